@@ -3,6 +3,7 @@
 #include <iostream>
 #include <parser/Parser.h>
 #include <common/Errors.h>
+#include <common/SourceIndex.h>
 #include <semantics/SemanticAnalyzer.h>
 #include <semantics/ScopedNodes.h>
 #include <cassert>
@@ -16,7 +17,7 @@ using namespace Swallow;
 
 
 REPL::REPL(const ConsoleWriterPtr& out)
-:out(out), canQuit(false)
+:evaluator(&registry, nullptr), out(out), maxResults(CompilerResults::DefaultLimit), canQuit(false)
 {
     initCommands();
     resultId = 0;
@@ -41,7 +42,13 @@ void REPL::repl()
             continue;
         }
         CompilerResults compilerResults;
-        eval(compilerResults, line);
+        compilerResults.setLimit(maxResults);
+        lastStats.reset();
+        {
+            CompilerStatsScope statsScope(&lastStats);
+            eval(compilerResults, line);
+        }
+        sessionStats.merge(lastStats);
         dumpCompilerResults(compilerResults, line);
         id++;
     }
@@ -61,7 +68,11 @@ void REPL::eval(CompilerResults& compilerResults, const wstring& line)
     {
         SemanticAnalyzer analyzer(&registry, &compilerResults);
         program->accept(&analyzer);
-        dumpProgram();
+        //types are still printed if the evaluation failed
+        vector<Value> values;
+        evaluator.setCompilerResults(&compilerResults);
+        bool evaluated = evaluator.evaluate(static_pointer_cast<ScopedProgram>(program), &values);
+        dumpProgram(evaluated ? &values : nullptr);
     }
     catch(const Abort&)
     {
@@ -69,21 +80,24 @@ void REPL::eval(CompilerResults& compilerResults, const wstring& line)
     }
 
 }
-void REPL::dumpProgram()
+void REPL::dumpProgram(const vector<Value>* values)
 {
     SymbolScope* scope = static_pointer_cast<ScopedProgram>(program)->getScope();
     assert(scope != nullptr);
     out->setForegroundColor(Cyan);
+    size_t index = 0;
     for(const StatementPtr& st : *program)
     {
         SymbolPtr sym = nullptr;
+        const Value* value = values ? &(*values)[index] : nullptr;
+        index++;
         switch(st->getNodeType())
         {
             case NodeType::Identifier:
             {
                 IdentifierPtr id = static_pointer_cast<Identifier>(st);
                 sym = scope->lookup(id->getIdentifier());
-                dumpSymbol(sym);
+                dumpSymbol(sym, value);
                 break;
             }
             case NodeType::ValueBindings:
@@ -94,7 +108,7 @@ void REPL::dumpProgram()
                     if(IdentifierPtr id = dynamic_pointer_cast<Identifier>(var->getName()))
                     {
                         sym = scope->lookup(id->getIdentifier());
-                        dumpSymbol(sym);
+                        dumpSymbol(sym, values && sym ? evaluator.getGlobal(sym) : nullptr);
                     }
                 }
                 break;
@@ -108,7 +122,7 @@ void REPL::dumpProgram()
                         wstringstream s;
                         s<<L"$R"<<(resultId++);
                         SymbolPlaceHolderPtr sym(new SymbolPlaceHolder(s.str(), pat->getType(), SymbolPlaceHolder::R_LOCAL_VARIABLE, 0));
-                        dumpSymbol(sym);
+                        dumpSymbol(sym, value);
                     }
                 }
                 break;
@@ -118,19 +132,26 @@ void REPL::dumpProgram()
     out->reset();
 }
 
-void REPL::dumpSymbol(const SymbolPtr& sym)
+void REPL::dumpSymbol(const SymbolPtr& sym, const Value* value)
 {
     if(sym && sym->getType())
     {
         wstring type = sym->getType()->toString();
-        out->printf(L"%ls : %ls\n", sym->getName().c_str(), type.c_str());
+        if(value)
+        {
+            wstring str = evaluator.toString(*value, sym->getType());
+            out->printf(L"%ls : %ls = %ls\n", sym->getName().c_str(), type.c_str(), str.c_str());
+        }
+        else
+            out->printf(L"%ls : %ls\n", sym->getName().c_str(), type.c_str());
     }
 }
 
 
 void REPL::dumpCompilerResults(CompilerResults& compilerResults, const std::wstring& code)
 {
-    for(auto res : compilerResults)
+    SourceIndex index(code);
+    for(const CompilerResult& res : compilerResults)
     {
         out->setForegroundColor(White);
         out->printf(L"%d:%d: ", res.line, res.column);
@@ -155,10 +176,12 @@ void REPL::dumpCompilerResults(CompilerResults& compilerResults, const std::wstr
         }
         out->setForegroundColor(White, Bright);
         out->printf(L": ");
-        wstring msg = Errors::format(res.code, res.items);
-        out->printf(L"%ls\n", msg.c_str());
+        wchar_t msg[1024];
+        res.render(msg, sizeof(msg) / sizeof(msg[0]));
+        out->printf(L"%ls\n", msg);
         out->reset();
-        out->printf(L"%ls\n", code.c_str());
+        wstring line = index.getLineContent(res.line);
+        out->printf(L"%ls\n", line.c_str());
         for(int i = 1; i < res.column; i++)
         {
             out->printf(L" ");
@@ -195,16 +218,18 @@ void REPL::initCommands()
     methods.insert(make_pair(L"quit", &REPL::commandQuit));
     methods.insert(make_pair(L"exit", &REPL::commandQuit));
     methods.insert(make_pair(L"symbols", &REPL::commandSymbols));
+    methods.insert(make_pair(L"stats", &REPL::commandStats));
 }
 void REPL::commandHelp(const wstring& args)
 {
     out->printf(L"The Swallow REPL (Read-Eval-Print-Loop) acts like an interpreter.  Valid statements, expressions, and declarations.\n");
-    out->printf(L"Compiler and execution is not finished yet.");
+    out->printf(L"Statements are evaluated by a tree-walking interpreter, a subset of the language is supported.");
     out->printf(L"\n");
     out->printf(L"The complete set of commands are also available as described below.  Commands must be prefixed with a colon at the REPL prompt (:quit for example.) \n\n\n");
     out->printf(L"REPL commands:\n");
     out->printf(L"  help              -- Show a list of all swallow commands, or give details about specific commands.\n");
     out->printf(L"  symbols           -- Dump symbols\n");
+    out->printf(L"  stats             -- Show compiler phase times and counters of the last line, 'stats session' for the whole session, 'stats reset' to clear them\n");
     out->printf(L"  quit              -- Quit out of the Swallow REPL.\n\n");
 }
 void REPL::commandQuit(const wstring& args)
@@ -276,3 +301,30 @@ void REPL::commandSymbols(const wstring& args)
         scope = p->getScope();
     dumpSymbols(scope, out);
 }
+
+static void dumpStats(const CompilerStats& stats, const ConsoleWriterPtr& out)
+{
+    for(int i = 0; i < CompilerPhase::Count; i++)
+    {
+        CompilerPhase::T phase = (CompilerPhase::T)i;
+        out->printf(L"%26s %10.3f ms\n", CompilerStats::getPhaseName(phase), stats.getTime(phase) / 1000000.0);
+    }
+    out->setForegroundColor(White, Bright);
+    out->printf(L"%26s %10.3f ms\n", "total", stats.getTotalTime() / 1000000.0);
+    out->reset();
+    for(int i = 0; i < CompilerCounter::Count; i++)
+    {
+        CompilerCounter::T counter = (CompilerCounter::T)i;
+        out->printf(L"%26s %10llu\n", CompilerStats::getCounterName(counter), (unsigned long long)stats.getCount(counter));
+    }
+}
+void REPL::commandStats(const wstring& args)
+{
+    if(args == L"reset")
+    {
+        lastStats.reset();
+        sessionStats.reset();
+        return;
+    }
+    dumpStats(args == L"session" ? sessionStats : lastStats, out);
+}
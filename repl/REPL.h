@@ -33,8 +33,10 @@
 #include <map>
 #include <memory>
 #include "common/CompilerResults.h"
+#include "common/CompilerStats.h"
 #include <semantics/SymbolRegistry.h>
 #include <semantics/ScopedNodeFactory.h>
+#include <interpreter/Evaluator.h>
 #include <ast/ast-decl.h>
 using std::wstring;
 class REPL;
@@ -47,25 +49,37 @@ public:
     REPL(const ConsoleWriterPtr& out);
 public:
     void repl();
+    /*!
+     * Limits the number of compiler results reported for each line, 0 means unlimited.
+     */
+    void setMaxResults(int maxResults) { this->maxResults = maxResults;}
 private:
     void evalCommand(const wstring& command);
     void eval(Swallow::CompilerResults& compilerResults, const wstring& line);
     void dumpCompilerResults(Swallow::CompilerResults& compilerResults, const std::wstring& code);
-    void dumpProgram();
-    void dumpSymbol(const Swallow::SymbolPtr& sym);
+    void dumpProgram(const std::vector<Swallow::Value>* values);
+    void dumpSymbol(const Swallow::SymbolPtr& sym, const Swallow::Value* value);
 
 private://commands
     void initCommands();
     void commandHelp(const wstring& args);
     void commandQuit(const wstring& args);
     void commandSymbols(const wstring& args);
+    void commandStats(const wstring& args);
 private:
     Swallow::SymbolRegistry registry;
+    Swallow::Evaluator evaluator;
     Swallow::ScopedNodeFactory nodeFactory;
     Swallow::ProgramPtr program;
     std::map<std::wstring, CommandMethod> methods;
     ConsoleWriterPtr out;
+    /*!
+     * Stats of the last evaluated line and of the whole session
+     */
+    Swallow::CompilerStats lastStats;
+    Swallow::CompilerStats sessionStats;
     int resultId;
+    int maxResults;
     bool canQuit;
 
 };
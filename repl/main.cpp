@@ -28,19 +28,285 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
 #include "ConsoleWriter.h"
 #include "common/Errors.h"
+#include "common/SwallowUtils.h"
+#include "common/CompilerTrace.h"
+#include "semantics/BatchCompiler.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/ScopedNodeFactory.h"
+#include "semantics/OperatorResolver.h"
+#include "semantics/SemanticAnalyzer.h"
+#include "semantics/Symbol.h"
+#include "ast/ast.h"
+#include "parser/Parser.h"
+#include "interpreter/Evaluator.h"
+#include "interpreter/VirtualMachine.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRSpecializer.h"
+#include "ir/IRStackPromotion.h"
+#include "ir/IRARCOptimizer.h"
+#include "codegen/CEmitter.h"
 #include "REPL.h"
 
 using namespace std;
 using namespace Swallow;
 
 
+/*!
+ * Compile all .swift files in given directory concurrently and dump their compiler results.
+ */
+static int batch(const char* directory, int numThreads, int maxExpressionCost, int maxResults, CompilerTrace* trace)
+{
+    vector<BatchItem> items;
+    if(!BatchCompiler::readDirectory(directory, items))
+    {
+        cerr << "Cannot open directory " << directory << endl;
+        return 2;
+    }
+    BatchCompiler compiler(numThreads);
+    compiler.setTrace(trace);
+    compiler.setMaxExpressionCost(maxExpressionCost);
+    compiler.setMaxResults(maxResults);
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    int failed = 0;
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const BatchResult& result = results[i];
+        if(!result.compilerResults.numResults())
+            continue;
+        failed++;
+        wcout << L"==> " << result.fileName << endl;
+        SwallowUtils::dumpCompilerResults(items[i].code, result.compilerResults, wcout);
+    }
+    wcout << results.size() << L" files compiled, " << failed << L" files with diagnostics." << endl;
+    return failed ? 1 : 0;
+}
+
+/*!
+ * Parse and analyze the source of given file, returns null if any error is reported
+ */
+static ScopedProgramPtr analyze(SymbolRegistry& registry, CompilerResults& compilerResults, const wstring& code, const char* fileName, int maxExpressionCost)
+{
+    ScopedNodeFactory nodeFactory;
+    Parser parser(&nodeFactory, &compilerResults);
+    parser.setFileName(SwallowUtils::toWString(fileName).c_str());
+    ScopedProgramPtr program = static_pointer_cast<ScopedProgram>(parser.parse(code.c_str()));
+    if(!program)
+        return nullptr;
+    try
+    {
+        OperatorResolver operatorResolver(&registry, &compilerResults);
+        SemanticAnalyzer analyzer(&registry, &compilerResults);
+        analyzer.setMaxExpressionCost(maxExpressionCost);
+        program->accept(&operatorResolver);
+        program->accept(&analyzer);
+    }
+    catch(const Abort&)
+    {
+        return nullptr;
+    }
+    return compilerResults.numResults() == 0 ? program : nullptr;
+}
+
+/*!
+ * Prints the values of the top-level variables after the program is executed by given engine
+ */
+template<class Engine>
+static void dumpGlobals(const ScopedProgramPtr& program, Engine& engine)
+{
+    SymbolScope* scope = program->getScope();
+    for(const StatementPtr& st : *program)
+    {
+        ValueBindingsPtr vars = dynamic_pointer_cast<ValueBindings>(st);
+        if(!vars)
+            continue;
+        for(const ValueBindingPtr& var : *vars)
+        {
+            IdentifierPtr id = dynamic_pointer_cast<Identifier>(var->getName());
+            SymbolPtr sym = id ? scope->lookup(id->getIdentifier()) : nullptr;
+            Value* value = sym ? engine.getGlobal(sym) : nullptr;
+            if(!value)
+                continue;
+            wcout << sym->getName() << L" : " << sym->getType()->toString() << L" = " << engine.toString(*value, sym->getType()) << endl;
+        }
+    }
+}
+
+static bool isSupported(const CompilerResults& compilerResults)
+{
+    for(const CompilerResult& res : compilerResults)
+    {
+        if(res.code == Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1)
+            return false;
+    }
+    return true;
+}
+
+/*!
+ * Runs given file on the bytecode virtual machine and prints the values of its top-level variables.
+ * Programs using constructs the virtual machine doesn't support are run by the tree-walking evaluator instead,
+ * nothing is executed by the virtual machine in that case because the whole program is compiled before it runs.
+ */
+static int run(const char* fileName, int maxExpressionCost, int maxResults, CompilerTrace* trace)
+{
+    CompilerTraceScope traceScope(trace);
+    wstring code = SwallowUtils::readFile(fileName);
+    SymbolRegistry registry;
+    CompilerResults compilerResults;
+    compilerResults.setLimit(maxResults);
+    ScopedProgramPtr program = analyze(registry, compilerResults, code, fileName, maxExpressionCost);
+    if(!program)
+    {
+        SwallowUtils::dumpCompilerResults(code, compilerResults, wcerr);
+        return 1;
+    }
+    VirtualMachine vm(&registry, &compilerResults);
+    if(vm.run(program))
+    {
+        dumpGlobals(program, vm);
+        return 0;
+    }
+    if(isSupported(compilerResults))
+    {
+        SwallowUtils::dumpCompilerResults(code, compilerResults, wcerr);
+        return 1;
+    }
+    wcerr << L"Falling back to the evaluator: " << compilerResults.getResult(0).format() << endl;
+    compilerResults.clear();
+    Evaluator evaluator(&registry, &compilerResults);
+    if(!evaluator.evaluate(program))
+    {
+        SwallowUtils::dumpCompilerResults(code, compilerResults, wcerr);
+        return 1;
+    }
+    dumpGlobals(program, evaluator);
+    return 0;
+}
+
+/*!
+ * Compile given file into C99 source and write it to standard output,
+ * the statistics of generic specialization and reference counting optimization are written to standard error.
+ */
+static int emitC(const char* fileName, SpecializationPolicy::T policy, int maxExpressionCost, int maxResults, CompilerTrace* trace)
+{
+    CompilerTraceScope traceScope(trace);
+    wstring code = SwallowUtils::readFile(fileName);
+    SymbolRegistry registry;
+    CompilerResults compilerResults;
+    compilerResults.setLimit(maxResults);
+    //output functions implemented by the emitted runtime
+    GlobalScope* global = registry.getGlobalScope();
+    const wchar_t* printables[] = {L"Int", L"Int8", L"Int16", L"Int32", L"Int64", L"UInt", L"UInt8", L"UInt16", L"UInt32", L"UInt64",
+        L"Double", L"Float", L"Bool", L"String", nullptr};
+    for(int i = 0; printables[i]; i++)
+    {
+        global->declareFunction(L"print", 0, L"Void", printables[i], NULL);
+        global->declareFunction(L"println", 0, L"Void", printables[i], NULL);
+    }
+    ScopedProgramPtr program = analyze(registry, compilerResults, code, fileName, maxExpressionCost);
+    bool ok = program != nullptr;
+    if(ok)
+    {
+        IRModule module(L"main");
+        IRLowering lowering(&registry, &compilerResults, &module);
+        CEmitter emitter(&registry, &compilerResults);
+        ok = lowering.lower(program);
+        if(ok)
+        {
+            IRSpecializer specializer(&registry, &module);
+            specializer.setPolicy(policy);
+            specializer.run();
+            specializer.dumpStatistics(wcerr);
+            IRStackPromotion promotion(&module);
+            promotion.run();
+            promotion.dumpStatistics(wcerr);
+            IRARCOptimizer arc(&module);
+            arc.run();
+            arc.dumpStatistics(wcerr);
+            ok = emitter.emit(&module, cout);
+        }
+    }
+    if(!ok)
+    {
+        SwallowUtils::dumpCompilerResults(code, compilerResults, wcerr);
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char** argv)
 {
+    const char* batchDirectory = nullptr;
+    const char* emitCFile = nullptr;
+    const char* runFile = nullptr;
+    const char* traceFile = nullptr;
+    SpecializationPolicy::T policy = SpecializationPolicy::HotOrSmall;
+    int numThreads = 0;
+    int maxExpressionCost = SemanticAnalyzer::DefaultMaxExpressionCost;
+    int maxResults = CompilerResults::DefaultLimit;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--batch") && i + 1 < argc)
+            batchDirectory = argv[++i];
+        else if(!strcmp(argv[i], "-j") && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--emit-c") && i + 1 < argc)
+            emitCFile = argv[++i];
+        else if(!strcmp(argv[i], "--run") && i + 1 < argc)
+            runFile = argv[++i];
+        else if(!strcmp(argv[i], "--trace") && i + 1 < argc)
+            traceFile = argv[++i];
+        else if(!strcmp(argv[i], "--max-expression-cost") && i + 1 < argc)
+            maxExpressionCost = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--max-errors") && i + 1 < argc)
+            maxResults = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--specialize") && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            if(!strcmp(name, "always"))
+                policy = SpecializationPolicy::Always;
+            else if(!strcmp(name, "never"))
+                policy = SpecializationPolicy::Never;
+            else
+                policy = SpecializationPolicy::HotOrSmall;
+        }
+    }
+    if(batchDirectory || emitCFile || runFile)
+    {
+        CompilerTrace trace;
+        int ret;
+        if(batchDirectory)
+            ret = batch(batchDirectory, numThreads, maxExpressionCost, maxResults, traceFile ? &trace : nullptr);
+        else if(emitCFile)
+            ret = emitC(emitCFile, policy, maxExpressionCost, maxResults, traceFile ? &trace : nullptr);
+        else
+            ret = run(runFile, maxExpressionCost, maxResults, traceFile ? &trace : nullptr);
+        if(traceFile)
+        {
+            ofstream out(traceFile);
+            if(!out)
+            {
+                cerr << "Cannot write trace file " << traceFile << endl;
+                return 2;
+            }
+            trace.writeChromeTrace(out);
+            if(trace.getDroppedEvents())
+                cerr << trace.getDroppedEvents() << " trace events were dropped" << endl;
+        }
+        return ret;
+    }
+
     ConsoleWriterPtr out(ConsoleWriter::create());
     REPL repl(out);
+    repl.setMaxResults(maxResults);
     repl.repl();
     return 0;
 }
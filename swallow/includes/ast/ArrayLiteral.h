@@ -41,14 +41,15 @@ public:
 public:
 	void push(const ExpressionPtr& item);
     ExpressionPtr getElement(int i);
+    void setElement(int i, const ExpressionPtr& item);
     int numElements()const;
 public:
     virtual void accept(NodeVisitor* visitor);
 
-    std::vector<ExpressionPtr>::iterator begin();
-    std::vector<ExpressionPtr>::iterator end();
+    std::vector<ExpressionPtr>::const_iterator begin()const;
+    std::vector<ExpressionPtr>::const_iterator end()const;
 
-public:
+private:
     std::vector<ExpressionPtr> elements;
 };
 
@@ -39,10 +39,10 @@ public:
     BinaryOperator();
     ~BinaryOperator();
 public:
-    void setLHS(const PatternPtr& val){lhs = val;}
+    void setLHS(const PatternPtr& val){lhs = val; adopt(val.get());}
     PatternPtr getLHS(){return lhs;}
 
-    void setRHS(const PatternPtr& val){rhs = val;}
+    void setRHS(const PatternPtr& val){rhs = val; adopt(val.get());}
     PatternPtr getRHS(){return rhs;}
     
 
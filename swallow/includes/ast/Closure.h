@@ -69,14 +69,16 @@ public:
     void addStatement(const StatementPtr& st);
     int numStatement()const;
     StatementPtr getStatement(int i);
+    void setStatement(int i, const StatementPtr& st);
 
-    std::vector<StatementPtr>::iterator begin(){return statements.begin();}
-    std::vector<StatementPtr>::iterator end(){return statements.end();}
+    std::vector<StatementPtr>::const_iterator begin()const{return statements.begin();}
+    std::vector<StatementPtr>::const_iterator end()const{return statements.end();}
 public:
     CaptureSpecifier captureSpecifier;
     ExpressionPtr capture;
     ParametersNodePtr parameters;
     TypeNodePtr returnType;
+private:
     std::vector<StatementPtr> statements;
     
 };
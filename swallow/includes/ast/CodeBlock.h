@@ -45,6 +45,7 @@ public:
     void addStatement(const StatementPtr& st);
     int numStatements();
     StatementPtr getStatement(int idx);
+    void setStatement(int idx, const StatementPtr& st);
     
     void setAttributes(const Attributes& attrs);
     const Attributes& getAttributes()const;
@@ -52,8 +53,8 @@ public:
     const TypePtr& getType()const;
     void setType(const TypePtr& type);
 public:
-    std::vector<StatementPtr>::iterator begin() { return statements.begin();}
-    std::vector<StatementPtr>::iterator end() { return statements.end();}
+    std::vector<StatementPtr>::const_iterator begin() const { return statements.begin();}
+    std::vector<StatementPtr>::const_iterator end() const { return statements.end();}
 public:
     virtual void accept(NodeVisitor* visitor);
 private:
@@ -44,9 +44,9 @@ public:
     ExpressionPtr getFalseExpression() { return falseExpression;}
     
     
-    void setCondition(PatternPtr v) { condition = v;}
-    void setTrueExpression(ExpressionPtr v) { trueExpression = v;}
-    void setFalseExpression(ExpressionPtr v) { falseExpression = v;}
+    void setCondition(PatternPtr v) { condition = v; adopt(v.get());}
+    void setTrueExpression(ExpressionPtr v) { trueExpression = v; adopt(v.get());}
+    void setFalseExpression(ExpressionPtr v) { falseExpression = v; adopt(v.get());}
 public:
     
     virtual int numChildren();
@@ -42,9 +42,11 @@ public:
 public:
 	void insert(const ExpressionPtr& key, const ExpressionPtr& value);
     int numElements()const;
+    void setKey(int idx, const ExpressionPtr& key);
+    void setValue(int idx, const ExpressionPtr& value);
 public:
-    Map::iterator begin(){return items.begin();}
-    Map::iterator end(){return items.end();}
+    Map::const_iterator begin()const{return items.begin();}
+    Map::const_iterator end()const{return items.end();}
 public:
     virtual void accept(NodeVisitor* visitor);
 private:
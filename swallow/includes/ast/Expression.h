@@ -31,12 +31,45 @@
 #define EXPRESSION_H
 #include "Pattern.h"
 SWALLOW_NS_BEGIN
+class Symbol;
+typedef std::shared_ptr<Symbol> SymbolPtr;
 
+/*!
+ * The kind of literal an expression is made of, its type can still be inferred from the contextual type
+ * after it's analyzed with the default literal type.
+ */
+struct LiteralKind
+{
+    enum T
+    {
+        None,
+        Integer,
+        Float
+    };
+};
 
 class SWALLOW_EXPORT Expression : public Pattern
 {
 protected:
 	Expression(NodeType::T nodeType);
+public:
+    /*!
+     * Gets the symbol that semantic analyzer resolved for this expression, e.g. the variable of
+     * an identifier, the member of a member access or the selected overload of a function call/operator.
+     */
+    SymbolPtr getReferencedSymbol() const;
+    void setReferencedSymbol(const SymbolPtr& symbol);
+
+    /*!
+     * Gets the literal kind of the expression, e.g. 1 and 1 + 2 are both integer literals whose
+     * type is Int by default, and can be inferred to other integer or floating point types.
+     */
+    LiteralKind::T getLiteralKind() const;
+    void setLiteralKind(LiteralKind::T kind);
+private:
+    //weak reference, function symbols hold their definitions which may contain this node
+    std::weak_ptr<Symbol> referencedSymbol;
+    LiteralKind::T literalKind;
 };
 typedef std::shared_ptr<Expression> ExpressionPtr;
 SWALLOW_NS_END
@@ -0,0 +1,169 @@
+/* FlatAST.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+#include "swallow_conf.h"
+#include "ast-decl.h"
+#include "Node.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+class NodeVisitor;
+typedef std::shared_ptr<class Type> TypePtr;
+
+/*!
+ * \brief A flat, index based copy of an AST for passes that scan a whole file.
+ *
+ * Nodes are numbered in pre-order and their attributes are stored in parallel arrays: kind, flags, role, source
+ * offset, type index, name index and parent, so a scan over one attribute touches a contiguous array instead of
+ * chasing pointers. The subtree of a node covers the indices [node, getSubtreeEnd(node)), and the children of
+ * each node are a contiguous range in a shared array of 32-bit indices.
+ * Types and names(identifiers, literals, operators) are interned in tables and referred by index.
+ *
+ * The nodes are the ones reached by NodeVisitor's default traversal, plus the loop variables of for-in.
+ * The role of a node tells which part of a control statement it is, so passes like ControlFlowGraph can
+ * walk control statements without the tree. Each flat node keeps a pointer to the node it's built from,
+ * so any existing NodeVisitor can still be applied to a flat node by accept().
+ * The flat AST keeps the root alive but doesn't follow later changes of the tree.
+ */
+class SWALLOW_EXPORT FlatAST
+{
+    friend class FlatASTBuilder;
+public:
+    enum : uint32_t
+    {
+        InvalidIndex = 0xffffffff
+    };
+    enum Flags : uint8_t
+    {
+        FlagExpression = 1,
+        FlagDeclaration = 2,
+        /*!
+         * let bindings
+         */
+        FlagReadOnly = 4,
+        /*!
+         * Boolean literal true
+         */
+        FlagTrue = 8
+    };
+    enum Role : uint8_t
+    {
+        RoleNone,
+        /*!
+         * Condition of if/while/do/for, control expression of switch, or pattern of case
+         */
+        RoleCondition,
+        RoleThen,
+        RoleElse,
+        /*!
+         * Code block of a loop or case
+         */
+        RoleBody,
+        /*!
+         * Expressions or variable declarations before the first iteration of for
+         */
+        RoleInit,
+        RoleStep,
+        RoleLoopVariables,
+        /*!
+         * Sequence iterated by for-in
+         */
+        RoleContainer,
+        RoleGuard,
+        RoleCase,
+        RoleDefaultCase
+    };
+public:
+    FlatAST(const NodePtr& root);
+public:
+    uint32_t size() const { return kinds.size();}
+    NodeType::T getKind(uint32_t node) const { return (NodeType::T)kinds[node];}
+    uint8_t getFlags(uint32_t node) const { return flags[node];}
+    Role getRole(uint32_t node) const { return (Role)roles[node];}
+    /*!
+     * Offset of the node in the source buffer
+     */
+    uint32_t getSourceOffset(uint32_t node) const { return sourceOffsets[node];}
+    /*!
+     * Gets the type of the node resolved by semantic analysis, or null
+     */
+    const TypePtr& getType(uint32_t node) const;
+    uint32_t getTypeIndex(uint32_t node) const { return typeIndices[node];}
+    /*!
+     * Gets the identifier, literal text, operator, declared name or loop label of the node, or an empty string
+     */
+    const std::wstring& getName(uint32_t node) const;
+    uint32_t getNameIndex(uint32_t node) const { return nameIndices[node];}
+    uint32_t getParent(uint32_t node) const { return parents[node];}
+    uint32_t getSubtreeEnd(uint32_t node) const { return subtreeEnds[node];}
+    uint32_t numChildren(uint32_t node) const { return childOffsets[node + 1] - childOffsets[node];}
+    uint32_t getChild(uint32_t node, uint32_t idx) const { return children[childOffsets[node] + idx];}
+    /*!
+     * Gets the first child of given role, returns InvalidIndex if there's none
+     */
+    uint32_t findChild(uint32_t node, Role role) const;
+    /*!
+     * Gets the tree node that the flat node is built from
+     */
+    Node* getNode(uint32_t node) const { return nodes[node];}
+    /*!
+     * Applies the visitor to the tree node of the flat node
+     */
+    void accept(uint32_t node, NodeVisitor* visitor) const;
+    /*!
+     * Bytes used by the flat arrays and the tree nodes kept alive by the flat AST, the tree nodes are counted
+     * by the size of their classes, not including the containers they own or the interned names and types
+     */
+    size_t getMemoryUsage() const;
+private:
+    NodePtr root;
+    std::vector<uint8_t> kinds;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> roles;
+    std::vector<uint32_t> sourceOffsets;
+    std::vector<uint32_t> typeIndices;
+    std::vector<uint32_t> nameIndices;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> subtreeEnds;
+    std::vector<uint32_t> childOffsets;
+    std::vector<uint32_t> children;
+    std::vector<Node*> nodes;
+    std::vector<TypePtr> types;
+    std::vector<std::wstring> names;
+    size_t treeMemory;
+};
+
+SWALLOW_NS_END
+
+#endif//FLAT_AST_H
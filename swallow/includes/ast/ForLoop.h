@@ -46,6 +46,7 @@ public:
     void addInit(const ExpressionPtr& init);
     int numInit() const;
     ExpressionPtr getInit(int idx) const;
+    void setInit(int idx, const ExpressionPtr& init);
 
     ValueBindingsPtr getInitializer() const;
     void setInitializer(const ValueBindingsPtr& initializer);
@@ -62,8 +63,9 @@ public:
     
 public:
     virtual void accept(NodeVisitor* visitor);
-public:
+private:
     std::vector<ExpressionPtr> inits;
+public:
     ValueBindingsPtr initializer;
     ExpressionPtr condition;
     ExpressionPtr step;
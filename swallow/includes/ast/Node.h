@@ -71,6 +71,7 @@ struct NodeType
         DynamicType,
         EnumCasePattern,
         Enum,
+        Error,
         Extension,
         Fallthrough,
         FloatLiteral,
@@ -144,15 +145,21 @@ public:
     virtual void accept(NodeVisitor* visitor){}
 
 protected:
+    /*!
+     * The parent is linked when the node is attached to it, so visiting the node doesn't touch the link
+     */
     template<class ASTNode>
     inline void accept2(NodeVisitor* visitor, void (NodeVisitor::*visit)(const std::shared_ptr<ASTNode>&))
     {
-        std::shared_ptr<ASTNode> self = std::static_pointer_cast<ASTNode>(shared_from_this());
-        this->parentNode = visitor->currentNode;
-        SCOPED_SET(visitor->currentNode, self);
-        (visitor->*visit)(self);
+        NodeVisitor::NodeScope scope(visitor, this);
+        (visitor->*visit)(std::static_pointer_cast<ASTNode>(shared_from_this()));
     }
-
+protected:
+    /*!
+     * Links the child to this node, the setters and container methods of child nodes call this
+     * so a rewritten tree keeps its parent links.
+     */
+    void adopt(Node* child);
 public:
     /*!
      * Used for debugging, convert node type into it's class name
@@ -88,6 +88,7 @@ public:
     virtual BreakStatementPtr createBreak(const SourceInfo& state);
     virtual ContinueStatementPtr createContinue(const SourceInfo& state);
     virtual FallthroughStatementPtr createFallthrough(const SourceInfo& state);
+    virtual ErrorNodePtr createError(const SourceInfo& state);
     virtual ReturnStatementPtr createReturn(const SourceInfo& state);
     virtual LabeledStatementPtr createLabel(const SourceInfo& state);
     virtual CodeBlockPtr createCodeBlock(const SourceInfo& state);
@@ -31,6 +31,7 @@
 #define NODE_VISITOR_H
 #include "swallow_conf.h"
 #include "ast-decl.h"
+#include <vector>
 
 SWALLOW_NS_BEGIN
 
@@ -73,6 +74,7 @@ public://statement
     virtual void visitReturn(const ReturnStatementPtr& node);
     virtual void visitContinue(const ContinueStatementPtr& node);
     virtual void visitFallthrough(const FallthroughStatementPtr& node);
+    virtual void visitError(const ErrorNodePtr& node);
     virtual void visitIf(const IfStatementPtr& node);
     virtual void visitSwitchCase(const SwitchCasePtr& node);
     virtual void visitCase(const CaseStatementPtr& node);
@@ -116,7 +118,30 @@ public:
     virtual void visitTupleType(const TupleTypePtr& node);
     virtual void visitTypeIdentifier(const TypeIdentifierPtr& node);
 protected:
-    NodePtr currentNode;
+    /*!
+     * Gets the node being visited, or nullptr if it's called outside of a visit
+     */
+    Node* getCurrentNode() const { return nodeStack.empty() ? nullptr : nodeStack.back();}
+    /*!
+     * Gets the node whose visit led to the current node, a node can be visited from other than its parent
+     */
+    Node* getVisitingParent() const { return nodeStack.size() < 2 ? nullptr : nodeStack[nodeStack.size() - 2];}
+private:
+    struct NodeScope
+    {
+        NodeScope(NodeVisitor* visitor, Node* node)
+        :visitor(visitor)
+        {
+            visitor->nodeStack.push_back(node);
+        }
+        ~NodeScope()
+        {
+            visitor->nodeStack.pop_back();
+        }
+        NodeVisitor* visitor;
+    };
+    //nodes on the path from the outermost visited node to the current node
+    std::vector<Node*> nodeStack;
 };
 
 
@@ -53,14 +53,21 @@ public:
 public:
     void append(const std::wstring& name, const ExpressionPtr& expr);
     void append(const ExpressionPtr& expr);
+    /*!
+     * Appends an expression that stays attached to its own parent, used by the argument lists
+     * built temporarily to resolve an operator.
+     */
+    void borrow(const ExpressionPtr& expr);
     size_t numExpressions()const;
     std::wstring getName(int idx);
     ExpressionPtr get(int idx);
+    void setExpression(int idx, const ExpressionPtr& expr);
+    void setTransformedExpression(int idx, const ExpressionPtr& expr);
 public:
     virtual void accept(NodeVisitor* visitor);
-    std::vector<Term>::iterator begin() {return expressions.begin();}
-    std::vector<Term>::iterator end() {return expressions.end();}
-public:
+    std::vector<Term>::const_iterator begin() const {return expressions.begin();}
+    std::vector<Term>::const_iterator end() const {return expressions.end();}
+private:
     std::vector<Term> expressions;
 };
 
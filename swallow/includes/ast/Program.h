@@ -48,9 +48,10 @@ public:
     void addStatement(const StatementPtr& statement);
     int numStatements()const;
     StatementPtr getStatement(int n);
+    void setStatement(int n, const StatementPtr& statement);
 
-    std::vector<StatementPtr>::iterator begin() { return statements.begin();}
-    std::vector<StatementPtr>::iterator end() { return statements.end();}
+    std::vector<StatementPtr>::const_iterator begin() const { return statements.begin();}
+    std::vector<StatementPtr>::const_iterator end() const { return statements.end();}
 
     void clearStatements();
 private:
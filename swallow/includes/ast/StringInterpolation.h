@@ -43,9 +43,10 @@ SWALLOW_NS_BEGIN
         virtual void accept(NodeVisitor* visitor);
         void addExpression(const ExpressionPtr& expr);
         ExpressionPtr getExpression(int index);
+        void setExpression(int index, const ExpressionPtr& expr);
         size_t numExpressions()const;
-        std::vector<ExpressionPtr>::iterator begin();
-        std::vector<ExpressionPtr>::iterator end();
+        std::vector<ExpressionPtr>::const_iterator begin()const;
+        std::vector<ExpressionPtr>::const_iterator end()const;
     private:
         std::vector<ExpressionPtr> expressions;
     };
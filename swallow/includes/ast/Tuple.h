@@ -47,12 +47,13 @@ public:
     void add(const PatternPtr& pattern);
     int numElements();
     PatternPtr getElement(int i);
+    void setElement(int i, const PatternPtr& pattern);
     
     TypeNodePtr getDeclaredType();
     void setDeclaredType(const TypeNodePtr& type);
 
-    std::vector<PatternPtr>::iterator begin(){return elements.begin();}
-    std::vector<PatternPtr>::iterator end(){return elements.end();}
+    std::vector<PatternPtr>::const_iterator begin()const{return elements.begin();}
+    std::vector<PatternPtr>::const_iterator end()const{return elements.end();}
 
 private:
     TypeNodePtr declaredType;
@@ -39,7 +39,7 @@ public:
     UnaryOperator();
     ~UnaryOperator();
 public:
-    void setOperand(const ExpressionPtr& node){operand = node;}
+    void setOperand(const ExpressionPtr& node){operand = node; adopt(node.get());}
     ExpressionPtr getOperand(){return operand;}
     
 public:
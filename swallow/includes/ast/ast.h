@@ -71,6 +71,7 @@
 #include "ContinueStatement.h"
 #include "DoLoop.h"
 #include "FallthroughStatement.h"
+#include "ErrorNode.h"
 #include "ForLoop.h"
 #include "ForInLoop.h"
 #include "IfStatement.h"
@@ -0,0 +1,133 @@
+/* CEmitter.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef C_EMITTER_H
+#define C_EMITTER_H
+#include "swallow_conf.h"
+#include "ir/IR.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <sstream>
+#include <memory>
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+class CompilerResults;
+class GlobalScope;
+typedef std::shared_ptr<class FunctionSymbol> FunctionSymbolPtr;
+
+/*!
+ * \brief Emits a self-contained C99 translation unit from the IR module.
+ *
+ * Functions and globals keep their mangled names. Structs become C structs laid out in the order of
+ * their stored properties, tuples become anonymous-like structs with numbered elements, enums become
+ * a tag followed by a union of payloads. Classes are reference counted heap objects, every object starts
+ * with a header pointing to its class's vtable, subclasses embed the layout of their parent as the first
+ * member so a reference can be used as any of its superclasses.
+ *
+ * The small runtime(allocation, reference counting, strings and overflow-checked arithmetic) is emitted
+ * in the same file, so the output builds with any C99 compiler without extra libraries except libm.
+ *
+ * Types and instructions that have no C mapping are reported as E_A_IS_NOT_SUPPORTED_IN_C_CODE_GENERATION_1.
+ */
+class SWALLOW_EXPORT CEmitter
+{
+    struct ClassInfo;
+public:
+    CEmitter(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults);
+    ~CEmitter();
+public:
+    /*!
+     * Emits C main that runs the top-level code, default is true.
+     * When it's disabled the top-level code is exported as swallow_main so the output can be embedded.
+     */
+    void setEntryPoint(bool entryPoint) { this->entryPoint = entryPoint;}
+    /*!
+     * Emits the module as C source into out.
+     * Returns false if the module uses a construct that has no C mapping.
+     */
+    bool emit(const IRModule* module, std::ostream& out);
+private:
+    void unsupported(const std::wstring& what);
+    std::string getTypeName(IRTypeRef type);
+    std::string getTypeName(const TypePtr& type);
+    std::string defineNominalType(const TypePtr& type);
+    std::string defineTuple(const TypePtr& type);
+    ClassInfo* getClassInfo(const TypePtr& type);
+    void defineClass(ClassInfo* info);
+    bool isTrivial(const TypePtr& type);
+    /*!
+     * Gets the helper that retains or releases a value of given type, empty if the type is trivial
+     */
+    std::string getValueHelper(const TypePtr& type, bool retain);
+    std::string getBuiltin(const std::wstring& name);
+    std::string getFunctionName(const IRFunction* func);
+    std::string getPrototype(const IRFunction* func, const std::string& name);
+    bool emitIntrinsic(const IRFunction* func);
+private:
+    void emitFunction(const IRFunction* func);
+    void emitInstruction(const IRFunction* func, IRValue value);
+    void emitBranch(const IRFunction* func, uint32_t target, const IRValue* args, int numArgs);
+    std::string getStringLiteral(uint32_t index);
+private:
+    SymbolRegistry* symbolRegistry;
+    CompilerResults* compilerResults;
+    GlobalScope* global;
+    const IRModule* module;
+    bool entryPoint;
+    //sections of the output, joined in this order
+    std::ostringstream declarations;
+    std::ostringstream definitions;
+    std::ostringstream builtins;
+    std::ostringstream helpers;
+    std::ostringstream prototypes;
+    std::ostringstream classes;
+    std::ostringstream globals;
+    std::ostringstream functions;
+    //C names of Swift types, nominal types are keyed by their declaration
+    std::unordered_map<Type*, std::string> typeNames;
+    std::map<std::wstring, std::string> tupleNames;
+    std::unordered_set<std::string> usedNames;
+    std::unordered_set<std::string> definedHelpers;
+    std::unordered_map<Type*, bool> trivialTypes;
+    //classes are kept in the order they were defined, parents come first
+    std::vector<std::unique_ptr<ClassInfo> > classList;
+    std::unordered_map<Type*, ClassInfo*> classInfos;
+    std::unordered_map<Symbol*, const IRFunction*> functionsBySymbol;
+    std::unordered_set<uint32_t> emittedStrings;
+};
+
+SWALLOW_NS_END
+
+#endif//C_EMITTER_H
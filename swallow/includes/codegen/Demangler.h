@@ -0,0 +1,133 @@
+/* Demangler.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef DEMANGLER_H
+#define DEMANGLER_H
+#include "swallow_conf.h"
+#include <string>
+#include <vector>
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * \brief Parsed form of a mangled symbol name
+ */
+struct SWALLOW_EXPORT DemangledSymbol
+{
+    enum Kind
+    {
+        Variable,
+        Function
+    };
+    Kind kind;
+    std::wstring module;
+    /*!
+     * Names of the declaring types, outermost first
+     */
+    std::vector<std::wstring> context;
+    /*!
+     * Readable full name of the innermost declaring type
+     */
+    std::wstring contextName;
+    /*!
+     * The declaring type is an extension, context contains the name of extended type
+     */
+    bool extension;
+    /*!
+     * Name of the symbol, initializers and deinitializers are named as init/deinit
+     */
+    std::wstring name;
+    /*!
+     * Property accessor, one of 'g'(getter), 's'(setter), 'w'(willSet), 'W'(didSet) or 0
+     */
+    char accessor;
+    /*!
+     * Operator fixity, one of 'i'(infix), 'p'(prefix), 'P'(postfix) or 0
+     */
+    char fixity;
+    /*!
+     * One of 'C'(allocating init), 'c'(init), 'D'(deallocating deinit), 'd'(deinit) or 0
+     */
+    char special;
+    bool isPrivate;
+    /*!
+     * Generic signature like <A : Swift.Equatable, B>, empty if the symbol is not generic
+     */
+    std::wstring generics;
+    /*!
+     * Readable type of the symbol
+     */
+    std::wstring type;
+
+    DemangledSymbol();
+    /*!
+     * Readable text of the symbol, like main.test (Swift.Int) -> Swift.Bool
+     */
+    std::wstring toString() const;
+};
+
+/*!
+ * \brief Parse the mangled names generated by NameMangling
+ * A demangler can be reused for any number of names, it's not thread-safe.
+ */
+class SWALLOW_EXPORT Demangler
+{
+public:
+    /*!
+     * \brief Parse a mangled name
+     * \return false if the name is not a valid mangled name
+     */
+    bool demangle(const char* name, size_t length, DemangledSymbol& out);
+    bool demangle(const std::string& name, DemangledSymbol& out);
+    /*!
+     * \brief Demangle a name into readable text
+     * \return The name itself if it cannot be demangled
+     */
+    std::wstring demangle(const std::string& name);
+private:
+    bool parseType(std::wstring& out);
+    bool parseNominal(std::wstring& out);
+    bool parseSubstitution(std::wstring& out);
+    bool parseTuple(std::wstring& out);
+    bool parseGenerics(std::wstring& out);
+    bool parseName(std::wstring& out);
+    bool parseNumber(int& out);
+    bool match(char ch);
+    bool peek(char ch) const;
+private:
+    const char* cursor;
+    const char* end;
+    std::wstring module;
+    std::vector<std::wstring> substitutions;
+    std::vector<std::wstring> genericParameters;
+};
+
+SWALLOW_NS_END
+
+#endif//DEMANGLER_H
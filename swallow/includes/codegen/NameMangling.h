@@ -31,9 +31,12 @@
 #define NAME_MANGLING_H
 #include "swallow_conf.h"
 #include "swallow_types.h"
+#include "semantics/GenericDefinition.h"
+#include "codegen/Demangler.h"
 #include <string>
-#include <sstream>
+#include <vector>
 #include <map>
+#include <unordered_map>
 
 SWALLOW_NS_BEGIN
 typedef std::shared_ptr<class Symbol> SymbolPtr;
@@ -41,6 +44,7 @@ typedef std::shared_ptr<class SymbolPlaceHolder> SymbolPlaceHolderPtr;
 typedef std::shared_ptr<class GenericDefinition> GenericDefinitionPtr;
 typedef std::shared_ptr<class Type> TypePtr;
 class SymbolRegistry;
+class SymbolScope;
 struct ManglingContext;
 
 /*!
@@ -54,10 +58,18 @@ public:
 public:
     /*!
      * \brief Decode a mangled name into a symbol
+     * Names that were encoded before are resolved by the reverse index directly, others are demangled and
+     * looked up from the indexed scopes, file scope and global scope.
      * \param name
      * \return nullptr if failed to decode it
      */
     SymbolPtr decode(const wchar_t* name);
+    SymbolPtr decode(const std::string& name);
+
+    /*!
+     * \brief Add all symbols of given scope to the reverse index, the scope will also be searched by decode.
+     */
+    void indexScope(SymbolScope* scope);
 
     /*!
      * \brief Encode a symbol into a mangled name
@@ -65,15 +77,59 @@ public:
      * \return
      */
     std::wstring encode(const SymbolPtr& symbol);
+
+    /*!
+     * \brief Encode a symbol into a mangled name, the name is written into given narrow buffer
+     * \param symbol
+     * \param out  Receives the mangled name, identifiers with non-ASCII characters are written in UTF-8
+     * \return false if the symbol cannot be mangled
+     */
+    bool encode(const SymbolPtr& symbol, std::string& out);
+
+    /*!
+     * \brief Encode all symbols defined in given scope at once
+     * Overloaded functions and accessors of computed properties are expanded, symbols that cannot
+     * be mangled are skipped.
+     */
+    void encodeAll(SymbolScope* scope, std::vector<std::pair<SymbolPtr, std::string> >& results);
+    /*!
+     * \brief Encode the name of a generic function specialized with given argument types
+     * The name follows swift's generic specialization mangling, e.g. _TTSg5Si___TF4main2idU__FQ_Q_ for id<Int>
+     * \param name  Mangled name of the generic function
+     */
+    std::wstring encodeSpecialization(const std::wstring& name, const std::vector<TypePtr>& arguments);
 private:
-    void encodeType(std::wstringstream& out, const std::wstring& moduleName, const std::wstring& typeName);
+    bool encodeImpl(const SymbolPtr& symbol, std::string& out);
+    void encodeType(std::string& out, const TypePtr& type);
     void encodeType(ManglingContext& out, const TypePtr& type, bool wrapCollections = true);
     void defineAbbreviation(const TypePtr&, const std::wstring& abbrev);
     std::wstring encodeVariable(const SymbolPlaceHolderPtr& symbol);
+    const std::string& getDiscriminator(const std::wstring& moduleName);
+    const std::vector<TypePtr>& getSortedConstraints(const GenericDefinition::NodeDefPtr& node);
+    void resolve(SymbolScope* scope, const DemangledSymbol& demangled);
 
 private:
-    std::map<TypePtr, std::wstring> typeToName;
+    std::map<TypePtr, std::string> typeToName;
     std::map<std::wstring, TypePtr> nameToType;
+    /*!
+     * Context-free fragments cached across symbols: module-qualified names of nominal types,
+     * sorted protocol compositions, sorted generic constraints and private discriminator of modules
+     */
+    std::map<TypePtr, std::string> nominalNames;
+    std::map<TypePtr, std::string> compositions;
+    std::map<GenericDefinition::NodeDefPtr, std::vector<TypePtr> > constraints;
+    std::map<std::wstring, std::string> discriminators;
+    /*!
+     * Reusable buffer for the wide-string version of encode
+     */
+    std::string buffer;
+    /*!
+     * Reverse index from mangled name to symbol, filled by every successful encoding
+     */
+    std::unordered_map<std::string, SymbolPtr> symbols;
+    std::vector<SymbolScope*> scopes;
+    SymbolRegistry* registry;
+    Demangler demangler;
 
     void encodeGeneric(ManglingContext &context, const GenericDefinitionPtr &def);
 };
@@ -0,0 +1,148 @@
+/* BitVector.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+#include "swallow_conf.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+SWALLOW_NS_BEGIN
+
+    /*!
+     * A fixed size set of bits packed in 64-bit words, used as the lattice value of dataflow analyses.
+     * The bits beyond the size in the last word are always kept as zero.
+     */
+    class BitVector
+    {
+    public:
+        BitVector()
+        :numBits(0)
+        {
+        }
+        explicit BitVector(size_t numBits, bool value = false)
+        :words((numBits + 63) / 64, value ? ~(uint64_t)0 : 0), numBits(numBits)
+        {
+            clearUnusedBits();
+        }
+    public:
+        size_t size() const { return numBits;}
+        bool test(size_t bit) const
+        {
+            return (words[bit / 64] >> (bit % 64)) & 1;
+        }
+        void set(size_t bit, bool value = true)
+        {
+            if(value)
+                words[bit / 64] |= (uint64_t)1 << (bit % 64);
+            else
+                words[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+        }
+        void reset(size_t bit)
+        {
+            set(bit, false);
+        }
+        void setAll(bool value)
+        {
+            for(uint64_t& w : words)
+                w = value ? ~(uint64_t)0 : 0;
+            clearUnusedBits();
+        }
+        /*!
+         * Number of bits that are set
+         */
+        size_t count() const
+        {
+            size_t ret = 0;
+            for(uint64_t w : words)
+            {
+                for(; w; w &= w - 1)
+                    ret++;
+            }
+            return ret;
+        }
+        /*!
+         * this = this | rhs, returns true if this is changed
+         */
+        bool unite(const BitVector& rhs)
+        {
+            bool changed = false;
+            for(size_t i = 0; i < words.size(); i++)
+            {
+                uint64_t w = words[i] | rhs.words[i];
+                changed |= w != words[i];
+                words[i] = w;
+            }
+            return changed;
+        }
+        /*!
+         * this = this & rhs, returns true if this is changed
+         */
+        bool intersect(const BitVector& rhs)
+        {
+            bool changed = false;
+            for(size_t i = 0; i < words.size(); i++)
+            {
+                uint64_t w = words[i] & rhs.words[i];
+                changed |= w != words[i];
+                words[i] = w;
+            }
+            return changed;
+        }
+        /*!
+         * this = this & ~rhs
+         */
+        void subtract(const BitVector& rhs)
+        {
+            for(size_t i = 0; i < words.size(); i++)
+                words[i] &= ~rhs.words[i];
+        }
+        bool operator==(const BitVector& rhs) const
+        {
+            return numBits == rhs.numBits && words == rhs.words;
+        }
+        bool operator!=(const BitVector& rhs) const
+        {
+            return !(*this == rhs);
+        }
+    private:
+        void clearUnusedBits()
+        {
+            if(numBits % 64)
+                words.back() &= ((uint64_t)1 << (numBits % 64)) - 1;
+        }
+    private:
+        std::vector<uint64_t> words;
+        size_t numBits;
+    };
+
+SWALLOW_NS_END
+
+#endif//BIT_VECTOR_H
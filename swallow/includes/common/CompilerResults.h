@@ -31,8 +31,13 @@
 #define ERROR_LIST_H
 #include "swallow_conf.h"
 #include "swallow_types.h"
+#include "common/SourceIndex.h"
 #include <string>
 #include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <unordered_map>
 
 SWALLOW_NS_BEGIN
 
@@ -47,24 +52,81 @@ struct ErrorLevel
     };
 };
 typedef std::vector<std::wstring> ResultItems;
-struct CompilerResult : SourceInfo
+
+/*!
+ * Interned argument strings of compiler results, each distinct string is stored only once
+ * and referenced by its handle.
+ */
+class SWALLOW_EXPORT ResultStringPool
+{
+public:
+    unsigned int intern(const std::wstring& str);
+    const std::wstring& get(unsigned int handle) const {return strings[handle];}
+    size_t size() const { return strings.size();}
+private:
+    std::unordered_map<std::wstring, unsigned int> indices;
+    std::deque<std::wstring> strings;
+};
+
+/*!
+ * Arguments of a compiler result, a fixed number of handles into the string pool.
+ * The pool is shared so a copied result stays valid after its CompilerResults is cleared or destroyed.
+ */
+struct SWALLOW_EXPORT ResultArguments
+{
+    enum {MAX_ARGUMENTS = 4};
+
+    ResultArguments()
+    :count(0)
+    {}
+    size_t size() const { return count;}
+    bool empty() const { return count == 0;}
+    const std::wstring& operator[](size_t idx) const { return pool->get(handles[idx]);}
+    unsigned int handle(size_t idx) const { return handles[idx];}
+    std::vector<std::wstring> toVector() const;
+
+    std::shared_ptr<const ResultStringPool> pool;
+    unsigned int count;
+    unsigned int handles[MAX_ARGUMENTS];
+};
+
+struct SWALLOW_EXPORT CompilerResult : SourceInfo
 {
+    /*!
+     * Position resolved from the offset when the result is added
+     */
+    int line;
+    int column;
     ErrorLevel::T level;
     int code;
-    ResultItems items;
+    ResultArguments items;
 
-    
-    CompilerResult(ErrorLevel::T level, const SourceInfo& sourceInfo, int code, const ResultItems& items)
-    :level(level), code(code), items(items)
+    CompilerResult(ErrorLevel::T level, const SourceInfo& sourceInfo, int line, int column, int code, const ResultArguments& items)
+    :SourceInfo(sourceInfo), line(line), column(column), level(level), code(code), items(items)
     {
-        this->fileHash = sourceInfo.fileHash;
-        this->line = sourceInfo.line;
-        this->column = sourceInfo.column;
     }
+
+    /*!
+     * Renders the message into caller's buffer, see Errors::render
+     */
+    size_t render(wchar_t* buffer, size_t size) const;
+    /*!
+     * Renders the message into a new string
+     */
+    std::wstring format() const;
 };
 
+/*!
+ * Diagnostics collected during compilation.
+ *
+ * Results are stored as compact records(code, level, location and interned argument handles),
+ * messages are only rendered when requested. Duplicated results(same level, code, location and
+ * arguments) are dropped, and results beyond the limit are counted but not stored.
+ */
 class SWALLOW_EXPORT CompilerResults
 {
+public:
+    CompilerResults();
 public:
     void clear();
     int numResults() const;
@@ -72,10 +134,57 @@ public:
     void add(ErrorLevel::T level, const SourceInfo&, int code, const ResultItems& items);
     void add(ErrorLevel::T level, const SourceInfo&, int code, const std::wstring& item = std::wstring());
 
+    /*!
+     * Sets the line-start table of the source being compiled, the positions of results are resolved by it.
+     * Only the table is kept, the source buffer is not read after this call.
+     */
+    void setSourceIndex(const SourceIndex& index);
+    /*!
+     * Resolve the line and column of given position in the source being compiled
+     */
+    void getPosition(const SourceInfo& sourceInfo, int& line, int& column) const;
+    int getLine(const SourceInfo& sourceInfo) const;
+
+    /*!
+     * Sets the maximum number of results to keep, 0 means unlimited.
+     */
+    void setLimit(int limit);
+    int getLimit() const { return limit;}
+    /*!
+     * The limit used by the front ends, results after it are mostly cascaded from the earlier errors
+     */
+    static const int DefaultLimit = 100;
+    /*!
+     * Returns true if the limit is reached, further results will be discarded.
+     */
+    bool isFull() const;
+    /*!
+     * Number of results dropped by the limit or deduplication
+     */
+    int numDiscarded() const { return discarded;}
+
     std::vector<CompilerResult>::iterator begin() { return results.begin();}
     std::vector<CompilerResult>::iterator end() { return results.end();}
+    std::vector<CompilerResult>::const_iterator begin() const { return results.begin();}
+    std::vector<CompilerResult>::const_iterator end() const { return results.end();}
+private:
+    struct ResultKey
+    {
+        int level;
+        int code;
+        uint32_t offset;
+        unsigned int count;
+        unsigned int handles[ResultArguments::MAX_ARGUMENTS];
+        bool operator<(const ResultKey& rhs) const;
+    };
+    bool addResult(ErrorLevel::T level, const SourceInfo& sourceInfo, int code, const ResultArguments& args);
 private:
     std::vector<CompilerResult> results;
+    std::set<ResultKey> keys;
+    std::shared_ptr<ResultStringPool> strings;
+    SourceIndex sourceIndex;
+    int limit;
+    int discarded;
 };
 
 SWALLOW_NS_END
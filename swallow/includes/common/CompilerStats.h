@@ -0,0 +1,179 @@
+/* CompilerStats.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef COMPILER_STATS_H
+#define COMPILER_STATS_H
+#include "swallow_conf.h"
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+struct CompilerPhase
+{
+    enum T
+    {
+        Tokenize,
+        Parse,
+        OperatorResolution,
+        DeclarationAnalysis,
+        BodyAnalysis,
+        Specialization,
+        Mangling,
+        Count,
+        /*!
+         * Not in any phase
+         */
+        None = Count
+    };
+};
+
+struct CompilerCounter
+{
+    enum T
+    {
+        /*!
+         * Tokens read from tokenizer, tokens read again after the parser backtracks are also counted
+         */
+        Tokens,
+        Nodes,
+        /*!
+         * Symbol lookups in a single scope, looking up a name through the scope chain counts every scope visited
+         */
+        ScopeLookups,
+        /*!
+         * Overloaded functions scored against the arguments of a call
+         */
+        OverloadCandidates,
+        Specializations,
+        SpecializationCacheHits,
+        ManglingCacheHits,
+        Count
+    };
+};
+
+/*!
+ * \brief Time spent in each compiler phase and counters of the work done.
+ *
+ * The stats are collected on the thread that activates them by CompilerStatsScope, nothing is collected when
+ * no stats are active. Phase times are exclusive, entering a nested phase pauses the outer one, so the sum of
+ * all phases is the time spent in the compiler.
+ */
+class SWALLOW_EXPORT CompilerStats
+{
+    friend class CompilerStatsScope;
+    friend class PhaseTimer;
+public:
+    CompilerStats();
+public:
+    void reset();
+    /*!
+     * Adds the times and counters of another stats to this one
+     */
+    void merge(const CompilerStats& stats);
+    /*!
+     * Gets the time spent in given phase, in nanoseconds
+     */
+    uint64_t getTime(CompilerPhase::T phase) const { return times[phase];}
+    /*!
+     * Gets the time spent in all phases, in nanoseconds
+     */
+    uint64_t getTotalTime() const;
+    uint64_t getCount(CompilerCounter::T counter) const { return counters[counter];}
+
+    static const char* getPhaseName(CompilerPhase::T phase);
+    static const char* getCounterName(CompilerCounter::T counter);
+public:
+    /*!
+     * Gets the stats activated on current thread, or null
+     */
+    static CompilerStats* current() { return active;}
+    /*!
+     * Increases a counter of the stats activated on current thread
+     */
+    static void increase(CompilerCounter::T counter, uint64_t n = 1)
+    {
+        if(CompilerStats* stats = active)
+            stats->counters[counter] += n;
+    }
+private:
+    CompilerPhase::T enter(CompilerPhase::T phase);
+    void leave(CompilerPhase::T previous);
+private:
+    static thread_local CompilerStats* active;
+    uint64_t times[CompilerPhase::Count];
+    uint64_t counters[CompilerCounter::Count];
+    CompilerPhase::T phase;
+    uint64_t phaseStart;
+};
+
+/*!
+ * Activates the stats on current thread during its scope
+ */
+class SWALLOW_EXPORT CompilerStatsScope
+{
+public:
+    CompilerStatsScope(CompilerStats* stats)
+    :previous(CompilerStats::active)
+    {
+        CompilerStats::active = stats;
+    }
+    ~CompilerStatsScope()
+    {
+        CompilerStats::active = previous;
+    }
+private:
+    CompilerStats* previous;
+};
+
+/*!
+ * Accounts the time of its scope to given phase of the active stats.
+ * It's a no-op without active stats, or when the phase is already being timed.
+ */
+class SWALLOW_EXPORT PhaseTimer
+{
+public:
+    PhaseTimer(CompilerPhase::T phase)
+    :stats(CompilerStats::active), previous(phase)
+    {
+        if(stats)
+            previous = stats->enter(phase);
+    }
+    ~PhaseTimer()
+    {
+        if(stats)
+            stats->leave(previous);
+    }
+private:
+    CompilerStats* stats;
+    CompilerPhase::T previous;
+};
+
+SWALLOW_NS_END
+
+#endif//COMPILER_STATS_H
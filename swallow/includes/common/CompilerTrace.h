@@ -0,0 +1,165 @@
+/* CompilerTrace.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef COMPILER_TRACE_H
+#define COMPILER_TRACE_H
+#include "swallow_conf.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+struct TraceCategory
+{
+    enum T
+    {
+        File,
+        /*!
+         * A top-level statement or declaration, lazy declarations are traced when they're actually declared
+         */
+        Declaration,
+        FunctionBody,
+        Specialization,
+        OverloadResolution,
+        Count
+    };
+};
+
+struct TraceBuffer;
+
+/*!
+ * \brief Timeline of the compilation that can be viewed in chrome://tracing or Perfetto.
+ *
+ * Begin/end events are recorded on the threads that activate the trace by CompilerTraceScope, each thread
+ * writes to its own fixed-size ring buffer without locking, the oldest events are overwritten when the buffer
+ * is full. Nothing is recorded when no trace is active.
+ * The trace can only be written after all threads that record into it have finished.
+ */
+class SWALLOW_EXPORT CompilerTrace
+{
+    friend class CompilerTraceScope;
+    friend class TraceEvent;
+public:
+    /*!
+     * \param capacity Maximum events kept for each thread
+     */
+    CompilerTrace(size_t capacity = 1 << 16);
+    ~CompilerTrace();
+public:
+    /*!
+     * Gets the number of events kept in all threads
+     */
+    size_t getNumEvents() const;
+    /*!
+     * Gets the number of events overwritten since the ring buffers were full
+     */
+    uint64_t getDroppedEvents() const;
+
+    /*!
+     * Writes the events in Chrome's trace event format, timestamps are in microseconds since the trace is created.
+     * End events whose begin was overwritten are skipped.
+     */
+    void writeChromeTrace(std::ostream& out) const;
+
+    static const char* getCategoryName(TraceCategory::T category);
+    /*!
+     * Returns true if current thread is recording into a trace
+     */
+    static bool isActive() { return active != nullptr;}
+private:
+    /*!
+     * Gets the buffer of current thread, it's created when the thread uses this trace for the first time
+     */
+    TraceBuffer* getBuffer();
+    static void begin(TraceBuffer* buffer, TraceCategory::T category, const std::wstring& name, int line);
+    static void end(TraceBuffer* buffer);
+private:
+    static thread_local TraceBuffer* active;
+    std::mutex mutex;
+    std::vector<TraceBuffer*> buffers;
+    size_t capacity;
+    uint64_t origin;
+};
+
+/*!
+ * Activates the trace on current thread during its scope
+ */
+class SWALLOW_EXPORT CompilerTraceScope
+{
+public:
+    CompilerTraceScope(CompilerTrace* trace)
+    :previous(CompilerTrace::active)
+    {
+        CompilerTrace::active = trace ? trace->getBuffer() : nullptr;
+    }
+    ~CompilerTraceScope()
+    {
+        CompilerTrace::active = previous;
+    }
+private:
+    TraceBuffer* previous;
+};
+
+/*!
+ * Records a begin event to the active trace, and the end event when it goes out of scope.
+ */
+class SWALLOW_EXPORT TraceEvent
+{
+public:
+    TraceEvent(TraceCategory::T category, const std::wstring& name, int line = 0)
+    :buffer(CompilerTrace::active)
+    {
+        if(buffer)
+            CompilerTrace::begin(buffer, category, name, line);
+    }
+    /*!
+     * The name is only evaluated when a trace is active
+     */
+    template<class NameFunc>
+    TraceEvent(TraceCategory::T category, int line, const NameFunc& nameOf)
+    :buffer(CompilerTrace::active)
+    {
+        if(buffer)
+            CompilerTrace::begin(buffer, category, nameOf(), line);
+    }
+    ~TraceEvent()
+    {
+        if(buffer)
+            CompilerTrace::end(buffer);
+    }
+private:
+    TraceBuffer* buffer;
+};
+
+SWALLOW_NS_END
+
+#endif//COMPILER_TRACE_H
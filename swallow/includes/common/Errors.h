@@ -120,6 +120,7 @@ struct SWALLOW_EXPORT Errors
         E_A_IS_NOT_A_MEMBER_TYPE_OF_B_2, // '%0' is not a member type of '%2'
         E_TYPE_A_NESTED_IN_GENERIC_TYPE_B_IS_NOT_ALLOWED_2, //type '%0' nested in generic type '%1' is not allowed
         E_GENERIC_TYPE_A_NESTED_IN_TYPE_B_IS_NOT_ALLOWED_2, //generic type '%0' nested in type '%1' is not allowed
+        E_ARGUMENT_FOR_GENERIC_PARAMETER_A_COULD_NOT_BE_INFERRED_1, //Argument for generic parameter '%0' could not be inferred
 
         E_TUPLE_ACCESS_ONLY_WORKS_FOR_TUPLE_TYPE, //Tuple access only works for tuple type
         E_TUPLE_ACCESS_A_OUT_OF_RANGE_IN_B_2, //Tuple access '%0' out of range in '%1'
@@ -233,6 +234,20 @@ struct SWALLOW_EXPORT Errors
 
         E_A_MUST_BE_DECLARED_B_BECAUSE_ITS_C_USES_A_D_TYPE_4,//Method must be declared private because its result uses a private type
         E_A_CANNOT_BE_DECLARED_B_BECAUSE_ITS_C_USES_A_D_TYPE_4,//Property cannot be declared public because its type uses a private type
+        //constant folding errors
+        E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2,//arithmetic operation '%0' (on type '%1') results in an overflow
+        E_DIVISION_BY_ZERO,//division by zero
+        //IR lowering errors
+        E_A_IS_NOT_SUPPORTED_IN_IR_LOWERING_1,//'%0' is not supported in IR lowering
+        //evaluation errors
+        E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1,//'%0' is not supported in evaluation
+        E_ARRAY_INDEX_OUT_OF_RANGE,//array index out of range
+        E_CANNOT_REMOVE_LAST_ELEMENT_FROM_AN_EMPTY_COLLECTION,//can't removeLast from an empty collection
+        E_MAXIMUM_CALL_DEPTH_EXCEEDED,//maximum call depth exceeded
+        //C code generation errors
+        E_A_IS_NOT_SUPPORTED_IN_C_CODE_GENERATION_1,//'%0' is not supported in C code generation
+        //type checking limits
+        E_EXPRESSION_WAS_TOO_COMPLEX_A_OF_B_SPENT_HERE_2,//Expression was too complex to be solved in reasonable time, %0 of the maximum cost %1 was spent on this sub-expression
 
 
 
@@ -250,7 +265,16 @@ struct SWALLOW_EXPORT Errors
         //linking errors
     };
     static std::wstring format(int code, const std::vector<std::wstring>& items);
-    static std::wstring getErrorTemplate(int errorCode);
+    /*!
+     * Renders the message of given error code into caller's buffer, the output is
+     * truncated to fit in the buffer and always null-terminated when size > 0.
+     * Returns the full length of the message(excluding the terminator), like snprintf.
+     */
+    static size_t render(int code, const std::wstring* const* items, size_t numItems, wchar_t* buffer, size_t size);
+    /*!
+     * Returns the message template of given error code from the static template table
+     */
+    static const wchar_t* getErrorTemplate(int errorCode);
 };
 
 
@@ -0,0 +1,87 @@
+/* SourceIndex.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SOURCE_INDEX_H
+#define SOURCE_INDEX_H
+#include "swallow_conf.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * Line-start offset table of a source buffer.
+ *
+ * The table is built once by scanning the buffer for new lines, line and column
+ * of an offset are then recovered by a binary search.
+ * Lines and columns are 1-based, offsets are 0-based.
+ */
+class SWALLOW_EXPORT SourceIndex
+{
+public:
+    SourceIndex();
+    SourceIndex(const wchar_t* data, size_t size);
+    SourceIndex(const std::wstring& src);
+public:
+    /*!
+     * Rebuild the table for given buffer, the buffer must outlive the index
+     */
+    void reset(const wchar_t* data, size_t size);
+
+    int numLines() const;
+    /*!
+     * Gets the line of given offset
+     */
+    int getLine(uint32_t offset) const;
+    /*!
+     * Gets the line and column of given offset
+     */
+    void getPosition(uint32_t offset, int& line, int& column) const;
+    /*!
+     * Gets the offset of given line and column, returns the size of buffer if out of range
+     */
+    uint32_t getOffset(int line, int column) const;
+    /*!
+     * Gets the content of given line without the line terminator
+     */
+    std::wstring getLineContent(int line) const;
+    /*!
+     * Gets the content of given line without the line terminator, returns false if out of range.
+     */
+    bool getLineContent(int line, const wchar_t*& begin, size_t& length) const;
+private:
+    const wchar_t* data;
+    uint32_t size;
+    std::vector<uint32_t> lineStarts;
+};
+
+SWALLOW_NS_END
+
+#endif//SOURCE_INDEX_H
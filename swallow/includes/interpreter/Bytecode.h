@@ -0,0 +1,189 @@
+/* Bytecode.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef BYTECODE_H
+#define BYTECODE_H
+#include "Value.h"
+#include "swallow_types.h"
+#include <memory>
+#include <vector>
+#include <string>
+
+SWALLOW_NS_BEGIN
+
+struct RuntimeType;
+typedef std::shared_ptr<class Type> TypePtr;
+typedef std::shared_ptr<class FunctionSymbol> FunctionSymbolPtr;
+typedef std::shared_ptr<class ParameterNode> ParameterNodePtr;
+typedef std::shared_ptr<class CodeBlock> CodeBlockPtr;
+
+/*!
+ * Instructions of the register machine, R[n] is the n-th register of current frame.
+ * A call at register a moves the callee's frame to R[a], self or the first argument is passed in R[a],
+ * the rest in the following registers, and the result is returned in R[a].
+ */
+#define SWALLOW_BYTECODE_OPCODES(OP) \
+    OP(Move)            /* R[a] = R[b] */ \
+    OP(LoadInt)         /* R[a] = 32 bits immediate in b:c */ \
+    OP(LoadConst)       /* R[a] = constants[b] */ \
+    OP(LoadGlobal)      /* R[a] = globals[b] */ \
+    OP(StoreGlobal)     /* globals[b] = R[a] */ \
+    OP(LoadEnum)        /* R[a] = enum case b without payload */ \
+    OP(EnumIndex)       /* R[a] = case index of R[b] */ \
+    OP(AddInt)          /* R[a] = R[b] + R[c], Int with overflow check */ \
+    OP(SubInt) \
+    OP(MulInt) \
+    OP(AddIntImm)       /* R[a] = R[b] + signed 16 bits immediate c */ \
+    OP(LtInt)           /* R[a] = R[b] < R[c], Int */ \
+    OP(LeInt) \
+    OP(EqInt) \
+    OP(NeInt) \
+    OP(IntOp)           /* R[a] = R[b] op R[c], operator and integer format in x */ \
+    OP(IntCompare) \
+    OP(FloatOp)         /* R[a] = R[b] op R[c], operator in x, bit 5 of x is set for Float */ \
+    OP(FloatCompare) \
+    OP(Not)             /* R[a] = !R[b] */ \
+    OP(Jump)            /* goto c */ \
+    OP(JumpIfFalse)     /* if !R[a] goto c */ \
+    OP(JumpIfTrue)      /* if R[a] goto c */ \
+    OP(JumpIfNotLtInt)  /* if !(R[a] < R[b]) goto c */ \
+    OP(JumpIfNotLeInt)  /* if !(R[a] <= R[b]) goto c */ \
+    OP(Call)            /* call functions[b] at R[a] */ \
+    OP(CallVirtual)     /* call the override of functions[b] by self's type at R[a], inline cache c */ \
+    OP(Return)          /* return R[a] */ \
+    OP(ReturnVoid) \
+    OP(New)             /* R[a] = new instance of types[b] */ \
+    OP(GetField)        /* R[a] = R[b].fields[c] */ \
+    OP(SetField)        /* R[a].fields[b] = R[c], R[a] is made unique if x is set */ \
+    OP(AddressOf)       /* R[a] = &R[b] */ \
+    OP(GlobalAddress)   /* R[a] = &globals[b] */ \
+    OP(FieldAddress)    /* R[a] = &R[b].fields[c], R[b] is made unique if x is set */ \
+    OP(ElementAddress)  /* R[a] = &R[b][R[c]] */ \
+    OP(Load)            /* R[a] = *R[b] */ \
+    OP(Store)           /* *R[a] = R[b] */ \
+    OP(NewArray)        /* R[a] = [R[b], ..., R[b + c - 1]] */ \
+    OP(GetElement)      /* R[a] = R[b][R[c]] */ \
+    OP(SetElement)      /* R[a][R[b]] = R[c] */ \
+    OP(ArrayCount)      /* R[a] = R[b].count */ \
+    OP(ArrayAppend)     /* R[a].append(R[b]) */ \
+    OP(ArrayRemoveLast) /* R[a] = R[b].removeLast() */ \
+    OP(ToString)        /* R[a] = description of R[b] of type types[c], x = 1/2 for signed/unsigned integers */ \
+    OP(Concat)          /* R[a] = R[b] + R[c], strings, appended in place when a == b and the string is unique */ \
+    OP(StringEqual)     /* R[a] = (R[b] == R[c]) != x */
+
+struct BCOpcode
+{
+#define SWALLOW_BYTECODE_ENUM(name) name,
+    enum T : uint8_t
+    {
+        SWALLOW_BYTECODE_OPCODES(SWALLOW_BYTECODE_ENUM)
+        NumOpcodes
+    };
+#undef SWALLOW_BYTECODE_ENUM
+    static const char* getName(T opcode);
+};
+
+/*!
+ * Instruction in fixed 8 bytes, registers, indices and jump targets are 16 bits.
+ * Addresses of registers like inout parameters and self of mutating methods are read and written through
+ * Load/Store, field and element accesses dereference an address implicitly.
+ */
+struct BCInstruction
+{
+    BCOpcode::T opcode;
+    //sub-operation of generic instructions
+    uint8_t x;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+    int32_t getImmediate() const {return (int32_t)(((uint32_t)b << 16) | c);}
+};
+
+/*!
+ * Operator and integer format of IntOp/IntCompare packed in x, operator in bits 0-4,
+ * log2 of the size in bytes in bits 5-6 and the signedness in bit 7
+ */
+struct BCIntegerOperator
+{
+    static uint8_t encode(int op, int bits, bool isSigned)
+    {
+        int size = bits == 8 ? 0 : bits == 16 ? 1 : bits == 32 ? 2 : 3;
+        return (uint8_t)(op | (size << 5) | (isSigned ? 0x80 : 0));
+    }
+    static int getOperator(uint8_t x) {return x & 0x1f;}
+    static int getBits(uint8_t x) {return 8 << ((x >> 5) & 3);}
+    static bool isSigned(uint8_t x) {return (x & 0x80) != 0;}
+};
+
+struct BCFunction;
+
+/*!
+ * Polymorphic inline cache of a virtual call, keeps the overrides resolved for the last few receiver types.
+ * When all entries are taken, the oldest one is replaced.
+ */
+struct BCInlineCache
+{
+    static const int Size = 4;
+    RuntimeType* types[Size];
+    BCFunction* targets[Size];
+    uint8_t next;
+};
+
+/*!
+ * A compiled function, top-level statements are also compiled into functions without parameters
+ */
+struct BCFunction
+{
+    BCFunction() : index(0), owner(nullptr), numParameters(0), numRegisters(1), hasSelf(false), selfByAddress(false), isInit(false) {}
+    std::wstring name;
+    FunctionSymbolPtr symbol;
+    uint16_t index;
+    //the type that declares the method
+    RuntimeType* owner;
+    //parameter declarations and body, used to compile the function
+    std::vector<ParameterNodePtr> parameters;
+    CodeBlockPtr body;
+    //self and parameters take the first registers
+    int numParameters;
+    int numRegisters;
+    bool hasSelf;
+    //self of mutating methods of value types is passed by address
+    bool selfByAddress;
+    bool isInit;
+    std::vector<BCInstruction> code;
+    //source location of each instruction, used by runtime errors
+    std::vector<SourceInfo> sourceInfos;
+    std::vector<Value> constants;
+    std::vector<TypePtr> types;
+    std::vector<BCInlineCache> caches;
+};
+
+SWALLOW_NS_END
+
+#endif//BYTECODE_H
@@ -0,0 +1,201 @@
+/* BytecodeCompiler.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef BYTECODE_COMPILER_H
+#define BYTECODE_COMPILER_H
+#include "Bytecode.h"
+#include "ast/NodeVisitor.h"
+#include <unordered_map>
+
+SWALLOW_NS_BEGIN
+
+class VirtualMachine;
+class CompilerResults;
+class GlobalScope;
+class SymbolScope;
+class Symbol;
+struct IntegerFormat;
+typedef std::shared_ptr<Symbol> SymbolPtr;
+typedef std::shared_ptr<class TypeDeclaration> TypeDeclarationPtr;
+typedef std::shared_ptr<class ScopedProgram> ScopedProgramPtr;
+
+/*!
+ * \brief Compiles the type-checked AST into the bytecode of VirtualMachine.
+ *
+ * An expression is compiled into a destination register given by the caller, local variables and parameters are
+ * allocated in registers, temporary registers are released after each statement.
+ */
+class SWALLOW_EXPORT BytecodeCompiler : public NodeVisitor
+{
+    struct Loop
+    {
+        //break in switch leaves the switch, continue goes to the enclosing loop
+        bool isSwitch;
+        std::vector<size_t> breaks;
+        std::vector<size_t> continues;
+    };
+    struct FunctionState
+    {
+        BCFunction* function;
+        TypePtr selfType;
+        int top;
+        std::vector<SymbolScope*> scopes;
+        std::unordered_map<Symbol*, int> locals;
+        std::vector<Loop> loops;
+    };
+public:
+    BytecodeCompiler(VirtualMachine* vm, CompilerResults* compilerResults);
+public:
+    /*!
+     * Compiles the top-level statements into a function for each, the value of an expression statement is returned.
+     * Functions and types declared by the program are compiled as well.
+     */
+    void compileProgram(const ScopedProgramPtr& program, std::vector<std::unique_ptr<BCFunction>>& statements);
+public://declarations
+    virtual void visitValueBindings(const ValueBindingsPtr& node) override;
+    virtual void visitComputedProperty(const ComputedPropertyPtr& node) override;
+    virtual void visitClass(const ClassDefPtr& node) override;
+    virtual void visitStruct(const StructDefPtr& node) override;
+    virtual void visitEnum(const EnumDefPtr& node) override;
+    virtual void visitExtension(const ExtensionDefPtr& node) override;
+    virtual void visitProtocol(const ProtocolDefPtr& node) override;
+    virtual void visitFunction(const FunctionDefPtr& node) override;
+    virtual void visitDeinit(const DeinitializerDefPtr& node) override;
+    virtual void visitInit(const InitializerDefPtr& node) override;
+    virtual void visitSubscript(const SubscriptDefPtr& node) override;
+    virtual void visitTypeAlias(const TypeAliasPtr& node) override;
+    virtual void visitImport(const ImportPtr& node) override;
+    virtual void visitOperator(const OperatorDefPtr& node) override;
+public://statements
+    virtual void visitWhileLoop(const WhileLoopPtr& node) override;
+    virtual void visitForIn(const ForInLoopPtr& node) override;
+    virtual void visitForLoop(const ForLoopPtr& node) override;
+    virtual void visitDoLoop(const DoLoopPtr& node) override;
+    virtual void visitLabeledStatement(const LabeledStatementPtr& node) override;
+    virtual void visitBreak(const BreakStatementPtr& node) override;
+    virtual void visitReturn(const ReturnStatementPtr& node) override;
+    virtual void visitContinue(const ContinueStatementPtr& node) override;
+    virtual void visitFallthrough(const FallthroughStatementPtr& node) override;
+    virtual void visitIf(const IfStatementPtr& node) override;
+    virtual void visitSwitchCase(const SwitchCasePtr& node) override;
+    virtual void visitCodeBlock(const CodeBlockPtr& node) override;
+public://expressions
+    virtual void visitAssignment(const AssignmentPtr& node) override;
+    virtual void visitArrayLiteral(const ArrayLiteralPtr& node) override;
+    virtual void visitDictionaryLiteral(const DictionaryLiteralPtr& node) override;
+    virtual void visitConditionalOperator(const ConditionalOperatorPtr& node) override;
+    virtual void visitBinaryOperator(const BinaryOperatorPtr& node) override;
+    virtual void visitUnaryOperator(const UnaryOperatorPtr& node) override;
+    virtual void visitTuple(const TuplePtr& node) override;
+    virtual void visitIdentifier(const IdentifierPtr& node) override;
+    virtual void visitCompileConstant(const CompileConstantPtr& node) override;
+    virtual void visitSubscriptAccess(const SubscriptAccessPtr& node) override;
+    virtual void visitMemberAccess(const MemberAccessPtr& node) override;
+    virtual void visitFunctionCall(const FunctionCallPtr& node) override;
+    virtual void visitClosure(const ClosurePtr& node) override;
+    virtual void visitSelf(const SelfExpressionPtr& node) override;
+    virtual void visitInitializerReference(const InitializerReferencePtr& node) override;
+    virtual void visitDynamicType(const DynamicTypePtr& node) override;
+    virtual void visitForcedValue(const ForcedValuePtr& node) override;
+    virtual void visitOptionalChaining(const OptionalChainingPtr& node) override;
+    virtual void visitParenthesizedExpression(const ParenthesizedExpressionPtr& node) override;
+    virtual void visitString(const StringLiteralPtr& node) override;
+    virtual void visitStringInterpolation(const StringInterpolationPtr& node) override;
+    virtual void visitInteger(const IntegerLiteralPtr& node) override;
+    virtual void visitFloat(const FloatLiteralPtr& node) override;
+    virtual void visitBooleanLiteral(const BooleanLiteralPtr& node) override;
+    virtual void visitNilLiteral(const NilLiteralPtr& node) override;
+private://declarations
+    void unsupported(const NodePtr& node, const std::wstring& what);
+    BCFunction* declareFunction(const FunctionSymbolPtr& symbol, RuntimeType* owner, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body);
+    void declareStatement(const StatementPtr& statement);
+    void declareType(const TypeDeclarationPtr& node);
+    void compileType(const TypeDeclarationPtr& node);
+    void compileFunction(BCFunction* function);
+    void compileFieldInitializer(RuntimeType* type, BCFunction* function);
+private://code generation
+    size_t emit(BCOpcode::T opcode, int a = 0, int b = 0, int c = 0, int x = 0);
+    void emitLoadConstant(int dst, const Value& value);
+    void patch(size_t jump);
+    void patchTo(size_t jump, size_t target);
+    int allocate(int count = 1);
+    int declareLocal(const SymbolPtr& symbol);
+    /*!
+     * Register of the current expression's result, a temporary register is allocated if the result is not used
+     */
+    int destination();
+    SymbolPtr lookupLocal(const std::wstring& name);
+private://statements
+    void compileStatement(const StatementPtr& statement);
+    void compileStatements(const CodeBlockPtr& codeBlock);
+    void compileJumps(std::vector<size_t>& jumps, size_t target);
+    /*!
+     * Compiles a jump that's taken if the condition is false, returns the jump to be patched
+     */
+    size_t compileJumpIfFalse(const ExpressionPtr& condition);
+private://expressions
+    void compileExpression(const PatternPtr& expr, int dst);
+    /*!
+     * Gets a register that holds the value of expression, a local variable is used in place
+     */
+    int compileOperand(const ExpressionPtr& expr);
+    /*!
+     * Gets a register that holds the value or the address of a variable, fields and elements are read through it
+     * without copying the value
+     */
+    int compileBase(const ExpressionPtr& expr);
+    /*!
+     * Gets a register that holds the storage of expression, or its address if isAddress is set
+     */
+    int compilePlace(const ExpressionPtr& expr, bool& isAddress);
+    int compileAddress(const ExpressionPtr& expr);
+    int getFieldIndex(const TypePtr& type, const SymbolPtr& field);
+    void compileSelf(const NodePtr& node, int dst);
+    void compileCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    void compileConstruct(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    void compileInstance(RuntimeType* type, int dst);
+    void compileArrayMethod(const ExpressionPtr& node, const std::wstring& name, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    bool isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+    void compileBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+    void compileIncrement(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& operand, const IntegerFormat& format);
+private:
+    VirtualMachine* vm;
+    CompilerResults* compilerResults;
+    GlobalScope* global;
+    FunctionState* state;
+    //destination register of the expression being compiled, -1 if the result is not used
+    int target;
+    //source location of the instructions being emitted
+    SourceInfo sourceInfo;
+    std::vector<BCFunction*> pending;
+};
+
+SWALLOW_NS_END
+
+#endif//BYTECODE_COMPILER_H
@@ -0,0 +1,271 @@
+/* Evaluator.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+#include "ast/NodeVisitor.h"
+#include "interpreter/Executable.h"
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+class SymbolScope;
+class CompilerResults;
+class GlobalScope;
+typedef std::shared_ptr<class TypeDeclaration> TypeDeclarationPtr;
+typedef std::shared_ptr<class ScopedProgram> ScopedProgramPtr;
+
+/*!
+ * \brief Executes a type-checked program by walking a tree compiled from the AST.
+ *
+ * Top-level statements are compiled and run one by one, functions and methods are compiled when their
+ * declarations are met, so the REPL can keep the state across the evaluations.
+ * Identifiers are resolved at compile time by the roles of their symbols: locals and parameters to the slots
+ * of the frame, top-level variables to global storages, and variables of enclosing functions to the upvalues
+ * of the closure. A variable captured by closures is kept in a box.
+ *
+ * Constructs that are not supported are reported as E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, runtime errors abort
+ * the evaluation with an error reported at the failed expression.
+ */
+class SWALLOW_EXPORT Evaluator : public NodeVisitor
+{
+    struct FunctionContext;
+    struct Local
+    {
+        enum Kind
+        {
+            Direct,
+            //slot holds a box of captured variable
+            Boxed,
+            //slot holds the address of an inout parameter or self of mutating method
+            Address
+        };
+        int slot;
+        Kind kind;
+    };
+    struct Global
+    {
+        SymbolPtr symbol;
+        Value* storage;
+    };
+    struct StackChunk
+    {
+        std::unique_ptr<Value[]> values;
+        size_t size;
+    };
+public:
+    /*!
+     * Maximum depth of nested calls
+     */
+    static const int MaxCallDepth = 10000;
+public:
+    Evaluator(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults);
+    ~Evaluator();
+public:
+    /*!
+     * Changes the compiler results that errors are reported to
+     */
+    void setCompilerResults(CompilerResults* compilerResults);
+    /*!
+     * Evaluates the top-level statements of the program.
+     * A value for each statement is appended to results if it's given, statements that are not expressions produce Void.
+     * Returns false if it failed to compile or run.
+     */
+    bool evaluate(const ScopedProgramPtr& program, std::vector<Value>* results = nullptr);
+    /*!
+     * Gets the storage of a top-level variable, nullptr if it's not evaluated yet
+     */
+    Value* getGlobal(const SymbolPtr& symbol);
+    /*!
+     * Formats the value of given type, strings are quoted as literal if literal is true.
+     */
+    std::wstring toString(const Value& value, const TypePtr& type, bool literal = true);
+public://shared with other backends
+    /*!
+     * Formats the value of given type without an evaluator, instances are formatted by their runtime types
+     */
+    static std::wstring toString(GlobalScope* global, const Value& value, const TypePtr& type, bool literal = true);
+    /*!
+     * Gets the representation of a standard integer type, returns false if it's not an integer type
+     */
+    static bool getIntegerFormat(GlobalScope* global, const TypePtr& type, IntegerFormat& format);
+    static bool isFloating(GlobalScope* global, const TypePtr& type);
+public://used by executable nodes
+    /*!
+     * Reports a runtime error and aborts the evaluation
+     */
+    void runtimeError(const SourceInfo& sourceInfo, int code, const std::wstring& item1 = std::wstring(), const std::wstring& item2 = std::wstring());
+    /*!
+     * Calls the compiled function with the arguments stored in slots
+     */
+    Value invoke(Function* function, Value* slots, ClosureObject* closure, const SourceInfo& sourceInfo);
+    /*!
+     * Allocates slots for a call, they're released in reversed order
+     */
+    Value* allocateSlots(int count);
+    void releaseSlots(Value* slots, int count);
+    /*!
+     * Finds the method that overrides given method in the type, used by dynamic dispatch
+     */
+    Function* findOverride(RuntimeType* type, Function* method);
+    /*!
+     * Initializes the stored properties of a new instance by their initial values, inherited properties first
+     */
+    void initializeFields(RuntimeType* type, Value& self);
+    /*!
+     * Runs the deinitializers of a class instance
+     */
+    void deinitialize(InstanceObject* instance);
+public://declarations
+    virtual void visitValueBindings(const ValueBindingsPtr& node) override;
+    virtual void visitComputedProperty(const ComputedPropertyPtr& node) override;
+    virtual void visitClass(const ClassDefPtr& node) override;
+    virtual void visitStruct(const StructDefPtr& node) override;
+    virtual void visitEnum(const EnumDefPtr& node) override;
+    virtual void visitExtension(const ExtensionDefPtr& node) override;
+    virtual void visitProtocol(const ProtocolDefPtr& node) override;
+    virtual void visitFunction(const FunctionDefPtr& node) override;
+    virtual void visitDeinit(const DeinitializerDefPtr& node) override;
+    virtual void visitInit(const InitializerDefPtr& node) override;
+    virtual void visitSubscript(const SubscriptDefPtr& node) override;
+    virtual void visitTypeAlias(const TypeAliasPtr& node) override;
+    virtual void visitImport(const ImportPtr& node) override;
+    virtual void visitOperator(const OperatorDefPtr& node) override;
+public://statements
+    virtual void visitWhileLoop(const WhileLoopPtr& node) override;
+    virtual void visitForIn(const ForInLoopPtr& node) override;
+    virtual void visitForLoop(const ForLoopPtr& node) override;
+    virtual void visitDoLoop(const DoLoopPtr& node) override;
+    virtual void visitLabeledStatement(const LabeledStatementPtr& node) override;
+    virtual void visitBreak(const BreakStatementPtr& node) override;
+    virtual void visitReturn(const ReturnStatementPtr& node) override;
+    virtual void visitContinue(const ContinueStatementPtr& node) override;
+    virtual void visitFallthrough(const FallthroughStatementPtr& node) override;
+    virtual void visitIf(const IfStatementPtr& node) override;
+    virtual void visitSwitchCase(const SwitchCasePtr& node) override;
+    virtual void visitCodeBlock(const CodeBlockPtr& node) override;
+public://expressions
+    virtual void visitAssignment(const AssignmentPtr& node) override;
+    virtual void visitArrayLiteral(const ArrayLiteralPtr& node) override;
+    virtual void visitDictionaryLiteral(const DictionaryLiteralPtr& node) override;
+    virtual void visitConditionalOperator(const ConditionalOperatorPtr& node) override;
+    virtual void visitBinaryOperator(const BinaryOperatorPtr& node) override;
+    virtual void visitUnaryOperator(const UnaryOperatorPtr& node) override;
+    virtual void visitTuple(const TuplePtr& node) override;
+    virtual void visitIdentifier(const IdentifierPtr& node) override;
+    virtual void visitCompileConstant(const CompileConstantPtr& node) override;
+    virtual void visitSubscriptAccess(const SubscriptAccessPtr& node) override;
+    virtual void visitMemberAccess(const MemberAccessPtr& node) override;
+    virtual void visitFunctionCall(const FunctionCallPtr& node) override;
+    virtual void visitClosure(const ClosurePtr& node) override;
+    virtual void visitSelf(const SelfExpressionPtr& node) override;
+    virtual void visitInitializerReference(const InitializerReferencePtr& node) override;
+    virtual void visitDynamicType(const DynamicTypePtr& node) override;
+    virtual void visitForcedValue(const ForcedValuePtr& node) override;
+    virtual void visitOptionalChaining(const OptionalChainingPtr& node) override;
+    virtual void visitParenthesizedExpression(const ParenthesizedExpressionPtr& node) override;
+    virtual void visitString(const StringLiteralPtr& node) override;
+    virtual void visitStringInterpolation(const StringInterpolationPtr& node) override;
+    virtual void visitInteger(const IntegerLiteralPtr& node) override;
+    virtual void visitFloat(const FloatLiteralPtr& node) override;
+    virtual void visitBooleanLiteral(const BooleanLiteralPtr& node) override;
+    virtual void visitNilLiteral(const NilLiteralPtr& node) override;
+private://declarations
+    void unsupported(const NodePtr& node, const std::wstring& what);
+    RuntimeType* getRuntimeType(const TypePtr& type);
+    Function* declareFunction(const FunctionSymbolPtr& symbol, RuntimeType* owner, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body);
+    Function* getFunction(const FunctionSymbolPtr& symbol);
+    void declareStatement(const StatementPtr& statement);
+    void declareType(const TypeDeclarationPtr& node);
+    ExecNodePtr compileType(const TypeDeclarationPtr& node);
+    void compilePending();
+private://functions
+    void compileFunction(Function* function, FunctionContext* parent, std::vector<ExecMakeClosure::Capture>* captures = nullptr);
+    void compileBody(Function* function);
+    void compileFieldInitializer(RuntimeType* type);
+    Local declareLocal(const SymbolPtr& symbol);
+    SymbolPtr lookupLocal(const std::wstring& name);
+    Value* getGlobalStorage(const SymbolPtr& symbol);
+    int resolveUpvalue(FunctionContext* context, Symbol* symbol, const NodePtr& node);
+    Function* getClosureFunction(const NodePtr& node);
+private://statements
+    ExecNodePtr compileStatement(const StatementPtr& statement);
+    ExecNodePtr compileStatements(const CodeBlockPtr& codeBlock);
+    ExecNodePtr compileSwitchOnEnum(const SwitchCasePtr& node);
+    void bindPayload(const PatternPtr& pattern, ExecExpressionPtr payload, const TypePtr& type, ExecBlock* block);
+private://expressions
+    ExecExpressionPtr compileExpression(const PatternPtr& expr);
+    ExecLValuePtr compileLValue(const ExpressionPtr& expr);
+    ExecExpressionPtr compileCondition(const ExpressionPtr& expr);
+    ExecLValuePtr compileVariable(const SymbolPtr& symbol, const NodePtr& node);
+    ExecLValuePtr compileSelf(const NodePtr& node);
+    ExecExpressionPtr compileField(ExecExpressionPtr base, const TypePtr& baseType, int index);
+    ExecExpressionPtr compileCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    ExecExpressionPtr compileConstruct(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    ExecExpressionPtr compileArrayMethod(const ExpressionPtr& node, const std::wstring& name, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    ExecExpressionPtr compileBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+    void compileArguments(ExecCall* call, const TypePtr& type, const std::vector<ExpressionPtr>& arguments);
+    ExecExpressionPtr compileEnumCase(const TypePtr& type, const std::wstring& name, ExecExpressionPtr payload);
+    bool isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+private://runtime
+    static std::wstring toString(GlobalScope* global, const Value& value, const TypePtr& type, bool literal, std::unordered_set<Object*>& visiting);
+private:
+    SymbolRegistry* symbolRegistry;
+    CompilerResults* compilerResults;
+    GlobalScope* global;
+    FunctionContext* ctx;
+    SymbolScope* programScope;
+    ExecNodePtr result;
+    std::vector<std::unique_ptr<Function> > functions;
+    std::unordered_map<FunctionSymbol*, Function*> functionsBySymbol;
+    //functions of closures and local functions, reused when the enclosing function is compiled again
+    std::unordered_map<Node*, Function*> closures;
+    std::vector<Function*> pending;
+    std::unordered_map<Type*, std::unique_ptr<RuntimeType> > types;
+    std::unordered_map<Symbol*, Global> globals;
+    std::deque<Value> globalStorages;
+    //variables that are captured by closures
+    std::unordered_set<Symbol*> capturedSymbols;
+    //slots of the frames being called
+    std::vector<StackChunk> stack;
+    size_t stackChunk;
+    size_t stackTop;
+    //tops of the previous chunks
+    std::vector<size_t> savedTops;
+    int depth;
+};
+
+SWALLOW_NS_END
+
+#endif//EVALUATOR_H
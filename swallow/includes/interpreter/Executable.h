@@ -0,0 +1,708 @@
+/* Executable.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef EXECUTABLE_H
+#define EXECUTABLE_H
+#include "Value.h"
+#include "swallow_types.h"
+#include <memory>
+#include <unordered_map>
+
+SWALLOW_NS_BEGIN
+
+class Evaluator;
+typedef std::shared_ptr<class Type> TypePtr;
+typedef std::shared_ptr<class Symbol> SymbolPtr;
+typedef std::shared_ptr<class FunctionSymbol> FunctionSymbolPtr;
+typedef std::shared_ptr<class ParameterNode> ParameterNodePtr;
+typedef std::shared_ptr<class CodeBlock> CodeBlockPtr;
+typedef std::shared_ptr<class Closure> ClosurePtr;
+
+/*!
+ * How a statement completes
+ */
+struct Flow
+{
+    enum T
+    {
+        Normal,
+        Break,
+        Continue,
+        Return
+    };
+};
+
+/*!
+ * Activation record of a function call
+ */
+struct Frame
+{
+    Evaluator* evaluator;
+    //parameters come first, then self and local variables
+    Value* slots;
+    //the closure being called, its captures are the upvalues
+    ClosureObject* closure;
+    Value result;
+};
+
+/*!
+ * \brief A node of the executable tree that Evaluator compiles from the typed AST.
+ *
+ * Symbols are resolved to slots at compile time, executing a node never looks up a name.
+ */
+class SWALLOW_EXPORT ExecNode
+{
+public:
+    virtual ~ExecNode(){}
+public:
+    virtual Flow::T execute(Frame& frame) = 0;
+};
+typedef std::unique_ptr<ExecNode> ExecNodePtr;
+
+/*!
+ * Expressions have typed entry points, nodes that know the type of their result override them
+ * to avoid constructing a Value.
+ */
+class SWALLOW_EXPORT ExecExpression : public ExecNode
+{
+public:
+    virtual Value evaluate(Frame& frame) = 0;
+    virtual int64_t evaluateInt(Frame& frame) {return evaluate(frame).i;}
+    virtual double evaluateDouble(Frame& frame) {return evaluate(frame).d;}
+    virtual bool evaluateBool(Frame& frame) {return evaluate(frame).i != 0;}
+    virtual Flow::T execute(Frame& frame) override
+    {
+        evaluate(frame);
+        return Flow::Normal;
+    }
+};
+typedef std::unique_ptr<ExecExpression> ExecExpressionPtr;
+
+/*!
+ * Expression that denotes a storage
+ */
+class SWALLOW_EXPORT ExecLValue : public ExecExpression
+{
+public:
+    /*!
+     * Gets the address of the storage, value types along the path are made unique so the storage can be modified.
+     * The object that holds the storage is kept in owner during the access.
+     */
+    virtual Value* getAddress(Frame& frame, Value& owner) = 0;
+    /*!
+     * Reads the storage without making it unique
+     */
+    virtual const Value& read(Frame& frame, Value& owner) = 0;
+    virtual Value evaluate(Frame& frame) override
+    {
+        Value owner;
+        return read(frame, owner);
+    }
+};
+typedef std::unique_ptr<ExecLValue> ExecLValuePtr;
+
+/*!
+ * A compiled function
+ */
+struct Function
+{
+    Function() : owner(nullptr), numParameters(0), numSlots(0), selfSlot(-1), isInit(false) {}
+    std::wstring name;
+    FunctionSymbolPtr symbol;
+    //the type that declares the method
+    RuntimeType* owner;
+    //parameter declarations and body of a function, or the closure, used to compile the function
+    std::vector<ParameterNodePtr> parameters;
+    CodeBlockPtr body;
+    ClosurePtr closure;
+    ExecNodePtr code;
+    int numParameters;
+    int numSlots;
+    //slot of self, -1 for functions without self
+    int selfSlot;
+    bool isInit;
+};
+
+/*!
+ * Runtime information of a struct/class/enum
+ */
+struct RuntimeType
+{
+    RuntimeType() : parent(nullptr), fieldInitializer(nullptr), deinit(nullptr), evaluator(nullptr) {}
+    TypePtr type;
+    RuntimeType* parent;
+    //stored properties in the layout of instance, inherited properties come first
+    std::vector<SymbolPtr> fields;
+    //initial values of stored properties declared by this type, self is passed by address
+    Function* fieldInitializer;
+    Function* deinit;
+    Evaluator* evaluator;
+    //overrides of the methods that are dispatched dynamically
+    std::unordered_map<Symbol*, Function*> methods;
+    int getFieldIndex(const SymbolPtr& field) const;
+};
+
+/*!
+ * Allocates the slots of a frame from the evaluator's stack, they're released when it goes out of scope
+ */
+struct SWALLOW_EXPORT SlotsGuard
+{
+    SlotsGuard(Evaluator* evaluator, int count);
+    ~SlotsGuard();
+    Evaluator* evaluator;
+    Value* slots;
+    int count;
+};
+
+/*********************************************************************
+ * Statements
+ *********************************************************************/
+
+class SWALLOW_EXPORT ExecBlock : public ExecNode
+{
+public:
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    std::vector<ExecNodePtr> statements;
+};
+
+class SWALLOW_EXPORT ExecIf : public ExecNode
+{
+public:
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    ExecExpressionPtr condition;
+    ExecNodePtr thenPart;
+    ExecNodePtr elsePart;
+};
+
+/*!
+ * while/do-while/for loops, the condition is tested before the body unless it's a do-while
+ */
+class SWALLOW_EXPORT ExecLoop : public ExecNode
+{
+public:
+    ExecLoop() : testFirst(true) {}
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    ExecExpressionPtr condition;
+    ExecNodePtr body;
+    ExecNodePtr step;
+    bool testFirst;
+};
+
+class SWALLOW_EXPORT ExecReturn : public ExecNode
+{
+public:
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    ExecExpressionPtr value;
+};
+
+/*!
+ * break/continue
+ */
+class SWALLOW_EXPORT ExecJump : public ExecNode
+{
+public:
+    ExecJump(Flow::T flow) : flow(flow) {}
+    virtual Flow::T execute(Frame& frame) override {return flow;}
+public:
+    Flow::T flow;
+};
+
+/*!
+ * Initializes a local variable, a captured variable is stored in a new box every time it's declared
+ */
+class SWALLOW_EXPORT ExecDeclare : public ExecNode
+{
+public:
+    ExecDeclare(int slot, bool boxed) : slot(slot), boxed(boxed) {}
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    int slot;
+    bool boxed;
+    ExecExpressionPtr initializer;
+};
+
+/*!
+ * The control value is kept in a slot, case bodies bind the associated values from it.
+ * Enum cases are dispatched by the case index, other values are compared with the patterns in order.
+ */
+class SWALLOW_EXPORT ExecSwitch : public ExecNode
+{
+public:
+    ExecSwitch() : slot(0), isEnum(false), defaultCase(-1) {}
+    virtual Flow::T execute(Frame& frame) override;
+public:
+    ExecExpressionPtr control;
+    int slot;
+    bool isEnum;
+    //enum case index to the index of case body
+    std::unordered_map<uint32_t, int> enumCases;
+    //patterns and the index of case body
+    std::vector<std::pair<ExecExpressionPtr, int> > patterns;
+    std::vector<ExecNodePtr> bodies;
+    int defaultCase;
+};
+
+/*********************************************************************
+ * Storage
+ *********************************************************************/
+
+class SWALLOW_EXPORT ExecLocal : public ExecLValue
+{
+public:
+    ExecLocal(int slot) : slot(slot) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override {return &frame.slots[slot];}
+    virtual const Value& read(Frame& frame, Value& owner) override {return frame.slots[slot];}
+    virtual Value evaluate(Frame& frame) override {return frame.slots[slot];}
+    virtual int64_t evaluateInt(Frame& frame) override {return frame.slots[slot].i;}
+    virtual double evaluateDouble(Frame& frame) override {return frame.slots[slot].d;}
+    virtual bool evaluateBool(Frame& frame) override {return frame.slots[slot].i != 0;}
+public:
+    int slot;
+};
+
+/*!
+ * Local variable whose slot holds a box or an address
+ */
+class SWALLOW_EXPORT ExecIndirect : public ExecLValue
+{
+public:
+    ExecIndirect(int slot) : slot(slot) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override {return frame.slots[slot].getReferent();}
+    virtual const Value& read(Frame& frame, Value& owner) override {return *frame.slots[slot].getReferent();}
+    virtual int64_t evaluateInt(Frame& frame) override {return frame.slots[slot].getReferent()->i;}
+    virtual double evaluateDouble(Frame& frame) override {return frame.slots[slot].getReferent()->d;}
+    virtual bool evaluateBool(Frame& frame) override {return frame.slots[slot].getReferent()->i != 0;}
+public:
+    int slot;
+};
+
+/*!
+ * Variable captured by the closure being called
+ */
+class SWALLOW_EXPORT ExecUpvalue : public ExecLValue
+{
+public:
+    ExecUpvalue(int index) : index(index) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override {return frame.closure->captures[index].getReferent();}
+    virtual const Value& read(Frame& frame, Value& owner) override {return *frame.closure->captures[index].getReferent();}
+    virtual int64_t evaluateInt(Frame& frame) override {return frame.closure->captures[index].getReferent()->i;}
+public:
+    int index;
+};
+
+class SWALLOW_EXPORT ExecGlobal : public ExecLValue
+{
+public:
+    ExecGlobal(Value* storage) : storage(storage) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override {return storage;}
+    virtual const Value& read(Frame& frame, Value& owner) override {return *storage;}
+    virtual Value evaluate(Frame& frame) override {return *storage;}
+    virtual int64_t evaluateInt(Frame& frame) override {return storage->i;}
+    virtual double evaluateDouble(Frame& frame) override {return storage->d;}
+    virtual bool evaluateBool(Frame& frame) override {return storage->i != 0;}
+public:
+    Value* storage;
+};
+
+/*!
+ * Stored property of struct/tuple, the base is modified in place
+ */
+class SWALLOW_EXPORT ExecField : public ExecLValue
+{
+public:
+    ExecField(ExecLValue* base, int index) : base(base), index(index) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override;
+    virtual const Value& read(Frame& frame, Value& owner) override;
+public:
+    ExecLValuePtr base;
+    int index;
+};
+
+/*!
+ * Stored property of a class instance, or of a temporary struct/tuple
+ */
+class SWALLOW_EXPORT ExecReferenceField : public ExecLValue
+{
+public:
+    ExecReferenceField(ExecExpression* base, int index) : base(base), index(index) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override;
+    virtual const Value& read(Frame& frame, Value& owner) override;
+public:
+    ExecExpressionPtr base;
+    int index;
+};
+
+class SWALLOW_EXPORT ExecAssign : public ExecExpression
+{
+public:
+    ExecAssign(ExecLValue* target, ExecExpression* value) : target(target), value(value) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    ExecLValuePtr target;
+    ExecExpressionPtr value;
+};
+
+/*********************************************************************
+ * Operators
+ *********************************************************************/
+
+/*!
+ * Representation of the standard integer types
+ */
+struct IntegerFormat
+{
+    IntegerFormat() : bits(64), isSigned(true) {}
+    IntegerFormat(int bits, bool isSigned) : bits(bits), isSigned(isSigned) {}
+    int bits;
+    bool isSigned;
+};
+
+struct ExecOperator
+{
+    enum T
+    {
+        Add, Sub, Mul, Div, Rem,
+        WrappingAdd, WrappingSub, WrappingMul, WrappingDiv, WrappingRem,
+        And, Or, Xor, ShiftLeft, ShiftRight,
+        Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual,
+        Negate, Not
+    };
+    static bool isComparison(T op) {return op >= Equal && op <= GreaterEqual;}
+    /*!
+     * Gets the operator of the standard library's operator function on primitive types
+     */
+    static bool fromName(const std::wstring& name, size_t numArguments, T& ret);
+    /*!
+     * Gets the spelling of the operator, used by error messages
+     */
+    static const wchar_t* getName(T op);
+    /*!
+     * Calculates the integer operation, returns false if it overflows.
+     * Division by zero must be checked by the caller.
+     */
+    static bool calculate(T op, const IntegerFormat& format, int64_t a, int64_t b, int64_t& r);
+    static bool compare(T op, const IntegerFormat& format, int64_t a, int64_t b);
+    static double calculate(T op, bool isFloat, double a, double b);
+    static bool compare(T op, double a, double b);
+};
+
+class SWALLOW_EXPORT ExecConstant : public ExecExpression
+{
+public:
+    ExecConstant(const Value& value) : value(value) {}
+    virtual Value evaluate(Frame& frame) override {return value;}
+    virtual int64_t evaluateInt(Frame& frame) override {return value.i;}
+    virtual double evaluateDouble(Frame& frame) override {return value.d;}
+    virtual bool evaluateBool(Frame& frame) override {return value.i != 0;}
+public:
+    Value value;
+};
+
+/*!
+ * Checked arithmetic, bitwise and comparison operators of integers, the operator is reported with the source info on overflow
+ */
+class SWALLOW_EXPORT ExecIntegerOperator : public ExecExpression
+{
+public:
+    ExecIntegerOperator(ExecOperator::T op, const IntegerFormat& format, ExecExpression* lhs, ExecExpression* rhs)
+    :op(op), format(format), lhs(lhs), rhs(rhs) {}
+    virtual Value evaluate(Frame& frame) override;
+    virtual int64_t evaluateInt(Frame& frame) override;
+    virtual bool evaluateBool(Frame& frame) override;
+public:
+    ExecOperator::T op;
+    IntegerFormat format;
+    ExecExpressionPtr lhs;
+    ExecExpressionPtr rhs;
+    SourceInfo sourceInfo;
+    std::wstring typeName;
+};
+
+class SWALLOW_EXPORT ExecFloatingOperator : public ExecExpression
+{
+public:
+    ExecFloatingOperator(ExecOperator::T op, bool isFloat, ExecExpression* lhs, ExecExpression* rhs)
+    :op(op), isFloat(isFloat), lhs(lhs), rhs(rhs) {}
+    virtual Value evaluate(Frame& frame) override;
+    virtual double evaluateDouble(Frame& frame) override;
+    virtual bool evaluateBool(Frame& frame) override;
+public:
+    ExecOperator::T op;
+    //Float is rounded to single precision after each operation
+    bool isFloat;
+    ExecExpressionPtr lhs;
+    ExecExpressionPtr rhs;
+};
+
+/*!
+ * !, && and ||
+ */
+class SWALLOW_EXPORT ExecLogicalOperator : public ExecExpression
+{
+public:
+    ExecLogicalOperator(ExecOperator::T op, ExecExpression* lhs, ExecExpression* rhs) : op(op), lhs(lhs), rhs(rhs) {}
+    virtual Value evaluate(Frame& frame) override {return Value::makeBool(evaluateBool(frame));}
+    virtual bool evaluateBool(Frame& frame) override;
+public:
+    ExecOperator::T op;
+    ExecExpressionPtr lhs;
+    ExecExpressionPtr rhs;
+};
+
+/*!
+ * String concatenation and comparison
+ */
+class SWALLOW_EXPORT ExecStringOperator : public ExecExpression
+{
+public:
+    ExecStringOperator(ExecOperator::T op, ExecExpression* lhs, ExecExpression* rhs) : op(op), lhs(lhs), rhs(rhs) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    ExecOperator::T op;
+    ExecExpressionPtr lhs;
+    ExecExpressionPtr rhs;
+};
+
+/*!
+ * Prefix/postfix ++ and --
+ */
+class SWALLOW_EXPORT ExecIncrement : public ExecExpression
+{
+public:
+    ExecIncrement(ExecLValue* target, int delta, bool postfix) : target(target), delta(delta), postfix(postfix) {}
+    virtual Value evaluate(Frame& frame) override {return Value::makeInt(evaluateInt(frame));}
+    virtual int64_t evaluateInt(Frame& frame) override;
+public:
+    ExecLValuePtr target;
+    int delta;
+    bool postfix;
+    IntegerFormat format;
+    SourceInfo sourceInfo;
+    std::wstring typeName;
+};
+
+class SWALLOW_EXPORT ExecConditional : public ExecExpression
+{
+public:
+    virtual Value evaluate(Frame& frame) override;
+    virtual int64_t evaluateInt(Frame& frame) override;
+    virtual double evaluateDouble(Frame& frame) override;
+public:
+    ExecExpressionPtr condition;
+    ExecExpressionPtr trueValue;
+    ExecExpressionPtr falseValue;
+};
+
+/*********************************************************************
+ * Values
+ *********************************************************************/
+
+/*!
+ * Creates a tuple, or a struct/class instance from its fields
+ */
+class SWALLOW_EXPORT ExecInstance : public ExecExpression
+{
+public:
+    ExecInstance(RuntimeType* type) : type(type) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    RuntimeType* type;
+    std::vector<ExecExpressionPtr> fields;
+};
+
+class SWALLOW_EXPORT ExecEnum : public ExecExpression
+{
+public:
+    ExecEnum(uint32_t index) : index(index) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    uint32_t index;
+    ExecExpressionPtr payload;
+};
+
+/*!
+ * Associated values of an enum value
+ */
+class SWALLOW_EXPORT ExecEnumPayload : public ExecExpression
+{
+public:
+    ExecEnumPayload(ExecExpression* value) : value(value) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    ExecExpressionPtr value;
+};
+
+class SWALLOW_EXPORT ExecArrayLiteral : public ExecExpression
+{
+public:
+    virtual Value evaluate(Frame& frame) override;
+public:
+    std::vector<ExecExpressionPtr> elements;
+};
+
+/*!
+ * Element of an array, the array is modified in place if it's a storage
+ */
+class SWALLOW_EXPORT ExecArrayElement : public ExecLValue
+{
+public:
+    ExecArrayElement(ExecExpression* base, ExecExpression* index) : base(base), index(index) {}
+    virtual Value* getAddress(Frame& frame, Value& owner) override;
+    virtual const Value& read(Frame& frame, Value& owner) override;
+public:
+    ExecExpressionPtr base;
+    ExecExpressionPtr index;
+    SourceInfo sourceInfo;
+};
+
+/*!
+ * count, append and removeLast of array
+ */
+class SWALLOW_EXPORT ExecArrayMethod : public ExecExpression
+{
+public:
+    enum Method
+    {
+        Count,
+        Append,
+        RemoveLast
+    };
+    ExecArrayMethod(Method method, ExecExpression* base) : method(method), base(base) {}
+    virtual Value evaluate(Frame& frame) override;
+    virtual int64_t evaluateInt(Frame& frame) override;
+public:
+    Method method;
+    ExecExpressionPtr base;
+    ExecExpressionPtr argument;
+    SourceInfo sourceInfo;
+};
+
+class SWALLOW_EXPORT ExecStringInterpolation : public ExecExpression
+{
+public:
+    virtual Value evaluate(Frame& frame) override;
+public:
+    std::vector<ExecExpressionPtr> parts;
+    std::vector<TypePtr> types;
+};
+
+/*********************************************************************
+ * Calls
+ *********************************************************************/
+
+/*!
+ * Call of a function that is resolved at compile time.
+ * Arguments are evaluated into the slots of callee's frame, inout arguments and self of mutating methods are passed by address.
+ */
+class SWALLOW_EXPORT ExecCall : public ExecExpression
+{
+public:
+    ExecCall(Function* function) : function(function), selfByAddress(false) {}
+    virtual Value evaluate(Frame& frame) override;
+protected:
+    /*!
+     * Evaluates arguments into the slots
+     */
+    void prepareArguments(Frame& frame, Value* slots, std::vector<Value>& owners);
+    virtual Function* getTarget(Frame& frame, const Value& self) {return function;}
+public:
+    Function* function;
+    std::vector<ExecExpressionPtr> arguments;
+    //arguments that are passed by address, the same size of arguments or empty if none
+    std::vector<bool> inout;
+    ExecExpressionPtr self;
+    bool selfByAddress;
+    SourceInfo sourceInfo;
+};
+
+/*!
+ * Method call that is dispatched by the dynamic type of self, the last resolved method is cached in the call site
+ */
+class SWALLOW_EXPORT ExecVirtualCall : public ExecCall
+{
+public:
+    ExecVirtualCall(Function* function) : ExecCall(function), cachedType(nullptr), cachedFunction(nullptr) {}
+protected:
+    virtual Function* getTarget(Frame& frame, const Value& self) override;
+public:
+    RuntimeType* cachedType;
+    Function* cachedFunction;
+};
+
+/*!
+ * Creates an instance and calls the initializer on it, the stored properties are initialized first.
+ * A class initializer may be inherited from the parent class.
+ */
+class SWALLOW_EXPORT ExecConstruct : public ExecCall
+{
+public:
+    ExecConstruct(RuntimeType* type, Function* init) : ExecCall(init), type(type) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    RuntimeType* type;
+};
+
+/*!
+ * Call of a function value
+ */
+class SWALLOW_EXPORT ExecClosureCall : public ExecCall
+{
+public:
+    ExecClosureCall(ExecExpression* callee) : ExecCall(nullptr), callee(callee) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    ExecExpressionPtr callee;
+};
+
+/*!
+ * Creates a closure with the captured variables
+ */
+class SWALLOW_EXPORT ExecMakeClosure : public ExecExpression
+{
+public:
+    struct Capture
+    {
+        //captured from a local slot of current frame or from the upvalues of current closure
+        bool local;
+        int index;
+    };
+    ExecMakeClosure(Function* function) : function(function) {}
+    virtual Value evaluate(Frame& frame) override;
+public:
+    Function* function;
+    std::vector<Capture> captures;
+};
+
+SWALLOW_NS_END
+
+#endif//EXECUTABLE_H
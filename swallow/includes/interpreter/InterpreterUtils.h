@@ -0,0 +1,102 @@
+/* InterpreterUtils.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef INTERPRETER_UTILS_H
+#define INTERPRETER_UTILS_H
+#include "swallow_conf.h"
+#include "semantics/semantic-types.h"
+#include "semantics/Symbol.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+typedef std::shared_ptr<class Type> TypePtr;
+typedef std::shared_ptr<class FunctionSymbol> FunctionSymbolPtr;
+typedef std::shared_ptr<class Expression> ExpressionPtr;
+typedef std::shared_ptr<class Identifier> IdentifierPtr;
+typedef std::shared_ptr<class Pattern> PatternPtr;
+typedef std::shared_ptr<class Tuple> TuplePtr;
+typedef std::shared_ptr<class FunctionDef> FunctionDefPtr;
+typedef std::shared_ptr<class ParameterNode> ParameterNodePtr;
+typedef std::shared_ptr<class ParenthesizedExpression> ParenthesizedExpressionPtr;
+class SymbolScope;
+
+/*!
+ * Queries on the type-checked AST shared by the evaluator and the bytecode compiler
+ */
+struct SWALLOW_EXPORT InterpreterUtils
+{
+    static bool hasFlag(const FunctionSymbolPtr& func, SymbolFlags flag);
+    /*!
+     * Gets the type that declares the symbol, extensions are resolved to the extended type
+     */
+    static TypePtr getOwnerType(const SymbolPtr& symbol);
+    static bool isInitializer(const FunctionSymbolPtr& func);
+    static bool isStoredProperty(const SymbolPtr& symbol);
+    /*!
+     * Static stored properties and top-level variables live in global storages
+     */
+    static bool isGlobalVariable(const SymbolPtr& symbol);
+    /*!
+     * Stored properties that occupy a slot in the instance, in declaration order
+     */
+    static void getStoredProperties(const TypePtr& type, std::vector<SymbolPtr>& properties);
+    static bool isSelfIdentifier(const ExpressionPtr& expr);
+    /*!
+     * Arguments are taken after the semantic analyzer's transformation, e.g. the implicit self access expanded
+     */
+    static void getArguments(const ParenthesizedExpressionPtr& args, std::vector<ExpressionPtr>& ret);
+    /*!
+     * Parameters of a function declaration, curried functions are not supported
+     */
+    static std::vector<ParameterNodePtr> getParameters(const FunctionDefPtr& node);
+    /*!
+     * Resolves the symbol an identifier refers to.
+     * Operands of operators are not updated with the analyzer's transformation, so an identifier may refer to a member
+     * of self implicitly.
+     */
+    static SymbolPtr resolveIdentifier(const IdentifierPtr& id, const std::vector<SymbolScope*>& scopes, const TypePtr& selfType);
+    /*!
+     * Gets the name of enum case and the associated value's pattern from a case pattern
+     */
+    static bool getEnumCasePattern(const PatternPtr& condition, std::wstring& name, TuplePtr& binding);
+    /*!
+     * Checks if the symbol refers to an enum case without associated values, e.g. Color.Red
+     */
+    static bool isEnumCaseReference(const SymbolPtr& sym, const TypePtr& type, const std::wstring& name);
+    static uint32_t getEnumCaseIndex(const TypePtr& type, const std::wstring& name);
+    static bool sameSignature(const TypePtr& lhs, const TypePtr& rhs);
+};
+
+SWALLOW_NS_END
+
+#endif//INTERPRETER_UTILS_H
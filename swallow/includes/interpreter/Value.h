@@ -0,0 +1,308 @@
+/* Value.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef VALUE_H
+#define VALUE_H
+#include "swallow_conf.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+struct Function;
+struct RuntimeType;
+
+/*!
+ * \brief Base class of the heap objects that values refer to.
+ *
+ * Objects are reference counted, the evaluator is single threaded so the counter is not atomic.
+ * A new object is created with a reference count of 1 that is owned by the value it's given to.
+ */
+class SWALLOW_EXPORT Object
+{
+public:
+    Object() : refCount(1) {}
+    virtual ~Object(){}
+public:
+    void retain() {refCount++;}
+    void release()
+    {
+        if(--refCount == 0)
+            destroy();
+    }
+    bool isUnique() const {return refCount == 1;}
+    /*!
+     * Creates a copy of this object, used by copy-on-write of value types
+     */
+    virtual Object* clone() const = 0;
+protected:
+    /*!
+     * Called when the last reference is released
+     */
+    virtual void destroy() {delete this;}
+public:
+    int refCount;
+};
+
+class Value;
+
+/*!
+ * \brief A compact tagged value of the evaluator.
+ *
+ * Int/Double/Bool and strings of up to 8 Latin-1 characters are stored inline, all integer types are kept
+ * in 64 bits(unsigned ones as bit pattern), Float is kept as double rounded to single precision.
+ * Other values refer to a reference counted Object, value types(struct/tuple/array/string) are copied on write.
+ */
+class SWALLOW_EXPORT Value
+{
+public:
+    enum Kind : uint8_t
+    {
+        Void,
+        Int,
+        Double,
+        Bool,
+        InlineString,
+        /*!
+         * Address of another value, used by inout parameters and self of mutating methods
+         */
+        Address,
+        //kinds below may refer to an object
+        /*!
+         * Enum case stored in index, associated values are kept in a Box
+         */
+        Enum,
+        String,
+        Array,
+        /*!
+         * Instance of struct/class, and tuple
+         */
+        Instance,
+        /*!
+         * Storage of a variable captured by closures
+         */
+        Box,
+        Closure
+    };
+    static const int MaxInlineLength = 8;
+public:
+    Value() : kind(Void), length(0), index(0) {i = 0;}
+    Value(const Value& v) : kind(v.kind), length(v.length), index(v.index)
+    {
+        i = v.i;
+        retain();
+    }
+    Value(Value&& v) : kind(v.kind), length(v.length), index(v.index)
+    {
+        i = v.i;
+        v.kind = Void;
+        v.i = 0;
+    }
+    ~Value() {release();}
+    Value& operator=(const Value& v)
+    {
+        v.retain();
+        release();
+        kind = v.kind;
+        length = v.length;
+        index = v.index;
+        i = v.i;
+        return *this;
+    }
+    Value& operator=(Value&& v)
+    {
+        if(this != &v)
+        {
+            release();
+            kind = v.kind;
+            length = v.length;
+            index = v.index;
+            i = v.i;
+            v.kind = Void;
+            v.i = 0;
+        }
+        return *this;
+    }
+public:
+    static Value makeInt(int64_t v)
+    {
+        Value ret;
+        ret.kind = Int;
+        ret.i = v;
+        return ret;
+    }
+    static Value makeDouble(double v)
+    {
+        Value ret;
+        ret.kind = Double;
+        ret.d = v;
+        return ret;
+    }
+    static Value makeBool(bool v)
+    {
+        Value ret;
+        ret.kind = Bool;
+        ret.i = v ? 1 : 0;
+        return ret;
+    }
+    static Value makeAddress(Value* v)
+    {
+        Value ret;
+        ret.kind = Address;
+        ret.address = v;
+        return ret;
+    }
+    /*!
+     * Creates an enum value, the payload's reference is taken by the value
+     */
+    static Value makeEnum(uint32_t index, Object* payload)
+    {
+        Value ret;
+        ret.kind = Enum;
+        ret.index = index;
+        ret.object = payload;
+        return ret;
+    }
+    /*!
+     * Creates a value that refers to the object, the object's reference is taken by the value
+     */
+    static Value makeObject(Kind kind, Object* object)
+    {
+        Value ret;
+        ret.kind = kind;
+        ret.object = object;
+        return ret;
+    }
+    static Value makeString(const std::wstring& str);
+    static Value makeBox(const Value& value);
+public:
+    Kind getKind() const {return kind;}
+    bool isString() const {return kind == InlineString || kind == String;}
+    /*!
+     * Gets the content of a string value
+     */
+    std::wstring getString() const;
+    /*!
+     * Gets the value that a box or an address refers to
+     */
+    Value* getReferent() const;
+    /*!
+     * Makes the referred object unique so it can be modified in place, used by value types
+     */
+    Object* makeUnique();
+    /*!
+     * Checks if two values of the same primitive type(integers, floating numbers, Bool and String) are equal
+     */
+    bool equals(const Value& rhs) const;
+private:
+    void retain() const
+    {
+        if(kind >= Enum && object)
+            object->retain();
+    }
+    void release()
+    {
+        if(kind >= Enum && object)
+            object->release();
+    }
+public:
+    Kind kind;
+    //number of characters of an inline string
+    uint8_t length;
+    //case index of an enum value
+    uint32_t index;
+    union
+    {
+        int64_t i;
+        double d;
+        char chars[MaxInlineLength];
+        Value* address;
+        Object* object;
+    };
+};
+
+class SWALLOW_EXPORT StringObject : public Object
+{
+public:
+    StringObject(const std::wstring& value) : value(value) {}
+    virtual Object* clone() const override {return new StringObject(value);}
+public:
+    std::wstring value;
+};
+
+class SWALLOW_EXPORT ArrayObject : public Object
+{
+public:
+    virtual Object* clone() const override;
+public:
+    std::vector<Value> elements;
+};
+
+class SWALLOW_EXPORT BoxObject : public Object
+{
+public:
+    BoxObject(const Value& value) : value(value) {}
+    virtual Object* clone() const override {return new BoxObject(value);}
+public:
+    Value value;
+};
+
+/*!
+ * Instance of a struct or class, tuples are instances without type
+ */
+class SWALLOW_EXPORT InstanceObject : public Object
+{
+public:
+    InstanceObject(RuntimeType* type, size_t numFields) : type(type), fields(numFields) {}
+    virtual Object* clone() const override;
+protected:
+    /*!
+     * Runs the deinitializers of a class instance before it's freed
+     */
+    virtual void destroy() override;
+public:
+    RuntimeType* type;
+    std::vector<Value> fields;
+};
+
+class SWALLOW_EXPORT ClosureObject : public Object
+{
+public:
+    ClosureObject(Function* function) : function(function) {}
+    virtual Object* clone() const override;
+public:
+    Function* function;
+    //boxes of the captured variables
+    std::vector<Value> captures;
+};
+
+SWALLOW_NS_END
+
+#endif//VALUE_H
@@ -0,0 +1,126 @@
+/* VirtualMachine.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef VIRTUAL_MACHINE_H
+#define VIRTUAL_MACHINE_H
+#include "Bytecode.h"
+#include <deque>
+#include <unordered_map>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+class CompilerResults;
+class GlobalScope;
+class Symbol;
+typedef std::shared_ptr<Symbol> SymbolPtr;
+typedef std::shared_ptr<class ScopedProgram> ScopedProgramPtr;
+
+/*!
+ * \brief Executes a type-checked program by compiling it into register-based bytecode.
+ *
+ * It runs the same subset of the language as the Evaluator except closures, tuples, inout parameters,
+ * associated values of enums and deinitializers. Calls to resolved functions are linked directly, methods
+ * that can be overridden are dispatched through an inline cache at the call site.
+ * Like the Evaluator, the state is kept across the runs so the REPL can evaluate the program line by line.
+ */
+class SWALLOW_EXPORT VirtualMachine
+{
+    friend class BytecodeCompiler;
+public:
+    /*!
+     * Maximum depth of nested calls
+     */
+    static const int MaxCallDepth = 10000;
+    /*!
+     * Number of registers shared by all frames
+     */
+    static const size_t StackSize = 128 * 1024;
+public:
+    VirtualMachine(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults);
+    ~VirtualMachine();
+public:
+    /*!
+     * Changes the compiler results that errors are reported to
+     */
+    void setCompilerResults(CompilerResults* compilerResults);
+    /*!
+     * Compiles and runs the top-level statements of the program.
+     * A value for each statement is appended to results if it's given, statements that are not expressions produce Void.
+     * Returns false if it failed to compile or run.
+     */
+    bool run(const ScopedProgramPtr& program, std::vector<Value>* results = nullptr);
+    /*!
+     * Gets the storage of a top-level variable, nullptr if it's not declared yet
+     */
+    Value* getGlobal(const SymbolPtr& symbol);
+    /*!
+     * Formats the value of given type, strings are quoted as literal if literal is true.
+     */
+    std::wstring toString(const Value& value, const TypePtr& type, bool literal = true);
+    /*!
+     * Lists the instructions of the functions with given name, top-level statements are compiled as "main"
+     */
+    std::wstring disassemble(const std::wstring& name);
+private:
+    void execute(BCFunction* function, Value* registers);
+    BCFunction* resolveOverride(RuntimeType* type, BCFunction* method);
+    void runtimeError(BCFunction* function, const BCInstruction* pc, int code, const std::wstring& item1 = std::wstring(), const std::wstring& item2 = std::wstring());
+private://used by compiler
+    BCFunction* addFunction(const std::wstring& name);
+    BCFunction* getFunction(const FunctionSymbolPtr& symbol);
+    RuntimeType* getRuntimeType(const TypePtr& type);
+    uint16_t getTypeIndex(const TypePtr& type);
+    uint16_t getGlobalIndex(const SymbolPtr& symbol);
+private:
+    SymbolRegistry* symbolRegistry;
+    CompilerResults* compilerResults;
+    GlobalScope* global;
+    std::vector<std::unique_ptr<BCFunction>> functions;
+    std::unordered_map<Symbol*, BCFunction*> functionsBySymbol;
+    //functions of the top-level statements of last run
+    std::vector<std::unique_ptr<BCFunction>> statements;
+    std::vector<std::unique_ptr<RuntimeType>> types;
+    std::unordered_map<Type*, uint16_t> typeIndices;
+    //initial values of stored properties declared by the type, self is passed in the first register
+    std::unordered_map<RuntimeType*, BCFunction*> fieldInitializers;
+    std::deque<Value> globalStorages;
+    std::vector<Value*> globals;
+    //symbols of the globals are kept alive, they're indexed by address
+    std::vector<SymbolPtr> globalSymbols;
+    std::unordered_map<Symbol*, uint16_t> globalIndices;
+    std::unique_ptr<Value[]> stack;
+    //registers above it are not used
+    Value* stackTop;
+    int depth;
+};
+
+SWALLOW_NS_END
+
+#endif//VIRTUAL_MACHINE_H
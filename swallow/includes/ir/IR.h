@@ -0,0 +1,339 @@
+/* IR.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_H
+#define IR_H
+#include "swallow_conf.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <tuple>
+
+SWALLOW_NS_BEGIN
+typedef std::shared_ptr<class Type> TypePtr;
+typedef std::shared_ptr<class Symbol> SymbolPtr;
+typedef std::shared_ptr<class GenericDefinition> GenericDefinitionPtr;
+
+/*!
+ * A value is the index of the instruction(or block argument) that defines it inside its function.
+ */
+typedef uint32_t IRValue;
+/*!
+ * Index of a type in IRModule's type table, the highest bit marks an address of the type.
+ */
+typedef uint32_t IRTypeRef;
+
+/*!
+ * Opcodes of the SSA intermediate representation, they follow the SIL instructions documented
+ * in docs/en/sil-3-instruction-references.
+ * Comments describe the operands and immediate of each opcode.
+ */
+struct IROpcode
+{
+    enum T : uint8_t
+    {
+        Argument,           //block argument, immediate: index of the argument
+        //memory
+        AllocStack,         //immediate: none, result is an address
+        AllocBox,           //immediate: none, result is an address
+        AllocRef,           //immediate: none, result is a class reference
+        DeallocStack,       //operands: address
+        DeallocRef,         //operands: reference
+        Load,               //operands: address
+        Store,              //operands: value, address
+        DestroyAddr,        //operands: address
+        //aggregates
+        Struct,             //operands: stored properties
+        Tuple,              //operands: elements
+        Enum,               //operands: optional payload, immediate: member
+        StructExtract,      //operands: struct value, immediate: member
+        StructElementAddr,  //operands: struct address, immediate: member
+        TupleExtract,       //operands: tuple value, immediate: element index
+        TupleElementAddr,   //operands: tuple address, immediate: element index
+        RefElementAddr,     //operands: class reference, immediate: member
+        UncheckedEnumData,  //operands: enum value, immediate: member
+        GlobalAddr,         //immediate: global
+        //literals
+        IntegerLiteral,     //immediate: integer
+        FloatLiteral,       //immediate: real
+        StringLiteral,      //immediate: string
+        Metatype,           //immediate: none
+        //functions
+        FunctionRef,        //immediate: function
+        ClassMethod,        //operands: class reference, immediate: member
+        Apply,              //operands: callee, arguments, immediate: substitution of generic arguments
+        Builtin,            //operands: arguments, immediate: string of builtin's name
+        //reference counting
+        StrongRetain,       //operands: reference
+        StrongRelease,      //operands: reference
+        RetainValue,        //operands: value
+        ReleaseValue,       //operands: value
+        //meta
+        DebugValue,         //operands: value, immediate: string of variable's name
+        //terminators
+        Return,             //operands: value
+        Br,                 //operands: block arguments, immediate: block
+        CondBr,             //operands: condition, immediate: then/else blocks
+        SwitchEnum,         //operands: enum value, pairs of member and block, immediate: default block
+        CondFail,           //operands: condition
+        Unreachable,
+        _Count
+    };
+    /*!
+     * Gets the SIL spelling of the opcode
+     */
+    static const char* getName(T opcode);
+    /*!
+     * Returns true if the opcode ends a basic block
+     */
+    static bool isTerminator(T opcode);
+    /*!
+     * Returns true if the instruction defines a value
+     */
+    static bool hasResult(T opcode);
+};
+
+/*!
+ * Instructions are fixed-size records stored contiguously in IRFunction, operands are
+ * stored in the function's operand array and referenced by offset.
+ */
+struct IRInstruction
+{
+    IROpcode::T opcode;
+    //debug_value: 1 if it's a variable; alloc_ref: 1 if it's allocated on stack; cond_br/switch_enum: unused
+    uint8_t flags;
+    uint16_t numOperands;
+    IRTypeRef type;
+    uint32_t operands;
+    uint32_t block;
+    union
+    {
+        int64_t integer;
+        double real;
+        uint32_t index;
+        uint32_t targets[2];
+    } immediate;
+};
+static_assert(sizeof(IRInstruction) == 24, "IRInstruction is expected to be 24 bytes");
+
+/*!
+ * A basic block owns a contiguous range of instructions, its arguments are the leading Argument instructions.
+ */
+struct IRBasicBlock
+{
+    uint32_t first;
+    uint32_t end;
+    uint32_t numArguments;
+};
+
+/*!
+ * A reference to a member of a type, used by field access, enum cases and methods.
+ */
+struct IRMember
+{
+    enum Kind
+    {
+        Field,
+        EnumCase,
+        Method
+    };
+    TypePtr owner;
+    std::wstring name;
+    Kind kind;
+    //position of the stored property or enum case inside the owner
+    uint32_t index;
+    //for enum case, it's true if the case has associated values
+    bool hasPayload;
+    SymbolPtr symbol;
+};
+
+struct IRGlobal
+{
+    std::wstring name;
+    IRTypeRef type;
+    SymbolPtr symbol;
+};
+
+struct IRType
+{
+    //Swift type, it's null for builtin types or function signatures
+    TypePtr type;
+    //The SIL spelling of the type
+    std::wstring name;
+};
+
+struct IRConvention
+{
+    enum T
+    {
+        Thin,
+        Method
+    };
+};
+
+class SWALLOW_EXPORT IRFunction
+{
+public:
+    static const IRValue InvalidValue = 0xffffffff;
+    static const uint32_t InvalidBlock = 0xffffffff;
+public:
+    IRFunction(const std::wstring& name);
+public:
+    const IRValue* getOperands(const IRInstruction& inst) const { return operands.data() + inst.operands;}
+    IRValue getOperand(const IRInstruction& inst, int idx) const { return operands[inst.operands + idx];}
+    IRTypeRef getValueType(IRValue value) const { return instructions[value].type;}
+    /*!
+     * Declared functions without body are implemented by runtime or other modules
+     */
+    bool isExternal() const { return blocks.empty();}
+    /*!
+     * Generic functions have unbound generic parameters in their types, they're called with substitutions
+     */
+    bool isGeneric() const { return generic != nullptr;}
+    /*!
+     * Gets the successors of given block by reading its terminator
+     */
+    void getSuccessors(uint32_t block, std::vector<uint32_t>& successors) const;
+    /*!
+     * Drops blocks that were never filled or never reached from the entry,
+     * then renumbers the blocks and values by their layout order.
+     */
+    void finish();
+public:
+    std::wstring name;
+    SymbolPtr symbol;
+    IRConvention::T convention;
+    std::vector<IRTypeRef> parameters;
+    IRTypeRef result;
+    //the type used to refer this function
+    IRTypeRef signature;
+    GenericDefinitionPtr generic;
+
+    std::vector<IRInstruction> instructions;
+    std::vector<IRValue> operands;
+    std::vector<IRBasicBlock> blocks;
+};
+
+/*!
+ * Users of each value of a function and the operand index used by each user,
+ * it's a snapshot that needs to be rebuilt after the function is changed.
+ */
+class SWALLOW_EXPORT IRUsers
+{
+public:
+    typedef std::pair<IRValue, int> Use;
+public:
+    IRUsers(const IRFunction* func);
+public:
+    const std::vector<Use>& operator[](IRValue value) const { return uses[value];}
+private:
+    std::vector<std::vector<Use> > uses;
+};
+
+/*!
+ * A module owns all lowered functions, globals and the interned tables used by instructions
+ */
+class SWALLOW_EXPORT IRModule
+{
+public:
+    static const IRTypeRef AddressBit = 0x80000000;
+    //type index of the empty tuple
+    static const IRTypeRef VoidType = 0;
+public:
+    IRModule(const std::wstring& name);
+    ~IRModule();
+public:
+    const std::wstring& getName() const { return name;}
+
+    /*!
+     * Interns a Swift type
+     */
+    IRTypeRef getType(const TypePtr& type);
+    /*!
+     * Interns a builtin type or a function signature by its spelling
+     */
+    IRTypeRef getType(const std::wstring& spelling);
+    static IRTypeRef addressOf(IRTypeRef type) { return type | AddressBit;}
+    static IRTypeRef objectOf(IRTypeRef type) { return type & ~AddressBit;}
+    static bool isAddress(IRTypeRef type) { return (type & AddressBit) != 0;}
+    const IRType& getTypeInfo(IRTypeRef type) const { return types[objectOf(type)];}
+    /*!
+     * Gets the SIL spelling of the type, addresses are prefixed by *
+     */
+    std::wstring getTypeName(IRTypeRef type) const;
+
+    uint32_t getString(const std::wstring& str);
+    const std::wstring& getStringAt(uint32_t idx) const { return strings[idx];}
+
+    uint32_t getMember(const TypePtr& owner, const std::wstring& name, IRMember::Kind kind, uint32_t index, const SymbolPtr& symbol = nullptr, bool hasPayload = false);
+    const IRMember& getMemberAt(uint32_t idx) const { return members[idx];}
+
+    /*!
+     * Interns the generic arguments of an apply, substitution 0 is always the empty list
+     */
+    uint32_t getSubstitution(const std::vector<IRTypeRef>& types);
+    const std::vector<IRTypeRef>& getSubstitutionAt(uint32_t idx) const { return substitutions[idx];}
+    size_t numSubstitutions() const { return substitutions.size();}
+
+    /*!
+     * Gets the function by mangled name, returns nullptr if it's not declared yet
+     */
+    IRFunction* getFunction(const std::wstring& name) const;
+    IRFunction* addFunction(const std::wstring& name);
+    uint32_t getFunctionIndex(const IRFunction* func) const;
+    IRFunction* getFunctionAt(uint32_t idx) const { return functions[idx].get();}
+    size_t numFunctions() const { return functions.size();}
+
+    uint32_t getGlobal(const std::wstring& name, IRTypeRef type, const SymbolPtr& symbol);
+    const IRGlobal& getGlobalAt(uint32_t idx) const { return globals[idx];}
+    size_t numGlobals() const { return globals.size();}
+private:
+    std::wstring name;
+    std::vector<IRType> types;
+    std::unordered_map<Type*, IRTypeRef> typeIndex;
+    std::unordered_map<std::wstring, IRTypeRef> spellingIndex;
+    std::vector<std::wstring> strings;
+    std::unordered_map<std::wstring, uint32_t> stringIndex;
+    std::vector<IRMember> members;
+    //methods are also keyed by their symbol to tell overloads apart
+    std::map<std::tuple<Type*, std::wstring, Symbol*>, uint32_t> memberIndex;
+    std::vector<std::vector<IRTypeRef> > substitutions;
+    std::map<std::vector<IRTypeRef>, uint32_t> substitutionIndex;
+    std::vector<std::unique_ptr<IRFunction> > functions;
+    std::unordered_map<std::wstring, uint32_t> functionIndex;
+    std::vector<IRGlobal> globals;
+    std::unordered_map<std::wstring, uint32_t> globalIndex;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_H
@@ -0,0 +1,98 @@
+/* IRARCOptimizer.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_ARC_OPTIMIZER_H
+#define IR_ARC_OPTIMIZER_H
+#include "swallow_conf.h"
+#include "ir/IR.h"
+#include "ir/IREscapeAnalysis.h"
+#include <map>
+#include <vector>
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+struct ARCStatistics
+{
+    //retains, releases and destroy_addr of the module before and after the optimization
+    uint32_t originalOperations;
+    uint32_t finalOperations;
+    //retain and release pairs removed because the object is known to be alive between them
+    uint32_t removedPairs;
+    //pairs around calls removed because arguments are passed as guaranteed
+    uint32_t borrowedArguments;
+    //objects allocated and released in the same function without escaping
+    uint32_t nonEscapingObjects;
+    uint32_t removedNonEscaping;
+    uint32_t hoistedReleases;
+};
+
+/*!
+ * \brief Removes redundant reference counting from the naively lowered IR.
+ *
+ * IRLowering owns values at +1 and passes parameters at +0, so every copy of a class reference is wrapped by
+ * a retain and a release. The optimizer runs these steps on each function:
+ *
+ *  1. Objects that never escape the function only keep their final release, it's decided by IREscapeAnalysis.
+ *  2. A retain and a following release of the same value are removed if nothing consumes the value between them
+ *     and the object is kept alive by another reference: an owned value, a guaranteed parameter, a stack slot that
+ *     is not modified between them, or simply no instruction between them may release anything. A copy stored to
+ *     a local constant is borrowed the same way if the source outlives the constant.
+ *  3. Remaining releases and destructions of local constants are hoisted to the last use of the value in its
+ *     block, they never cross calls or other releases so the order of deinitializers is preserved.
+ */
+class SWALLOW_EXPORT IRARCOptimizer
+{
+public:
+    IRARCOptimizer(IRModule* module);
+public:
+    /*!
+     * Optimize all functions of the module, returns the number of removed reference counting operations
+     */
+    uint32_t run();
+
+    const ARCStatistics& getStatistics() const { return statistics;}
+    void dumpStatistics(std::wostream& out) const;
+private:
+    void removeNonEscaping(IRFunction* func, const IRUsers& users, std::vector<bool>& removed);
+    void removePairs(IRFunction* func, const IRUsers& users, std::vector<bool>& removed);
+    void removeSlotCopy(IRFunction* func, const IRUsers& users, IRValue retain, IRValue store, std::vector<bool>& removed);
+    IRValue getDestroy(const IRFunction* func, const IRUsers& users, IRValue slot);
+    void hoistReleases(IRFunction* func, const IRUsers& users, std::vector<std::vector<IRValue> >& layout);
+    bool consumes(const IRFunction* func, const IRInstruction& inst, IRValue value);
+    bool isOwned(const IRFunction* func, IRValue value);
+private:
+    IRModule* module;
+    ARCStatistics statistics;
+    IREscapeAnalysis escapeAnalysis;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_ARC_OPTIMIZER_H
@@ -0,0 +1,133 @@
+/* IRBuilder.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_BUILDER_H
+#define IR_BUILDER_H
+#include "ir/IR.h"
+#include <initializer_list>
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * \brief Appends instructions to a function.
+ *
+ * Blocks are created empty and laid out when they become the insertion block, so a block's instructions
+ * stay contiguous as long as the previous insertion block was terminated before switching to a new one.
+ */
+class SWALLOW_EXPORT IRBuilder
+{
+public:
+    IRBuilder(IRModule* module, IRFunction* function);
+public:
+    IRModule* getModule() { return module;}
+    IRFunction* getFunction() { return function;}
+
+    /*!
+     * Creates a new block which is not laid out yet
+     */
+    uint32_t createBlock();
+    /*!
+     * Declares an argument to a block that's not laid out yet
+     */
+    void addBlockArgument(uint32_t block, IRTypeRef type);
+    /*!
+     * Gets the value of a block's argument, the block must be laid out
+     */
+    IRValue getBlockArgument(uint32_t block, int index) const;
+    /*!
+     * Lays out given block after current one and appends subsequent instructions to it.
+     */
+    void setInsertionBlock(uint32_t block);
+    uint32_t getInsertionBlock() const { return current;}
+    /*!
+     * Returns true if there's no insertion block or current block is already terminated
+     */
+    bool isTerminated() const;
+    IRTypeRef getValueType(IRValue value) const { return function->getValueType(value);}
+public:
+    IRValue createAllocStack(IRTypeRef type);
+    IRValue createAllocBox(IRTypeRef type);
+    IRValue createAllocRef(IRTypeRef type);
+    void createDeallocStack(IRValue address);
+    void createDeallocRef(IRValue ref);
+    IRValue createLoad(IRValue address);
+    void createStore(IRValue value, IRValue address);
+    void createDestroyAddr(IRValue address);
+
+    IRValue createStruct(IRTypeRef type, const std::vector<IRValue>& fields);
+    IRValue createTuple(IRTypeRef type, const std::vector<IRValue>& elements);
+    IRValue createEnum(IRTypeRef type, uint32_t member, IRValue payload = IRFunction::InvalidValue);
+    IRValue createStructExtract(IRValue value, uint32_t member, IRTypeRef type);
+    IRValue createStructElementAddr(IRValue address, uint32_t member, IRTypeRef type);
+    IRValue createTupleExtract(IRValue value, int index, IRTypeRef type);
+    IRValue createTupleElementAddr(IRValue address, int index, IRTypeRef type);
+    IRValue createRefElementAddr(IRValue ref, uint32_t member, IRTypeRef type);
+    IRValue createUncheckedEnumData(IRValue value, uint32_t member, IRTypeRef type);
+    IRValue createGlobalAddr(uint32_t global);
+
+    IRValue createIntegerLiteral(IRTypeRef type, int64_t value);
+    IRValue createFloatLiteral(IRTypeRef type, double value);
+    IRValue createStringLiteral(IRTypeRef type, const std::wstring& value);
+    IRValue createMetatype(IRTypeRef type);
+
+    IRValue createFunctionRef(IRFunction* func);
+    IRValue createClassMethod(IRValue self, uint32_t member, IRTypeRef signature);
+    IRValue createApply(IRValue callee, const std::vector<IRValue>& args, IRTypeRef result, uint32_t substitution = 0);
+    IRValue createBuiltin(const std::wstring& name, const std::vector<IRValue>& args, IRTypeRef result);
+
+    void createStrongRetain(IRValue ref);
+    void createStrongRelease(IRValue ref);
+    void createRetainValue(IRValue value);
+    void createReleaseValue(IRValue value);
+    void createDebugValue(IRValue value, const std::wstring& name, bool variable);
+
+    void createReturn(IRValue value);
+    void createBr(uint32_t target, const std::vector<IRValue>& args = std::vector<IRValue>());
+    void createCondBr(IRValue condition, uint32_t thenBlock, uint32_t elseBlock);
+    /*!
+     * cases are pairs of enum case member and target block
+     */
+    void createSwitchEnum(IRValue value, const std::vector<std::pair<uint32_t, uint32_t> >& cases, uint32_t defaultBlock = IRFunction::InvalidBlock);
+    void createCondFail(IRValue condition);
+    void createUnreachable();
+private:
+    IRValue emit(IROpcode::T opcode, IRTypeRef type, const IRValue* operands, size_t numOperands);
+    IRValue emit(IROpcode::T opcode, IRTypeRef type, std::initializer_list<IRValue> operands = {});
+    IRValue emit(IROpcode::T opcode, IRTypeRef type, const std::vector<IRValue>& operands);
+private:
+    IRModule* module;
+    IRFunction* function;
+    uint32_t current;
+    //argument types of blocks that are not laid out yet
+    std::map<uint32_t, std::vector<IRTypeRef> > pendingArguments;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_BUILDER_H
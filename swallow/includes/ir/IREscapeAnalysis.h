@@ -0,0 +1,94 @@
+/* IREscapeAnalysis.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_ESCAPE_ANALYSIS_H
+#define IR_ESCAPE_ANALYSIS_H
+#include "swallow_conf.h"
+#include "ir/IR.h"
+#include <map>
+#include <vector>
+
+SWALLOW_NS_BEGIN
+
+struct IREscape
+{
+    enum T : uint8_t
+    {
+        NoEscape,
+        //the parameter is only returned, it's the self of initializers
+        Returned,
+        Escapes
+    };
+};
+
+/*!
+ * \brief Decides which class references may outlive the function that holds them.
+ *
+ * An object escapes if it's stored anywhere other than a stack slot that is stored only once, returned, passed
+ * to a branch or an aggregate, or passed to a call that may let it escape. Calls are resolved by a summary of
+ * each function's parameters computed on the whole module, the summaries start optimistic and are weakened
+ * until no summary changes, so recursive functions are handled. Calls dispatched dynamically and external
+ * functions let all their arguments escape.
+ */
+class SWALLOW_EXPORT IREscapeAnalysis
+{
+public:
+    IREscapeAnalysis(const IRModule* module);
+public:
+    /*!
+     * Computes the summaries of all functions
+     */
+    void run();
+    IREscape::T getParameterEscape(const IRFunction* func, uint32_t param) const;
+    /*!
+     * Collects the values that refer the same object as root, returns false if the object may escape.
+     * Aliases are loaded from stack slots that are only stored once, or returned from initializers.
+     */
+    bool collectAliases(const IRFunction* func, const IRUsers& users, IRValue root, bool allowReturn,
+        std::vector<IRValue>& aliases, std::vector<IRValue>& slots, bool& returned) const;
+    /*!
+     * Check if the object allocated by alloc_ref never escapes and its lifetime ends in the block it's allocated,
+     * the retains, releases and destructions of slots that hold the object are collected in order.
+     */
+    bool isLocalObject(const IRFunction* func, const IRUsers& users, IRValue alloc, std::vector<IRValue>& operations) const;
+    /*!
+     * A stable slot is a stack slot that is stored once and never passed by address,
+     * its content can only be changed by the function that allocates it.
+     */
+    static bool isStableSlot(const IRFunction* func, const IRUsers& users, IRValue slot);
+private:
+    static bool isFieldAccess(const IRFunction* func, const IRUsers& users, IRValue address);
+private:
+    const IRModule* module;
+    std::map<const IRFunction*, std::vector<IREscape::T> > summaries;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_ESCAPE_ANALYSIS_H
@@ -0,0 +1,220 @@
+/* IRLowering.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_LOWERING_H
+#define IR_LOWERING_H
+#include "ast/NodeVisitor.h"
+#include "ir/IRBuilder.h"
+#include "codegen/NameMangling.h"
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+class SymbolScope;
+class CompilerResults;
+class GlobalScope;
+typedef std::shared_ptr<class ScopedProgram> ScopedProgramPtr;
+typedef std::shared_ptr<class FunctionSymbol> FunctionSymbolPtr;
+typedef std::shared_ptr<class TypeDeclaration> TypeDeclarationPtr;
+
+/*!
+ * \brief Lowers a type-checked AST into the SSA IR.
+ *
+ * The lowering relies on the symbols resolved by SemanticAnalyzer and attached to the expressions,
+ * so it must run on a program that passed the semantic analysis without errors.
+ *
+ * Values are owned at +1 and parameters are passed at +0 (guaranteed), reference counting operations
+ * are emitted naively and are expected to be optimized by later passes.
+ *
+ * Constructs that have no lowering yet are reported as E_A_IS_NOT_SUPPORTED_IN_IR_LOWERING_1.
+ */
+class SWALLOW_EXPORT IRLowering : public NodeVisitor
+{
+    struct FunctionContext;
+    struct Variable
+    {
+        IRValue value;
+        //the value is an address of the variable's storage
+        bool address;
+    };
+    struct LValue
+    {
+        IRValue address;
+        //the class reference that holds the storage, needs to be released after the access
+        IRValue owner;
+    };
+    struct Cleanup
+    {
+        IRValue address;
+        bool destroy;
+    };
+    struct Loop
+    {
+        uint32_t breakBlock;
+        uint32_t continueBlock;
+        //number of cleanup scopes outside the loop
+        size_t depth;
+    };
+public:
+    IRLowering(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults, IRModule* module);
+    ~IRLowering();
+public:
+    /*!
+     * Lowers the whole program, top-level code goes to function main.
+     * Returns false if any construct failed to lower.
+     */
+    bool lower(const ScopedProgramPtr& program);
+    /*!
+     * Gets or declares the IR function of given function symbol
+     */
+    IRFunction* getFunction(const FunctionSymbolPtr& func);
+public://declarations
+    virtual void visitValueBindings(const ValueBindingsPtr& node) override;
+    virtual void visitComputedProperty(const ComputedPropertyPtr& node) override;
+    virtual void visitClass(const ClassDefPtr& node) override;
+    virtual void visitStruct(const StructDefPtr& node) override;
+    virtual void visitEnum(const EnumDefPtr& node) override;
+    virtual void visitExtension(const ExtensionDefPtr& node) override;
+    virtual void visitProtocol(const ProtocolDefPtr& node) override;
+    virtual void visitFunction(const FunctionDefPtr& node) override;
+    virtual void visitDeinit(const DeinitializerDefPtr& node) override;
+    virtual void visitInit(const InitializerDefPtr& node) override;
+    virtual void visitSubscript(const SubscriptDefPtr& node) override;
+    virtual void visitTypeAlias(const TypeAliasPtr& node) override;
+    virtual void visitImport(const ImportPtr& node) override;
+    virtual void visitOperator(const OperatorDefPtr& node) override;
+public://statements
+    virtual void visitWhileLoop(const WhileLoopPtr& node) override;
+    virtual void visitForIn(const ForInLoopPtr& node) override;
+    virtual void visitForLoop(const ForLoopPtr& node) override;
+    virtual void visitDoLoop(const DoLoopPtr& node) override;
+    virtual void visitLabeledStatement(const LabeledStatementPtr& node) override;
+    virtual void visitBreak(const BreakStatementPtr& node) override;
+    virtual void visitReturn(const ReturnStatementPtr& node) override;
+    virtual void visitContinue(const ContinueStatementPtr& node) override;
+    virtual void visitFallthrough(const FallthroughStatementPtr& node) override;
+    virtual void visitIf(const IfStatementPtr& node) override;
+    virtual void visitSwitchCase(const SwitchCasePtr& node) override;
+    virtual void visitCodeBlock(const CodeBlockPtr& node) override;
+public://expressions
+    virtual void visitAssignment(const AssignmentPtr& node) override;
+    virtual void visitArrayLiteral(const ArrayLiteralPtr& node) override;
+    virtual void visitDictionaryLiteral(const DictionaryLiteralPtr& node) override;
+    virtual void visitConditionalOperator(const ConditionalOperatorPtr& node) override;
+    virtual void visitBinaryOperator(const BinaryOperatorPtr& node) override;
+    virtual void visitUnaryOperator(const UnaryOperatorPtr& node) override;
+    virtual void visitTuple(const TuplePtr& node) override;
+    virtual void visitIdentifier(const IdentifierPtr& node) override;
+    virtual void visitCompileConstant(const CompileConstantPtr& node) override;
+    virtual void visitSubscriptAccess(const SubscriptAccessPtr& node) override;
+    virtual void visitMemberAccess(const MemberAccessPtr& node) override;
+    virtual void visitFunctionCall(const FunctionCallPtr& node) override;
+    virtual void visitClosure(const ClosurePtr& node) override;
+    virtual void visitSelf(const SelfExpressionPtr& node) override;
+    virtual void visitInitializerReference(const InitializerReferencePtr& node) override;
+    virtual void visitDynamicType(const DynamicTypePtr& node) override;
+    virtual void visitForcedValue(const ForcedValuePtr& node) override;
+    virtual void visitOptionalChaining(const OptionalChainingPtr& node) override;
+    virtual void visitParenthesizedExpression(const ParenthesizedExpressionPtr& node) override;
+    virtual void visitString(const StringLiteralPtr& node) override;
+    virtual void visitStringInterpolation(const StringInterpolationPtr& node) override;
+    virtual void visitInteger(const IntegerLiteralPtr& node) override;
+    virtual void visitFloat(const FloatLiteralPtr& node) override;
+    virtual void visitNilLiteral(const NilLiteralPtr& node) override;
+    virtual void visitBooleanLiteral(const BooleanLiteralPtr& node) override;
+private:
+    /*!
+     * Reports the construct as unsupported and aborts the lowering
+     */
+    void unsupported(const NodePtr& node, const std::wstring& what);
+    std::wstring getName(const SymbolPtr& symbol);
+    IRTypeRef getType(const TypePtr& type);
+    IRTypeRef getMetatype(const TypePtr& type);
+    bool isTrivial(const TypePtr& type);
+    bool isPrimitive(const TypePtr& type);
+    void emitCopy(IRValue value, const TypePtr& type);
+    void emitDestroy(IRValue value, const TypePtr& type);
+    uint32_t getFieldMember(const TypePtr& type, const SymbolPtr& field);
+    uint32_t getEnumCaseMember(const TypePtr& type, const std::wstring& name);
+    TypePtr getPayloadType(const TypePtr& type, const std::wstring& name);
+private://functions
+    void beginFunction(IRFunction* func, const FunctionSymbolPtr& symbol);
+    void lowerFunction(const FunctionSymbolPtr& symbol, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body);
+    void lowerImplicitInit(const FunctionSymbolPtr& symbol);
+    void lowerTypeDeclaration(const TypeDeclarationPtr& node);
+    void initializeStoredProperties(const TypePtr& type);
+    void emitReturn(IRValue value);
+    void finishFunction();
+private://statements
+    void lowerStatement(const StatementPtr& statement);
+    void lowerStatements(const CodeBlockPtr& codeBlock);
+    void pushScope(SymbolScope* scope);
+    void popScope();
+    void emitCleanups(size_t depth);
+    void declareLocal(const SymbolPtr& symbol, IRValue value);
+    SymbolPtr lookupLocal(const std::wstring& name);
+    void lowerSwitchOnEnum(const SwitchCasePtr& node, IRValue value, uint32_t exitBlock);
+    void lowerSwitchOnValue(const SwitchCasePtr& node, IRValue value, uint32_t exitBlock);
+    void bindPayload(const PatternPtr& pattern, IRValue payload, const TypePtr& type);
+private://expressions
+    IRValue lowerExpression(const PatternPtr& expr);
+    IRValue lowerCondition(const ExpressionPtr& expr);
+    /*!
+     * Lowers an expression whose value is only used during current statement, a parameter is used without copy
+     */
+    IRValue lowerBorrowed(const ExpressionPtr& expr, bool& owned);
+    bool isAddressable(const ExpressionPtr& expr);
+    LValue lowerLValue(const ExpressionPtr& expr);
+    Variable* findVariable(const SymbolPtr& symbol);
+    IRValue loadCopy(const LValue& lv, const TypePtr& type);
+    IRValue lowerEnumCase(const TypePtr& type, const std::wstring& name, IRValue payload);
+    IRValue lowerCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments);
+    IRValue lowerBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+    IRValue lowerShortCircuit(const ExpressionPtr& lhs, const ExpressionPtr& rhs, bool isAnd);
+    IRValue lowerGetter(const FunctionSymbolPtr& getter, const ExpressionPtr& base);
+    bool isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments);
+private:
+    SymbolRegistry* symbolRegistry;
+    CompilerResults* compilerResults;
+    IRModule* module;
+    GlobalScope* global;
+    NameMangling mangling;
+    FunctionContext* ctx;
+    std::vector<std::unique_ptr<FunctionContext> > contexts;
+    //the value of last lowered expression
+    IRValue result;
+    std::unordered_map<Type*, bool> trivialTypes;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_LOWERING_H
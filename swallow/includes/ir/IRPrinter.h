@@ -0,0 +1,62 @@
+/* IRPrinter.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_PRINTER_H
+#define IR_PRINTER_H
+#include "ir/IR.h"
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * \brief Prints IR in the textual form of SIL, so it can be compared with the documented examples.
+ */
+class SWALLOW_EXPORT IRPrinter
+{
+public:
+    IRPrinter(std::wostream& out);
+public:
+    void print(const IRModule* module);
+    void printFunction(const IRModule* module, const IRFunction* func);
+    void printInstruction(const IRModule* module, const IRFunction* func, IRValue value);
+private:
+    void printValue(IRValue value);
+    void printTypedValue(IRValue value);
+    void printType(IRTypeRef type);
+    void printMember(uint32_t member);
+    void printString(const std::wstring& str);
+private:
+    std::wostream& out;
+    const IRModule* module;
+    const IRFunction* function;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_PRINTER_H
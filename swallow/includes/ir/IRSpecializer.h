@@ -0,0 +1,172 @@
+/* IRSpecializer.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_SPECIALIZER_H
+#define IR_SPECIALIZER_H
+#include "swallow_conf.h"
+#include "ir/IR.h"
+#include "codegen/NameMangling.h"
+#include <map>
+#include <vector>
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+typedef std::shared_ptr<class GenericArgument> GenericArgumentPtr;
+
+/*!
+ * Decides which instances of generic functions are given a specialized copy,
+ * instances that are not specialized keep calling the shared generic implementation.
+ */
+struct SpecializationPolicy
+{
+    enum T
+    {
+        //every instance is specialized, only the nesting depth is limited
+        Always,
+        //hot instances or instances of small generic functions are specialized within the code growth budget
+        HotOrSmall,
+        //all call sites keep calling the generic implementation
+        Never
+    };
+};
+
+/*!
+ * An instance is a generic function with a set of generic arguments, call sites with identical interned
+ * arguments share one instance.
+ */
+struct SpecializationInstance
+{
+    uint32_t function;
+    uint32_t substitution;
+    //index of the specialized function, or InvalidFunction
+    uint32_t specialized;
+    uint32_t callSites;
+    //call sites weighted by their loop nesting
+    uint32_t hotness;
+    //nesting level of specializations that led to this instance
+    uint32_t depth;
+    //instructions of the generic implementation and the specialized copy
+    size_t genericSize;
+    size_t specializedSize;
+};
+
+struct SpecializationStatistics
+{
+    uint32_t genericFunctions;
+    uint32_t instances;
+    uint32_t specializedInstances;
+    uint32_t callSites;
+    uint32_t specializedCallSites;
+    //instructions of the module before and after specialization
+    size_t originalSize;
+    size_t finalSize;
+    //reference counting removed because its type became trivial after specialization
+    uint32_t removedRefCounting;
+};
+
+/*!
+ * \brief Monomorphizes generic functions of an IR module.
+ *
+ * Applies with concrete generic arguments are redirected to specialized copies of the generic function, the
+ * copies have all generic parameters substituted, so reference counting on types that became trivial is dropped.
+ * Specialized copies are named by the generic specialization mangling and are deduplicated by the interned
+ * substitution of the apply, new call sites found in a specialized copy are specialized in the next round.
+ */
+class SWALLOW_EXPORT IRSpecializer
+{
+public:
+    static const uint32_t InvalidFunction = 0xffffffff;
+public:
+    IRSpecializer(SymbolRegistry* symbolRegistry, IRModule* module);
+public:
+    void setPolicy(SpecializationPolicy::T policy) { this->policy = policy;}
+    SpecializationPolicy::T getPolicy() const { return policy;}
+    /*!
+     * Generic functions with no more instructions than this are small, default is 32
+     */
+    void setSmallFunctionSize(size_t size) { smallFunctionSize = size;}
+    /*!
+     * Instances with hotness of at least this are hot, a call site counts 1 and a call site inside a loop counts 8,
+     * default is 8
+     */
+    void setHotThreshold(uint32_t hotness) { hotThreshold = hotness;}
+    /*!
+     * Maximum instructions added by HotOrSmall policy, relative to the original size of the module, default is 1.0
+     */
+    void setMaxCodeGrowth(double ratio) { maxCodeGrowth = ratio;}
+    /*!
+     * Maximum nesting level of specializations, it stops the polymorphic recursion, default is 8
+     */
+    void setMaxDepth(uint32_t depth) { maxDepth = depth;}
+    /*!
+     * Specialize the module, returns the number of specialized instances
+     */
+    uint32_t run();
+
+    const SpecializationStatistics& getStatistics() const { return statistics;}
+    const std::vector<SpecializationInstance>& getInstances() const { return instances;}
+    /*!
+     * Prints the statistics and a line for each instance
+     */
+    void dumpStatistics(std::wostream& out) const;
+private:
+    struct CallSite
+    {
+        uint32_t function;
+        IRValue apply;
+        uint32_t instance;
+    };
+    void collectCallSites(uint32_t function, std::vector<CallSite>& callSites);
+    bool shouldSpecialize(const SpecializationInstance& instance, size_t growth) const;
+    bool isConcrete(uint32_t substitution) const;
+    IRTypeRef substitute(IRTypeRef type, const GenericArgumentPtr& arguments);
+    uint32_t specialize(const SpecializationInstance& instance);
+    std::wstring getSignature(const IRFunction* func);
+    bool isTrivial(const TypePtr& type);
+private:
+    IRModule* module;
+    NameMangling mangling;
+    SpecializationPolicy::T policy;
+    size_t smallFunctionSize;
+    uint32_t hotThreshold;
+    double maxCodeGrowth;
+    uint32_t maxDepth;
+    SpecializationStatistics statistics;
+    std::vector<SpecializationInstance> instances;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> instanceIndex;
+    //depth of the instance a specialized function was created for
+    std::map<uint32_t, uint32_t> functionDepth;
+    std::map<Type*, bool> trivialTypes;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_SPECIALIZER_H
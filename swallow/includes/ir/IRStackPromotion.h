@@ -0,0 +1,82 @@
+/* IRStackPromotion.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IR_STACK_PROMOTION_H
+#define IR_STACK_PROMOTION_H
+#include "swallow_conf.h"
+#include "ir/IR.h"
+#include "ir/IREscapeAnalysis.h"
+#include <map>
+#include <iostream>
+
+SWALLOW_NS_BEGIN
+
+class FunctionSymbol;
+
+struct StackPromotionStatistics
+{
+    uint32_t allocations;
+    uint32_t promoted;
+    //local objects kept on heap because a deinitializer may let self escape
+    uint32_t escapingDeinits;
+};
+
+/*!
+ * \brief Allocates class instances that never escape their function on the stack.
+ *
+ * An alloc_ref is promoted when IREscapeAnalysis proves the object is local to the block it's allocated in and
+ * no deinitializer in its class hierarchy lets self escape, the promoted alloc_ref is flagged and the backends
+ * reserve the storage in the function's frame. The reference counting is kept, the final release still runs the
+ * deinitializers but it doesn't free the storage.
+ */
+class SWALLOW_EXPORT IRStackPromotion
+{
+public:
+    IRStackPromotion(IRModule* module);
+public:
+    /*!
+     * Promote all allocations of the module, returns the number of promoted allocations
+     */
+    uint32_t run();
+
+    const StackPromotionStatistics& getStatistics() const { return statistics;}
+    void dumpStatistics(std::wostream& out) const;
+private:
+    bool isDeinitEscaping(const TypePtr& type);
+private:
+    IRModule* module;
+    IREscapeAnalysis escapeAnalysis;
+    StackPromotionStatistics statistics;
+    std::map<const FunctionSymbol*, const IRFunction*> functionsBySymbol;
+    std::map<Type*, bool> escapingDeinits;
+};
+
+SWALLOW_NS_END
+
+#endif//IR_STACK_PROMOTION_H
@@ -52,6 +52,12 @@ public:
     bool parse(const wchar_t* code, const ProgramPtr& program);
     void setFileName(const wchar_t* fileName);
     void setFunctionName(const wchar_t* function);
+    /*!
+     * When error recovery is enabled, the parser skips the broken statement to the next
+     * synchronization point and replaces it with an ErrorNode instead of stopping at the
+     * first error, so a single pass reports all independent errors in a file.
+     */
+    void setErrorRecovery(bool errorRecovery);
 private:
     TypeNodePtr parseType();
     TypeNodePtr parseTypeAnnotation();
@@ -155,6 +161,18 @@ private:
      * Restore the position of tokenizer to specified token
      */
     void restore(Token& token);
+    /*!
+     * Source position of given token
+     */
+    SourceInfo location(const Token& token);
+    /*!
+     * Source position of the tokenizer's cursor
+     */
+    SourceInfo location();
+    /*!
+     * Resolve the line of given token
+     */
+    int line(const Token& token);
     /*!
      * Read next token from tokenizer, return false if EOF reached.
      */
@@ -203,6 +221,26 @@ private:
 
     void tassert(Token& token, bool cond, int errorCode);
     void tassert(Token& token, bool cond, int errorCode, const std::wstring& s);
+
+    /*!
+     * Recover from a failed statement that starts at given token, returns false if
+     * error recovery is disabled or no more errors can be accepted.
+     */
+    bool recover(const Token& start);
+    /*!
+     * Skip the statement that starts at given token to the next synchronization point:
+     * a semicolon, the closing bracket of enclosing block or the first token of next statement
+     * in a new line, brackets are skipped in balance.
+     */
+    void synchronize(const Token& start);
+    /*!
+     * Check if the parser has consumed any token since given token
+     */
+    bool advanced(const Token& start);
+    /*!
+     * Check if the token can begin a statement when it appears at the start of a line
+     */
+    bool isStatementStart(const Token& token);
 private:
     Tokenizer* tokenizer;
     NodeFactory* nodeFactory;
@@ -211,6 +249,7 @@ private:
     int fileHash;
     std::wstring functionName;
     int flags;
+    bool errorRecovery;
 
 };
 
@@ -0,0 +1,149 @@
+/* BatchCompiler.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef BATCH_COMPILER_H
+#define BATCH_COMPILER_H
+#include "swallow_conf.h"
+#include "common/CompilerResults.h"
+#include "common/CompilerStats.h"
+#include <string>
+#include <vector>
+
+SWALLOW_NS_BEGIN
+
+class SymbolRegistry;
+class GlobalScope;
+class CompilerTrace;
+typedef std::shared_ptr<class ScopedProgram> ScopedProgramPtr;
+typedef std::shared_ptr<class TypeCache> TypeCachePtr;
+
+/*!
+ * A single independent source to be compiled by BatchCompiler
+ */
+struct SWALLOW_EXPORT BatchItem
+{
+    std::wstring fileName;
+    std::wstring code;
+    BatchItem(const std::wstring& fileName, const std::wstring& code)
+    :fileName(fileName), code(code)
+    {}
+};
+
+/*!
+ * The compilation result of a BatchItem
+ */
+struct SWALLOW_EXPORT BatchResult
+{
+    std::wstring fileName;
+    CompilerResults compilerResults;
+    /*!
+     * The types created by the compilation, they're released after the program.
+     */
+    TypeCachePtr types;
+    /*!
+     * The analyzed program, only available when keepAST is enabled and no fatal error occurred.
+     */
+    ScopedProgramPtr program;
+    /*!
+     * Phase times and counters of this item
+     */
+    CompilerStats stats;
+    bool successed;
+    BatchResult()
+    :successed(false)
+    {}
+};
+
+/*!
+ * Compiles many independent sources concurrently.
+ * All sources are analyzed on top of the same standard library global scope which is initialized only once,
+ * each source gets its own SymbolRegistry, node factory and compiler results.
+ */
+class SWALLOW_EXPORT BatchCompiler
+{
+public:
+    /*!
+     * \param numThreads Number of worker threads, 0 means the number of cores
+     */
+    BatchCompiler(int numThreads = 0);
+    ~BatchCompiler();
+public:
+    /*!
+     * Gets the shared global scope, external functions should be declared here before compiling.
+     */
+    GlobalScope* getGlobalScope();
+
+    /*!
+     * Keep the analyzed AST in result, default is false
+     */
+    void setKeepAST(bool keepAST);
+
+    /*!
+     * Records the timeline of all compilations to given trace, default is null
+     */
+    void setTrace(CompilerTrace* trace);
+
+    /*!
+     * Limits the cost of type checking a single statement, 0 means unlimited.
+     * Default is SemanticAnalyzer::DefaultMaxExpressionCost
+     */
+    void setMaxExpressionCost(int maxExpressionCost);
+
+    /*!
+     * Limits the number of compiler results kept for each item, 0 means unlimited.
+     * Default is CompilerResults::DefaultLimit
+     */
+    void setMaxResults(int maxResults);
+
+    /*!
+     * Compile all items concurrently, results are stored in the same order of items.
+     */
+    void compile(const std::vector<BatchItem>& items, std::vector<BatchResult>& results);
+
+    /*!
+     * Compile a single item in the caller's thread
+     */
+    void compile(const BatchItem& item, BatchResult& result);
+
+    /*!
+     * Collect all .swift files under given directory(not recursively), sorted by file name.
+     */
+    static bool readDirectory(const std::string& path, std::vector<BatchItem>& items);
+private:
+    SymbolRegistry* stdlib;
+    int numThreads;
+    bool keepAST;
+    CompilerTrace* trace;
+    int maxExpressionCost;
+    int maxResults;
+};
+
+SWALLOW_NS_END
+
+#endif//BATCH_COMPILER_H
@@ -63,6 +63,10 @@ public:
      */
     void warning(const NodePtr& node, int code, const std::wstring& item = std::wstring());
 
+    /*!
+     * Line of the node for trace events, it's only resolved when a trace is recording
+     */
+    int getTraceLine(const NodePtr& node) const;
 protected:
     CompilerResults* compilerResults;
 };
@@ -0,0 +1,129 @@
+/* ConstantFolder.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CONSTANT_FOLDER_H
+#define CONSTANT_FOLDER_H
+#include "SemanticPass.h"
+#include "ast/NodeFactory.h"
+#include <unordered_map>
+#include <vector>
+
+SWALLOW_NS_BEGIN
+
+class SymbolScope;
+class Symbol;
+typedef std::shared_ptr<class Type> TypePtr;
+typedef std::shared_ptr<class TypeDeclaration> TypeDeclarationPtr;
+
+/*!
+ * \brief Evaluates operators on literals at compile time and replaces them with literal nodes.
+ *
+ * It runs after SemanticAnalyzer, only the standard library's operators on the standard numeric
+ * types, Bool and String are evaluated, the literal types are the ones inferred by the analyzer,
+ * so a folded literal keeps the type that the operator would return.
+ * Constants declared by let with a foldable initializer are propagated to where they are referenced.
+ *
+ * Integer overflow and division by zero are reported as compile errors.
+ */
+class SWALLOW_EXPORT ConstantFolder : public SemanticPass
+{
+private:
+    struct Constant;
+public:
+    ConstantFolder(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults);
+public:
+    virtual void visitProgram(const ProgramPtr& node) override;
+    virtual void visitCodeBlock(const CodeBlockPtr& node) override;
+    virtual void visitClosure(const ClosurePtr& node) override;
+    virtual void visitClass(const ClassDefPtr& node) override;
+    virtual void visitStruct(const StructDefPtr& node) override;
+    virtual void visitEnum(const EnumDefPtr& node) override;
+    virtual void visitExtension(const ExtensionDefPtr& node) override;
+    virtual void visitProtocol(const ProtocolDefPtr& node) override;
+    virtual void visitValueBindings(const ValueBindingsPtr& node) override;
+    virtual void visitComputedProperty(const ComputedPropertyPtr& node) override;
+    virtual void visitAssignment(const AssignmentPtr& node) override;
+    virtual void visitBinaryOperator(const BinaryOperatorPtr& node) override;
+    virtual void visitUnaryOperator(const UnaryOperatorPtr& node) override;
+    virtual void visitConditionalOperator(const ConditionalOperatorPtr& node) override;
+    virtual void visitTuple(const TuplePtr& node) override;
+    virtual void visitParenthesizedExpression(const ParenthesizedExpressionPtr& node) override;
+    virtual void visitArrayLiteral(const ArrayLiteralPtr& node) override;
+    virtual void visitDictionaryLiteral(const DictionaryLiteralPtr& node) override;
+    virtual void visitStringInterpolation(const StringInterpolationPtr& node) override;
+    virtual void visitReturn(const ReturnStatementPtr& node) override;
+    virtual void visitIf(const IfStatementPtr& node) override;
+    virtual void visitWhileLoop(const WhileLoopPtr& node) override;
+    virtual void visitDoLoop(const DoLoopPtr& node) override;
+    virtual void visitForLoop(const ForLoopPtr& node) override;
+    virtual void visitSwitchCase(const SwitchCasePtr& node) override;
+public:
+    /*!
+     * Folds the expression and its sub expressions, returns the literal that replaces it
+     * or the expression itself if it cannot be evaluated at compile time.
+     */
+    ExpressionPtr fold(const ExpressionPtr& expr);
+private:
+    template<class T, typename Ptr = std::shared_ptr<T>>
+    Ptr transform(const Ptr& ptr)
+    {
+        if(!ptr)
+            return nullptr;
+        ExpressionPtr expr = std::dynamic_pointer_cast<Expression>(ptr);
+        if(!expr)
+        {
+            std::static_pointer_cast<Node>(ptr)->accept(this);
+            return ptr;
+        }
+        return std::static_pointer_cast<T>(fold(expr));
+    }
+    void visitTypeDeclaration(const TypeDeclarationPtr& node);
+    bool evaluate(const ExpressionPtr& expr, Constant& ret);
+    bool evaluateBinary(const BinaryOperatorPtr& node, Constant& ret);
+    bool evaluateUnary(const UnaryOperatorPtr& node, Constant& ret);
+    bool checkIntegerRange(const ExpressionPtr& node, const std::wstring& expr, const TypePtr& type, Constant& value);
+    ExpressionPtr createLiteral(const ExpressionPtr& node, const Constant& value);
+private:
+    /*!
+     * Scope of the let constants being recorded, null inside a type declaration
+     */
+    SymbolScope* scope;
+    /*!
+     * Folded initializers of let constants
+     */
+    std::unordered_map<Symbol*, ExpressionPtr> constants;
+    /*!
+     * Creates the folded literals, the parser's factory may not outlive the AST
+     */
+    NodeFactory nodeFactory;
+};
+
+SWALLOW_NS_END
+
+#endif//CONSTANT_FOLDER_H
@@ -0,0 +1,107 @@
+/* ControlFlowGraph.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef CONTROL_FLOW_GRAPH_H
+#define CONTROL_FLOW_GRAPH_H
+#include "swallow_conf.h"
+#include "ast/ast-decl.h"
+#include <vector>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+class Node;
+class FlatAST;
+
+/*!
+ * \brief Control flow graph of a function body, built by walking the body in a FlatAST.
+ *
+ * A block is a range of elements that are executed in order, an element is either a statement or a part of
+ * a control statement that is evaluated in the block, like the condition of if/while or the step of a for loop.
+ * Control statements themselves are not elements, their branches are turned into edges.
+ * The elements, successors and predecessors of all blocks are stored in flat arrays and each block refers
+ * to a range of them.
+ *
+ * Block 0 is the entry and block 1 is the exit, return statements jump to the exit. The statements following
+ * return/break/continue/fallthrough start a block without predecessors.
+ * Closures, nested functions and nested types are kept as single elements.
+ * The graph refers to the tree nodes of the flat AST without owning them.
+ */
+class SWALLOW_EXPORT ControlFlowGraph
+{
+    friend class ControlFlowGraphBuilder;
+public:
+    enum : uint32_t
+    {
+        Entry = 0,
+        Exit = 1,
+        InvalidBlock = 0xffffffff
+    };
+    struct Block
+    {
+        uint32_t firstElement;
+        uint32_t numElements;
+        uint32_t firstSuccessor;
+        uint32_t numSuccessors;
+        uint32_t firstPredecessor;
+        uint32_t numPredecessors;
+    };
+public:
+    /*!
+     * Builds the graph of the code block at given index of the flat AST
+     */
+    ControlFlowGraph(const FlatAST& ast, uint32_t body);
+    /*!
+     * Builds the graph from a flat AST of the body
+     */
+    ControlFlowGraph(const CodeBlockPtr& body);
+public:
+    uint32_t numBlocks() const { return blocks.size();}
+    const Block& getBlock(uint32_t block) const { return blocks[block];}
+    /*!
+     * Elements of all blocks are indexed globally, elements of a block are [firstElement, firstElement + numElements)
+     */
+    uint32_t numElements() const { return elements.size();}
+    Node* getElement(uint32_t element) const { return elements[element];}
+    uint32_t getSuccessor(uint32_t block, uint32_t idx) const { return successors[blocks[block].firstSuccessor + idx];}
+    uint32_t getPredecessor(uint32_t block, uint32_t idx) const { return predecessors[blocks[block].firstPredecessor + idx];}
+    /*!
+     * Gets the block that contains given element, returns InvalidBlock if it's not an element of the graph
+     */
+    uint32_t findBlock(const Node* element) const;
+private:
+    std::vector<Block> blocks;
+    std::vector<Node*> elements;
+    std::vector<uint32_t> successors;
+    std::vector<uint32_t> predecessors;
+};
+
+SWALLOW_NS_END
+
+#endif//CONTROL_FLOW_GRAPH_H
@@ -0,0 +1,140 @@
+/* DataFlowAnalysis.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef DATA_FLOW_ANALYSIS_H
+#define DATA_FLOW_ANALYSIS_H
+#include "swallow_conf.h"
+#include "common/BitVector.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdint>
+
+SWALLOW_NS_BEGIN
+
+class ControlFlowGraph;
+
+/*!
+ * \brief The local variables of a function body and where the elements of its ControlFlowGraph access them.
+ *
+ * Variables are the names bound by let/var, if-let and for-in inside the body, and they're identified by name
+ * so a name rebound in a nested scope is the same variable. The accesses of each element are recorded in
+ * evaluation order, a variable used by an assignment's right hand side is read before it's written.
+ * Closures and nested functions only read the variables they capture.
+ */
+class SWALLOW_EXPORT LocalVariables
+{
+    friend class VariableAccessCollector;
+public:
+    struct Access
+    {
+        uint32_t variable;
+        bool write;
+    };
+public:
+    LocalVariables(const ControlFlowGraph& cfg);
+public:
+    uint32_t size() const { return names.size();}
+    const std::wstring& getName(uint32_t variable) const { return names[variable];}
+    /*!
+     * Gets the index of the variable, returns -1 if it's not a local variable of the function body
+     */
+    int indexOf(const std::wstring& name) const;
+    uint32_t numAccesses(uint32_t element) const { return offsets[element + 1] - offsets[element];}
+    const Access& getAccess(uint32_t element, uint32_t idx) const { return accesses[offsets[element] + idx];}
+private:
+    std::vector<std::wstring> names;
+    std::map<std::wstring, uint32_t> indices;
+    std::vector<Access> accesses;
+    std::vector<uint32_t> offsets;
+};
+
+/*!
+ * \brief Generic bit-vector dataflow over a ControlFlowGraph.
+ *
+ * Each block is summarized by a gen and a kill set, the transfer function is out = gen | (in - kill) for
+ * forward problems and in = gen | (out - kill) for backward problems, values of the predecessors(forward)
+ * or successors(backward) are combined by the meet operator.
+ * The boundary value is given to the entry(forward) or the exit(backward) block, other blocks start from
+ * the identity of the meet operator, then blocks are updated from a worklist until nothing changes.
+ */
+class SWALLOW_EXPORT DataFlowAnalysis
+{
+public:
+    enum Direction
+    {
+        Forward,
+        Backward
+    };
+    enum Meet
+    {
+        Union,
+        Intersection
+    };
+public:
+    DataFlowAnalysis(const ControlFlowGraph& cfg, Direction direction, Meet meet, size_t numBits);
+public:
+    BitVector& gen(uint32_t block) { return gens[block];}
+    BitVector& kill(uint32_t block) { return kills[block];}
+    void setBoundary(const BitVector& value) { boundary = value;}
+    void solve();
+    const BitVector& getIn(uint32_t block) const { return ins[block];}
+    const BitVector& getOut(uint32_t block) const { return outs[block];}
+    /*!
+     * Number of block updates done by the last solve
+     */
+    size_t getIterations() const { return iterations;}
+public:
+    /*!
+     * Forward with one bit, the bit of getOut(block) is set if the block is reachable from the entry
+     */
+    static DataFlowAnalysis reachability(const ControlFlowGraph& cfg);
+    /*!
+     * Backward on variables, getIn(block) is the variables that may be read before written after entering the block
+     */
+    static DataFlowAnalysis liveness(const ControlFlowGraph& cfg, const LocalVariables& variables);
+    /*!
+     * Forward on variables, getIn(block) is the variables that are written on all paths reaching the block
+     */
+    static DataFlowAnalysis definiteAssignment(const ControlFlowGraph& cfg, const LocalVariables& variables);
+private:
+    const ControlFlowGraph* cfg;
+    Direction direction;
+    Meet meet;
+    BitVector boundary;
+    std::vector<BitVector> gens;
+    std::vector<BitVector> kills;
+    std::vector<BitVector> ins;
+    std::vector<BitVector> outs;
+    size_t iterations;
+};
+
+SWALLOW_NS_END
+
+#endif//DATA_FLOW_ANALYSIS_H
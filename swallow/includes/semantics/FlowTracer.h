@@ -0,0 +1,198 @@
+/* FlowTracer.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FLOW_TRACER_H
+#define FLOW_TRACER_H
+#include "swallow_conf.h"
+#include <memory>
+#include <algorithm>
+
+SWALLOW_NS_BEGIN
+
+    class Node;
+    enum ReturnCoverResult
+    {
+        ReturnCoverNoResult = 0,
+        /*!
+         * No branch matched
+         */
+        ReturnCoverUnmatched = 1,
+        /*!
+         * Partially matched
+         */
+        ReturnCoverPartial = 3,
+        /*!
+         * All possible paths are covered
+         */
+        ReturnCoverFull = 2,
+        /*!
+         * Exists more than once
+         */
+        ReturnCoverDeadcode = 4
+    };
+    enum InitializerCoverResult
+    {
+        InitializerCoverNoResult = 0,
+        /*!
+         * No branch matched
+         */
+        InitializerCoverUnmatched = 1,
+        /*!
+         * Partially matched
+         */
+        InitializerCoverPartial = 3,
+        /*!
+         * All possible paths are covered
+         */
+        InitializerCoverFull = 2,
+        /*!
+         * Exists more than once
+         */
+        InitializerCoverMultiple = 4
+    };
+    /*!
+     * A FlowTracer summarizes the control flow of a function body while the
+     * SemanticAnalyzer is visiting it, so return coverage, dead code and
+     * self.init/super.init delegation can be checked without walking the body again.
+     *
+     * Like InitializationTracer, a tracer is created for each statement(Sequence) and
+     * each branch of if/switch(Branch), and merges its summary into the parent tracer
+     * when it goes out of scope.
+     */
+    class FlowTracer
+    {
+        typedef std::shared_ptr<Node> NodePtr;
+    public:
+        enum Type
+        {
+            /*!
+             * The tracer runs after its previous siblings
+             */
+            Sequence,
+            /*!
+             * The tracer is one of the alternatives of its siblings
+             */
+            Branch
+        };
+    public:
+        FlowTracer(FlowTracer* parent, Type type)
+        :parent(parent), type(type), returns(ReturnCoverNoResult), initializers(InitializerCoverNoResult), unreachable(false)
+        {
+        }
+        ~FlowTracer()
+        {
+            if(!parent)
+                return;
+            parent->mergeReturns(type, returns, returnRefNode);
+            parent->mergeInitializers(type, initializers, initializerRefNode);
+        }
+    public:
+        /*!
+         * A return statement is reached
+         */
+        void addReturn()
+        {
+            if(!unreachable)
+                returns = (ReturnCoverResult)(returns | ReturnCoverFull);
+        }
+        /*!
+         * A statement-level X.init(...) call is reached
+         */
+        void addInitializerCall(const NodePtr& node)
+        {
+            mergeInitializers(Sequence, InitializerCoverFull, node);
+        }
+        /*!
+         * Returns true if all paths traced so far are returned
+         */
+        bool isReturned() const
+        {
+            return returns == ReturnCoverFull;
+        }
+        /*!
+         * Mark given statement and the rest of current code block as unreachable
+         */
+        void markUnreachable(const NodePtr& node)
+        {
+            returns = ReturnCoverDeadcode;
+            returnRefNode = node;
+            unreachable = true;
+        }
+    private:
+        void mergeReturns(Type mergeType, ReturnCoverResult result, const NodePtr& refNode)
+        {
+            if(unreachable)
+                return;
+            if(mergeType == Branch && result == ReturnCoverNoResult)
+                result = ReturnCoverUnmatched;
+            //in sequence mode, the full cover result will override previous result
+            if(mergeType == Sequence && result == ReturnCoverFull)
+                returns = result;
+            returns = (ReturnCoverResult)(returns | result);
+            if((returns & ReturnCoverDeadcode) && !returnRefNode)
+                returnRefNode = refNode;
+        }
+        void mergeInitializers(Type mergeType, InitializerCoverResult result, const NodePtr& refNode)
+        {
+            if(mergeType == Branch && result == InitializerCoverNoResult)
+                result = InitializerCoverUnmatched;
+            if(mergeType == Sequence)
+            {
+                //calling initializer delegation will not interrupt the workflow, so it can be called more than once
+                if((initializers & InitializerCoverFull) && (result & InitializerCoverFull))
+                    initializers = (InitializerCoverResult)(initializers | InitializerCoverMultiple);
+                initializers = std::max(initializers, result);
+            }
+            else
+            {
+                initializers = (InitializerCoverResult)(initializers | result);
+            }
+            if((initializers & InitializerCoverMultiple) && !initializerRefNode)
+                initializerRefNode = refNode;
+        }
+    public:
+        FlowTracer* parent;
+        Type type;
+        ReturnCoverResult returns;
+        /*!
+         * The first unreachable statement
+         */
+        NodePtr returnRefNode;
+        InitializerCoverResult initializers;
+        /*!
+         * The redundant initializer call
+         */
+        NodePtr initializerRefNode;
+        bool unreachable;
+    };
+
+SWALLOW_NS_END
+
+
+#endif//FLOW_TRACER_H
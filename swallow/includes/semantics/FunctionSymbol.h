@@ -31,7 +31,9 @@
 #define FUNCTION_SYMBOL_H
 #include "swallow_conf.h"
 #include "Symbol.h"
+#include "Type.h"
 #include <vector>
+#include <map>
 
 SWALLOW_NS_BEGIN
 typedef std::shared_ptr<Symbol> SymbolPtr;
@@ -39,6 +41,8 @@ typedef std::shared_ptr<class FunctionDef> FunctionDefPtr;
 typedef std::weak_ptr<class FunctionDef> FunctionDefWeakPtr;
 typedef std::shared_ptr<class CodeBlock> CodeBlockPtr;
 typedef std::weak_ptr<class CodeBlock> CodeBlockWeakPtr;
+typedef std::shared_ptr<class GenericArgument> GenericArgumentPtr;
+typedef std::weak_ptr<class FunctionSymbol> FunctionSymbolWeakPtr;
 
 enum FunctionRole
 {
@@ -104,15 +108,45 @@ public:
     CodeBlockPtr getDefinition();
     FunctionRole getRole() const { return role;}
     void setRole(FunctionRole role) { this->role = role;}
-    ComputedPropertySymbolPtr getOwnerProperty() { return ownerProperty;}
+    ComputedPropertySymbolPtr getOwnerProperty() { return ownerProperty.lock();}
     void setOwnerProperty(const ComputedPropertySymbolPtr& v) { ownerProperty = v;}
+    /*!
+     * The generic function this function is specialized from by a call site, it's null for non-specialized functions.
+     */
+    FunctionSymbolPtr getGenericFunction() const { return genericFunction.lock();}
+    /*!
+     * The generic arguments used to specialize the generic function
+     */
+    const GenericArgumentPtr& getGenericArguments() const { return genericArguments;}
+    /*!
+     * Gets the specialization of a generic function by given generic arguments.
+     * Specializations are created on first use and cached weakly by the generic function, so call sites with
+     * identical generic arguments share the same symbol while it's in use, and a shared generic function of
+     * the standard library doesn't keep the specializations of finished compilations alive.
+     * The caller owns the returned symbol, see SymbolScope::addSpecialization.
+     */
+    static FunctionSymbolPtr getSpecialization(const FunctionSymbolPtr& genericFunction, const GenericArgumentPtr& arguments);
+private:
+    /*!
+     * Drops the specializations that are no longer referenced once the cache reaches the sweep size,
+     * the sweep size grows with the live entries so the cost is amortized.
+     */
+    void sweepSpecializations();
 
 private:
     std::wstring name;
     TypePtr type;
     FunctionRole role;
     CodeBlockWeakPtr definition;
-    ComputedPropertySymbolPtr ownerProperty;
+    //the property owns its accessors
+    std::weak_ptr<ComputedPropertySymbol> ownerProperty;
+    FunctionSymbolWeakPtr genericFunction;
+    GenericArgumentPtr genericArguments;
+    std::map<GenericArgumentKey, FunctionSymbolWeakPtr> specializations;
+    /*!
+     * Expired specializations are swept when the cache grows to this size
+     */
+    size_t specializationSweepSize;
 };
 
 
@@ -37,8 +37,8 @@
 SWALLOW_NS_BEGIN
     /*!
      * A InitializationTracer will trace symbol initialization in all branches
-     * This is different to InitializerValidator that it will perform an in-place
-     * symbol initialization tracing during a normal semantic pass.
+     * It performs an in-place symbol initialization tracing during a normal semantic pass,
+     * the same way FlowTracer summarizes returns and initializer delegations.
      * It's used to detect if a symbol is initialized in all possible paths
      */
     class InitializationTracer
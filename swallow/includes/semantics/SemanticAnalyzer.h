@@ -137,6 +137,13 @@ public://Syntax sugar for type
     virtual void visitOptionalType(const OptionalTypePtr& node);
 public:
     SemanticContext* getContext() {return &ctx;}
+    /*!
+     * Limits the cost of type checking a single statement, a statement exceeding it is reported as too complex.
+     * 0 means unlimited, default is DefaultMaxExpressionCost.
+     */
+    void setMaxExpressionCost(int maxExpressionCost) { this->maxExpressionCost = maxExpressionCost;}
+    int getMaxExpressionCost() const { return maxExpressionCost;}
+    static const int DefaultMaxExpressionCost = 100000;
 
     /*!
      * This implementation will try to find the member from the type, and look up from extension as a fallback.
@@ -170,7 +177,7 @@ private:
     TypePtr evaluateType(const ExpressionPtr& expr);
 
     bool hasOptionalChaining(const NodePtr& node);
-    bool isParentInOptionalChain(const NodePtr& node);
+    bool isParentInOptionalChain(Node* node);
 
     /*!
      * Calculates the fit score of arguments on given function
@@ -180,13 +187,48 @@ private:
     float calculateFitScore(bool mutatingSelf, SymbolPtr& func, const ParenthesizedExpressionPtr& arguments, bool supressErrors);
 
     bool checkArgument(const TypePtr& funcType, const Parameter& parameter, const std::pair<std::wstring, ExpressionPtr>& argument, bool variadic, float& score, bool supressErrors, std::map<std::wstring, TypePtr>& genericTypes);
+    /*!
+     * Checks an argument that was analyzed by analyzeArguments, its literals are inferred from the parameter type
+     * without analyzing it again. The argument is converted to the parameter type when errors are not suppressed.
+     */
+    bool checkAnalyzedArgument(const TypePtr& funcType, const Parameter& parameter, const std::wstring& name, ExpressionPtr& argument, float& score, bool supressErrors, std::map<std::wstring, TypePtr>& genericTypes);
     TypePtr getExpressionType(const ExpressionPtr& expr, const TypePtr& hint, float& score);
+    /*!
+     * Analyzes the arguments whose type doesn't depend on the contextual type before resolving the overload,
+     * all candidates reuse the result instead of analyzing them again for each parameter.
+     */
+    void analyzeArguments(const ParenthesizedExpressionPtr& arguments);
+    /*!
+     * Returns true if the type of the expression doesn't depend on the contextual type, literals are included
+     * because they can be inferred again by applyContextualType.
+     */
+    bool isContextFree(const ExpressionPtr& expr);
+    /*!
+     * Returns true if the identifier refers to an overloaded or a generic function, the contextual type decides
+     * which overload is referenced or how the function is specialized.
+     */
+    bool isContextDependentFunction(const IdentifierPtr& id);
+    /*!
+     * Propagates the contextual type down to an expression of literals that was analyzed without it,
+     * the literals take the contextual type and the operators between them are resolved again without
+     * visiting the operands.
+     */
+    void applyContextualType(const ExpressionPtr& expr, const TypePtr& type);
+    /*!
+     * Resolves an operator of literals again with the overloads that return given type
+     */
+    void inferOperatorType(const ExpressionPtr& node, const TypePtr& type);
 
     /*!
      * Return a function that matches the given argument
      * This will always returns a matched function, if no functions matched it will throw exception and abort the process
      */
     SymbolPtr getOverloadedFunction(bool mutatingSelf, const NodePtr& node, const std::vector<SymbolPtr>& funcs, const ParenthesizedExpressionPtr& arguments);
+    /*!
+     * Charges the type checking cost of current statement on given sub-expression, it's aborted with an error at
+     * the most expensive sub-expression when the cost exceeds the limit.
+     */
+    void chargeExpressionCost(const NodePtr& node, int cost);
     /*!
      * Check if the given expression can be converted to given type
      */
@@ -282,6 +324,7 @@ protected:
     DeclarationAnalyzer* declarationAnalyzer;
     std::map<std::wstring, std::list<DeclarationPtr>> lazyDeclarations;
     bool lazyDeclaration;
+    int maxExpressionCost;
 };
 
 SWALLOW_NS_END
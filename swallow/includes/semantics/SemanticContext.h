@@ -30,11 +30,36 @@
 #ifndef SEMANTIC_CONTEXT_H
 #define SEMANTIC_CONTEXT_H
 #include "Type.h"
+#include <unordered_map>
 
 SWALLOW_NS_BEGIN
 
 class ScopedCodeBlock;
 class InitializationTracer;
+class FlowTracer;
+class Node;
+typedef std::shared_ptr<Node> NodePtr;
+
+/*!
+ * Cost of type checking a statement, it's charged by overload candidates tried, generic candidates to specialize
+ * and elements of collection literals to infer. Sub-expressions checked again for each candidate are charged again.
+ */
+struct ExpressionCost
+{
+    int total;
+    /*!
+     * Cost charged by each sub-expression
+     */
+    std::unordered_map<Node*, int> nodes;
+    /*!
+     * The sub-expression that charged the most
+     */
+    NodePtr hotNode;
+    int hotCost;
+    ExpressionCost()
+        :total(0), hotCost(0)
+    {}
+};
 
 
 struct SemanticContext
@@ -61,11 +86,13 @@ struct SemanticContext
     TypePtr currentFunction;
     ScopedCodeBlock* currentCodeBlock;
     InitializationTracer* currentInitializationTracer;
+    FlowTracer* currentFlowTracer;
+    ExpressionCost* expressionCost;
     int numTemporaryNames;
     int flags;
 
     SemanticContext()
-        :currentCodeBlock(nullptr), currentInitializationTracer(nullptr), numTemporaryNames(0), flags(FLAG_PROCESS_DECLARATION | FLAG_PROCESS_IMPLEMENTATION)
+        :currentCodeBlock(nullptr), currentInitializationTracer(nullptr), currentFlowTracer(nullptr), expressionCost(nullptr), numTemporaryNames(0), flags(FLAG_PROCESS_DECLARATION | FLAG_PROCESS_IMPLEMENTATION)
     {}
 };
 
@@ -47,6 +47,14 @@ class SWALLOW_EXPORT SymbolRegistry
     friend class SymbolScope;
 public:
     SymbolRegistry();
+    /*!
+     * Create a registry on top of an existing global scope, the global scope is shared and not owned by this registry.
+     * Symbols are only declared in the registry's own scopes, but the generic types and functions of the shared
+     * global scope still cache their specializations: activate a TypeCache during the compilation to keep them out
+     * of the shared types. Writes to the shared caches are serialized, so multiple registries can analyze different
+     * sources concurrently.
+     */
+    SymbolRegistry(GlobalScope* globalScope);
     ~SymbolRegistry();
 public:
     bool registerOperator(const std::wstring& name, OperatorType::T type, Associativity::T associativity = Associativity::None, int precedence = 100);
@@ -89,6 +97,7 @@ private:
     SymbolScope* currentScope;
     GlobalScope* globalScope;
     SymbolScope* fileScope;
+    bool sharedGlobalScope;
 };
 
 SWALLOW_NS_END
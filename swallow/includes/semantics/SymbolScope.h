@@ -31,6 +31,7 @@
 #define SYMBOL_SCOPE_H
 #include "swallow_conf.h"
 #include <map>
+#include <set>
 #include <memory>
 #include "semantic-types.h"
 #include "swallow_types.h"
@@ -88,12 +89,19 @@ public:
      * Register an extension to this scope.
      */
     void addExtension(const TypePtr& extension);
+
+    /*!
+     * Keeps a specialized function used by the code of this scope alive,
+     * the generic function only caches its specializations weakly.
+     */
+    void addSpecialization(const FunctionSymbolPtr& func);
 protected:
     OperatorMap operators;
     Node* owner;
     SymbolScope* parent;
     SymbolMap symbols;
     std::map<std::wstring, TypePtr> extensions;
+    std::set<FunctionSymbolPtr> specializations;
 };
 
 
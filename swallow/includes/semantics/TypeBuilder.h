@@ -85,6 +85,12 @@ public:
      * add a new enum case
      */
     void addEnumCase(const std::wstring& name, const TypePtr& associatedType);
+
+    /*!
+     * Drops all references to other types and symbols, used to break the reference cycles between the types of a
+     * finished compilation, see TypeCache
+     */
+    void releaseReferences();
 };
 typedef std::shared_ptr<TypeBuilder> TypeBuilderPtr;
 
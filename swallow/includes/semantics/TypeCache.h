@@ -0,0 +1,110 @@
+/* TypeCache.h --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef TYPE_CACHE_H
+#define TYPE_CACHE_H
+#include "swallow_conf.h"
+#include "semantics/Type.h"
+#include <map>
+#include <vector>
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * \brief Types created by a single compilation.
+ *
+ * Generic types cache their specialized versions, the generic types of a shared global scope would keep the
+ * specializations of every compilation alive, together with the user types used as generic arguments.
+ * While a cache is activated on current thread by TypeCacheScope, new specializations are stored in it instead of
+ * the generic types, and every new type is tracked by it.
+ * Types reference each other through their members, when the cache is cleared or destroyed all tracked types drop
+ * their references so the cycles between them are released, so it must outlive the AST of the compilation.
+ */
+class SWALLOW_EXPORT TypeCache
+{
+    friend class TypeCacheScope;
+public:
+    ~TypeCache();
+public:
+    /*!
+     * Gets the cached specialization of given generic type, or null
+     */
+    TypePtr getSpecializedType(const TypePtr& type, const GenericArgumentPtr& arguments) const;
+    void addSpecializedType(const TypePtr& type, const GenericArgumentPtr& arguments, const TypePtr& specialized);
+    /*!
+     * Tracks a type created by this compilation
+     */
+    void track(const TypePtr& type);
+    size_t numSpecializedTypes() const { return specializations.size();}
+    size_t numTypes() const { return types.size();}
+    /*!
+     * Releases all tracked types and cached specializations
+     */
+    void clear();
+public:
+    /*!
+     * Gets the cache activated on current thread, or null
+     */
+    static TypeCache* current() { return active;}
+private:
+    struct Entry
+    {
+        //keeps the generic type alive, so its address is never reused by another type while it's a key
+        TypePtr type;
+        TypePtr specialized;
+    };
+    typedef std::pair<const Type*, GenericArgumentKey> Key;
+    static thread_local TypeCache* active;
+    std::map<Key, Entry> specializations;
+    std::vector<std::weak_ptr<Type> > types;
+};
+typedef std::shared_ptr<TypeCache> TypeCachePtr;
+
+/*!
+ * Activates the type cache on current thread during its scope
+ */
+class SWALLOW_EXPORT TypeCacheScope
+{
+public:
+    TypeCacheScope(TypeCache* cache)
+    :previous(TypeCache::active)
+    {
+        TypeCache::active = cache;
+    }
+    ~TypeCacheScope()
+    {
+        TypeCache::active = previous;
+    }
+private:
+    TypeCache* previous;
+};
+
+SWALLOW_NS_END
+
+#endif//TYPE_CACHE_H
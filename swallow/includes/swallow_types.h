@@ -30,6 +30,7 @@
 #ifndef SWALLOW_TYPES_H
 #define SWALLOW_TYPES_H
 #include "swallow_conf.h"
+#include <cstdint>
 
 SWALLOW_NS_BEGIN
 
@@ -229,13 +230,15 @@ struct DeclarationModifiers
 };
 
 
+/*!
+ * Position of a token or node, stored as the offset in its source buffer.
+ * Line and column are resolved through the SourceIndex of the buffer when they're needed.
+ */
 struct SourceInfo
 {
-    int fileHash;
-    int line;
-    int column;
+    uint32_t offset;
     SourceInfo()
-    :fileHash(0), line(0), column(0)
+    :offset(0)
     {}
 };
 
@@ -34,6 +34,8 @@
 #include <cstring>
 #include <string>
 #include <wchar.h>
+#include <stdint.h>
+#include <type_traits>
 
 SWALLOW_NS_BEGIN
 
@@ -55,7 +57,7 @@ enum TokenizerContext
     TokenizerContextDeclaration = TokenizerContextFile | TokenizerContextClass | TokenizerContextFunctionBody,
     TokenizerContextAll = TokenizerContextFile | TokenizerContextOperator | TokenizerContextClass | TokenizerContextComputedProperty | TokenizerContextFunctionSignature | TokenizerContextCaptureList,
 };
-struct TokenizerState : SourceInfo
+struct TokenizerState
 {
     int cursor;
     bool hasSpace;
@@ -63,6 +65,52 @@ struct TokenizerState : SourceInfo
     TokenizerContext context;
 };
 
+/*!
+ * Text of a token, it refers to the string interned by the tokenizer, so copying a token never allocates.
+ * The interned string stays valid until the tokenizer is reset or destroyed.
+ */
+class TokenText
+{
+public:
+    TokenText()
+    :text(&emptyText())
+    {}
+    explicit TokenText(const std::wstring* text)
+    :text(text)
+    {}
+public:
+    operator const std::wstring&() const { return *text;}
+    const std::wstring& str() const { return *text;}
+    const wchar_t* c_str() const { return text->c_str();}
+    size_t size() const { return text->size();}
+    bool empty() const { return text->empty();}
+    wchar_t operator[](size_t idx) const { return (*text)[idx];}
+
+    bool operator==(const TokenText& rhs) const { return text == rhs.text || *text == *rhs.text;}
+    bool operator!=(const TokenText& rhs) const { return !(*this == rhs);}
+    bool operator==(const std::wstring& rhs) const { return *text == rhs;}
+    bool operator!=(const std::wstring& rhs) const { return *text != rhs;}
+    bool operator==(const wchar_t* rhs) const { return *text == rhs;}
+    bool operator!=(const wchar_t* rhs) const { return *text != rhs;}
+    friend bool operator==(const std::wstring& lhs, const TokenText& rhs) { return rhs == lhs;}
+    friend bool operator!=(const std::wstring& lhs, const TokenText& rhs) { return rhs != lhs;}
+    friend bool operator==(const wchar_t* lhs, const TokenText& rhs) { return rhs == lhs;}
+    friend bool operator!=(const wchar_t* lhs, const TokenText& rhs) { return rhs != lhs;}
+private:
+    static const std::wstring& emptyText()
+    {
+        static const std::wstring e;
+        return e;
+    }
+private:
+    const std::wstring* text;
+};
+
+/*!
+ * Token is copied by value all the time by parser, so it's kept small and trivially copyable:
+ * the text lives in the tokenizer's string pool, and the source position is only stored as an offset,
+ * line and column are resolved through Tokenizer::locate when a node or an error needs them.
+ */
 struct Token
 {
     //“Operators are made up of one or more of the following characters: /, =, -, +, !, *, %, <, >, &, |, ^, ~, and .. That said, the tokens =, ->, //, /*, */, ., and the unary prefix operator & are reserved. ”
@@ -71,12 +119,12 @@ struct Token
         struct
         {
             bool multiline;
-            int nestedLevels;
+            unsigned short nestedLevels;
         } comment;
         struct
         {
-            KeywordType::T type;
-            Keyword::T keyword;
+            KeywordType::T type : 8;
+            Keyword::T keyword : 8;
             bool backtick;
             bool implicitParameterName;
         } identifier;
@@ -86,28 +134,31 @@ struct Token
         } string;
         struct
         {
-            int base;
+            union
+            {
+                int64_t value;
+                double dvalue;
+            };
+            unsigned char base;
             bool sign;
-            int fraction;
-            int exponent;
-
-            int64_t value;
-            double dvalue;
         } number;
         struct
         {
-            OperatorType::T type;
+            OperatorType::T type : 8;
         } operators;
     };
-    TokenType::T type;
-    std::wstring token;
-    size_t size;
-    TokenizerState state;
-    void append(wchar_t ch)
-    {
-        token.push_back(ch);
-        size++;
-    }
+    TokenText token;
+    /*!
+     * Offset of the token's first character in the source
+     */
+    uint32_t offset;
+    TokenType::T type : 8;
+    /*!
+     * Tokenizer's context and string interpolation depth when this token was read, used to restore the tokenizer
+     */
+    TokenizerContext context : 8;
+    uint16_t inStringExpression;
+
     Keyword::T getKeyword() const
     {
         if(type != TokenType::Identifier)
@@ -117,13 +168,15 @@ struct Token
     
     bool operator ==(const wchar_t*str) const
     {
-        return wcscmp(token.c_str(), str) == 0;
+        return token == str;
     }
     bool operator ==(TokenType::T type) const
     {
         return this->type == type;
     }
 };
+static_assert(sizeof(Token) <= 32, "Token should fit in half a cache line");
+static_assert(std::is_trivially_copyable<Token>::value, "Token should be trivially copyable");
 
 SWALLOW_NS_END
 #endif//TOKEN_H
@@ -30,9 +30,11 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 #include "Token.h"
+#include "common/SourceIndex.h"
 #include <cstring>
 #include <string>
 #include <map>
+#include <unordered_set>
 
 SWALLOW_NS_BEGIN
 
@@ -42,6 +44,7 @@ struct TokenizerError
     int line;
     int column;
     int errorCode;
+    int cursor;
     std::wstring item;
 };
 struct KeywordInfo
@@ -78,6 +81,10 @@ public:
      * Restore the state that used to parse given token
      */
     void restore(const Token& token);
+    /*!
+     * Line-start table of current input, resolves the line and column of token offsets
+     */
+    const SourceIndex& getSourceIndex() const { return index;}
 
     /*!
      * Tells the tokenizer which context it is in
@@ -86,6 +93,8 @@ public:
 private:
     bool nextImpl(Token& token);
     void resetToken(Token& token);
+    void append(wchar_t ch);
+    const std::wstring* intern(const std::wstring& str);
     bool skipSpaces();
     bool get(wchar_t &ch);
     void unget();
@@ -117,7 +126,15 @@ private:
     const wchar_t* end;
     size_t size;
     TokenizerState state;
-    int positions[16];
+    SourceIndex index;
+    /*!
+     * Text of the token being read
+     */
+    std::wstring text;
+    /*!
+     * Interned token texts, tokens refer to the strings stored here
+     */
+    std::unordered_set<std::wstring> strings;
     std::map<std::wstring, KeywordInfo> keywords;
     std::map<Keyword::T, std::wstring> keywordNames;
 };
@@ -44,11 +44,18 @@ ArrayLiteral::~ArrayLiteral()
 void ArrayLiteral::push(const ExpressionPtr& item)
 {
 	elements.push_back(item);
+	adopt(item.get());
 }
 ExpressionPtr ArrayLiteral::getElement(int i)
 {
     return elements[i];
 }
+
+void ArrayLiteral::setElement(int i, const ExpressionPtr& item)
+{
+    elements[i] = item;
+    adopt(item.get());
+}
 int ArrayLiteral::numElements()const
 {
     return elements.size();
@@ -58,11 +65,11 @@ void ArrayLiteral::accept(NodeVisitor* visitor)
 {
     accept2(visitor, &NodeVisitor::visitArrayLiteral);
 }
-std::vector<ExpressionPtr>::iterator ArrayLiteral::begin()
+std::vector<ExpressionPtr>::const_iterator ArrayLiteral::begin()const
 {
     return elements.begin();
 }
-std::vector<ExpressionPtr>::iterator ArrayLiteral::end()
+std::vector<ExpressionPtr>::const_iterator ArrayLiteral::end()const
 {
     return elements.end();
 }
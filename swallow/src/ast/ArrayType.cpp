@@ -44,6 +44,7 @@ ArrayType::~ArrayType()
 void ArrayType::setInnerType(const TypeNodePtr& innerType)
 {
     this->innerType = innerType;
+    adopt(innerType.get());
 }
 const TypeNodePtr& ArrayType::getInnerType() const
 {
@@ -75,4 +75,5 @@ void BinaryOperator::set(int i, const NodePtr& val)
         default:
             break;
     }
+    adopt(val.get());
 }
@@ -30,6 +30,8 @@
 #include "ast/CodeBlock.h"
 #include "ast/CaseStatement.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Expression.h"
+#include "ast/Pattern.h"
 USE_SWALLOW_NS
 
 
@@ -51,6 +53,8 @@ void CaseStatement::accept(NodeVisitor* visitor)
 void CaseStatement::addCondition(const PatternPtr& condition, const ExpressionPtr& guard)
 {
     conditions.push_back(Condition(condition, guard));
+    adopt(condition.get());
+    adopt(guard.get());
 }
 int CaseStatement::numConditions()const
 {
@@ -64,6 +68,7 @@ const CaseStatement::Condition& CaseStatement::getCondition(int i)
 void CaseStatement::setCodeBlock(const CodeBlockPtr& codeBlock)
 {
     this->codeBlock = codeBlock;
+    adopt(codeBlock.get());
 }
 const CodeBlockPtr& CaseStatement::getCodeBlock()const
 {
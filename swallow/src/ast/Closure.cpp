@@ -29,6 +29,8 @@
  */
 #include "ast/Closure.h"
 #include "ast/NodeVisitor.h"
+#include "ast/ParametersNode.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -60,6 +62,7 @@ void Closure::setCaptureSpecifier(CaptureSpecifier val)
 void Closure::setCapture(const ExpressionPtr& capture)
 {
     this->capture = capture;
+    adopt(capture.get());
 }
 ExpressionPtr Closure::getCapture()
 {
@@ -69,6 +72,7 @@ ExpressionPtr Closure::getCapture()
 void Closure::setParameters(const ParametersNodePtr& val)
 {
     parameters = val;
+    adopt(val.get());
 }
 ParametersNodePtr Closure::getParameters()
 {
@@ -78,6 +82,7 @@ ParametersNodePtr Closure::getParameters()
 void Closure::setReturnType(const TypeNodePtr& val)
 {
     returnType = val;
+    adopt(val.get());
 }
 TypeNodePtr Closure::getReturnType()
 {
@@ -87,6 +92,7 @@ TypeNodePtr Closure::getReturnType()
 void Closure::addStatement(const StatementPtr& st)
 {
     statements.push_back(st);
+    adopt(st.get());
 }
 int Closure::numStatement()const
 {
@@ -96,3 +102,9 @@ StatementPtr Closure::getStatement(int i)
 {
     return statements[i];
 }
+
+void Closure::setStatement(int i, const StatementPtr& st)
+{
+    statements[i] = st;
+    adopt(st.get());
+}
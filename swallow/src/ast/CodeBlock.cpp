@@ -50,6 +50,7 @@ void CodeBlock::accept(NodeVisitor* visitor)
 void CodeBlock::addStatement(const StatementPtr& st)
 {
     statements.push_back(st);
+    adopt(st.get());
 }
 int CodeBlock::numStatements()
 {
@@ -60,6 +61,12 @@ StatementPtr CodeBlock::getStatement(int idx)
     return statements[idx];
 }
 
+void CodeBlock::setStatement(int idx, const StatementPtr& st)
+{
+    statements[idx] = st;
+    adopt(st.get());
+}
+
 
 void CodeBlock::setAttributes(const Attributes& attrs)
 {
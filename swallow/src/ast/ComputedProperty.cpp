@@ -29,6 +29,9 @@
  */
 #include "ast/ComputedProperty.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -60,6 +63,7 @@ const Attributes& ComputedProperty::getTypeAttributes() const
 void ComputedProperty::setDeclaredType(const TypeNodePtr& t)
 {
     this->declaredType = t;
+    adopt(t.get());
 }
 TypeNodePtr ComputedProperty::getDeclaredType()
 {
@@ -88,6 +92,7 @@ void ComputedProperty::setName(const std::wstring& name)
 void ComputedProperty::setInitializer(const ExpressionPtr& initializer)
 {
     this->initializer = initializer;
+    adopt(initializer.get());
 }
 const ExpressionPtr& ComputedProperty::getInitializer()const
 {
@@ -97,6 +102,7 @@ const ExpressionPtr& ComputedProperty::getInitializer()const
 void ComputedProperty::setSetter(const CodeBlockPtr& setter)
 {
     this->setter = setter;
+    adopt(setter.get());
 }
 CodeBlockPtr ComputedProperty::getSetter()
 {
@@ -115,6 +121,7 @@ const std::wstring& ComputedProperty::getSetterName()
 void ComputedProperty::setGetter(const CodeBlockPtr& getter)
 {
     this->getter = getter;
+    adopt(getter.get());
 }
 CodeBlockPtr ComputedProperty::getGetter()
 {
@@ -125,6 +132,7 @@ CodeBlockPtr ComputedProperty::getGetter()
 void ComputedProperty::setWillSet(const CodeBlockPtr& willSet)
 {
     this->willSet = willSet;
+    adopt(willSet.get());
 }
 CodeBlockPtr ComputedProperty::getWillSet()
 {
@@ -134,6 +142,7 @@ CodeBlockPtr ComputedProperty::getWillSet()
 void ComputedProperty::setDidSet(const CodeBlockPtr& didSet)
 {
     this->didSet = didSet;
+    adopt(didSet.get());
 }
 CodeBlockPtr ComputedProperty::getDidSet()
 {
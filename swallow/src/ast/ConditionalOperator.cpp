@@ -84,4 +84,5 @@ void ConditionalOperator::set(int i, const NodePtr& val)
         default:
             break;
     }
+    adopt(val.get());
 }
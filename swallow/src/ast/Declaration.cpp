@@ -30,6 +30,7 @@
 #include "ast/Declaration.h"
 #include "ast/Attribute.h"
 #include <algorithm>
+#include "ast/GenericParametersDef.h"
 USE_SWALLOW_NS
 
 
@@ -84,4 +85,5 @@ GenericParametersDefPtr Declaration::getGenericParametersDef()
 void Declaration::setGenericParametersDef(const GenericParametersDefPtr& val)
 {
     genericParameters = val;
+    adopt(val.get());
 }
@@ -29,6 +29,7 @@
  */
 #include "ast/DeinitializerDef.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
 USE_SWALLOW_NS
 
 
@@ -55,4 +56,5 @@ CodeBlockPtr DeinitializerDef::getBody()
 void DeinitializerDef::setBody(const CodeBlockPtr& body)
 {
     this->body = body;
+    adopt(body.get());
 }
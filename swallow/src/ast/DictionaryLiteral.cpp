@@ -44,6 +44,8 @@ DictionaryLiteral::~DictionaryLiteral()
 void DictionaryLiteral::insert(const ExpressionPtr& key, const ExpressionPtr& value)
 {
 	items.push_back(std::make_pair(key, value));
+	adopt(key.get());
+	adopt(value.get());
 }
 
 int DictionaryLiteral::numElements()const
@@ -51,6 +53,18 @@ int DictionaryLiteral::numElements()const
     return items.size();
 }
 
+void DictionaryLiteral::setKey(int idx, const ExpressionPtr& key)
+{
+    items[idx].first = key;
+    adopt(key.get());
+}
+
+void DictionaryLiteral::setValue(int idx, const ExpressionPtr& value)
+{
+    items[idx].second = value;
+    adopt(value.get());
+}
+
 
 void DictionaryLiteral::accept(NodeVisitor* visitor)
 {
@@ -44,6 +44,7 @@ DictionaryType::~DictionaryType()
 void DictionaryType::setKeyType(const TypeNodePtr& keyType)
 {
     this->keyType = keyType;
+    adopt(keyType.get());
 }
 const TypeNodePtr& DictionaryType::getKeyType() const
 {
@@ -52,6 +53,7 @@ const TypeNodePtr& DictionaryType::getKeyType() const
 void DictionaryType::setValueType(const TypeNodePtr& valueType)
 {
     this->valueType = valueType;
+    adopt(valueType.get());
 }
 const TypeNodePtr& DictionaryType::getValueType() const
 {
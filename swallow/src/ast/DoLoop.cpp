@@ -29,6 +29,8 @@
  */
 #include "ast/DoLoop.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
 USE_SWALLOW_NS
 
 
@@ -50,6 +52,7 @@ void DoLoop::accept(NodeVisitor* visitor)
 void DoLoop::setCodeBlock(const CodeBlockPtr& codeBlock)
 {
     this->codeBlock = codeBlock;
+    adopt(codeBlock.get());
 }
 CodeBlockPtr DoLoop::getCodeBlock()
 {
@@ -59,6 +62,7 @@ CodeBlockPtr DoLoop::getCodeBlock()
 void DoLoop::setCondition(const ExpressionPtr& expression)
 {
     this->condition = expression;
+    adopt(expression.get());
 }
 ExpressionPtr DoLoop::getCondition()
 {
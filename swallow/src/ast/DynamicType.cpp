@@ -43,6 +43,7 @@ DynamicType::~DynamicType()
 void DynamicType::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr DynamicType::getExpression()
 {
@@ -29,6 +29,7 @@
  */
 #include "ast/EnumCasePattern.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Tuple.h"
 USE_SWALLOW_NS
 
 
@@ -58,6 +59,7 @@ const std::wstring& EnumCasePattern::getName()const
 void EnumCasePattern::setAssociatedBinding(const TuplePtr& tuple)
 {
     associatedBinding = tuple;
+    adopt(tuple.get());
 }
 TuplePtr EnumCasePattern::getAssociatedBinding()
 {
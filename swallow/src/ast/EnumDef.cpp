@@ -58,6 +58,7 @@ void EnumDef::setValueStyle(EnumDef::ValueStyle style)
 void EnumDef::addCase(const std::wstring& name, const NodePtr& value)
 {
     cases.push_back(Case(name, value));
+    adopt(value.get());
 }
 int EnumDef::numCases() const
 {
@@ -31,7 +31,27 @@
 USE_SWALLOW_NS
 
 Expression::Expression(NodeType::T nodeType)
-    :Pattern(nodeType)
+    :Pattern(nodeType), literalKind(LiteralKind::None)
 {
 
 }
+
+SymbolPtr Expression::getReferencedSymbol() const
+{
+    return referencedSymbol.lock();
+}
+
+void Expression::setReferencedSymbol(const SymbolPtr& symbol)
+{
+    referencedSymbol = symbol;
+}
+
+LiteralKind::T Expression::getLiteralKind() const
+{
+    return literalKind;
+}
+
+void Expression::setLiteralKind(LiteralKind::T kind)
+{
+    literalKind = kind;
+}
@@ -0,0 +1,384 @@
+/* FlatAST.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ast/FlatAST.h"
+#include "ast/ast.h"
+#include "ast/NodeVisitor.h"
+#include <unordered_map>
+
+USE_SWALLOW_NS
+using namespace std;
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * Numbers the nodes in the order NodeVisitor's default traversal enters them, and fills the flat arrays
+ */
+class FlatASTBuilder : public NodeVisitor
+{
+public:
+    FlatASTBuilder(FlatAST* ast)
+    :ast(ast), pendingRole(FlatAST::RoleNone)
+    {
+    }
+public:
+    void build(const NodePtr& root);
+public:
+#define FLATTEN(Name, PtrType) \
+    virtual void visit##Name(const PtrType& node) override \
+    { \
+        uint32_t idx = enter(node.get(), sizeof(*node)); \
+        NodeVisitor::visit##Name(node); \
+        leave(idx); \
+    }
+    FLATTEN(ValueBindings, ValueBindingsPtr)
+    FLATTEN(ComputedProperty, ComputedPropertyPtr)
+    FLATTEN(ValueBinding, ValueBindingPtr)
+    FLATTEN(Assignment, AssignmentPtr)
+    FLATTEN(Class, ClassDefPtr)
+    FLATTEN(Struct, StructDefPtr)
+    FLATTEN(Enum, EnumDefPtr)
+    FLATTEN(Protocol, ProtocolDefPtr)
+    FLATTEN(Extension, ExtensionDefPtr)
+    FLATTEN(Function, FunctionDefPtr)
+    FLATTEN(Deinit, DeinitializerDefPtr)
+    FLATTEN(Init, InitializerDefPtr)
+    FLATTEN(Import, ImportPtr)
+    FLATTEN(Subscript, SubscriptDefPtr)
+    FLATTEN(TypeAlias, TypeAliasPtr)
+    FLATTEN(LabeledStatement, LabeledStatementPtr)
+    FLATTEN(Operator, OperatorDefPtr)
+    FLATTEN(ArrayLiteral, ArrayLiteralPtr)
+    FLATTEN(DictionaryLiteral, DictionaryLiteralPtr)
+    FLATTEN(Break, BreakStatementPtr)
+    FLATTEN(Return, ReturnStatementPtr)
+    FLATTEN(Continue, ContinueStatementPtr)
+    FLATTEN(Fallthrough, FallthroughStatementPtr)
+    FLATTEN(Error, ErrorNodePtr)
+    FLATTEN(CodeBlock, CodeBlockPtr)
+    FLATTEN(Parameter, ParameterNodePtr)
+    FLATTEN(Parameters, ParametersNodePtr)
+    FLATTEN(Program, ProgramPtr)
+    FLATTEN(ValueBindingPattern, ValueBindingPatternPtr)
+    FLATTEN(ConditionalOperator, ConditionalOperatorPtr)
+    FLATTEN(BinaryOperator, BinaryOperatorPtr)
+    FLATTEN(UnaryOperator, UnaryOperatorPtr)
+    FLATTEN(Tuple, TuplePtr)
+    FLATTEN(Identifier, IdentifierPtr)
+    FLATTEN(CompileConstant, CompileConstantPtr)
+    FLATTEN(SubscriptAccess, SubscriptAccessPtr)
+    FLATTEN(MemberAccess, MemberAccessPtr)
+    FLATTEN(FunctionCall, FunctionCallPtr)
+    FLATTEN(Closure, ClosurePtr)
+    FLATTEN(Self, SelfExpressionPtr)
+    FLATTEN(InitializerReference, InitializerReferencePtr)
+    FLATTEN(TypedPattern, TypedPatternPtr)
+    FLATTEN(EnumCasePattern, EnumCasePatternPtr)
+    FLATTEN(DynamicType, DynamicTypePtr)
+    FLATTEN(ForcedValue, ForcedValuePtr)
+    FLATTEN(OptionalChaining, OptionalChainingPtr)
+    FLATTEN(ParenthesizedExpression, ParenthesizedExpressionPtr)
+    FLATTEN(String, StringLiteralPtr)
+    FLATTEN(StringInterpolation, StringInterpolationPtr)
+    FLATTEN(Integer, IntegerLiteralPtr)
+    FLATTEN(Float, FloatLiteralPtr)
+    FLATTEN(NilLiteral, NilLiteralPtr)
+    FLATTEN(BooleanLiteral, BooleanLiteralPtr)
+    FLATTEN(ArrayType, ArrayTypePtr)
+    FLATTEN(FunctionType, FunctionTypePtr)
+    FLATTEN(ImplicitlyUnwrappedOptional, ImplicitlyUnwrappedOptionalPtr)
+    FLATTEN(OptionalType, OptionalTypePtr)
+    FLATTEN(ProtocolComposition, ProtocolCompositionPtr)
+    FLATTEN(TupleType, TupleTypePtr)
+    FLATTEN(TypeIdentifier, TypeIdentifierPtr)
+#undef FLATTEN
+    virtual void visitIf(const IfStatementPtr& node) override;
+    virtual void visitWhileLoop(const WhileLoopPtr& node) override;
+    virtual void visitDoLoop(const DoLoopPtr& node) override;
+    virtual void visitForLoop(const ForLoopPtr& node) override;
+    virtual void visitForIn(const ForInLoopPtr& node) override;
+    virtual void visitSwitchCase(const SwitchCasePtr& node) override;
+    virtual void visitCase(const CaseStatementPtr& node) override;
+private:
+    uint32_t enter(Node* node, size_t size);
+    void leave(uint32_t idx);
+    /*!
+     * Flattens a part of a control statement with given role
+     */
+    void visitPart(const NodePtr& node, FlatAST::Role role);
+    uint32_t internName(const wstring& name);
+    uint32_t internType(const TypePtr& type);
+private:
+    FlatAST* ast;
+    FlatAST::Role pendingRole;
+    vector<uint32_t> stack;
+    vector<pair<uint32_t, uint32_t> > edges;
+    unordered_map<wstring, uint32_t> nameIndices;
+    unordered_map<Type*, uint32_t> typeIndices;
+};
+
+SWALLOW_NS_END
+
+/*!
+ * Gets the name that the flat node carries for given node
+ */
+static const wstring* getNodeName(Node* node)
+{
+    switch(node->getNodeType())
+    {
+        case NodeType::Identifier:
+            return &static_cast<Identifier*>(node)->getIdentifier();
+        case NodeType::IntegerLiteral:
+            return &static_cast<IntegerLiteral*>(node)->valueAsString;
+        case NodeType::FloatLiteral:
+            return &static_cast<FloatLiteral*>(node)->valueAsString;
+        case NodeType::StringLiteral:
+            return &static_cast<StringLiteral*>(node)->value;
+        case NodeType::BinaryOperator:
+        case NodeType::UnaryOperator:
+            return &static_cast<Operator*>(node)->getOperator();
+        case NodeType::Function:
+            return &static_cast<FunctionDef*>(node)->getName();
+        case NodeType::TypeIdentifier:
+            return &static_cast<TypeIdentifier*>(node)->getName();
+        case NodeType::Break:
+            return &static_cast<BreakStatement*>(node)->getLoop();
+        case NodeType::Continue:
+            return &static_cast<ContinueStatement*>(node)->getLoop();
+        case NodeType::LabeledStatement:
+            return &static_cast<LabeledStatement*>(node)->getLabel();
+        case NodeType::MemberAccess:
+        {
+            MemberAccess* ma = static_cast<MemberAccess*>(node);
+            return ma->getField() ? &ma->getField()->getIdentifier() : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+void FlatASTBuilder::build(const NodePtr& root)
+{
+    if(root)
+        root->accept(this);
+    //lay out the children of each node contiguously, edges are recorded in pre-order so children keep their order
+    uint32_t size = ast->size();
+    ast->childOffsets.assign(size + 1, 0);
+    for(const pair<uint32_t, uint32_t>& edge : edges)
+        ast->childOffsets[edge.first + 1]++;
+    for(uint32_t i = 0; i < size; i++)
+        ast->childOffsets[i + 1] += ast->childOffsets[i];
+    ast->children.resize(edges.size());
+    vector<uint32_t> filled(ast->childOffsets.begin(), ast->childOffsets.end() - 1);
+    for(const pair<uint32_t, uint32_t>& edge : edges)
+        ast->children[filled[edge.first]++] = edge.second;
+}
+
+uint32_t FlatASTBuilder::enter(Node* node, size_t size)
+{
+    uint32_t idx = ast->kinds.size();
+    uint32_t parent = stack.empty() ? FlatAST::InvalidIndex : stack.back();
+    if(parent != FlatAST::InvalidIndex)
+        edges.push_back(make_pair(parent, idx));
+    uint8_t flags = 0;
+    uint32_t type = FlatAST::InvalidIndex;
+    if(Pattern* pattern = dynamic_cast<Pattern*>(node))
+        type = internType(pattern->getType());
+    if(dynamic_cast<Expression*>(node))
+        flags |= FlatAST::FlagExpression;
+    if(dynamic_cast<Declaration*>(node))
+        flags |= FlatAST::FlagDeclaration;
+    if(node->getNodeType() == NodeType::ValueBindings && static_cast<ValueBindings*>(node)->isReadOnly())
+        flags |= FlatAST::FlagReadOnly;
+    if(node->getNodeType() == NodeType::BooleanLiteral && static_cast<BooleanLiteral*>(node)->getValue())
+        flags |= FlatAST::FlagTrue;
+    const wstring* name = getNodeName(node);
+
+    ast->kinds.push_back((uint8_t)node->getNodeType());
+    ast->flags.push_back(flags);
+    ast->roles.push_back(pendingRole);
+    pendingRole = FlatAST::RoleNone;
+    ast->treeMemory += size;
+    ast->sourceOffsets.push_back(node->getSourceInfo()->offset);
+    ast->typeIndices.push_back(type);
+    ast->nameIndices.push_back(name ? internName(*name) : FlatAST::InvalidIndex);
+    ast->parents.push_back(parent);
+    ast->subtreeEnds.push_back(idx + 1);
+    ast->nodes.push_back(node);
+    stack.push_back(idx);
+    return idx;
+}
+
+void FlatASTBuilder::visitPart(const NodePtr& node, FlatAST::Role role)
+{
+    if(!node)
+        return;
+    pendingRole = role;
+    node->accept(this);
+}
+
+void FlatASTBuilder::visitIf(const IfStatementPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    visitPart(node->getCondition(), FlatAST::RoleCondition);
+    visitPart(node->getThen(), FlatAST::RoleThen);
+    visitPart(node->getElse(), FlatAST::RoleElse);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitWhileLoop(const WhileLoopPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    visitPart(node->getCondition(), FlatAST::RoleCondition);
+    visitPart(node->getCodeBlock(), FlatAST::RoleBody);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitDoLoop(const DoLoopPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    visitPart(node->getCodeBlock(), FlatAST::RoleBody);
+    visitPart(node->getCondition(), FlatAST::RoleCondition);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitForLoop(const ForLoopPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    for(int i = 0; i < node->numInit(); i++)
+        visitPart(node->getInit(i), FlatAST::RoleInit);
+    visitPart(node->getInitializer(), FlatAST::RoleInit);
+    visitPart(node->getCondition(), FlatAST::RoleCondition);
+    visitPart(node->getStep(), FlatAST::RoleStep);
+    visitPart(node->getCodeBlock(), FlatAST::RoleBody);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitForIn(const ForInLoopPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    visitPart(node->getLoopVars(), FlatAST::RoleLoopVariables);
+    visitPart(node->getContainer(), FlatAST::RoleContainer);
+    visitPart(node->getCodeBlock(), FlatAST::RoleBody);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitSwitchCase(const SwitchCasePtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    visitPart(node->getControlExpression(), FlatAST::RoleCondition);
+    for(const CaseStatementPtr& c : *node)
+        visitPart(c, FlatAST::RoleCase);
+    visitPart(node->getDefaultCase(), FlatAST::RoleDefaultCase);
+    leave(idx);
+}
+
+void FlatASTBuilder::visitCase(const CaseStatementPtr& node)
+{
+    uint32_t idx = enter(node.get(), sizeof(*node));
+    for(const CaseStatement::Condition& cond : node->getConditions())
+    {
+        visitPart(cond.condition, FlatAST::RoleCondition);
+        visitPart(cond.guard, FlatAST::RoleGuard);
+    }
+    visitPart(node->getCodeBlock(), FlatAST::RoleBody);
+    leave(idx);
+}
+
+void FlatASTBuilder::leave(uint32_t idx)
+{
+    ast->subtreeEnds[idx] = ast->kinds.size();
+    stack.pop_back();
+}
+
+uint32_t FlatASTBuilder::internName(const wstring& name)
+{
+    auto iter = nameIndices.find(name);
+    if(iter != nameIndices.end())
+        return iter->second;
+    uint32_t ret = ast->names.size();
+    ast->names.push_back(name);
+    nameIndices.insert(make_pair(name, ret));
+    return ret;
+}
+
+uint32_t FlatASTBuilder::internType(const TypePtr& type)
+{
+    if(!type)
+        return FlatAST::InvalidIndex;
+    auto iter = typeIndices.find(type.get());
+    if(iter != typeIndices.end())
+        return iter->second;
+    uint32_t ret = ast->types.size();
+    ast->types.push_back(type);
+    typeIndices.insert(make_pair(type.get(), ret));
+    return ret;
+}
+
+FlatAST::FlatAST(const NodePtr& root)
+:root(root), treeMemory(0)
+{
+    FlatASTBuilder builder(this);
+    builder.build(root);
+}
+
+const TypePtr& FlatAST::getType(uint32_t node) const
+{
+    static const TypePtr none;
+    uint32_t idx = typeIndices[node];
+    return idx == InvalidIndex ? none : types[idx];
+}
+
+const std::wstring& FlatAST::getName(uint32_t node) const
+{
+    static const wstring none;
+    uint32_t idx = nameIndices[node];
+    return idx == InvalidIndex ? none : names[idx];
+}
+
+void FlatAST::accept(uint32_t node, NodeVisitor* visitor) const
+{
+    nodes[node]->accept(visitor);
+}
+
+uint32_t FlatAST::findChild(uint32_t node, Role role) const
+{
+    for(uint32_t i = childOffsets[node]; i < childOffsets[node + 1]; i++)
+    {
+        if(roles[children[i]] == role)
+            return children[i];
+    }
+    return InvalidIndex;
+}
+
+size_t FlatAST::getMemoryUsage() const
+{
+    size_t perNode = sizeof(uint8_t) * 3 + sizeof(uint32_t) * 6 + sizeof(Node*);
+    return size() * perNode + children.size() * sizeof(uint32_t) + sizeof(uint32_t) + treeMemory;
+}
@@ -29,6 +29,10 @@
  */
 #include "ast/ForInLoop.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
+#include "ast/Pattern.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -51,6 +55,7 @@ void ForInLoop::accept(NodeVisitor* visitor)
 void ForInLoop::setLoopVars(const PatternPtr& val)
 {
     loopVars = val;
+    adopt(val.get());
 }
 PatternPtr ForInLoop::getLoopVars()
 {
@@ -60,6 +65,7 @@ PatternPtr ForInLoop::getLoopVars()
 void ForInLoop::setContainer(const ExpressionPtr& val)
 {
     this->container = val;
+    adopt(val.get());
 }
 ExpressionPtr ForInLoop::getContainer()
 {
@@ -69,6 +75,7 @@ ExpressionPtr ForInLoop::getContainer()
 void ForInLoop::setCodeBlock(const CodeBlockPtr& val)
 {
     codeBlock = val;
+    adopt(val.get());
 }
 CodeBlockPtr ForInLoop::getCodeBlock()
 {
@@ -77,6 +84,7 @@ CodeBlockPtr ForInLoop::getCodeBlock()
 void ForInLoop::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 TypeNodePtr ForInLoop::getDeclaredType()const
 {
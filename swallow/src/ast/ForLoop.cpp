@@ -29,6 +29,9 @@
  */
 #include "ast/ForLoop.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
+#include "ast/ValueBindings.h"
 USE_SWALLOW_NS
 
 
@@ -49,6 +52,7 @@ void ForLoop::accept(NodeVisitor* visitor)
 void ForLoop::addInit(const ExpressionPtr& init)
 {
     inits.push_back(init);
+    adopt(init.get());
 }
 int ForLoop::numInit() const
 {
@@ -59,6 +63,12 @@ ExpressionPtr ForLoop::getInit(int idx) const
     return inits[idx];
 }
 
+void ForLoop::setInit(int idx, const ExpressionPtr& init)
+{
+    inits[idx] = init;
+    adopt(init.get());
+}
+
 ValueBindingsPtr ForLoop::getInitializer() const
 {
     return initializer;
@@ -66,6 +76,7 @@ ValueBindingsPtr ForLoop::getInitializer() const
 void ForLoop::setInitializer(const ValueBindingsPtr& initializer)
 {
     this->initializer = initializer;
+    adopt(initializer.get());
 }
 
 
@@ -73,6 +84,7 @@ void ForLoop::setInitializer(const ValueBindingsPtr& initializer)
 void ForLoop::setCondition(const ExpressionPtr& cond)
 {
     condition = cond;
+    adopt(cond.get());
 }
 ExpressionPtr ForLoop::getCondition()
 {
@@ -82,6 +94,7 @@ ExpressionPtr ForLoop::getCondition()
 void ForLoop::setStep(const ExpressionPtr& step)
 {
     this->step = step;
+    adopt(step.get());
 }
 ExpressionPtr ForLoop::getStep()
 {
@@ -91,6 +104,7 @@ ExpressionPtr ForLoop::getStep()
 void ForLoop::setCodeBlock(const CodeBlockPtr& codeBlock)
 {
     this->codeBlock = codeBlock;
+    adopt(codeBlock.get());
 }
 CodeBlockPtr ForLoop::getCodeBlock()
 {
@@ -42,6 +42,7 @@ ForcedValue::~ForcedValue()
 void ForcedValue::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr ForcedValue::getExpression()
 {
@@ -29,6 +29,8 @@
  */
 #include "ast/FunctionCall.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Closure.h"
+#include "ast/ParenthesizedExpression.h"
 USE_SWALLOW_NS
 
 
@@ -47,6 +49,7 @@ FunctionCall::~FunctionCall()
 void FunctionCall::setFunction(const ExpressionPtr& expr)
 {
     function = expr;
+    adopt(expr.get());
 }
 ExpressionPtr FunctionCall::getFunction()
 {
@@ -55,6 +58,7 @@ ExpressionPtr FunctionCall::getFunction()
 void FunctionCall::setArguments(const ParenthesizedExpressionPtr& arguments)
 {
     this->arguments = arguments;
+    adopt(arguments.get());
 }
 ParenthesizedExpressionPtr FunctionCall::getArguments()
 {
@@ -64,6 +68,7 @@ ParenthesizedExpressionPtr FunctionCall::getArguments()
 void FunctionCall::setTrailingClosure(const ClosurePtr& trailingClosure)
 {
     this->trailingClosure = trailingClosure;
+    adopt(trailingClosure.get());
 }
 
 
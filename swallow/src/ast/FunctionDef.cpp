@@ -29,6 +29,9 @@
  */
 #include "ast/FunctionDef.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/ParametersNode.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -62,6 +65,7 @@ const std::wstring& FunctionDef::getName()const
 void FunctionDef::addParameters(const ParametersNodePtr& parameters)
 {
     parametersList.push_back(parameters);
+    adopt(parameters.get());
 }
 int FunctionDef::numParameters() const
 {
@@ -75,6 +79,7 @@ ParametersNodePtr FunctionDef::getParameters(int i)
 void FunctionDef::setReturnType(const TypeNodePtr& type)
 {
     returnType = type;
+    adopt(type.get());
 }
 TypeNodePtr FunctionDef::getReturnType()
 {
@@ -93,6 +98,7 @@ const Attributes& FunctionDef::getReturnTypeAttributes()const
 void FunctionDef::setBody(const CodeBlockPtr& body)
 {
     this->body = body;
+    adopt(body.get());
 }
 CodeBlockPtr FunctionDef::getBody()
 {
@@ -47,6 +47,7 @@ void FunctionType::accept(NodeVisitor* visitor)
 void FunctionType::setArgumentsType(const TupleTypePtr& argumentsType)
 {
     this->argumentsType = argumentsType;
+    adopt(argumentsType.get());
 }
 
 TupleTypePtr FunctionType::getArgumentsType()
@@ -56,6 +57,7 @@ TupleTypePtr FunctionType::getArgumentsType()
 void FunctionType::setReturnType(const TypeNodePtr& retType)
 {
     this->returnType = retType;
+    adopt(retType.get());
 }
 
 
@@ -43,6 +43,7 @@ GenericArgumentDef::~GenericArgumentDef()
 void GenericArgumentDef::addArgument(const TypeNodePtr& type)
 {
     arguments.push_back(type);
+    adopt(type.get());
 }
 TypeNodePtr GenericArgumentDef::getArgument(int i)
 {
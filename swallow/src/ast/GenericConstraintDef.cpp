@@ -45,6 +45,7 @@ GenericConstraintDef::~GenericConstraintDef()
 void GenericConstraintDef::setIdentifier(const TypeIdentifierPtr& identifier)
 {
     this->identifier = identifier;
+    adopt(identifier.get());
 }
 TypeIdentifierPtr GenericConstraintDef::getIdentifier()
 {
@@ -63,6 +64,7 @@ GenericConstraintDef::ConstraintType GenericConstraintDef::getConstraintType()co
 void GenericConstraintDef::setExpectedType(const TypeNodePtr& expectedIdentifier)
 {
     this->expectedType = expectedIdentifier;
+    adopt(expectedIdentifier.get());
 }
 
 TypeNodePtr GenericConstraintDef::getExpectedType()const
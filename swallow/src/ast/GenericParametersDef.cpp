@@ -28,6 +28,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "ast/GenericParametersDef.h"
+#include "ast/GenericConstraintDef.h"
+#include "ast/TypeIdentifier.h"
 USE_SWALLOW_NS
 
 
@@ -43,6 +45,7 @@ GenericParametersDef::~GenericParametersDef()
 void GenericParametersDef::addGenericType(const TypeIdentifierPtr& type)
 {
     genericTypes.push_back(type);
+    adopt(type.get());
 }
 int GenericParametersDef::numGenericTypes()const
 {
@@ -57,6 +60,7 @@ TypeIdentifierPtr GenericParametersDef::getGenericType(int i)
 void GenericParametersDef::addConstraint(const GenericConstraintDefPtr& constraint)
 {
     constraints.push_back(constraint);
+    adopt(constraint.get());
 }
 size_t GenericParametersDef::numConstraints()const
 {
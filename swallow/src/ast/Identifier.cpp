@@ -29,6 +29,7 @@
  */
 #include "ast/Identifier.h"
 #include "ast/NodeVisitor.h"
+#include "ast/GenericArgumentDef.h"
 USE_SWALLOW_NS
 
 Identifier::Identifier()
@@ -56,6 +57,7 @@ GenericArgumentDefPtr Identifier::getGenericArgumentDef() const
 void Identifier::setGenericArgumentDef(const GenericArgumentDefPtr& val)
 {
     genericArgumentDef = val;
+    adopt(val.get());
 }
 /*!
  * Check if given node is an identifier with specified name
@@ -29,6 +29,8 @@
  */
 #include "ast/IfStatement.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
 USE_SWALLOW_NS
 
 
@@ -52,6 +54,7 @@ void IfStatement::accept(NodeVisitor* visitor)
 void IfStatement::setCondition(const ExpressionPtr& expr)
 {
     this->condition = expr;
+    adopt(expr.get());
 }
 ExpressionPtr IfStatement::getCondition()
 {
@@ -61,6 +64,7 @@ ExpressionPtr IfStatement::getCondition()
 void IfStatement::setThen(const CodeBlockPtr& thenPart)
 {
     this->thenPart = thenPart;
+    adopt(thenPart.get());
 }
 CodeBlockPtr IfStatement::getThen()
 {
@@ -70,6 +74,7 @@ CodeBlockPtr IfStatement::getThen()
 void IfStatement::setElse(const StatementPtr& elsePart)
 {
     this->elsePart = elsePart;
+    adopt(elsePart.get());
 }
 StatementPtr IfStatement::getElse()
 {
@@ -48,6 +48,7 @@ void ImplicitlyUnwrappedOptional::accept(NodeVisitor* visitor)
 void ImplicitlyUnwrappedOptional::setInnerType(const TypeNodePtr& innerType)
 {
     this->innerType = innerType;
+    adopt(innerType.get());
 }
 TypeNodePtr ImplicitlyUnwrappedOptional::getInnerType()
 {
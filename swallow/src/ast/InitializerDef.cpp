@@ -29,6 +29,8 @@
  */
 #include "ast/InitializerDef.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/ParametersNode.h"
 USE_SWALLOW_NS
 
 
@@ -51,6 +53,7 @@ void InitializerDef::accept(NodeVisitor* visitor)
 void InitializerDef::setParameters(const ParametersNodePtr& parameters)
 {
     this->parameters = parameters;
+    adopt(parameters.get());
 }
 ParametersNodePtr InitializerDef::getParameters()
 {
@@ -60,6 +63,7 @@ ParametersNodePtr InitializerDef::getParameters()
 void InitializerDef::setBody(const CodeBlockPtr& body)
 {
     this->body = body;
+    adopt(body.get());
 }
 CodeBlockPtr InitializerDef::getBody()
 {
@@ -43,6 +43,7 @@ InitializerReference::~InitializerReference()
 void InitializerReference::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr InitializerReference::getExpression()
 {
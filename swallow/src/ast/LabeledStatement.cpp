@@ -59,6 +59,7 @@ const std::wstring& LabeledStatement::getLabel() const
 void LabeledStatement::setStatement(const StatementPtr& statement)
 {
     this->statement = statement;
+    adopt(statement.get());
 }
 
 StatementPtr LabeledStatement::getStatement()
@@ -29,6 +29,7 @@
  */
 #include "ast/MemberAccess.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Identifier.h"
 USE_SWALLOW_NS
 
 
@@ -42,10 +43,12 @@ MemberAccess::~MemberAccess()
 void MemberAccess::setSelf(const ExpressionPtr& self)
 {
     this->self = self;
+    adopt(self.get());
 }
 void MemberAccess::setField(const IdentifierPtr& field)
 {
     this->field = field;
+    adopt(field.get());
 }
 
 ExpressionPtr MemberAccess::getSelf()
@@ -32,12 +32,15 @@
 #include <cassert>
 #include <set>
 #include <algorithm>
+#include "common/CompilerStats.h"
 USE_SWALLOW_NS
 
 #ifdef TRACE_NODE
+#include <mutex>
 int Node::NodeCount = 0;
 std::list<Node*> Node::UnreleasedNodes;
-
+//nodes can be created by different threads in batch compilation
+static std::mutex traceLock;
 #endif
 
 
@@ -74,6 +77,7 @@ const char* Node::nodeTypeToName(NodeType::T nodeType)
     CASE_TYPE(DynamicType)
     CASE_TYPE(EnumCasePattern)
     CASE_TYPE(Enum)
+    CASE_TYPE(Error)
     CASE_TYPE(Extension)
     CASE_TYPE(Fallthrough)
     CASE_TYPE(FloatLiteral)
@@ -136,7 +140,9 @@ const char* Node::nodeTypeToName(NodeType::T nodeType)
 Node::Node(NodeType::T nodeType)
 :nodeType(nodeType), nodeFactory(nullptr)
 {
+    CompilerStats::increase(CompilerCounter::Nodes);
 #ifdef TRACE_NODE
+    std::lock_guard<std::mutex> lock(traceLock);
     NodeCount++;
     UnreleasedNodes.push_back(this);
 #endif
@@ -144,6 +150,7 @@ Node::Node(NodeType::T nodeType)
 Node::~Node()
 {
 #ifdef TRACE_NODE
+    std::lock_guard<std::mutex> lock(traceLock);
     NodeCount--;
     std::list<Node*>::iterator iter = std::find(UnreleasedNodes.begin(), UnreleasedNodes.end(), this);
     if(iter != UnreleasedNodes.end())
@@ -168,3 +175,8 @@ NodePtr Node::getParentNode() const
 {
     return parentNode.lock();
 }
+void Node::adopt(Node* child)
+{
+    if(child)
+        child->parentNode = shared_from_this();
+}
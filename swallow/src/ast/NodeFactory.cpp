@@ -209,6 +209,10 @@ FallthroughStatementPtr NodeFactory::createFallthrough(const SourceInfo& state)
 {
     return _(state, new FallthroughStatement());
 }
+ErrorNodePtr NodeFactory::createError(const SourceInfo& state)
+{
+    return _(state, new ErrorNode());
+}
 ReturnStatementPtr NodeFactory::createReturn(const SourceInfo& state)
 {
     return _(state, new ReturnStatement());
@@ -72,9 +72,9 @@ void NodeVisitor::visitForIn(const ForInLoopPtr& node)
 
 void NodeVisitor::visitForLoop(const ForLoopPtr& node)
 {
-    for(ExpressionPtr init : node->inits)
+    for(int i = 0; i < node->numInit(); i++)
     {
-        ACCEPT(init);
+        ACCEPT(node->getInit(i));
     }
     ACCEPT(node->getInitializer());
     ACCEPT(node->condition);
@@ -100,7 +100,7 @@ void NodeVisitor::visitOperator(const OperatorDefPtr& node)
 
 void NodeVisitor::visitArrayLiteral(const ArrayLiteralPtr& node)
 {
-    for(ExpressionPtr expr : node->elements)
+    for(ExpressionPtr expr : *node)
     {
         ACCEPT(expr);
     }
@@ -132,6 +132,10 @@ void NodeVisitor::visitFallthrough(const FallthroughStatementPtr& node)
 {
 }
 
+void NodeVisitor::visitError(const ErrorNodePtr& node)
+{
+}
+
 void NodeVisitor::visitIf(const IfStatementPtr& node)
 {
     ACCEPT(node->getCondition());
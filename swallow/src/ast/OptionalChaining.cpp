@@ -44,6 +44,7 @@ OptionalChaining::~OptionalChaining()
 void OptionalChaining::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr OptionalChaining::getExpression()
 {
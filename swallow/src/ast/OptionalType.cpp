@@ -49,6 +49,7 @@ void OptionalType::accept(NodeVisitor* visitor)
 void OptionalType::setInnerType(TypeNodePtr innerType)
 {
     this->innerType = innerType;
+    adopt(innerType.get());
 }
 TypeNodePtr OptionalType::getInnerType()
 {
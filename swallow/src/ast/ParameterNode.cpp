@@ -29,6 +29,8 @@
  */
 #include "ast/ParameterNode.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Expression.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -117,6 +119,7 @@ TypePtr ParameterNode::getType()
 void ParameterNode::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 TypeNodePtr ParameterNode::getDeclaredType()
 {
@@ -125,6 +128,7 @@ TypeNodePtr ParameterNode::getDeclaredType()
 void ParameterNode::setDefaultValue(const ExpressionPtr& def)
 {
     this->defaultValue = def;
+    adopt(def.get());
 }
 ExpressionPtr ParameterNode::getDefaultValue()
 {
@@ -29,6 +29,7 @@
  */
 #include "ast/ParametersNode.h"
 #include "ast/NodeVisitor.h"
+#include "ast/ParameterNode.h"
 USE_SWALLOW_NS
 
 
@@ -59,6 +60,7 @@ bool ParametersNode::isVariadicParameters()const
 void ParametersNode::addParameter(const ParameterNodePtr& parameter)
 {
     parameters.push_back(parameter);
+    adopt(parameter.get());
 }
 int ParametersNode::numParameters()const
 {
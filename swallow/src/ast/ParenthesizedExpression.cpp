@@ -45,11 +45,17 @@ ParenthesizedExpression::~ParenthesizedExpression()
 void ParenthesizedExpression::append(const std::wstring& name, const ExpressionPtr& expr)
 {
     expressions.push_back(Term(name, expr));
+    adopt(expr.get());
 }
 void ParenthesizedExpression::append(const ExpressionPtr& expr)
 {
     append(L"", expr);
 }
+
+void ParenthesizedExpression::borrow(const ExpressionPtr& expr)
+{
+    expressions.push_back(Term(L"", expr));
+}
 size_t ParenthesizedExpression::numExpressions()const
 {
     return expressions.size();
@@ -72,3 +78,18 @@ ExpressionPtr ParenthesizedExpression::get(int idx)
         return NULL;
     return expressions[idx].expression;
 }
+
+void ParenthesizedExpression::setExpression(int idx, const ExpressionPtr& expr)
+{
+    expressions[idx].expression = expr;
+    adopt(expr.get());
+}
+
+void ParenthesizedExpression::setTransformedExpression(int idx, const ExpressionPtr& expr)
+{
+    Term& term = expressions[idx];
+    term.transformedExpression = expr;
+    //a borrowed expression that is reused as it is stays with its own parent
+    if(expr != term.expression)
+        adopt(expr.get());
+}
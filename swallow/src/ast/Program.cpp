@@ -29,6 +29,7 @@
  */
 #include "ast/Program.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Statement.h"
 USE_SWALLOW_NS
 
 
@@ -48,6 +49,7 @@ void Program::accept(NodeVisitor* visitor)
 void Program::addStatement(const StatementPtr& statement)
 {
     statements.push_back(statement);
+    adopt(statement.get());
 }
 void Program::clearStatements()
 {
@@ -62,3 +64,9 @@ StatementPtr Program::getStatement(int n)
     return statements[n];
 }
 
+void Program::setStatement(int n, const StatementPtr& statement)
+{
+    statements[n] = statement;
+    adopt(statement.get());
+}
+
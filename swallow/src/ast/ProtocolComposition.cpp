@@ -45,6 +45,7 @@ ProtocolComposition::~ProtocolComposition()
 void ProtocolComposition::addProtocol(TypeIdentifierPtr protocol)
 {
     protocols.push_back(protocol);
+    adopt(protocol.get());
 }
 TypeIdentifierPtr ProtocolComposition::getProtocol(int i)
 {
@@ -29,6 +29,7 @@
  */
 #include "ast/ReturnStatement.h"
 #include "ast/NodeVisitor.h"
+#include "ast/Expression.h"
 USE_SWALLOW_NS
 
 
@@ -48,6 +49,7 @@ void ReturnStatement::accept(NodeVisitor* visitor)
 void ReturnStatement::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr ReturnStatement::getExpression()
 {
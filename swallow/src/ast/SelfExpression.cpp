@@ -46,6 +46,7 @@ SelfExpression::~SelfExpression()
 void SelfExpression::setExpression(const ExpressionPtr& expr)
 {
     this->expression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr SelfExpression::getExpression()
 {
@@ -45,20 +45,27 @@ void StringInterpolation::accept(NodeVisitor* visitor)
 void StringInterpolation::addExpression(const ExpressionPtr& expr)
 {
     expressions.push_back(expr);
+    adopt(expr.get());
 }
 ExpressionPtr StringInterpolation::getExpression(int index)
 {
     return expressions[index];
 }
+
+void StringInterpolation::setExpression(int index, const ExpressionPtr& expr)
+{
+    expressions[index] = expr;
+    adopt(expr.get());
+}
 size_t StringInterpolation::numExpressions()const
 {
     return expressions.size();
 }
-std::vector<ExpressionPtr>::iterator StringInterpolation::begin()
+std::vector<ExpressionPtr>::const_iterator StringInterpolation::begin()const
 {
     return expressions.begin();
 }
-std::vector<ExpressionPtr>::iterator StringInterpolation::end()
+std::vector<ExpressionPtr>::const_iterator StringInterpolation::end()const
 {
     return expressions.end();
 }
@@ -29,6 +29,7 @@
  */
 #include "ast/SubscriptAccess.h"
 #include "ast/NodeVisitor.h"
+#include "ast/ParenthesizedExpression.h"
 USE_SWALLOW_NS
 
 
@@ -45,6 +46,7 @@ SubscriptAccess::~SubscriptAccess()
 void SubscriptAccess::setSelf(const ExpressionPtr& self)
 {
     this->self = self;
+    adopt(self.get());
 }
 const ExpressionPtr& SubscriptAccess::getSelf()
 {
@@ -54,6 +56,7 @@ const ExpressionPtr& SubscriptAccess::getSelf()
 void SubscriptAccess::setIndex(const ParenthesizedExpressionPtr& index)
 {
     this->indices = index;
+    adopt(index.get());
 }
 const ParenthesizedExpressionPtr& SubscriptAccess::getIndex()
 {
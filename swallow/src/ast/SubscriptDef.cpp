@@ -29,6 +29,9 @@
  */
 #include "ast/SubscriptDef.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/ParametersNode.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -50,6 +53,7 @@ void SubscriptDef::accept(NodeVisitor* visitor)
 void SubscriptDef::setParameters(const ParametersNodePtr& params)
 {
     this->parameters = params;
+    adopt(params.get());
 }
 ParametersNodePtr SubscriptDef::getParameters()
 {
@@ -59,6 +63,7 @@ ParametersNodePtr SubscriptDef::getParameters()
 void SubscriptDef::setReturnType(const TypeNodePtr& type)
 {
     this->returnType = type;
+    adopt(type.get());
 }
 TypeNodePtr SubscriptDef::getReturnType()
 {
@@ -77,6 +82,7 @@ const Attributes& SubscriptDef::getReturnTypeAttributes()const
 void SubscriptDef::setGetter(const CodeBlockPtr& getter)
 {
     this->getter = getter;
+    adopt(getter.get());
 }
 CodeBlockPtr SubscriptDef::getGetter()
 {
@@ -86,6 +92,7 @@ CodeBlockPtr SubscriptDef::getGetter()
 void SubscriptDef::setSetter(const CodeBlockPtr& setter)
 {
     this->setter = setter;
+    adopt(setter.get());
 }
 CodeBlockPtr SubscriptDef::getSetter()
 {
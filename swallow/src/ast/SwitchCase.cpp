@@ -29,6 +29,8 @@
  */
 #include "ast/SwitchCase.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CaseStatement.h"
+#include "ast/Expression.h"
 USE_SWALLOW_NS
 
 
@@ -51,6 +53,7 @@ void SwitchCase::accept(NodeVisitor* visitor)
 void SwitchCase::setControlExpression(const ExpressionPtr& expr)
 {
     this->controlExpression = expr;
+    adopt(expr.get());
 }
 ExpressionPtr SwitchCase::getControlExpression()
 {
@@ -60,6 +63,7 @@ ExpressionPtr SwitchCase::getControlExpression()
 void SwitchCase::addCase(const CaseStatementPtr& c)
 {
     cases.push_back(c);
+    adopt(c.get());
 }
 int SwitchCase::numCases()
 {
@@ -73,6 +77,7 @@ CaseStatementPtr SwitchCase::getCase(int idx)
 void SwitchCase::setDefaultCase(const CaseStatementPtr& c)
 {
     this->defaultCase = c;
+    adopt(c.get());
 }
 CaseStatementPtr SwitchCase::getDefaultCase()
 {
@@ -30,6 +30,7 @@
 #include "ast/Tuple.h"
 #include "ast/NodeVisitor.h"
 #include "ast/TypedPattern.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -54,11 +55,13 @@ TypeNodePtr Tuple::getDeclaredType()
 void Tuple::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 
 void Tuple::add(const PatternPtr& pattern)
 {
     elements.push_back(pattern);
+    adopt(pattern.get());
 }
 int Tuple::numElements()
 {
@@ -68,3 +71,9 @@ PatternPtr Tuple::getElement(int i)
 {
     return elements[i];
 }
+
+void Tuple::setElement(int i, const PatternPtr& pattern)
+{
+    elements[i] = pattern;
+    adopt(pattern.get());
+}
@@ -45,6 +45,7 @@ TupleType::~TupleType()
 void TupleType::add(bool inout, const std::wstring& name, const TypeNodePtr& type)
 {
     elements.push_back(TupleElement(inout, name, type));
+    adopt(type.get());
 }
 int TupleType::numElements()
 {
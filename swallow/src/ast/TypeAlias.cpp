@@ -29,6 +29,7 @@
  */
 #include "ast/TypeAlias.h"
 #include "ast/NodeVisitor.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -57,6 +58,7 @@ void TypeAlias::setName(const std::wstring& name)
 void TypeAlias::setType(TypeNodePtr type)
 {
     this->type = type;
+    adopt(type.get());
 }
 TypeNodePtr TypeAlias::getType()
 {
@@ -59,6 +59,7 @@ TypeNodePtr TypeCast::getDeclaredType()
 void TypeCast::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 
 int TypeCast::numChildren()
@@ -90,5 +91,6 @@ void TypeCast::set(int i, const NodePtr& val)
         default:
             break;
     }
+    adopt(val.get());
 }
 
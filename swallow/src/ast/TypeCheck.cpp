@@ -48,6 +48,7 @@ TypeNodePtr TypeCheck::getDeclaredType()
 void TypeCheck::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 int TypeCheck::numChildren()
 {
@@ -78,4 +79,5 @@ void TypeCheck::set(int i, const NodePtr& val)
         default:
             break;
     }
+    adopt(val.get());
 }
@@ -48,6 +48,7 @@ TypeDeclaration::~TypeDeclaration()
 void TypeDeclaration::addParent(const TypeIdentifierPtr& protocol)
 {
     parents.push_back(protocol);
+    adopt(protocol.get());
 }
 int TypeDeclaration::numParents()const
 {
@@ -65,6 +66,7 @@ TypeIdentifierPtr TypeDeclaration::getParent(int i)
 void TypeDeclaration::setIdentifier(const TypeIdentifierPtr& id)
 {
     this->identifier = id;
+    adopt(id.get());
 }
 TypeIdentifierPtr TypeDeclaration::getIdentifier()
 {
@@ -75,6 +77,7 @@ TypeIdentifierPtr TypeDeclaration::getIdentifier()
 void TypeDeclaration::addDeclaration(const DeclarationPtr& decl)
 {
     declarations.push_back(decl);
+    adopt(decl.get());
 }
 int TypeDeclaration::numDeclarations()const
 {
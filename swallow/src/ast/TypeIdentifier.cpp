@@ -53,6 +53,7 @@ const std::wstring& TypeIdentifier::getName() const
 void TypeIdentifier::addGenericArgument(TypeNodePtr argument)
 {
     genericArguments.push_back(argument);
+    adopt(argument.get());
 }
 size_t TypeIdentifier::numGenericArguments()
 {
@@ -67,6 +68,7 @@ TypeNodePtr TypeIdentifier::getGenericArgument(int idx)
 void TypeIdentifier::setNestedType(TypeIdentifierPtr type)
 {
     this->nestedType = type;
+    adopt(type.get());
 }
 TypeIdentifierPtr TypeIdentifier::getNestedType()
 {
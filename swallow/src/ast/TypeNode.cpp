@@ -29,6 +29,7 @@
  */
 #include "ast/TypeNode.h"
 #include <algorithm>
+#include "ast/Attribute.h"
 USE_SWALLOW_NS
 
 
@@ -44,6 +45,7 @@ TypeNode::~TypeNode()
 void TypeNode::addAttribute(AttributePtr attr)
 {
     attributes.push_back(attr);
+    adopt(attr.get());
 }
 void TypeNode::setAttributes(const std::vector<AttributePtr> attrs)
 {
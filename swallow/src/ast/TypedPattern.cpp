@@ -29,6 +29,8 @@
  */
 #include "ast/TypedPattern.h"
 #include "ast/NodeVisitor.h"
+#include "ast/GenericArgumentDef.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 TypedPattern::TypedPattern()
@@ -50,6 +52,7 @@ void TypedPattern::accept(NodeVisitor* visitor)
 void TypedPattern::setPattern(const PatternPtr& pattern)
 {
     this->pattern = pattern;
+    adopt(pattern.get());
 }
 PatternPtr TypedPattern::getPattern()const
 {
@@ -58,6 +61,7 @@ PatternPtr TypedPattern::getPattern()const
 void TypedPattern::setDeclaredType(const TypeNodePtr& type)
 {
     this->declaredType = type;
+    adopt(type.get());
 }
 TypeNodePtr TypedPattern::getDeclaredType()
 {
@@ -71,4 +75,5 @@ GenericArgumentDefPtr TypedPattern::getGenericArgumentDef()
 void TypedPattern::setGenericArgumentDef(const GenericArgumentDefPtr& val)
 {
     genericArgumentDef = val;
+    adopt(val.get());
 }
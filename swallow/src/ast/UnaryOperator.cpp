@@ -56,7 +56,10 @@ NodePtr UnaryOperator::get(int i)
 void UnaryOperator::set(int i, const NodePtr& val)
 {
     if(i == 0)
+    {
         operand = std::dynamic_pointer_cast<Expression>(val);
+        adopt(val.get());
+    }
 }
 
 void UnaryOperator::accept(NodeVisitor* visitor)
@@ -29,6 +29,7 @@
  */
 #include "ast/ValueBinding.h"
 #include "ast/NodeVisitor.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 ValueBinding::ValueBinding()
@@ -72,6 +73,7 @@ const Attributes& ValueBinding::getTypeAttributes() const
 void ValueBinding::setDeclaredType(const TypeNodePtr& t)
 {
     this->declaredType = t;
+    adopt(t.get());
 }
 TypeNodePtr ValueBinding::getDeclaredType()
 {
@@ -95,11 +97,13 @@ const PatternPtr& ValueBinding::getName()const
 void ValueBinding::setName(const PatternPtr& name)
 {
     this->name = name;
+    adopt(name.get());
 }
 
 void ValueBinding::setInitializer(const ExpressionPtr& initializer)
 {
     this->initializer = initializer;
+    adopt(initializer.get());
 }
 const ExpressionPtr& ValueBinding::getInitializer()const
 {
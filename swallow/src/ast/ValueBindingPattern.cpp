@@ -29,6 +29,7 @@
  */
 #include "ast/ValueBindingPattern.h"
 #include "ast/NodeVisitor.h"
+#include "ast/TypeNode.h"
 USE_SWALLOW_NS
 
 
@@ -50,6 +51,7 @@ void ValueBindingPattern::setReadOnly(bool readonly)
 void ValueBindingPattern::setBinding(const PatternPtr& st)
 {
     this->binding = st;
+    adopt(st.get());
 }
 PatternPtr ValueBindingPattern::getBinding() const
 {
@@ -63,6 +65,7 @@ TypeNodePtr ValueBindingPattern::getDeclaredType()const
 void ValueBindingPattern::setDeclaredType(const TypeNodePtr& type)
 {
     declaredType = type;
+    adopt(type.get());
 }
 
 
@@ -52,10 +52,12 @@ void ValueBindings::add(const ValueBindingPtr& var)
 {
     valueBindings.push_back(var);
     var->owner = std::static_pointer_cast<ValueBindings>(shared_from_this());
+    adopt(var.get());
 }
 ValueBindings::Iterator ValueBindings::insertBefore(const ValueBindingPtr& binding, const Iterator& iter)
 {
     binding->owner = std::static_pointer_cast<ValueBindings>(shared_from_this());
+    adopt(binding.get());
     if(iter == valueBindings.end())
     {
         valueBindings.push_back(binding);
@@ -82,6 +84,7 @@ void ValueBindings::insertAfter(const ValueBindingPtr& binding, const Iterator&
         valueBindings.insert(it, binding);
     }
     binding->owner = std::static_pointer_cast<ValueBindings>(shared_from_this());
+    adopt(binding.get());
 }
 ValueBindingPtr ValueBindings::get(int i)
 {
@@ -29,6 +29,8 @@
  */
 #include "ast/WhileLoop.h"
 #include "ast/NodeVisitor.h"
+#include "ast/CodeBlock.h"
+#include "ast/Expression.h"
 USE_SWALLOW_NS
 
 
@@ -51,6 +53,7 @@ void WhileLoop::accept(NodeVisitor* visitor)
 void WhileLoop::setCodeBlock(const CodeBlockPtr& codeBlock)
 {
     this->codeBlock = codeBlock;
+    adopt(codeBlock.get());
 }
 CodeBlockPtr WhileLoop::getCodeBlock()
 {
@@ -60,6 +63,7 @@ CodeBlockPtr WhileLoop::getCodeBlock()
 void WhileLoop::setCondition(const ExpressionPtr& expression)
 {
     this->condition = expression;
+    adopt(expression.get());
 }
 ExpressionPtr WhileLoop::getCondition()
 {
@@ -0,0 +1,1277 @@
+/* CEmitter.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "codegen/CEmitter.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/Type.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include "common/SwallowUtils.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+/*!
+ * Runtime shared by all emitted modules, it's emitted in front of the module
+ */
+static const char* prelude =
+    "/* Generated by Swallow */\n"
+    "#include <stdint.h>\n"
+    "#include <stdbool.h>\n"
+    "#include <stddef.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "#include <stdio.h>\n"
+    "#include <inttypes.h>\n"
+    "#include <math.h>\n"
+    "\n"
+    "typedef uint8_t sw_Metatype;\n"
+    "typedef struct sw_Object sw_Object;\n"
+    "typedef struct sw_VTable\n"
+    "{\n"
+    "    void (*destroy)(sw_Object*);\n"
+    "} sw_VTable;\n"
+    "/* header of all class instances */\n"
+    "struct sw_Object\n"
+    "{\n"
+    "    const sw_VTable* vtable;\n"
+    "    intptr_t refCount;\n"
+    "    intptr_t flags;\n"
+    "};\n"
+    "/* the instance is in the frame of its function, the final release doesn't free it */\n"
+    "#define SW_OBJECT_ON_STACK 1\n"
+    "/* storage of strings, literals are immortal and have a negative reference count */\n"
+    "typedef struct sw_StringStorage\n"
+    "{\n"
+    "    intptr_t refCount;\n"
+    "    int64_t length;\n"
+    "    char data[];\n"
+    "} sw_StringStorage;\n"
+    "typedef sw_StringStorage* sw_String;\n"
+    "\n"
+    "static void sw_trap(const char* message)\n"
+    "{\n"
+    "    fprintf(stderr, \"fatal error: %s\\n\", message);\n"
+    "    abort();\n"
+    "}\n"
+    "static inline sw_Object* sw_allocObject(size_t size, const sw_VTable* vtable)\n"
+    "{\n"
+    "    sw_Object* ret = (sw_Object*)calloc(1, size);\n"
+    "    if(!ret)\n"
+    "        sw_trap(\"out of memory\");\n"
+    "    ret->vtable = vtable;\n"
+    "    ret->refCount = 1;\n"
+    "    return ret;\n"
+    "}\n"
+    "static inline sw_Object* sw_initObject(void* storage, size_t size, const sw_VTable* vtable)\n"
+    "{\n"
+    "    sw_Object* ret = (sw_Object*)memset(storage, 0, size);\n"
+    "    ret->vtable = vtable;\n"
+    "    ret->refCount = 1;\n"
+    "    ret->flags = SW_OBJECT_ON_STACK;\n"
+    "    return ret;\n"
+    "}\n"
+    "static inline void sw_freeObject(sw_Object* object)\n"
+    "{\n"
+    "    if(!(object->flags & SW_OBJECT_ON_STACK))\n"
+    "        free(object);\n"
+    "}\n"
+    "static inline void sw_retain(sw_Object* object)\n"
+    "{\n"
+    "    if(object)\n"
+    "        object->refCount++;\n"
+    "}\n"
+    "static inline void sw_release(sw_Object* object)\n"
+    "{\n"
+    "    if(object && --object->refCount == 0)\n"
+    "        object->vtable->destroy(object);\n"
+    "}\n"
+    "static inline sw_String sw_allocString(int64_t length)\n"
+    "{\n"
+    "    sw_String ret = (sw_String)malloc(sizeof(sw_StringStorage) + length + 1);\n"
+    "    if(!ret)\n"
+    "        sw_trap(\"out of memory\");\n"
+    "    ret->refCount = 1;\n"
+    "    ret->length = length;\n"
+    "    ret->data[length] = 0;\n"
+    "    return ret;\n"
+    "}\n"
+    "static inline void sw_retain_String(sw_String str)\n"
+    "{\n"
+    "    if(str && str->refCount >= 0)\n"
+    "        str->refCount++;\n"
+    "}\n"
+    "static inline void sw_release_String(sw_String str)\n"
+    "{\n"
+    "    if(str && str->refCount >= 0 && --str->refCount == 0)\n"
+    "        free(str);\n"
+    "}\n"
+    "\n";
+
+static const char* const keywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern",
+    "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short", "signed",
+    "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while",
+    "bool", "true", "false", "main", "base", "header", "tag", "payload", nullptr
+};
+
+/*!
+ * Encodes a wide string into UTF-8
+ */
+static string toUTF8(const wstring& str)
+{
+    string ret;
+    for(wchar_t wc : str)
+    {
+        uint32_t ch = (uint32_t)wc;
+        if(ch < 0x80)
+            ret += (char)ch;
+        else if(ch < 0x800)
+        {
+            ret += (char)(0xc0 | (ch >> 6));
+            ret += (char)(0x80 | (ch & 0x3f));
+        }
+        else if(ch < 0x10000)
+        {
+            ret += (char)(0xe0 | (ch >> 12));
+            ret += (char)(0x80 | ((ch >> 6) & 0x3f));
+            ret += (char)(0x80 | (ch & 0x3f));
+        }
+        else
+        {
+            ret += (char)(0xf0 | (ch >> 18));
+            ret += (char)(0x80 | ((ch >> 12) & 0x3f));
+            ret += (char)(0x80 | ((ch >> 6) & 0x3f));
+            ret += (char)(0x80 | (ch & 0x3f));
+        }
+    }
+    return ret;
+}
+
+/*!
+ * Converts a Swift identifier into a valid C identifier, characters out of C's identifier set are
+ * escaped by their code point and identifiers that conflict with C keywords or generated members get a suffix.
+ */
+static string sanitize(const wstring& name)
+{
+    string ret;
+    char buf[16];
+    for(wchar_t ch : name)
+    {
+        if((ch >= L'a' && ch <= L'z') || (ch >= L'A' && ch <= L'Z') || (ch >= L'0' && ch <= L'9') || ch == L'_')
+            ret += (char)ch;
+        else
+        {
+            snprintf(buf, sizeof(buf), "_u%x_", (unsigned)ch);
+            ret += buf;
+        }
+    }
+    if(ret.empty() || (ret[0] >= '0' && ret[0] <= '9'))
+        ret = "_" + ret;
+    for(int i = 0; keywords[i]; i++)
+    {
+        if(ret == keywords[i])
+            return ret + "_";
+    }
+    return ret;
+}
+
+static bool hasFlag(const SymbolPtr& symbol, SymbolFlags flag)
+{
+    return symbol && symbol->hasFlags(flag);
+}
+
+static void getStoredProperties(const TypePtr& type, vector<SymbolPtr>& properties)
+{
+    for(const SymbolPtr& sym : type->getDeclaredStoredProperties())
+    {
+        if(!dynamic_pointer_cast<SymbolPlaceHolder>(sym) || sym->hasFlags(SymbolFlagTemporary))
+            continue;
+        properties.push_back(sym);
+    }
+}
+
+static bool sameSignature(const TypePtr& lhs, const TypePtr& rhs)
+{
+    const vector<Parameter>& params1 = lhs->getParameters();
+    const vector<Parameter>& params2 = rhs->getParameters();
+    if(params1.size() != params2.size() || !Type::equals(lhs->getReturnType(), rhs->getReturnType()))
+        return false;
+    for(size_t i = 0; i < params1.size(); i++)
+    {
+        if(params1[i].name != params2[i].name || params1[i].inout != params2[i].inout || !Type::equals(params1[i].type, params2[i].type))
+            return false;
+    }
+    return true;
+}
+
+/*!
+ * Strips the struct keyword from a C type name, used to derive names of helpers
+ */
+static string getTag(const string& type)
+{
+    if(type.compare(0, 7, "struct ") == 0)
+        return type.substr(7);
+    return type;
+}
+
+/*!
+ * A primitive type that's mapped to C's arithmetic type
+ */
+struct PrimitiveType
+{
+    const char* name;
+    TypePtr (GlobalScope::*type)() const;
+    const char* ctype;
+    const char* min;
+    const char* max;
+    int bits;
+    bool isSigned;
+    bool isFloat;
+};
+
+static const PrimitiveType primitives[] = {
+    {"Int", &GlobalScope::Int, "int64_t", "INT64_MIN", "INT64_MAX", 64, true, false},
+    {"Int64", &GlobalScope::Int64, "int64_t", "INT64_MIN", "INT64_MAX", 64, true, false},
+    {"Int32", &GlobalScope::Int32, "int32_t", "INT32_MIN", "INT32_MAX", 32, true, false},
+    {"Int16", &GlobalScope::Int16, "int16_t", "INT16_MIN", "INT16_MAX", 16, true, false},
+    {"Int8", &GlobalScope::Int8, "int8_t", "INT8_MIN", "INT8_MAX", 8, true, false},
+    {"UInt", &GlobalScope::UInt, "uint64_t", "0", "UINT64_MAX", 64, false, false},
+    {"UInt64", &GlobalScope::UInt64, "uint64_t", "0", "UINT64_MAX", 64, false, false},
+    {"UInt32", &GlobalScope::UInt32, "uint32_t", "0", "UINT32_MAX", 32, false, false},
+    {"UInt16", &GlobalScope::UInt16, "uint16_t", "0", "UINT16_MAX", 16, false, false},
+    {"UInt8", &GlobalScope::UInt8, "uint8_t", "0", "UINT8_MAX", 8, false, false},
+    {"Double", &GlobalScope::Double, "double", nullptr, nullptr, 64, true, true},
+    {"Float", &GlobalScope::Float, "float", nullptr, nullptr, 32, true, true},
+    {"Bool", &GlobalScope::Bool, "bool", nullptr, nullptr, 1, false, false},
+    {nullptr, nullptr, nullptr, nullptr, nullptr, 0, false, false}
+};
+
+/*!
+ * Gets the primitive by the suffix of a builtin's name
+ */
+static const PrimitiveType* getPrimitive(const string& name)
+{
+    for(int i = 0; primitives[i].name; i++)
+    {
+        if(name == primitives[i].name)
+            return &primitives[i];
+    }
+    return nullptr;
+}
+
+static const PrimitiveType* getPrimitive(GlobalScope* global, const TypePtr& type)
+{
+    if(!type || type->getCategory() != Type::Struct)
+        return nullptr;
+    for(int i = 0; primitives[i].name; i++)
+    {
+        if(type == (global->*primitives[i].type)())
+            return &primitives[i];
+    }
+    return nullptr;
+}
+
+struct CEmitter::ClassInfo
+{
+    TypePtr type;
+    //tag of the instance layout
+    string name;
+    ClassInfo* parent;
+    //implementation of each vtable slot
+    vector<FunctionSymbolPtr> slots;
+    vector<string> slotNames;
+    //slots of methods declared or overridden by this class and its parents
+    unordered_map<Symbol*, int> slotIndices;
+};
+
+CEmitter::CEmitter(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults)
+:symbolRegistry(symbolRegistry), compilerResults(compilerResults), module(nullptr), entryPoint(true)
+{
+    global = symbolRegistry->getGlobalScope();
+}
+
+CEmitter::~CEmitter()
+{
+}
+
+void CEmitter::unsupported(const std::wstring& what)
+{
+    compilerResults->add(ErrorLevel::Error, SourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_C_CODE_GENERATION_1, what);
+    throw Abort();
+}
+
+bool CEmitter::emit(const IRModule* module, std::ostream& out)
+{
+    this->module = module;
+    for(size_t i = 0; i < module->numFunctions(); i++)
+    {
+        const IRFunction* func = module->getFunctionAt(i);
+        if(func->symbol)
+            functionsBySymbol[func->symbol.get()] = func;
+    }
+    try
+    {
+        for(size_t i = 0; i < module->numFunctions(); i++)
+        {
+            const IRFunction* func = module->getFunctionAt(i);
+            //generic implementations are only reachable through their specialized copies
+            if(func->isGeneric())
+                continue;
+            string name = getFunctionName(func);
+            if(func->isExternal())
+            {
+                if(!emitIntrinsic(func))
+                    prototypes << "extern " << getPrototype(func, name) << ";\n";
+                continue;
+            }
+            prototypes << getPrototype(func, name) << ";\n";
+        }
+        for(size_t i = 0; i < module->numGlobals(); i++)
+        {
+            const IRGlobal& g = module->getGlobalAt(i);
+            globals << getTypeName(g.type) << " " << sanitize(g.name) << ";\n";
+        }
+        for(size_t i = 0; i < module->numFunctions(); i++)
+        {
+            const IRFunction* func = module->getFunctionAt(i);
+            if(!func->isExternal() && !func->isGeneric())
+                emitFunction(func);
+        }
+    }
+    catch(const Abort&)
+    {
+        return false;
+    }
+    out << prelude;
+    out << declarations.str() << "\n";
+    out << definitions.str();
+    out << builtins.str();
+    out << helpers.str();
+    out << prototypes.str() << "\n";
+    out << classes.str();
+    out << globals.str() << "\n";
+    out << functions.str();
+    if(entryPoint && module->getFunction(L"main"))
+    {
+        out << "int main(int argc, char** argv)\n";
+        out << "{\n";
+        out << "    (void)argc;\n";
+        out << "    (void)argv;\n";
+        out << "    swallow_main();\n";
+        out << "    return 0;\n";
+        out << "}\n";
+    }
+    return true;
+}
+
+/*********************************************************************
+ * Types
+ *********************************************************************/
+
+std::string CEmitter::getTypeName(IRTypeRef type)
+{
+    if(IRModule::isAddress(type))
+        return getTypeName(IRModule::objectOf(type)) + "*";
+    const IRType& info = module->getTypeInfo(type);
+    if(info.type)
+        return getTypeName(info.type);
+    if(type == IRModule::VoidType)
+        return "void";
+    const wstring& name = info.name;
+    if(name.size() > 5 && name.compare(name.size() - 5, 5, L".Type") == 0)
+        return "sw_Metatype";
+    unsupported(L"function value");
+    return "";
+}
+
+std::string CEmitter::getTypeName(const TypePtr& type)
+{
+    if(!type || type == global->Void())
+        return "void";
+    if(const PrimitiveType* p = getPrimitive(global, type))
+        return p->ctype;
+    if(type == global->String())
+        return "sw_String";
+    switch(type->getCategory())
+    {
+        case Type::Class:
+            getClassInfo(type);
+            return "sw_Object*";
+        case Type::Struct:
+        case Type::Enum:
+            return defineNominalType(type);
+        case Type::Tuple:
+            if(type->numElementTypes() == 0)
+                return "void";
+            return defineTuple(type);
+        case Type::MetaType:
+            return "sw_Metatype";
+        default:
+            unsupported(L"type " + type->toString());
+            return "";
+    }
+}
+
+/*!
+ * Struct and enum are defined after the types of their members
+ */
+std::string CEmitter::defineNominalType(const TypePtr& type)
+{
+    auto iter = typeNames.find(type.get());
+    if(iter != typeNames.end())
+        return iter->second;
+    string tag = "sw_" + sanitize(type->getName());
+    for(int i = 2; usedNames.find(tag) != usedNames.end(); i++)
+        tag = "sw_" + sanitize(type->getName()) + "_" + to_string(i);
+    usedNames.insert(tag);
+    string ret = "struct " + tag;
+    typeNames.insert(make_pair(type.get(), ret));
+    ostringstream def;
+    def << ret << "\n{\n";
+    if(type->getCategory() == Type::Struct)
+    {
+        vector<SymbolPtr> properties;
+        getStoredProperties(type, properties);
+        for(const SymbolPtr& field : properties)
+            def << "    " << getTypeName(field->getType()) << " " << sanitize(field->getName()) << ";\n";
+        if(properties.empty())
+            def << "    char unused;\n";
+    }
+    else
+    {
+        def << "    uint32_t tag;\n";
+        ostringstream payloads;
+        for(const auto& c : type->getEnumCases())
+        {
+            TypePtr payload = c.second.type;
+            if(!payload || payload == global->Void())
+                continue;
+            if(payload->getCategory() == Type::Tuple && payload->numElementTypes() == 1)
+                payload = payload->getElementType(0);
+            payloads << "        " << getTypeName(payload) << " " << sanitize(c.first) << ";\n";
+        }
+        if(!payloads.str().empty())
+            def << "    union\n    {\n" << payloads.str() << "    } payload;\n";
+    }
+    def << "};\n\n";
+    declarations << ret << ";\n";
+    definitions << def.str();
+    return ret;
+}
+
+std::string CEmitter::defineTuple(const TypePtr& type)
+{
+    wstring key = type->toString();
+    auto iter = tupleNames.find(key);
+    if(iter != tupleNames.end())
+        return iter->second;
+    string ret = "struct sw_tuple" + to_string(tupleNames.size());
+    ostringstream def;
+    def << ret << "\n{\n";
+    for(int i = 0; i < type->numElementTypes(); i++)
+        def << "    " << getTypeName(type->getElementType(i)) << " e" << i << ";\n";
+    def << "};\n\n";
+    tupleNames.insert(make_pair(key, ret));
+    declarations << ret << ";\n";
+    definitions << def.str();
+    return ret;
+}
+
+CEmitter::ClassInfo* CEmitter::getClassInfo(const TypePtr& type)
+{
+    auto iter = classInfos.find(type.get());
+    if(iter != classInfos.end())
+        return iter->second;
+    ClassInfo* info = new ClassInfo();
+    info->type = type;
+    info->parent = nullptr;
+    info->name = "sw_" + sanitize(type->getName());
+    for(int i = 2; usedNames.find(info->name) != usedNames.end(); i++)
+        info->name = "sw_" + sanitize(type->getName()) + "_" + to_string(i);
+    usedNames.insert(info->name);
+    classList.push_back(unique_ptr<ClassInfo>(info));
+    classInfos.insert(make_pair(type.get(), info));
+
+    TypePtr parentType = type->getParentType();
+    if(parentType && parentType->getCategory() == Type::Class)
+    {
+        info->parent = getClassInfo(parentType);
+        info->slots = info->parent->slots;
+        info->slotNames = info->parent->slotNames;
+        info->slotIndices = info->parent->slotIndices;
+    }
+    //layout of the instance, parent's layout comes first
+    ostringstream def;
+    def << "struct " << info->name << "\n{\n";
+    if(info->parent)
+        def << "    struct " << info->parent->name << " base;\n";
+    else
+        def << "    sw_Object header;\n";
+    vector<SymbolPtr> properties;
+    getStoredProperties(type, properties);
+    for(const SymbolPtr& field : properties)
+        def << "    " << getTypeName(field->getType()) << " " << sanitize(field->getName()) << ";\n";
+    def << "};\n\n";
+    declarations << "struct " << info->name << ";\n";
+    definitions << def.str();
+
+    //an override takes the slot of the method it overrides, other methods get new slots
+    for(const FunctionOverloadedSymbolPtr& funcs : type->getDeclaredFunctions())
+    {
+        for(const FunctionSymbolPtr& func : *funcs)
+        {
+            if(hasFlag(func, SymbolFlagStatic) || hasFlag(func, SymbolFlagInit) || hasFlag(func, SymbolFlagDeinit))
+                continue;
+            int slot = -1;
+            for(size_t i = 0; i < info->slots.size(); i++)
+            {
+                if(info->slots[i]->getName() == func->getName() && sameSignature(info->slots[i]->getType(), func->getType()))
+                {
+                    slot = (int)i;
+                    break;
+                }
+            }
+            if(slot == -1)
+            {
+                slot = (int)info->slots.size();
+                info->slots.push_back(func);
+                info->slotNames.push_back("m" + to_string(slot) + "_" + sanitize(func->getName()));
+            }
+            info->slots[slot] = func;
+            info->slotIndices[func.get()] = slot;
+        }
+    }
+    defineClass(info);
+    return info;
+}
+
+/*!
+ * Emits the vtable, destructor and vtable instance of a class
+ */
+void CEmitter::defineClass(ClassInfo* info)
+{
+    const string& name = info->name;
+    ostringstream out;
+    out << "struct " << name << "_vtable\n{\n";
+    out << "    sw_VTable header;\n";
+    vector<string> slotTypes;
+    for(size_t i = 0; i < info->slots.size(); i++)
+    {
+        //the signature of a slot is decided by the method that introduced it
+        const IRFunction* func = nullptr;
+        for(ClassInfo* c = info; c; c = c->parent)
+        {
+            if(i < c->slots.size())
+            {
+                auto iter = functionsBySymbol.find(c->slots[i].get());
+                if(iter != functionsBySymbol.end())
+                    func = iter->second;
+            }
+        }
+        string decl = func ? getPrototype(func, "(*" + info->slotNames[i] + ")") : "void (*" + info->slotNames[i] + ")(void)";
+        out << "    " << decl << ";\n";
+        slotTypes.push_back(decl);
+    }
+    out << "};\n";
+    //fields are released from the most derived class to the root
+    out << "static void " << name << "_releaseFields(sw_Object* self)\n{\n";
+    vector<SymbolPtr> properties;
+    getStoredProperties(info->type, properties);
+    for(const SymbolPtr& field : properties)
+    {
+        string helper = getValueHelper(field->getType(), false);
+        if(!helper.empty())
+            out << "    " << helper << "(((struct " << name << "*)self)->" << sanitize(field->getName()) << ");\n";
+    }
+    if(info->parent)
+        out << "    " << info->parent->name << "_releaseFields(self);\n";
+    out << "}\n";
+    out << "static void " << name << "_destroy(sw_Object* self)\n{\n";
+    out << "    /* deinitializers may retain and release self */\n";
+    out << "    self->refCount = 1;\n";
+    for(ClassInfo* c = info; c; c = c->parent)
+    {
+        FunctionSymbolPtr deinit = c->type->getDeinit();
+        auto iter = deinit ? functionsBySymbol.find(deinit.get()) : functionsBySymbol.end();
+        if(iter != functionsBySymbol.end())
+            out << "    " << getFunctionName(iter->second) << "(self);\n";
+    }
+    out << "    " << name << "_releaseFields(self);\n";
+    out << "    sw_freeObject(self);\n";
+    out << "}\n";
+    out << "static const struct " << name << "_vtable " << name << "_vtable = {\n";
+    out << "    {" << name << "_destroy}";
+    for(size_t i = 0; i < info->slots.size(); i++)
+    {
+        auto iter = functionsBySymbol.find(info->slots[i].get());
+        out << ",\n    ";
+        if(iter == functionsBySymbol.end() || iter->second->isExternal())
+        {
+            out << "NULL";
+            continue;
+        }
+        //overrides may differ in the types of address parameters, they're called through the slot's type
+        string impl = getPrototype(iter->second, "(*" + info->slotNames[i] + ")");
+        if(impl != slotTypes[i])
+        {
+            string cast = slotTypes[i];
+            cast.replace(cast.find(info->slotNames[i]), info->slotNames[i].size(), "");
+            out << "(" << cast << ")";
+        }
+        out << getFunctionName(iter->second);
+    }
+    out << "\n};\n\n";
+    classes << out.str();
+}
+
+bool CEmitter::isTrivial(const TypePtr& type)
+{
+    if(!type || getPrimitive(global, type))
+        return true;
+    auto iter = trivialTypes.find(type.get());
+    if(iter != trivialTypes.end())
+        return iter->second;
+    bool ret = false;
+    switch(type->getCategory())
+    {
+        case Type::Struct:
+        {
+            if(type == global->String())
+                break;
+            ret = true;
+            vector<SymbolPtr> properties;
+            getStoredProperties(type, properties);
+            for(const SymbolPtr& sym : properties)
+                ret = ret && isTrivial(sym->getType());
+            break;
+        }
+        case Type::Tuple:
+            ret = true;
+            for(int i = 0; i < type->numElementTypes(); i++)
+                ret = ret && isTrivial(type->getElementType(i));
+            break;
+        case Type::Enum:
+            ret = true;
+            for(const auto& c : type->getEnumCases())
+                ret = ret && isTrivial(c.second.type);
+            break;
+        case Type::MetaType:
+            ret = true;
+            break;
+        default:
+            break;
+    }
+    trivialTypes.insert(make_pair(type.get(), ret));
+    return ret;
+}
+
+std::string CEmitter::getValueHelper(const TypePtr& type, bool retain)
+{
+    if(isTrivial(type))
+        return "";
+    if(type->getCategory() == Type::Class)
+        return retain ? "sw_retain" : "sw_release";
+    if(type == global->String())
+        return retain ? "sw_retain_String" : "sw_release_String";
+    string typeName = getTypeName(type);
+    string ret = (retain ? "sw_retain_" : "sw_release_") + getTag(typeName);
+    if(definedHelpers.find(ret) != definedHelpers.end())
+        return ret;
+    definedHelpers.insert(ret);
+    //helpers of members are defined first
+    ostringstream body;
+    switch(type->getCategory())
+    {
+        case Type::Struct:
+        {
+            vector<SymbolPtr> properties;
+            getStoredProperties(type, properties);
+            for(const SymbolPtr& field : properties)
+            {
+                string helper = getValueHelper(field->getType(), retain);
+                if(!helper.empty())
+                    body << "    " << helper << "(value." << sanitize(field->getName()) << ");\n";
+            }
+            break;
+        }
+        case Type::Tuple:
+            for(int i = 0; i < type->numElementTypes(); i++)
+            {
+                string helper = getValueHelper(type->getElementType(i), retain);
+                if(!helper.empty())
+                    body << "    " << helper << "(value.e" << i << ");\n";
+            }
+            break;
+        case Type::Enum:
+        {
+            body << "    switch(value.tag)\n    {\n";
+            uint32_t index = 0;
+            for(const auto& c : type->getEnumCases())
+            {
+                TypePtr payload = c.second.type;
+                if(payload->getCategory() == Type::Tuple && payload->numElementTypes() == 1)
+                    payload = payload->getElementType(0);
+                string helper = getValueHelper(payload, retain);
+                if(!helper.empty())
+                    body << "        case " << index << ":\n            " << helper << "(value.payload." << sanitize(c.first) << ");\n            break;\n";
+                index++;
+            }
+            body << "        default:\n            break;\n    }\n";
+            break;
+        }
+        default:
+            unsupported(L"type " + type->toString());
+    }
+    helpers << "static void " << ret << "(" << typeName << " value)\n{\n" << body.str() << "}\n";
+    return ret;
+}
+
+/*!
+ * Builtins are named as operation_Type, each one is implemented by a static function with the same name.
+ * Arithmetic on integers traps on overflow and division by zero like Swift does.
+ */
+std::string CEmitter::getBuiltin(const std::wstring& name)
+{
+    string ret = "sw_" + toUTF8(name);
+    if(definedHelpers.find(ret) != definedHelpers.end())
+        return ret;
+    size_t pos = name.rfind(L'_');
+    const PrimitiveType* p = pos == wstring::npos ? nullptr : getPrimitive(toUTF8(name.substr(pos + 1)));
+    if(!p)
+    {
+        unsupported(L"builtin " + name);
+        return "";
+    }
+    string op = toUTF8(name.substr(0, pos));
+    string T = p->ctype;
+    //unsigned type of same width, used by wrapping operations
+    string U = p->isSigned && !p->isFloat ? "u" + T : T;
+    ostringstream out;
+    bool unary = op == "neg" || op == "not";
+    out << "static inline " << (op.compare(0, 4, "cmp_") == 0 ? "bool" : T.c_str()) << " " << ret;
+    if(unary)
+        out << "(" << T << " a)\n{\n";
+    else
+        out << "(" << T << " a, " << T << " b)\n{\n";
+    const char* binaries[][2] = {
+        {"add", "+"}, {"sub", "-"}, {"mul", "*"}, {"div", "/"}, {"rem", "%"},
+        {"cmp_eq", "=="}, {"cmp_ne", "!="}, {"cmp_lt", "<"}, {"cmp_le", "<="}, {"cmp_gt", ">"}, {"cmp_ge", ">="},
+        {"and", "&"}, {"or", "|"}, {"xor", "^"}, {nullptr, nullptr}
+    };
+    const char* symbol = nullptr;
+    for(int i = 0; binaries[i][0]; i++)
+    {
+        if(op == binaries[i][0])
+            symbol = binaries[i][1];
+    }
+    bool integer = !p->isFloat && p->bits > 1;
+    if(op.compare(0, 4, "cmp_") == 0 || op == "and" || op == "or" || op == "xor")
+    {
+        if(!symbol || p->isFloat)
+            unsupported(L"builtin " + name);
+        out << "    return a " << symbol << " b;\n";
+    }
+    else if(p->isFloat)
+    {
+        if(op == "neg")
+            out << "    return -a;\n";
+        else if(op == "rem")
+            out << "    return " << (p->bits == 32 ? "fmodf" : "fmod") << "(a, b);\n";
+        else if(op == "add" || op == "sub" || op == "mul" || op == "div")
+            out << "    return a " << symbol << " b;\n";
+        else
+            unsupported(L"builtin " + name);
+    }
+    else if(op == "not")
+        out << "    return " << (p->bits == 1 ? "!a" : "(" + T + ")~a") << ";\n";
+    else if(!integer)
+        unsupported(L"builtin " + name);
+    else if(op == "add" || op == "sub" || op == "mul")
+    {
+        //checked before the operation so the result is always representable
+        if(op == "add" && p->isSigned)
+            out << "    if((b > 0 && a > " << p->max << " - b) || (b < 0 && a < " << p->min << " - b))\n";
+        else if(op == "add")
+            out << "    if(a > " << p->max << " - b)\n";
+        else if(op == "sub" && p->isSigned)
+            out << "    if((b < 0 && a > " << p->max << " + b) || (b > 0 && a < " << p->min << " + b))\n";
+        else if(op == "sub")
+            out << "    if(a < b)\n";
+        else if(p->isSigned)
+            out << "    if(a != 0 && b != 0 && (a > 0 ? (b > 0 ? a > " << p->max << " / b : b < " << p->min << " / a)"
+                << " : (b > 0 ? a < " << p->min << " / b : a < " << p->max << " / b)))\n";
+        else
+            out << "    if(b != 0 && a > " << p->max << " / b)\n";
+        out << "        sw_trap(\"arithmetic overflow\");\n";
+        out << "    return (" << T << ")(a " << symbol << " b);\n";
+    }
+    else if(op == "div" || op == "rem")
+    {
+        out << "    if(b == 0)\n        sw_trap(\"division by zero\");\n";
+        if(p->isSigned)
+            out << "    if(a == " << p->min << " && b == -1)\n        sw_trap(\"arithmetic overflow\");\n";
+        out << "    return (" << T << ")(a " << symbol << " b);\n";
+    }
+    else if(op == "wrapping_add" || op == "wrapping_sub" || op == "wrapping_mul")
+    {
+        //computed in 64 bits unsigned to avoid the undefined behavior of signed overflow
+        out << "    return (" << T << ")((uint64_t)a " << (op == "wrapping_add" ? "+" : op == "wrapping_sub" ? "-" : "*") << " (uint64_t)b);\n";
+    }
+    else if(op == "wrapping_div" || op == "wrapping_rem")
+    {
+        out << "    if(b == 0)\n        return 0;\n";
+        if(p->isSigned)
+            out << "    if(a == " << p->min << " && b == -1)\n        return " << (op == "wrapping_div" ? "a" : "0") << ";\n";
+        out << "    return (" << T << ")(a " << (op == "wrapping_div" ? "/" : "%") << " b);\n";
+    }
+    else if(op == "shl" || op == "shr")
+    {
+        //shifting by the width or more shifts all bits out
+        out << "    if(b < 0 || b >= " << p->bits << ")\n";
+        out << "        return " << (op == "shr" && p->isSigned ? "a < 0 ? -1 : 0" : "0") << ";\n";
+        if(op == "shl")
+            out << "    return (" << T << ")((" << U << ")a << b);\n";
+        else
+            out << "    return (" << T << ")(a >> b);\n";
+    }
+    else if(op == "neg")
+    {
+        if(p->isSigned)
+            out << "    if(a == " << p->min << ")\n        sw_trap(\"arithmetic overflow\");\n";
+        else
+            out << "    if(a != 0)\n        sw_trap(\"arithmetic overflow\");\n";
+        out << "    return (" << T << ")-a;\n";
+    }
+    else
+        unsupported(L"builtin " + name);
+    out << "}\n";
+    definedHelpers.insert(ret);
+    builtins << out.str();
+    return ret;
+}
+
+/*********************************************************************
+ * Functions
+ *********************************************************************/
+
+std::string CEmitter::getFunctionName(const IRFunction* func)
+{
+    //top-level code is exported under a name that doesn't conflict with C's entry point
+    if(func->name == L"main")
+        return "swallow_main";
+    return sanitize(func->name);
+}
+
+/*!
+ * Declaration of the function with given name, parameters are named by the values of the entry block's arguments
+ */
+std::string CEmitter::getPrototype(const IRFunction* func, const std::string& name)
+{
+    ostringstream out;
+    out << getTypeName(func->result) << " " << name << "(";
+    uint32_t first = func->blocks.empty() ? 0 : func->blocks[0].first;
+    for(size_t i = 0; i < func->parameters.size(); i++)
+    {
+        if(i)
+            out << ", ";
+        out << getTypeName(func->parameters[i]) << " v" << (first + i);
+    }
+    if(func->parameters.empty())
+        out << "void";
+    out << ")";
+    return out.str();
+}
+
+/*!
+ * Functions declared by the standard library without body, only printing and String's operators are provided
+ */
+bool CEmitter::emitIntrinsic(const IRFunction* func)
+{
+    FunctionSymbolPtr symbol = dynamic_pointer_cast<FunctionSymbol>(func->symbol);
+    if(!symbol)
+        return false;
+    const vector<Parameter>& params = symbol->getType()->getParameters();
+    const wstring& name = symbol->getName();
+    ostringstream body;
+    if((name == L"print" || name == L"println") && params.size() == 1)
+    {
+        TypePtr type = params[0].type;
+        const PrimitiveType* p = getPrimitive(global, type);
+        const char* newline = name == L"println" ? "\\n" : "";
+        if(type == global->String())
+            body << "    fwrite(v0->data, 1, (size_t)v0->length, stdout);\n";
+        else if(p && p->bits == 1)
+            body << "    fputs(v0 ? \"true\" : \"false\", stdout);\n";
+        else if(p && p->isFloat)
+            body << "    printf(\"%.17g\", (double)v0);\n";
+        else if(p)
+            body << "    printf(\"%\" " << (p->isSigned ? "PRId64" : "PRIu64") << ", (" << (p->isSigned ? "int64_t" : "uint64_t") << ")v0);\n";
+        else
+            return false;
+        if(*newline)
+            body << "    fputs(\"" << newline << "\", stdout);\n";
+    }
+    else if(params.size() == 2 && params[0].type == global->String() && params[1].type == global->String())
+    {
+        if(name == L"+")
+        {
+            body << "    sw_String ret = sw_allocString(v0->length + v1->length);\n";
+            body << "    memcpy(ret->data, v0->data, (size_t)v0->length);\n";
+            body << "    memcpy(ret->data + v0->length, v1->data, (size_t)v1->length);\n";
+            body << "    return ret;\n";
+        }
+        else if(name == L"==" || name == L"!=")
+            body << "    return (v0->length == v1->length && !memcmp(v0->data, v1->data, (size_t)v0->length)) == " << (name == L"==" ? "true" : "false") << ";\n";
+        else
+            return false;
+    }
+    else
+        return false;
+    prototypes << "static " << getPrototype(func, getFunctionName(func)) << ";\n";
+    builtins << "static " << getPrototype(func, getFunctionName(func)) << "\n{\n" << body.str() << "}\n";
+    return true;
+}
+
+void CEmitter::emitFunction(const IRFunction* func)
+{
+    functions << getPrototype(func, getFunctionName(func)) << "\n{\n";
+    //all values are declared at the beginning, so branches never jump over a declaration
+    for(IRValue v = 0; v < func->instructions.size(); v++)
+    {
+        const IRInstruction& inst = func->instructions[v];
+        if(!IROpcode::hasResult(inst.opcode) || inst.opcode == IROpcode::FunctionRef || inst.opcode == IROpcode::ClassMethod)
+            continue;
+        if(inst.opcode == IROpcode::Argument && inst.block == 0)
+            continue;
+        string type = getTypeName(inst.type);
+        if(type == "void")
+            continue;
+        if(inst.opcode == IROpcode::AllocStack)
+            functions << "    " << getTypeName(IRModule::objectOf(inst.type)) << " s" << v << ";\n";
+        if(inst.opcode == IROpcode::AllocRef && inst.flags)
+            functions << "    struct " << getClassInfo(module->getTypeInfo(inst.type).type)->name << " s" << v << ";\n";
+        functions << "    " << type << " v" << v << ";\n";
+    }
+    for(uint32_t b = 0; b < func->blocks.size(); b++)
+    {
+        const IRBasicBlock& block = func->blocks[b];
+        if(b)
+            functions << "bb" << b << ":;\n";
+        for(IRValue v = block.first + block.numArguments; v < block.end; v++)
+            emitInstruction(func, v);
+    }
+    functions << "}\n\n";
+}
+
+std::string CEmitter::getStringLiteral(uint32_t index)
+{
+    string name = "sw_string" + to_string(index);
+    if(emittedStrings.insert(index).second)
+    {
+        string str = toUTF8(module->getStringAt(index));
+        ostringstream literal;
+        char buf[8];
+        for(unsigned char ch : str)
+        {
+            if(ch >= 0x20 && ch < 0x7f && ch != '"' && ch != '\\' && ch != '?')
+                literal << (char)ch;
+            else
+            {
+                snprintf(buf, sizeof(buf), "\\%03o", ch);
+                literal << buf;
+            }
+        }
+        globals << "static struct { intptr_t refCount; int64_t length; char data[" << (str.size() + 1) << "]; } "
+            << name << " = {-1, " << str.size() << ", \"" << literal.str() << "\"};\n";
+    }
+    return "(sw_String)&" + name;
+}
+
+void CEmitter::emitBranch(const IRFunction* func, uint32_t target, const IRValue* args, int numArgs)
+{
+    const IRBasicBlock& block = func->blocks[target];
+    if(numArgs == 1)
+        functions << "    v" << block.first << " = v" << args[0] << ";\n";
+    else if(numArgs > 1)
+    {
+        //arguments are assigned in parallel, a source can be another argument of the same block
+        functions << "    {\n";
+        for(int i = 0; i < numArgs; i++)
+            functions << "        " << getTypeName(func->instructions[block.first + i].type) << " t" << i << " = v" << args[i] << ";\n";
+        for(int i = 0; i < numArgs; i++)
+            functions << "        v" << (block.first + i) << " = t" << i << ";\n";
+        functions << "    }\n";
+    }
+    functions << "    goto bb" << target << ";\n";
+}
+
+void CEmitter::emitInstruction(const IRFunction* func, IRValue value)
+{
+    const IRInstruction& inst = func->instructions[value];
+    const IRValue* ops = func->getOperands(inst);
+    ostream& out = functions;
+    string dst = "v" + to_string(value);
+    switch(inst.opcode)
+    {
+        case IROpcode::AllocStack:
+            out << "    " << dst << " = &s" << value << ";\n";
+            break;
+        case IROpcode::AllocRef:
+        {
+            ClassInfo* info = getClassInfo(module->getTypeInfo(inst.type).type);
+            if(inst.flags)
+                out << "    " << dst << " = sw_initObject(&s" << value << ", sizeof(struct " << info->name << "), &" << info->name << "_vtable.header);\n";
+            else
+                out << "    " << dst << " = sw_allocObject(sizeof(struct " << info->name << "), &" << info->name << "_vtable.header);\n";
+            break;
+        }
+        case IROpcode::DeallocStack:
+            break;
+        case IROpcode::DeallocRef:
+            out << "    sw_freeObject(v" << ops[0] << ");\n";
+            break;
+        case IROpcode::Load:
+            out << "    " << dst << " = *v" << ops[0] << ";\n";
+            break;
+        case IROpcode::Store:
+            out << "    *v" << ops[1] << " = v" << ops[0] << ";\n";
+            break;
+        case IROpcode::DestroyAddr:
+        {
+            TypePtr type = module->getTypeInfo(func->getValueType(ops[0])).type;
+            string helper = getValueHelper(type, false);
+            if(!helper.empty())
+                out << "    " << helper << "(*v" << ops[0] << ");\n";
+            break;
+        }
+        case IROpcode::Struct:
+        case IROpcode::Tuple:
+        {
+            string type = getTypeName(inst.type);
+            if(type == "void")
+                break;
+            out << "    " << dst << " = (" << type << "){";
+            for(int i = 0; i < inst.numOperands; i++)
+                out << (i ? ", v" : "v") << ops[i];
+            if(!inst.numOperands)
+                out << "0";
+            out << "};\n";
+            break;
+        }
+        case IROpcode::Enum:
+        {
+            const IRMember& member = module->getMemberAt(inst.immediate.index);
+            out << "    " << dst << ".tag = " << member.index << ";\n";
+            if(inst.numOperands)
+                out << "    " << dst << ".payload." << sanitize(member.name) << " = v" << ops[0] << ";\n";
+            break;
+        }
+        case IROpcode::StructExtract:
+            out << "    " << dst << " = v" << ops[0] << "." << sanitize(module->getMemberAt(inst.immediate.index).name) << ";\n";
+            break;
+        case IROpcode::StructElementAddr:
+            out << "    " << dst << " = &v" << ops[0] << "->" << sanitize(module->getMemberAt(inst.immediate.index).name) << ";\n";
+            break;
+        case IROpcode::TupleExtract:
+            out << "    " << dst << " = v" << ops[0] << ".e" << inst.immediate.index << ";\n";
+            break;
+        case IROpcode::TupleElementAddr:
+            out << "    " << dst << " = &v" << ops[0] << "->e" << inst.immediate.index << ";\n";
+            break;
+        case IROpcode::RefElementAddr:
+        {
+            //the field is accessed through the layout of the class that declares it
+            const IRMember& member = module->getMemberAt(inst.immediate.index);
+            ClassInfo* info = getClassInfo(member.owner);
+            out << "    " << dst << " = &((struct " << info->name << "*)v" << ops[0] << ")->" << sanitize(member.name) << ";\n";
+            break;
+        }
+        case IROpcode::UncheckedEnumData:
+            out << "    " << dst << " = v" << ops[0] << ".payload." << sanitize(module->getMemberAt(inst.immediate.index).name) << ";\n";
+            break;
+        case IROpcode::GlobalAddr:
+            out << "    " << dst << " = &" << sanitize(module->getGlobalAt(inst.immediate.index).name) << ";\n";
+            break;
+        case IROpcode::IntegerLiteral:
+        {
+            string type = getTypeName(inst.type);
+            int64_t i = inst.immediate.integer;
+            out << "    " << dst << " = ";
+            if(type == "bool")
+                out << (i ? "true" : "false");
+            else if(type == "uint64_t")
+                out << "UINT64_C(" << (uint64_t)i << ")";
+            else if(i == INT64_MIN)
+                out << "INT64_MIN";
+            else if(i >= INT32_MIN && i <= INT32_MAX)
+                out << i;
+            else
+                out << "INT64_C(" << i << ")";
+            out << ";\n";
+            break;
+        }
+        case IROpcode::FloatLiteral:
+        {
+            double d = inst.immediate.real;
+            out << "    " << dst << " = ";
+            if(std::isnan(d))
+                out << "NAN";
+            else if(std::isinf(d))
+                out << (d < 0 ? "-INFINITY" : "INFINITY");
+            else
+            {
+                //17 significant digits keep the exact value of a double
+                char buf[40];
+                snprintf(buf, sizeof(buf), "%.17g", d);
+                out << buf;
+                if(!strpbrk(buf, ".e"))
+                    out << ".0";
+                if(getTypeName(inst.type) == "float")
+                    out << "f";
+            }
+            out << ";\n";
+            break;
+        }
+        case IROpcode::StringLiteral:
+            out << "    " << dst << " = " << getStringLiteral(inst.immediate.index) << ";\n";
+            break;
+        case IROpcode::Metatype:
+            out << "    " << dst << " = 0;\n";
+            break;
+        case IROpcode::FunctionRef:
+        case IROpcode::ClassMethod:
+            //only used as callees of apply
+            break;
+        case IROpcode::Apply:
+        {
+            const IRInstruction& callee = func->instructions[ops[0]];
+            string target;
+            if(inst.immediate.index)
+                unsupported(L"call of generic function without specialization");
+            if(callee.opcode == IROpcode::FunctionRef)
+                target = getFunctionName(module->getFunctionAt(callee.immediate.index));
+            else if(callee.opcode == IROpcode::ClassMethod)
+            {
+                const IRMember& member = module->getMemberAt(callee.immediate.index);
+                ClassInfo* info = getClassInfo(member.owner);
+                IRValue self = func->getOperand(callee, 0);
+                auto iter = info->slotIndices.find(member.symbol.get());
+                if(iter != info->slotIndices.end())
+                    target = "((const struct " + info->name + "_vtable*)v" + to_string(self) + "->vtable)->" + info->slotNames[iter->second];
+                else
+                {
+                    //methods out of vtable are dispatched statically
+                    auto func = functionsBySymbol.find(member.symbol.get());
+                    if(func == functionsBySymbol.end())
+                        unsupported(L"method " + member.name);
+                    target = getFunctionName(func->second);
+                }
+            }
+            else
+                unsupported(L"call of function value");
+            out << "    ";
+            if(getTypeName(inst.type) != "void")
+                out << dst << " = ";
+            out << target << "(";
+            for(int i = 1; i < inst.numOperands; i++)
+                out << (i > 1 ? ", v" : "v") << ops[i];
+            out << ");\n";
+            break;
+        }
+        case IROpcode::Builtin:
+        {
+            string builtin = getBuiltin(module->getStringAt(inst.immediate.index));
+            out << "    " << dst << " = " << builtin << "(";
+            for(int i = 0; i < inst.numOperands; i++)
+                out << (i ? ", v" : "v") << ops[i];
+            out << ");\n";
+            break;
+        }
+        case IROpcode::StrongRetain:
+            out << "    sw_retain(v" << ops[0] << ");\n";
+            break;
+        case IROpcode::StrongRelease:
+            out << "    sw_release(v" << ops[0] << ");\n";
+            break;
+        case IROpcode::RetainValue:
+        case IROpcode::ReleaseValue:
+        {
+            TypePtr type = module->getTypeInfo(func->getValueType(ops[0])).type;
+            string helper = getValueHelper(type, inst.opcode == IROpcode::RetainValue);
+            if(!helper.empty())
+                out << "    " << helper << "(v" << ops[0] << ");\n";
+            break;
+        }
+        case IROpcode::DebugValue:
+            break;
+        case IROpcode::Return:
+            if(getTypeName(func->result) == "void")
+                out << "    return;\n";
+            else
+                out << "    return v" << ops[0] << ";\n";
+            break;
+        case IROpcode::Br:
+            emitBranch(func, inst.immediate.index, ops, inst.numOperands);
+            break;
+        case IROpcode::CondBr:
+            out << "    if(v" << ops[0] << ")\n        goto bb" << inst.immediate.targets[0] << ";\n";
+            out << "    goto bb" << inst.immediate.targets[1] << ";\n";
+            break;
+        case IROpcode::SwitchEnum:
+        {
+            out << "    switch(v" << ops[0] << ".tag)\n    {\n";
+            for(int i = 1; i + 1 < inst.numOperands; i += 2)
+                out << "        case " << module->getMemberAt(ops[i]).index << ": goto bb" << ops[i + 1] << ";\n";
+            if(inst.immediate.index != IRFunction::InvalidBlock)
+                out << "        default: goto bb" << inst.immediate.index << ";\n";
+            else
+                out << "        default: sw_trap(\"unreachable\");\n";
+            out << "    }\n";
+            break;
+        }
+        case IROpcode::CondFail:
+            out << "    if(v" << ops[0] << ")\n        sw_trap(\"condition failed\");\n";
+            break;
+        case IROpcode::Unreachable:
+            out << "    sw_trap(\"unreachable\");\n";
+            break;
+        default:
+            unsupported(wstring(L"instruction ") + SwallowUtils::toWString(IROpcode::getName(inst.opcode)));
+            break;
+    }
+}
@@ -0,0 +1,516 @@
+/* Demangler.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "codegen/Demangler.h"
+#include <cstring>
+#include <cctype>
+
+USE_SWALLOW_NS
+using namespace std;
+
+
+DemangledSymbol::DemangledSymbol()
+:kind(Function), extension(false), accessor(0), fixity(0), special(0), isPrivate(false)
+{
+}
+
+/*!
+ * Readable text of the symbol, like main.test (Swift.Int) -> Swift.Bool
+ */
+std::wstring DemangledSymbol::toString() const
+{
+    wstring ret = contextName.empty() ? module : contextName;
+    ret += L".";
+    switch(special)
+    {
+        case 'C': ret += L"__allocating_init"; break;
+        case 'c': ret += L"init"; break;
+        case 'D': ret += L"__deallocating_deinit"; break;
+        case 'd': ret += L"deinit"; break;
+        default: ret += name; break;
+    }
+    switch(accessor)
+    {
+        case 'g': ret += L".getter"; break;
+        case 's': ret += L".setter"; break;
+        case 'w': ret += L".willSet"; break;
+        case 'W': ret += L".didSet"; break;
+        default: break;
+    }
+    if(type.empty())
+        return ret;
+    if(kind == Variable || accessor)
+        ret += L" : ";
+    else
+        ret += L" ";
+    ret += generics;
+    ret += type;
+    return ret;
+}
+
+/*!
+ * Swift's abbreviations for the types in standard library
+ */
+static const wchar_t* getAbbreviation(char ch)
+{
+    switch(ch)
+    {
+        case 'a': return L"Swift.Array";
+        case 'b': return L"Swift.Bool";
+        case 'c': return L"Swift.UnicodeScalar";
+        case 'd': return L"Swift.Double";
+        case 'f': return L"Swift.Float";
+        case 'i': return L"Swift.Int";
+        case 'q': return L"Swift.Optional";
+        case 'Q': return L"Swift.ImplicitlyUnwrappedOptional";
+        case 'S': return L"Swift.String";
+        case 'u': return L"Swift.UInt";
+        default: return nullptr;
+    }
+}
+/*!
+ * Restore the operator characters that were replaced by letters during encoding
+ */
+static wchar_t decodeOperator(wchar_t ch)
+{
+    switch(ch)
+    {
+        case 'p': return '+';
+        case 'e': return '=';
+        case 's': return '-';
+        case 'n': return '!';
+        case 'r': return '%';
+        case 'x': return '^';
+        case 'a': return '&';
+        case 'm': return '*';
+        case 'o': return '|';
+        case 't': return '~';
+        case 'd': return '/';
+        case 'l': return '<';
+        case 'g': return '>';
+        case 'q': return '?';
+        default: return ch;
+    }
+}
+/*!
+ * Strip the module and generic arguments from a readable type name
+ */
+static wstring simpleName(const wstring& name)
+{
+    wstring ret = name.substr(0, name.find(L'<'));
+    size_t dot = ret.rfind(L'.');
+    if(dot != wstring::npos)
+        ret = ret.substr(dot + 1);
+    return ret;
+}
+
+bool Demangler::demangle(const std::string& name, DemangledSymbol& out)
+{
+    return demangle(name.c_str(), name.size(), out);
+}
+
+/*!
+ * \brief Parse a mangled name
+ * \return false if the name is not a valid mangled name
+ */
+bool Demangler::demangle(const char* name, size_t length, DemangledSymbol& out)
+{
+    cursor = name;
+    end = name + length;
+    substitutions.clear();
+    genericParameters.clear();
+    out = DemangledSymbol();
+    if(!match('_') || !match('T'))
+        return false;
+    if(match('v'))
+        out.kind = DemangledSymbol::Variable;
+    else if(match('F'))
+        out.kind = DemangledSymbol::Function;
+    else
+        return false;
+    //kinds of the declaring types
+    string kinds;
+    while(cursor < end && strchr("OVPCE", *cursor))
+        kinds.push_back(*cursor++);
+    if(!parseName(out.module))
+        return false;
+    module = out.module;
+    //declaring types
+    for(char kind : kinds)
+    {
+        wstring name;
+        if(kind == 'E')
+        {
+            if(!parseType(out.contextName))
+                return false;
+            out.extension = true;
+            out.context.push_back(simpleName(out.contextName));
+            continue;
+        }
+        if(!parseName(name))
+            return false;
+        if(out.contextName.empty())
+            out.contextName = module;
+        out.contextName += L".";
+        out.contextName += name;
+        out.context.push_back(name);
+        substitutions.push_back(out.contextName);
+    }
+    if(cursor < end && strchr("gswW", *cursor))
+        out.accessor = *cursor++;
+    if(match('o'))
+    {
+        if(cursor >= end || !strchr("ipP", *cursor))
+            return false;
+        out.fixity = *cursor++;
+    }
+    if(peek('P'))
+    {
+        //private discriminator, P33_ followed by the hash of module
+        if(end - cursor < 36 || strncmp(cursor, "P33_", 4))
+            return false;
+        cursor += 36;
+        out.isPrivate = true;
+    }
+    if(cursor < end && strchr("CcDd", *cursor))
+    {
+        out.special = *cursor++;
+        out.name = (out.special == 'C' || out.special == 'c') ? L"init" : L"deinit";
+    }
+    else
+    {
+        if(!parseName(out.name))
+            return false;
+        if(out.fixity)
+        {
+            for(wchar_t& ch : out.name)
+                ch = decodeOperator(ch);
+        }
+    }
+    if(match('U') && !parseGenerics(out.generics))
+        return false;
+    //deinit has no symbol type
+    if(out.special != 'd' && !parseType(out.type))
+        return false;
+    return cursor == end;
+}
+
+/*!
+ * \brief Demangle a name into readable text
+ * \return The name itself if it cannot be demangled
+ */
+std::wstring Demangler::demangle(const std::string& name)
+{
+    DemangledSymbol symbol;
+    if(demangle(name, symbol))
+        return symbol.toString();
+    return wstring(name.begin(), name.end());
+}
+
+bool Demangler::match(char ch)
+{
+    if(cursor < end && *cursor == ch)
+    {
+        cursor++;
+        return true;
+    }
+    return false;
+}
+bool Demangler::peek(char ch) const
+{
+    return cursor < end && *cursor == ch;
+}
+
+bool Demangler::parseNumber(int& out)
+{
+    if(cursor >= end || !isdigit(*cursor))
+        return false;
+    out = 0;
+    while(cursor < end && isdigit(*cursor))
+        out = out * 10 + (*cursor++ - '0');
+    return true;
+}
+
+/*!
+ * Parse an identifier prefixed by its length in characters, the characters are encoded in UTF-8
+ */
+bool Demangler::parseName(std::wstring& out)
+{
+    int len;
+    if(!parseNumber(len))
+        return false;
+    out.clear();
+    for(int i = 0; i < len; i++)
+    {
+        if(cursor >= end)
+            return false;
+        unsigned char c = (unsigned char)*cursor++;
+        unsigned int ch = c;
+        int extra = 0;
+        if(c >= 0xf0)
+        {
+            ch = c & 0x07;
+            extra = 3;
+        }
+        else if(c >= 0xe0)
+        {
+            ch = c & 0x0f;
+            extra = 2;
+        }
+        else if(c >= 0xc0)
+        {
+            ch = c & 0x1f;
+            extra = 1;
+        }
+        for(; extra > 0; extra--)
+        {
+            if(cursor >= end)
+                return false;
+            ch = (ch << 6) | ((unsigned char)*cursor++ & 0x3f);
+        }
+        out.push_back((wchar_t)ch);
+    }
+    return true;
+}
+
+/*!
+ * Parse a module-qualified type name, Ss stands for module Swift and S_ for current module
+ */
+bool Demangler::parseNominal(std::wstring& out)
+{
+    wstring name;
+    if(!match('S'))
+        return false;
+    if(match('s'))
+        out = L"Swift";
+    else if(match('_'))
+        out = module;
+    else
+        return false;
+    if(!parseName(name))
+        return false;
+    out += L".";
+    out += name;
+    substitutions.push_back(out);
+    return true;
+}
+
+/*!
+ * Parse a type that starts with S, it's either an abbreviation, a reference to previous type or a bare protocol
+ */
+bool Demangler::parseSubstitution(std::wstring& out)
+{
+    if(cursor + 1 >= end)
+        return false;
+    char ch = cursor[1];
+    if(ch == 's' || ch == '_')
+        return parseNominal(out);
+    cursor++;
+    int idx;
+    if(parseNumber(idx))
+    {
+        if(!match('_') || idx < 0 || idx >= (int)substitutions.size())
+            return false;
+        out = substitutions[idx];
+        return true;
+    }
+    const wchar_t* abbrev = getAbbreviation(*cursor);
+    if(!abbrev)
+        return false;
+    cursor++;
+    out = abbrev;
+    return true;
+}
+
+/*!
+ * Parse tuple elements till the terminator, element may have a label.
+ */
+bool Demangler::parseTuple(std::wstring& out)
+{
+    out = L"(";
+    bool first = true;
+    while(!match('_'))
+    {
+        wstring label, type;
+        if(cursor < end && isdigit(*cursor) && !parseName(label))
+            return false;
+        if(!parseType(type))
+            return false;
+        if(!first)
+            out += L", ";
+        first = false;
+        if(!label.empty())
+        {
+            out += label;
+            out += L" : ";
+        }
+        out += type;
+    }
+    out += L")";
+    return true;
+}
+
+/*!
+ * Parse generic parameters, each parameter is terminated by _ after its protocol constraints
+ */
+bool Demangler::parseGenerics(std::wstring& out)
+{
+    out = L"<";
+    //an unconstrained parameter is a single _, the list's terminator is followed by the function type
+    while(cursor < end && !(*cursor == '_' && (cursor + 1 == end || cursor[1] == 'F' || cursor[1] == 'f')))
+    {
+        wstring name(1, (wchar_t)('A' + genericParameters.size() % 26));
+        if(genericParameters.size() >= 26)
+            name += to_wstring(genericParameters.size() / 26);
+        if(!genericParameters.empty())
+            out += L", ";
+        out += name;
+        genericParameters.push_back(name);
+        bool first = true;
+        while(!match('_'))
+        {
+            wstring constraint;
+            if(!parseType(constraint))
+                return false;
+            out += first ? L" : " : L", ";
+            out += constraint;
+            first = false;
+        }
+    }
+    out += L">";
+    return match('_');
+}
+
+bool Demangler::parseType(std::wstring& out)
+{
+    if(cursor >= end)
+        return false;
+    char ch = *cursor++;
+    switch(ch)
+    {
+        case 'S':
+            cursor--;
+            return parseSubstitution(out);
+        case 'V':
+        case 'C':
+        case 'O':
+            return parseNominal(out);
+        case 'P':
+        {
+            //protocol or protocol composition
+            vector<wstring> protocols;
+            size_t numSubstitutions = substitutions.size();
+            while(!match('_'))
+            {
+                wstring protocol;
+                if(!parseNominal(protocol))
+                    return false;
+                protocols.push_back(protocol);
+            }
+            if(protocols.size() == 1)
+            {
+                out = protocols[0];
+                return true;
+            }
+            //protocols inside a composition are not referenced
+            substitutions.resize(numSubstitutions);
+            out = L"protocol<";
+            for(size_t i = 0; i < protocols.size(); i++)
+            {
+                if(i)
+                    out += L", ";
+                out += protocols[i];
+            }
+            out += L">";
+            return true;
+        }
+        case 'G':
+        {
+            if(!parseType(out))
+                return false;
+            out += L"<";
+            bool first = true;
+            while(!match('_'))
+            {
+                wstring arg;
+                if(!parseType(arg))
+                    return false;
+                if(!first)
+                    out += L", ";
+                first = false;
+                out += arg;
+            }
+            out += L">";
+            return true;
+        }
+        case 'Q':
+        {
+            int idx = 0;
+            if(parseNumber(idx))
+                idx++;
+            if(!match('_') || idx >= (int)genericParameters.size())
+                return false;
+            out = genericParameters[idx];
+            return true;
+        }
+        case 'T':
+            return parseTuple(out);
+        case 'M':
+            if(!parseType(out))
+                return false;
+            out += L".Type";
+            return true;
+        case 'R':
+            if(!parseType(out))
+                return false;
+            out = L"inout " + out;
+            return true;
+        case 'F':
+        {
+            wstring params, ret;
+            if(!parseType(params) || !parseType(ret))
+                return false;
+            if(params.empty() || params[0] != L'(')
+                params = L"(" + params + L")";
+            out = params + L" -> " + ret;
+            return true;
+        }
+        case 'f':
+        {
+            //curried function, the first parameter list is the implicit self
+            wstring self, rest;
+            if(!parseType(self) || !parseType(rest))
+                return false;
+            out = L"(" + self + L")" + rest;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
@@ -8,7 +8,10 @@
 #include "common/SwallowUtils.h"
 #include "semantics/GenericArgument.h"
 #include "semantics/GenericDefinition.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/FunctionOverloadedSymbol.h"
 #include "3rdparty/md5.h"
+#include "common/CompilerStats.h"
 #include <algorithm>
 #include <semantics/CollectionTypeAnalyzer.h>
 
@@ -22,11 +25,11 @@ SWALLOW_NS_BEGIN
 struct ManglingContext
 {
     wstring currentModule;
-    wstringstream& out;
+    string& out;
     vector<TypePtr> types;
     vector<wstring> genericParameters;
 
-    ManglingContext(const wstring& module, wstringstream& out)
+    ManglingContext(const wstring& module, string& out)
             :currentModule(module), out(out)
     {
 
@@ -73,6 +76,7 @@ SWALLOW_NS_END
 
 
 NameMangling::NameMangling(SymbolRegistry *registry)
+    :registry(registry)
 {
     GlobalScope* g = registry->getGlobalScope();
     defineAbbreviation(g->UInt(), L"Su");
@@ -96,21 +100,79 @@ NameMangling::~NameMangling()
 void NameMangling::defineAbbreviation(const TypePtr& type, const std::wstring& abbrev)
 {
     nameToType.insert(make_pair(abbrev, type));
-    typeToName.insert(make_pair(type, abbrev));
+    typeToName.insert(make_pair(type, SwallowUtils::toString(abbrev)));
+}
+
+
+static void appendNumber(string& out, int n)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", n);
+    out += buf;
 }
 /*!
- * \brief Decode a mangled name into a symbol
- * \param name
- * \return nullptr if failed to decode it
+ * Append a character of identifier, non-ASCII characters are written in UTF-8
  */
-SymbolPtr NameMangling::decode(const wchar_t* name)
+static void appendChar(string& out, wchar_t c)
 {
-    return nullptr;
-
+    unsigned int ch = (unsigned int)c;
+    if(ch < 0x80)
+        out.push_back((char)ch);
+    else if(ch < 0x800)
+    {
+        out.push_back((char)(0xc0 | (ch >> 6)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+    else if(ch < 0x10000)
+    {
+        out.push_back((char)(0xe0 | (ch >> 12)));
+        out.push_back((char)(0x80 | ((ch >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+    else
+    {
+        out.push_back((char)(0xf0 | (ch >> 18)));
+        out.push_back((char)(0x80 | ((ch >> 12) & 0x3f)));
+        out.push_back((char)(0x80 | ((ch >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+}
+/*!
+ * Decode the UTF-8 mangled name back to wide string
+ */
+static wstring toWide(const string& str)
+{
+    wstring ret;
+    ret.reserve(str.size());
+    for(size_t i = 0; i < str.size(); )
+    {
+        unsigned char c = (unsigned char)str[i];
+        unsigned int ch = c;
+        int extra = 0;
+        if(c >= 0xf0)
+        {
+            ch = c & 0x07;
+            extra = 3;
+        }
+        else if(c >= 0xe0)
+        {
+            ch = c & 0x0f;
+            extra = 2;
+        }
+        else if(c >= 0xc0)
+        {
+            ch = c & 0x1f;
+            extra = 1;
+        }
+        i++;
+        for(; extra > 0 && i < str.size(); extra--, i++)
+            ch = (ch << 6) | ((unsigned char)str[i] & 0x3f);
+        ret.push_back((wchar_t)ch);
+    }
+    return ret;
 }
 
-
-static void encodeName(wstringstream& out, const wchar_t* name)
+static void encodeName(string& out, const wchar_t* name)
 {
     const wchar_t* p = name;
     while(p && *p)
@@ -122,7 +184,7 @@ static void encodeName(wstringstream& out, const wchar_t* name)
             len = next - p;
         else
             len = wcslen(p);
-        out<<len;
+        appendNumber(out, len);
         for(int i = 0; i < len; i++)
         {
             wchar_t c = p[i];
@@ -143,27 +205,40 @@ static void encodeName(wstringstream& out, const wchar_t* name)
                 case '>': c = 'g'; break;
                 case '?': c = 'q'; break;
             }
-            out<<c;
+            appendChar(out, c);
         }
         p = next;
     }
 }
-static void encodeName(wstringstream& out, const wstring& name)
+static void encodeName(string& out, const wstring& name)
 {
     encodeName(out, name.c_str());
 }
 
 
-void NameMangling::encodeType(wstringstream& out, const wstring& moduleName, const wstring& typeName)
+/*!
+ * Encode the module-qualified name of a nominal type, the fragment is context-free so it's cached per type.
+ */
+void NameMangling::encodeType(string& out, const TypePtr& type)
 {
-    if(moduleName == L"Swift")
-        out<<L"Ss";
+    auto iter = nominalNames.find(type);
+    if(iter != nominalNames.end())
+        CompilerStats::increase(CompilerCounter::ManglingCacheHits);
     else
     {
-        out << L"S_";
-        encodeName(out, moduleName);
+        string fragment;
+        const wstring& moduleName = type->getModuleName();
+        if(moduleName == L"Swift")
+            fragment += "Ss";
+        else
+        {
+            fragment += "S_";
+            encodeName(fragment, moduleName);
+        }
+        encodeName(fragment, type->getName());
+        iter = nominalNames.insert(make_pair(type, fragment)).first;
     }
-    encodeName(out, typeName);
+    out += iter->second;
 }
 
 /*!
@@ -197,10 +272,10 @@ void NameMangling::encodeType(ManglingContext& ctx, const TypePtr& type, bool wr
 {
     //check for abbreviation
     auto iter = typeToName.find(type);
-    wstringstream& out = ctx.out;
+    string& out = ctx.out;
     if(iter != typeToName.end())
     {
-        out << iter->second;
+        out += iter->second;
         return;
     }
     Type::Category category = type->getCategory();
@@ -208,7 +283,9 @@ void NameMangling::encodeType(ManglingContext& ctx, const TypePtr& type, bool wr
     //use short syntax to make a reference
     if(idx != -1)
     {
-        out <<L"S" <<idx << L"_";
+        out += "S";
+        appendNumber(out, idx);
+        out += "_";
         return;
     }
     ctx.saveTypeReference(type);
@@ -219,56 +296,60 @@ void NameMangling::encodeType(ManglingContext& ctx, const TypePtr& type, bool wr
     switch(category)
     {
         case Type::Specialized:
-            out<<L"G";
+            out += "G";
             encodeType(ctx, type->getInnerType());
             for(const TypePtr& arg : *type->getGenericArguments())
             {
                 encodeType(ctx, arg);
             }
-            out<<L"_";
+            out += "_";
             break;
         case Type::Alias:
         {
             int n = ctx.getGenericReference(type->getName());
             assert(n != -1);
             if(n == 0)
-                out<<L"Q_";
+                out += "Q_";
             else
-                out<<L"Q" << (n - 1) <<L"_";
+            {
+                out += "Q";
+                appendNumber(out, n - 1);
+                out += "_";
+            }
             break;
         }
         case Type::Tuple:
             if(wrapCollections)
-                out<<L"T";
+                out += "T";
             for(int i = 0; i < type->numElementTypes(); i++)
             {
                 TypePtr element = type->getElementType(i);
                 encodeType(ctx, element);
             }
             if(wrapCollections)
-                out<<L"_";
+                out += "_";
             break;
         case Type::Enum:
-            out<<L"O";
-            encodeType(out, type->getModuleName(), type->getName());
+            out += "O";
+            encodeType(out, type);
             break;
         case Type::Protocol:
             if(wrapCollections)
-                out<<L"P";
-            encodeType(out, type->getModuleName(), type->getName());
+                out += "P";
+            encodeType(out, type);
             if(wrapCollections)
-                out<<L"_";
+                out += "_";
             break;
         case Type::Struct:
-            out<<L"V";
-            encodeType(out, type->getModuleName(), type->getName());
+            out += "V";
+            encodeType(out, type);
             break;
         case Type::Class:
-            out<<L"C";
-            encodeType(out, type->getModuleName(), type->getName());
+            out += "C";
+            encodeType(out, type);
             break;
         case Type::MetaType:
-            out<<L"M";
+            out += "M";
             encodeType(ctx, type->getInnerType());
             break;
         case Type::Function:
@@ -278,43 +359,43 @@ void NameMangling::encodeType(ManglingContext& ctx, const TypePtr& type, bool wr
             if (type->hasFlags(SymbolFlagMember))
             {
                 if(!encodeParameters)
-                    out << L"F";
+                    out += "F";
                 else
-                    out << L"f";
+                    out += "f";
                 if (type->hasFlags(SymbolFlagStatic) || type->hasFlags(SymbolFlagInit))
-                    out << L"M";
+                    out += "M";
                 if (type->hasFlags(SymbolFlagMutating) && type->getDeclaringType() && type->getDeclaringType()->isValueType())
-                    out << L"R";
+                    out += "R";
                 encodeType(ctx, type->getDeclaringType());
             }
             if(encodeParameters)
             {
-                out << L"F";
+                out += "F";
                 bool ignoreTuple = type->getParameters().size() == 1 && !type->hasFlags(SymbolFlagInit);
                 if (!ignoreTuple)
-                    out << L"T";
+                    out += "T";
                 for (const Parameter &param : type->getParameters())
                 {
                     if (!param.name.empty())
                         encodeName(out, param.name);
                     if (type->hasFlags(SymbolFlagMutating))
-                        out << L"M";
+                        out += "M";
                     if (param.inout)
-                        out << L"R";
+                        out += "R";
                     encodeType(ctx, param.type);
                 }
                 if (!ignoreTuple)
-                    out << L"_";
+                    out += "_";
             }
             if (type->hasFlags(SymbolFlagInit))
             {
                 if(type->hasFlags(SymbolFlagImplicitFailableInitializer))
-                    out << L"GSQ";
+                    out += "GSQ";
                 else if(type->hasFlags(SymbolFlagFailableInitializer))
-                    out << L"GSq";
+                    out += "GSq";
                 encodeType(ctx, type->getDeclaringType());
                 if(type->hasFlags(SymbolFlagFailableInitializer))
-                    out << L"_";
+                    out += "_";
             }
             else
                 encodeType(ctx, type->getReturnType());
@@ -323,14 +404,20 @@ void NameMangling::encodeType(ManglingContext& ctx, const TypePtr& type, bool wr
         case Type::ProtocolComposition:
             {
                 if(wrapCollections)
-                    out<<L"P";
-                vector<TypePtr> protocols = sortTypes(type->getProtocols());
-                for (const TypePtr &protocol : protocols)
+                    out += "P";
+                auto iter = compositions.find(type);
+                if(iter == compositions.end())
                 {
-                    encodeType(out, protocol->getModuleName(), protocol->getName());
+                    string fragment;
+                    for (const TypePtr &protocol : sortTypes(type->getProtocols()))
+                    {
+                        encodeType(fragment, protocol);
+                    }
+                    iter = compositions.insert(make_pair(type, fragment)).first;
                 }
+                out += iter->second;
                 if(wrapCollections)
-                    out << L"_";
+                    out += "_";
             }
             break;
         default:
@@ -357,26 +444,26 @@ static void encodeDeclaringType(ManglingContext& ctx, const TypePtr& type)
     ctx.saveTypeReference(type);
     encodeName(ctx.out, type->getName());
 }
-static void encodeTypeKind(wostream& out, const TypePtr& type)
+static void encodeTypeKind(string& out, const TypePtr& type)
 {
     if(type->getDeclaringType())
         encodeTypeKind(out, type->getDeclaringType());
     switch(type->getCategory())
     {
         case Type::Enum:
-            out<<L"O";
+            out += "O";
             break;
         case Type::Struct:
-            out<<L"V";
+            out += "V";
             break;
         case Type::Protocol:
-            out<<L"P";
+            out += "P";
             break;
         case Type::Class:
-            out<<L"C";
+            out += "C";
             break;
         case Type::Extension:
-            out<<L"E";
+            out += "E";
             break;
         default:
             break;
@@ -389,23 +476,76 @@ static void encodeTypeKind(wostream& out, const TypePtr& type)
  * \return
  */
 std::wstring NameMangling::encode(const SymbolPtr& symbol)
+{
+    if(!encode(symbol, buffer))
+        return L"";
+    return toWide(buffer);
+}
+
+std::wstring NameMangling::encodeSpecialization(const std::wstring& name, const std::vector<TypePtr>& arguments)
+{
+    PhaseTimer timer(CompilerPhase::Mangling);
+    string out = "_TTSg";
+    ManglingContext context(L"main", out);
+    for(const TypePtr& arg : arguments)
+    {
+        out += "5";
+        encodeType(context, arg);
+        out += "_";
+    }
+    out += "_";
+    for(wchar_t ch : name)
+        appendChar(out, ch);
+    return toWide(out);
+}
+
+/*!
+ * Return the mangled fragment of module's private discriminator, md5 is only calculated once per module.
+ */
+const std::string& NameMangling::getDiscriminator(const std::wstring& moduleName)
+{
+    auto iter = discriminators.find(moduleName);
+    if(iter != discriminators.end())
+        CompilerStats::increase(CompilerCounter::ManglingCacheHits);
+    else
+    {
+        string fragment = "P33_";
+        fragment += md5(SwallowUtils::toString(moduleName));
+        iter = discriminators.insert(make_pair(moduleName, fragment)).first;
+    }
+    return iter->second;
+}
+
+/*!
+ * \brief Encode a symbol into a mangled name, the name is written into given narrow buffer
+ */
+bool NameMangling::encode(const SymbolPtr& symbol, std::string& out)
+{
+    PhaseTimer timer(CompilerPhase::Mangling);
+    if(!encodeImpl(symbol, out))
+        return false;
+    symbols.insert(make_pair(out, symbol));
+    return true;
+}
+
+bool NameMangling::encodeImpl(const SymbolPtr& symbol, std::string& out)
 {
     wstring moduleName = L"main";
-    wstringstream out;
+    out.clear();
     ManglingContext context(moduleName, out);
-    out<<L"_T";//mark for swift symbol
+    out += "_T";//mark for swift symbol
     if(SymbolPlaceHolderPtr sym = dynamic_pointer_cast<SymbolPlaceHolder>(symbol))
     {
         if(!sym->hasFlags(SymbolFlagStatic) && sym->getRole() != SymbolPlaceHolder::R_TOP_LEVEL_VARIABLE)
-            return L"";//Non top-level variable will not be encoded.
-        out<<L"v";//mark for variable
+            return false;//Non top-level variable will not be encoded.
+        out += "v";//mark for variable
     }
     else if(FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(symbol))
     {
-        out<<L"F";//mark for function
+        out += "F";//mark for function
     }
     else
-        return L"";//unsupported symbol type
+        return false;//unsupported symbol type
     if(symbol->getDeclaringType())
         encodeTypeKind(out, symbol->getDeclaringType());
 
@@ -429,41 +569,39 @@ std::wstring NameMangling::encode(const SymbolPtr& symbol)
         FunctionRole role = accessor->getRole();
         symbolType = accessor->getOwnerProperty()->getType();
         if(role == FunctionRoleGetter)
-            out << L"g";
+            out += "g";
         else if(role == FunctionRoleSetter)
-            out << L"s";
+            out += "s";
         else if(role == FunctionRoleWillSet)
-            out << L"w";
+            out += "w";
         else if(role == FunctionRoleDidSet)
-            out << L"W";
+            out += "W";
         else
             assert(0 && "Invalid role for a property accessor");
     }
     if(symbol->hasFlags(SymbolFlagOperator))
     {
-        out << L"o";
+        out += "o";
         if(symbol->hasFlags(SymbolFlagInfix))
-            out << L"i";
+            out += "i";
         else if(symbol->hasFlags(SymbolFlagPrefix))
-            out << L"p";
+            out += "p";
         else if(symbol->hasFlags(SymbolFlagPostfix))
-            out << L"P";
+            out += "P";
     }
 
     if(symbol->getAccessLevel() == AccessLevelPrivate)
     {
-        out<<L"P33_";
-        string s = md5(SwallowUtils::toString(moduleName));
-        out<<SwallowUtils::toWString(s);
+        out += getDiscriminator(moduleName);
     }
     if(symbolType->hasFlags(SymbolFlagAllocatingInit))
-        out<<L"C";
+        out += "C";
     else if(symbolType->hasFlags(SymbolFlagInit))
-        out<<L"c";
+        out += "c";
     else if(symbolType->hasFlags(SymbolFlagDeallocatingInit))
-        out << L"D";
+        out += "D";
     else if(symbolType->hasFlags(SymbolFlagDeinit))
-        out << L"d";
+        out += "d";
     else
         encodeName(out, symbolName);
     if(FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(symbol))
@@ -486,45 +624,203 @@ std::wstring NameMangling::encode(const SymbolPtr& symbol)
 
     }
     #endif
-    return out.str();
+    return true;
+}
+
+/*!
+ * Collect the symbols that can be mangled from a symbol defined in scope
+ */
+static void collectSymbols(const SymbolPtr& symbol, vector<SymbolPtr>& symbols)
+{
+    if(!symbol)
+        return;
+    if(FunctionOverloadedSymbolPtr funcs = dynamic_pointer_cast<FunctionOverloadedSymbol>(symbol))
+    {
+        for(const FunctionSymbolPtr& func : *funcs)
+            symbols.push_back(func);
+    }
+    else if(ComputedPropertySymbolPtr prop = dynamic_pointer_cast<ComputedPropertySymbol>(symbol))
+    {
+        //accessors are declared in the scope as functions, only the backing storage is collected here
+        if(prop->getVariable())
+            symbols.push_back(prop->getVariable());
+    }
+    else
+        symbols.push_back(symbol);
+}
+
+/*!
+ * \brief Encode all symbols defined in given scope at once
+ */
+void NameMangling::encodeAll(SymbolScope* scope, std::vector<std::pair<SymbolPtr, std::string> >& results)
+{
+    vector<SymbolPtr> symbols;
+    for(auto entry : scope->getSymbols())
+    {
+        collectSymbols(entry.second, symbols);
+    }
+    results.reserve(results.size() + symbols.size());
+    for(const SymbolPtr& symbol : symbols)
+    {
+        if(encode(symbol, buffer))
+            results.push_back(make_pair(symbol, buffer));
+    }
 }
 
 void NameMangling::encodeGeneric(ManglingContext &context, const GenericDefinitionPtr &def)
 {
-    context.out<<L"U";
+    context.out += "U";
     for(const GenericDefinition::Parameter& param : def->getParameters())
     {
         GenericDefinition::NodeDefPtr node = def->getConstraint(param.name);
         if(node)
         {
-            vector<TypePtr> types;
-            //collect all constraints for generic parameter
-            for(const GenericDefinition::Constraint& constraint : node->constraints)
+            context.genericParameters.push_back(param.name);
+            //then encode them to result stream
+            for(const TypePtr& type : getSortedConstraints(node))
             {
-                if(constraint.type != GenericDefinition::AssignableTo)
-                    continue;
-                //unpack protocol composition
-                if(constraint.reference->getCategory() == Type::ProtocolComposition)
-                {
-                    for(const TypePtr& protocol : constraint.reference->getProtocols())
-                    {
-                        types.push_back(protocol);
-                    }
-                }
-                else
+                encodeType(context, type, false);
+            }
+        }
+        context.out += "_";
+    }
+
+    context.out += "_";
+}
+
+/*!
+ * Return the sorted protocol constraints of a generic parameter, the result is cached per constraint node
+ */
+const std::vector<TypePtr>& NameMangling::getSortedConstraints(const GenericDefinition::NodeDefPtr& node)
+{
+    auto iter = constraints.find(node);
+    if(iter != constraints.end())
+        CompilerStats::increase(CompilerCounter::ManglingCacheHits);
+    else
+    {
+        vector<TypePtr> types;
+        //collect all constraints for generic parameter
+        for(const GenericDefinition::Constraint& constraint : node->constraints)
+        {
+            if(constraint.type != GenericDefinition::AssignableTo)
+                continue;
+            //unpack protocol composition
+            if(constraint.reference->getCategory() == Type::ProtocolComposition)
+            {
+                for(const TypePtr& protocol : constraint.reference->getProtocols())
                 {
-                    types.push_back(constraint.reference);
+                    types.push_back(protocol);
                 }
             }
-            context.genericParameters.push_back(param.name);
-            //then encode them to result stream
-            for(const TypePtr& type : sortTypes(types))
+            else
             {
-                encodeType(context, type, false);
+                types.push_back(constraint.reference);
             }
         }
-        context.out<<L"_";
+        iter = constraints.insert(make_pair(node, sortTypes(types))).first;
     }
+    return iter->second;
+}
+
+/*!
+ * \brief Decode a mangled name into a symbol
+ * \param name
+ * \return nullptr if failed to decode it
+ */
+SymbolPtr NameMangling::decode(const wchar_t* name)
+{
+    string str;
+    for(const wchar_t* p = name; p && *p; p++)
+        appendChar(str, *p);
+    return decode(str);
+}
 
-    context.out<<L"_";
+SymbolPtr NameMangling::decode(const std::string& name)
+{
+    auto iter = symbols.find(name);
+    if(iter != symbols.end())
+        return iter->second;
+    DemangledSymbol demangled;
+    if(!demangler.demangle(name, demangled))
+        return nullptr;
+    //encode the candidates, they'll be added to the reverse index
+    for(SymbolScope* scope : scopes)
+        resolve(scope, demangled);
+    if(SymbolScope* scope = registry->getFileScope())
+        resolve(scope, demangled);
+    resolve(registry->getGlobalScope(), demangled);
+    iter = symbols.find(name);
+    if(iter != symbols.end())
+        return iter->second;
+    return nullptr;
+}
+
+/*!
+ * \brief Add all symbols of given scope to the reverse index, the scope will also be searched by decode.
+ */
+void NameMangling::indexScope(SymbolScope* scope)
+{
+    if(find(scopes.begin(), scopes.end(), scope) != scopes.end())
+        return;
+    scopes.push_back(scope);
+    vector<pair<SymbolPtr, string> > results;
+    encodeAll(scope, results);
+}
+
+/*!
+ * Collect the candidates of a demangled symbol from given scope, and encode them to fill the reverse index
+ */
+void NameMangling::resolve(SymbolScope* scope, const DemangledSymbol& demangled)
+{
+    wstring name = demangled.name;
+    switch(demangled.accessor)
+    {
+        case 'g': name += L".getter"; break;
+        case 's': name += L".setter"; break;
+        case 'w': name += L".willSet"; break;
+        case 'W': name += L".didSet"; break;
+        default: break;
+    }
+    vector<SymbolPtr> candidates;
+    if(demangled.context.empty())
+    {
+        collectSymbols(scope->lookup(name), candidates);
+        if(demangled.accessor)
+            collectSymbols(scope->lookup(demangled.name), candidates);
+    }
+    else
+    {
+        TypePtr type;
+        for(const wstring& typeName : demangled.context)
+        {
+            if(!type)
+                type = demangled.extension ? scope->getExtension(typeName) : dynamic_pointer_cast<Type>(scope->lookup(typeName));
+            else
+                type = dynamic_pointer_cast<Type>(type->getDeclaredMember(typeName));
+            if(!type)
+                return;
+        }
+        collectSymbols(type->getDeclaredMember(name), candidates);
+        collectSymbols(type->getDeclaredStaticMember(name), candidates);
+        if(demangled.accessor)
+        {
+            collectSymbols(type->getDeclaredMember(demangled.name), candidates);
+            collectSymbols(type->getDeclaredStaticMember(demangled.name), candidates);
+        }
+    }
+    for(const SymbolPtr& candidate : candidates)
+    {
+        //property accessors are also reachable from the computed property
+        if(ComputedPropertySymbolPtr prop = dynamic_pointer_cast<ComputedPropertySymbol>(candidate))
+        {
+            const FunctionSymbolPtr accessors[] = {prop->getGetter(), prop->getSetter(), prop->getWillSet(), prop->getDidSet()};
+            for(const FunctionSymbolPtr& accessor : accessors)
+            {
+                if(accessor)
+                    encode(accessor, buffer);
+            }
+        }
+        else
+            encode(candidate, buffer);
+    }
 }
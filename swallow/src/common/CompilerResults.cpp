@@ -29,12 +29,81 @@
  */
 #include "common/CompilerResults.h"
 #include "common/Errors.h"
+#include <cassert>
+#include <algorithm>
 USE_SWALLOW_NS
 
 
+unsigned int ResultStringPool::intern(const std::wstring& str)
+{
+    auto iter = indices.find(str);
+    if(iter != indices.end())
+        return iter->second;
+    unsigned int handle = (unsigned int)strings.size();
+    strings.push_back(str);
+    indices.insert(std::make_pair(str, handle));
+    return handle;
+}
+
+std::vector<std::wstring> ResultArguments::toVector() const
+{
+    std::vector<std::wstring> ret;
+    for(size_t i = 0; i < count; i++)
+        ret.push_back(pool->get(handles[i]));
+    return ret;
+}
+
+size_t CompilerResult::render(wchar_t* buffer, size_t size) const
+{
+    const std::wstring* args[ResultArguments::MAX_ARGUMENTS];
+    for(size_t i = 0; i < items.size(); i++)
+        args[i] = &items[i];
+    return Errors::render(code, args, items.size(), buffer, size);
+}
+
+std::wstring CompilerResult::format() const
+{
+    wchar_t buffer[256];
+    size_t len = render(buffer, sizeof(buffer) / sizeof(buffer[0]));
+    if(len < sizeof(buffer) / sizeof(buffer[0]))
+        return std::wstring(buffer, len);
+    std::wstring ret(len + 1, 0);
+    render(&ret[0], ret.size());
+    ret.resize(len);
+    return ret;
+}
+
+bool CompilerResults::ResultKey::operator<(const ResultKey& rhs) const
+{
+    if(code != rhs.code)
+        return code < rhs.code;
+    if(offset != rhs.offset)
+        return offset < rhs.offset;
+    if(level != rhs.level)
+        return level < rhs.level;
+    if(count != rhs.count)
+        return count < rhs.count;
+    for(unsigned int i = 0; i < count; i++)
+    {
+        if(handles[i] != rhs.handles[i])
+            return handles[i] < rhs.handles[i];
+    }
+    return false;
+}
+
+const int CompilerResults::DefaultLimit;
+
+CompilerResults::CompilerResults()
+:strings(new ResultStringPool()), limit(0), discarded(0)
+{
+}
+
 void CompilerResults::clear()
 {
     results.clear();
+    keys.clear();
+    strings = std::make_shared<ResultStringPool>();
+    discarded = 0;
 }
 int CompilerResults::numResults() const
 {
@@ -44,13 +113,72 @@ const CompilerResult& CompilerResults::getResult(int i) const
 {
     return results[i];
 }
+void CompilerResults::setLimit(int limit)
+{
+    this->limit = limit;
+}
+void CompilerResults::setSourceIndex(const SourceIndex& index)
+{
+    sourceIndex = index;
+}
+void CompilerResults::getPosition(const SourceInfo& sourceInfo, int& line, int& column) const
+{
+    sourceIndex.getPosition(sourceInfo.offset, line, column);
+}
+int CompilerResults::getLine(const SourceInfo& sourceInfo) const
+{
+    return sourceIndex.getLine(sourceInfo.offset);
+}
+bool CompilerResults::isFull() const
+{
+    return limit > 0 && (int)results.size() >= limit;
+}
+bool CompilerResults::addResult(ErrorLevel::T level, const SourceInfo& sourceInfo, int code, const ResultArguments& args)
+{
+    ResultKey key;
+    key.level = level;
+    key.code = code;
+    key.offset = sourceInfo.offset;
+    key.count = args.count;
+    std::copy(args.handles, args.handles + args.count, key.handles);
+    if(!keys.insert(key).second)
+    {
+        discarded++;
+        return false;
+    }
+    int line, column;
+    getPosition(sourceInfo, line, column);
+    results.push_back(CompilerResult(level, sourceInfo, line, column, code, args));
+    return true;
+}
 void CompilerResults::add(ErrorLevel::T level, const SourceInfo& sourceInfo, int code, const ResultItems& items)
 {
-    results.push_back(CompilerResult(level, sourceInfo, code, items));
+    //nobody is going to read it, skip before building anything
+    if(isFull())
+    {
+        discarded++;
+        return;
+    }
+    assert(items.size() <= ResultArguments::MAX_ARGUMENTS);
+    ResultArguments args;
+    args.pool = strings;
+    for(const std::wstring& item : items)
+    {
+        if(args.count == ResultArguments::MAX_ARGUMENTS)
+            break;
+        args.handles[args.count++] = strings->intern(item);
+    }
+    addResult(level, sourceInfo, code, args);
 }
 void CompilerResults::add(ErrorLevel::T level, const SourceInfo& sourceInfo, int code, const std::wstring& item)
 {
-    ResultItems items;
-    items.push_back(item);
-    add(level, sourceInfo, code, items);
+    if(isFull())
+    {
+        discarded++;
+        return;
+    }
+    ResultArguments args;
+    args.pool = strings;
+    args.handles[args.count++] = strings->intern(item);
+    addResult(level, sourceInfo, code, args);
 }
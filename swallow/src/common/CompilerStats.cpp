@@ -0,0 +1,114 @@
+/* CompilerStats.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common/CompilerStats.h"
+#include <chrono>
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+thread_local CompilerStats* CompilerStats::active = nullptr;
+
+static uint64_t now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CompilerStats::CompilerStats()
+{
+    reset();
+}
+
+void CompilerStats::reset()
+{
+    memset(times, 0, sizeof(times));
+    memset(counters, 0, sizeof(counters));
+    phase = CompilerPhase::None;
+    phaseStart = 0;
+}
+
+void CompilerStats::merge(const CompilerStats& stats)
+{
+    for(int i = 0; i < CompilerPhase::Count; i++)
+        times[i] += stats.times[i];
+    for(int i = 0; i < CompilerCounter::Count; i++)
+        counters[i] += stats.counters[i];
+}
+
+uint64_t CompilerStats::getTotalTime() const
+{
+    uint64_t ret = 0;
+    for(int i = 0; i < CompilerPhase::Count; i++)
+        ret += times[i];
+    return ret;
+}
+
+const char* CompilerStats::getPhaseName(CompilerPhase::T phase)
+{
+    static const char* names[] = {"tokenize", "parse", "operator_resolution", "declaration_analysis", "body_analysis", "specialization", "mangling"};
+    static_assert(sizeof(names) / sizeof(names[0]) == CompilerPhase::Count, "Missing phase names");
+    return phase < CompilerPhase::Count ? names[phase] : "none";
+}
+
+const char* CompilerStats::getCounterName(CompilerCounter::T counter)
+{
+    static const char* names[] = {"tokens", "nodes", "scope_lookups", "overload_candidates", "specializations", "specialization_cache_hits", "mangling_cache_hits"};
+    static_assert(sizeof(names) / sizeof(names[0]) == CompilerCounter::Count, "Missing counter names");
+    return names[counter];
+}
+
+/*!
+ * Pauses current phase and starts the given one, returns the paused phase
+ */
+CompilerPhase::T CompilerStats::enter(CompilerPhase::T phase)
+{
+    CompilerPhase::T previous = this->phase;
+    if(phase == previous)
+        return previous;
+    uint64_t t = now();
+    if(previous != CompilerPhase::None)
+        times[previous] += t - phaseStart;
+    this->phase = phase;
+    phaseStart = t;
+    return previous;
+}
+
+/*!
+ * Stops current phase and resumes the previous one
+ */
+void CompilerStats::leave(CompilerPhase::T previous)
+{
+    if(previous == phase)
+        return;
+    uint64_t t = now();
+    times[phase] += t - phaseStart;
+    phase = previous;
+    phaseStart = t;
+}
@@ -0,0 +1,239 @@
+/* CompilerTrace.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common/CompilerTrace.h"
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <iomanip>
+#include <unistd.h>
+
+USE_SWALLOW_NS
+using namespace std;
+
+thread_local TraceBuffer* CompilerTrace::active = nullptr;
+
+SWALLOW_NS_BEGIN
+
+struct TraceEntry
+{
+    uint64_t timestamp;
+    uint32_t name;
+    int32_t line;
+    uint8_t category;
+    bool begin;
+};
+
+/*!
+ * Events recorded by a single thread, only the owner thread writes to it.
+ */
+struct TraceBuffer
+{
+    thread::id threadId;
+    int tid;
+    /*!
+     * Ring buffer of events, count is the number of all events ever recorded
+     */
+    vector<TraceEntry> events;
+    uint64_t count;
+    /*!
+     * Names are interned so an event only keeps an index
+     */
+    unordered_map<wstring, uint32_t> nameIndices;
+    vector<wstring> names;
+};
+
+SWALLOW_NS_END
+
+static uint64_t now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CompilerTrace::CompilerTrace(size_t capacity)
+:capacity(capacity > 0 ? capacity : 1), origin(now())
+{
+}
+
+CompilerTrace::~CompilerTrace()
+{
+    for(TraceBuffer* buffer : buffers)
+        delete buffer;
+}
+
+size_t CompilerTrace::getNumEvents() const
+{
+    size_t ret = 0;
+    for(TraceBuffer* buffer : buffers)
+        ret += (size_t)min<uint64_t>(buffer->count, capacity);
+    return ret;
+}
+
+uint64_t CompilerTrace::getDroppedEvents() const
+{
+    uint64_t ret = 0;
+    for(TraceBuffer* buffer : buffers)
+    {
+        if(buffer->count > capacity)
+            ret += buffer->count - capacity;
+    }
+    return ret;
+}
+
+const char* CompilerTrace::getCategoryName(TraceCategory::T category)
+{
+    static const char* names[] = {"file", "declaration", "function_body", "specialization", "overload_resolution"};
+    static_assert(sizeof(names) / sizeof(names[0]) == TraceCategory::Count, "Missing category names");
+    return names[category];
+}
+
+TraceBuffer* CompilerTrace::getBuffer()
+{
+    thread::id id = this_thread::get_id();
+    lock_guard<std::mutex> lock(mutex);
+    for(TraceBuffer* buffer : buffers)
+    {
+        if(buffer->threadId == id)
+            return buffer;
+    }
+    TraceBuffer* buffer = new TraceBuffer();
+    buffer->threadId = id;
+    buffer->tid = (int)buffers.size();
+    buffer->events.resize(capacity);
+    buffer->count = 0;
+    buffers.push_back(buffer);
+    return buffer;
+}
+
+void CompilerTrace::begin(TraceBuffer* buffer, TraceCategory::T category, const std::wstring& name, int line)
+{
+    auto iter = buffer->nameIndices.find(name);
+    uint32_t index;
+    if(iter != buffer->nameIndices.end())
+    {
+        index = iter->second;
+    }
+    else
+    {
+        index = (uint32_t)buffer->names.size();
+        buffer->names.push_back(name);
+        buffer->nameIndices.insert(make_pair(name, index));
+    }
+    TraceEntry& e = buffer->events[buffer->count++ % buffer->events.size()];
+    e.timestamp = now();
+    e.name = index;
+    e.line = line;
+    e.category = (uint8_t)category;
+    e.begin = true;
+}
+
+void CompilerTrace::end(TraceBuffer* buffer)
+{
+    TraceEntry& e = buffer->events[buffer->count++ % buffer->events.size()];
+    e.timestamp = now();
+    e.begin = false;
+}
+
+/*!
+ * Encodes the string as UTF-8 and escapes it for a JSON string literal
+ */
+static void writeJSONString(ostream& out, const wstring& str)
+{
+    out << '"';
+    for(wchar_t ch : str)
+    {
+        unsigned int c = (unsigned int)ch;
+        if(c == '"' || c == '\\')
+            out << '\\' << (char)c;
+        else if(c < 0x20)
+            out << "\\u" << hex << setw(4) << setfill('0') << c << dec << setfill(' ');
+        else if(c < 0x80)
+            out << (char)c;
+        else if(c < 0x800)
+            out << (char)(0xc0 | (c >> 6)) << (char)(0x80 | (c & 0x3f));
+        else if(c < 0x10000)
+            out << (char)(0xe0 | (c >> 12)) << (char)(0x80 | ((c >> 6) & 0x3f)) << (char)(0x80 | (c & 0x3f));
+        else
+            out << (char)(0xf0 | (c >> 18)) << (char)(0x80 | ((c >> 12) & 0x3f)) << (char)(0x80 | ((c >> 6) & 0x3f)) << (char)(0x80 | (c & 0x3f));
+    }
+    out << '"';
+}
+
+/*!
+ * Writes nanoseconds since origin as microseconds
+ */
+static void writeTimestamp(ostream& out, uint64_t timestamp, uint64_t origin)
+{
+    uint64_t t = timestamp > origin ? timestamp - origin : 0;
+    out << (t / 1000) << '.' << setw(3) << setfill('0') << (t % 1000) << setfill(' ');
+}
+
+void CompilerTrace::writeChromeTrace(std::ostream& out) const
+{
+    int pid = (int)getpid();
+    bool first = true;
+    out << "{\"traceEvents\":[";
+    for(TraceBuffer* buffer : buffers)
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"compiler " << buffer->tid << "\"}}";
+        size_t size = buffer->events.size();
+        uint64_t start = buffer->count > size ? buffer->count - size : 0;
+        int depth = 0;
+        for(uint64_t i = start; i < buffer->count; i++)
+        {
+            const TraceEntry& e = buffer->events[i % size];
+            if(e.begin)
+            {
+                depth++;
+                out << ",\n{\"name\":";
+                writeJSONString(out, buffer->names[e.name]);
+                out << ",\"cat\":\"" << getCategoryName((TraceCategory::T)e.category) << "\",\"ph\":\"B\",\"ts\":";
+                writeTimestamp(out, e.timestamp, origin);
+                out << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid;
+                if(e.line > 0)
+                    out << ",\"args\":{\"line\":" << e.line << "}";
+                out << "}";
+            }
+            else
+            {
+                //the begin event was overwritten
+                if(depth == 0)
+                    continue;
+                depth--;
+                out << ",\n{\"ph\":\"E\",\"ts\":";
+                writeTimestamp(out, e.timestamp, origin);
+                out << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << "}";
+            }
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
@@ -0,0 +1,119 @@
+/* SourceIndex.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common/SourceIndex.h"
+#include <cwchar>
+#include <algorithm>
+
+USE_SWALLOW_NS
+
+
+SourceIndex::SourceIndex()
+:data(nullptr), size(0)
+{
+    lineStarts.push_back(0);
+}
+
+SourceIndex::SourceIndex(const wchar_t* data, size_t size)
+{
+    reset(data, size);
+}
+
+SourceIndex::SourceIndex(const std::wstring& src)
+{
+    reset(src.c_str(), src.size());
+}
+
+void SourceIndex::reset(const wchar_t* data, size_t size)
+{
+    this->data = data;
+    this->size = (uint32_t)size;
+    lineStarts.clear();
+    lineStarts.push_back(0);
+    if(!data)
+        return;
+    //wmemchr is vectorized by the C library, much faster than checking character one by one
+    const wchar_t* p = data;
+    const wchar_t* end = data + size;
+    while(p < end)
+    {
+        const wchar_t* nl = wmemchr(p, L'\n', end - p);
+        if(!nl)
+            break;
+        p = nl + 1;
+        lineStarts.push_back((uint32_t)(p - data));
+    }
+}
+
+int SourceIndex::numLines() const
+{
+    return (int)lineStarts.size();
+}
+
+int SourceIndex::getLine(uint32_t offset) const
+{
+    //the last line start that not greater than offset
+    auto iter = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    return (int)(iter - lineStarts.begin());
+}
+
+void SourceIndex::getPosition(uint32_t offset, int& line, int& column) const
+{
+    line = getLine(offset);
+    column = (int)(offset - lineStarts[line - 1]) + 1;
+}
+
+uint32_t SourceIndex::getOffset(int line, int column) const
+{
+    if(line < 1 || line > (int)lineStarts.size() || column < 1)
+        return size;
+    return std::min(size, lineStarts[line - 1] + column - 1);
+}
+
+std::wstring SourceIndex::getLineContent(int line) const
+{
+    const wchar_t* begin;
+    size_t length;
+    if(!getLineContent(line, begin, length))
+        return std::wstring();
+    return std::wstring(begin, length);
+}
+
+bool SourceIndex::getLineContent(int line, const wchar_t*& begin, size_t& length) const
+{
+    if(!data || line < 1 || line > (int)lineStarts.size())
+        return false;
+    uint32_t start = lineStarts[line - 1];
+    uint32_t end = line < (int)lineStarts.size() ? lineStarts[line] - 1 : size;
+    if(end > start && data[end - 1] == L'\r')
+        end--;
+    begin = data + start;
+    length = end - start;
+    return true;
+}
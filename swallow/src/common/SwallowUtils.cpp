@@ -34,6 +34,7 @@
 #include <iostream>
 #include "common/CompilerResults.h"
 #include "common/Errors.h"
+#include "common/SourceIndex.h"
 //#include <codecvt>
 
 USE_SWALLOW_NS
@@ -89,14 +90,7 @@ void SwallowUtils::dumpCompilerResults(const std::wstring& src, const CompilerRe
     if(!compilerResults.numResults())
         return;
 
-    //separate source code by lines
-    vector<wstring> lines;
-    wstringstream stream(src);
-    wstring line;
-    while(getline(stream, line))
-    {
-        lines.push_back(line);
-    }
+    SourceIndex index(src);
 
     for(int i = 0; i < compilerResults.numResults(); i++)
     {
@@ -120,14 +114,17 @@ void SwallowUtils::dumpCompilerResults(const std::wstring& src, const CompilerRe
         }
         out << L" " << res.code << L" :";
         out << L"(" << res.line << L", " << res.column << ") ";
-        std::wstring msg = Errors::format(res.code, res.items);
+        wchar_t msg[1024];
+        res.render(msg, sizeof(msg) / sizeof(msg[0]));
         out << msg << std::endl;
 
 
-        if(res.line > 0 && res.line <= (int)lines.size())
+        const wchar_t* line;
+        size_t length;
+        if(index.getLineContent(res.line, line, length))
         {
-            wstring line = lines[res.line - 1];
-            out<<line<<endl;
+            out.write(line, length);
+            out<<endl;
             for(int i = 0; i < res.column - 1; i++)
             {
                 out<<L' ';
@@ -0,0 +1,1706 @@
+/* BytecodeCompiler.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/BytecodeCompiler.h"
+#include "interpreter/VirtualMachine.h"
+#include "interpreter/Evaluator.h"
+#include "interpreter/InterpreterUtils.h"
+#include "ast/ast.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include <cassert>
+#include <algorithm>
+
+USE_SWALLOW_NS
+using namespace std;
+
+static const int NoTarget = -1;
+/*!
+ * Registers, constants and jump targets are addressed by 16 bits operands
+ */
+static const size_t MaxOperand = 0xffff;
+
+BytecodeCompiler::BytecodeCompiler(VirtualMachine* vm, CompilerResults* compilerResults)
+:vm(vm), compilerResults(compilerResults), state(nullptr), target(NoTarget)
+{
+    global = vm->global;
+}
+
+void BytecodeCompiler::unsupported(const NodePtr& node, const std::wstring& what)
+{
+    compilerResults->add(ErrorLevel::Error, *node->getSourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, what);
+    throw Abort();
+}
+
+void BytecodeCompiler::compileProgram(const ScopedProgramPtr& program, std::vector<std::unique_ptr<BCFunction>>& statements)
+{
+    for(const StatementPtr& st : *program)
+        declareStatement(st);
+    for(const StatementPtr& st : *program)
+    {
+        BCFunction* function = new BCFunction();
+        statements.push_back(unique_ptr<BCFunction>(function));
+        function->name = L"main";
+        FunctionState context = {function, nullptr, 0};
+        context.scopes.push_back(program->getScope());
+        state = &context;
+        sourceInfo = *st->getSourceInfo();
+        if(ExpressionPtr expr = dynamic_pointer_cast<Expression>(st))
+        {
+            //value of the expression statement is returned in the first register
+            allocate();
+            compileExpression(expr, 0);
+            emit(BCOpcode::Return, 0);
+        }
+        else
+        {
+            compileStatement(st);
+            emit(BCOpcode::ReturnVoid);
+        }
+        state = nullptr;
+    }
+    while(!pending.empty())
+    {
+        BCFunction* function = pending.back();
+        pending.pop_back();
+        compileFunction(function);
+    }
+}
+
+/*********************************************************************
+ * Declarations
+ *********************************************************************/
+
+BCFunction* BytecodeCompiler::declareFunction(const FunctionSymbolPtr& symbol, RuntimeType* owner, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body)
+{
+    if(BCFunction* ret = vm->getFunction(symbol))
+        return ret;
+    for(const ParameterNodePtr& param : parameters)
+    {
+        if(param->isInout())
+            unsupported(param, L"inout parameter");
+    }
+    BCFunction* ret = vm->addFunction(symbol->getName());
+    ret->symbol = symbol;
+    ret->owner = owner;
+    ret->parameters = parameters;
+    ret->body = body;
+    ret->isInit = owner && InterpreterUtils::isInitializer(symbol);
+    ret->hasSelf = owner && !InterpreterUtils::hasFlag(symbol, SymbolFlagStatic);
+    ret->selfByAddress = ret->hasSelf && !ret->isInit && owner->type->getCategory() != Type::Class && InterpreterUtils::hasFlag(symbol, SymbolFlagMutating);
+    ret->numParameters = (int)parameters.size() + (ret->hasSelf ? 1 : 0);
+    vm->functionsBySymbol.insert(make_pair(symbol.get(), ret));
+    pending.push_back(ret);
+    return ret;
+}
+
+void BytecodeCompiler::declareStatement(const StatementPtr& statement)
+{
+    switch(statement->getNodeType())
+    {
+        case NodeType::Function:
+        {
+            FunctionDefPtr func = static_pointer_cast<FunctionDef>(statement);
+            if(func->numParameters() > 1)
+                unsupported(func, L"curried function");
+            declareFunction(static_pointer_cast<SymboledFunction>(func)->symbol, nullptr, InterpreterUtils::getParameters(func), func->getBody());
+            break;
+        }
+        case NodeType::ComputedProperty:
+        {
+            ComputedPropertyPtr property = static_pointer_cast<ComputedProperty>(statement);
+            if(property->getWillSet() || property->getDidSet())
+                unsupported(property, L"property observer");
+            shared_ptr<ComposedComputedProperty> p = static_pointer_cast<ComposedComputedProperty>(property);
+            for(const SymboledFunctionPtr& func : {p->functions.getter, p->functions.setter})
+            {
+                if(func)
+                    declareFunction(func->symbol, nullptr, InterpreterUtils::getParameters(func), func->getBody());
+            }
+            break;
+        }
+        case NodeType::Class:
+        case NodeType::Struct:
+        case NodeType::Enum:
+        case NodeType::Extension:
+            declareType(static_pointer_cast<TypeDeclaration>(statement));
+            break;
+        default:
+            break;
+    }
+}
+
+void BytecodeCompiler::declareType(const TypeDeclarationPtr& node)
+{
+    TypePtr type = node->getType();
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    RuntimeType* rt = vm->getRuntimeType(type);
+    for(const DeclarationPtr& decl : *node)
+    {
+        switch(decl->getNodeType())
+        {
+            case NodeType::Function:
+            {
+                FunctionDefPtr func = static_pointer_cast<FunctionDef>(decl);
+                FunctionSymbolPtr symbol = static_pointer_cast<SymboledFunction>(func)->symbol;
+                if(func->numParameters() > 1)
+                    unsupported(func, L"curried function");
+                declareFunction(symbol, vm->getRuntimeType(InterpreterUtils::getOwnerType(symbol)), InterpreterUtils::getParameters(func), func->getBody());
+                break;
+            }
+            case NodeType::Init:
+            {
+                InitializerDefPtr init = static_pointer_cast<InitializerDef>(decl);
+                FunctionSymbolPtr symbol = static_pointer_cast<SymboledInit>(init)->symbol;
+                if(init->isFailable() || init->isImplicitFailable())
+                    unsupported(init, L"failable initializer");
+                vector<ParameterNodePtr> params(init->getParameters()->begin(), init->getParameters()->end());
+                declareFunction(symbol, vm->getRuntimeType(InterpreterUtils::getOwnerType(symbol)), params, init->getBody());
+                break;
+            }
+            case NodeType::ComputedProperty:
+            {
+                ComputedPropertyPtr property = static_pointer_cast<ComputedProperty>(decl);
+                if(property->getWillSet() || property->getDidSet())
+                    unsupported(property, L"property observer");
+                shared_ptr<ComposedComputedProperty> p = static_pointer_cast<ComposedComputedProperty>(property);
+                for(const SymboledFunctionPtr& func : {p->functions.getter, p->functions.setter})
+                {
+                    if(func)
+                        declareFunction(func->symbol, vm->getRuntimeType(InterpreterUtils::getOwnerType(func->symbol)), InterpreterUtils::getParameters(func), func->getBody());
+                }
+                break;
+            }
+            case NodeType::Deinit:
+                unsupported(decl, L"deinitializer");
+                break;
+            case NodeType::ValueBindings:
+            {
+                ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(decl);
+                for(const ValueBindingPtr& binding : *bindings)
+                {
+                    IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+                    if(!id)
+                        unsupported(binding, L"tuple pattern");
+                    if(!binding->getInitializer() || !InterpreterUtils::isStoredProperty(type->getDeclaredMember(id->getIdentifier())))
+                        continue;
+                    if(!vm->fieldInitializers.count(rt))
+                    {
+                        BCFunction* init = vm->addFunction(type->getName() + L".fields");
+                        init->owner = rt;
+                        init->hasSelf = true;
+                        init->numParameters = 1;
+                        vm->fieldInitializers.insert(make_pair(rt, init));
+                        pending.push_back(init);
+                    }
+                }
+                break;
+            }
+            case NodeType::Class:
+            case NodeType::Struct:
+            case NodeType::Enum:
+                declareType(static_pointer_cast<TypeDeclaration>(decl));
+                break;
+            case NodeType::Subscript:
+                unsupported(decl, L"subscript");
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void BytecodeCompiler::compileType(const TypeDeclarationPtr& node)
+{
+    //static stored properties are initialized when the declaration is executed
+    TypePtr type = node->getType();
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    for(const DeclarationPtr& decl : *node)
+    {
+        if(decl->getNodeType() == NodeType::Class || decl->getNodeType() == NodeType::Struct || decl->getNodeType() == NodeType::Enum)
+        {
+            compileType(static_pointer_cast<TypeDeclaration>(decl));
+            continue;
+        }
+        if(decl->getNodeType() != NodeType::ValueBindings)
+            continue;
+        ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(decl);
+        for(const ValueBindingPtr& binding : *bindings)
+        {
+            IdentifierPtr id = static_pointer_cast<Identifier>(binding->getName());
+            SymbolPtr sym = type->getDeclaredMember(id->getIdentifier());
+            if(!binding->getInitializer() || !InterpreterUtils::isGlobalVariable(sym))
+                continue;
+            int top = state->top;
+            int value = compileOperand(binding->getInitializer());
+            emit(BCOpcode::StoreGlobal, value, vm->getGlobalIndex(sym));
+            state->top = top;
+        }
+    }
+}
+
+void BytecodeCompiler::compileFunction(BCFunction* function)
+{
+    FunctionState context = {function, function->owner ? function->owner->type : nullptr, function->numParameters};
+    function->numRegisters = std::max(1, function->numParameters);
+    state = &context;
+    auto initializer = function->owner ? vm->fieldInitializers.find(function->owner) : vm->fieldInitializers.end();
+    if(initializer != vm->fieldInitializers.end() && initializer->second == function)
+    {
+        compileFieldInitializer(function->owner, function);
+        state = nullptr;
+        return;
+    }
+    SymbolScope* scope = function->body ? static_pointer_cast<ScopedCodeBlock>(function->body)->getScope() : nullptr;
+    context.scopes.push_back(scope);
+    //self comes first, then the parameters
+    int first = function->hasSelf ? 1 : 0;
+    for(size_t i = 0; i < function->parameters.size(); i++)
+    {
+        SymbolPtr sym = scope ? scope->lookup(function->parameters[i]->getLocalName()) : nullptr;
+        if(sym)
+            context.locals[sym.get()] = first + (int)i;
+    }
+    if(function->hasSelf && !function->selfByAddress && scope)
+    {
+        //self passed by address is accessed by compileSelf
+        for(const wchar_t* name : {L"self", L"super"})
+        {
+            if(SymbolPtr sym = scope->lookup(name))
+                context.locals[sym.get()] = 0;
+        }
+    }
+    if(function->body)
+    {
+        sourceInfo = *function->body->getSourceInfo();
+        compileStatements(function->body);
+    }
+    //initializer always returns the initialized self
+    if(function->isInit)
+        emit(BCOpcode::Return, 0);
+    else
+        emit(BCOpcode::ReturnVoid);
+    state = nullptr;
+}
+
+void BytecodeCompiler::compileFieldInitializer(RuntimeType* type, BCFunction* function)
+{
+    TypeDeclarationPtr decl = type->type->getReference();
+    bool valueType = type->type->getCategory() != Type::Class;
+    sourceInfo = *decl->getSourceInfo();
+    for(const DeclarationPtr& d : *decl)
+    {
+        if(d->getNodeType() != NodeType::ValueBindings)
+            continue;
+        ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(d);
+        for(const ValueBindingPtr& binding : *bindings)
+        {
+            if(!binding->getInitializer())
+                continue;
+            IdentifierPtr id = static_pointer_cast<Identifier>(binding->getName());
+            SymbolPtr field = type->type->getDeclaredMember(id->getIdentifier());
+            if(!InterpreterUtils::isStoredProperty(field))
+                continue;
+            int top = state->top;
+            int value = compileOperand(binding->getInitializer());
+            emit(BCOpcode::SetField, 0, type->getFieldIndex(field), value, valueType);
+            state->top = top;
+        }
+    }
+    emit(BCOpcode::Return, 0);
+}
+
+/*********************************************************************
+ * Code generation
+ *********************************************************************/
+
+size_t BytecodeCompiler::emit(BCOpcode::T opcode, int a, int b, int c, int x)
+{
+    BCFunction* function = state->function;
+    size_t ret = function->code.size();
+    if(ret >= MaxOperand)
+    {
+        compilerResults->add(ErrorLevel::Error, sourceInfo, Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"function of more than 65535 instructions");
+        throw Abort();
+    }
+    BCInstruction instruction = {opcode, (uint8_t)x, (uint16_t)a, (uint16_t)b, (uint16_t)c};
+    function->code.push_back(instruction);
+    function->sourceInfos.push_back(sourceInfo);
+    return ret;
+}
+
+void BytecodeCompiler::emitLoadConstant(int dst, const Value& value)
+{
+    BCFunction* function = state->function;
+    if(value.kind == Value::Int && value.i >= INT32_MIN && value.i <= INT32_MAX)
+    {
+        uint32_t imm = (uint32_t)(int32_t)value.i;
+        emit(BCOpcode::LoadInt, dst, imm >> 16, imm & 0xffff);
+        return;
+    }
+    if(function->constants.size() >= MaxOperand)
+    {
+        compilerResults->add(ErrorLevel::Error, sourceInfo, Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"function of more than 65535 constants");
+        throw Abort();
+    }
+    function->constants.push_back(value);
+    emit(BCOpcode::LoadConst, dst, (int)function->constants.size() - 1);
+}
+
+void BytecodeCompiler::patch(size_t jump)
+{
+    patchTo(jump, state->function->code.size());
+}
+
+void BytecodeCompiler::patchTo(size_t jump, size_t target)
+{
+    state->function->code[jump].c = (uint16_t)target;
+}
+
+void BytecodeCompiler::compileJumps(std::vector<size_t>& jumps, size_t target)
+{
+    for(size_t jump : jumps)
+        patchTo(jump, target);
+}
+
+int BytecodeCompiler::allocate(int count)
+{
+    int ret = state->top;
+    state->top += count;
+    if((size_t)state->top > MaxOperand)
+    {
+        compilerResults->add(ErrorLevel::Error, sourceInfo, Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"function of more than 65535 registers");
+        throw Abort();
+    }
+    state->function->numRegisters = std::max(state->function->numRegisters, state->top);
+    return ret;
+}
+
+int BytecodeCompiler::declareLocal(const SymbolPtr& symbol)
+{
+    int ret = allocate();
+    state->locals[symbol.get()] = ret;
+    return ret;
+}
+
+int BytecodeCompiler::destination()
+{
+    if(target != NoTarget)
+        return target;
+    return allocate();
+}
+
+SymbolPtr BytecodeCompiler::lookupLocal(const std::wstring& name)
+{
+    for(auto iter = state->scopes.rbegin(); iter != state->scopes.rend(); iter++)
+    {
+        if(!*iter)
+            continue;
+        if(SymbolPtr ret = (*iter)->lookup(name))
+            return ret;
+    }
+    return nullptr;
+}
+
+/*********************************************************************
+ * Declarations in statements
+ *********************************************************************/
+
+void BytecodeCompiler::visitValueBindings(const ValueBindingsPtr& node)
+{
+    for(const ValueBindingPtr& binding : *node)
+    {
+        IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+        if(!id)
+            unsupported(binding, L"tuple pattern");
+        SymbolPlaceHolderPtr var = dynamic_pointer_cast<SymbolPlaceHolder>(lookupLocal(id->getIdentifier()));
+        if(!var)
+            unsupported(binding, id->getIdentifier());
+        if(InterpreterUtils::isGlobalVariable(var))
+        {
+            uint16_t index = vm->getGlobalIndex(var);
+            if(!binding->getInitializer())
+                continue;
+            int top = state->top;
+            int value = compileOperand(binding->getInitializer());
+            emit(BCOpcode::StoreGlobal, value, index);
+            state->top = top;
+            continue;
+        }
+        //registers of local variables are kept until the end of the block
+        int local = declareLocal(var);
+        if(binding->getInitializer())
+            compileExpression(binding->getInitializer(), local);
+        state->top = local + 1;
+    }
+}
+
+void BytecodeCompiler::visitComputedProperty(const ComputedPropertyPtr& node)
+{
+    shared_ptr<ComposedComputedProperty> property = static_pointer_cast<ComposedComputedProperty>(node);
+    if(property->functions.getter && !vm->getFunction(property->functions.getter->symbol))
+        unsupported(node, L"local computed property");
+}
+
+void BytecodeCompiler::visitClass(const ClassDefPtr& node)
+{
+    declareType(node);
+    compileType(node);
+}
+
+void BytecodeCompiler::visitStruct(const StructDefPtr& node)
+{
+    declareType(node);
+    compileType(node);
+}
+
+void BytecodeCompiler::visitEnum(const EnumDefPtr& node)
+{
+    declareType(node);
+    compileType(node);
+}
+
+void BytecodeCompiler::visitExtension(const ExtensionDefPtr& node)
+{
+    declareType(node);
+    compileType(node);
+}
+
+void BytecodeCompiler::visitProtocol(const ProtocolDefPtr& node)
+{
+    //protocols have no implementation
+}
+
+void BytecodeCompiler::visitFunction(const FunctionDefPtr& node)
+{
+    //nested functions need closures
+    if(!vm->getFunction(static_pointer_cast<SymboledFunction>(node)->symbol))
+        unsupported(node, L"local function");
+}
+
+void BytecodeCompiler::visitDeinit(const DeinitializerDefPtr& node)
+{
+    unsupported(node, L"deinitializer");
+}
+
+void BytecodeCompiler::visitInit(const InitializerDefPtr& node)
+{
+    //compiled by its type declaration
+}
+
+void BytecodeCompiler::visitSubscript(const SubscriptDefPtr& node)
+{
+    unsupported(node, L"subscript");
+}
+
+void BytecodeCompiler::visitTypeAlias(const TypeAliasPtr& node)
+{
+}
+
+void BytecodeCompiler::visitImport(const ImportPtr& node)
+{
+}
+
+void BytecodeCompiler::visitOperator(const OperatorDefPtr& node)
+{
+}
+
+/*********************************************************************
+ * Statements
+ *********************************************************************/
+
+void BytecodeCompiler::compileStatement(const StatementPtr& statement)
+{
+    int top = state->top;
+    SourceInfo saved = sourceInfo;
+    sourceInfo = *statement->getSourceInfo();
+    if(ExpressionPtr expr = dynamic_pointer_cast<Expression>(statement))
+    {
+        compileExpression(expr, NoTarget);
+    }
+    else
+    {
+        int savedTarget = target;
+        target = NoTarget;
+        statement->accept(this);
+        target = savedTarget;
+    }
+    sourceInfo = saved;
+    //temporary registers are reused by next statement, local variables are kept
+    if(statement->getNodeType() != NodeType::ValueBindings)
+        state->top = top;
+}
+
+void BytecodeCompiler::compileStatements(const CodeBlockPtr& codeBlock)
+{
+    int top = state->top;
+    state->scopes.push_back(static_pointer_cast<ScopedCodeBlock>(codeBlock)->getScope());
+    for(const StatementPtr& st : *codeBlock)
+        compileStatement(st);
+    state->scopes.pop_back();
+    state->top = top;
+}
+
+void BytecodeCompiler::visitCodeBlock(const CodeBlockPtr& node)
+{
+    compileStatements(node);
+}
+
+size_t BytecodeCompiler::compileJumpIfFalse(const ExpressionPtr& condition)
+{
+    ExpressionPtr expr = condition;
+    while(expr->getNodeType() == NodeType::ParenthesizedExpression && static_pointer_cast<ParenthesizedExpression>(expr)->numExpressions() == 1)
+        expr = static_pointer_cast<ParenthesizedExpression>(expr)->get(0);
+    if(expr->getNodeType() == NodeType::Assignment && static_pointer_cast<Assignment>(expr)->getLHS()->getNodeType() == NodeType::ValueBindingPattern)
+        unsupported(expr, L"optional binding");
+    if(expr->getType() != global->Bool())
+        unsupported(expr, L"condition of type " + expr->getType()->toString());
+    int top = state->top;
+    size_t ret;
+    BinaryOperatorPtr binary = dynamic_pointer_cast<BinaryOperator>(expr);
+    FunctionSymbolPtr func = binary ? dynamic_pointer_cast<FunctionSymbol>(binary->getReferencedSymbol()) : nullptr;
+    ExpressionPtr lhs = binary ? dynamic_pointer_cast<Expression>(binary->getLHS()) : nullptr;
+    ExpressionPtr rhs = binary ? dynamic_pointer_cast<Expression>(binary->getRHS()) : nullptr;
+    ExecOperator::T op;
+    IntegerFormat format;
+    if(func && lhs && rhs && isBuiltin(func, {lhs, rhs}) && ExecOperator::fromName(func->getName(), 2, op)
+        && op >= ExecOperator::Less && Evaluator::getIntegerFormat(global, func->getType()->getParameters()[0].type, format)
+        && format.bits == 64 && format.isSigned)
+    {
+        //comparison of Int is fused into the jump
+        int a = compileOperand(lhs);
+        int b = compileOperand(rhs);
+        if(op == ExecOperator::Greater || op == ExecOperator::GreaterEqual)
+            std::swap(a, b);
+        bool less = op == ExecOperator::Less || op == ExecOperator::Greater;
+        sourceInfo = *expr->getSourceInfo();
+        ret = emit(less ? BCOpcode::JumpIfNotLtInt : BCOpcode::JumpIfNotLeInt, a, b);
+    }
+    else
+    {
+        int value = compileOperand(expr);
+        ret = emit(BCOpcode::JumpIfFalse, value);
+    }
+    state->top = top;
+    return ret;
+}
+
+void BytecodeCompiler::visitIf(const IfStatementPtr& node)
+{
+    size_t jump = compileJumpIfFalse(node->getCondition());
+    compileStatements(node->getThen());
+    if(!node->getElse())
+    {
+        patch(jump);
+        return;
+    }
+    size_t end = emit(BCOpcode::Jump);
+    patch(jump);
+    compileStatement(node->getElse());
+    patch(end);
+}
+
+void BytecodeCompiler::visitWhileLoop(const WhileLoopPtr& node)
+{
+    size_t start = state->function->code.size();
+    size_t exit = compileJumpIfFalse(node->getCondition());
+    Loop loop = {false};
+    state->loops.push_back(loop);
+    compileStatements(node->getCodeBlock());
+    emit(BCOpcode::Jump, 0, 0, (int)start);
+    patch(exit);
+    compileJumps(state->loops.back().breaks, state->function->code.size());
+    compileJumps(state->loops.back().continues, start);
+    state->loops.pop_back();
+}
+
+void BytecodeCompiler::visitDoLoop(const DoLoopPtr& node)
+{
+    size_t start = state->function->code.size();
+    Loop loop = {false};
+    state->loops.push_back(loop);
+    compileStatements(node->getCodeBlock());
+    size_t condition = state->function->code.size();
+    size_t exit = compileJumpIfFalse(node->getCondition());
+    emit(BCOpcode::Jump, 0, 0, (int)start);
+    patch(exit);
+    compileJumps(state->loops.back().breaks, state->function->code.size());
+    compileJumps(state->loops.back().continues, condition);
+    state->loops.pop_back();
+}
+
+void BytecodeCompiler::visitForLoop(const ForLoopPtr& node)
+{
+    //the initializer is declared in the scope of loop's body
+    int top = state->top;
+    state->scopes.push_back(static_pointer_cast<ScopedCodeBlock>(node->getCodeBlock())->getScope());
+    if(node->getInitializer())
+        compileStatement(node->getInitializer());
+    for(int i = 0; i < node->numInit(); i++)
+        compileStatement(node->getInit(i));
+    size_t start = state->function->code.size();
+    size_t exit = 0;
+    if(node->getCondition())
+        exit = compileJumpIfFalse(node->getCondition());
+    Loop loop = {false};
+    state->loops.push_back(loop);
+    compileStatements(node->getCodeBlock());
+    size_t step = state->function->code.size();
+    if(node->getStep())
+        compileStatement(node->getStep());
+    emit(BCOpcode::Jump, 0, 0, (int)start);
+    if(node->getCondition())
+        patch(exit);
+    compileJumps(state->loops.back().breaks, state->function->code.size());
+    compileJumps(state->loops.back().continues, step);
+    state->loops.pop_back();
+    state->scopes.pop_back();
+    state->top = top;
+}
+
+void BytecodeCompiler::visitForIn(const ForInLoopPtr& node)
+{
+    unsupported(node, L"for-in");
+}
+
+void BytecodeCompiler::visitLabeledStatement(const LabeledStatementPtr& node)
+{
+    unsupported(node, L"labeled statement");
+}
+
+void BytecodeCompiler::visitFallthrough(const FallthroughStatementPtr& node)
+{
+    unsupported(node, L"fallthrough");
+}
+
+void BytecodeCompiler::visitBreak(const BreakStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled break");
+    assert(!state->loops.empty());
+    state->loops.back().breaks.push_back(emit(BCOpcode::Jump));
+}
+
+void BytecodeCompiler::visitContinue(const ContinueStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled continue");
+    for(auto iter = state->loops.rbegin(); iter != state->loops.rend(); iter++)
+    {
+        if(iter->isSwitch)
+            continue;
+        iter->continues.push_back(emit(BCOpcode::Jump));
+        return;
+    }
+    assert(0 && "continue outside of loop");
+}
+
+void BytecodeCompiler::visitReturn(const ReturnStatementPtr& node)
+{
+    if(node->getExpression())
+        emit(BCOpcode::Return, compileOperand(node->getExpression()));
+    else if(state->function->isInit)
+        emit(BCOpcode::Return, 0);
+    else
+        emit(BCOpcode::ReturnVoid);
+}
+
+void BytecodeCompiler::visitSwitchCase(const SwitchCasePtr& node)
+{
+    ExpressionPtr control = node->getControlExpression();
+    TypePtr type = control->getType();
+    bool isEnum = type->getCategory() == Type::Enum;
+    IntegerFormat format;
+    bool isInteger = Evaluator::getIntegerFormat(global, type, format) || type == global->Bool();
+    if(!isEnum && !isInteger && !Evaluator::isFloating(global, type) && type != global->String())
+        unsupported(control, L"switch on " + type->toString());
+    bool fastInteger = isEnum || (isInteger && format.bits == 64 && format.isSigned);
+    int value = allocate();
+    compileExpression(control, value);
+    if(isEnum)
+        emit(BCOpcode::EnumIndex, value, value);
+    int test = allocate();
+    //each pattern jumps to the body of its case when matched
+    vector<vector<size_t> > matches;
+    for(const CaseStatementPtr& c : *node)
+    {
+        matches.push_back(vector<size_t>());
+        for(const CaseStatement::Condition& cond : c->getConditions())
+        {
+            if(cond.guard)
+                unsupported(cond.guard, L"guard of case");
+            int pattern;
+            if(isEnum)
+            {
+                wstring name;
+                TuplePtr binding;
+                if(!InterpreterUtils::getEnumCasePattern(cond.condition, name, binding) || !type->getEnumCase(name))
+                    unsupported(cond.condition, L"case pattern");
+                if(binding)
+                    unsupported(cond.condition, L"associated value");
+                pattern = allocate();
+                emitLoadConstant(pattern, Value::makeInt(InterpreterUtils::getEnumCaseIndex(type, name)));
+            }
+            else
+            {
+                ExpressionPtr expr = dynamic_pointer_cast<Expression>(cond.condition);
+                if(!expr)
+                    unsupported(cond.condition, L"case pattern");
+                pattern = compileOperand(expr);
+            }
+            if(fastInteger)
+                emit(BCOpcode::EqInt, test, value, pattern);
+            else if(isInteger)
+                emit(BCOpcode::IntCompare, test, value, pattern, BCIntegerOperator::encode(ExecOperator::Equal, format.bits, format.isSigned));
+            else if(type == global->String())
+                emit(BCOpcode::StringEqual, test, value, pattern);
+            else
+                emit(BCOpcode::FloatCompare, test, value, pattern, ExecOperator::Equal);
+            matches.back().push_back(emit(BCOpcode::JumpIfTrue, test));
+        }
+    }
+    size_t noMatch = emit(BCOpcode::Jump);
+    Loop loop = {true};
+    state->loops.push_back(loop);
+    vector<size_t> ends;
+    size_t i = 0;
+    for(const CaseStatementPtr& c : *node)
+    {
+        compileJumps(matches[i++], state->function->code.size());
+        compileStatements(c->getCodeBlock());
+        ends.push_back(emit(BCOpcode::Jump));
+    }
+    patch(noMatch);
+    if(node->getDefaultCase())
+        compileStatements(node->getDefaultCase()->getCodeBlock());
+    compileJumps(ends, state->function->code.size());
+    compileJumps(state->loops.back().breaks, state->function->code.size());
+    state->loops.pop_back();
+}
+
+/*********************************************************************
+ * Expressions
+ *********************************************************************/
+
+void BytecodeCompiler::compileExpression(const PatternPtr& expr, int dst)
+{
+    int savedTarget = target;
+    SourceInfo saved = sourceInfo;
+    target = dst;
+    sourceInfo = *expr->getSourceInfo();
+    expr->accept(this);
+    target = savedTarget;
+    sourceInfo = saved;
+}
+
+int BytecodeCompiler::compileOperand(const ExpressionPtr& expr)
+{
+    switch(expr->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            IdentifierPtr id = static_pointer_cast<Identifier>(expr);
+            SymbolPtr sym = InterpreterUtils::resolveIdentifier(id, state->scopes, state->selfType);
+            auto iter = sym ? state->locals.find(sym.get()) : state->locals.end();
+            if(iter != state->locals.end())
+                return iter->second;
+            break;
+        }
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+            if(p->numExpressions() == 1)
+                return compileOperand(p->get(0));
+            break;
+        }
+        default:
+            break;
+    }
+    int ret = allocate();
+    compileExpression(expr, ret);
+    return ret;
+}
+
+int BytecodeCompiler::compileBase(const ExpressionPtr& expr)
+{
+    if(InterpreterUtils::isSelfIdentifier(expr) && state->function->hasSelf)
+        return 0;
+    if(expr->getNodeType() == NodeType::Identifier)
+    {
+        //a global is accessed in place, so a copy doesn't defeat the copy-on-write of its value
+        SymbolPtr sym = InterpreterUtils::resolveIdentifier(static_pointer_cast<Identifier>(expr), state->scopes, state->selfType);
+        if(!state->locals.count(sym.get()) && InterpreterUtils::isGlobalVariable(sym))
+        {
+            int ret = allocate();
+            emit(BCOpcode::GlobalAddress, ret, vm->getGlobalIndex(sym));
+            return ret;
+        }
+    }
+    return compileOperand(expr);
+}
+
+int BytecodeCompiler::compilePlace(const ExpressionPtr& expr, bool& isAddress)
+{
+    isAddress = true;
+    switch(expr->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            IdentifierPtr id = static_pointer_cast<Identifier>(expr);
+            SymbolPtr sym = InterpreterUtils::resolveIdentifier(id, state->scopes, state->selfType);
+            auto iter = sym ? state->locals.find(sym.get()) : state->locals.end();
+            if(iter != state->locals.end())
+            {
+                isAddress = false;
+                return iter->second;
+            }
+            if(InterpreterUtils::isSelfIdentifier(id))
+            {
+                if(!state->function->hasSelf)
+                    unsupported(expr, L"self");
+                isAddress = state->function->selfByAddress;
+                return 0;
+            }
+            if(InterpreterUtils::isGlobalVariable(sym))
+            {
+                int ret = allocate();
+                emit(BCOpcode::GlobalAddress, ret, vm->getGlobalIndex(sym));
+                return ret;
+            }
+            if(InterpreterUtils::isStoredProperty(sym) && state->function->hasSelf)
+            {
+                //implicit member of self
+                int ret = allocate();
+                emit(BCOpcode::FieldAddress, ret, 0, getFieldIndex(state->selfType, sym), state->selfType->getCategory() != Type::Class);
+                return ret;
+            }
+            break;
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(expr);
+            ExpressionPtr base = ma->getSelf();
+            SymbolPtr field = ma->getReferencedSymbol();
+            if(!base || !ma->getField())
+                break;
+            if(InterpreterUtils::isGlobalVariable(field))
+            {
+                int ret = allocate();
+                emit(BCOpcode::GlobalAddress, ret, vm->getGlobalIndex(field));
+                return ret;
+            }
+            if(!InterpreterUtils::isStoredProperty(field))
+                break;
+            TypePtr baseType = base->getType();
+            int owner;
+            bool valueType = baseType->getCategory() != Type::Class;
+            if(valueType)
+            {
+                bool ownerIsAddress;
+                owner = compilePlace(base, ownerIsAddress);
+            }
+            else
+                owner = compileOperand(base);
+            int ret = allocate();
+            emit(BCOpcode::FieldAddress, ret, owner, getFieldIndex(baseType, field), valueType);
+            return ret;
+        }
+        case NodeType::SubscriptAccess:
+        {
+            SubscriptAccessPtr sa = static_pointer_cast<SubscriptAccess>(expr);
+            if(!global->isArray(sa->getSelf()->getType()) || sa->getIndex()->numExpressions() != 1)
+                break;
+            bool arrayIsAddress;
+            int array = compilePlace(sa->getSelf(), arrayIsAddress);
+            int index = compileOperand(sa->getIndex()->get(0));
+            int ret = allocate();
+            sourceInfo = *expr->getSourceInfo();
+            emit(BCOpcode::ElementAddress, ret, array, index);
+            return ret;
+        }
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+            if(p->numExpressions() == 1)
+                return compilePlace(p->get(0), isAddress);
+            break;
+        }
+        default:
+            break;
+    }
+    unsupported(expr, L"mutation of expression");
+    return 0;
+}
+
+int BytecodeCompiler::compileAddress(const ExpressionPtr& expr)
+{
+    bool isAddress;
+    int place = compilePlace(expr, isAddress);
+    if(isAddress)
+        return place;
+    int ret = allocate();
+    emit(BCOpcode::AddressOf, ret, place);
+    return ret;
+}
+
+int BytecodeCompiler::getFieldIndex(const TypePtr& type, const SymbolPtr& field)
+{
+    //inherited fields take the same indices in the layout of subclass
+    int ret = vm->getRuntimeType(type)->getFieldIndex(field);
+    assert(ret >= 0);
+    return ret;
+}
+
+void BytecodeCompiler::compileSelf(const NodePtr& node, int dst)
+{
+    if(!state->function->hasSelf)
+        unsupported(node, L"self");
+    if(state->function->selfByAddress)
+        emit(BCOpcode::Load, dst, 0);
+    else if(dst != 0)
+        emit(BCOpcode::Move, dst, 0);
+}
+
+void BytecodeCompiler::visitIdentifier(const IdentifierPtr& node)
+{
+    const wstring& name = node->getIdentifier();
+    SymbolPtr sym = InterpreterUtils::resolveIdentifier(node, state->scopes, state->selfType);
+    if(InterpreterUtils::isEnumCaseReference(sym, node->getType(), name))
+    {
+        emit(BCOpcode::LoadEnum, destination(), InterpreterUtils::getEnumCaseIndex(node->getType(), name));
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        compileCall(node, property->getGetter(), nullptr, vector<ExpressionPtr>());
+        return;
+    }
+    auto iter = sym ? state->locals.find(sym.get()) : state->locals.end();
+    if(iter != state->locals.end())
+    {
+        //the value of a variable that's not stored is not used
+        if(target != NoTarget && target != iter->second)
+            emit(BCOpcode::Move, target, iter->second);
+        return;
+    }
+    if(InterpreterUtils::isSelfIdentifier(node))
+    {
+        compileSelf(node, destination());
+        return;
+    }
+    if(InterpreterUtils::isGlobalVariable(sym))
+    {
+        emit(BCOpcode::LoadGlobal, destination(), vm->getGlobalIndex(sym));
+        return;
+    }
+    if(InterpreterUtils::isStoredProperty(sym) && state->function->hasSelf)
+    {
+        emit(BCOpcode::GetField, destination(), 0, getFieldIndex(state->selfType, sym));
+        return;
+    }
+    unsupported(node, L"reference to " + name);
+}
+
+void BytecodeCompiler::visitMemberAccess(const MemberAccessPtr& node)
+{
+    ExpressionPtr base = node->getSelf();
+    TypePtr type = node->getType();
+    SymbolPtr sym = node->getReferencedSymbol();
+    if(!node->getField())
+        unsupported(node, L"tuple");
+    const wstring& name = node->getField()->getIdentifier();
+    if(InterpreterUtils::isEnumCaseReference(sym, type, name))
+    {
+        emit(BCOpcode::LoadEnum, destination(), InterpreterUtils::getEnumCaseIndex(type, name));
+        return;
+    }
+    if(base && global->isArray(base->getType()))
+    {
+        compileArrayMethod(node, name, base, vector<ExpressionPtr>());
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        compileCall(node, property->getGetter(), base, vector<ExpressionPtr>());
+        return;
+    }
+    if(InterpreterUtils::isGlobalVariable(sym))
+    {
+        emit(BCOpcode::LoadGlobal, destination(), vm->getGlobalIndex(sym));
+        return;
+    }
+    if(!base || !InterpreterUtils::isStoredProperty(sym))
+        unsupported(node, L"member access of " + name);
+    int owner = compileBase(base);
+    emit(BCOpcode::GetField, destination(), owner, getFieldIndex(base->getType(), sym));
+}
+
+void BytecodeCompiler::visitSubscriptAccess(const SubscriptAccessPtr& node)
+{
+    if(!global->isArray(node->getSelf()->getType()) || node->getIndex()->numExpressions() != 1)
+        unsupported(node, L"subscript");
+    int array = compileBase(node->getSelf());
+    int index = compileOperand(node->getIndex()->get(0));
+    emit(BCOpcode::GetElement, destination(), array, index);
+}
+
+void BytecodeCompiler::visitAssignment(const AssignmentPtr& node)
+{
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!lhs || !rhs)
+        unsupported(node, L"assignment to pattern");
+    SymbolPtr sym;
+    if(lhs->getNodeType() == NodeType::Identifier)
+        sym = InterpreterUtils::resolveIdentifier(static_pointer_cast<Identifier>(lhs), state->scopes, state->selfType);
+    else
+        sym = lhs->getReferencedSymbol();
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        ExpressionPtr base;
+        if(lhs->getNodeType() == NodeType::MemberAccess)
+            base = static_pointer_cast<MemberAccess>(lhs)->getSelf();
+        if(!property->getSetter())
+            unsupported(lhs, L"assignment target");
+        int savedTarget = target;
+        target = NoTarget;
+        compileCall(node, property->getSetter(), base, {rhs});
+        target = savedTarget;
+        return;
+    }
+    if(lhs->getNodeType() == NodeType::Identifier)
+    {
+        auto iter = sym ? state->locals.find(sym.get()) : state->locals.end();
+        if(iter != state->locals.end())
+        {
+            //the value is computed into the variable directly
+            compileExpression(rhs, iter->second);
+            return;
+        }
+        if(InterpreterUtils::isGlobalVariable(sym))
+        {
+            emit(BCOpcode::StoreGlobal, compileOperand(rhs), vm->getGlobalIndex(sym));
+            return;
+        }
+        if(!InterpreterUtils::isSelfIdentifier(lhs) && InterpreterUtils::isStoredProperty(sym) && state->function->hasSelf)
+        {
+            int value = compileOperand(rhs);
+            emit(BCOpcode::SetField, 0, getFieldIndex(state->selfType, sym), value, state->selfType->getCategory() != Type::Class);
+            return;
+        }
+    }
+    else if(lhs->getNodeType() == NodeType::MemberAccess && InterpreterUtils::isStoredProperty(sym) && static_pointer_cast<MemberAccess>(lhs)->getSelf())
+    {
+        ExpressionPtr base = static_pointer_cast<MemberAccess>(lhs)->getSelf();
+        int value = compileOperand(rhs);
+        TypePtr baseType = base->getType();
+        bool valueType = baseType->getCategory() != Type::Class;
+        int owner;
+        if(valueType)
+        {
+            bool isAddress;
+            owner = compilePlace(base, isAddress);
+        }
+        else
+            owner = compileOperand(base);
+        emit(BCOpcode::SetField, owner, getFieldIndex(baseType, sym), value, valueType);
+        return;
+    }
+    else if(lhs->getNodeType() == NodeType::SubscriptAccess)
+    {
+        SubscriptAccessPtr sa = static_pointer_cast<SubscriptAccess>(lhs);
+        if(!global->isArray(sa->getSelf()->getType()) || sa->getIndex()->numExpressions() != 1)
+            unsupported(lhs, L"subscript");
+        int value = compileOperand(rhs);
+        bool isAddress;
+        int array = compilePlace(sa->getSelf(), isAddress);
+        int index = compileOperand(sa->getIndex()->get(0));
+        sourceInfo = *lhs->getSourceInfo();
+        emit(BCOpcode::SetElement, array, index, value);
+        return;
+    }
+    int value = compileOperand(rhs);
+    int address = compileAddress(lhs);
+    emit(BCOpcode::Store, address, value);
+}
+
+void BytecodeCompiler::visitFunctionCall(const FunctionCallPtr& node)
+{
+    ExpressionPtr callee = node->getFunction();
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    vector<ExpressionPtr> args;
+    InterpreterUtils::getArguments(node->getArguments(), args);
+    if(func && func->getRole() == FunctionRoleEnumCase)
+        unsupported(node, L"associated value");
+    ExpressionPtr base;
+    if(callee->getNodeType() == NodeType::MemberAccess)
+        base = static_pointer_cast<MemberAccess>(callee)->getSelf();
+    if(func && base && global->isArray(base->getType()))
+    {
+        compileArrayMethod(node, func->getName(), base, args);
+        return;
+    }
+    if(!func || (!InterpreterUtils::getOwnerType(func) && state->locals.count(func.get())))
+        unsupported(node, L"call of function value");
+    compileCall(node, func, base, args);
+}
+
+void BytecodeCompiler::compileCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    TypePtr owner = InterpreterUtils::getOwnerType(func);
+    if(!owner && isBuiltin(func, arguments))
+    {
+        compileBuiltin(node, func, arguments);
+        return;
+    }
+    if(func->getType()->hasVariadicParameters() || func->getType()->getParameters().size() != arguments.size())
+        unsupported(node, L"default or variadic arguments");
+    if(owner && InterpreterUtils::isInitializer(func))
+    {
+        compileConstruct(node, func, base, arguments);
+        return;
+    }
+    BCFunction* function = vm->getFunction(func);
+    if(!function)
+        unsupported(node, func->getName());
+    bool dynamicDispatch = owner && owner->getCategory() == Type::Class && func->getRole() == FunctionRoleNormal
+        && !InterpreterUtils::hasFlag(func, SymbolFlagStatic) && !InterpreterUtils::hasFlag(func, SymbolFlagFinal) && !func->hasFlags(SymbolFlagExtension);
+    //a call on super is not dispatched dynamically
+    if(base && base->getNodeType() == NodeType::Identifier && static_pointer_cast<Identifier>(base)->getIdentifier() == L"super")
+        dynamicDispatch = false;
+    int dst = target;
+    //callee's registers start from the window, the result is returned in its first register
+    int window = allocate(std::max(1, function->numParameters));
+    int argument = window;
+    if(function->hasSelf)
+    {
+        if(function->selfByAddress && base)
+            emit(BCOpcode::Move, window, compileAddress(base));
+        else if(function->selfByAddress)
+        {
+            //implicit self of the caller
+            if(!state->function->hasSelf)
+                unsupported(node, L"self");
+            emit(state->function->selfByAddress ? BCOpcode::Move : BCOpcode::AddressOf, window, 0);
+        }
+        else if(base)
+            compileExpression(base, window);
+        else
+            compileSelf(node, window);
+        argument++;
+    }
+    for(size_t i = 0; i < arguments.size(); i++)
+        compileExpression(arguments[i], argument + (int)i);
+    sourceInfo = *node->getSourceInfo();
+    if(dynamicDispatch)
+    {
+        BCInlineCache cache = {{nullptr}, {nullptr}, 0};
+        state->function->caches.push_back(cache);
+        emit(BCOpcode::CallVirtual, window, function->index, (int)state->function->caches.size() - 1);
+    }
+    else
+        emit(BCOpcode::Call, window, function->index);
+    if(dst != NoTarget && dst != window)
+        emit(BCOpcode::Move, dst, window);
+}
+
+void BytecodeCompiler::compileInstance(RuntimeType* type, int dst)
+{
+    emit(BCOpcode::New, dst, vm->getTypeIndex(type->type));
+    //initial values of inherited properties first
+    vector<RuntimeType*> chain;
+    for(RuntimeType* t = type; t; t = t->parent)
+        chain.push_back(t);
+    for(auto iter = chain.rbegin(); iter != chain.rend(); iter++)
+    {
+        auto init = vm->fieldInitializers.find(*iter);
+        if(init != vm->fieldInitializers.end())
+            emit(BCOpcode::Call, dst, init->second->index);
+    }
+}
+
+void BytecodeCompiler::compileConstruct(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    TypePtr owner = InterpreterUtils::getOwnerType(func);
+    RuntimeType* type = vm->getRuntimeType(owner);
+    BCFunction* function = vm->getFunction(func);
+    bool isClass = owner->getCategory() == Type::Class;
+    int dst = target;
+    if(!function)
+    {
+        //implicit initializers
+        const vector<Parameter>& params = func->getType()->getParameters();
+        if(!isClass && !params.empty())
+        {
+            //memberwise initializer
+            if(params.size() != type->fields.size())
+                unsupported(node, L"initializer of " + owner->getName());
+            int window = allocate(1 + (int)arguments.size());
+            emit(BCOpcode::New, window, vm->getTypeIndex(type->type));
+            for(size_t i = 0; i < arguments.size(); i++)
+            {
+                compileExpression(arguments[i], window + 1 + (int)i);
+                emit(BCOpcode::SetField, window, (int)i, window + 1 + (int)i);
+            }
+            if(dst != NoTarget)
+                emit(BCOpcode::Move, dst, window);
+            return;
+        }
+        if(isClass && !params.empty())
+        {
+            //an inherited initializer is the parent's initializer with the same parameters
+            for(RuntimeType* t = type->parent; t && !function; t = t->parent)
+            {
+                FunctionOverloadedSymbolPtr inits = t->type->getDeclaredInitializer();
+                if(!inits)
+                    continue;
+                for(const FunctionSymbolPtr& init : *inits)
+                {
+                    if(InterpreterUtils::sameSignature(init->getType(), func->getType()) && vm->getFunction(init))
+                    {
+                        function = vm->getFunction(init);
+                        break;
+                    }
+                }
+            }
+            if(!function)
+                unsupported(node, L"initializer of " + owner->getName());
+        }
+    }
+    int window = allocate(function ? function->numParameters : 1);
+    if(InterpreterUtils::isSelfIdentifier(base))
+    {
+        //self.init/super.init initializes self in place
+        if(!function || !state->function->hasSelf)
+            unsupported(node, L"initializer delegation");
+        if(isClass)
+            emit(BCOpcode::Move, window, 0);
+        else
+            compileInstance(type, window);
+    }
+    else
+        compileInstance(type, window);
+    if(function)
+    {
+        for(size_t i = 0; i < arguments.size(); i++)
+            compileExpression(arguments[i], window + 1 + (int)i);
+        sourceInfo = *node->getSourceInfo();
+        emit(BCOpcode::Call, window, function->index);
+    }
+    if(InterpreterUtils::isSelfIdentifier(base))
+    {
+        if(!isClass)
+            emit(state->function->selfByAddress ? BCOpcode::Store : BCOpcode::Move, 0, window);
+        return;
+    }
+    if(dst != NoTarget)
+        emit(BCOpcode::Move, dst, window);
+}
+
+void BytecodeCompiler::compileArrayMethod(const ExpressionPtr& node, const std::wstring& name, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    if(name == L"count" && arguments.empty())
+    {
+        int array = compileBase(base);
+        emit(BCOpcode::ArrayCount, destination(), array);
+        return;
+    }
+    if(name == L"append" && arguments.size() == 1)
+    {
+        int value = compileOperand(arguments[0]);
+        bool isAddress;
+        int array = compilePlace(base, isAddress);
+        emit(BCOpcode::ArrayAppend, array, value);
+        return;
+    }
+    if(name == L"removeLast" && arguments.empty())
+    {
+        bool isAddress;
+        int array = compilePlace(base, isAddress);
+        sourceInfo = *node->getSourceInfo();
+        emit(BCOpcode::ArrayRemoveLast, destination(), array);
+        return;
+    }
+    unsupported(node, L"Array." + name);
+}
+
+bool BytecodeCompiler::isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    //operators on primitive types are declared by GlobalScope without definitions, ++/-- are not flagged as operators
+    if(func->getDefinition() || vm->getFunction(func))
+        return false;
+    IntegerFormat format;
+    for(const Parameter& param : func->getType()->getParameters())
+    {
+        if(!Evaluator::getIntegerFormat(global, param.type, format) && !Evaluator::isFloating(global, param.type) && param.type != global->Bool() && param.type != global->String())
+            return false;
+    }
+    ExecOperator::T op;
+    return ExecOperator::fromName(func->getName(), arguments.size(), op);
+}
+
+/*!
+ * Gets the small integer literal that can be encoded as an immediate operand
+ */
+static bool getImmediate(const ExpressionPtr& expr, int negate, int& ret)
+{
+    if(expr->getNodeType() != NodeType::IntegerLiteral)
+        return false;
+    int64_t value = static_pointer_cast<IntegerLiteral>(expr)->value * negate;
+    if(value < INT16_MIN || value > INT16_MAX)
+        return false;
+    ret = (int)value;
+    return true;
+}
+
+void BytecodeCompiler::compileBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    const wstring& name = func->getName();
+    TypePtr operandType = func->getType()->getParameters()[0].type;
+    ExecOperator::T op;
+    ExecOperator::fromName(name, arguments.size(), op);
+    IntegerFormat format;
+    bool isInteger = Evaluator::getIntegerFormat(global, operandType, format) || operandType == global->Bool();
+    if(name == L"++" || name == L"--")
+    {
+        ExpressionPtr operand = arguments[0];
+        if(operand->getNodeType() == NodeType::InOut)
+            operand = static_pointer_cast<InOutParameter>(operand)->getOperand();
+        if(!isInteger)
+            unsupported(operand, name);
+        compileIncrement(node, func, operand, format);
+        return;
+    }
+    if(name == L"+" && arguments.size() == 1)
+    {
+        compileExpression(arguments[0], target);
+        return;
+    }
+    if(name == L"&&" || name == L"||")
+    {
+        //short-circuit in a temporary register, the destination may be read by the right operand
+        int value = allocate();
+        compileExpression(arguments[0], value);
+        size_t jump = emit(name == L"&&" ? BCOpcode::JumpIfFalse : BCOpcode::JumpIfTrue, value);
+        compileExpression(arguments[1], value);
+        patch(jump);
+        if(target != NoTarget)
+            emit(BCOpcode::Move, target, value);
+        return;
+    }
+    int lhs = compileOperand(arguments[0]);
+    int rhs = lhs;
+    int immediate = 0;
+    bool isInt = isInteger && format.bits == 64 && format.isSigned;
+    bool useImmediate = isInt && arguments.size() == 2 && (op == ExecOperator::Add || op == ExecOperator::Sub)
+        && getImmediate(arguments[1], op == ExecOperator::Sub ? -1 : 1, immediate);
+    if(arguments.size() == 2 && !useImmediate)
+        rhs = compileOperand(arguments[1]);
+    int dst = destination();
+    sourceInfo = *node->getSourceInfo();
+    if(name == L"!" && operandType == global->Bool())
+    {
+        emit(BCOpcode::Not, dst, lhs);
+        return;
+    }
+    if(operandType == global->String())
+    {
+        if(op == ExecOperator::Add)
+            emit(BCOpcode::Concat, dst, lhs, rhs);
+        else if(op == ExecOperator::Equal || op == ExecOperator::NotEqual)
+            emit(BCOpcode::StringEqual, dst, lhs, rhs, op == ExecOperator::NotEqual);
+        else
+            unsupported(node, name);
+        return;
+    }
+    if(Evaluator::isFloating(global, operandType))
+    {
+        int isFloat = operandType == global->Float() ? 0x20 : 0;
+        emit(ExecOperator::isComparison(op) ? BCOpcode::FloatCompare : BCOpcode::FloatOp, dst, lhs, rhs, op | isFloat);
+        return;
+    }
+    if(useImmediate)
+    {
+        emit(BCOpcode::AddIntImm, dst, lhs, (uint16_t)(int16_t)immediate);
+        return;
+    }
+    if(isInt)
+    {
+        switch(op)
+        {
+            case ExecOperator::Add:
+                emit(BCOpcode::AddInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::Sub:
+                emit(BCOpcode::SubInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::Mul:
+                emit(BCOpcode::MulInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::Less:
+                emit(BCOpcode::LtInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::LessEqual:
+                emit(BCOpcode::LeInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::Greater:
+                emit(BCOpcode::LtInt, dst, rhs, lhs);
+                return;
+            case ExecOperator::GreaterEqual:
+                emit(BCOpcode::LeInt, dst, rhs, lhs);
+                return;
+            case ExecOperator::Equal:
+                emit(BCOpcode::EqInt, dst, lhs, rhs);
+                return;
+            case ExecOperator::NotEqual:
+                emit(BCOpcode::NeInt, dst, lhs, rhs);
+                return;
+            default:
+                break;
+        }
+    }
+    if(op == ExecOperator::Not)
+    {
+        //bitwise not flips the bits of the representation
+        op = ExecOperator::Xor;
+        int64_t mask = format.isSigned || format.bits == 64 ? -1 : (int64_t)((1ULL << format.bits) - 1);
+        rhs = allocate();
+        emitLoadConstant(rhs, Value::makeInt(mask));
+    }
+    BCOpcode::T opcode = ExecOperator::isComparison(op) ? BCOpcode::IntCompare : BCOpcode::IntOp;
+    emit(opcode, dst, lhs, rhs, BCIntegerOperator::encode(op, format.bits, format.isSigned));
+}
+
+void BytecodeCompiler::compileIncrement(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& operand, const IntegerFormat& format)
+{
+    int delta = func->getName() == L"++" ? 1 : -1;
+    bool postfix = InterpreterUtils::hasFlag(func, SymbolFlagPostfix);
+    bool isInt = format.bits == 64 && format.isSigned;
+    int dst = target;
+    bool isAddress;
+    int place = compilePlace(operand, isAddress);
+    sourceInfo = *node->getSourceInfo();
+    if(!isAddress && isInt)
+    {
+        //a local variable of Int is updated in place
+        if(dst != NoTarget && postfix)
+            emit(BCOpcode::Move, dst, place);
+        emit(BCOpcode::AddIntImm, place, place, (uint16_t)(int16_t)delta);
+        if(dst != NoTarget && !postfix)
+            emit(BCOpcode::Move, dst, place);
+        return;
+    }
+    int old = allocate();
+    int updated = allocate();
+    emit(isAddress ? BCOpcode::Load : BCOpcode::Move, old, place);
+    if(isInt)
+        emit(BCOpcode::AddIntImm, updated, old, (uint16_t)(int16_t)delta);
+    else
+    {
+        int one = allocate();
+        emitLoadConstant(one, Value::makeInt(delta));
+        emit(BCOpcode::IntOp, updated, old, one, BCIntegerOperator::encode(ExecOperator::Add, format.bits, format.isSigned));
+    }
+    emit(isAddress ? BCOpcode::Store : BCOpcode::Move, place, updated);
+    if(dst != NoTarget)
+        emit(BCOpcode::Move, dst, postfix ? old : updated);
+}
+
+void BytecodeCompiler::visitBinaryOperator(const BinaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!func || !lhs || !rhs)
+        unsupported(node, node->getOperator());
+    compileCall(node, func, nullptr, {lhs, rhs});
+}
+
+void BytecodeCompiler::visitUnaryOperator(const UnaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    if(!func)
+        unsupported(node, node->getOperator());
+    compileCall(node, func, nullptr, {node->getOperand()});
+}
+
+void BytecodeCompiler::visitConditionalOperator(const ConditionalOperatorPtr& node)
+{
+    ExpressionPtr condition = dynamic_pointer_cast<Expression>(node->getCondition());
+    if(!condition)
+        unsupported(node, L"conditional pattern");
+    int value = allocate();
+    size_t jump = compileJumpIfFalse(condition);
+    compileExpression(node->getTrueExpression(), value);
+    size_t end = emit(BCOpcode::Jump);
+    patch(jump);
+    compileExpression(node->getFalseExpression(), value);
+    patch(end);
+    if(target != NoTarget)
+        emit(BCOpcode::Move, target, value);
+}
+
+void BytecodeCompiler::visitParenthesizedExpression(const ParenthesizedExpressionPtr& node)
+{
+    if(node->numExpressions() != 1)
+        unsupported(node, L"tuple");
+    compileExpression(node->get(0), target);
+}
+
+void BytecodeCompiler::visitTuple(const TuplePtr& node)
+{
+    unsupported(node, L"tuple");
+}
+
+void BytecodeCompiler::visitArrayLiteral(const ArrayLiteralPtr& node)
+{
+    if(!global->isArray(node->getType()))
+        unsupported(node, L"array literal of " + node->getType()->toString());
+    int count = node->numElements();
+    int elements = allocate(count);
+    for(int i = 0; i < count; i++)
+        compileExpression(node->getElement(i), elements + i);
+    emit(BCOpcode::NewArray, destination(), elements, count);
+}
+
+void BytecodeCompiler::visitInteger(const IntegerLiteralPtr& node)
+{
+    //integer literal can be inferred as a floating number
+    if(Evaluator::isFloating(global, node->getType()))
+        emitLoadConstant(destination(), Value::makeDouble((double)node->value));
+    else
+        emitLoadConstant(destination(), Value::makeInt(node->value));
+}
+
+void BytecodeCompiler::visitFloat(const FloatLiteralPtr& node)
+{
+    double value = node->value;
+    if(node->getType() == global->Float())
+        value = (float)value;
+    emitLoadConstant(destination(), Value::makeDouble(value));
+}
+
+void BytecodeCompiler::visitString(const StringLiteralPtr& node)
+{
+    emitLoadConstant(destination(), Value::makeString(node->toString()));
+}
+
+void BytecodeCompiler::visitBooleanLiteral(const BooleanLiteralPtr& node)
+{
+    emitLoadConstant(destination(), Value::makeBool(node->getValue()));
+}
+
+void BytecodeCompiler::visitStringInterpolation(const StringInterpolationPtr& node)
+{
+    //the string is built in a temporary register, the destination may be read by the parts
+    int value = allocate();
+    int top = state->top;
+    bool first = true;
+    for(const ExpressionPtr& expr : *node)
+    {
+        int part = compileOperand(expr);
+        if(expr->getType() != global->String() && expr->getNodeType() != NodeType::StringLiteral)
+        {
+            BCFunction* function = state->function;
+            function->types.push_back(expr->getType());
+            int str = first ? value : allocate();
+            IntegerFormat format;
+            int kind = Evaluator::getIntegerFormat(global, expr->getType(), format) ? (format.isSigned ? 1 : 2) : 0;
+            emit(BCOpcode::ToString, str, part, (int)function->types.size() - 1, kind);
+            part = str;
+        }
+        if(first)
+        {
+            if(part != value)
+                emit(BCOpcode::Move, value, part);
+        }
+        else
+            emit(BCOpcode::Concat, value, value, part);
+        first = false;
+        state->top = top;
+    }
+    if(first)
+        emitLoadConstant(value, Value::makeString(wstring()));
+    if(target != NoTarget)
+        emit(BCOpcode::Move, target, value);
+}
+
+void BytecodeCompiler::visitClosure(const ClosurePtr& node)
+{
+    unsupported(node, L"closure");
+}
+
+void BytecodeCompiler::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
+{
+    unsupported(node, L"dictionary literal");
+}
+
+void BytecodeCompiler::visitCompileConstant(const CompileConstantPtr& node)
+{
+    unsupported(node, L"compile constant");
+}
+
+void BytecodeCompiler::visitSelf(const SelfExpressionPtr& node)
+{
+    unsupported(node, L"self expression");
+}
+
+void BytecodeCompiler::visitInitializerReference(const InitializerReferencePtr& node)
+{
+    unsupported(node, L"initializer reference");
+}
+
+void BytecodeCompiler::visitDynamicType(const DynamicTypePtr& node)
+{
+    unsupported(node, L"dynamicType");
+}
+
+void BytecodeCompiler::visitForcedValue(const ForcedValuePtr& node)
+{
+    unsupported(node, L"forced value");
+}
+
+void BytecodeCompiler::visitOptionalChaining(const OptionalChainingPtr& node)
+{
+    unsupported(node, L"optional chaining");
+}
+
+void BytecodeCompiler::visitNilLiteral(const NilLiteralPtr& node)
+{
+    unsupported(node, L"nil");
+}
@@ -0,0 +1,2054 @@
+/* Evaluator.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/Evaluator.h"
+#include "interpreter/InterpreterUtils.h"
+#include "ast/ast.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "semantics/GenericArgument.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include "swallow_types.h"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+USE_SWALLOW_NS
+using namespace std;
+
+struct Evaluator::FunctionContext
+{
+    FunctionContext(Function* function, FunctionContext* parent)
+    :function(function), parent(parent), numSlots(0), recompile(false)
+    {
+    }
+    Function* function;
+    FunctionContext* parent;
+    //the type that declared current function
+    TypePtr selfType;
+    //symbol of self declared by current function, used to resolve the implicit self
+    Symbol* selfSymbol;
+    int numSlots;
+    //set when a local variable is captured after it's compiled, the function is compiled again to box it
+    bool recompile;
+    vector<SymbolScope*> scopes;
+    unordered_map<Symbol*, Local> locals;
+    //variables captured by current closure, the index is used by ExecUpvalue
+    vector<Symbol*> upvalues;
+    vector<ExecMakeClosure::Capture> captures;
+};
+
+/*!
+ * Number of slots in a chunk of the stack
+ */
+static const size_t StackChunkSize = 64 * 1024;
+
+/*!
+ * Type of an enum case's associated values, a single associated value is carried directly
+ */
+static TypePtr getPayloadType(const TypePtr& type, const wstring& name)
+{
+    const EnumCase* c = type->getEnumCase(name);
+    assert(c != nullptr);
+    TypePtr ret = c->type;
+    if(ret->getCategory() == Type::Tuple && ret->numElementTypes() == 1)
+        ret = ret->getElementType(0);
+    return ret;
+}
+
+/*!
+ * Shortest representation of a floating number that reads back to the same value
+ */
+static wstring formatFloating(double value, bool isFloat)
+{
+    char buf[64];
+    for(int precision = 1; precision <= 17; precision++)
+    {
+        snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        double v = strtod(buf, nullptr);
+        if(isFloat ? (float)v == (float)value : v == value)
+            break;
+    }
+    string s = buf;
+    if(s.find_first_of(".en") == string::npos)
+        s += ".0";
+    return wstring(s.begin(), s.end());
+}
+
+static wstring quote(const wstring& str)
+{
+    wstring ret = L"\"";
+    for(wchar_t ch : str)
+    {
+        switch(ch)
+        {
+            case L'"':
+                ret += L"\\\"";
+                break;
+            case L'\\':
+                ret += L"\\\\";
+                break;
+            case L'\n':
+                ret += L"\\n";
+                break;
+            case L'\t':
+                ret += L"\\t";
+                break;
+            default:
+                ret += ch;
+                break;
+        }
+    }
+    ret += L"\"";
+    return ret;
+}
+
+
+Evaluator::Evaluator(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults)
+:symbolRegistry(symbolRegistry), compilerResults(compilerResults), ctx(nullptr), programScope(nullptr), stackChunk(0), stackTop(0), depth(0)
+{
+    global = symbolRegistry->getGlobalScope();
+}
+
+Evaluator::~Evaluator()
+{
+    //instances released from now on are not deinitialized
+    for(auto& entry : types)
+        entry.second->evaluator = nullptr;
+    globalStorages.clear();
+}
+
+void Evaluator::setCompilerResults(CompilerResults* compilerResults)
+{
+    this->compilerResults = compilerResults;
+}
+
+bool Evaluator::evaluate(const ScopedProgramPtr& program, std::vector<Value>* results)
+{
+    programScope = program->getScope();
+    //nodes of previous evaluation are released, their addresses can be reused
+    closures.clear();
+    Function main;
+    main.name = L"main";
+    vector<ExecNodePtr> statements;
+    try
+    {
+        for(const StatementPtr& st : *program)
+            declareStatement(st);
+        FunctionContext context(&main, nullptr);
+        context.scopes.push_back(programScope);
+        ctx = &context;
+        for(const StatementPtr& st : *program)
+        {
+            //a top-level local variable captured by a closure is boxed in a second pass
+            ExecNodePtr code;
+            do
+            {
+                context.recompile = false;
+                code = compileStatement(st);
+            } while(context.recompile);
+            statements.push_back(std::move(code));
+        }
+        main.numSlots = context.numSlots;
+        ctx = nullptr;
+        compilePending();
+    }
+    catch(const Abort&)
+    {
+        ctx = nullptr;
+        pending.clear();
+        return false;
+    }
+    try
+    {
+        SlotsGuard guard(this, main.numSlots);
+        Frame frame = {this, guard.slots, nullptr, Value()};
+        for(const ExecNodePtr& st : statements)
+        {
+            ExecExpression* expr = dynamic_cast<ExecExpression*>(st.get());
+            Value value;
+            if(expr)
+                value = expr->evaluate(frame);
+            else if(st)
+                st->execute(frame);
+            if(results)
+                results->push_back(std::move(value));
+        }
+    }
+    catch(const Abort&)
+    {
+        return false;
+    }
+    return true;
+}
+
+Value* Evaluator::getGlobal(const SymbolPtr& symbol)
+{
+    auto iter = globals.find(symbol.get());
+    if(iter == globals.end())
+        return nullptr;
+    return iter->second.storage;
+}
+
+void Evaluator::unsupported(const NodePtr& node, const std::wstring& what)
+{
+    compilerResults->add(ErrorLevel::Error, *node->getSourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, what);
+    throw Abort();
+}
+
+/*********************************************************************
+ * Runtime
+ *********************************************************************/
+
+void Evaluator::runtimeError(const SourceInfo& sourceInfo, int code, const std::wstring& item1, const std::wstring& item2)
+{
+    ResultItems items;
+    items.push_back(item1);
+    items.push_back(item2);
+    compilerResults->add(ErrorLevel::Error, sourceInfo, code, items);
+    throw Abort();
+}
+
+Value Evaluator::invoke(Function* function, Value* slots, ClosureObject* closure, const SourceInfo& sourceInfo)
+{
+    if(depth >= MaxCallDepth)
+        runtimeError(sourceInfo, Errors::E_MAXIMUM_CALL_DEPTH_EXCEEDED);
+    Frame frame = {this, slots, closure, Value()};
+    depth++;
+    try
+    {
+        function->code->execute(frame);
+    }
+    catch(...)
+    {
+        depth--;
+        throw;
+    }
+    depth--;
+    return std::move(frame.result);
+}
+
+Value* Evaluator::allocateSlots(int count)
+{
+    if(stack.empty())
+    {
+        StackChunk chunk = {unique_ptr<Value[]>(new Value[StackChunkSize]), StackChunkSize};
+        stack.push_back(std::move(chunk));
+    }
+    if(stackTop + count > stack[stackChunk].size)
+    {
+        //continue in next chunk, the chunks are kept for later calls
+        savedTops.push_back(stackTop);
+        stackChunk++;
+        stackTop = 0;
+        if(stackChunk == stack.size() || stack[stackChunk].size < (size_t)count)
+        {
+            size_t size = std::max(StackChunkSize, (size_t)count);
+            StackChunk chunk = {unique_ptr<Value[]>(new Value[size]), size};
+            if(stackChunk == stack.size())
+                stack.push_back(std::move(chunk));
+            else
+                stack[stackChunk] = std::move(chunk);
+        }
+    }
+    Value* ret = stack[stackChunk].values.get() + stackTop;
+    stackTop += count;
+    return ret;
+}
+
+void Evaluator::releaseSlots(Value* slots, int count)
+{
+    for(int i = 0; i < count; i++)
+        slots[i] = Value();
+    stackTop -= count;
+    if(stackTop == 0 && stackChunk > 0)
+    {
+        stackChunk--;
+        stackTop = savedTops.back();
+        savedTops.pop_back();
+    }
+}
+
+Function* Evaluator::findOverride(RuntimeType* type, Function* method)
+{
+    auto iter = type->methods.find(method->symbol.get());
+    if(iter != type->methods.end())
+        return iter->second;
+    Function* ret = method;
+    for(RuntimeType* t = type; t; t = t->parent)
+    {
+        FunctionOverloadedSymbolPtr funcs = dynamic_pointer_cast<FunctionOverloadedSymbol>(t->type->getDeclaredMember(method->name));
+        if(!funcs)
+            continue;
+        Function* found = nullptr;
+        for(const FunctionSymbolPtr& func : *funcs)
+        {
+            if(InterpreterUtils::sameSignature(func->getType(), method->symbol->getType()))
+            {
+                found = getFunction(func);
+                break;
+            }
+        }
+        if(found)
+        {
+            ret = found;
+            break;
+        }
+    }
+    type->methods.insert(make_pair(method->symbol.get(), ret));
+    return ret;
+}
+
+void Evaluator::initializeFields(RuntimeType* type, Value& self)
+{
+    if(type->parent)
+        initializeFields(type->parent, self);
+    Function* init = type->fieldInitializer;
+    if(!init)
+        return;
+    SlotsGuard guard(this, init->numSlots);
+    guard.slots[0] = Value::makeAddress(&self);
+    invoke(init, guard.slots, nullptr, SourceInfo());
+}
+
+void Evaluator::deinitialize(InstanceObject* instance)
+{
+    for(RuntimeType* t = instance->type; t; t = t->parent)
+    {
+        if(!t->deinit)
+            continue;
+        try
+        {
+            SlotsGuard guard(this, t->deinit->numSlots);
+            instance->retain();
+            guard.slots[0] = Value::makeObject(Value::Instance, instance);
+            invoke(t->deinit, guard.slots, nullptr, SourceInfo());
+        }
+        catch(const Abort&)
+        {
+            //the error is already reported, an instance being released cannot abort the evaluation
+        }
+    }
+}
+
+std::wstring Evaluator::toString(const Value& value, const TypePtr& type, bool literal)
+{
+    return toString(global, value, type, literal);
+}
+
+std::wstring Evaluator::toString(GlobalScope* global, const Value& value, const TypePtr& type, bool literal)
+{
+    unordered_set<Object*> visiting;
+    return toString(global, value, type, literal, visiting);
+}
+
+std::wstring Evaluator::toString(GlobalScope* global, const Value& value, const TypePtr& type, bool literal, std::unordered_set<Object*>& visiting)
+{
+    if(!type)
+        return L"?";
+    IntegerFormat format;
+    if(type == global->Bool())
+        return value.i ? L"true" : L"false";
+    if(getIntegerFormat(global, type, format))
+        return format.isSigned ? to_wstring(value.i) : to_wstring((uint64_t)value.i);
+    if(isFloating(global, type))
+        return formatFloating(value.d, type == global->Float());
+    if(type == global->String())
+        return literal ? quote(value.getString()) : value.getString();
+    if(global->isArray(type))
+    {
+        TypePtr elementType = type->getGenericArguments()->get(0);
+        wstring ret = L"[";
+        ArrayObject* array = static_cast<ArrayObject*>(value.object);
+        for(size_t i = 0; array && i < array->elements.size(); i++)
+        {
+            if(i)
+                ret += L", ";
+            ret += toString(global, array->elements[i], elementType, true, visiting);
+        }
+        return ret + L"]";
+    }
+    switch(type->getCategory())
+    {
+        case Type::Tuple:
+        {
+            if(type->numElementTypes() == 0)
+                return L"()";
+            InstanceObject* tuple = static_cast<InstanceObject*>(value.object);
+            wstring ret = L"(";
+            for(int i = 0; i < type->numElementTypes(); i++)
+            {
+                if(i)
+                    ret += L", ";
+                ret += toString(global, tuple->fields[i], type->getElementType(i), true, visiting);
+            }
+            return ret + L")";
+        }
+        case Type::Enum:
+        {
+            const Type::EnumCaseMap& cases = type->getEnumCases();
+            if(value.index >= cases.size())
+                return L"?";
+            auto iter = cases.begin();
+            advance(iter, value.index);
+            wstring ret = iter->first;
+            if(value.object)
+            {
+                TypePtr payloadType = getPayloadType(type, iter->first);
+                wstring payload = toString(global, static_cast<BoxObject*>(value.object)->value, payloadType, true, visiting);
+                if(payloadType->getCategory() == Type::Tuple)
+                    ret += payload;
+                else
+                    ret += L"(" + payload + L")";
+            }
+            return ret;
+        }
+        case Type::Struct:
+        case Type::Class:
+        {
+            InstanceObject* instance = static_cast<InstanceObject*>(value.object);
+            wstring ret = type->getName();
+            if(!instance || !instance->type)
+                return ret;
+            //instances of class can refer to each other
+            if(!visiting.insert(instance).second)
+                return ret + L"(...)";
+            ret += L"(";
+            const vector<SymbolPtr>& fields = instance->type->fields;
+            for(size_t i = 0; i < fields.size(); i++)
+            {
+                if(i)
+                    ret += L", ";
+                ret += fields[i]->getName() + L": " + toString(global, instance->fields[i], fields[i]->getType(), true, visiting);
+            }
+            visiting.erase(instance);
+            return ret + L")";
+        }
+        case Type::Function:
+            return L"(Function)";
+        default:
+            return type->toString();
+    }
+}
+
+/*********************************************************************
+ * Declarations
+ *********************************************************************/
+
+RuntimeType* Evaluator::getRuntimeType(const TypePtr& type)
+{
+    auto iter = types.find(type.get());
+    if(iter != types.end())
+        return iter->second.get();
+    RuntimeType* ret = new RuntimeType();
+    types.insert(make_pair(type.get(), unique_ptr<RuntimeType>(ret)));
+    ret->type = type;
+    if(type->getCategory() == Type::Class && type->getParentType() && type->getParentType()->getCategory() == Type::Class)
+    {
+        ret->parent = getRuntimeType(type->getParentType());
+        ret->fields = ret->parent->fields;
+        //deinitializers of parent class also run on the instances of subclass
+        ret->evaluator = ret->parent->evaluator;
+    }
+    if(type->getCategory() == Type::Struct || type->getCategory() == Type::Class)
+        InterpreterUtils::getStoredProperties(type, ret->fields);
+    return ret;
+}
+
+Function* Evaluator::declareFunction(const FunctionSymbolPtr& symbol, RuntimeType* owner, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body)
+{
+    if(Function* ret = getFunction(symbol))
+        return ret;
+    Function* ret = new Function();
+    functions.push_back(unique_ptr<Function>(ret));
+    ret->name = symbol->getName();
+    ret->symbol = symbol;
+    ret->owner = owner;
+    ret->parameters = parameters;
+    ret->body = body;
+    ret->numParameters = (int)parameters.size();
+    ret->isInit = owner && InterpreterUtils::isInitializer(symbol);
+    if(owner && !InterpreterUtils::hasFlag(symbol, SymbolFlagStatic))
+        ret->selfSlot = ret->numParameters;
+    functionsBySymbol.insert(make_pair(symbol.get(), ret));
+    pending.push_back(ret);
+    return ret;
+}
+
+Function* Evaluator::getFunction(const FunctionSymbolPtr& symbol)
+{
+    auto iter = functionsBySymbol.find(symbol.get());
+    if(iter == functionsBySymbol.end())
+        return nullptr;
+    return iter->second;
+}
+
+void Evaluator::declareStatement(const StatementPtr& statement)
+{
+    switch(statement->getNodeType())
+    {
+        case NodeType::Function:
+        {
+            FunctionDefPtr func = static_pointer_cast<FunctionDef>(statement);
+            if(func->numParameters() > 1)
+                unsupported(func, L"curried function");
+            declareFunction(static_pointer_cast<SymboledFunction>(func)->symbol, nullptr, InterpreterUtils::getParameters(func), func->getBody());
+            break;
+        }
+        case NodeType::ComputedProperty:
+        {
+            ComputedPropertyPtr property = static_pointer_cast<ComputedProperty>(statement);
+            if(property->getWillSet() || property->getDidSet())
+                unsupported(property, L"property observer");
+            shared_ptr<ComposedComputedProperty> p = static_pointer_cast<ComposedComputedProperty>(property);
+            if(SymboledFunctionPtr getter = p->functions.getter)
+                declareFunction(getter->symbol, nullptr, InterpreterUtils::getParameters(getter), getter->getBody());
+            if(SymboledFunctionPtr setter = p->functions.setter)
+                declareFunction(setter->symbol, nullptr, InterpreterUtils::getParameters(setter), setter->getBody());
+            break;
+        }
+        case NodeType::Class:
+        case NodeType::Struct:
+        case NodeType::Enum:
+        case NodeType::Extension:
+            declareType(static_pointer_cast<TypeDeclaration>(statement));
+            break;
+        default:
+            break;
+    }
+}
+
+void Evaluator::declareType(const TypeDeclarationPtr& node)
+{
+    TypePtr type = node->getType();
+    RuntimeType* rt = nullptr;
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    if(type)
+        rt = getRuntimeType(type);
+    for(const DeclarationPtr& decl : *node)
+    {
+        switch(decl->getNodeType())
+        {
+            case NodeType::Function:
+            {
+                FunctionDefPtr func = static_pointer_cast<FunctionDef>(decl);
+                FunctionSymbolPtr symbol = static_pointer_cast<SymboledFunction>(func)->symbol;
+                if(func->numParameters() > 1)
+                    unsupported(func, L"curried function");
+                declareFunction(symbol, getRuntimeType(InterpreterUtils::getOwnerType(symbol)), InterpreterUtils::getParameters(func), func->getBody());
+                break;
+            }
+            case NodeType::Init:
+            {
+                InitializerDefPtr init = static_pointer_cast<InitializerDef>(decl);
+                FunctionSymbolPtr symbol = static_pointer_cast<SymboledInit>(init)->symbol;
+                if(init->isFailable() || init->isImplicitFailable())
+                    unsupported(init, L"failable initializer");
+                vector<ParameterNodePtr> params(init->getParameters()->begin(), init->getParameters()->end());
+                declareFunction(symbol, getRuntimeType(InterpreterUtils::getOwnerType(symbol)), params, init->getBody());
+                break;
+            }
+            case NodeType::ComputedProperty:
+            {
+                ComputedPropertyPtr property = static_pointer_cast<ComputedProperty>(decl);
+                if(property->getWillSet() || property->getDidSet())
+                    unsupported(property, L"property observer");
+                shared_ptr<ComposedComputedProperty> p = static_pointer_cast<ComposedComputedProperty>(property);
+                for(const SymboledFunctionPtr& func : {p->functions.getter, p->functions.setter})
+                {
+                    if(func)
+                        declareFunction(func->symbol, getRuntimeType(InterpreterUtils::getOwnerType(func->symbol)), InterpreterUtils::getParameters(func), func->getBody());
+                }
+                break;
+            }
+            case NodeType::Deinit:
+            {
+                rt->deinit = declareFunction(type->getDeinit(), rt, vector<ParameterNodePtr>(), static_pointer_cast<DeinitializerDef>(decl)->getBody());
+                rt->evaluator = this;
+                break;
+            }
+            case NodeType::ValueBindings:
+            {
+                //stored properties with initial values are initialized by the field initializer of the type
+                ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(decl);
+                for(const ValueBindingPtr& binding : *bindings)
+                {
+                    IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+                    if(!id)
+                        unsupported(binding, L"tuple pattern");
+                    if(!binding->getInitializer() || !InterpreterUtils::isStoredProperty(type->getDeclaredMember(id->getIdentifier())))
+                        continue;
+                    if(!rt->fieldInitializer)
+                    {
+                        Function* init = new Function();
+                        functions.push_back(unique_ptr<Function>(init));
+                        init->name = type->getName() + L".fields";
+                        init->owner = rt;
+                        init->selfSlot = 0;
+                        rt->fieldInitializer = init;
+                        pending.push_back(init);
+                    }
+                }
+                break;
+            }
+            case NodeType::Class:
+            case NodeType::Struct:
+            case NodeType::Enum:
+                declareType(static_pointer_cast<TypeDeclaration>(decl));
+                break;
+            case NodeType::Subscript:
+                unsupported(decl, L"subscript");
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+ExecNodePtr Evaluator::compileType(const TypeDeclarationPtr& node)
+{
+    //static stored properties are initialized when the declaration is executed
+    TypePtr type = node->getType();
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    ExecBlock* block = new ExecBlock();
+    ExecNodePtr ret(block);
+    for(const DeclarationPtr& decl : *node)
+    {
+        if(decl->getNodeType() == NodeType::Class || decl->getNodeType() == NodeType::Struct || decl->getNodeType() == NodeType::Enum)
+        {
+            block->statements.push_back(compileType(static_pointer_cast<TypeDeclaration>(decl)));
+            continue;
+        }
+        if(decl->getNodeType() != NodeType::ValueBindings)
+            continue;
+        ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(decl);
+        for(const ValueBindingPtr& binding : *bindings)
+        {
+            IdentifierPtr id = static_pointer_cast<Identifier>(binding->getName());
+            SymbolPtr sym = type->getDeclaredMember(id->getIdentifier());
+            if(!binding->getInitializer() || !InterpreterUtils::isGlobalVariable(sym))
+                continue;
+            ExecExpressionPtr value = compileExpression(binding->getInitializer());
+            block->statements.push_back(ExecNodePtr(new ExecAssign(new ExecGlobal(getGlobalStorage(sym)), value.release())));
+        }
+    }
+    return ret;
+}
+
+void Evaluator::compilePending()
+{
+    while(!pending.empty())
+    {
+        Function* func = pending.back();
+        pending.pop_back();
+        compileFunction(func, nullptr);
+    }
+}
+
+/*********************************************************************
+ * Functions
+ *********************************************************************/
+
+void Evaluator::compileFunction(Function* function, FunctionContext* parent, std::vector<ExecMakeClosure::Capture>* captures)
+{
+    FunctionContext* saved = ctx;
+    try
+    {
+        do
+        {
+            FunctionContext context(function, parent);
+            ctx = &context;
+            if(function->owner && function == function->owner->fieldInitializer)
+                compileFieldInitializer(function->owner);
+            else
+                compileBody(function);
+            if(!context.recompile)
+            {
+                if(captures)
+                    *captures = context.captures;
+                break;
+            }
+        } while(true);
+    }
+    catch(...)
+    {
+        ctx = saved;
+        throw;
+    }
+    ctx = saved;
+}
+
+void Evaluator::compileBody(Function* function)
+{
+    SymbolScope* scope = nullptr;
+    if(function->closure)
+        scope = static_pointer_cast<ScopedClosure>(function->closure)->getScope();
+    else if(function->body)
+        scope = static_pointer_cast<ScopedCodeBlock>(function->body)->getScope();
+    ctx->scopes.push_back(scope);
+    ctx->numSlots = function->numParameters + (function->selfSlot >= 0 ? 1 : 0);
+    ExecBlock* block = new ExecBlock();
+    function->code.reset(block);
+    //parameters come first, a captured parameter is moved into a box
+    for(int i = 0; i < function->numParameters; i++)
+    {
+        const ParameterNodePtr& param = function->parameters[i];
+        SymbolPtr sym = scope ? scope->lookup(param->getLocalName()) : nullptr;
+        if(!sym)
+            continue;
+        Local local = {i, Local::Direct};
+        if(param->isInout())
+            local.kind = Local::Address;
+        else if(capturedSymbols.count(sym.get()))
+            local.kind = Local::Boxed;
+        ctx->locals[sym.get()] = local;
+        if(local.kind == Local::Boxed)
+        {
+            ExecDeclare* box = new ExecDeclare(i, true);
+            box->initializer.reset(new ExecLocal(i));
+            block->statements.push_back(ExecNodePtr(box));
+        }
+    }
+    if(function->owner)
+    {
+        TypePtr owner = function->owner->type;
+        ctx->selfType = owner;
+        if(function->selfSlot >= 0)
+        {
+            bool valueType = owner->getCategory() != Type::Class;
+            Local self = {function->selfSlot, Local::Direct};
+            SymbolPtr selfSymbol = scope ? scope->lookup(L"self") : nullptr;
+            if(valueType && !function->isInit && InterpreterUtils::hasFlag(function->symbol, SymbolFlagMutating))
+                self.kind = Local::Address;
+            else if(selfSymbol && capturedSymbols.count(selfSymbol.get()))
+            {
+                self.kind = Local::Boxed;
+                ExecDeclare* box = new ExecDeclare(self.slot, true);
+                box->initializer.reset(new ExecLocal(self.slot));
+                block->statements.push_back(ExecNodePtr(box));
+            }
+            if(selfSymbol)
+            {
+                ctx->selfSymbol = selfSymbol.get();
+                ctx->locals[selfSymbol.get()] = self;
+            }
+            if(SymbolPtr superSymbol = scope ? scope->lookup(L"super") : nullptr)
+                ctx->locals[superSymbol.get()] = self;
+        }
+    }
+    if(function->closure)
+    {
+        ClosurePtr closure = function->closure;
+        TypePtr returnType = closure->getType()->getReturnType();
+        //a single expression closure returns the value of the expression implicitly
+        if(closure->numStatement() == 1 && dynamic_pointer_cast<Expression>(closure->getStatement(0)) && returnType && !Type::equals(returnType, global->Void()))
+        {
+            ExecReturn* ret = new ExecReturn();
+            ret->value = compileExpression(static_pointer_cast<Expression>(closure->getStatement(0)));
+            block->statements.push_back(ExecNodePtr(ret));
+        }
+        else
+        {
+            for(const StatementPtr& st : *closure)
+                block->statements.push_back(compileStatement(st));
+        }
+    }
+    else if(function->body)
+    {
+        block->statements.push_back(compileStatements(function->body));
+    }
+    if(function->isInit)
+    {
+        //initializer always returns the initialized self
+        ExecReturn* ret = new ExecReturn();
+        ret->value = compileSelf(function->body);
+        block->statements.push_back(ExecNodePtr(ret));
+    }
+    ctx->scopes.pop_back();
+    function->numSlots = ctx->numSlots;
+}
+
+void Evaluator::compileFieldInitializer(RuntimeType* type)
+{
+    Function* function = type->fieldInitializer;
+    TypeDeclarationPtr decl = type->type->getReference();
+    ExecBlock* block = new ExecBlock();
+    function->code.reset(block);
+    ctx->selfType = type->type;
+    ctx->numSlots = 1;
+    //self is passed by address
+    ExecLValuePtr self(new ExecIndirect(0));
+    for(const DeclarationPtr& d : *decl)
+    {
+        if(d->getNodeType() != NodeType::ValueBindings)
+            continue;
+        ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(d);
+        for(const ValueBindingPtr& binding : *bindings)
+        {
+            if(!binding->getInitializer())
+                continue;
+            IdentifierPtr id = static_pointer_cast<Identifier>(binding->getName());
+            SymbolPtr field = type->type->getDeclaredMember(id->getIdentifier());
+            if(!InterpreterUtils::isStoredProperty(field))
+                continue;
+            ExecExpressionPtr value = compileExpression(binding->getInitializer());
+            ExecLValue* target;
+            if(type->type->getCategory() == Type::Class)
+                target = new ExecReferenceField(new ExecIndirect(0), type->getFieldIndex(field));
+            else
+                target = new ExecField(new ExecIndirect(0), type->getFieldIndex(field));
+            block->statements.push_back(ExecNodePtr(new ExecAssign(target, value.release())));
+        }
+    }
+    function->numSlots = ctx->numSlots;
+}
+
+Evaluator::Local Evaluator::declareLocal(const SymbolPtr& symbol)
+{
+    Local ret = {ctx->numSlots++, Local::Direct};
+    if(capturedSymbols.count(symbol.get()))
+        ret.kind = Local::Boxed;
+    ctx->locals[symbol.get()] = ret;
+    return ret;
+}
+
+SymbolPtr Evaluator::lookupLocal(const std::wstring& name)
+{
+    for(auto iter = ctx->scopes.rbegin(); iter != ctx->scopes.rend(); iter++)
+    {
+        if(!*iter)
+            continue;
+        if(SymbolPtr ret = (*iter)->lookup(name))
+            return ret;
+    }
+    return nullptr;
+}
+
+Value* Evaluator::getGlobalStorage(const SymbolPtr& symbol)
+{
+    if(Value* ret = getGlobal(symbol))
+        return ret;
+    globalStorages.push_back(Value());
+    Global g = {symbol, &globalStorages.back()};
+    globals.insert(make_pair(symbol.get(), g));
+    return g.storage;
+}
+
+int Evaluator::resolveUpvalue(FunctionContext* context, Symbol* symbol, const NodePtr& node)
+{
+    if(!context->parent)
+        return -1;
+    for(size_t i = 0; i < context->upvalues.size(); i++)
+    {
+        if(context->upvalues[i] == symbol)
+            return (int)i;
+    }
+    ExecMakeClosure::Capture capture;
+    auto iter = context->parent->locals.find(symbol);
+    if(iter != context->parent->locals.end())
+    {
+        if(iter->second.kind == Local::Address)
+            unsupported(node, L"capture of inout parameter");
+        if(iter->second.kind == Local::Direct)
+        {
+            //the variable was compiled as an unboxed local, compile the enclosing function again
+            capturedSymbols.insert(symbol);
+            context->parent->recompile = true;
+        }
+        capture.local = true;
+        capture.index = iter->second.slot;
+    }
+    else
+    {
+        int index = resolveUpvalue(context->parent, symbol, node);
+        if(index < 0)
+            return -1;
+        capture.local = false;
+        capture.index = index;
+    }
+    context->upvalues.push_back(symbol);
+    context->captures.push_back(capture);
+    return (int)context->upvalues.size() - 1;
+}
+
+/*********************************************************************
+ * Declarations in statements
+ *********************************************************************/
+
+void Evaluator::visitValueBindings(const ValueBindingsPtr& node)
+{
+    ExecBlock* block = new ExecBlock();
+    ExecNodePtr holder(block);
+    for(const ValueBindingPtr& binding : *node)
+    {
+        IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+        if(!id)
+            unsupported(binding, L"tuple pattern");
+        SymbolPlaceHolderPtr var = dynamic_pointer_cast<SymbolPlaceHolder>(lookupLocal(id->getIdentifier()));
+        if(!var)
+            unsupported(binding, id->getIdentifier());
+        ExecExpressionPtr value;
+        if(binding->getInitializer())
+            value = compileExpression(binding->getInitializer());
+        if(InterpreterUtils::isGlobalVariable(var))
+        {
+            Value* storage = getGlobalStorage(var);
+            if(value)
+                block->statements.push_back(ExecNodePtr(new ExecAssign(new ExecGlobal(storage), value.release())));
+        }
+        else
+        {
+            Local local = declareLocal(var);
+            ExecDeclare* declare = new ExecDeclare(local.slot, local.kind == Local::Boxed);
+            declare->initializer = std::move(value);
+            block->statements.push_back(ExecNodePtr(declare));
+        }
+    }
+    result = std::move(holder);
+}
+
+void Evaluator::visitComputedProperty(const ComputedPropertyPtr& node)
+{
+    shared_ptr<ComposedComputedProperty> property = static_pointer_cast<ComposedComputedProperty>(node);
+    if(property->functions.getter && !getFunction(property->functions.getter->symbol))
+        unsupported(node, L"local computed property");
+}
+
+void Evaluator::visitClass(const ClassDefPtr& node)
+{
+    declareType(node);
+    result = compileType(node);
+}
+
+void Evaluator::visitStruct(const StructDefPtr& node)
+{
+    declareType(node);
+    result = compileType(node);
+}
+
+void Evaluator::visitEnum(const EnumDefPtr& node)
+{
+    declareType(node);
+    result = compileType(node);
+}
+
+void Evaluator::visitExtension(const ExtensionDefPtr& node)
+{
+    declareType(node);
+    result = compileType(node);
+}
+
+void Evaluator::visitProtocol(const ProtocolDefPtr& node)
+{
+    //protocols have no implementation
+}
+
+void Evaluator::visitFunction(const FunctionDefPtr& node)
+{
+    FunctionSymbolPtr symbol = static_pointer_cast<SymboledFunction>(node)->symbol;
+    if(getFunction(symbol))
+        return;
+    //a local function is a closure stored in a local variable, so it can capture the enclosing function's variables
+    if(node->numParameters() > 1)
+        unsupported(node, L"curried function");
+    Local local = declareLocal(symbol);
+    Function* function = getClosureFunction(node);
+    function->name = symbol->getName();
+    function->symbol = symbol;
+    function->parameters = InterpreterUtils::getParameters(node);
+    function->numParameters = (int)function->parameters.size();
+    function->body = node->getBody();
+    ExecMakeClosure* closure = new ExecMakeClosure(function);
+    ExecExpressionPtr value(closure);
+    compileFunction(function, ctx, &closure->captures);
+    ExecBlock* block = new ExecBlock();
+    result.reset(block);
+    block->statements.push_back(ExecNodePtr(new ExecDeclare(local.slot, local.kind == Local::Boxed)));
+    ExecLValue* target = local.kind == Local::Boxed ? (ExecLValue*)new ExecIndirect(local.slot) : (ExecLValue*)new ExecLocal(local.slot);
+    block->statements.push_back(ExecNodePtr(new ExecAssign(target, value.release())));
+}
+
+void Evaluator::visitDeinit(const DeinitializerDefPtr& node)
+{
+    //compiled by its type declaration
+}
+
+void Evaluator::visitInit(const InitializerDefPtr& node)
+{
+    //compiled by its type declaration
+}
+
+void Evaluator::visitSubscript(const SubscriptDefPtr& node)
+{
+    unsupported(node, L"subscript");
+}
+
+void Evaluator::visitTypeAlias(const TypeAliasPtr& node)
+{
+}
+
+void Evaluator::visitImport(const ImportPtr& node)
+{
+}
+
+void Evaluator::visitOperator(const OperatorDefPtr& node)
+{
+}
+
+/*********************************************************************
+ * Statements
+ *********************************************************************/
+
+ExecNodePtr Evaluator::compileStatement(const StatementPtr& statement)
+{
+    result = nullptr;
+    statement->accept(this);
+    ExecNodePtr ret = std::move(result);
+    if(!ret)
+        ret.reset(new ExecBlock());
+    return ret;
+}
+
+ExecNodePtr Evaluator::compileStatements(const CodeBlockPtr& codeBlock)
+{
+    ExecBlock* block = new ExecBlock();
+    ExecNodePtr ret(block);
+    ctx->scopes.push_back(static_pointer_cast<ScopedCodeBlock>(codeBlock)->getScope());
+    for(const StatementPtr& st : *codeBlock)
+        block->statements.push_back(compileStatement(st));
+    ctx->scopes.pop_back();
+    return ret;
+}
+
+void Evaluator::visitCodeBlock(const CodeBlockPtr& node)
+{
+    result = compileStatements(node);
+}
+
+void Evaluator::visitIf(const IfStatementPtr& node)
+{
+    ExecIf* ret = new ExecIf();
+    ExecNodePtr holder(ret);
+    ret->condition = compileCondition(node->getCondition());
+    ret->thenPart = compileStatements(node->getThen());
+    if(node->getElse())
+        ret->elsePart = compileStatement(node->getElse());
+    result = std::move(holder);
+}
+
+void Evaluator::visitWhileLoop(const WhileLoopPtr& node)
+{
+    ExecLoop* ret = new ExecLoop();
+    ExecNodePtr holder(ret);
+    ret->condition = compileCondition(node->getCondition());
+    ret->body = compileStatements(node->getCodeBlock());
+    result = std::move(holder);
+}
+
+void Evaluator::visitDoLoop(const DoLoopPtr& node)
+{
+    ExecLoop* ret = new ExecLoop();
+    ExecNodePtr holder(ret);
+    ret->testFirst = false;
+    ret->body = compileStatements(node->getCodeBlock());
+    ret->condition = compileCondition(node->getCondition());
+    result = std::move(holder);
+}
+
+void Evaluator::visitForLoop(const ForLoopPtr& node)
+{
+    ExecBlock* block = new ExecBlock();
+    ExecNodePtr holder(block);
+    //the initializer is declared in the scope of loop's body
+    ctx->scopes.push_back(static_pointer_cast<ScopedCodeBlock>(node->getCodeBlock())->getScope());
+    if(node->getInitializer())
+        block->statements.push_back(compileStatement(node->getInitializer()));
+    for(int i = 0; i < node->numInit(); i++)
+        block->statements.push_back(compileStatement(node->getInit(i)));
+    ExecLoop* loop = new ExecLoop();
+    block->statements.push_back(ExecNodePtr(loop));
+    if(node->getCondition())
+        loop->condition = compileCondition(node->getCondition());
+    loop->body = compileStatements(node->getCodeBlock());
+    if(node->getStep())
+        loop->step = compileStatement(node->getStep());
+    ctx->scopes.pop_back();
+    result = std::move(holder);
+}
+
+void Evaluator::visitForIn(const ForInLoopPtr& node)
+{
+    unsupported(node, L"for-in");
+}
+
+void Evaluator::visitLabeledStatement(const LabeledStatementPtr& node)
+{
+    unsupported(node, L"labeled statement");
+}
+
+void Evaluator::visitFallthrough(const FallthroughStatementPtr& node)
+{
+    unsupported(node, L"fallthrough");
+}
+
+void Evaluator::visitBreak(const BreakStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled break");
+    result.reset(new ExecJump(Flow::Break));
+}
+
+void Evaluator::visitContinue(const ContinueStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled continue");
+    result.reset(new ExecJump(Flow::Continue));
+}
+
+void Evaluator::visitReturn(const ReturnStatementPtr& node)
+{
+    ExecReturn* ret = new ExecReturn();
+    ExecNodePtr holder(ret);
+    if(node->getExpression())
+        ret->value = compileExpression(node->getExpression());
+    else if(ctx->function->isInit)
+        ret->value = compileSelf(node);
+    result = std::move(holder);
+}
+
+void Evaluator::visitSwitchCase(const SwitchCasePtr& node)
+{
+    ExpressionPtr control = node->getControlExpression();
+    TypePtr type = control->getType();
+    if(type->getCategory() == Type::Enum)
+    {
+        result = compileSwitchOnEnum(node);
+        return;
+    }
+    IntegerFormat format;
+    if(!getIntegerFormat(global, type, format) && !isFloating(global, type) && type != global->Bool() && type != global->String())
+        unsupported(control, L"switch on " + type->toString());
+    ExecSwitch* ret = new ExecSwitch();
+    ExecNodePtr holder(ret);
+    ret->control = compileExpression(control);
+    ret->slot = ctx->numSlots++;
+    for(const CaseStatementPtr& c : *node)
+    {
+        int body = (int)ret->bodies.size();
+        for(const CaseStatement::Condition& cond : c->getConditions())
+        {
+            if(cond.guard)
+                unsupported(cond.guard, L"guard of case");
+            if(!dynamic_pointer_cast<Expression>(cond.condition))
+                unsupported(cond.condition, L"case pattern");
+            ret->patterns.push_back(make_pair(compileExpression(cond.condition), body));
+        }
+        ret->bodies.push_back(compileStatements(c->getCodeBlock()));
+    }
+    if(node->getDefaultCase())
+    {
+        ret->defaultCase = (int)ret->bodies.size();
+        ret->bodies.push_back(compileStatements(node->getDefaultCase()->getCodeBlock()));
+    }
+    result = std::move(holder);
+}
+
+ExecNodePtr Evaluator::compileSwitchOnEnum(const SwitchCasePtr& node)
+{
+    TypePtr type = node->getControlExpression()->getType();
+    ExecSwitch* ret = new ExecSwitch();
+    ExecNodePtr holder(ret);
+    ret->isEnum = true;
+    ret->control = compileExpression(node->getControlExpression());
+    ret->slot = ctx->numSlots++;
+    for(const CaseStatementPtr& c : *node)
+    {
+        int body = (int)ret->bodies.size();
+        for(const CaseStatement::Condition& cond : c->getConditions())
+        {
+            wstring name;
+            TuplePtr binding;
+            if(cond.guard)
+                unsupported(cond.guard, L"guard of case");
+            if(!InterpreterUtils::getEnumCasePattern(cond.condition, name, binding) || !type->getEnumCase(name))
+                unsupported(cond.condition, L"case pattern");
+            if(binding && c->numConditions() > 1)
+                unsupported(cond.condition, L"binding in case with multiple patterns");
+            ret->enumCases.insert(make_pair(InterpreterUtils::getEnumCaseIndex(type, name), body));
+        }
+        ExecBlock* block = new ExecBlock();
+        ret->bodies.push_back(ExecNodePtr(block));
+        ctx->scopes.push_back(static_pointer_cast<ScopedCodeBlock>(c->getCodeBlock())->getScope());
+        wstring name;
+        TuplePtr binding;
+        InterpreterUtils::getEnumCasePattern(c->getCondition(0).condition, name, binding);
+        if(binding)
+        {
+            ExecExpressionPtr payload(new ExecEnumPayload(new ExecLocal(ret->slot)));
+            bindPayload(binding, std::move(payload), getPayloadType(type, name), block);
+        }
+        block->statements.push_back(compileStatements(c->getCodeBlock()));
+        ctx->scopes.pop_back();
+    }
+    if(node->getDefaultCase())
+    {
+        ret->defaultCase = (int)ret->bodies.size();
+        ret->bodies.push_back(compileStatements(node->getDefaultCase()->getCodeBlock()));
+    }
+    return holder;
+}
+
+void Evaluator::bindPayload(const PatternPtr& pattern, ExecExpressionPtr payload, const TypePtr& type, ExecBlock* block)
+{
+    switch(pattern->getNodeType())
+    {
+        case NodeType::ValueBindingPattern:
+            bindPayload(static_pointer_cast<ValueBindingPattern>(pattern)->getBinding(), std::move(payload), type, block);
+            break;
+        case NodeType::Tuple:
+        {
+            TuplePtr tuple = static_pointer_cast<Tuple>(pattern);
+            if(tuple->numElements() == 1 && type->getCategory() != Type::Tuple)
+            {
+                bindPayload(tuple->getElement(0), std::move(payload), type, block);
+                break;
+            }
+            //keep the tuple in a temporary slot, elements are bound from it
+            int slot = ctx->numSlots++;
+            ExecDeclare* temp = new ExecDeclare(slot, false);
+            temp->initializer = std::move(payload);
+            block->statements.push_back(ExecNodePtr(temp));
+            for(int i = 0; i < tuple->numElements(); i++)
+            {
+                ExecExpressionPtr element(new ExecReferenceField(new ExecLocal(slot), i));
+                bindPayload(tuple->getElement(i), std::move(element), type->getElementType(i), block);
+            }
+            break;
+        }
+        case NodeType::Identifier:
+        {
+            const wstring& name = static_pointer_cast<Identifier>(pattern)->getIdentifier();
+            if(name == L"_")
+                break;
+            SymbolPtr sym = lookupLocal(name);
+            assert(sym != nullptr);
+            Local local = declareLocal(sym);
+            ExecDeclare* declare = new ExecDeclare(local.slot, local.kind == Local::Boxed);
+            declare->initializer = std::move(payload);
+            block->statements.push_back(ExecNodePtr(declare));
+            break;
+        }
+        default:
+            unsupported(pattern, L"case pattern");
+    }
+}
+
+/*********************************************************************
+ * Expressions
+ *********************************************************************/
+
+ExecExpressionPtr Evaluator::compileExpression(const PatternPtr& expr)
+{
+    result = nullptr;
+    expr->accept(this);
+    if(!result)
+        unsupported(expr, L"expression");
+    return ExecExpressionPtr(static_cast<ExecExpression*>(result.release()));
+}
+
+ExecExpressionPtr Evaluator::compileCondition(const ExpressionPtr& expr)
+{
+    if(expr->getNodeType() == NodeType::Assignment && static_pointer_cast<Assignment>(expr)->getLHS()->getNodeType() == NodeType::ValueBindingPattern)
+        unsupported(expr, L"optional binding");
+    if(expr->getType() != global->Bool())
+        unsupported(expr, L"condition of type " + expr->getType()->toString());
+    return compileExpression(expr);
+}
+
+ExecLValuePtr Evaluator::compileVariable(const SymbolPtr& symbol, const NodePtr& node)
+{
+    if(!symbol)
+        return nullptr;
+    auto iter = ctx->locals.find(symbol.get());
+    if(iter != ctx->locals.end())
+    {
+        if(iter->second.kind == Local::Direct)
+            return ExecLValuePtr(new ExecLocal(iter->second.slot));
+        return ExecLValuePtr(new ExecIndirect(iter->second.slot));
+    }
+    if(InterpreterUtils::isGlobalVariable(symbol))
+        return ExecLValuePtr(new ExecGlobal(getGlobalStorage(symbol)));
+    int upvalue = resolveUpvalue(ctx, symbol.get(), node);
+    if(upvalue >= 0)
+        return ExecLValuePtr(new ExecUpvalue(upvalue));
+    if(InterpreterUtils::isStoredProperty(symbol))
+    {
+        //implicit member of self
+        TypePtr owner = InterpreterUtils::getOwnerType(symbol);
+        ExecLValuePtr self = compileSelf(node);
+        if(!self)
+            return nullptr;
+        if(owner && owner->getCategory() == Type::Class)
+            return ExecLValuePtr(new ExecReferenceField(self.release(), getRuntimeType(owner)->getFieldIndex(symbol)));
+        if(!owner)
+            owner = ctx->selfType;
+        return ExecLValuePtr(new ExecField(self.release(), getRuntimeType(owner)->getFieldIndex(symbol)));
+    }
+    return nullptr;
+}
+
+ExecLValuePtr Evaluator::compileSelf(const NodePtr& node)
+{
+    //self of a closure is captured from the method that declares it
+    for(FunctionContext* c = ctx; c; c = c->parent)
+    {
+        if(!c->selfSymbol)
+            continue;
+        auto iter = ctx->locals.find(c->selfSymbol);
+        if(c == ctx && iter != ctx->locals.end())
+            return ExecLValuePtr(iter->second.kind == Local::Direct ? (ExecLValue*)new ExecLocal(iter->second.slot) : (ExecLValue*)new ExecIndirect(iter->second.slot));
+        int upvalue = resolveUpvalue(ctx, c->selfSymbol, node);
+        if(upvalue >= 0)
+            return ExecLValuePtr(new ExecUpvalue(upvalue));
+        break;
+    }
+    if(ctx->function->owner && ctx->function->selfSlot >= 0)
+        return ExecLValuePtr(new ExecLocal(ctx->function->selfSlot));
+    return nullptr;
+}
+
+ExecExpressionPtr Evaluator::compileField(ExecExpressionPtr base, const TypePtr& baseType, int index)
+{
+    //a struct in a storage is read in place
+    if(baseType->getCategory() != Type::Class)
+    {
+        if(ExecLValue* lvalue = dynamic_cast<ExecLValue*>(base.get()))
+        {
+            base.release();
+            return ExecExpressionPtr(new ExecField(lvalue, index));
+        }
+    }
+    return ExecExpressionPtr(new ExecReferenceField(base.release(), index));
+}
+
+ExecLValuePtr Evaluator::compileLValue(const ExpressionPtr& expr)
+{
+    switch(expr->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            IdentifierPtr id = static_pointer_cast<Identifier>(expr);
+            if(InterpreterUtils::isSelfIdentifier(id))
+                return compileSelf(id);
+            SymbolPtr sym = InterpreterUtils::resolveIdentifier(id, ctx->scopes, ctx->selfType);
+            if(dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+                return nullptr;
+            return compileVariable(sym, id);
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(expr);
+            ExpressionPtr base = ma->getSelf();
+            if(!base)
+                return nullptr;
+            TypePtr baseType = base->getType();
+            if(!ma->getField())
+            {
+                ExecLValuePtr lvalue = compileLValue(base);
+                if(!lvalue)
+                    return nullptr;
+                return ExecLValuePtr(new ExecField(lvalue.release(), ma->getIndex()));
+            }
+            SymbolPtr field = ma->getReferencedSymbol();
+            if(InterpreterUtils::isGlobalVariable(field))
+                return ExecLValuePtr(new ExecGlobal(getGlobalStorage(field)));
+            if(!InterpreterUtils::isStoredProperty(field))
+                return nullptr;
+            int index = getRuntimeType(baseType)->getFieldIndex(field);
+            if(baseType->getCategory() == Type::Class)
+                return ExecLValuePtr(new ExecReferenceField(compileExpression(base).release(), index));
+            ExecLValuePtr lvalue = compileLValue(base);
+            if(!lvalue)
+                return nullptr;
+            return ExecLValuePtr(new ExecField(lvalue.release(), index));
+        }
+        case NodeType::SubscriptAccess:
+        {
+            SubscriptAccessPtr sa = static_pointer_cast<SubscriptAccess>(expr);
+            if(!global->isArray(sa->getSelf()->getType()) || sa->getIndex()->numExpressions() != 1)
+                return nullptr;
+            ExecLValuePtr base = compileLValue(sa->getSelf());
+            if(!base)
+                return nullptr;
+            ExecExpressionPtr index = compileExpression(sa->getIndex()->get(0));
+            ExecArrayElement* ret = new ExecArrayElement(base.release(), index.release());
+            ret->sourceInfo = *expr->getSourceInfo();
+            return ExecLValuePtr(ret);
+        }
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+            if(p->numExpressions() != 1)
+                return nullptr;
+            return compileLValue(p->get(0));
+        }
+        default:
+            return nullptr;
+    }
+}
+
+ExecExpressionPtr Evaluator::compileEnumCase(const TypePtr& type, const std::wstring& name, ExecExpressionPtr payload)
+{
+    ExecEnum* ret = new ExecEnum(InterpreterUtils::getEnumCaseIndex(type, name));
+    ret->payload = std::move(payload);
+    return ExecExpressionPtr(ret);
+}
+
+void Evaluator::visitIdentifier(const IdentifierPtr& node)
+{
+    const wstring& name = node->getIdentifier();
+    SymbolPtr sym = InterpreterUtils::resolveIdentifier(node, ctx->scopes, ctx->selfType);
+    if(InterpreterUtils::isEnumCaseReference(sym, node->getType(), name))
+    {
+        result = compileEnumCase(node->getType(), name, nullptr);
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        result = compileCall(node, property->getGetter(), nullptr, vector<ExpressionPtr>());
+        return;
+    }
+    if(InterpreterUtils::isSelfIdentifier(node))
+    {
+        if(ExecLValuePtr self = compileSelf(node))
+        {
+            result = std::move(self);
+            return;
+        }
+    }
+    if(ExecLValuePtr var = compileVariable(sym, node))
+    {
+        result = std::move(var);
+        return;
+    }
+    if(FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(sym))
+    {
+        Function* function = getFunction(func);
+        if(function && !function->owner)
+        {
+            //a global function used as a value
+            result.reset(new ExecMakeClosure(function));
+            return;
+        }
+    }
+    unsupported(node, L"reference to " + name);
+}
+
+void Evaluator::visitMemberAccess(const MemberAccessPtr& node)
+{
+    ExpressionPtr base = node->getSelf();
+    TypePtr type = node->getType();
+    SymbolPtr sym = node->getReferencedSymbol();
+    if(!node->getField())
+    {
+        //tuple element
+        result = compileField(compileExpression(base), base->getType(), node->getIndex());
+        return;
+    }
+    const wstring& name = node->getField()->getIdentifier();
+    if(InterpreterUtils::isEnumCaseReference(sym, type, name))
+    {
+        result = compileEnumCase(type, name, nullptr);
+        return;
+    }
+    if(base && global->isArray(base->getType()))
+    {
+        result = compileArrayMethod(node, name, base, vector<ExpressionPtr>());
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        result = compileCall(node, property->getGetter(), base, vector<ExpressionPtr>());
+        return;
+    }
+    if(InterpreterUtils::isGlobalVariable(sym))
+    {
+        result.reset(new ExecGlobal(getGlobalStorage(sym)));
+        return;
+    }
+    if(!base || !InterpreterUtils::isStoredProperty(sym))
+        unsupported(node, L"member access of " + name);
+    TypePtr baseType = base->getType();
+    result = compileField(compileExpression(base), baseType, getRuntimeType(baseType)->getFieldIndex(sym));
+}
+
+void Evaluator::visitFunctionCall(const FunctionCallPtr& node)
+{
+    ExpressionPtr callee = node->getFunction();
+    SymbolPtr sym = node->getReferencedSymbol();
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(sym);
+    vector<ExpressionPtr> args;
+    InterpreterUtils::getArguments(node->getArguments(), args);
+    if(func && func->getRole() == FunctionRoleEnumCase)
+    {
+        TypePtr type = node->getType();
+        wstring name;
+        if(callee->getNodeType() == NodeType::MemberAccess)
+            name = static_pointer_cast<MemberAccess>(callee)->getField()->getIdentifier();
+        else if(callee->getNodeType() == NodeType::Identifier)
+            name = static_pointer_cast<Identifier>(callee)->getIdentifier();
+        else
+            unsupported(node, L"enum case");
+        ExecExpressionPtr payload;
+        if(args.size() == 1)
+        {
+            payload = compileExpression(args[0]);
+        }
+        else
+        {
+            ExecInstance* tuple = new ExecInstance(nullptr);
+            payload.reset(tuple);
+            for(const ExpressionPtr& arg : args)
+                tuple->fields.push_back(compileExpression(arg));
+        }
+        result = compileEnumCase(type, name, std::move(payload));
+        return;
+    }
+    ExpressionPtr base;
+    if(callee->getNodeType() == NodeType::MemberAccess)
+        base = static_pointer_cast<MemberAccess>(callee)->getSelf();
+    if(func && base && global->isArray(base->getType()))
+    {
+        result = compileArrayMethod(node, func->getName(), base, args);
+        return;
+    }
+    if(!func || (!InterpreterUtils::getOwnerType(func) && (ctx->locals.count(func.get()) || resolveUpvalue(ctx, func.get(), node) >= 0)))
+    {
+        //call of a function value
+        if(callee->getType() && callee->getType()->getCategory() != Type::Function)
+            unsupported(node, L"call of " + callee->getType()->toString());
+        ExecClosureCall* call = new ExecClosureCall(compileExpression(callee).release());
+        ExecNodePtr holder(call);
+        call->sourceInfo = *node->getSourceInfo();
+        TypePtr type = callee->getType();
+        if(type->getParameters().size() != args.size())
+            unsupported(node, L"default or variadic arguments");
+        compileArguments(call, type, args);
+        result = std::move(holder);
+        return;
+    }
+    result = compileCall(node, func, base, args);
+}
+
+ExecExpressionPtr Evaluator::compileCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    TypePtr owner = InterpreterUtils::getOwnerType(func);
+    if(!owner && isBuiltin(func, arguments))
+        return compileBuiltin(node, func, arguments);
+    if(func->getType()->hasVariadicParameters() || func->getType()->getParameters().size() != arguments.size())
+        unsupported(node, L"default or variadic arguments");
+    if(owner && InterpreterUtils::isInitializer(func))
+        return compileConstruct(node, func, base, arguments);
+    Function* function = getFunction(func);
+    if(!function)
+        unsupported(node, func->getName());
+    ExecCall* call;
+    bool isClass = owner && owner->getCategory() == Type::Class;
+    bool dynamicDispatch = isClass && func->getRole() == FunctionRoleNormal && !InterpreterUtils::hasFlag(func, SymbolFlagStatic)
+        && !InterpreterUtils::hasFlag(func, SymbolFlagFinal) && !func->hasFlags(SymbolFlagExtension);
+    //a call on super is not dispatched dynamically
+    if(base && base->getNodeType() == NodeType::Identifier && static_pointer_cast<Identifier>(base)->getIdentifier() == L"super")
+        dynamicDispatch = false;
+    if(dynamicDispatch)
+        call = new ExecVirtualCall(function);
+    else
+        call = new ExecCall(function);
+    ExecExpressionPtr ret(call);
+    call->sourceInfo = *node->getSourceInfo();
+    if(function->selfSlot >= 0)
+    {
+        if(!isClass && InterpreterUtils::hasFlag(func, SymbolFlagMutating))
+        {
+            ExecLValuePtr self = base ? compileLValue(base) : compileSelf(node);
+            if(!self)
+                unsupported(base ? base : node, L"mutating method on immutable value");
+            call->self = std::move(self);
+            call->selfByAddress = true;
+        }
+        else if(base)
+            call->self = compileExpression(base);
+        else
+            call->self = compileSelf(node);
+        if(!call->self)
+            unsupported(node, L"self");
+    }
+    compileArguments(call, func->getType(), arguments);
+    return ret;
+}
+
+ExecExpressionPtr Evaluator::compileConstruct(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    TypePtr owner = InterpreterUtils::getOwnerType(func);
+    RuntimeType* type = getRuntimeType(owner);
+    Function* function = getFunction(func);
+    bool isClass = owner->getCategory() == Type::Class;
+    if(!function)
+    {
+        //implicit initializers
+        const vector<Parameter>& params = func->getType()->getParameters();
+        if(!isClass && !params.empty())
+        {
+            //memberwise initializer
+            if(params.size() != type->fields.size())
+                unsupported(node, L"initializer of " + owner->getName());
+            ExecInstance* ret = new ExecInstance(type);
+            ExecExpressionPtr holder(ret);
+            for(const ExpressionPtr& arg : arguments)
+                ret->fields.push_back(compileExpression(arg));
+            return holder;
+        }
+        if(isClass && !params.empty())
+        {
+            //an inherited initializer is the parent's initializer with the same parameters
+            for(RuntimeType* t = type->parent; t && !function; t = t->parent)
+            {
+                FunctionOverloadedSymbolPtr inits = t->type->getDeclaredInitializer();
+                if(!inits)
+                    continue;
+                for(const FunctionSymbolPtr& init : *inits)
+                {
+                    if(InterpreterUtils::sameSignature(init->getType(), func->getType()) && getFunction(init))
+                    {
+                        function = getFunction(init);
+                        break;
+                    }
+                }
+            }
+            if(!function)
+                unsupported(node, L"initializer of " + owner->getName());
+        }
+    }
+    if(InterpreterUtils::isSelfIdentifier(base))
+    {
+        //self.init/super.init initializes self in place
+        ExecLValuePtr self = compileSelf(node);
+        if(!function || !self)
+            unsupported(node, L"initializer delegation");
+        if(!isClass)
+        {
+            ExecConstruct* construct = new ExecConstruct(type, function);
+            ExecExpressionPtr value(construct);
+            construct->sourceInfo = *node->getSourceInfo();
+            compileArguments(construct, func->getType(), arguments);
+            return ExecExpressionPtr(new ExecAssign(self.release(), value.release()));
+        }
+        ExecCall* call = new ExecCall(function);
+        ExecExpressionPtr ret(call);
+        call->sourceInfo = *node->getSourceInfo();
+        call->self = std::move(self);
+        compileArguments(call, func->getType(), arguments);
+        return ret;
+    }
+    ExecConstruct* ret = new ExecConstruct(type, function);
+    ExecExpressionPtr holder(ret);
+    ret->sourceInfo = *node->getSourceInfo();
+    compileArguments(ret, func->getType(), arguments);
+    return holder;
+}
+
+ExecExpressionPtr Evaluator::compileArrayMethod(const ExpressionPtr& node, const std::wstring& name, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    ExecArrayMethod::Method method;
+    if(name == L"count" && arguments.empty())
+        method = ExecArrayMethod::Count;
+    else if(name == L"append" && arguments.size() == 1)
+        method = ExecArrayMethod::Append;
+    else if(name == L"removeLast" && arguments.empty())
+        method = ExecArrayMethod::RemoveLast;
+    else
+        unsupported(node, L"Array." + name);
+    ExecExpressionPtr array;
+    if(method == ExecArrayMethod::Count)
+        array = compileExpression(base);
+    else if(!(array = compileLValue(base)))
+        unsupported(base, L"mutating method on immutable value");
+    ExecArrayMethod* ret = new ExecArrayMethod(method, array.release());
+    ExecExpressionPtr holder(ret);
+    ret->sourceInfo = *node->getSourceInfo();
+    if(!arguments.empty())
+        ret->argument = compileExpression(arguments[0]);
+    return holder;
+}
+
+void Evaluator::compileArguments(ExecCall* call, const TypePtr& type, const std::vector<ExpressionPtr>& arguments)
+{
+    const vector<Parameter>& params = type->getParameters();
+    for(size_t i = 0; i < arguments.size(); i++)
+    {
+        ExpressionPtr arg = arguments[i];
+        if(!params[i].inout)
+        {
+            call->arguments.push_back(compileExpression(arg));
+            continue;
+        }
+        if(arg->getNodeType() == NodeType::InOut)
+            arg = static_pointer_cast<InOutParameter>(arg)->getOperand();
+        ExecLValuePtr lvalue = compileLValue(arg);
+        if(!lvalue)
+            unsupported(arg, L"inout argument");
+        call->inout.resize(arguments.size());
+        call->inout[i] = true;
+        call->arguments.push_back(std::move(lvalue));
+    }
+}
+
+bool Evaluator::isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    //operators on primitive types are declared by GlobalScope without definitions, ++/-- are not flagged as operators
+    if(func->getDefinition() || getFunction(func))
+        return false;
+    IntegerFormat format;
+    for(const Parameter& param : func->getType()->getParameters())
+    {
+        if(!getIntegerFormat(global, param.type, format) && !isFloating(global, param.type) && param.type != global->Bool() && param.type != global->String())
+            return false;
+    }
+    ExecOperator::T op;
+    return ExecOperator::fromName(func->getName(), arguments.size(), op);
+}
+
+ExecExpressionPtr Evaluator::compileBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    const wstring& name = func->getName();
+    TypePtr operandType = func->getType()->getParameters()[0].type;
+    ExecOperator::T op;
+    ExecOperator::fromName(name, arguments.size(), op);
+    IntegerFormat format;
+    bool isInteger = getIntegerFormat(global, operandType, format) || operandType == global->Bool();
+    ExecExpressionPtr ret;
+    if(name == L"++" || name == L"--")
+    {
+        ExpressionPtr operand = arguments[0];
+        if(operand->getNodeType() == NodeType::InOut)
+            operand = static_pointer_cast<InOutParameter>(operand)->getOperand();
+        ExecLValuePtr target = compileLValue(operand);
+        if(!target || !isInteger)
+            unsupported(operand, name);
+        ExecIncrement* increment = new ExecIncrement(target.release(), name == L"++" ? 1 : -1, InterpreterUtils::hasFlag(func, SymbolFlagPostfix));
+        ret.reset(increment);
+        increment->format = format;
+        increment->sourceInfo = *node->getSourceInfo();
+        increment->typeName = operandType->toString();
+        return ret;
+    }
+    ExecExpressionPtr lhs = compileExpression(arguments[0]);
+    ExecExpressionPtr rhs;
+    if(arguments.size() == 2)
+        rhs = compileExpression(arguments[1]);
+    if(name == L"+" && arguments.size() == 1)
+        return lhs;
+    if(name == L"&&" || name == L"||" || (name == L"!" && operandType == global->Bool()))
+        return ExecExpressionPtr(new ExecLogicalOperator(op, lhs.release(), rhs.release()));
+    if(operandType == global->String())
+    {
+        if(op != ExecOperator::Add && op != ExecOperator::Equal && op != ExecOperator::NotEqual)
+            unsupported(node, name);
+        return ExecExpressionPtr(new ExecStringOperator(op, lhs.release(), rhs.release()));
+    }
+    if(isFloating(global, operandType))
+        return ExecExpressionPtr(new ExecFloatingOperator(op, operandType == global->Float(), lhs.release(), rhs.release()));
+    if(op == ExecOperator::Not)
+    {
+        //bitwise not flips the bits of the representation
+        op = ExecOperator::Xor;
+        int64_t mask = format.isSigned || format.bits == 64 ? -1 : (int64_t)((1ULL << format.bits) - 1);
+        rhs.reset(new ExecConstant(Value::makeInt(mask)));
+    }
+    ExecIntegerOperator* integer = new ExecIntegerOperator(op, format, lhs.release(), rhs.release());
+    ret.reset(integer);
+    integer->sourceInfo = *node->getSourceInfo();
+    integer->typeName = operandType->toString();
+    return ret;
+}
+
+bool Evaluator::getIntegerFormat(GlobalScope* global, const TypePtr& type, IntegerFormat& format)
+{
+    static const struct
+    {
+        TypePtr (GlobalScope::*type)() const;
+        int bits;
+        bool isSigned;
+    } formats[] = {
+        {&GlobalScope::Int, 64, true}, {&GlobalScope::UInt, 64, false},
+        {&GlobalScope::Int8, 8, true}, {&GlobalScope::UInt8, 8, false},
+        {&GlobalScope::Int16, 16, true}, {&GlobalScope::UInt16, 16, false},
+        {&GlobalScope::Int32, 32, true}, {&GlobalScope::UInt32, 32, false},
+        {&GlobalScope::Int64, 64, true}, {&GlobalScope::UInt64, 64, false},
+        {nullptr, 0, false}
+    };
+    for(int i = 0; formats[i].type; i++)
+    {
+        if(type == (global->*formats[i].type)())
+        {
+            format = IntegerFormat(formats[i].bits, formats[i].isSigned);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Evaluator::isFloating(GlobalScope* global, const TypePtr& type)
+{
+    return type == global->Double() || type == global->Float() || type == global->Float80();
+}
+
+void Evaluator::visitBinaryOperator(const BinaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!func || !lhs || !rhs)
+        unsupported(node, node->getOperator());
+    result = compileCall(node, func, nullptr, {lhs, rhs});
+}
+
+void Evaluator::visitUnaryOperator(const UnaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    if(!func)
+        unsupported(node, node->getOperator());
+    result = compileCall(node, func, nullptr, {node->getOperand()});
+}
+
+void Evaluator::visitAssignment(const AssignmentPtr& node)
+{
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!lhs || !rhs)
+        unsupported(node, L"assignment to pattern");
+    SymbolPtr sym;
+    if(lhs->getNodeType() == NodeType::Identifier)
+        sym = InterpreterUtils::resolveIdentifier(static_pointer_cast<Identifier>(lhs), ctx->scopes, ctx->selfType);
+    else
+        sym = lhs->getReferencedSymbol();
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        ExpressionPtr base;
+        if(lhs->getNodeType() == NodeType::MemberAccess)
+            base = static_pointer_cast<MemberAccess>(lhs)->getSelf();
+        if(!property->getSetter())
+            unsupported(lhs, L"assignment target");
+        result = compileCall(node, property->getSetter(), base, {rhs});
+        return;
+    }
+    ExecLValuePtr target = compileLValue(lhs);
+    if(!target)
+        unsupported(lhs, L"assignment target");
+    ExecExpressionPtr value = compileExpression(rhs);
+    result.reset(new ExecAssign(target.release(), value.release()));
+}
+
+void Evaluator::visitConditionalOperator(const ConditionalOperatorPtr& node)
+{
+    ExpressionPtr condition = dynamic_pointer_cast<Expression>(node->getCondition());
+    if(!condition)
+        unsupported(node, L"conditional pattern");
+    ExecConditional* ret = new ExecConditional();
+    ExecNodePtr holder(ret);
+    ret->condition = compileCondition(condition);
+    ret->trueValue = compileExpression(node->getTrueExpression());
+    ret->falseValue = compileExpression(node->getFalseExpression());
+    result = std::move(holder);
+}
+
+void Evaluator::visitTuple(const TuplePtr& node)
+{
+    ExecInstance* ret = new ExecInstance(nullptr);
+    ExecNodePtr holder(ret);
+    for(const PatternPtr& element : *node)
+        ret->fields.push_back(compileExpression(element));
+    result = std::move(holder);
+}
+
+void Evaluator::visitParenthesizedExpression(const ParenthesizedExpressionPtr& node)
+{
+    if(node->numExpressions() == 1)
+    {
+        result = compileExpression(node->get(0));
+        return;
+    }
+    ExecInstance* ret = new ExecInstance(nullptr);
+    ExecNodePtr holder(ret);
+    for(const ParenthesizedExpression::Term& term : *node)
+        ret->fields.push_back(compileExpression(term.expression));
+    result = std::move(holder);
+}
+
+void Evaluator::visitArrayLiteral(const ArrayLiteralPtr& node)
+{
+    if(!global->isArray(node->getType()))
+        unsupported(node, L"array literal of " + node->getType()->toString());
+    ExecArrayLiteral* ret = new ExecArrayLiteral();
+    ExecNodePtr holder(ret);
+    for(int i = 0; i < node->numElements(); i++)
+        ret->elements.push_back(compileExpression(node->getElement(i)));
+    result = std::move(holder);
+}
+
+void Evaluator::visitSubscriptAccess(const SubscriptAccessPtr& node)
+{
+    if(!global->isArray(node->getSelf()->getType()) || node->getIndex()->numExpressions() != 1)
+        unsupported(node, L"subscript");
+    ExecExpressionPtr base = compileExpression(node->getSelf());
+    ExecExpressionPtr index = compileExpression(node->getIndex()->get(0));
+    ExecArrayElement* ret = new ExecArrayElement(base.release(), index.release());
+    result.reset(ret);
+    ret->sourceInfo = *node->getSourceInfo();
+}
+
+Function* Evaluator::getClosureFunction(const NodePtr& node)
+{
+    //a closure is compiled again when its enclosing function is, the function is reused
+    auto iter = closures.find(node.get());
+    if(iter != closures.end())
+        return iter->second;
+    Function* ret = new Function();
+    functions.push_back(unique_ptr<Function>(ret));
+    closures.insert(make_pair(node.get(), ret));
+    return ret;
+}
+
+void Evaluator::visitClosure(const ClosurePtr& node)
+{
+    if(node->getCapture())
+        unsupported(node, L"capture list");
+    Function* function = getClosureFunction(node);
+    function->name = L"closure";
+    function->closure = node;
+    function->parameters.clear();
+    if(node->getParameters())
+        function->parameters.assign(node->getParameters()->begin(), node->getParameters()->end());
+    function->numParameters = (int)function->parameters.size();
+    if(node->getType()->getParameters().size() != function->parameters.size())
+        unsupported(node, L"closure with implicit parameters");
+    ExecMakeClosure* ret = new ExecMakeClosure(function);
+    ExecNodePtr holder(ret);
+    compileFunction(function, ctx, &ret->captures);
+    result = std::move(holder);
+}
+
+void Evaluator::visitInteger(const IntegerLiteralPtr& node)
+{
+    TypePtr type = node->getType();
+    //integer literal can be inferred as a floating number
+    if(isFloating(global, type))
+        result.reset(new ExecConstant(Value::makeDouble((double)node->value)));
+    else
+        result.reset(new ExecConstant(Value::makeInt(node->value)));
+}
+
+void Evaluator::visitFloat(const FloatLiteralPtr& node)
+{
+    double value = node->value;
+    if(node->getType() == global->Float())
+        value = (float)value;
+    result.reset(new ExecConstant(Value::makeDouble(value)));
+}
+
+void Evaluator::visitString(const StringLiteralPtr& node)
+{
+    result.reset(new ExecConstant(Value::makeString(node->toString())));
+}
+
+void Evaluator::visitBooleanLiteral(const BooleanLiteralPtr& node)
+{
+    result.reset(new ExecConstant(Value::makeBool(node->getValue())));
+}
+
+void Evaluator::visitStringInterpolation(const StringInterpolationPtr& node)
+{
+    ExecStringInterpolation* ret = new ExecStringInterpolation();
+    ExecNodePtr holder(ret);
+    for(const ExpressionPtr& expr : *node)
+    {
+        ret->parts.push_back(compileExpression(expr));
+        ret->types.push_back(expr->getType());
+    }
+    result = std::move(holder);
+}
+
+void Evaluator::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
+{
+    unsupported(node, L"dictionary literal");
+}
+
+void Evaluator::visitCompileConstant(const CompileConstantPtr& node)
+{
+    unsupported(node, L"compile constant");
+}
+
+void Evaluator::visitSelf(const SelfExpressionPtr& node)
+{
+    unsupported(node, L"self expression");
+}
+
+void Evaluator::visitInitializerReference(const InitializerReferencePtr& node)
+{
+    unsupported(node, L"initializer reference");
+}
+
+void Evaluator::visitDynamicType(const DynamicTypePtr& node)
+{
+    unsupported(node, L"dynamicType");
+}
+
+void Evaluator::visitForcedValue(const ForcedValuePtr& node)
+{
+    unsupported(node, L"forced value");
+}
+
+void Evaluator::visitOptionalChaining(const OptionalChainingPtr& node)
+{
+    unsupported(node, L"optional chaining");
+}
+
+void Evaluator::visitNilLiteral(const NilLiteralPtr& node)
+{
+    unsupported(node, L"nil");
+}
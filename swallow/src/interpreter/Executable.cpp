@@ -0,0 +1,771 @@
+/* Executable.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/Executable.h"
+#include "interpreter/Evaluator.h"
+#include "common/Errors.h"
+#include <cmath>
+#include <limits>
+
+USE_SWALLOW_NS
+using namespace std;
+
+int RuntimeType::getFieldIndex(const SymbolPtr& field) const
+{
+    for(size_t i = 0; i < fields.size(); i++)
+    {
+        if(fields[i] == field)
+            return (int)i;
+    }
+    return -1;
+}
+
+SlotsGuard::SlotsGuard(Evaluator* evaluator, int count)
+:evaluator(evaluator), count(count)
+{
+    slots = evaluator->allocateSlots(count);
+}
+
+SlotsGuard::~SlotsGuard()
+{
+    evaluator->releaseSlots(slots, count);
+}
+
+/*********************************************************************
+ * Statements
+ *********************************************************************/
+
+Flow::T ExecBlock::execute(Frame& frame)
+{
+    for(const ExecNodePtr& st : statements)
+    {
+        Flow::T flow = st->execute(frame);
+        if(flow != Flow::Normal)
+            return flow;
+    }
+    return Flow::Normal;
+}
+
+Flow::T ExecIf::execute(Frame& frame)
+{
+    if(condition->evaluateBool(frame))
+        return thenPart->execute(frame);
+    if(elsePart)
+        return elsePart->execute(frame);
+    return Flow::Normal;
+}
+
+Flow::T ExecLoop::execute(Frame& frame)
+{
+    if(testFirst && condition && !condition->evaluateBool(frame))
+        return Flow::Normal;
+    while(true)
+    {
+        Flow::T flow = body->execute(frame);
+        if(flow == Flow::Break)
+            break;
+        if(flow == Flow::Return)
+            return flow;
+        if(step)
+            step->execute(frame);
+        if(condition && !condition->evaluateBool(frame))
+            break;
+    }
+    return Flow::Normal;
+}
+
+Flow::T ExecReturn::execute(Frame& frame)
+{
+    if(value)
+        frame.result = value->evaluate(frame);
+    return Flow::Return;
+}
+
+Flow::T ExecDeclare::execute(Frame& frame)
+{
+    Value value;
+    if(initializer)
+        value = initializer->evaluate(frame);
+    if(boxed)
+        frame.slots[slot] = Value::makeBox(value);
+    else
+        frame.slots[slot] = std::move(value);
+    return Flow::Normal;
+}
+
+Flow::T ExecSwitch::execute(Frame& frame)
+{
+    frame.slots[slot] = control->evaluate(frame);
+    int target = defaultCase;
+    if(isEnum)
+    {
+        auto iter = enumCases.find(frame.slots[slot].index);
+        if(iter != enumCases.end())
+            target = iter->second;
+    }
+    else
+    {
+        for(const auto& pattern : patterns)
+        {
+            if(frame.slots[slot].equals(pattern.first->evaluate(frame)))
+            {
+                target = pattern.second;
+                break;
+            }
+        }
+    }
+    if(target < 0)
+        return Flow::Normal;
+    Flow::T flow = bodies[target]->execute(frame);
+    //break leaves the switch
+    return flow == Flow::Break ? Flow::Normal : flow;
+}
+
+/*********************************************************************
+ * Storage
+ *********************************************************************/
+
+Value* ExecField::getAddress(Frame& frame, Value& owner)
+{
+    Value* storage = base->getAddress(frame, owner);
+    InstanceObject* instance = static_cast<InstanceObject*>(storage->makeUnique());
+    return &instance->fields[index];
+}
+
+const Value& ExecField::read(Frame& frame, Value& owner)
+{
+    const Value& value = base->read(frame, owner);
+    return static_cast<InstanceObject*>(value.object)->fields[index];
+}
+
+Value* ExecReferenceField::getAddress(Frame& frame, Value& owner)
+{
+    owner = base->evaluate(frame);
+    return &static_cast<InstanceObject*>(owner.object)->fields[index];
+}
+
+const Value& ExecReferenceField::read(Frame& frame, Value& owner)
+{
+    owner = base->evaluate(frame);
+    return static_cast<InstanceObject*>(owner.object)->fields[index];
+}
+
+Value ExecAssign::evaluate(Frame& frame)
+{
+    Value v = value->evaluate(frame);
+    Value owner;
+    *target->getAddress(frame, owner) = std::move(v);
+    return Value();
+}
+
+/*********************************************************************
+ * Operators
+ *********************************************************************/
+
+bool ExecOperator::fromName(const wstring& op, size_t numArguments, T& ret)
+{
+    static const struct
+    {
+        const wchar_t* name;
+        T op;
+    } binaries[] = {
+        {L"+", Add}, {L"-", Sub}, {L"*", Mul}, {L"/", Div}, {L"%", Rem},
+        {L"&+", WrappingAdd}, {L"&-", WrappingSub}, {L"&*", WrappingMul},
+        {L"&/", WrappingDiv}, {L"&%", WrappingRem},
+        {L"==", Equal}, {L"!=", NotEqual}, {L"<", Less}, {L"<=", LessEqual},
+        {L">", Greater}, {L">=", GreaterEqual},
+        {L"&", And}, {L"|", Or}, {L"^", Xor},
+        {L"<<", ShiftLeft}, {L">>", ShiftRight},
+        {L"&&", And}, {L"||", Or},
+        {nullptr, Add}
+    };
+    if(numArguments == 2)
+    {
+        for(int i = 0; binaries[i].name; i++)
+        {
+            if(op == binaries[i].name)
+            {
+                ret = binaries[i].op;
+                return true;
+            }
+        }
+        return false;
+    }
+    if(op == L"-")
+        ret = Negate;
+    else if(op == L"!" || op == L"~")
+        ret = Not;
+    else if(op == L"+" || op == L"++" || op == L"--")
+        ret = Add;
+    else
+        return false;
+    return true;
+}
+
+const wchar_t* ExecOperator::getName(T op)
+{
+    static const wchar_t* names[] = {
+        L"+", L"-", L"*", L"/", L"%",
+        L"&+", L"&-", L"&*", L"&/", L"&%",
+        L"&", L"|", L"^", L"<<", L">>",
+        L"==", L"!=", L"<", L"<=", L">", L">=",
+        L"-", L"!"
+    };
+    return names[op];
+}
+
+/*!
+ * Truncates the bits to the integer format, used by the wrapping operators
+ */
+static inline int64_t truncate(uint64_t value, const IntegerFormat& format)
+{
+    if(format.bits < 64)
+    {
+        uint64_t mask = (1ULL << format.bits) - 1;
+        value &= mask;
+        if(format.isSigned && ((value >> (format.bits - 1)) & 1))
+            value |= ~mask;
+    }
+    return (int64_t)value;
+}
+
+/*!
+ * Checks if the exact result of an operation on narrow integers can be represented
+ */
+static inline bool inRange(int64_t value, const IntegerFormat& format)
+{
+    if(format.isSigned)
+        return value >= -(1LL << (format.bits - 1)) && value < (1LL << (format.bits - 1));
+    return value >= 0 && value < (1LL << format.bits);
+}
+
+bool ExecOperator::calculate(T op, const IntegerFormat& format, int64_t a, int64_t b, int64_t& r)
+{
+    bool unsigned64 = !format.isSigned && format.bits == 64;
+    bool overflow = false;
+    switch(op)
+    {
+        case ExecOperator::Add:
+            if(unsigned64)
+                overflow = __builtin_add_overflow((uint64_t)a, (uint64_t)b, (uint64_t*)&r);
+            else
+                overflow = __builtin_add_overflow(a, b, &r);
+            break;
+        case ExecOperator::Sub:
+            if(unsigned64)
+                overflow = __builtin_sub_overflow((uint64_t)a, (uint64_t)b, (uint64_t*)&r);
+            else
+                overflow = __builtin_sub_overflow(a, b, &r);
+            break;
+        case ExecOperator::Mul:
+            if(unsigned64)
+                overflow = __builtin_mul_overflow((uint64_t)a, (uint64_t)b, (uint64_t*)&r);
+            else
+                overflow = __builtin_mul_overflow(a, b, &r);
+            break;
+        case ExecOperator::Div:
+        case ExecOperator::Rem:
+        case ExecOperator::WrappingDiv:
+        case ExecOperator::WrappingRem:
+        {
+            bool rem = op == ExecOperator::Rem || op == ExecOperator::WrappingRem;
+            if(unsigned64)
+                r = (int64_t)(rem ? (uint64_t)a % (uint64_t)b : (uint64_t)a / (uint64_t)b);
+            else if(a == numeric_limits<int64_t>::min() && b == -1)
+            {
+                r = rem ? 0 : a;
+                overflow = !rem;
+            }
+            else
+                r = rem ? a % b : a / b;
+            if(op == ExecOperator::WrappingDiv || op == ExecOperator::WrappingRem)
+            {
+                r = truncate((uint64_t)r, format);
+                return true;
+            }
+            break;
+        }
+        case ExecOperator::WrappingAdd:
+            r = truncate((uint64_t)a + (uint64_t)b, format);
+            return true;
+        case ExecOperator::WrappingSub:
+            r = truncate((uint64_t)a - (uint64_t)b, format);
+            return true;
+        case ExecOperator::WrappingMul:
+            r = truncate((uint64_t)a * (uint64_t)b, format);
+            return true;
+        case ExecOperator::And:
+            r = a & b;
+            return true;
+        case ExecOperator::Or:
+            r = a | b;
+            return true;
+        case ExecOperator::Xor:
+            r = a ^ b;
+            return true;
+        case ExecOperator::ShiftLeft:
+            r = b < 0 || b >= format.bits ? 0 : truncate((uint64_t)a << b, format);
+            return true;
+        case ExecOperator::ShiftRight:
+            if(b < 0 || b >= format.bits)
+                r = format.isSigned && a < 0 ? -1 : 0;
+            else
+                r = format.isSigned ? a >> b : (int64_t)((uint64_t)a >> b);
+            return true;
+        case ExecOperator::Negate:
+            if(unsigned64)
+            {
+                r = -a;
+                overflow = a != 0;
+            }
+            else
+                overflow = __builtin_sub_overflow((int64_t)0, a, &r);
+            break;
+        default:
+            return false;
+    }
+    if(overflow)
+        return false;
+    return format.bits == 64 || inRange(r, format);
+}
+
+bool ExecOperator::compare(T op, const IntegerFormat& format, int64_t a, int64_t b)
+{
+    if(!format.isSigned && format.bits == 64)
+    {
+        uint64_t ua = (uint64_t)a;
+        uint64_t ub = (uint64_t)b;
+        switch(op)
+        {
+            case Less:
+                return ua < ub;
+            case LessEqual:
+                return ua <= ub;
+            case Greater:
+                return ua > ub;
+            case GreaterEqual:
+                return ua >= ub;
+            default:
+                break;
+        }
+    }
+    switch(op)
+    {
+        case Equal:
+            return a == b;
+        case NotEqual:
+            return a != b;
+        case Less:
+            return a < b;
+        case LessEqual:
+            return a <= b;
+        case Greater:
+            return a > b;
+        case GreaterEqual:
+            return a >= b;
+        default:
+            return false;
+    }
+}
+
+double ExecOperator::calculate(T op, bool isFloat, double a, double b)
+{
+    double r;
+    switch(op)
+    {
+        case Add:
+        case WrappingAdd:
+            r = a + b;
+            break;
+        case Sub:
+        case WrappingSub:
+            r = a - b;
+            break;
+        case Mul:
+        case WrappingMul:
+            r = a * b;
+            break;
+        case Div:
+        case WrappingDiv:
+            r = a / b;
+            break;
+        case Rem:
+        case WrappingRem:
+            r = fmod(a, b);
+            break;
+        case Negate:
+            r = -a;
+            break;
+        default:
+            r = 0;
+            break;
+    }
+    if(isFloat)
+        r = (float)r;
+    return r;
+}
+
+bool ExecOperator::compare(T op, double a, double b)
+{
+    switch(op)
+    {
+        case Equal:
+            return a == b;
+        case NotEqual:
+            return a != b;
+        case Less:
+            return a < b;
+        case LessEqual:
+            return a <= b;
+        case Greater:
+            return a > b;
+        case GreaterEqual:
+            return a >= b;
+        default:
+            return false;
+    }
+}
+
+Value ExecIntegerOperator::evaluate(Frame& frame)
+{
+    if(ExecOperator::isComparison(op))
+        return Value::makeBool(evaluateBool(frame));
+    return Value::makeInt(evaluateInt(frame));
+}
+
+int64_t ExecIntegerOperator::evaluateInt(Frame& frame)
+{
+    int64_t a = lhs->evaluateInt(frame);
+    int64_t b = rhs ? rhs->evaluateInt(frame) : 0;
+    int64_t r;
+    //fast path of Int
+    if(format.bits == 64 && format.isSigned)
+    {
+        switch(op)
+        {
+            case ExecOperator::Add:
+                if(!__builtin_add_overflow(a, b, &r))
+                    return r;
+                break;
+            case ExecOperator::Sub:
+                if(!__builtin_sub_overflow(a, b, &r))
+                    return r;
+                break;
+            case ExecOperator::Mul:
+                if(!__builtin_mul_overflow(a, b, &r))
+                    return r;
+                break;
+            default:
+                break;
+        }
+    }
+    if(b == 0 && (op == ExecOperator::Div || op == ExecOperator::Rem))
+        frame.evaluator->runtimeError(sourceInfo, Errors::E_DIVISION_BY_ZERO);
+    if(b == 0 && (op == ExecOperator::WrappingDiv || op == ExecOperator::WrappingRem))
+        return 0;
+    if(!ExecOperator::calculate(op, format, a, b, r))
+        frame.evaluator->runtimeError(sourceInfo, Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, ExecOperator::getName(op), typeName);
+    return r;
+}
+
+bool ExecIntegerOperator::evaluateBool(Frame& frame)
+{
+    int64_t a = lhs->evaluateInt(frame);
+    int64_t b = rhs->evaluateInt(frame);
+    return ExecOperator::compare(op, format, a, b);
+}
+
+Value ExecFloatingOperator::evaluate(Frame& frame)
+{
+    if(ExecOperator::isComparison(op))
+        return Value::makeBool(evaluateBool(frame));
+    return Value::makeDouble(evaluateDouble(frame));
+}
+
+double ExecFloatingOperator::evaluateDouble(Frame& frame)
+{
+    double a = lhs->evaluateDouble(frame);
+    double b = rhs ? rhs->evaluateDouble(frame) : 0;
+    return ExecOperator::calculate(op, isFloat, a, b);
+}
+
+bool ExecFloatingOperator::evaluateBool(Frame& frame)
+{
+    double a = lhs->evaluateDouble(frame);
+    double b = rhs->evaluateDouble(frame);
+    return ExecOperator::compare(op, a, b);
+}
+
+bool ExecLogicalOperator::evaluateBool(Frame& frame)
+{
+    switch(op)
+    {
+        case ExecOperator::And:
+            return lhs->evaluateBool(frame) && rhs->evaluateBool(frame);
+        case ExecOperator::Or:
+            return lhs->evaluateBool(frame) || rhs->evaluateBool(frame);
+        default:
+            return !lhs->evaluateBool(frame);
+    }
+}
+
+Value ExecStringOperator::evaluate(Frame& frame)
+{
+    Value a = lhs->evaluate(frame);
+    Value b = rhs->evaluate(frame);
+    switch(op)
+    {
+        case ExecOperator::Equal:
+            return Value::makeBool(a.equals(b));
+        case ExecOperator::NotEqual:
+            return Value::makeBool(!a.equals(b));
+        default:
+            return Value::makeString(a.getString() + b.getString());
+    }
+}
+
+int64_t ExecIncrement::evaluateInt(Frame& frame)
+{
+    Value owner;
+    Value* storage = target->getAddress(frame, owner);
+    int64_t old = storage->i;
+    int64_t r;
+    if(!ExecOperator::calculate(ExecOperator::Add, format, old, delta, r))
+        frame.evaluator->runtimeError(sourceInfo, Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, delta > 0 ? L"++" : L"--", typeName);
+    *storage = Value::makeInt(r);
+    return postfix ? old : r;
+}
+
+Value ExecConditional::evaluate(Frame& frame)
+{
+    return condition->evaluateBool(frame) ? trueValue->evaluate(frame) : falseValue->evaluate(frame);
+}
+
+int64_t ExecConditional::evaluateInt(Frame& frame)
+{
+    return condition->evaluateBool(frame) ? trueValue->evaluateInt(frame) : falseValue->evaluateInt(frame);
+}
+
+double ExecConditional::evaluateDouble(Frame& frame)
+{
+    return condition->evaluateBool(frame) ? trueValue->evaluateDouble(frame) : falseValue->evaluateDouble(frame);
+}
+
+/*********************************************************************
+ * Values
+ *********************************************************************/
+
+Value ExecInstance::evaluate(Frame& frame)
+{
+    InstanceObject* instance = new InstanceObject(type, fields.size());
+    Value ret = Value::makeObject(Value::Instance, instance);
+    for(size_t i = 0; i < fields.size(); i++)
+        instance->fields[i] = fields[i]->evaluate(frame);
+    return ret;
+}
+
+Value ExecEnum::evaluate(Frame& frame)
+{
+    if(!payload)
+        return Value::makeEnum(index, nullptr);
+    return Value::makeEnum(index, new BoxObject(payload->evaluate(frame)));
+}
+
+Value ExecEnumPayload::evaluate(Frame& frame)
+{
+    Value v = value->evaluate(frame);
+    return static_cast<BoxObject*>(v.object)->value;
+}
+
+Value ExecArrayLiteral::evaluate(Frame& frame)
+{
+    ArrayObject* array = new ArrayObject();
+    Value ret = Value::makeObject(Value::Array, array);
+    array->elements.reserve(elements.size());
+    for(const ExecExpressionPtr& element : elements)
+        array->elements.push_back(element->evaluate(frame));
+    return ret;
+}
+
+Value* ExecArrayElement::getAddress(Frame& frame, Value& owner)
+{
+    int64_t i = index->evaluateInt(frame);
+    Value* storage = static_cast<ExecLValue*>(base.get())->getAddress(frame, owner);
+    ArrayObject* array = static_cast<ArrayObject*>(storage->makeUnique());
+    if(i < 0 || i >= (int64_t)array->elements.size())
+        frame.evaluator->runtimeError(sourceInfo, Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+    return &array->elements[i];
+}
+
+const Value& ExecArrayElement::read(Frame& frame, Value& owner)
+{
+    int64_t i = index->evaluateInt(frame);
+    owner = base->evaluate(frame);
+    ArrayObject* array = static_cast<ArrayObject*>(owner.object);
+    if(i < 0 || i >= (int64_t)array->elements.size())
+        frame.evaluator->runtimeError(sourceInfo, Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+    return array->elements[i];
+}
+
+Value ExecArrayMethod::evaluate(Frame& frame)
+{
+    switch(method)
+    {
+        case Count:
+            return Value::makeInt(evaluateInt(frame));
+        case Append:
+        {
+            Value element = argument->evaluate(frame);
+            Value owner;
+            Value* storage = static_cast<ExecLValue*>(base.get())->getAddress(frame, owner);
+            static_cast<ArrayObject*>(storage->makeUnique())->elements.push_back(std::move(element));
+            return Value();
+        }
+        default:
+        {
+            Value owner;
+            Value* storage = static_cast<ExecLValue*>(base.get())->getAddress(frame, owner);
+            ArrayObject* array = static_cast<ArrayObject*>(storage->makeUnique());
+            if(array->elements.empty())
+                frame.evaluator->runtimeError(sourceInfo, Errors::E_CANNOT_REMOVE_LAST_ELEMENT_FROM_AN_EMPTY_COLLECTION);
+            Value ret = std::move(array->elements.back());
+            array->elements.pop_back();
+            return ret;
+        }
+    }
+}
+
+int64_t ExecArrayMethod::evaluateInt(Frame& frame)
+{
+    if(method != Count)
+        return evaluate(frame).i;
+    Value array = base->evaluate(frame);
+    return (int64_t)static_cast<ArrayObject*>(array.object)->elements.size();
+}
+
+Value ExecStringInterpolation::evaluate(Frame& frame)
+{
+    wstring ret;
+    for(size_t i = 0; i < parts.size(); i++)
+    {
+        Value v = parts[i]->evaluate(frame);
+        if(v.isString())
+            ret += v.getString();
+        else
+            ret += frame.evaluator->toString(v, types[i], false);
+    }
+    return Value::makeString(ret);
+}
+
+/*********************************************************************
+ * Calls
+ *********************************************************************/
+
+void ExecCall::prepareArguments(Frame& frame, Value* slots, std::vector<Value>& owners)
+{
+    if(!inout.empty())
+        owners.resize(arguments.size());
+    for(size_t i = 0; i < arguments.size(); i++)
+    {
+        if(!inout.empty() && inout[i])
+            slots[i] = Value::makeAddress(static_cast<ExecLValue*>(arguments[i].get())->getAddress(frame, owners[i]));
+        else
+            slots[i] = arguments[i]->evaluate(frame);
+    }
+}
+
+Value ExecCall::evaluate(Frame& frame)
+{
+    Value selfValue;
+    Value selfOwner;
+    if(self)
+    {
+        if(selfByAddress)
+            selfValue = Value::makeAddress(static_cast<ExecLValue*>(self.get())->getAddress(frame, selfOwner));
+        else
+            selfValue = self->evaluate(frame);
+    }
+    Function* target = getTarget(frame, selfValue);
+    SlotsGuard guard(frame.evaluator, target->numSlots);
+    vector<Value> owners;
+    prepareArguments(frame, guard.slots, owners);
+    if(target->selfSlot >= 0)
+        guard.slots[target->selfSlot] = std::move(selfValue);
+    return frame.evaluator->invoke(target, guard.slots, nullptr, sourceInfo);
+}
+
+Function* ExecVirtualCall::getTarget(Frame& frame, const Value& self)
+{
+    RuntimeType* type = static_cast<InstanceObject*>(self.object)->type;
+    if(type != cachedType)
+    {
+        cachedFunction = frame.evaluator->findOverride(type, function);
+        cachedType = type;
+    }
+    return cachedFunction;
+}
+
+Value ExecConstruct::evaluate(Frame& frame)
+{
+    Value instance = Value::makeObject(Value::Instance, new InstanceObject(type, type->fields.size()));
+    frame.evaluator->initializeFields(type, instance);
+    if(!function)
+        return instance;
+    SlotsGuard guard(frame.evaluator, function->numSlots);
+    vector<Value> owners;
+    prepareArguments(frame, guard.slots, owners);
+    guard.slots[function->selfSlot] = std::move(instance);
+    return frame.evaluator->invoke(function, guard.slots, nullptr, sourceInfo);
+}
+
+Value ExecClosureCall::evaluate(Frame& frame)
+{
+    Value value = callee->evaluate(frame);
+    ClosureObject* closure = static_cast<ClosureObject*>(value.object);
+    Function* target = closure->function;
+    SlotsGuard guard(frame.evaluator, target->numSlots);
+    vector<Value> owners;
+    prepareArguments(frame, guard.slots, owners);
+    return frame.evaluator->invoke(target, guard.slots, closure, sourceInfo);
+}
+
+Value ExecMakeClosure::evaluate(Frame& frame)
+{
+    ClosureObject* closure = new ClosureObject(function);
+    Value ret = Value::makeObject(Value::Closure, closure);
+    closure->captures.reserve(captures.size());
+    for(const Capture& capture : captures)
+    {
+        if(capture.local)
+            closure->captures.push_back(frame.slots[capture.index]);
+        else
+            closure->captures.push_back(frame.closure->captures[capture.index]);
+    }
+    return ret;
+}
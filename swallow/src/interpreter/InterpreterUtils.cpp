@@ -0,0 +1,188 @@
+/* InterpreterUtils.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/InterpreterUtils.h"
+#include "ast/ast.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include <cassert>
+
+USE_SWALLOW_NS
+using namespace std;
+
+bool InterpreterUtils::hasFlag(const FunctionSymbolPtr& func, SymbolFlags flag)
+{
+    return func->hasFlags(flag) || (func->getType() && func->getType()->hasFlags(flag));
+}
+
+TypePtr InterpreterUtils::getOwnerType(const SymbolPtr& symbol)
+{
+    TypePtr type = symbol->getDeclaringType();
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    return type;
+}
+
+bool InterpreterUtils::isInitializer(const FunctionSymbolPtr& func)
+{
+    return func->getRole() == FunctionRoleInit || hasFlag(func, SymbolFlagInit);
+}
+
+bool InterpreterUtils::isStoredProperty(const SymbolPtr& symbol)
+{
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(symbol);
+    return s && s->getRole() == SymbolPlaceHolder::R_PROPERTY && !s->hasFlags(SymbolFlagStatic);
+}
+
+bool InterpreterUtils::isGlobalVariable(const SymbolPtr& symbol)
+{
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(symbol);
+    if(!s)
+        return false;
+    if(s->getRole() == SymbolPlaceHolder::R_TOP_LEVEL_VARIABLE)
+        return true;
+    return s->getRole() == SymbolPlaceHolder::R_PROPERTY && s->hasFlags(SymbolFlagStatic);
+}
+
+void InterpreterUtils::getStoredProperties(const TypePtr& type, vector<SymbolPtr>& properties)
+{
+    for(const SymbolPtr& sym : type->getDeclaredStoredProperties())
+    {
+        if(!dynamic_pointer_cast<SymbolPlaceHolder>(sym) || sym->hasFlags(SymbolFlagTemporary))
+            continue;
+        properties.push_back(sym);
+    }
+}
+
+bool InterpreterUtils::isSelfIdentifier(const ExpressionPtr& expr)
+{
+    if(!expr || expr->getNodeType() != NodeType::Identifier)
+        return false;
+    const wstring& name = static_pointer_cast<Identifier>(expr)->getIdentifier();
+    return name == L"self" || name == L"super";
+}
+
+void InterpreterUtils::getArguments(const ParenthesizedExpressionPtr& args, vector<ExpressionPtr>& ret)
+{
+    if(!args)
+        return;
+    for(const ParenthesizedExpression::Term& term : *args)
+        ret.push_back(term.transformedExpression ? term.transformedExpression : term.expression);
+}
+
+SymbolPtr InterpreterUtils::resolveIdentifier(const IdentifierPtr& id, const vector<SymbolScope*>& scopes, const TypePtr& selfType)
+{
+    if(SymbolPtr ret = id->getReferencedSymbol())
+        return ret;
+    const wstring& name = id->getIdentifier();
+    for(auto iter = scopes.rbegin(); iter != scopes.rend(); iter++)
+    {
+        for(SymbolScope* scope = *iter; scope; scope = scope->getParentScope())
+        {
+            if(SymbolPtr ret = scope->lookup(name))
+                return ret;
+        }
+    }
+    if(selfType)
+        return selfType->getMember(name);
+    return nullptr;
+}
+
+bool InterpreterUtils::getEnumCasePattern(const PatternPtr& condition, wstring& name, TuplePtr& binding)
+{
+    PatternPtr pattern = condition;
+    if(pattern->getNodeType() == NodeType::ValueBindingPattern)
+        pattern = static_pointer_cast<ValueBindingPattern>(pattern)->getBinding();
+    switch(pattern->getNodeType())
+    {
+        case NodeType::Identifier:
+            name = static_pointer_cast<Identifier>(pattern)->getIdentifier();
+            return true;
+        case NodeType::EnumCasePattern:
+        {
+            EnumCasePatternPtr ec = static_pointer_cast<EnumCasePattern>(pattern);
+            name = ec->getName();
+            binding = ec->getAssociatedBinding();
+            return true;
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(pattern);
+            if(!ma->getField())
+                return false;
+            name = ma->getField()->getIdentifier();
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool InterpreterUtils::isEnumCaseReference(const SymbolPtr& sym, const TypePtr& type, const wstring& name)
+{
+    if(!type || type->getCategory() != Type::Enum || !type->getEnumCase(name))
+        return false;
+    if(!sym)
+        return true;
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(sym);
+    return s && s->hasFlags(SymbolFlagStatic) && s->getRole() == SymbolPlaceHolder::R_PARAMETER;
+}
+
+bool InterpreterUtils::sameSignature(const TypePtr& lhs, const TypePtr& rhs)
+{
+    const vector<Parameter>& params1 = lhs->getParameters();
+    const vector<Parameter>& params2 = rhs->getParameters();
+    if(params1.size() != params2.size() || !Type::equals(lhs->getReturnType(), rhs->getReturnType()))
+        return false;
+    for(size_t i = 0; i < params1.size(); i++)
+    {
+        if(params1[i].name != params2[i].name || params1[i].inout != params2[i].inout || !Type::equals(params1[i].type, params2[i].type))
+            return false;
+    }
+    return true;
+}
+
+vector<ParameterNodePtr> InterpreterUtils::getParameters(const FunctionDefPtr& node)
+{
+    vector<ParameterNodePtr> ret;
+    if(node->numParameters())
+        ret.assign(node->getParameters(0)->begin(), node->getParameters(0)->end());
+    return ret;
+}
+
+uint32_t InterpreterUtils::getEnumCaseIndex(const TypePtr& type, const std::wstring& name)
+{
+    const Type::EnumCaseMap& cases = type->getEnumCases();
+    auto iter = cases.find(name);
+    assert(iter != cases.end());
+    return (uint32_t)distance(cases.begin(), iter);
+}
@@ -0,0 +1,139 @@
+/* Value.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/Value.h"
+#include "interpreter/Executable.h"
+#include "interpreter/Evaluator.h"
+
+USE_SWALLOW_NS
+using namespace std;
+
+Value Value::makeString(const std::wstring& str)
+{
+    Value ret;
+    if(str.size() <= MaxInlineLength)
+    {
+        bool latin1 = true;
+        for(wchar_t ch : str)
+            latin1 = latin1 && (unsigned)ch < 0x100;
+        if(latin1)
+        {
+            ret.kind = InlineString;
+            ret.length = (uint8_t)str.size();
+            for(size_t i = 0; i < str.size(); i++)
+                ret.chars[i] = (char)str[i];
+            return ret;
+        }
+    }
+    ret.kind = String;
+    ret.object = new StringObject(str);
+    return ret;
+}
+
+Value Value::makeBox(const Value& value)
+{
+    return makeObject(Box, new BoxObject(value));
+}
+
+std::wstring Value::getString() const
+{
+    if(kind == InlineString)
+    {
+        wstring ret(length, L' ');
+        for(int i = 0; i < length; i++)
+            ret[i] = (unsigned char)chars[i];
+        return ret;
+    }
+    if(kind == String)
+        return static_cast<StringObject*>(object)->value;
+    return wstring();
+}
+
+Value* Value::getReferent() const
+{
+    if(kind == Address)
+        return address;
+    return &static_cast<BoxObject*>(object)->value;
+}
+
+Object* Value::makeUnique()
+{
+    if(!object->isUnique())
+    {
+        Object* copy = object->clone();
+        object->release();
+        object = copy;
+    }
+    return object;
+}
+
+bool Value::equals(const Value& rhs) const
+{
+    if(isString() && rhs.isString())
+    {
+        if(kind == InlineString && rhs.kind == InlineString)
+            return length == rhs.length && i == rhs.i;
+        return getString() == rhs.getString();
+    }
+    if(kind == Double)
+        return d == rhs.d;
+    return i == rhs.i;
+}
+
+Object* ArrayObject::clone() const
+{
+    ArrayObject* ret = new ArrayObject();
+    ret->elements = elements;
+    return ret;
+}
+
+Object* InstanceObject::clone() const
+{
+    InstanceObject* ret = new InstanceObject(type, 0);
+    ret->fields = fields;
+    return ret;
+}
+
+void InstanceObject::destroy()
+{
+    if(type && type->evaluator)
+    {
+        //keep it alive while the deinitializer is running
+        refCount = 1;
+        type->evaluator->deinitialize(this);
+    }
+    delete this;
+}
+
+Object* ClosureObject::clone() const
+{
+    ClosureObject* ret = new ClosureObject(function);
+    ret->captures = captures;
+    return ret;
+}
@@ -0,0 +1,686 @@
+/* VirtualMachine.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "interpreter/VirtualMachine.h"
+#include "interpreter/BytecodeCompiler.h"
+#include "interpreter/Evaluator.h"
+#include "interpreter/InterpreterUtils.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include <sstream>
+#include <cassert>
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+static_assert(sizeof(BCInstruction) == 8, "instruction is expected in 8 bytes");
+
+#if defined(__GNUC__) && !defined(SWALLOW_NO_COMPUTED_GOTO)
+#define SWALLOW_COMPUTED_GOTO 1
+#endif
+
+const char* BCOpcode::getName(T opcode)
+{
+#define SWALLOW_BYTECODE_NAME(name) #name,
+    static const char* names[] = {SWALLOW_BYTECODE_OPCODES(SWALLOW_BYTECODE_NAME) nullptr};
+#undef SWALLOW_BYTECODE_NAME
+    if(opcode >= NumOpcodes)
+        return "?";
+    return names[opcode];
+}
+
+/*!
+ * Primitive results are written into the register directly, an object it refers to is released first
+ */
+static inline void setInt(Value& v, int64_t i)
+{
+    if(v.kind >= Value::Enum)
+        v = Value();
+    v.kind = Value::Int;
+    v.i = i;
+}
+
+static inline void setBool(Value& v, bool b)
+{
+    if(v.kind >= Value::Enum)
+        v = Value();
+    v.kind = Value::Bool;
+    v.i = b ? 1 : 0;
+}
+
+static inline void setDouble(Value& v, double d)
+{
+    if(v.kind >= Value::Enum)
+        v = Value();
+    v.kind = Value::Double;
+    v.d = d;
+}
+
+/*!
+ * Value in the register, or the value it refers to if it's an address
+ */
+static inline Value& deref(Value& v)
+{
+    return v.kind == Value::Address ? *v.address : v;
+}
+
+/*!
+ * Formats an integer without going through the type's description, short results are kept inline
+ */
+static Value integerToString(int64_t i, bool isSigned)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    bool negative = isSigned && i < 0;
+    uint64_t u = negative ? 0 - (uint64_t)i : (uint64_t)i;
+    do
+    {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while(u);
+    if(negative)
+        *--p = '-';
+    if(end - p > Value::MaxInlineLength)
+        return Value::makeString(wstring(p, end));
+    Value ret;
+    ret.kind = Value::InlineString;
+    ret.length = (uint8_t)(end - p);
+    memcpy(ret.chars, p, end - p);
+    return ret;
+}
+
+/*!
+ * Appends src to dst, a unique string object is extended in place
+ */
+static void appendString(Value& dst, const Value& src)
+{
+    if(dst.kind != Value::String || !dst.object->isUnique())
+    {
+        dst = Value::makeString(dst.getString() + src.getString());
+        return;
+    }
+    wstring& str = static_cast<StringObject*>(dst.object)->value;
+    if(src.kind == Value::InlineString)
+    {
+        for(int i = 0; i < src.length; i++)
+            str.push_back((unsigned char)src.chars[i]);
+    }
+    else if(src.kind == Value::String)
+        str += static_cast<StringObject*>(src.object)->value;
+}
+
+static wstring getIntegerTypeName(int bits, bool isSigned)
+{
+    wstring ret = isSigned ? L"Int" : L"UInt";
+    if(bits != 64)
+        ret += to_wstring(bits);
+    return ret;
+}
+
+VirtualMachine::VirtualMachine(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults)
+:symbolRegistry(symbolRegistry), compilerResults(compilerResults), stack(new Value[StackSize]), depth(0)
+{
+    global = symbolRegistry->getGlobalScope();
+    stackTop = stack.get();
+}
+
+VirtualMachine::~VirtualMachine()
+{
+}
+
+void VirtualMachine::setCompilerResults(CompilerResults* compilerResults)
+{
+    this->compilerResults = compilerResults;
+}
+
+bool VirtualMachine::run(const ScopedProgramPtr& program, std::vector<Value>* results)
+{
+    statements.clear();
+    size_t numFunctions = functions.size();
+    try
+    {
+        BytecodeCompiler compiler(this, compilerResults);
+        compiler.compileProgram(program, statements);
+    }
+    catch(const Abort&)
+    {
+        //functions declared by the failed program are not compiled
+        for(size_t i = numFunctions; i < functions.size(); i++)
+        {
+            if(functions[i]->symbol)
+                functionsBySymbol.erase(functions[i]->symbol.get());
+            auto init = fieldInitializers.find(functions[i]->owner);
+            if(init != fieldInitializers.end() && init->second == functions[i].get())
+                fieldInitializers.erase(init);
+        }
+        functions.resize(numFunctions);
+        statements.clear();
+        return false;
+    }
+    bool ret = true;
+    Value* registers = stack.get();
+    try
+    {
+        for(const unique_ptr<BCFunction>& st : statements)
+        {
+            stackTop = registers + st->numRegisters;
+            execute(st.get(), registers);
+            if(results)
+                results->push_back(std::move(registers[0]));
+            for(Value* v = registers; v < stackTop; v++)
+                *v = Value();
+        }
+    }
+    catch(const Abort&)
+    {
+        depth = 0;
+        for(Value* v = registers; v < stackTop; v++)
+            *v = Value();
+        ret = false;
+    }
+    stackTop = registers;
+    return ret;
+}
+
+Value* VirtualMachine::getGlobal(const SymbolPtr& symbol)
+{
+    auto iter = globalIndices.find(symbol.get());
+    if(iter == globalIndices.end())
+        return nullptr;
+    return globals[iter->second];
+}
+
+std::wstring VirtualMachine::toString(const Value& value, const TypePtr& type, bool literal)
+{
+    return Evaluator::toString(global, value, type, literal);
+}
+
+std::wstring VirtualMachine::disassemble(const std::wstring& name)
+{
+    wstringstream out;
+    vector<BCFunction*> list;
+    for(const unique_ptr<BCFunction>& function : functions)
+        list.push_back(function.get());
+    for(const unique_ptr<BCFunction>& function : statements)
+        list.push_back(function.get());
+    for(BCFunction* function : list)
+    {
+        if(function->name != name)
+            continue;
+        out << function->name << L" (" << function->numParameters << L" parameters, " << function->numRegisters << L" registers)" << endl;
+        for(size_t i = 0; i < function->code.size(); i++)
+        {
+            const BCInstruction& ins = function->code[i];
+            const char* opcode = BCOpcode::getName(ins.opcode);
+            out << i << L"\t" << wstring(opcode, opcode + strlen(opcode)) << L" " << ins.a << L", " << ins.b << L", " << ins.c;
+            if(ins.x)
+                out << L" [" << ins.x << L"]";
+            out << endl;
+        }
+    }
+    return out.str();
+}
+
+void VirtualMachine::runtimeError(BCFunction* function, const BCInstruction* pc, int code, const std::wstring& item1, const std::wstring& item2)
+{
+    ResultItems items;
+    items.push_back(item1);
+    items.push_back(item2);
+    compilerResults->add(ErrorLevel::Error, function->sourceInfos[pc - function->code.data()], code, items);
+    throw Abort();
+}
+
+BCFunction* VirtualMachine::resolveOverride(RuntimeType* type, BCFunction* method)
+{
+    //the member found by the type's lookup is the nearest declaration, an overload set may not override this signature
+    for(RuntimeType* t = type; t; t = t->parent)
+    {
+        SymbolPtr member = t == type ? t->type->getMember(method->name) : t->type->getDeclaredMember(method->name);
+        vector<FunctionSymbolPtr> candidates;
+        if(FunctionOverloadedSymbolPtr funcs = dynamic_pointer_cast<FunctionOverloadedSymbol>(member))
+            candidates.assign(funcs->begin(), funcs->end());
+        else if(FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(member))
+            candidates.push_back(func);
+        for(const FunctionSymbolPtr& func : candidates)
+        {
+            BCFunction* ret = getFunction(func);
+            if(ret && InterpreterUtils::sameSignature(func->getType(), method->symbol->getType()))
+                return ret;
+        }
+        if(t->type == method->owner->type)
+            break;
+    }
+    return method;
+}
+
+/*********************************************************************
+ * Used by compiler
+ *********************************************************************/
+
+BCFunction* VirtualMachine::addFunction(const std::wstring& name)
+{
+    if(functions.size() > 0xffff)
+    {
+        compilerResults->add(ErrorLevel::Error, SourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"more than 65536 functions");
+        throw Abort();
+    }
+    BCFunction* ret = new BCFunction();
+    ret->name = name;
+    ret->index = (uint16_t)functions.size();
+    functions.push_back(unique_ptr<BCFunction>(ret));
+    return ret;
+}
+
+BCFunction* VirtualMachine::getFunction(const FunctionSymbolPtr& symbol)
+{
+    auto iter = functionsBySymbol.find(symbol.get());
+    if(iter == functionsBySymbol.end())
+        return nullptr;
+    return iter->second;
+}
+
+RuntimeType* VirtualMachine::getRuntimeType(const TypePtr& type)
+{
+    return types[getTypeIndex(type)].get();
+}
+
+uint16_t VirtualMachine::getTypeIndex(const TypePtr& type)
+{
+    auto iter = typeIndices.find(type.get());
+    if(iter != typeIndices.end())
+        return iter->second;
+    RuntimeType* parent = nullptr;
+    if(type->getCategory() == Type::Class && type->getParentType() && type->getParentType()->getCategory() == Type::Class)
+        parent = getRuntimeType(type->getParentType());
+    if(types.size() > 0xffff)
+    {
+        compilerResults->add(ErrorLevel::Error, SourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"more than 65536 types");
+        throw Abort();
+    }
+    RuntimeType* ret = new RuntimeType();
+    ret->type = type;
+    ret->parent = parent;
+    if(parent)
+        ret->fields = parent->fields;
+    if(type->getCategory() == Type::Struct || type->getCategory() == Type::Class)
+        InterpreterUtils::getStoredProperties(type, ret->fields);
+    uint16_t index = (uint16_t)types.size();
+    types.push_back(unique_ptr<RuntimeType>(ret));
+    typeIndices.insert(make_pair(type.get(), index));
+    return index;
+}
+
+uint16_t VirtualMachine::getGlobalIndex(const SymbolPtr& symbol)
+{
+    auto iter = globalIndices.find(symbol.get());
+    if(iter != globalIndices.end())
+        return iter->second;
+    if(globals.size() > 0xffff)
+    {
+        compilerResults->add(ErrorLevel::Error, SourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1, L"more than 65536 global variables");
+        throw Abort();
+    }
+    globalStorages.push_back(Value());
+    uint16_t ret = (uint16_t)globals.size();
+    globals.push_back(&globalStorages.back());
+    globalSymbols.push_back(symbol);
+    globalIndices.insert(make_pair(symbol.get(), ret));
+    return ret;
+}
+
+/*********************************************************************
+ * Interpreter
+ *********************************************************************/
+
+void VirtualMachine::execute(BCFunction* function, Value* R)
+{
+    const BCInstruction* pc = function->code.data();
+    const Value* K = function->constants.data();
+    Value** G = globals.data();
+    BCFunction* callee;
+    Value* frame;
+#ifdef SWALLOW_COMPUTED_GOTO
+#define SWALLOW_BYTECODE_LABEL(name) &&L_##name,
+    static void* const labels[] = {SWALLOW_BYTECODE_OPCODES(SWALLOW_BYTECODE_LABEL)};
+#undef SWALLOW_BYTECODE_LABEL
+#define DISPATCH() goto *labels[pc->opcode]
+#define CASE(name) L_##name
+#else
+#define DISPATCH() goto dispatch
+#define CASE(name) case BCOpcode::name
+#endif
+#define NEXT() pc++; DISPATCH()
+#define ERROR(...) runtimeError(function, pc, __VA_ARGS__)
+
+#ifdef SWALLOW_COMPUTED_GOTO
+    DISPATCH();
+#else
+dispatch:
+    switch(pc->opcode)
+#endif
+    {
+        CASE(Move):
+            R[pc->a] = R[pc->b];
+            NEXT();
+        CASE(LoadInt):
+            setInt(R[pc->a], pc->getImmediate());
+            NEXT();
+        CASE(LoadConst):
+            R[pc->a] = K[pc->b];
+            NEXT();
+        CASE(LoadGlobal):
+            R[pc->a] = *G[pc->b];
+            NEXT();
+        CASE(StoreGlobal):
+            *G[pc->b] = R[pc->a];
+            NEXT();
+        CASE(LoadEnum):
+            R[pc->a] = Value::makeEnum(pc->b, nullptr);
+            NEXT();
+        CASE(EnumIndex):
+            setInt(R[pc->a], deref(R[pc->b]).index);
+            NEXT();
+        CASE(AddInt):
+        {
+            int64_t r;
+            if(__builtin_add_overflow(R[pc->b].i, R[pc->c].i, &r))
+                ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, L"+", L"Int");
+            setInt(R[pc->a], r);
+            NEXT();
+        }
+        CASE(SubInt):
+        {
+            int64_t r;
+            if(__builtin_sub_overflow(R[pc->b].i, R[pc->c].i, &r))
+                ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, L"-", L"Int");
+            setInt(R[pc->a], r);
+            NEXT();
+        }
+        CASE(MulInt):
+        {
+            int64_t r;
+            if(__builtin_mul_overflow(R[pc->b].i, R[pc->c].i, &r))
+                ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, L"*", L"Int");
+            setInt(R[pc->a], r);
+            NEXT();
+        }
+        CASE(AddIntImm):
+        {
+            int64_t r;
+            if(__builtin_add_overflow(R[pc->b].i, (int64_t)(int16_t)pc->c, &r))
+                ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, (int16_t)pc->c < 0 ? L"-" : L"+", L"Int");
+            setInt(R[pc->a], r);
+            NEXT();
+        }
+        CASE(LtInt):
+            setBool(R[pc->a], R[pc->b].i < R[pc->c].i);
+            NEXT();
+        CASE(LeInt):
+            setBool(R[pc->a], R[pc->b].i <= R[pc->c].i);
+            NEXT();
+        CASE(EqInt):
+            setBool(R[pc->a], R[pc->b].i == R[pc->c].i);
+            NEXT();
+        CASE(NeInt):
+            setBool(R[pc->a], R[pc->b].i != R[pc->c].i);
+            NEXT();
+        CASE(IntOp):
+        {
+            ExecOperator::T op = (ExecOperator::T)BCIntegerOperator::getOperator(pc->x);
+            IntegerFormat format(BCIntegerOperator::getBits(pc->x), BCIntegerOperator::isSigned(pc->x));
+            int64_t a = R[pc->b].i;
+            int64_t b = R[pc->c].i;
+            int64_t r = 0;
+            if(b == 0 && (op == ExecOperator::Div || op == ExecOperator::Rem))
+                ERROR(Errors::E_DIVISION_BY_ZERO);
+            if(b != 0 || (op != ExecOperator::WrappingDiv && op != ExecOperator::WrappingRem))
+            {
+                if(!ExecOperator::calculate(op, format, a, b, r))
+                    ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, ExecOperator::getName(op), getIntegerTypeName(format.bits, format.isSigned));
+            }
+            setInt(R[pc->a], r);
+            NEXT();
+        }
+        CASE(IntCompare):
+        {
+            ExecOperator::T op = (ExecOperator::T)BCIntegerOperator::getOperator(pc->x);
+            IntegerFormat format(BCIntegerOperator::getBits(pc->x), BCIntegerOperator::isSigned(pc->x));
+            setBool(R[pc->a], ExecOperator::compare(op, format, R[pc->b].i, R[pc->c].i));
+            NEXT();
+        }
+        CASE(FloatOp):
+            setDouble(R[pc->a], ExecOperator::calculate((ExecOperator::T)(pc->x & 0x1f), (pc->x & 0x20) != 0, R[pc->b].d, R[pc->c].d));
+            NEXT();
+        CASE(FloatCompare):
+            setBool(R[pc->a], ExecOperator::compare((ExecOperator::T)(pc->x & 0x1f), R[pc->b].d, R[pc->c].d));
+            NEXT();
+        CASE(Not):
+            setBool(R[pc->a], !R[pc->b].i);
+            NEXT();
+        CASE(Jump):
+            pc = function->code.data() + pc->c;
+            DISPATCH();
+        CASE(JumpIfFalse):
+            if(!R[pc->a].i)
+            {
+                pc = function->code.data() + pc->c;
+                DISPATCH();
+            }
+            NEXT();
+        CASE(JumpIfTrue):
+            if(R[pc->a].i)
+            {
+                pc = function->code.data() + pc->c;
+                DISPATCH();
+            }
+            NEXT();
+        CASE(JumpIfNotLtInt):
+            if(!(R[pc->a].i < R[pc->b].i))
+            {
+                pc = function->code.data() + pc->c;
+                DISPATCH();
+            }
+            NEXT();
+        CASE(JumpIfNotLeInt):
+            if(!(R[pc->a].i <= R[pc->b].i))
+            {
+                pc = function->code.data() + pc->c;
+                DISPATCH();
+            }
+            NEXT();
+        CASE(Call):
+            callee = functions[pc->b].get();
+            goto call;
+        CASE(CallVirtual):
+        {
+            BCInlineCache& cache = function->caches[pc->c];
+            RuntimeType* type = static_cast<InstanceObject*>(R[pc->a].object)->type;
+            int i = 0;
+            while(i < BCInlineCache::Size && cache.types[i] != type)
+                i++;
+            if(i == BCInlineCache::Size)
+            {
+                i = cache.next;
+                cache.next = (uint8_t)((i + 1) % BCInlineCache::Size);
+                cache.types[i] = type;
+                cache.targets[i] = resolveOverride(type, functions[pc->b].get());
+            }
+            callee = cache.targets[i];
+            goto call;
+        }
+        call:
+            frame = R + pc->a;
+            if(depth >= MaxCallDepth || frame + callee->numRegisters > stack.get() + StackSize)
+                ERROR(Errors::E_MAXIMUM_CALL_DEPTH_EXCEEDED);
+            if(frame + callee->numRegisters > stackTop)
+                stackTop = frame + callee->numRegisters;
+            depth++;
+            execute(callee, frame);
+            depth--;
+            //arguments and locals of the callee are released
+            for(int i = 1; i < callee->numRegisters; i++)
+            {
+                if(frame[i].kind >= Value::Enum)
+                    frame[i] = Value();
+            }
+            NEXT();
+        CASE(Return):
+            if(pc->a != 0)
+                R[0] = std::move(R[pc->a]);
+            return;
+        CASE(ReturnVoid):
+            R[0] = Value();
+            return;
+        CASE(New):
+        {
+            RuntimeType* type = types[pc->b].get();
+            R[pc->a] = Value::makeObject(Value::Instance, new InstanceObject(type, type->fields.size()));
+            NEXT();
+        }
+        CASE(GetField):
+        {
+            //the field is copied before the register that may own the instance is overwritten
+            Value v = static_cast<InstanceObject*>(deref(R[pc->b]).object)->fields[pc->c];
+            R[pc->a] = std::move(v);
+            NEXT();
+        }
+        CASE(SetField):
+        {
+            Value& owner = deref(R[pc->a]);
+            InstanceObject* instance = static_cast<InstanceObject*>(pc->x ? owner.makeUnique() : owner.object);
+            instance->fields[pc->b] = R[pc->c];
+            NEXT();
+        }
+        CASE(AddressOf):
+            R[pc->a] = Value::makeAddress(&R[pc->b]);
+            NEXT();
+        CASE(GlobalAddress):
+            R[pc->a] = Value::makeAddress(G[pc->b]);
+            NEXT();
+        CASE(FieldAddress):
+        {
+            Value& owner = deref(R[pc->b]);
+            InstanceObject* instance = static_cast<InstanceObject*>(pc->x ? owner.makeUnique() : owner.object);
+            R[pc->a] = Value::makeAddress(&instance->fields[pc->c]);
+            NEXT();
+        }
+        CASE(ElementAddress):
+        {
+            ArrayObject* array = static_cast<ArrayObject*>(deref(R[pc->b]).makeUnique());
+            int64_t i = R[pc->c].i;
+            if(i < 0 || i >= (int64_t)array->elements.size())
+                ERROR(Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+            R[pc->a] = Value::makeAddress(&array->elements[i]);
+            NEXT();
+        }
+        CASE(Load):
+        {
+            Value v = *R[pc->b].address;
+            R[pc->a] = std::move(v);
+            NEXT();
+        }
+        CASE(Store):
+            *R[pc->a].address = R[pc->b];
+            NEXT();
+        CASE(NewArray):
+        {
+            ArrayObject* array = new ArrayObject();
+            array->elements.assign(R + pc->b, R + pc->b + pc->c);
+            R[pc->a] = Value::makeObject(Value::Array, array);
+            NEXT();
+        }
+        CASE(GetElement):
+        {
+            ArrayObject* array = static_cast<ArrayObject*>(deref(R[pc->b]).object);
+            int64_t i = R[pc->c].i;
+            if(i < 0 || i >= (int64_t)array->elements.size())
+                ERROR(Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+            Value v = array->elements[i];
+            R[pc->a] = std::move(v);
+            NEXT();
+        }
+        CASE(SetElement):
+        {
+            ArrayObject* array = static_cast<ArrayObject*>(deref(R[pc->a]).makeUnique());
+            int64_t i = R[pc->b].i;
+            if(i < 0 || i >= (int64_t)array->elements.size())
+                ERROR(Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+            array->elements[i] = R[pc->c];
+            NEXT();
+        }
+        CASE(ArrayCount):
+            setInt(R[pc->a], (int64_t)static_cast<ArrayObject*>(deref(R[pc->b]).object)->elements.size());
+            NEXT();
+        CASE(ArrayAppend):
+            static_cast<ArrayObject*>(deref(R[pc->a]).makeUnique())->elements.push_back(R[pc->b]);
+            NEXT();
+        CASE(ArrayRemoveLast):
+        {
+            ArrayObject* array = static_cast<ArrayObject*>(deref(R[pc->b]).makeUnique());
+            if(array->elements.empty())
+                ERROR(Errors::E_CANNOT_REMOVE_LAST_ELEMENT_FROM_AN_EMPTY_COLLECTION);
+            Value v = std::move(array->elements.back());
+            array->elements.pop_back();
+            R[pc->a] = std::move(v);
+            NEXT();
+        }
+        CASE(ToString):
+            if(pc->x)
+                R[pc->a] = integerToString(R[pc->b].i, pc->x == 1);
+            else
+                R[pc->a] = Value::makeString(Evaluator::toString(global, R[pc->b], function->types[pc->c], false));
+            NEXT();
+        CASE(Concat):
+            if(pc->a == pc->b)
+                appendString(R[pc->a], R[pc->c]);
+            else
+                R[pc->a] = Value::makeString(R[pc->b].getString() + R[pc->c].getString());
+            NEXT();
+        CASE(StringEqual):
+            setBool(R[pc->a], R[pc->b].equals(R[pc->c]) != (pc->x != 0));
+            NEXT();
+#ifndef SWALLOW_COMPUTED_GOTO
+        default:
+            assert(0 && "invalid opcode");
+            return;
+#endif
+    }
+#undef DISPATCH
+#undef CASE
+#undef NEXT
+#undef ERROR
+}
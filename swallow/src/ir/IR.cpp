@@ -0,0 +1,383 @@
+/* IR.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IR.h"
+#include "semantics/Type.h"
+#include <cassert>
+#include <algorithm>
+
+USE_SWALLOW_NS
+using namespace std;
+
+struct OpcodeInfo
+{
+    const char* name;
+    bool terminator;
+    bool result;
+};
+static const OpcodeInfo opcodes[] =
+{
+    {"argument", false, true},
+    {"alloc_stack", false, true},
+    {"alloc_box", false, true},
+    {"alloc_ref", false, true},
+    {"dealloc_stack", false, false},
+    {"dealloc_ref", false, false},
+    {"load", false, true},
+    {"store", false, false},
+    {"destroy_addr", false, false},
+    {"struct", false, true},
+    {"tuple", false, true},
+    {"enum", false, true},
+    {"struct_extract", false, true},
+    {"struct_element_addr", false, true},
+    {"tuple_extract", false, true},
+    {"tuple_element_addr", false, true},
+    {"ref_element_addr", false, true},
+    {"unchecked_enum_data", false, true},
+    {"sil_global_addr", false, true},
+    {"integer_literal", false, true},
+    {"float_literal", false, true},
+    {"string_literal", false, true},
+    {"metatype", false, true},
+    {"function_ref", false, true},
+    {"class_method", false, true},
+    {"apply", false, true},
+    {"builtin", false, true},
+    {"strong_retain", false, false},
+    {"strong_release", false, false},
+    {"retain_value", false, false},
+    {"release_value", false, false},
+    {"debug_value", false, false},
+    {"return", true, false},
+    {"br", true, false},
+    {"cond_br", true, false},
+    {"switch_enum", true, false},
+    {"cond_fail", false, false},
+    {"unreachable", true, false},
+};
+static_assert(sizeof(opcodes) / sizeof(opcodes[0]) == IROpcode::_Count, "Opcode table mismatch");
+
+const char* IROpcode::getName(T opcode)
+{
+    return opcodes[opcode].name;
+}
+bool IROpcode::isTerminator(T opcode)
+{
+    return opcodes[opcode].terminator;
+}
+bool IROpcode::hasResult(T opcode)
+{
+    return opcodes[opcode].result;
+}
+
+
+IRFunction::IRFunction(const std::wstring& name)
+:name(name), convention(IRConvention::Thin), result(IRModule::VoidType), signature(IRModule::VoidType)
+{
+}
+
+void IRFunction::getSuccessors(uint32_t block, std::vector<uint32_t>& successors) const
+{
+    successors.clear();
+    const IRBasicBlock& bb = blocks[block];
+    if(bb.end == bb.first)
+        return;
+    const IRInstruction& inst = instructions[bb.end - 1];
+    switch(inst.opcode)
+    {
+        case IROpcode::Br:
+            successors.push_back(inst.immediate.index);
+            break;
+        case IROpcode::CondBr:
+            successors.push_back(inst.immediate.targets[0]);
+            successors.push_back(inst.immediate.targets[1]);
+            break;
+        case IROpcode::SwitchEnum:
+            for(int i = 1; i + 1 < inst.numOperands; i += 2)
+                successors.push_back(getOperand(inst, i + 1));
+            if(inst.immediate.index != InvalidBlock)
+                successors.push_back(inst.immediate.index);
+            break;
+        default:
+            break;
+    }
+}
+
+IRUsers::IRUsers(const IRFunction* func)
+:uses(func->instructions.size())
+{
+    for(IRValue v = 0; v < func->instructions.size(); v++)
+    {
+        const IRInstruction& inst = func->instructions[v];
+        //member and block pairs of switch_enum are not values
+        int numValues = inst.opcode == IROpcode::SwitchEnum ? 1 : inst.numOperands;
+        for(int i = 0; i < numValues; i++)
+            uses[func->getOperand(inst, i)].push_back(make_pair(v, i));
+    }
+}
+
+void IRFunction::finish()
+{
+    if(blocks.empty())
+        return;
+    //find out reachable blocks from entry
+    vector<bool> reachable(blocks.size(), false);
+    vector<uint32_t> worklist = {0};
+    vector<uint32_t> successors;
+    reachable[0] = true;
+    while(!worklist.empty())
+    {
+        uint32_t b = worklist.back();
+        worklist.pop_back();
+        getSuccessors(b, successors);
+        for(uint32_t s : successors)
+        {
+            if(!reachable[s])
+            {
+                reachable[s] = true;
+                worklist.push_back(s);
+            }
+        }
+    }
+    //order the survived blocks by their layout
+    vector<uint32_t> order;
+    for(uint32_t b = 0; b < blocks.size(); b++)
+    {
+        if(reachable[b] && blocks[b].first != InvalidValue)
+            order.push_back(b);
+    }
+    sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b){
+        return blocks[a].first < blocks[b].first;
+    });
+    vector<uint32_t> blockMap(blocks.size(), InvalidBlock);
+    for(uint32_t i = 0; i < order.size(); i++)
+        blockMap[order[i]] = i;
+    vector<IRValue> valueMap(instructions.size(), InvalidValue);
+    {
+        IRValue next = 0;
+        for(uint32_t b : order)
+        {
+            for(uint32_t i = blocks[b].first; i < blocks[b].end; i++)
+                valueMap[i] = next++;
+        }
+    }
+    //rebuild instructions and operands
+    vector<IRInstruction> newInstructions;
+    vector<IRValue> newOperands;
+    vector<IRBasicBlock> newBlocks;
+    newInstructions.reserve(instructions.size());
+    newOperands.reserve(operands.size());
+    for(uint32_t b : order)
+    {
+        IRBasicBlock bb = blocks[b];
+        IRBasicBlock nb = {(uint32_t)newInstructions.size(), 0, bb.numArguments};
+        for(uint32_t i = bb.first; i < bb.end; i++)
+        {
+            IRInstruction inst = instructions[i];
+            const IRValue* ops = getOperands(inst);
+            inst.operands = newOperands.size();
+            inst.block = newBlocks.size();
+            for(int j = 0; j < inst.numOperands; j++)
+            {
+                IRValue op = ops[j];
+                if(inst.opcode == IROpcode::SwitchEnum && j > 0)
+                {
+                    //member and block pairs
+                    if((j & 1) == 0)
+                        op = blockMap[op];
+                }
+                else
+                {
+                    assert(valueMap[op] != InvalidValue);
+                    op = valueMap[op];
+                }
+                newOperands.push_back(op);
+            }
+            switch(inst.opcode)
+            {
+                case IROpcode::Br:
+                    inst.immediate.index = blockMap[inst.immediate.index];
+                    break;
+                case IROpcode::CondBr:
+                    inst.immediate.targets[0] = blockMap[inst.immediate.targets[0]];
+                    inst.immediate.targets[1] = blockMap[inst.immediate.targets[1]];
+                    break;
+                case IROpcode::SwitchEnum:
+                    if(inst.immediate.index != InvalidBlock)
+                        inst.immediate.index = blockMap[inst.immediate.index];
+                    break;
+                default:
+                    break;
+            }
+            newInstructions.push_back(inst);
+        }
+        nb.end = newInstructions.size();
+        newBlocks.push_back(nb);
+    }
+    instructions.swap(newInstructions);
+    operands.swap(newOperands);
+    blocks.swap(newBlocks);
+}
+
+
+
+const IRValue IRFunction::InvalidValue;
+const uint32_t IRFunction::InvalidBlock;
+const IRTypeRef IRModule::AddressBit;
+const IRTypeRef IRModule::VoidType;
+
+IRModule::IRModule(const std::wstring& name)
+:name(name)
+{
+    IRType voidType = {nullptr, L"()"};
+    types.push_back(voidType);
+    spellingIndex.insert(make_pair(voidType.name, VoidType));
+    getSubstitution(vector<IRTypeRef>());
+}
+IRModule::~IRModule()
+{
+}
+
+IRTypeRef IRModule::getType(const TypePtr& type)
+{
+    if(!type)
+        return VoidType;
+    auto iter = typeIndex.find(type.get());
+    if(iter != typeIndex.end())
+        return iter->second;
+    wstring spelling = type->toString();
+    IRTypeRef ret;
+    auto iter2 = spellingIndex.find(spelling);
+    if(iter2 != spellingIndex.end())
+    {
+        ret = iter2->second;
+        if(!types[ret].type)
+            types[ret].type = type;
+    }
+    else
+    {
+        ret = types.size();
+        IRType t = {type, spelling};
+        types.push_back(t);
+        spellingIndex.insert(make_pair(spelling, ret));
+    }
+    typeIndex.insert(make_pair(type.get(), ret));
+    return ret;
+}
+
+IRTypeRef IRModule::getType(const std::wstring& spelling)
+{
+    auto iter = spellingIndex.find(spelling);
+    if(iter != spellingIndex.end())
+        return iter->second;
+    IRTypeRef ret = types.size();
+    IRType t = {nullptr, spelling};
+    types.push_back(t);
+    spellingIndex.insert(make_pair(spelling, ret));
+    return ret;
+}
+
+std::wstring IRModule::getTypeName(IRTypeRef type) const
+{
+    const IRType& t = getTypeInfo(type);
+    if(isAddress(type))
+        return L"*" + t.name;
+    return t.name;
+}
+
+uint32_t IRModule::getSubstitution(const std::vector<IRTypeRef>& types)
+{
+    auto iter = substitutionIndex.find(types);
+    if(iter != substitutionIndex.end())
+        return iter->second;
+    uint32_t ret = substitutions.size();
+    substitutions.push_back(types);
+    substitutionIndex.insert(make_pair(types, ret));
+    return ret;
+}
+
+uint32_t IRModule::getString(const std::wstring& str)
+{
+    auto iter = stringIndex.find(str);
+    if(iter != stringIndex.end())
+        return iter->second;
+    uint32_t ret = strings.size();
+    strings.push_back(str);
+    stringIndex.insert(make_pair(str, ret));
+    return ret;
+}
+
+uint32_t IRModule::getMember(const TypePtr& owner, const std::wstring& name, IRMember::Kind kind, uint32_t index, const SymbolPtr& symbol, bool hasPayload)
+{
+    auto key = make_tuple(owner.get(), name, kind == IRMember::Method ? symbol.get() : nullptr);
+    auto iter = memberIndex.find(key);
+    if(iter != memberIndex.end())
+        return iter->second;
+    uint32_t ret = members.size();
+    IRMember m = {owner, name, kind, index, hasPayload, symbol};
+    members.push_back(m);
+    memberIndex.insert(make_pair(key, ret));
+    return ret;
+}
+
+IRFunction* IRModule::getFunction(const std::wstring& name) const
+{
+    auto iter = functionIndex.find(name);
+    if(iter == functionIndex.end())
+        return nullptr;
+    return functions[iter->second].get();
+}
+
+IRFunction* IRModule::addFunction(const std::wstring& name)
+{
+    assert(getFunction(name) == nullptr);
+    functionIndex.insert(make_pair(name, (uint32_t)functions.size()));
+    functions.push_back(unique_ptr<IRFunction>(new IRFunction(name)));
+    return functions.back().get();
+}
+
+uint32_t IRModule::getFunctionIndex(const IRFunction* func) const
+{
+    auto iter = functionIndex.find(func->name);
+    assert(iter != functionIndex.end());
+    return iter->second;
+}
+
+uint32_t IRModule::getGlobal(const std::wstring& name, IRTypeRef type, const SymbolPtr& symbol)
+{
+    auto iter = globalIndex.find(name);
+    if(iter != globalIndex.end())
+        return iter->second;
+    uint32_t ret = globals.size();
+    IRGlobal g = {name, type, symbol};
+    globals.push_back(g);
+    globalIndex.insert(make_pair(name, ret));
+    return ret;
+}
@@ -0,0 +1,440 @@
+/* IRARCOptimizer.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRARCOptimizer.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+static bool isRetain(IROpcode::T opcode)
+{
+    return opcode == IROpcode::StrongRetain || opcode == IROpcode::RetainValue;
+}
+
+static bool isRelease(IROpcode::T opcode)
+{
+    return opcode == IROpcode::StrongRelease || opcode == IROpcode::ReleaseValue;
+}
+
+/*!
+ * Instructions that may release an object, or run a deinitializer
+ */
+static bool isCounting(IROpcode::T opcode)
+{
+    return isRetain(opcode) || isRelease(opcode) || opcode == IROpcode::DestroyAddr;
+}
+
+static bool mayDecrement(IROpcode::T opcode)
+{
+    switch(opcode)
+    {
+        case IROpcode::Apply:
+        case IROpcode::StrongRelease:
+        case IROpcode::ReleaseValue:
+        case IROpcode::DestroyAddr:
+        case IROpcode::DeallocRef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool isInitializer(const IRFunction* func)
+{
+    FunctionSymbolPtr symbol = dynamic_pointer_cast<FunctionSymbol>(func->symbol);
+    return symbol && (symbol->getRole() == FunctionRoleInit || symbol->hasFlags(SymbolFlagInit));
+}
+
+/*!
+ * Gets the statically known callee of the apply, or nullptr if it's dispatched dynamically
+ */
+static const IRFunction* getCallee(const IRModule* module, const IRFunction* func, const IRInstruction& apply)
+{
+    const IRInstruction& callee = func->instructions[func->getOperand(apply, 0)];
+    if(callee.opcode != IROpcode::FunctionRef)
+        return nullptr;
+    return module->getFunctionAt(callee.immediate.index);
+}
+
+/*!
+ * Rebuilds the instructions of the function by given layout of each block, values are renumbered
+ */
+static void rebuild(IRFunction* func, const vector<vector<IRValue> >& layout)
+{
+    vector<IRValue> valueMap(func->instructions.size(), IRFunction::InvalidValue);
+    IRValue next = 0;
+    for(const vector<IRValue>& block : layout)
+    {
+        for(IRValue v : block)
+            valueMap[v] = next++;
+    }
+    vector<IRInstruction> instructions;
+    vector<IRValue> operands;
+    instructions.reserve(next);
+    operands.reserve(func->operands.size());
+    for(uint32_t b = 0; b < layout.size(); b++)
+    {
+        IRBasicBlock& bb = func->blocks[b];
+        bb.first = instructions.size();
+        for(IRValue v : layout[b])
+        {
+            IRInstruction inst = func->instructions[v];
+            const IRValue* ops = func->getOperands(inst);
+            inst.operands = operands.size();
+            for(int i = 0; i < inst.numOperands; i++)
+            {
+                bool isValue = inst.opcode != IROpcode::SwitchEnum || i == 0;
+                assert(!isValue || valueMap[ops[i]] != IRFunction::InvalidValue);
+                operands.push_back(isValue ? valueMap[ops[i]] : ops[i]);
+            }
+            instructions.push_back(inst);
+        }
+        bb.end = instructions.size();
+    }
+    func->instructions.swap(instructions);
+    func->operands.swap(operands);
+}
+
+IRARCOptimizer::IRARCOptimizer(IRModule* module)
+:module(module), escapeAnalysis(module)
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+uint32_t IRARCOptimizer::run()
+{
+    memset(&statistics, 0, sizeof(statistics));
+    escapeAnalysis.run();
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+    {
+        IRFunction* func = module->getFunctionAt(i);
+        for(const IRInstruction& inst : func->instructions)
+        {
+            if(isCounting(inst.opcode))
+                statistics.originalOperations++;
+        }
+        if(func->isExternal())
+            continue;
+        vector<bool> removed(func->instructions.size(), false);
+        {
+            IRUsers users(func);
+            removeNonEscaping(func, users, removed);
+            removePairs(func, users, removed);
+        }
+        vector<vector<IRValue> > layout(func->blocks.size());
+        for(uint32_t b = 0; b < func->blocks.size(); b++)
+        {
+            for(IRValue v = func->blocks[b].first; v < func->blocks[b].end; v++)
+            {
+                if(!removed[v])
+                    layout[b].push_back(v);
+            }
+        }
+        IRUsers users(func);
+        hoistReleases(func, users, layout);
+        rebuild(func, layout);
+        for(const IRInstruction& inst : func->instructions)
+        {
+            if(isCounting(inst.opcode))
+                statistics.finalOperations++;
+        }
+    }
+    return statistics.originalOperations - statistics.finalOperations;
+}
+
+/*!
+ * An object allocated in a block that never escapes and is only retained and released in the same block
+ * has a balanced reference count, only the final release that deallocates it is needed.
+ */
+void IRARCOptimizer::removeNonEscaping(IRFunction* func, const IRUsers& users, std::vector<bool>& removed)
+{
+    vector<IRValue> operations;
+    for(IRValue v = 0; v < func->instructions.size(); v++)
+    {
+        if(func->instructions[v].opcode != IROpcode::AllocRef || !escapeAnalysis.isLocalObject(func, users, v, operations))
+            continue;
+        statistics.nonEscapingObjects++;
+        for(size_t i = 0; i + 1 < operations.size(); i++)
+        {
+            removed[operations[i]] = true;
+            statistics.removedNonEscaping++;
+        }
+    }
+}
+
+/*!
+ * Check if the instruction takes the ownership of given value
+ */
+bool IRARCOptimizer::consumes(const IRFunction* func, const IRInstruction& inst, IRValue value)
+{
+    const IRValue* ops = func->getOperands(inst);
+    switch(inst.opcode)
+    {
+        case IROpcode::Store:
+            return ops[0] == value;
+        case IROpcode::Return:
+        case IROpcode::Br:
+        case IROpcode::Struct:
+        case IROpcode::Tuple:
+        case IROpcode::Enum:
+        case IROpcode::DeallocRef:
+            return find(ops, ops + inst.numOperands, value) != ops + inst.numOperands;
+        case IROpcode::Apply:
+        {
+            //arguments are guaranteed, except self of initializers which is returned
+            const IRFunction* callee = getCallee(module, func, inst);
+            if(!callee || !isInitializer(callee))
+                return false;
+            return ops[inst.numOperands - 1] == value;
+        }
+        default:
+            return false;
+    }
+}
+
+/*!
+ * Owned values and arguments hold a reference until they're consumed or released
+ */
+bool IRARCOptimizer::isOwned(const IRFunction* func, IRValue value)
+{
+    switch(func->instructions[value].opcode)
+    {
+        case IROpcode::Argument:
+        case IROpcode::Apply:
+        case IROpcode::AllocRef:
+        case IROpcode::Struct:
+        case IROpcode::Tuple:
+        case IROpcode::Enum:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void IRARCOptimizer::removePairs(IRFunction* func, const IRUsers& users, std::vector<bool>& removed)
+{
+    for(const IRBasicBlock& bb : func->blocks)
+    {
+        //inner pairs are matched before outer ones
+        for(IRValue r = bb.end; r-- > bb.first;)
+        {
+            const IRInstruction& retain = func->instructions[r];
+            if(removed[r] || !isRetain(retain.opcode))
+                continue;
+            IRValue value = func->getOperand(retain, 0);
+            const IRInstruction& def = func->instructions[value];
+            //a load from a slot stored only once keeps the object alive until the slot is destroyed
+            IRValue slot = IRFunction::InvalidValue;
+            if(def.opcode == IROpcode::Load && IREscapeAnalysis::isStableSlot(func, users, func->getOperand(def, 0)))
+                slot = func->getOperand(def, 0);
+            bool decremented = false;
+            bool slotDestroyed = false;
+            bool borrowed = false;
+            for(IRValue q = r + 1; q < bb.end; q++)
+            {
+                if(removed[q])
+                    continue;
+                const IRInstruction& inst = func->instructions[q];
+                const IRValue* ops = func->getOperands(inst);
+                if(inst.opcode == retain.opcode && ops[0] == value)
+                    break;
+                if(isRelease(inst.opcode) && ops[0] == value)
+                {
+                    bool alive = isOwned(func, value) || !decremented || (slot != IRFunction::InvalidValue && !slotDestroyed);
+                    if(alive && (inst.opcode == IROpcode::StrongRelease) == (retain.opcode == IROpcode::StrongRetain))
+                    {
+                        removed[r] = removed[q] = true;
+                        if(borrowed)
+                            statistics.borrowedArguments++;
+                        else
+                            statistics.removedPairs++;
+                    }
+                    break;
+                }
+                if(consumes(func, inst, value))
+                {
+                    if(inst.opcode == IROpcode::Store)
+                        removeSlotCopy(func, users, r, q, removed);
+                    break;
+                }
+                decremented = decremented || mayDecrement(inst.opcode);
+                if(inst.opcode == IROpcode::DestroyAddr && ops[0] == slot)
+                    slotDestroyed = true;
+                if(inst.opcode == IROpcode::Apply && find(ops + 1, ops + inst.numOperands, value) != ops + inst.numOperands)
+                    borrowed = true;
+            }
+        }
+    }
+}
+
+/*!
+ * A copy stored to a stable slot doesn't need its own reference if the copied object outlives the slot,
+ * the retain and the destruction of the slot are both removed.
+ */
+void IRARCOptimizer::removeSlotCopy(IRFunction* func, const IRUsers& users, IRValue retain, IRValue store, std::vector<bool>& removed)
+{
+    const IRInstruction& inst = func->instructions[store];
+    IRValue value = func->getOperand(inst, 0);
+    IRValue slot = func->getOperand(inst, 1);
+    if(!IREscapeAnalysis::isStableSlot(func, users, slot))
+        return;
+    IRValue destroy = getDestroy(func, users, slot);
+    if(destroy == IRFunction::InvalidValue || destroy < store || removed[destroy] || func->instructions[destroy].block != inst.block)
+        return;
+    const IRInstruction& def = func->instructions[value];
+    bool outlives = false;
+    if(def.opcode == IROpcode::Argument)
+    {
+        //parameters are guaranteed by the caller, except self of initializers which is owned
+        bool isSelf = isInitializer(func) && value + 1 == func->parameters.size();
+        outlives = def.block == 0 && value < func->parameters.size() && !isSelf;
+    }
+    else if(def.opcode == IROpcode::Load && IREscapeAnalysis::isStableSlot(func, users, func->getOperand(def, 0)))
+    {
+        //the source is alive when it's loaded, it has to be still alive when the copy is destroyed
+        IRValue source = getDestroy(func, users, func->getOperand(def, 0));
+        outlives = source != IRFunction::InvalidValue && !(func->instructions[source].block == inst.block && source > value && source < destroy);
+    }
+    if(!outlives)
+        return;
+    removed[retain] = removed[destroy] = true;
+    statistics.removedPairs++;
+}
+
+/*!
+ * Gets the only destroy_addr of the slot
+ */
+IRValue IRARCOptimizer::getDestroy(const IRFunction* func, const IRUsers& users, IRValue slot)
+{
+    IRValue ret = IRFunction::InvalidValue;
+    for(const IRUsers::Use& use : users[slot])
+    {
+        if(func->instructions[use.first].opcode != IROpcode::DestroyAddr)
+            continue;
+        if(ret != IRFunction::InvalidValue)
+            return IRFunction::InvalidValue;
+        ret = use.first;
+    }
+    return ret;
+}
+
+/*!
+ * Moves releases and destructions of slots up to the last use of the value in the same block, instructions
+ * that may run code or release objects are barriers, so deinitializers still run in the same order.
+ */
+void IRARCOptimizer::hoistReleases(IRFunction* func, const IRUsers& users, std::vector<std::vector<IRValue> >& layout)
+{
+    vector<bool> derived(func->instructions.size(), false);
+    vector<IRValue> worklist, marked;
+    for(vector<IRValue>& block : layout)
+    {
+        for(size_t i = 0; i < block.size(); i++)
+        {
+            const IRInstruction& release = func->instructions[block[i]];
+            if(!isRelease(release.opcode) && release.opcode != IROpcode::DestroyAddr)
+                continue;
+            IRValue value = func->getOperand(release, 0);
+            //field addresses and values borrowed from the object are also uses of it
+            worklist = {value};
+            while(!worklist.empty())
+            {
+                IRValue v = worklist.back();
+                worklist.pop_back();
+                if(derived[v])
+                    continue;
+                derived[v] = true;
+                marked.push_back(v);
+                for(const IRUsers::Use& use : users[v])
+                {
+                    switch(func->instructions[use.first].opcode)
+                    {
+                        case IROpcode::RefElementAddr:
+                        case IROpcode::StructElementAddr:
+                        case IROpcode::TupleElementAddr:
+                        case IROpcode::StructExtract:
+                        case IROpcode::TupleExtract:
+                        case IROpcode::UncheckedEnumData:
+                        case IROpcode::Load:
+                            worklist.push_back(use.first);
+                            break;
+                        case IROpcode::Store:
+                        {
+                            //a slot may borrow the content of the destroyed slot without its own reference
+                            const IRInstruction& def = func->instructions[v];
+                            if(use.second == 0 && def.opcode == IROpcode::Load && func->getOperand(def, 0) == value)
+                                worklist.push_back(func->getOperand(func->instructions[use.first], 1));
+                            break;
+                        }
+                        default:
+                            break;
+                    }
+                }
+            }
+            size_t j = i;
+            while(j > 0)
+            {
+                IRValue prev = block[j - 1];
+                const IRInstruction& inst = func->instructions[prev];
+                if(derived[prev] || mayDecrement(inst.opcode) || inst.opcode == IROpcode::Argument)
+                    break;
+                const IRValue* ops = func->getOperands(inst);
+                int numValues = inst.opcode == IROpcode::SwitchEnum ? 1 : inst.numOperands;
+                bool used = false;
+                for(int k = 0; k < numValues && !used; k++)
+                    used = derived[ops[k]];
+                if(used)
+                    break;
+                j--;
+            }
+            for(IRValue v : marked)
+                derived[v] = false;
+            marked.clear();
+            if(j == i)
+                continue;
+            IRValue v = block[i];
+            block.erase(block.begin() + i);
+            block.insert(block.begin() + j, v);
+            statistics.hoistedReleases++;
+        }
+    }
+}
+
+void IRARCOptimizer::dumpStatistics(std::wostream& out) const
+{
+    const ARCStatistics& s = statistics;
+    out << L"reference counting: " << s.originalOperations << L" -> " << s.finalOperations << L" operations" << endl;
+    out << L"removed pairs: " << s.removedPairs << L", borrowed arguments: " << s.borrowedArguments
+        << L", non-escaping objects: " << s.nonEscapingObjects << L" (" << s.removedNonEscaping << L" operations)"
+        << L", hoisted releases: " << s.hoistedReleases << endl;
+}
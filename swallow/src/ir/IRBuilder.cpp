@@ -0,0 +1,327 @@
+/* IRBuilder.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRBuilder.h"
+#include <cassert>
+
+USE_SWALLOW_NS
+using namespace std;
+
+
+IRBuilder::IRBuilder(IRModule* module, IRFunction* function)
+:module(module), function(function), current(IRFunction::InvalidBlock)
+{
+}
+
+uint32_t IRBuilder::createBlock()
+{
+    IRBasicBlock bb = {IRFunction::InvalidValue, IRFunction::InvalidValue, 0};
+    function->blocks.push_back(bb);
+    return function->blocks.size() - 1;
+}
+
+void IRBuilder::addBlockArgument(uint32_t block, IRTypeRef type)
+{
+    assert(function->blocks[block].first == IRFunction::InvalidValue && "Cannot add argument to a block that's already laid out");
+    pendingArguments[block].push_back(type);
+}
+
+IRValue IRBuilder::getBlockArgument(uint32_t block, int index) const
+{
+    const IRBasicBlock& bb = function->blocks[block];
+    assert(bb.first != IRFunction::InvalidValue && index < (int)bb.numArguments);
+    return bb.first + index;
+}
+
+void IRBuilder::setInsertionBlock(uint32_t block)
+{
+    assert(isTerminated() && "Current block must be terminated before switching to another one");
+    IRBasicBlock& bb = function->blocks[block];
+    assert(bb.first == IRFunction::InvalidValue && "Block is already laid out");
+    bb.first = bb.end = function->instructions.size();
+    current = block;
+    auto iter = pendingArguments.find(block);
+    if(iter != pendingArguments.end())
+    {
+        for(IRTypeRef type : iter->second)
+        {
+            IRValue arg = emit(IROpcode::Argument, type);
+            function->instructions[arg].immediate.index = function->blocks[block].numArguments++;
+        }
+        pendingArguments.erase(iter);
+    }
+}
+
+bool IRBuilder::isTerminated() const
+{
+    if(current == IRFunction::InvalidBlock)
+        return true;
+    const IRBasicBlock& bb = function->blocks[current];
+    if(bb.end == bb.first)
+        return false;
+    return IROpcode::isTerminator(function->instructions[bb.end - 1].opcode);
+}
+
+IRValue IRBuilder::emit(IROpcode::T opcode, IRTypeRef type, const IRValue* operands, size_t numOperands)
+{
+    if(opcode != IROpcode::Argument && isTerminated())
+    {
+        //code after a terminator is unreachable, it goes to a new block that finish() will drop
+        setInsertionBlock(createBlock());
+    }
+    IRInstruction inst;
+    inst.opcode = opcode;
+    inst.flags = 0;
+    inst.numOperands = (uint16_t)numOperands;
+    inst.type = type;
+    inst.operands = function->operands.size();
+    inst.block = current;
+    inst.immediate.integer = 0;
+    function->operands.insert(function->operands.end(), operands, operands + numOperands);
+    IRValue ret = function->instructions.size();
+    function->instructions.push_back(inst);
+    function->blocks[current].end = function->instructions.size();
+    return ret;
+}
+
+IRValue IRBuilder::emit(IROpcode::T opcode, IRTypeRef type, std::initializer_list<IRValue> operands)
+{
+    return emit(opcode, type, operands.begin(), operands.size());
+}
+
+IRValue IRBuilder::emit(IROpcode::T opcode, IRTypeRef type, const std::vector<IRValue>& operands)
+{
+    return emit(opcode, type, operands.data(), operands.size());
+}
+
+IRValue IRBuilder::createAllocStack(IRTypeRef type)
+{
+    return emit(IROpcode::AllocStack, IRModule::addressOf(type));
+}
+IRValue IRBuilder::createAllocBox(IRTypeRef type)
+{
+    return emit(IROpcode::AllocBox, IRModule::addressOf(type));
+}
+IRValue IRBuilder::createAllocRef(IRTypeRef type)
+{
+    return emit(IROpcode::AllocRef, type);
+}
+void IRBuilder::createDeallocStack(IRValue address)
+{
+    emit(IROpcode::DeallocStack, IRModule::VoidType, {address});
+}
+void IRBuilder::createDeallocRef(IRValue ref)
+{
+    emit(IROpcode::DeallocRef, IRModule::VoidType, {ref});
+}
+IRValue IRBuilder::createLoad(IRValue address)
+{
+    return emit(IROpcode::Load, IRModule::objectOf(getValueType(address)), {address});
+}
+void IRBuilder::createStore(IRValue value, IRValue address)
+{
+    emit(IROpcode::Store, IRModule::VoidType, {value, address});
+}
+void IRBuilder::createDestroyAddr(IRValue address)
+{
+    emit(IROpcode::DestroyAddr, IRModule::VoidType, {address});
+}
+
+IRValue IRBuilder::createStruct(IRTypeRef type, const std::vector<IRValue>& fields)
+{
+    return emit(IROpcode::Struct, type, fields);
+}
+IRValue IRBuilder::createTuple(IRTypeRef type, const std::vector<IRValue>& elements)
+{
+    return emit(IROpcode::Tuple, type, elements);
+}
+IRValue IRBuilder::createEnum(IRTypeRef type, uint32_t member, IRValue payload)
+{
+    IRValue ret;
+    if(payload != IRFunction::InvalidValue)
+        ret = emit(IROpcode::Enum, type, {payload});
+    else
+        ret = emit(IROpcode::Enum, type);
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createStructExtract(IRValue value, uint32_t member, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::StructExtract, type, {value});
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createStructElementAddr(IRValue address, uint32_t member, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::StructElementAddr, IRModule::addressOf(type), {address});
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createTupleExtract(IRValue value, int index, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::TupleExtract, type, {value});
+    function->instructions[ret].immediate.index = index;
+    return ret;
+}
+IRValue IRBuilder::createTupleElementAddr(IRValue address, int index, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::TupleElementAddr, IRModule::addressOf(type), {address});
+    function->instructions[ret].immediate.index = index;
+    return ret;
+}
+IRValue IRBuilder::createRefElementAddr(IRValue ref, uint32_t member, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::RefElementAddr, IRModule::addressOf(type), {ref});
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createUncheckedEnumData(IRValue value, uint32_t member, IRTypeRef type)
+{
+    IRValue ret = emit(IROpcode::UncheckedEnumData, type, {value});
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createGlobalAddr(uint32_t global)
+{
+    IRValue ret = emit(IROpcode::GlobalAddr, IRModule::addressOf(module->getGlobalAt(global).type));
+    function->instructions[ret].immediate.index = global;
+    return ret;
+}
+
+IRValue IRBuilder::createIntegerLiteral(IRTypeRef type, int64_t value)
+{
+    IRValue ret = emit(IROpcode::IntegerLiteral, type);
+    function->instructions[ret].immediate.integer = value;
+    return ret;
+}
+IRValue IRBuilder::createFloatLiteral(IRTypeRef type, double value)
+{
+    IRValue ret = emit(IROpcode::FloatLiteral, type);
+    function->instructions[ret].immediate.real = value;
+    return ret;
+}
+IRValue IRBuilder::createStringLiteral(IRTypeRef type, const std::wstring& value)
+{
+    IRValue ret = emit(IROpcode::StringLiteral, type);
+    function->instructions[ret].immediate.index = module->getString(value);
+    return ret;
+}
+IRValue IRBuilder::createMetatype(IRTypeRef type)
+{
+    return emit(IROpcode::Metatype, type);
+}
+
+IRValue IRBuilder::createFunctionRef(IRFunction* func)
+{
+    IRValue ret = emit(IROpcode::FunctionRef, func->signature);
+    function->instructions[ret].immediate.index = module->getFunctionIndex(func);
+    return ret;
+}
+IRValue IRBuilder::createClassMethod(IRValue self, uint32_t member, IRTypeRef signature)
+{
+    IRValue ret = emit(IROpcode::ClassMethod, signature, {self});
+    function->instructions[ret].immediate.index = member;
+    return ret;
+}
+IRValue IRBuilder::createApply(IRValue callee, const std::vector<IRValue>& args, IRTypeRef result, uint32_t substitution)
+{
+    vector<IRValue> operands;
+    operands.reserve(args.size() + 1);
+    operands.push_back(callee);
+    operands.insert(operands.end(), args.begin(), args.end());
+    IRValue ret = emit(IROpcode::Apply, result, operands);
+    function->instructions[ret].immediate.index = substitution;
+    return ret;
+}
+IRValue IRBuilder::createBuiltin(const std::wstring& name, const std::vector<IRValue>& args, IRTypeRef result)
+{
+    IRValue ret = emit(IROpcode::Builtin, result, args);
+    function->instructions[ret].immediate.index = module->getString(name);
+    return ret;
+}
+
+void IRBuilder::createStrongRetain(IRValue ref)
+{
+    emit(IROpcode::StrongRetain, IRModule::VoidType, {ref});
+}
+void IRBuilder::createStrongRelease(IRValue ref)
+{
+    emit(IROpcode::StrongRelease, IRModule::VoidType, {ref});
+}
+void IRBuilder::createRetainValue(IRValue value)
+{
+    emit(IROpcode::RetainValue, IRModule::VoidType, {value});
+}
+void IRBuilder::createReleaseValue(IRValue value)
+{
+    emit(IROpcode::ReleaseValue, IRModule::VoidType, {value});
+}
+void IRBuilder::createDebugValue(IRValue value, const std::wstring& name, bool variable)
+{
+    IRValue ret = emit(IROpcode::DebugValue, IRModule::VoidType, {value});
+    function->instructions[ret].flags = variable ? 1 : 0;
+    function->instructions[ret].immediate.index = module->getString(name);
+}
+
+void IRBuilder::createReturn(IRValue value)
+{
+    emit(IROpcode::Return, IRModule::VoidType, {value});
+}
+void IRBuilder::createBr(uint32_t target, const std::vector<IRValue>& args)
+{
+    IRValue ret = emit(IROpcode::Br, IRModule::VoidType, args);
+    function->instructions[ret].immediate.index = target;
+}
+void IRBuilder::createCondBr(IRValue condition, uint32_t thenBlock, uint32_t elseBlock)
+{
+    IRValue ret = emit(IROpcode::CondBr, IRModule::VoidType, {condition});
+    function->instructions[ret].immediate.targets[0] = thenBlock;
+    function->instructions[ret].immediate.targets[1] = elseBlock;
+}
+void IRBuilder::createSwitchEnum(IRValue value, const std::vector<std::pair<uint32_t, uint32_t> >& cases, uint32_t defaultBlock)
+{
+    vector<IRValue> operands;
+    operands.reserve(cases.size() * 2 + 1);
+    operands.push_back(value);
+    for(const auto& c : cases)
+    {
+        operands.push_back(c.first);
+        operands.push_back(c.second);
+    }
+    IRValue ret = emit(IROpcode::SwitchEnum, IRModule::VoidType, operands);
+    function->instructions[ret].immediate.index = defaultBlock;
+}
+void IRBuilder::createCondFail(IRValue condition)
+{
+    emit(IROpcode::CondFail, IRModule::VoidType, {condition});
+}
+void IRBuilder::createUnreachable()
+{
+    emit(IROpcode::Unreachable, IRModule::VoidType);
+}
@@ -0,0 +1,268 @@
+/* IREscapeAnalysis.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IREscapeAnalysis.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include <algorithm>
+
+USE_SWALLOW_NS
+using namespace std;
+
+static bool isInitializer(const IRFunction* func)
+{
+    FunctionSymbolPtr symbol = dynamic_pointer_cast<FunctionSymbol>(func->symbol);
+    return symbol && (symbol->getRole() == FunctionRoleInit || symbol->hasFlags(SymbolFlagInit));
+}
+
+/*!
+ * Gets the statically known callee of the apply, or nullptr if it's dispatched dynamically
+ */
+static const IRFunction* getCallee(const IRModule* module, const IRFunction* func, const IRInstruction& apply)
+{
+    const IRInstruction& callee = func->instructions[func->getOperand(apply, 0)];
+    if(callee.opcode != IROpcode::FunctionRef)
+        return nullptr;
+    return module->getFunctionAt(callee.immediate.index);
+}
+
+IREscapeAnalysis::IREscapeAnalysis(const IRModule* module)
+:module(module)
+{
+}
+
+void IREscapeAnalysis::run()
+{
+    summaries.clear();
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+    {
+        const IRFunction* func = module->getFunctionAt(i);
+        vector<IREscape::T>& summary = summaries[func];
+        for(IRTypeRef param : func->parameters)
+            summary.push_back(func->isExternal() || IRModule::isAddress(param) ? IREscape::Escapes : IREscape::NoEscape);
+    }
+    bool changed = true;
+    vector<IRValue> aliases, slots;
+    while(changed)
+    {
+        changed = false;
+        for(uint32_t i = 0; i < module->numFunctions(); i++)
+        {
+            const IRFunction* func = module->getFunctionAt(i);
+            if(func->isExternal())
+                continue;
+            IRUsers users(func);
+            //parameters are the leading arguments of the entry block
+            for(uint32_t p = 0; p < func->parameters.size(); p++)
+            {
+                if(summaries[func][p] == IREscape::Escapes)
+                    continue;
+                bool allowReturn = isInitializer(func) && p + 1 == func->parameters.size();
+                bool returned = false;
+                IREscape::T escape = IREscape::Escapes;
+                if(collectAliases(func, users, p, allowReturn, aliases, slots, returned))
+                    escape = returned ? IREscape::Returned : IREscape::NoEscape;
+                if(escape != summaries[func][p])
+                {
+                    summaries[func][p] = escape;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+IREscape::T IREscapeAnalysis::getParameterEscape(const IRFunction* func, uint32_t param) const
+{
+    auto iter = summaries.find(func);
+    if(iter == summaries.end() || param >= iter->second.size())
+        return IREscape::Escapes;
+    return iter->second[param];
+}
+
+bool IREscapeAnalysis::collectAliases(const IRFunction* func, const IRUsers& users, IRValue root, bool allowReturn,
+    std::vector<IRValue>& aliases, std::vector<IRValue>& slots, bool& returned) const
+{
+    aliases.clear();
+    slots.clear();
+    vector<IRValue> worklist = {root};
+    while(!worklist.empty())
+    {
+        IRValue value = worklist.back();
+        worklist.pop_back();
+        if(find(aliases.begin(), aliases.end(), value) != aliases.end())
+            continue;
+        aliases.push_back(value);
+        for(const IRUsers::Use& use : users[value])
+        {
+            const IRInstruction& inst = func->instructions[use.first];
+            switch(inst.opcode)
+            {
+                case IROpcode::StrongRetain:
+                case IROpcode::StrongRelease:
+                case IROpcode::RetainValue:
+                case IROpcode::ReleaseValue:
+                case IROpcode::DebugValue:
+                case IROpcode::ClassMethod:
+                    break;
+                case IROpcode::RefElementAddr:
+                    if(!isFieldAccess(func, users, use.first))
+                        return false;
+                    break;
+                case IROpcode::Store:
+                {
+                    IRValue slot = func->getOperand(inst, 1);
+                    if(use.second != 0 || !isStableSlot(func, users, slot))
+                        return false;
+                    slots.push_back(slot);
+                    for(const IRUsers::Use& u : users[slot])
+                    {
+                        if(func->instructions[u.first].opcode == IROpcode::Load)
+                            worklist.push_back(u.first);
+                    }
+                    break;
+                }
+                case IROpcode::Apply:
+                {
+                    const IRFunction* callee = getCallee(module, func, inst);
+                    if(use.second == 0 || !callee)
+                        return false;
+                    IREscape::T escape = getParameterEscape(callee, use.second - 1);
+                    if(escape == IREscape::Escapes)
+                        return false;
+                    if(escape == IREscape::Returned)
+                        worklist.push_back(use.first);
+                    break;
+                }
+                case IROpcode::Return:
+                    if(!allowReturn)
+                        return false;
+                    returned = true;
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool IREscapeAnalysis::isLocalObject(const IRFunction* func, const IRUsers& users, IRValue alloc, std::vector<IRValue>& operations) const
+{
+    vector<IRValue> aliases, slots;
+    bool returned = false;
+    operations.clear();
+    if(!collectAliases(func, users, alloc, false, aliases, slots, returned))
+        return false;
+    uint32_t block = func->instructions[alloc].block;
+    for(IRValue alias : aliases)
+    {
+        for(const IRUsers::Use& use : users[alias])
+        {
+            const IRInstruction& inst = func->instructions[use.first];
+            if(inst.block != block)
+                return false;
+            if(inst.opcode == IROpcode::StrongRetain || inst.opcode == IROpcode::StrongRelease
+                || inst.opcode == IROpcode::RetainValue || inst.opcode == IROpcode::ReleaseValue)
+                operations.push_back(use.first);
+        }
+    }
+    for(IRValue slot : slots)
+    {
+        for(const IRUsers::Use& use : users[slot])
+        {
+            const IRInstruction& inst = func->instructions[use.first];
+            if(inst.block != block)
+                return false;
+            if(inst.opcode == IROpcode::DestroyAddr)
+                operations.push_back(use.first);
+        }
+    }
+    sort(operations.begin(), operations.end());
+    //the lifetime ends at the final release, retains after it mean the object is leaked
+    if(operations.empty())
+        return false;
+    IROpcode::T last = func->instructions[operations.back()].opcode;
+    return last != IROpcode::StrongRetain && last != IROpcode::RetainValue;
+}
+
+/*!
+ * Check if the field address is only loaded or stored
+ */
+bool IREscapeAnalysis::isFieldAccess(const IRFunction* func, const IRUsers& users, IRValue address)
+{
+    for(const IRUsers::Use& use : users[address])
+    {
+        const IRInstruction& inst = func->instructions[use.first];
+        switch(inst.opcode)
+        {
+            case IROpcode::Load:
+                break;
+            case IROpcode::Store:
+                if(use.second != 1)
+                    return false;
+                break;
+            case IROpcode::StructElementAddr:
+            case IROpcode::TupleElementAddr:
+                if(!isFieldAccess(func, users, use.first))
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool IREscapeAnalysis::isStableSlot(const IRFunction* func, const IRUsers& users, IRValue slot)
+{
+    if(func->instructions[slot].opcode != IROpcode::AllocStack)
+        return false;
+    int stores = 0;
+    for(const IRUsers::Use& use : users[slot])
+    {
+        const IRInstruction& inst = func->instructions[use.first];
+        switch(inst.opcode)
+        {
+            case IROpcode::Load:
+            case IROpcode::DestroyAddr:
+            case IROpcode::DeallocStack:
+            case IROpcode::DebugValue:
+                break;
+            case IROpcode::Store:
+                if(use.second != 1)
+                    return false;
+                stores++;
+                break;
+            default:
+                return false;
+        }
+    }
+    return stores == 1;
+}
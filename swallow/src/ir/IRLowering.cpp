@@ -0,0 +1,1936 @@
+/* IRLowering.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRLowering.h"
+#include "ast/ast.h"
+#include "ast/NodeFactory.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "semantics/GenericDefinition.h"
+#include "semantics/GenericArgument.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include "swallow_types.h"
+#include <cassert>
+#include <unordered_set>
+#include <algorithm>
+
+USE_SWALLOW_NS
+using namespace std;
+
+struct IRLowering::FunctionContext
+{
+    FunctionContext(IRModule* module, IRFunction* function)
+    :builder(module, function), function(function), isInit(false), selfOnStack(false)
+    {
+        self.value = IRFunction::InvalidValue;
+        self.address = false;
+    }
+    IRBuilder builder;
+    IRFunction* function;
+    FunctionSymbolPtr symbol;
+    //the type that declared current function
+    TypePtr selfType;
+    Variable self;
+    bool isInit;
+    //self of a value type's initializer lives in a stack allocation until the initializer returns
+    bool selfOnStack;
+    //cleanups of each lexical scope, the first one belongs to the function itself
+    vector<vector<Cleanup> > cleanups;
+    vector<SymbolScope*> scopes;
+    vector<Loop> loops;
+    unordered_map<Symbol*, Variable> variables;
+    //stored properties that are already initialized inside an initializer
+    unordered_set<Symbol*> initializedFields;
+};
+
+static bool hasFlag(const FunctionSymbolPtr& func, SymbolFlags flag)
+{
+    return func->hasFlags(flag) || (func->getType() && func->getType()->hasFlags(flag));
+}
+
+/*!
+ * Gets the type that declares the symbol, extensions are resolved to the extended type
+ */
+static TypePtr getOwnerType(const SymbolPtr& symbol)
+{
+    TypePtr type = symbol->getDeclaringType();
+    if(type && type->getCategory() == Type::Extension)
+        type = type->getInnerType();
+    return type;
+}
+
+static bool isInitializer(const FunctionSymbolPtr& func)
+{
+    return func->getRole() == FunctionRoleInit || hasFlag(func, SymbolFlagInit);
+}
+
+static bool isStoredProperty(const SymbolPtr& symbol)
+{
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(symbol);
+    return s && s->getRole() == SymbolPlaceHolder::R_PROPERTY && !s->hasFlags(SymbolFlagStatic);
+}
+
+/*!
+ * Stored properties that occupy a slot in the instance, in declaration order
+ */
+static void getStoredProperties(const TypePtr& type, vector<SymbolPtr>& properties)
+{
+    for(const SymbolPtr& sym : type->getDeclaredStoredProperties())
+    {
+        if(!dynamic_pointer_cast<SymbolPlaceHolder>(sym) || sym->hasFlags(SymbolFlagTemporary))
+            continue;
+        properties.push_back(sym);
+    }
+}
+
+static bool isSelfIdentifier(const ExpressionPtr& expr)
+{
+    if(!expr || expr->getNodeType() != NodeType::Identifier)
+        return false;
+    const wstring& name = static_pointer_cast<Identifier>(expr)->getIdentifier();
+    return name == L"self" || name == L"super";
+}
+
+/*!
+ * Arguments are taken after the semantic analyzer's transformation, e.g. the implicit self access expanded
+ */
+static void getArguments(const ParenthesizedExpressionPtr& args, vector<ExpressionPtr>& ret)
+{
+    if(!args)
+        return;
+    for(const ParenthesizedExpression::Term& term : *args)
+        ret.push_back(term.transformedExpression ? term.transformedExpression : term.expression);
+}
+
+
+IRLowering::IRLowering(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults, IRModule* module)
+:symbolRegistry(symbolRegistry), compilerResults(compilerResults), module(module), mangling(symbolRegistry), ctx(nullptr), result(IRFunction::InvalidValue)
+{
+    global = symbolRegistry->getGlobalScope();
+}
+
+IRLowering::~IRLowering()
+{
+}
+
+bool IRLowering::lower(const ScopedProgramPtr& program)
+{
+    IRFunction* main = module->getFunction(L"main");
+    if(!main)
+    {
+        main = module->addFunction(L"main");
+        main->convention = IRConvention::Thin;
+        main->result = IRModule::VoidType;
+        main->signature = module->getType(L"@thin () -> ()");
+    }
+    try
+    {
+        beginFunction(main, nullptr);
+        pushScope(program->getScope());
+        for(const StatementPtr& st : *program)
+        {
+            lowerStatement(st);
+        }
+        popScope();
+        finishFunction();
+    }
+    catch(const Abort&)
+    {
+        contexts.clear();
+        ctx = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void IRLowering::unsupported(const NodePtr& node, const std::wstring& what)
+{
+    compilerResults->add(ErrorLevel::Error, *node->getSourceInfo(), Errors::E_A_IS_NOT_SUPPORTED_IN_IR_LOWERING_1, what);
+    throw Abort();
+}
+
+std::wstring IRLowering::getName(const SymbolPtr& symbol)
+{
+    wstring name = mangling.encode(symbol);
+    if(name.empty())
+        name = symbol->getName();
+    return name;
+}
+
+IRTypeRef IRLowering::getType(const TypePtr& type)
+{
+    return module->getType(type);
+}
+
+IRTypeRef IRLowering::getMetatype(const TypePtr& type)
+{
+    const wchar_t* prefix = type->getCategory() == Type::Class ? L"@thick " : L"@thin ";
+    return module->getType(prefix + type->toString() + L".Type");
+}
+
+bool IRLowering::isTrivial(const TypePtr& type)
+{
+    if(!type)
+        return true;
+    auto iter = trivialTypes.find(type.get());
+    if(iter != trivialTypes.end())
+        return iter->second;
+    bool ret = true;
+    switch(type->getCategory())
+    {
+        case Type::Struct:
+        {
+            vector<SymbolPtr> properties;
+            getStoredProperties(type, properties);
+            for(const SymbolPtr& sym : properties)
+                ret = ret && isTrivial(sym->getType());
+            break;
+        }
+        case Type::Tuple:
+            for(int i = 0; i < type->numElementTypes(); i++)
+                ret = ret && isTrivial(type->getElementType(i));
+            break;
+        case Type::Enum:
+            for(const auto& c : type->getEnumCases())
+                ret = ret && isTrivial(c.second.type);
+            break;
+        case Type::MetaType:
+            ret = true;
+            break;
+        default:
+            //references, closures and generic containers are all reference counted
+            ret = false;
+            break;
+    }
+    trivialTypes.insert(make_pair(type.get(), ret));
+    return ret;
+}
+
+bool IRLowering::isPrimitive(const TypePtr& type)
+{
+    return type == global->Int() || type == global->UInt() || type == global->Int8() || type == global->UInt8()
+        || type == global->Int16() || type == global->UInt16() || type == global->Int32() || type == global->UInt32()
+        || type == global->Int64() || type == global->UInt64() || type == global->Float() || type == global->Double()
+        || type == global->Bool();
+}
+
+void IRLowering::emitCopy(IRValue value, const TypePtr& type)
+{
+    if(isTrivial(type))
+        return;
+    if(type->getCategory() == Type::Class)
+        ctx->builder.createStrongRetain(value);
+    else
+        ctx->builder.createRetainValue(value);
+}
+
+void IRLowering::emitDestroy(IRValue value, const TypePtr& type)
+{
+    if(isTrivial(type))
+        return;
+    if(type->getCategory() == Type::Class)
+        ctx->builder.createStrongRelease(value);
+    else
+        ctx->builder.createReleaseValue(value);
+}
+
+uint32_t IRLowering::getFieldMember(const TypePtr& type, const SymbolPtr& field)
+{
+    TypePtr owner = getOwnerType(field);
+    if(!owner)
+        owner = type;
+    vector<SymbolPtr> properties;
+    getStoredProperties(owner, properties);
+    uint32_t index = std::find(properties.begin(), properties.end(), field) - properties.begin();
+    return module->getMember(owner, field->getName(), IRMember::Field, index, field);
+}
+
+uint32_t IRLowering::getEnumCaseMember(const TypePtr& type, const std::wstring& name)
+{
+    const Type::EnumCaseMap& cases = type->getEnumCases();
+    auto iter = cases.find(name);
+    assert(iter != cases.end());
+    uint32_t index = distance(cases.begin(), iter);
+    bool hasPayload = iter->second.type != global->Void();
+    return module->getMember(type, name, IRMember::EnumCase, index, nullptr, hasPayload);
+}
+
+TypePtr IRLowering::getPayloadType(const TypePtr& type, const std::wstring& name)
+{
+    const EnumCase* c = type->getEnumCase(name);
+    assert(c != nullptr);
+    TypePtr ret = c->type;
+    //a single associated value is carried directly
+    if(ret->getCategory() == Type::Tuple && ret->numElementTypes() == 1)
+        ret = ret->getElementType(0);
+    return ret;
+}
+
+IRFunction* IRLowering::getFunction(const FunctionSymbolPtr& func)
+{
+    wstring name = getName(func);
+    IRFunction* ret = module->getFunction(name);
+    if(ret)
+        return ret;
+    ret = module->addFunction(name);
+    ret->symbol = func;
+    TypePtr type = func->getType();
+    TypePtr owner = getOwnerType(func);
+    for(const Parameter& param : type->getParameters())
+    {
+        IRTypeRef t = getType(param.type);
+        ret->parameters.push_back(param.inout ? IRModule::addressOf(t) : t);
+    }
+    ret->result = getType(type->getReturnType());
+    ret->convention = IRConvention::Thin;
+    ret->generic = type->getGenericDefinition();
+    if(owner)
+    {
+        //self is passed as the last parameter
+        ret->convention = IRConvention::Method;
+        bool isClass = owner->getCategory() == Type::Class;
+        if(isInitializer(func))
+        {
+            ret->result = getType(owner);
+            ret->parameters.push_back(isClass ? getType(owner) : getMetatype(owner));
+        }
+        else if(hasFlag(func, SymbolFlagStatic))
+            ret->parameters.push_back(getMetatype(owner));
+        else if(!isClass && hasFlag(func, SymbolFlagMutating))
+            ret->parameters.push_back(IRModule::addressOf(getType(owner)));
+        else
+            ret->parameters.push_back(getType(owner));
+    }
+    wstring signature = ret->convention == IRConvention::Method ? L"@cc(method) @thin " : L"@thin ";
+    if(ret->generic)
+    {
+        signature += L"<";
+        for(const GenericDefinition::Parameter& param : ret->generic->getParameters())
+            signature += (signature.back() == L'<' ? L"" : L", ") + param.name;
+        signature += L"> ";
+    }
+    signature += L"(";
+    for(size_t i = 0; i < ret->parameters.size(); i++)
+    {
+        IRTypeRef t = ret->parameters[i];
+        if(i)
+            signature += L", ";
+        if(IRModule::isAddress(t))
+            signature += L"@inout ";
+        signature += module->getTypeInfo(t).name;
+    }
+    signature += L") -> " + module->getTypeName(ret->result);
+    ret->signature = module->getType(signature);
+    return ret;
+}
+
+/*********************************************************************
+ * Functions
+ *********************************************************************/
+
+void IRLowering::beginFunction(IRFunction* func, const FunctionSymbolPtr& symbol)
+{
+    contexts.push_back(unique_ptr<FunctionContext>(new FunctionContext(module, func)));
+    ctx = contexts.back().get();
+    ctx->symbol = symbol;
+    uint32_t entry = ctx->builder.createBlock();
+    for(IRTypeRef type : func->parameters)
+        ctx->builder.addBlockArgument(entry, type);
+    ctx->builder.setInsertionBlock(entry);
+    ctx->cleanups.push_back(vector<Cleanup>());
+}
+
+void IRLowering::finishFunction()
+{
+    IRBuilder& b = ctx->builder;
+    if(!b.isTerminated())
+    {
+        if(ctx->isInit || ctx->function->result == IRModule::VoidType)
+            emitReturn(IRFunction::InvalidValue);
+        else
+            b.createUnreachable();//all paths of a non-void function return, this one is never reached
+    }
+    ctx->function->finish();
+    contexts.pop_back();
+    ctx = contexts.empty() ? nullptr : contexts.back().get();
+}
+
+void IRLowering::emitReturn(IRValue value)
+{
+    IRBuilder& b = ctx->builder;
+    if(ctx->isInit)
+    {
+        //initializer always returns the initialized self
+        value = ctx->selfOnStack ? b.createLoad(ctx->self.value) : ctx->self.value;
+    }
+    else if(value == IRFunction::InvalidValue)
+        value = b.createTuple(IRModule::VoidType, {});
+    emitCleanups(0);
+    if(ctx->selfOnStack)
+        b.createDeallocStack(ctx->self.value);
+    b.createReturn(value);
+}
+
+void IRLowering::lowerFunction(const FunctionSymbolPtr& symbol, const std::vector<ParameterNodePtr>& parameters, const CodeBlockPtr& body)
+{
+    if(!symbol || !body)
+        return;
+    IRFunction* func = getFunction(symbol);
+    if(!func->isExternal())
+        return;
+    TypePtr owner = getOwnerType(symbol);
+    beginFunction(func, symbol);
+    IRBuilder& b = ctx->builder;
+    SymbolScope* scope = static_pointer_cast<ScopedCodeBlock>(body)->getScope();
+    if(owner)
+    {
+        IRValue self = b.getBlockArgument(0, parameters.size());
+        ctx->selfType = owner;
+        if(isInitializer(symbol))
+        {
+            ctx->isInit = true;
+            if(owner->getCategory() == Type::Class)
+            {
+                ctx->self.value = self;
+            }
+            else
+            {
+                //allocated before any other stack slot, it's the last one to be deallocated
+                ctx->self.value = b.createAllocStack(getType(owner));
+                ctx->self.address = true;
+                ctx->selfOnStack = true;
+            }
+        }
+        else
+        {
+            ctx->self.value = self;
+            ctx->self.address = IRModule::isAddress(func->parameters.back());
+        }
+        if(SymbolPtr s = scope->lookup(L"self"))
+            ctx->variables[s.get()] = ctx->self;
+        if(SymbolPtr s = scope->lookup(L"super"))
+            ctx->variables[s.get()] = ctx->self;
+    }
+    for(size_t i = 0; i < parameters.size(); i++)
+    {
+        const ParameterNodePtr& param = parameters[i];
+        SymbolPtr sym = scope->lookup(param->getLocalName());
+        if(!sym)
+            continue;
+        Variable var = {b.getBlockArgument(0, i), param->isInout()};
+        if(!param->isInout() && sym->hasFlags(SymbolFlagWritable))
+        {
+            //a var parameter is a local copy of the argument
+            emitCopy(var.value, sym->getType());
+            IRValue address = b.createAllocStack(getType(sym->getType()));
+            b.createStore(var.value, address);
+            Cleanup cleanup = {address, !isTrivial(sym->getType())};
+            ctx->cleanups.back().push_back(cleanup);
+            var.value = address;
+            var.address = true;
+        }
+        ctx->variables[sym.get()] = var;
+    }
+    if(ctx->isInit)
+        initializeStoredProperties(owner);
+    lowerStatements(body);
+    finishFunction();
+}
+
+void IRLowering::initializeStoredProperties(const TypePtr& type)
+{
+    TypeDeclarationPtr decl = type->getReference();
+    if(!decl)
+        return;
+    IRBuilder& b = ctx->builder;
+    for(const DeclarationPtr& d : *decl)
+    {
+        if(d->getNodeType() != NodeType::ValueBindings)
+            continue;
+        ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(d);
+        for(const ValueBindingPtr& binding : *bindings)
+        {
+            if(!binding->getInitializer())
+                continue;
+            IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+            if(!id)
+                unsupported(binding, L"tuple pattern");
+            SymbolPtr field = type->getDeclaredMember(id->getIdentifier());
+            if(!isStoredProperty(field))
+                continue;
+            IRValue value = lowerExpression(binding->getInitializer());
+            uint32_t member = getFieldMember(type, field);
+            IRTypeRef fieldType = getType(field->getType());
+            IRValue address;
+            if(ctx->self.address)
+                address = b.createStructElementAddr(ctx->self.value, member, fieldType);
+            else
+                address = b.createRefElementAddr(ctx->self.value, member, fieldType);
+            b.createStore(value, address);
+            ctx->initializedFields.insert(field.get());
+        }
+    }
+}
+
+void IRLowering::lowerImplicitInit(const FunctionSymbolPtr& symbol)
+{
+    TypePtr owner = getOwnerType(symbol);
+    Type::Category category = owner->getCategory();
+    if(hasFlag(symbol, SymbolFlagFailableInitializer) || (category != Type::Struct && category != Type::Class))
+        return;
+    const vector<Parameter>& params = symbol->getType()->getParameters();
+    FunctionSymbolPtr parentInit;
+    if(category == Type::Class && owner->getParentType() && owner->getParentType()->getCategory() == Type::Class)
+    {
+        //an inherited initializer delegates to the parent's initializer with the same parameters
+        if(FunctionOverloadedSymbolPtr inits = owner->getParentType()->getDeclaredInitializer())
+        {
+            for(const FunctionSymbolPtr& init : *inits)
+            {
+                const vector<Parameter>& params2 = init->getType()->getParameters();
+                if(params2.size() != params.size())
+                    continue;
+                bool matched = true;
+                for(size_t i = 0; i < params.size() && matched; i++)
+                    matched = params[i].name == params2[i].name && Type::equals(params[i].type, params2[i].type);
+                if(matched)
+                {
+                    parentInit = init;
+                    break;
+                }
+            }
+        }
+        if(!parentInit)
+            unsupported(owner->getReference(), L"implicit initializer of " + owner->getName());
+    }
+    IRFunction* func = getFunction(symbol);
+    if(!func->isExternal())
+        return;
+    beginFunction(func, symbol);
+    IRBuilder& b = ctx->builder;
+    ctx->selfType = owner;
+    ctx->isInit = true;
+    if(category == Type::Class)
+    {
+        ctx->self.value = b.getBlockArgument(0, params.size());
+        initializeStoredProperties(owner);
+        if(parentInit)
+        {
+            vector<IRValue> args;
+            for(size_t i = 0; i <= params.size(); i++)
+                args.push_back(b.getBlockArgument(0, i));
+            b.createApply(b.createFunctionRef(getFunction(parentInit)), args, getType(owner->getParentType()));
+        }
+    }
+    else
+    {
+        ctx->self.value = b.createAllocStack(getType(owner));
+        ctx->self.address = true;
+        ctx->selfOnStack = true;
+        if(params.empty())
+        {
+            initializeStoredProperties(owner);
+        }
+        else
+        {
+            //memberwise initializer
+            vector<SymbolPtr> properties;
+            getStoredProperties(owner, properties);
+            assert(properties.size() == params.size());
+            for(size_t i = 0; i < params.size(); i++)
+            {
+                IRValue value = b.getBlockArgument(0, i);
+                emitCopy(value, params[i].type);
+                IRValue address = b.createStructElementAddr(ctx->self.value, getFieldMember(owner, properties[i]), getType(params[i].type));
+                b.createStore(value, address);
+            }
+        }
+    }
+    finishFunction();
+}
+
+void IRLowering::lowerTypeDeclaration(const TypeDeclarationPtr& node)
+{
+    TypePtr type = node->getType();
+    for(const DeclarationPtr& decl : *node)
+    {
+        switch(decl->getNodeType())
+        {
+            case NodeType::Function:
+            case NodeType::Init:
+            case NodeType::ComputedProperty:
+            case NodeType::Class:
+            case NodeType::Struct:
+            case NodeType::Enum:
+            case NodeType::Subscript:
+                decl->accept(this);
+                break;
+            case NodeType::Deinit:
+                lowerFunction(type->getDeinit(), vector<ParameterNodePtr>(), static_pointer_cast<DeinitializerDef>(decl)->getBody());
+                break;
+            default:
+                //stored properties are initialized by the initializers
+                break;
+        }
+    }
+    if(node->getNodeType() == NodeType::Extension)
+        return;
+    if(FunctionOverloadedSymbolPtr inits = type->getDeclaredInitializer())
+    {
+        for(const FunctionSymbolPtr& init : *inits)
+        {
+            if(getFunction(init)->isExternal())
+                lowerImplicitInit(init);
+        }
+    }
+}
+
+void IRLowering::visitClass(const ClassDefPtr& node)
+{
+    lowerTypeDeclaration(node);
+}
+
+void IRLowering::visitStruct(const StructDefPtr& node)
+{
+    lowerTypeDeclaration(node);
+}
+
+void IRLowering::visitEnum(const EnumDefPtr& node)
+{
+    lowerTypeDeclaration(node);
+}
+
+void IRLowering::visitExtension(const ExtensionDefPtr& node)
+{
+    lowerTypeDeclaration(node);
+}
+
+void IRLowering::visitProtocol(const ProtocolDefPtr& node)
+{
+    //protocols have no implementation
+}
+
+void IRLowering::visitFunction(const FunctionDefPtr& node)
+{
+    FunctionSymbolPtr symbol = static_pointer_cast<SymboledFunction>(node)->symbol;
+    if(node->numParameters() > 1)
+        unsupported(node, L"curried function");
+    vector<ParameterNodePtr> params;
+    if(node->numParameters())
+        params.assign(node->getParameters(0)->begin(), node->getParameters(0)->end());
+    lowerFunction(symbol, params, node->getBody());
+}
+
+void IRLowering::visitDeinit(const DeinitializerDefPtr& node)
+{
+    //lowered by its type declaration
+}
+
+void IRLowering::visitInit(const InitializerDefPtr& node)
+{
+    FunctionSymbolPtr symbol = static_pointer_cast<SymboledInit>(node)->symbol;
+    if(node->isFailable() || node->isImplicitFailable())
+        unsupported(node, L"failable initializer");
+    vector<ParameterNodePtr> params(node->getParameters()->begin(), node->getParameters()->end());
+    lowerFunction(symbol, params, node->getBody());
+}
+
+void IRLowering::visitComputedProperty(const ComputedPropertyPtr& node)
+{
+    if(node->getWillSet() || node->getDidSet())
+        unsupported(node, L"property observer");
+    shared_ptr<ComposedComputedProperty> property = static_pointer_cast<ComposedComputedProperty>(node);
+    if(SymboledFunctionPtr getter = property->functions.getter)
+        getter->accept(this);
+    if(SymboledFunctionPtr setter = property->functions.setter)
+        setter->accept(this);
+}
+
+void IRLowering::visitSubscript(const SubscriptDefPtr& node)
+{
+    unsupported(node, L"subscript");
+}
+
+void IRLowering::visitTypeAlias(const TypeAliasPtr& node)
+{
+}
+
+void IRLowering::visitImport(const ImportPtr& node)
+{
+}
+
+void IRLowering::visitOperator(const OperatorDefPtr& node)
+{
+}
+
+/*********************************************************************
+ * Statements
+ *********************************************************************/
+
+void IRLowering::lowerStatement(const StatementPtr& statement)
+{
+    result = IRFunction::InvalidValue;
+    statement->accept(this);
+    if(result != IRFunction::InvalidValue)
+    {
+        //discarded value of an expression statement
+        if(ExpressionPtr expr = dynamic_pointer_cast<Expression>(statement))
+            emitDestroy(result, expr->getType());
+    }
+    result = IRFunction::InvalidValue;
+}
+
+void IRLowering::lowerStatements(const CodeBlockPtr& codeBlock)
+{
+    pushScope(static_pointer_cast<ScopedCodeBlock>(codeBlock)->getScope());
+    for(const StatementPtr& st : *codeBlock)
+    {
+        //statements after return/break/continue are never executed
+        if(ctx->builder.isTerminated())
+            break;
+        lowerStatement(st);
+    }
+    popScope();
+}
+
+void IRLowering::pushScope(SymbolScope* scope)
+{
+    ctx->scopes.push_back(scope);
+    ctx->cleanups.push_back(vector<Cleanup>());
+}
+
+void IRLowering::popScope()
+{
+    if(!ctx->builder.isTerminated())
+        emitCleanups(ctx->cleanups.size() - 1);
+    ctx->scopes.pop_back();
+    ctx->cleanups.pop_back();
+}
+
+void IRLowering::emitCleanups(size_t depth)
+{
+    IRBuilder& b = ctx->builder;
+    for(size_t i = ctx->cleanups.size(); i > depth; i--)
+    {
+        const vector<Cleanup>& cleanups = ctx->cleanups[i - 1];
+        for(auto iter = cleanups.rbegin(); iter != cleanups.rend(); iter++)
+        {
+            if(iter->destroy)
+                b.createDestroyAddr(iter->address);
+            b.createDeallocStack(iter->address);
+        }
+    }
+}
+
+void IRLowering::declareLocal(const SymbolPtr& symbol, IRValue value)
+{
+    IRBuilder& b = ctx->builder;
+    TypePtr type = symbol->getType();
+    IRValue address = b.createAllocStack(getType(type));
+    Cleanup cleanup = {address, !isTrivial(type)};
+    ctx->cleanups.back().push_back(cleanup);
+    Variable var = {address, true};
+    ctx->variables[symbol.get()] = var;
+    if(value != IRFunction::InvalidValue)
+        b.createStore(value, address);
+}
+
+SymbolPtr IRLowering::lookupLocal(const std::wstring& name)
+{
+    for(auto iter = ctx->scopes.rbegin(); iter != ctx->scopes.rend(); iter++)
+    {
+        if(!*iter)
+            continue;
+        if(SymbolPtr ret = (*iter)->lookup(name))
+            return ret;
+    }
+    return nullptr;
+}
+
+void IRLowering::visitValueBindings(const ValueBindingsPtr& node)
+{
+    for(const ValueBindingPtr& binding : *node)
+    {
+        IdentifierPtr id = dynamic_pointer_cast<Identifier>(binding->getName());
+        if(!id)
+            unsupported(binding, L"tuple pattern");
+        SymbolPlaceHolderPtr var = dynamic_pointer_cast<SymbolPlaceHolder>(lookupLocal(id->getIdentifier()));
+        if(!var)
+            unsupported(binding, id->getIdentifier());
+        TypePtr type = var->getType();
+        IRValue value = IRFunction::InvalidValue;
+        if(binding->getInitializer())
+            value = lowerExpression(binding->getInitializer());
+        if(var->getRole() == SymbolPlaceHolder::R_TOP_LEVEL_VARIABLE)
+        {
+            uint32_t g = module->getGlobal(getName(var), getType(type), var);
+            if(value != IRFunction::InvalidValue)
+                ctx->builder.createStore(value, ctx->builder.createGlobalAddr(g));
+        }
+        else
+        {
+            if(value == IRFunction::InvalidValue && !isTrivial(type))
+                unsupported(binding, L"uninitialized variable of non-trivial type");
+            declareLocal(var, value);
+        }
+    }
+}
+
+void IRLowering::visitCodeBlock(const CodeBlockPtr& node)
+{
+    lowerStatements(node);
+}
+
+void IRLowering::visitIf(const IfStatementPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    IRValue cond = lowerCondition(node->getCondition());
+    uint32_t thenBlock = b.createBlock();
+    uint32_t exitBlock = b.createBlock();
+    uint32_t elseBlock = node->getElse() ? b.createBlock() : exitBlock;
+    b.createCondBr(cond, thenBlock, elseBlock);
+
+    b.setInsertionBlock(thenBlock);
+    lowerStatements(node->getThen());
+    if(!b.isTerminated())
+        b.createBr(exitBlock);
+    if(node->getElse())
+    {
+        b.setInsertionBlock(elseBlock);
+        lowerStatement(node->getElse());
+        if(!b.isTerminated())
+            b.createBr(exitBlock);
+    }
+    b.setInsertionBlock(exitBlock);
+}
+
+void IRLowering::visitWhileLoop(const WhileLoopPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    uint32_t header = b.createBlock();
+    uint32_t body = b.createBlock();
+    uint32_t exit = b.createBlock();
+    b.createBr(header);
+    b.setInsertionBlock(header);
+    b.createCondBr(lowerCondition(node->getCondition()), body, exit);
+
+    b.setInsertionBlock(body);
+    Loop loop = {exit, header, ctx->cleanups.size()};
+    ctx->loops.push_back(loop);
+    lowerStatements(node->getCodeBlock());
+    ctx->loops.pop_back();
+    if(!b.isTerminated())
+        b.createBr(header);
+    b.setInsertionBlock(exit);
+}
+
+void IRLowering::visitDoLoop(const DoLoopPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    uint32_t body = b.createBlock();
+    uint32_t condition = b.createBlock();
+    uint32_t exit = b.createBlock();
+    b.createBr(body);
+    b.setInsertionBlock(body);
+    Loop loop = {exit, condition, ctx->cleanups.size()};
+    ctx->loops.push_back(loop);
+    lowerStatements(node->getCodeBlock());
+    ctx->loops.pop_back();
+    if(!b.isTerminated())
+        b.createBr(condition);
+
+    b.setInsertionBlock(condition);
+    b.createCondBr(lowerCondition(node->getCondition()), body, exit);
+    b.setInsertionBlock(exit);
+}
+
+void IRLowering::visitForLoop(const ForLoopPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    //the initializer is declared in the scope of loop's body
+    pushScope(static_pointer_cast<ScopedCodeBlock>(node->getCodeBlock())->getScope());
+    if(node->getInitializer())
+        lowerStatement(node->getInitializer());
+    for(int i = 0; i < node->numInit(); i++)
+        lowerStatement(node->getInit(i));
+    uint32_t header = b.createBlock();
+    uint32_t body = b.createBlock();
+    uint32_t step = b.createBlock();
+    uint32_t exit = b.createBlock();
+    b.createBr(header);
+    b.setInsertionBlock(header);
+    if(node->getCondition())
+        b.createCondBr(lowerCondition(node->getCondition()), body, exit);
+    else
+        b.createBr(body);
+
+    b.setInsertionBlock(body);
+    Loop loop = {exit, step, ctx->cleanups.size()};
+    ctx->loops.push_back(loop);
+    lowerStatements(node->getCodeBlock());
+    ctx->loops.pop_back();
+    if(!b.isTerminated())
+        b.createBr(step);
+
+    b.setInsertionBlock(step);
+    if(node->getStep())
+        lowerStatement(node->getStep());
+    b.createBr(header);
+    b.setInsertionBlock(exit);
+    popScope();
+}
+
+void IRLowering::visitForIn(const ForInLoopPtr& node)
+{
+    unsupported(node, L"for-in");
+}
+
+void IRLowering::visitLabeledStatement(const LabeledStatementPtr& node)
+{
+    unsupported(node, L"labeled statement");
+}
+
+void IRLowering::visitFallthrough(const FallthroughStatementPtr& node)
+{
+    unsupported(node, L"fallthrough");
+}
+
+void IRLowering::visitBreak(const BreakStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled break");
+    assert(!ctx->loops.empty());
+    const Loop& loop = ctx->loops.back();
+    emitCleanups(loop.depth);
+    ctx->builder.createBr(loop.breakBlock);
+}
+
+void IRLowering::visitContinue(const ContinueStatementPtr& node)
+{
+    if(!node->getLoop().empty())
+        unsupported(node, L"labeled continue");
+    //switch statements can be broken but not continued
+    for(auto iter = ctx->loops.rbegin(); iter != ctx->loops.rend(); iter++)
+    {
+        if(iter->continueBlock == IRFunction::InvalidBlock)
+            continue;
+        emitCleanups(iter->depth);
+        ctx->builder.createBr(iter->continueBlock);
+        return;
+    }
+    assert(0 && "continue outside of loop");
+}
+
+void IRLowering::visitReturn(const ReturnStatementPtr& node)
+{
+    IRValue value = IRFunction::InvalidValue;
+    if(node->getExpression())
+        value = lowerExpression(node->getExpression());
+    emitReturn(value);
+}
+
+void IRLowering::visitSwitchCase(const SwitchCasePtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    ExpressionPtr control = node->getControlExpression();
+    TypePtr type = control->getType();
+    IRValue value = lowerExpression(control);
+    pushScope(nullptr);
+    if(!isTrivial(type))
+    {
+        //keep the value in a temporary, so it's released on every path that leaves the switch
+        IRValue temp = b.createAllocStack(getType(type));
+        b.createStore(value, temp);
+        Cleanup cleanup = {temp, true};
+        ctx->cleanups.back().push_back(cleanup);
+        value = b.createLoad(temp);
+    }
+    uint32_t exit = b.createBlock();
+    Loop loop = {exit, IRFunction::InvalidBlock, ctx->cleanups.size()};
+    ctx->loops.push_back(loop);
+    if(type->getCategory() == Type::Enum)
+        lowerSwitchOnEnum(node, value, exit);
+    else if(isPrimitive(type))
+        lowerSwitchOnValue(node, value, exit);
+    else
+        unsupported(control, L"switch on " + type->toString());
+    ctx->loops.pop_back();
+    b.setInsertionBlock(exit);
+    popScope();
+}
+
+/*!
+ * Gets the name of enum case and the associated value's pattern from a case pattern
+ */
+static bool getEnumCasePattern(const PatternPtr& condition, wstring& name, TuplePtr& binding)
+{
+    PatternPtr pattern = condition;
+    if(pattern->getNodeType() == NodeType::ValueBindingPattern)
+        pattern = static_pointer_cast<ValueBindingPattern>(pattern)->getBinding();
+    switch(pattern->getNodeType())
+    {
+        case NodeType::Identifier:
+            name = static_pointer_cast<Identifier>(pattern)->getIdentifier();
+            return true;
+        case NodeType::EnumCasePattern:
+        {
+            EnumCasePatternPtr ec = static_pointer_cast<EnumCasePattern>(pattern);
+            name = ec->getName();
+            binding = ec->getAssociatedBinding();
+            return true;
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(pattern);
+            if(!ma->getField())
+                return false;
+            name = ma->getField()->getIdentifier();
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void IRLowering::lowerSwitchOnEnum(const SwitchCasePtr& node, IRValue value, uint32_t exitBlock)
+{
+    IRBuilder& b = ctx->builder;
+    TypePtr type = node->getControlExpression()->getType();
+    vector<pair<uint32_t, uint32_t> > cases;
+    vector<uint32_t> blocks;
+    for(const CaseStatementPtr& c : *node)
+    {
+        uint32_t block = b.createBlock();
+        blocks.push_back(block);
+        for(const CaseStatement::Condition& cond : c->getConditions())
+        {
+            wstring name;
+            TuplePtr binding;
+            if(cond.guard)
+                unsupported(cond.guard, L"guard of case");
+            if(!getEnumCasePattern(cond.condition, name, binding) || !type->getEnumCase(name))
+                unsupported(cond.condition, L"case pattern");
+            if(binding && c->numConditions() > 1)
+                unsupported(cond.condition, L"binding in case with multiple patterns");
+            cases.push_back(make_pair(getEnumCaseMember(type, name), block));
+        }
+    }
+    uint32_t defaultBlock = node->getDefaultCase() ? b.createBlock() : IRFunction::InvalidBlock;
+    b.createSwitchEnum(value, cases, defaultBlock);
+
+    int idx = 0;
+    for(const CaseStatementPtr& c : *node)
+    {
+        b.setInsertionBlock(blocks[idx++]);
+        pushScope(static_pointer_cast<ScopedCodeBlock>(c->getCodeBlock())->getScope());
+        const CaseStatement::Condition& cond = c->getCondition(0);
+        wstring name;
+        TuplePtr binding;
+        getEnumCasePattern(cond.condition, name, binding);
+        if(binding)
+        {
+            TypePtr payloadType = getPayloadType(type, name);
+            IRValue payload = b.createUncheckedEnumData(value, getEnumCaseMember(type, name), getType(payloadType));
+            bindPayload(binding, payload, payloadType);
+        }
+        lowerStatements(c->getCodeBlock());
+        popScope();
+        if(!b.isTerminated())
+            b.createBr(exitBlock);
+    }
+    if(defaultBlock != IRFunction::InvalidBlock)
+    {
+        b.setInsertionBlock(defaultBlock);
+        lowerStatements(node->getDefaultCase()->getCodeBlock());
+        if(!b.isTerminated())
+            b.createBr(exitBlock);
+    }
+}
+
+void IRLowering::bindPayload(const PatternPtr& pattern, IRValue payload, const TypePtr& type)
+{
+    IRBuilder& b = ctx->builder;
+    switch(pattern->getNodeType())
+    {
+        case NodeType::ValueBindingPattern:
+            bindPayload(static_pointer_cast<ValueBindingPattern>(pattern)->getBinding(), payload, type);
+            break;
+        case NodeType::Tuple:
+        {
+            TuplePtr tuple = static_pointer_cast<Tuple>(pattern);
+            if(tuple->numElements() == 1 && type->getCategory() != Type::Tuple)
+            {
+                bindPayload(tuple->getElement(0), payload, type);
+                break;
+            }
+            for(int i = 0; i < tuple->numElements(); i++)
+            {
+                TypePtr elementType = type->getElementType(i);
+                IRValue element = b.createTupleExtract(payload, i, getType(elementType));
+                bindPayload(tuple->getElement(i), element, elementType);
+            }
+            break;
+        }
+        case NodeType::Identifier:
+        {
+            const wstring& name = static_pointer_cast<Identifier>(pattern)->getIdentifier();
+            if(name == L"_")
+                break;
+            SymbolPtr sym = lookupLocal(name);
+            assert(sym != nullptr);
+            emitCopy(payload, type);
+            declareLocal(sym, payload);
+            break;
+        }
+        default:
+            unsupported(pattern, L"case pattern");
+    }
+}
+
+void IRLowering::lowerSwitchOnValue(const SwitchCasePtr& node, IRValue value, uint32_t exitBlock)
+{
+    IRBuilder& b = ctx->builder;
+    TypePtr type = node->getControlExpression()->getType();
+    wstring compare = L"cmp_eq_" + type->getName();
+    IRTypeRef Bool = getType(global->Bool());
+    //test the patterns one by one, then lay out the case bodies
+    vector<uint32_t> blocks;
+    for(const CaseStatementPtr& c : *node)
+    {
+        uint32_t block = b.createBlock();
+        blocks.push_back(block);
+        for(const CaseStatement::Condition& cond : c->getConditions())
+        {
+            if(cond.guard)
+                unsupported(cond.guard, L"guard of case");
+            if(!dynamic_pointer_cast<Expression>(cond.condition))
+                unsupported(cond.condition, L"case pattern");
+            IRValue pattern = lowerExpression(cond.condition);
+            IRValue matched = b.createBuiltin(compare, {value, pattern}, Bool);
+            uint32_t next = b.createBlock();
+            b.createCondBr(matched, block, next);
+            b.setInsertionBlock(next);
+        }
+    }
+    uint32_t defaultBlock = IRFunction::InvalidBlock;
+    if(node->getDefaultCase())
+    {
+        defaultBlock = b.createBlock();
+        b.createBr(defaultBlock);
+    }
+    else
+    {
+        b.createUnreachable();
+    }
+    int idx = 0;
+    for(const CaseStatementPtr& c : *node)
+    {
+        b.setInsertionBlock(blocks[idx++]);
+        lowerStatements(c->getCodeBlock());
+        if(!b.isTerminated())
+            b.createBr(exitBlock);
+    }
+    if(defaultBlock != IRFunction::InvalidBlock)
+    {
+        b.setInsertionBlock(defaultBlock);
+        lowerStatements(node->getDefaultCase()->getCodeBlock());
+        if(!b.isTerminated())
+            b.createBr(exitBlock);
+    }
+}
+
+/*********************************************************************
+ * Expressions
+ *********************************************************************/
+
+IRValue IRLowering::lowerExpression(const PatternPtr& expr)
+{
+    result = IRFunction::InvalidValue;
+    expr->accept(this);
+    IRValue ret = result;
+    if(ret == IRFunction::InvalidValue)
+        ret = ctx->builder.createTuple(IRModule::VoidType, {});
+    result = IRFunction::InvalidValue;
+    return ret;
+}
+
+IRValue IRLowering::lowerCondition(const ExpressionPtr& expr)
+{
+    if(expr->getNodeType() == NodeType::Assignment && static_pointer_cast<Assignment>(expr)->getLHS()->getNodeType() == NodeType::ValueBindingPattern)
+        unsupported(expr, L"optional binding");
+    if(expr->getType() != global->Bool())
+        unsupported(expr, L"condition of type " + expr->getType()->toString());
+    return lowerExpression(expr);
+}
+
+IRLowering::Variable* IRLowering::findVariable(const SymbolPtr& symbol)
+{
+    auto iter = ctx->variables.find(symbol.get());
+    if(iter == ctx->variables.end())
+        return nullptr;
+    return &iter->second;
+}
+
+/*!
+ * Resolves the symbol an identifier refers to.
+ * Operands of operators are not updated with the analyzer's transformation, so an identifier may refer to a member
+ * of self implicitly, it's returned as a member access on self.
+ */
+static SymbolPtr resolveIdentifier(const IdentifierPtr& id, const vector<SymbolScope*>& scopes, const TypePtr& selfType)
+{
+    if(SymbolPtr ret = id->getReferencedSymbol())
+        return ret;
+    const wstring& name = id->getIdentifier();
+    for(auto iter = scopes.rbegin(); iter != scopes.rend(); iter++)
+    {
+        for(SymbolScope* scope = *iter; scope; scope = scope->getParentScope())
+        {
+            if(SymbolPtr ret = scope->lookup(name))
+                return ret;
+        }
+    }
+    if(selfType)
+        return selfType->getMember(name);
+    return nullptr;
+}
+
+bool IRLowering::isAddressable(const ExpressionPtr& expr)
+{
+    switch(expr->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            SymbolPtr sym = resolveIdentifier(static_pointer_cast<Identifier>(expr), ctx->scopes, ctx->selfType);
+            if(Variable* var = findVariable(sym))
+                return var->address;
+            if(isStoredProperty(sym))
+                return ctx->self.address || ctx->selfType->getCategory() == Type::Class;
+            SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(sym);
+            return s && s->getRole() == SymbolPlaceHolder::R_TOP_LEVEL_VARIABLE;
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(expr);
+            if(!ma->getSelf())
+                return false;
+            TypePtr baseType = ma->getSelf()->getType();
+            if(!ma->getField())
+                return baseType->getCategory() == Type::Tuple && isAddressable(ma->getSelf());
+            if(!isStoredProperty(ma->getReferencedSymbol()))
+                return false;
+            if(baseType->getCategory() == Type::Class)
+                return true;
+            return isAddressable(ma->getSelf());
+        }
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+            return p->numExpressions() == 1 && isAddressable(p->get(0));
+        }
+        default:
+            return false;
+    }
+}
+
+IRLowering::LValue IRLowering::lowerLValue(const ExpressionPtr& expr)
+{
+    IRBuilder& b = ctx->builder;
+    LValue ret = {IRFunction::InvalidValue, IRFunction::InvalidValue};
+    switch(expr->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            SymbolPtr sym = resolveIdentifier(static_pointer_cast<Identifier>(expr), ctx->scopes, ctx->selfType);
+            if(Variable* var = findVariable(sym))
+            {
+                ret.address = var->value;
+            }
+            else if(isStoredProperty(sym))
+            {
+                //implicit member of self
+                uint32_t member = getFieldMember(ctx->selfType, sym);
+                IRTypeRef type = getType(sym->getType());
+                if(ctx->self.address)
+                    ret.address = b.createStructElementAddr(ctx->self.value, member, type);
+                else
+                    ret.address = b.createRefElementAddr(ctx->self.value, member, type);
+            }
+            else
+            {
+                uint32_t g = module->getGlobal(getName(sym), getType(sym->getType()), sym);
+                ret.address = b.createGlobalAddr(g);
+            }
+            break;
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(expr);
+            ExpressionPtr base = ma->getSelf();
+            TypePtr baseType = base->getType();
+            if(!ma->getField())
+            {
+                ret = lowerLValue(base);
+                ret.address = b.createTupleElementAddr(ret.address, ma->getIndex(), getType(baseType->getElementType(ma->getIndex())));
+                break;
+            }
+            SymbolPtr field = ma->getReferencedSymbol();
+            IRTypeRef type = getType(field->getType());
+            if(baseType->getCategory() == Type::Class)
+            {
+                bool owned = false;
+                IRValue ref = lowerBorrowed(base, owned);
+                if(owned)
+                    ret.owner = ref;
+                ret.address = b.createRefElementAddr(ref, getFieldMember(baseType, field), type);
+            }
+            else
+            {
+                ret = lowerLValue(base);
+                ret.address = b.createStructElementAddr(ret.address, getFieldMember(baseType, field), type);
+            }
+            break;
+        }
+        case NodeType::ParenthesizedExpression:
+            ret = lowerLValue(static_pointer_cast<ParenthesizedExpression>(expr)->get(0));
+            break;
+        default:
+            assert(0 && "expression is not addressable");
+            break;
+    }
+    return ret;
+}
+
+IRValue IRLowering::lowerBorrowed(const ExpressionPtr& expr, bool& owned)
+{
+    if(expr->getNodeType() == NodeType::Identifier)
+    {
+        SymbolPtr sym = resolveIdentifier(static_pointer_cast<Identifier>(expr), ctx->scopes, ctx->selfType);
+        Variable* var = sym ? findVariable(sym) : nullptr;
+        if(var && !var->address)
+        {
+            owned = false;
+            return var->value;
+        }
+    }
+    else if(expr->getNodeType() == NodeType::ParenthesizedExpression)
+    {
+        ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+        if(p->numExpressions() == 1)
+            return lowerBorrowed(p->get(0), owned);
+    }
+    owned = true;
+    return lowerExpression(expr);
+}
+
+IRValue IRLowering::loadCopy(const LValue& lv, const TypePtr& type)
+{
+    IRBuilder& b = ctx->builder;
+    IRValue ret = b.createLoad(lv.address);
+    emitCopy(ret, type);
+    if(lv.owner != IRFunction::InvalidValue)
+        b.createStrongRelease(lv.owner);
+    return ret;
+}
+
+IRValue IRLowering::lowerEnumCase(const TypePtr& type, const std::wstring& name, IRValue payload)
+{
+    return ctx->builder.createEnum(getType(type), getEnumCaseMember(type, name), payload);
+}
+
+/*!
+ * Checks if the symbol refers to an enum case without associated values, e.g. Color.Red
+ */
+static bool isEnumCaseReference(const SymbolPtr& sym, const TypePtr& type, const wstring& name)
+{
+    if(!type || type->getCategory() != Type::Enum || !type->getEnumCase(name))
+        return false;
+    if(!sym)
+        return true;
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(sym);
+    return s && s->hasFlags(SymbolFlagStatic) && s->getRole() == SymbolPlaceHolder::R_PARAMETER;
+}
+
+void IRLowering::visitIdentifier(const IdentifierPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    const wstring& name = node->getIdentifier();
+    SymbolPtr sym = resolveIdentifier(node, ctx->scopes, ctx->selfType);
+    if(isEnumCaseReference(sym, node->getType(), name))
+    {
+        result = lowerEnumCase(node->getType(), name, IRFunction::InvalidValue);
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        result = lowerGetter(property->getGetter(), nullptr);
+        return;
+    }
+    TypePtr type = sym ? sym->getType() : nullptr;
+    if(Variable* var = findVariable(sym))
+    {
+        if(var->address)
+        {
+            result = b.createLoad(var->value);
+            emitCopy(result, type);
+        }
+        else
+        {
+            emitCopy(var->value, type);
+            result = var->value;
+        }
+        return;
+    }
+    if(isAddressable(node))
+    {
+        result = loadCopy(lowerLValue(node), type);
+        return;
+    }
+    if(isStoredProperty(sym) && ctx->self.value != IRFunction::InvalidValue && ctx->selfType->getCategory() != Type::Class)
+    {
+        //implicit self.field in a non-mutating struct method
+        result = b.createStructExtract(ctx->self.value, getFieldMember(ctx->selfType, sym), getType(type));
+        emitCopy(result, type);
+        return;
+    }
+    SymbolPlaceHolderPtr s = dynamic_pointer_cast<SymbolPlaceHolder>(sym);
+    if(s && s->getRole() == SymbolPlaceHolder::R_UPVALUE)
+        unsupported(node, L"captured variable " + name);
+    unsupported(node, L"reference to " + name);
+}
+
+void IRLowering::visitMemberAccess(const MemberAccessPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    ExpressionPtr base = node->getSelf();
+    TypePtr type = node->getType();
+    SymbolPtr sym = node->getReferencedSymbol();
+    if(!node->getField())
+    {
+        //tuple element
+        if(isAddressable(node))
+        {
+            result = loadCopy(lowerLValue(node), type);
+            return;
+        }
+        bool owned = false;
+        IRValue tuple = lowerBorrowed(base, owned);
+        result = b.createTupleExtract(tuple, node->getIndex(), getType(type));
+        emitCopy(result, type);
+        if(owned)
+            emitDestroy(tuple, base->getType());
+        return;
+    }
+    const wstring& name = node->getField()->getIdentifier();
+    if(isEnumCaseReference(sym, type, name))
+    {
+        result = lowerEnumCase(type, name, IRFunction::InvalidValue);
+        return;
+    }
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        if(property->hasFlags(SymbolFlagStatic))
+            unsupported(node, L"static property " + name);
+        result = lowerGetter(property->getGetter(), base);
+        return;
+    }
+    if(!base || !isStoredProperty(sym))
+        unsupported(node, L"member access of " + name);
+    if(isAddressable(node))
+    {
+        result = loadCopy(lowerLValue(node), type);
+        return;
+    }
+    //field of a temporary struct value
+    bool owned = false;
+    IRValue value = lowerBorrowed(base, owned);
+    result = b.createStructExtract(value, getFieldMember(base->getType(), sym), getType(type));
+    emitCopy(result, type);
+    if(owned)
+        emitDestroy(value, base->getType());
+}
+
+IRValue IRLowering::lowerGetter(const FunctionSymbolPtr& getter, const ExpressionPtr& base)
+{
+    return lowerCall(nullptr, getter, base, vector<ExpressionPtr>());
+}
+
+void IRLowering::visitFunctionCall(const FunctionCallPtr& node)
+{
+    ExpressionPtr callee = node->getFunction();
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    if(!func)
+        unsupported(node, L"call of function value");
+    vector<ExpressionPtr> args;
+    getArguments(node->getArguments(), args);
+    if(func->getRole() == FunctionRoleEnumCase)
+    {
+        IRBuilder& b = ctx->builder;
+        TypePtr type = node->getType();
+        const wstring& name = static_pointer_cast<MemberAccess>(callee)->getField()->getIdentifier();
+        IRValue payload;
+        if(args.size() == 1)
+        {
+            payload = lowerExpression(args[0]);
+        }
+        else
+        {
+            vector<IRValue> elements;
+            for(const ExpressionPtr& arg : args)
+                elements.push_back(lowerExpression(arg));
+            payload = b.createTuple(getType(getPayloadType(type, name)), elements);
+        }
+        result = lowerEnumCase(type, name, payload);
+        return;
+    }
+    ExpressionPtr base;
+    if(callee->getNodeType() == NodeType::MemberAccess)
+        base = static_pointer_cast<MemberAccess>(callee)->getSelf();
+    result = lowerCall(node, func, base, args);
+}
+
+IRValue IRLowering::lowerCall(const ExpressionPtr& node, const FunctionSymbolPtr& func, const ExpressionPtr& base, const std::vector<ExpressionPtr>& arguments)
+{
+    IRBuilder& b = ctx->builder;
+    TypePtr owner = getOwnerType(func);
+    if(!owner && isBuiltin(func, arguments))
+        return lowerBuiltin(node, func, arguments);
+    if(func->getType()->hasVariadicParameters() || func->getType()->getParameters().size() != arguments.size())
+        unsupported(node, L"default or variadic arguments");
+    //a specialized call site refers to the generic function with its generic arguments
+    IRFunction* callee = getFunction(func->getGenericFunction() ? func->getGenericFunction() : func);
+    IRTypeRef resultType = callee->result;
+    uint32_t substitution = 0;
+    if(func->getGenericFunction())
+    {
+        vector<IRTypeRef> types;
+        for(const TypePtr& arg : *func->getGenericArguments())
+            types.push_back(getType(arg));
+        substitution = module->getSubstitution(types);
+        resultType = getType(func->getType()->getReturnType());
+    }
+    vector<IRValue> args;
+    //values that are owned by the caller and released after the call
+    vector<pair<IRValue, TypePtr> > releases;
+    IRValue self = IRFunction::InvalidValue;
+    bool dynamicDispatch = false;
+    bool delegation = false;
+    if(owner)
+    {
+        bool isClass = owner->getCategory() == Type::Class;
+        if(isInitializer(func))
+        {
+            delegation = isSelfIdentifier(base);
+            if(delegation && isClass)
+                self = ctx->self.value;
+            else if(isClass)
+                self = b.createAllocRef(getType(owner));
+            else
+                self = b.createMetatype(getMetatype(owner));
+        }
+        else if(hasFlag(func, SymbolFlagStatic))
+        {
+            self = b.createMetatype(getMetatype(owner));
+        }
+        else if(!isClass && hasFlag(func, SymbolFlagMutating))
+        {
+            if(base)
+            {
+                LValue lv = lowerLValue(base);
+                self = lv.address;
+                if(lv.owner != IRFunction::InvalidValue)
+                    releases.push_back(make_pair(lv.owner, base->getType()));
+            }
+            else
+            {
+                assert(ctx->self.address);
+                self = ctx->self.value;
+            }
+        }
+        else if(base)
+        {
+            bool owned = false;
+            self = lowerBorrowed(base, owned);
+            if(owned)
+                releases.push_back(make_pair(self, base->getType()));
+        }
+        else if(ctx->self.address)
+        {
+            self = b.createLoad(ctx->self.value);
+            emitCopy(self, owner);
+            releases.push_back(make_pair(self, owner));
+        }
+        else
+        {
+            self = ctx->self.value;
+        }
+        dynamicDispatch = isClass && !isInitializer(func) && !hasFlag(func, SymbolFlagStatic)
+            && !hasFlag(func, SymbolFlagFinal) && !func->hasFlags(SymbolFlagExtension);
+    }
+    const vector<Parameter>& params = func->getType()->getParameters();
+    for(size_t i = 0; i < arguments.size(); i++)
+    {
+        ExpressionPtr arg = arguments[i];
+        if(params[i].inout)
+        {
+            if(arg->getNodeType() == NodeType::InOut)
+                arg = static_pointer_cast<InOutParameter>(arg)->getOperand();
+            if(!isAddressable(arg))
+                unsupported(arg, L"inout argument");
+            LValue lv = lowerLValue(arg);
+            args.push_back(lv.address);
+            if(lv.owner != IRFunction::InvalidValue)
+                releases.push_back(make_pair(lv.owner, arg->getType()));
+            continue;
+        }
+        bool owned = false;
+        IRValue value = lowerBorrowed(arg, owned);
+        args.push_back(value);
+        if(owned)
+            releases.push_back(make_pair(value, params[i].type));
+    }
+    if(self != IRFunction::InvalidValue)
+        args.push_back(self);
+    IRValue calleeValue;
+    if(dynamicDispatch)
+        calleeValue = b.createClassMethod(self, module->getMember(owner, func->getName(), IRMember::Method, 0, func), callee->signature);
+    else
+        calleeValue = b.createFunctionRef(callee);
+    IRValue ret = b.createApply(calleeValue, args, resultType, substitution);
+    for(auto iter = releases.rbegin(); iter != releases.rend(); iter++)
+        emitDestroy(iter->first, iter->second);
+    if(delegation)
+    {
+        //self.init/super.init initializes self in place
+        if(ctx->selfOnStack)
+            b.createStore(ret, ctx->self.value);
+        return IRFunction::InvalidValue;
+    }
+    return ret;
+}
+
+/*!
+ * Name of the builtin that implements a standard library's operator on primitive types
+ */
+static const wchar_t* getBuiltinName(const wstring& op, size_t numArguments)
+{
+    static const struct
+    {
+        const wchar_t* op;
+        const wchar_t* builtin;
+    } binaries[] = {
+        {L"+", L"add"}, {L"-", L"sub"}, {L"*", L"mul"}, {L"/", L"div"}, {L"%", L"rem"},
+        {L"&+", L"wrapping_add"}, {L"&-", L"wrapping_sub"}, {L"&*", L"wrapping_mul"}, {L"&/", L"wrapping_div"}, {L"&%", L"wrapping_rem"},
+        {L"==", L"cmp_eq"}, {L"!=", L"cmp_ne"}, {L"<", L"cmp_lt"}, {L"<=", L"cmp_le"}, {L">", L"cmp_gt"}, {L">=", L"cmp_ge"},
+        {L"&", L"and"}, {L"|", L"or"}, {L"^", L"xor"}, {L"<<", L"shl"}, {L">>", L"shr"},
+        {nullptr, nullptr}
+    };
+    if(numArguments == 2)
+    {
+        for(int i = 0; binaries[i].op; i++)
+        {
+            if(op == binaries[i].op)
+                return binaries[i].builtin;
+        }
+        return nullptr;
+    }
+    if(op == L"-")
+        return L"neg";
+    if(op == L"!" || op == L"~")
+        return L"not";
+    if(op == L"+" || op == L"++" || op == L"--")
+        return L"";
+    return nullptr;
+}
+
+bool IRLowering::isBuiltin(const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    //operators on primitive types are declared by GlobalScope without definitions, ++/-- are not flagged as operators
+    if(func->getDefinition())
+        return false;
+    if(!isPrimitive(func->getReturnType()))
+        return false;
+    for(const Parameter& param : func->getType()->getParameters())
+    {
+        if(!isPrimitive(param.type))
+            return false;
+    }
+    const wstring& op = func->getName();
+    if(arguments.size() == 2 && (op == L"&&" || op == L"||"))
+        return true;
+    return getBuiltinName(op, arguments.size()) != nullptr;
+}
+
+IRValue IRLowering::lowerBuiltin(const ExpressionPtr& node, const FunctionSymbolPtr& func, const std::vector<ExpressionPtr>& arguments)
+{
+    IRBuilder& b = ctx->builder;
+    const wstring& op = func->getName();
+    TypePtr operandType = func->getType()->getParameters()[0].type;
+    IRTypeRef resultType = getType(func->getReturnType());
+    if(arguments.size() == 2)
+    {
+        if(op == L"&&" || op == L"||")
+            return lowerShortCircuit(arguments[0], arguments[1], op == L"&&");
+        IRValue lhs = lowerExpression(arguments[0]);
+        IRValue rhs = lowerExpression(arguments[1]);
+        return b.createBuiltin(wstring(getBuiltinName(op, 2)) + L"_" + operandType->getName(), {lhs, rhs}, resultType);
+    }
+    if(op == L"++" || op == L"--")
+    {
+        ExpressionPtr operand = arguments[0];
+        if(operand->getNodeType() == NodeType::InOut)
+            operand = static_pointer_cast<InOutParameter>(operand)->getOperand();
+        if(!isAddressable(operand))
+            unsupported(operand, op);
+        LValue lv = lowerLValue(operand);
+        IRValue oldValue = b.createLoad(lv.address);
+        IRValue one = b.createIntegerLiteral(resultType, 1);
+        IRValue newValue = b.createBuiltin((op == L"++" ? L"add_" : L"sub_") + operandType->getName(), {oldValue, one}, resultType);
+        b.createStore(newValue, lv.address);
+        if(lv.owner != IRFunction::InvalidValue)
+            b.createStrongRelease(lv.owner);
+        return hasFlag(func, SymbolFlagPostfix) ? oldValue : newValue;
+    }
+    IRValue operand = lowerExpression(arguments[0]);
+    if(op == L"+")
+        return operand;
+    return b.createBuiltin(wstring(getBuiltinName(op, 1)) + L"_" + operandType->getName(), {operand}, resultType);
+}
+
+IRValue IRLowering::lowerShortCircuit(const ExpressionPtr& lhs, const ExpressionPtr& rhs, bool isAnd)
+{
+    IRBuilder& b = ctx->builder;
+    IRTypeRef Bool = getType(global->Bool());
+    IRValue left = lowerExpression(lhs);
+    uint32_t rhsBlock = b.createBlock();
+    uint32_t shortBlock = b.createBlock();
+    uint32_t merge = b.createBlock();
+    b.addBlockArgument(merge, Bool);
+    if(isAnd)
+        b.createCondBr(left, rhsBlock, shortBlock);
+    else
+        b.createCondBr(left, shortBlock, rhsBlock);
+    //the left operand decides the result when the right one is skipped
+    b.setInsertionBlock(shortBlock);
+    b.createBr(merge, {left});
+    b.setInsertionBlock(rhsBlock);
+    IRValue right = lowerExpression(rhs);
+    b.createBr(merge, {right});
+    b.setInsertionBlock(merge);
+    return b.getBlockArgument(merge, 0);
+}
+
+void IRLowering::visitBinaryOperator(const BinaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!func || !lhs || !rhs)
+        unsupported(node, node->getOperator());
+    result = lowerCall(node, func, nullptr, {lhs, rhs});
+}
+
+void IRLowering::visitUnaryOperator(const UnaryOperatorPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    if(!func)
+        unsupported(node, node->getOperator());
+    result = lowerCall(node, func, nullptr, {node->getOperand()});
+}
+
+void IRLowering::visitAssignment(const AssignmentPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    ExpressionPtr lhs = dynamic_pointer_cast<Expression>(node->getLHS());
+    ExpressionPtr rhs = dynamic_pointer_cast<Expression>(node->getRHS());
+    if(!lhs || !rhs)
+        unsupported(node, L"assignment to pattern");
+    SymbolPtr sym;
+    if(lhs->getNodeType() == NodeType::Identifier)
+        sym = resolveIdentifier(static_pointer_cast<Identifier>(lhs), ctx->scopes, ctx->selfType);
+    else
+        sym = lhs->getReferencedSymbol();
+    if(ComputedPropertySymbolPtr property = dynamic_pointer_cast<ComputedPropertySymbol>(sym))
+    {
+        ExpressionPtr base;
+        if(lhs->getNodeType() == NodeType::MemberAccess)
+            base = static_pointer_cast<MemberAccess>(lhs)->getSelf();
+        lowerCall(node, property->getSetter(), base, {rhs});
+        result = IRFunction::InvalidValue;
+        return;
+    }
+    if(!isAddressable(lhs))
+        unsupported(lhs, L"assignment target");
+    TypePtr type = lhs->getType() ? lhs->getType() : sym->getType();
+    IRValue value = lowerExpression(rhs);
+    LValue lv = lowerLValue(lhs);
+    //the first assignment to a stored property inside an initializer initializes it, there's no old value to destroy.
+    //NOTE: this is decided by lexical order and doesn't trace the assignments across branches
+    bool initialization = false;
+    if(ctx->isInit && isStoredProperty(sym) && (lhs->getNodeType() == NodeType::Identifier || isSelfIdentifier(static_pointer_cast<MemberAccess>(lhs)->getSelf())))
+        initialization = ctx->initializedFields.insert(sym.get()).second;
+    if(!initialization && !isTrivial(type))
+        b.createDestroyAddr(lv.address);
+    b.createStore(value, lv.address);
+    if(lv.owner != IRFunction::InvalidValue)
+        b.createStrongRelease(lv.owner);
+    result = IRFunction::InvalidValue;
+}
+
+void IRLowering::visitConditionalOperator(const ConditionalOperatorPtr& node)
+{
+    IRBuilder& b = ctx->builder;
+    ExpressionPtr condition = dynamic_pointer_cast<Expression>(node->getCondition());
+    if(!condition)
+        unsupported(node, L"conditional pattern");
+    IRValue cond = lowerCondition(condition);
+    uint32_t thenBlock = b.createBlock();
+    uint32_t elseBlock = b.createBlock();
+    uint32_t merge = b.createBlock();
+    b.addBlockArgument(merge, getType(node->getType()));
+    b.createCondBr(cond, thenBlock, elseBlock);
+    b.setInsertionBlock(thenBlock);
+    b.createBr(merge, {lowerExpression(node->getTrueExpression())});
+    b.setInsertionBlock(elseBlock);
+    b.createBr(merge, {lowerExpression(node->getFalseExpression())});
+    b.setInsertionBlock(merge);
+    result = b.getBlockArgument(merge, 0);
+}
+
+void IRLowering::visitTuple(const TuplePtr& node)
+{
+    vector<IRValue> elements;
+    for(const PatternPtr& element : *node)
+        elements.push_back(lowerExpression(element));
+    result = ctx->builder.createTuple(getType(node->getType()), elements);
+}
+
+void IRLowering::visitParenthesizedExpression(const ParenthesizedExpressionPtr& node)
+{
+    if(node->numExpressions() == 1)
+    {
+        result = lowerExpression(node->get(0));
+        return;
+    }
+    vector<IRValue> elements;
+    for(const ParenthesizedExpression::Term& term : *node)
+        elements.push_back(lowerExpression(term.expression));
+    result = ctx->builder.createTuple(getType(node->getType()), elements);
+}
+
+void IRLowering::visitInteger(const IntegerLiteralPtr& node)
+{
+    TypePtr type = node->getType();
+    //integer literal can be inferred as a floating number
+    if(type == global->Double() || type == global->Float())
+        result = ctx->builder.createFloatLiteral(getType(type), (double)node->value);
+    else
+        result = ctx->builder.createIntegerLiteral(getType(type), node->value);
+}
+
+void IRLowering::visitFloat(const FloatLiteralPtr& node)
+{
+    result = ctx->builder.createFloatLiteral(getType(node->getType()), node->value);
+}
+
+void IRLowering::visitString(const StringLiteralPtr& node)
+{
+    result = ctx->builder.createStringLiteral(getType(node->getType()), node->toString());
+}
+
+void IRLowering::visitBooleanLiteral(const BooleanLiteralPtr& node)
+{
+    result = ctx->builder.createIntegerLiteral(getType(global->Bool()), node->getValue() ? 1 : 0);
+}
+
+void IRLowering::visitArrayLiteral(const ArrayLiteralPtr& node)
+{
+    unsupported(node, L"array literal");
+}
+
+void IRLowering::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
+{
+    unsupported(node, L"dictionary literal");
+}
+
+void IRLowering::visitCompileConstant(const CompileConstantPtr& node)
+{
+    unsupported(node, L"compile constant");
+}
+
+void IRLowering::visitSubscriptAccess(const SubscriptAccessPtr& node)
+{
+    unsupported(node, L"subscript");
+}
+
+void IRLowering::visitClosure(const ClosurePtr& node)
+{
+    unsupported(node, L"closure");
+}
+
+void IRLowering::visitSelf(const SelfExpressionPtr& node)
+{
+    unsupported(node, L"self expression");
+}
+
+void IRLowering::visitInitializerReference(const InitializerReferencePtr& node)
+{
+    unsupported(node, L"initializer reference");
+}
+
+void IRLowering::visitDynamicType(const DynamicTypePtr& node)
+{
+    unsupported(node, L"dynamicType");
+}
+
+void IRLowering::visitForcedValue(const ForcedValuePtr& node)
+{
+    unsupported(node, L"forced value");
+}
+
+void IRLowering::visitOptionalChaining(const OptionalChainingPtr& node)
+{
+    unsupported(node, L"optional chaining");
+}
+
+void IRLowering::visitStringInterpolation(const StringInterpolationPtr& node)
+{
+    unsupported(node, L"string interpolation");
+}
+
+void IRLowering::visitNilLiteral(const NilLiteralPtr& node)
+{
+    unsupported(node, L"nil");
+}
@@ -0,0 +1,354 @@
+/* IRPrinter.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRPrinter.h"
+#include "semantics/Type.h"
+#include <cstring>
+#include <iomanip>
+
+USE_SWALLOW_NS
+using namespace std;
+
+
+IRPrinter::IRPrinter(std::wostream& out)
+:out(out), module(nullptr), function(nullptr)
+{
+}
+
+void IRPrinter::print(const IRModule* module)
+{
+    this->module = module;
+    out<<L"sil_stage raw"<<endl<<endl;
+    for(size_t i = 0; i < module->numGlobals(); i++)
+    {
+        const IRGlobal& g = module->getGlobalAt(i);
+        out<<L"sil_global @"<<g.name<<L" : ";
+        printType(g.type);
+        out<<endl;
+    }
+    if(module->numGlobals())
+        out<<endl;
+    for(size_t i = 0; i < module->numFunctions(); i++)
+    {
+        printFunction(module, module->getFunctionAt(i));
+        out<<endl;
+    }
+}
+
+void IRPrinter::printFunction(const IRModule* module, const IRFunction* func)
+{
+    this->module = module;
+    this->function = func;
+    if(func->isExternal())
+    {
+        out<<L"sil public_external @"<<func->name<<L" : ";
+        printType(func->signature);
+        out<<endl;
+        return;
+    }
+    out<<L"sil @"<<func->name<<L" : ";
+    printType(func->signature);
+    out<<L" {"<<endl;
+    for(size_t b = 0; b < func->blocks.size(); b++)
+    {
+        const IRBasicBlock& bb = func->blocks[b];
+        out<<L"bb"<<b;
+        if(bb.numArguments)
+        {
+            out<<L"(";
+            for(uint32_t i = 0; i < bb.numArguments; i++)
+            {
+                if(i)
+                    out<<L", ";
+                printTypedValue(bb.first + i);
+            }
+            out<<L")";
+        }
+        out<<L":"<<endl;
+        for(uint32_t i = bb.first + bb.numArguments; i < bb.end; i++)
+        {
+            out<<L"  ";
+            printInstruction(module, func, i);
+            out<<endl;
+        }
+    }
+    out<<L"}"<<endl;
+}
+
+void IRPrinter::printValue(IRValue value)
+{
+    out<<L"%"<<value;
+}
+
+void IRPrinter::printTypedValue(IRValue value)
+{
+    printValue(value);
+    out<<L" : ";
+    printType(function->getValueType(value));
+}
+
+void IRPrinter::printType(IRTypeRef type)
+{
+    out<<L"$"<<module->getTypeName(type);
+}
+
+void IRPrinter::printMember(uint32_t idx)
+{
+    const IRMember& member = module->getMemberAt(idx);
+    out<<L"#"<<member.owner->toString()<<L"."<<member.name;
+    if(member.kind == IRMember::EnumCase)
+        out<<(member.hasPayload ? L"!enumelt.1" : L"!enumelt");
+    else if(member.kind == IRMember::Method)
+        out<<L"!1";
+}
+
+void IRPrinter::printString(const std::wstring& str)
+{
+    out<<L"\"";
+    for(wchar_t ch : str)
+    {
+        switch(ch)
+        {
+            case L'"': out<<L"\\\""; break;
+            case L'\\': out<<L"\\\\"; break;
+            case L'\n': out<<L"\\n"; break;
+            case L'\r': out<<L"\\r"; break;
+            case L'\t': out<<L"\\t"; break;
+            default: out<<ch; break;
+        }
+    }
+    out<<L"\"";
+}
+
+void IRPrinter::printInstruction(const IRModule* module, const IRFunction* func, IRValue value)
+{
+    this->module = module;
+    this->function = func;
+    const IRInstruction& inst = func->instructions[value];
+    const IRValue* ops = func->getOperands(inst);
+    if(IROpcode::hasResult(inst.opcode))
+    {
+        printValue(value);
+        out<<L" = ";
+    }
+    out<<IROpcode::getName(inst.opcode);
+    switch(inst.opcode)
+    {
+        case IROpcode::Argument:
+            break;
+        case IROpcode::AllocStack:
+        case IROpcode::AllocBox:
+            out<<L" ";
+            printType(IRModule::objectOf(inst.type));
+            break;
+        case IROpcode::AllocRef:
+        case IROpcode::Metatype:
+            out<<L" ";
+            if(inst.opcode == IROpcode::AllocRef && inst.flags)
+                out<<L"[stack] ";
+            printType(inst.type);
+            break;
+        case IROpcode::DeallocStack:
+        case IROpcode::DeallocRef:
+        case IROpcode::Load:
+        case IROpcode::DestroyAddr:
+        case IROpcode::StrongRetain:
+        case IROpcode::StrongRelease:
+        case IROpcode::RetainValue:
+        case IROpcode::ReleaseValue:
+        case IROpcode::Return:
+        case IROpcode::CondFail:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            break;
+        case IROpcode::Store:
+            out<<L" ";
+            printValue(ops[0]);
+            out<<L" to ";
+            printTypedValue(ops[1]);
+            break;
+        case IROpcode::Struct:
+        case IROpcode::Tuple:
+            if(inst.opcode == IROpcode::Struct)
+            {
+                out<<L" ";
+                printType(inst.type);
+            }
+            out<<L" (";
+            for(int i = 0; i < inst.numOperands; i++)
+            {
+                if(i)
+                    out<<L", ";
+                printTypedValue(ops[i]);
+            }
+            out<<L")";
+            break;
+        case IROpcode::Enum:
+            out<<L" ";
+            printType(inst.type);
+            out<<L", ";
+            printMember(inst.immediate.index);
+            if(inst.numOperands)
+            {
+                out<<L", ";
+                printTypedValue(ops[0]);
+            }
+            break;
+        case IROpcode::StructExtract:
+        case IROpcode::StructElementAddr:
+        case IROpcode::RefElementAddr:
+        case IROpcode::UncheckedEnumData:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            out<<L", ";
+            printMember(inst.immediate.index);
+            break;
+        case IROpcode::TupleExtract:
+        case IROpcode::TupleElementAddr:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            out<<L", "<<inst.immediate.index;
+            break;
+        case IROpcode::GlobalAddr:
+            out<<L" @"<<module->getGlobalAt(inst.immediate.index).name<<L" : ";
+            printType(inst.type);
+            break;
+        case IROpcode::IntegerLiteral:
+            out<<L" ";
+            printType(inst.type);
+            out<<L", "<<inst.immediate.integer;
+            break;
+        case IROpcode::FloatLiteral:
+        {
+            uint64_t bits;
+            memcpy(&bits, &inst.immediate.real, sizeof(bits));
+            out<<L" ";
+            printType(inst.type);
+            out<<L", 0x"<<hex<<uppercase<<setw(16)<<setfill(L'0')<<bits<<dec<<nouppercase<<setfill(L' ');
+            out<<L" // "<<inst.immediate.real;
+            break;
+        }
+        case IROpcode::StringLiteral:
+            out<<L" utf8 ";
+            printString(module->getStringAt(inst.immediate.index));
+            break;
+        case IROpcode::FunctionRef:
+        {
+            const IRFunction* callee = module->getFunctionAt(inst.immediate.index);
+            out<<L" @"<<callee->name<<L" : ";
+            printType(inst.type);
+            break;
+        }
+        case IROpcode::ClassMethod:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            out<<L", ";
+            printMember(inst.immediate.index);
+            out<<L" : ";
+            printType(inst.type);
+            break;
+        case IROpcode::Apply:
+            out<<L" ";
+            printValue(ops[0]);
+            if(inst.immediate.index)
+            {
+                const vector<IRTypeRef>& types = module->getSubstitutionAt(inst.immediate.index);
+                out<<L"<";
+                for(size_t i = 0; i < types.size(); i++)
+                {
+                    if(i)
+                        out<<L", ";
+                    out<<module->getTypeName(types[i]);
+                }
+                out<<L">";
+            }
+            out<<L"(";
+            for(int i = 1; i < inst.numOperands; i++)
+            {
+                if(i > 1)
+                    out<<L", ";
+                printValue(ops[i]);
+            }
+            out<<L") : ";
+            printType(func->getValueType(ops[0]));
+            break;
+        case IROpcode::Builtin:
+            out<<L" ";
+            printString(module->getStringAt(inst.immediate.index));
+            out<<L"(";
+            for(int i = 0; i < inst.numOperands; i++)
+            {
+                if(i)
+                    out<<L", ";
+                printTypedValue(ops[i]);
+            }
+            out<<L") : ";
+            printType(inst.type);
+            break;
+        case IROpcode::DebugValue:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            out<<L"  // "<<(inst.flags ? L"var " : L"let ")<<module->getStringAt(inst.immediate.index);
+            break;
+        case IROpcode::Br:
+            out<<L" bb"<<inst.immediate.index;
+            if(inst.numOperands)
+            {
+                out<<L"(";
+                for(int i = 0; i < inst.numOperands; i++)
+                {
+                    if(i)
+                        out<<L", ";
+                    printTypedValue(ops[i]);
+                }
+                out<<L")";
+            }
+            break;
+        case IROpcode::CondBr:
+            out<<L" ";
+            printValue(ops[0]);
+            out<<L", bb"<<inst.immediate.targets[0]<<L", bb"<<inst.immediate.targets[1];
+            break;
+        case IROpcode::SwitchEnum:
+            out<<L" ";
+            printTypedValue(ops[0]);
+            for(int i = 1; i + 1 < inst.numOperands; i += 2)
+            {
+                out<<L", case ";
+                printMember(ops[i]);
+                out<<L": bb"<<ops[i + 1];
+            }
+            if(inst.immediate.index != IRFunction::InvalidBlock)
+                out<<L", default bb"<<inst.immediate.index;
+            break;
+        case IROpcode::Unreachable:
+        case IROpcode::_Count:
+            break;
+    }
+}
@@ -0,0 +1,418 @@
+/* IRSpecializer.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRSpecializer.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/Type.h"
+#include "semantics/GenericDefinition.h"
+#include "semantics/GenericArgument.h"
+#include <algorithm>
+#include <set>
+#include <cassert>
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+static void getStoredProperties(const TypePtr& type, vector<SymbolPtr>& properties)
+{
+    for(const SymbolPtr& sym : type->getDeclaredStoredProperties())
+    {
+        if(!dynamic_pointer_cast<SymbolPlaceHolder>(sym) || sym->hasFlags(SymbolFlagTemporary))
+            continue;
+        properties.push_back(sym);
+    }
+}
+
+/*!
+ * Marks blocks that are part of a cycle, call sites inside them are hotter than others
+ */
+static void findLoopBlocks(const IRFunction* func, vector<bool>& inLoop)
+{
+    size_t numBlocks = func->blocks.size();
+    inLoop.assign(numBlocks, false);
+    vector<uint32_t> successors;
+    vector<uint32_t> worklist;
+    vector<bool> visited;
+    for(uint32_t b = 0; b < numBlocks; b++)
+    {
+        visited.assign(numBlocks, false);
+        worklist.clear();
+        func->getSuccessors(b, successors);
+        worklist.insert(worklist.end(), successors.begin(), successors.end());
+        while(!worklist.empty() && !inLoop[b])
+        {
+            uint32_t s = worklist.back();
+            worklist.pop_back();
+            if(s == b)
+                inLoop[b] = true;
+            if(visited[s])
+                continue;
+            visited[s] = true;
+            func->getSuccessors(s, successors);
+            worklist.insert(worklist.end(), successors.begin(), successors.end());
+        }
+    }
+}
+
+const uint32_t IRSpecializer::InvalidFunction;
+
+IRSpecializer::IRSpecializer(SymbolRegistry* symbolRegistry, IRModule* module)
+:module(module), mangling(symbolRegistry), policy(SpecializationPolicy::HotOrSmall),
+ smallFunctionSize(32), hotThreshold(8), maxCodeGrowth(1.0), maxDepth(8)
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+uint32_t IRSpecializer::run()
+{
+    memset(&statistics, 0, sizeof(statistics));
+    vector<uint32_t> pending;
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+    {
+        const IRFunction* func = module->getFunctionAt(i);
+        statistics.originalSize += func->instructions.size();
+        if(!func->isExternal() && !func->isGeneric())
+            pending.push_back(i);
+    }
+    vector<CallSite> callSites;
+    vector<bool> redirected;
+    size_t growth = 0;
+    uint32_t ret = 0;
+    while(!pending.empty())
+    {
+        for(uint32_t func : pending)
+            collectCallSites(func, callSites);
+        pending.clear();
+        redirected.resize(callSites.size(), false);
+        //hot instances take the code growth budget first
+        vector<uint32_t> order;
+        for(uint32_t i = 0; i < instances.size(); i++)
+        {
+            if(instances[i].specialized == InvalidFunction)
+                order.push_back(i);
+        }
+        stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return instances[a].hotness > instances[b].hotness;
+        });
+        for(uint32_t i : order)
+        {
+            if(!shouldSpecialize(instances[i], growth))
+                continue;
+            uint32_t func = specialize(instances[i]);
+            SpecializationInstance& instance = instances[i];
+            instance.specialized = func;
+            instance.specializedSize = module->getFunctionAt(func)->instructions.size();
+            growth += instance.specializedSize;
+            functionDepth[func] = instance.depth;
+            pending.push_back(func);
+            ret++;
+        }
+        //redirect call sites to the specialized copies
+        for(size_t i = 0; i < callSites.size(); i++)
+        {
+            const SpecializationInstance& instance = instances[callSites[i].instance];
+            if(redirected[i] || instance.specialized == InvalidFunction)
+                continue;
+            redirected[i] = true;
+            IRFunction* func = module->getFunctionAt(callSites[i].function);
+            IRInstruction& apply = func->instructions[callSites[i].apply];
+            IRInstruction& ref = func->instructions[func->getOperand(apply, 0)];
+            ref.immediate.index = instance.specialized;
+            ref.type = module->getFunctionAt(instance.specialized)->signature;
+            apply.immediate.index = 0;
+            statistics.specializedCallSites++;
+        }
+    }
+    set<uint32_t> genericFunctions;
+    for(const SpecializationInstance& instance : instances)
+        genericFunctions.insert(instance.function);
+    statistics.genericFunctions = genericFunctions.size();
+    statistics.instances = instances.size();
+    statistics.specializedInstances = ret;
+    statistics.callSites = callSites.size();
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+        statistics.finalSize += module->getFunctionAt(i)->instructions.size();
+    return ret;
+}
+
+void IRSpecializer::collectCallSites(uint32_t function, std::vector<CallSite>& callSites)
+{
+    const IRFunction* func = module->getFunctionAt(function);
+    //a function reference shared by multiple applies cannot be redirected for one of them
+    vector<uint32_t> uses(func->instructions.size(), 0);
+    for(const IRInstruction& inst : func->instructions)
+    {
+        const IRValue* ops = func->getOperands(inst);
+        int numValues = inst.opcode == IROpcode::SwitchEnum ? 1 : inst.numOperands;
+        for(int i = 0; i < numValues; i++)
+            uses[ops[i]]++;
+    }
+    vector<bool> inLoop;
+    findLoopBlocks(func, inLoop);
+    auto iter = functionDepth.find(function);
+    uint32_t depth = iter == functionDepth.end() ? 1 : iter->second + 1;
+    for(IRValue v = 0; v < func->instructions.size(); v++)
+    {
+        const IRInstruction& inst = func->instructions[v];
+        if(inst.opcode != IROpcode::Apply || inst.immediate.index == 0)
+            continue;
+        IRValue calleeValue = func->getOperand(inst, 0);
+        const IRInstruction& ref = func->instructions[calleeValue];
+        if(ref.opcode != IROpcode::FunctionRef || uses[calleeValue] != 1)
+            continue;
+        const IRFunction* callee = module->getFunctionAt(ref.immediate.index);
+        if(!callee->isGeneric() || callee->isExternal() || !isConcrete(inst.immediate.index))
+            continue;
+        pair<uint32_t, uint32_t> key(ref.immediate.index, inst.immediate.index);
+        auto it = instanceIndex.find(key);
+        if(it == instanceIndex.end())
+        {
+            SpecializationInstance instance = {key.first, key.second, InvalidFunction, 0, 0, depth, callee->instructions.size(), 0};
+            it = instanceIndex.insert(make_pair(key, (uint32_t)instances.size())).first;
+            instances.push_back(instance);
+        }
+        SpecializationInstance& instance = instances[it->second];
+        instance.callSites++;
+        instance.hotness += inLoop[inst.block] ? 8 : 1;
+        instance.depth = min(instance.depth, depth);
+        CallSite callSite = {function, v, it->second};
+        callSites.push_back(callSite);
+    }
+}
+
+bool IRSpecializer::shouldSpecialize(const SpecializationInstance& instance, size_t growth) const
+{
+    if(instance.depth > maxDepth)
+        return false;
+    switch(policy)
+    {
+        case SpecializationPolicy::Always:
+            return true;
+        case SpecializationPolicy::Never:
+            return false;
+        case SpecializationPolicy::HotOrSmall:
+            if(instance.genericSize > smallFunctionSize && instance.hotness < hotThreshold)
+                return false;
+            return growth + instance.genericSize <= maxCodeGrowth * statistics.originalSize;
+    }
+    return false;
+}
+
+bool IRSpecializer::isConcrete(uint32_t substitution) const
+{
+    for(IRTypeRef ref : module->getSubstitutionAt(substitution))
+    {
+        const TypePtr& type = module->getTypeInfo(ref).type;
+        if(!type || type->containsGenericParameters())
+            return false;
+    }
+    return true;
+}
+
+IRTypeRef IRSpecializer::substitute(IRTypeRef type, const GenericArgumentPtr& arguments)
+{
+    if(IRModule::isAddress(type))
+        return IRModule::addressOf(substitute(IRModule::objectOf(type), arguments));
+    //builtin types and signatures are spelling only and never generic
+    TypePtr t = module->getTypeInfo(type).type;
+    if(!t)
+        return type;
+    //generic parameters of functions are declared as type aliases
+    if(t->getCategory() == Type::Alias)
+    {
+        if(TypePtr argument = arguments->get(t->getName()))
+            return module->getType(argument);
+        return type;
+    }
+    if(!t->containsGenericParameters())
+        return type;
+    return module->getType(Type::newSpecializedType(t, arguments));
+}
+
+std::wstring IRSpecializer::getSignature(const IRFunction* func)
+{
+    wstring signature = func->convention == IRConvention::Method ? L"@cc(method) @thin (" : L"@thin (";
+    for(size_t i = 0; i < func->parameters.size(); i++)
+    {
+        IRTypeRef t = func->parameters[i];
+        if(i)
+            signature += L", ";
+        if(IRModule::isAddress(t))
+            signature += L"@inout ";
+        signature += module->getTypeInfo(t).name;
+    }
+    signature += L") -> " + module->getTypeName(func->result);
+    return signature;
+}
+
+bool IRSpecializer::isTrivial(const TypePtr& type)
+{
+    if(!type)
+        return true;
+    auto iter = trivialTypes.find(type.get());
+    if(iter != trivialTypes.end())
+        return iter->second;
+    bool ret = true;
+    switch(type->getCategory())
+    {
+        case Type::Struct:
+        {
+            vector<SymbolPtr> properties;
+            getStoredProperties(type, properties);
+            for(const SymbolPtr& sym : properties)
+                ret = ret && isTrivial(sym->getType());
+            break;
+        }
+        case Type::Tuple:
+            for(int i = 0; i < type->numElementTypes(); i++)
+                ret = ret && isTrivial(type->getElementType(i));
+            break;
+        case Type::Enum:
+            for(const auto& c : type->getEnumCases())
+                ret = ret && isTrivial(c.second.type);
+            break;
+        case Type::MetaType:
+            ret = true;
+            break;
+        default:
+            //references, closures, generic parameters and containers are all reference counted
+            ret = false;
+            break;
+    }
+    trivialTypes.insert(make_pair(type.get(), ret));
+    return ret;
+}
+
+/*!
+ * Clones the generic function with its generic parameters substituted, returns the index of the copy
+ */
+uint32_t IRSpecializer::specialize(const SpecializationInstance& instance)
+{
+    const IRFunction* generic = module->getFunctionAt(instance.function);
+    GenericArgumentPtr arguments(new GenericArgument(generic->generic));
+    vector<TypePtr> types;
+    for(IRTypeRef ref : module->getSubstitutionAt(instance.substitution))
+    {
+        TypePtr type = module->getTypeInfo(ref).type;
+        arguments->add(type);
+        types.push_back(type);
+    }
+    IRFunction* ret = module->addFunction(mangling.encodeSpecialization(generic->name, types));
+    if(FunctionSymbolPtr symbol = dynamic_pointer_cast<FunctionSymbol>(generic->symbol))
+        ret->symbol = FunctionSymbol::getSpecialization(symbol, arguments);
+    ret->convention = generic->convention;
+    for(IRTypeRef param : generic->parameters)
+        ret->parameters.push_back(substitute(param, arguments));
+    ret->result = substitute(generic->result, arguments);
+    ret->signature = module->getType(getSignature(ret));
+
+    //values are renumbered after dropping the reference counting on trivial types
+    vector<IRValue> valueMap(generic->instructions.size(), IRFunction::InvalidValue);
+    vector<bool> removed(generic->instructions.size(), false);
+    IRValue next = 0;
+    for(IRValue v = 0; v < generic->instructions.size(); v++)
+    {
+        const IRInstruction& inst = generic->instructions[v];
+        if(inst.opcode == IROpcode::RetainValue || inst.opcode == IROpcode::ReleaseValue)
+        {
+            IRTypeRef type = substitute(generic->getValueType(generic->getOperand(inst, 0)), arguments);
+            if(isTrivial(module->getTypeInfo(type).type))
+            {
+                removed[v] = true;
+                statistics.removedRefCounting++;
+                continue;
+            }
+        }
+        valueMap[v] = next++;
+    }
+    ret->instructions.reserve(next);
+    ret->operands.reserve(generic->operands.size());
+    for(const IRBasicBlock& bb : generic->blocks)
+    {
+        IRBasicBlock nb = {(uint32_t)ret->instructions.size(), 0, bb.numArguments};
+        for(IRValue v = bb.first; v < bb.end; v++)
+        {
+            if(removed[v])
+                continue;
+            IRInstruction inst = generic->instructions[v];
+            const IRValue* ops = generic->getOperands(inst);
+            inst.operands = ret->operands.size();
+            inst.type = substitute(inst.type, arguments);
+            for(int i = 0; i < inst.numOperands; i++)
+            {
+                //member and block pairs of switch_enum are not values
+                bool isValue = inst.opcode != IROpcode::SwitchEnum || i == 0;
+                assert(!isValue || valueMap[ops[i]] != IRFunction::InvalidValue);
+                ret->operands.push_back(isValue ? valueMap[ops[i]] : ops[i]);
+            }
+            if(inst.opcode == IROpcode::Apply && inst.immediate.index)
+            {
+                //generic arguments of nested calls may refer the generic parameters being substituted
+                vector<IRTypeRef> subst;
+                for(IRTypeRef t : module->getSubstitutionAt(inst.immediate.index))
+                    subst.push_back(substitute(t, arguments));
+                inst.immediate.index = module->getSubstitution(subst);
+            }
+            ret->instructions.push_back(inst);
+        }
+        nb.end = ret->instructions.size();
+        ret->blocks.push_back(nb);
+    }
+    return module->getFunctionIndex(ret);
+}
+
+void IRSpecializer::dumpStatistics(std::wostream& out) const
+{
+    static const wchar_t* policies[] = {L"always", L"hot-or-small", L"never"};
+    const SpecializationStatistics& s = statistics;
+    out << L"specialization policy: " << policies[policy] << endl;
+    out << L"generic functions: " << s.genericFunctions << L", instances: " << s.instances
+        << L" (" << s.specializedInstances << L" specialized), call sites: " << s.callSites
+        << L" (" << s.specializedCallSites << L" specialized)" << endl;
+    out << L"code size: " << s.originalSize << L" -> " << s.finalSize << L" instructions";
+    if(s.originalSize)
+        out << L" (+" << (s.finalSize - s.originalSize) * 100 / s.originalSize << L"%)";
+    out << L", removed reference counting: " << s.removedRefCounting << endl;
+    for(const SpecializationInstance& instance : instances)
+    {
+        out << L"  " << module->getFunctionAt(instance.function)->name << L"<";
+        const vector<IRTypeRef>& types = module->getSubstitutionAt(instance.substitution);
+        for(size_t i = 0; i < types.size(); i++)
+            out << (i ? L", " : L"") << module->getTypeName(types[i]);
+        out << L">: call sites " << instance.callSites << L", hotness " << instance.hotness << L", size " << instance.genericSize;
+        if(instance.specialized != InvalidFunction)
+            out << L" -> " << instance.specializedSize << L" specialized";
+        else
+            out << L" shared";
+        out << endl;
+    }
+}
@@ -0,0 +1,115 @@
+/* IRStackPromotion.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ir/IRStackPromotion.h"
+#include "semantics/Type.h"
+#include "semantics/FunctionSymbol.h"
+#include <cstring>
+
+USE_SWALLOW_NS
+using namespace std;
+
+IRStackPromotion::IRStackPromotion(IRModule* module)
+:module(module), escapeAnalysis(module)
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+uint32_t IRStackPromotion::run()
+{
+    memset(&statistics, 0, sizeof(statistics));
+    functionsBySymbol.clear();
+    escapingDeinits.clear();
+    escapeAnalysis.run();
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+    {
+        const IRFunction* func = module->getFunctionAt(i);
+        if(FunctionSymbol* symbol = dynamic_cast<FunctionSymbol*>(func->symbol.get()))
+            functionsBySymbol.insert(make_pair(symbol, func));
+    }
+    vector<IRValue> operations;
+    for(uint32_t i = 0; i < module->numFunctions(); i++)
+    {
+        IRFunction* func = module->getFunctionAt(i);
+        if(func->isExternal())
+            continue;
+        IRUsers users(func);
+        for(IRValue v = 0; v < func->instructions.size(); v++)
+        {
+            IRInstruction& inst = func->instructions[v];
+            if(inst.opcode != IROpcode::AllocRef)
+                continue;
+            statistics.allocations++;
+            if(!escapeAnalysis.isLocalObject(func, users, v, operations))
+                continue;
+            if(isDeinitEscaping(module->getTypeInfo(inst.type).type))
+            {
+                statistics.escapingDeinits++;
+                continue;
+            }
+            inst.flags = 1;
+            statistics.promoted++;
+        }
+    }
+    return statistics.promoted;
+}
+
+/*!
+ * Check if a deinitializer of the class or its parents may let self escape, it would outlive the frame
+ */
+bool IRStackPromotion::isDeinitEscaping(const TypePtr& type)
+{
+    if(!type)
+        return false;
+    auto iter = escapingDeinits.find(type.get());
+    if(iter != escapingDeinits.end())
+        return iter->second;
+    bool ret = false;
+    if(FunctionSymbolPtr deinit = type->getDeinit())
+    {
+        auto func = functionsBySymbol.find(deinit.get());
+        //deinitializers without a body are treated as escaping
+        if(func == functionsBySymbol.end() || func->second->parameters.empty())
+            ret = true;
+        else
+            ret = escapeAnalysis.getParameterEscape(func->second, (uint32_t)func->second->parameters.size() - 1) != IREscape::NoEscape;
+    }
+    ret = ret || isDeinitEscaping(type->getParentType());
+    escapingDeinits[type.get()] = ret;
+    return ret;
+}
+
+void IRStackPromotion::dumpStatistics(std::wostream& out) const
+{
+    const StackPromotionStatistics& s = statistics;
+    out << L"stack promotion: " << s.promoted << L" of " << s.allocations << L" allocations";
+    if(s.escapingDeinits)
+        out << L", " << s.escapingDeinits << L" kept on heap by deinitializers";
+    out << endl;
+}
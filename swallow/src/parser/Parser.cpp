@@ -33,6 +33,7 @@
 #include "ast/ast.h"
 #include "common/CompilerResults.h"
 #include "common/Errors.h"
+#include "common/CompilerStats.h"
 #include <memory>
 using namespace Swallow;
 
@@ -43,6 +44,7 @@ Parser::Parser(NodeFactory* nodeFactory, CompilerResults* compilerResults)
     tokenizer = new Tokenizer(NULL);
     functionName = L"<top>";
     flags = 0;
+    errorRecovery = false;
 }
 Parser::~Parser()
 {
@@ -57,6 +59,10 @@ void Parser::setFunctionName(const wchar_t* function)
 {
     this->functionName = functionName;
 }
+void Parser::setErrorRecovery(bool errorRecovery)
+{
+    this->errorRecovery = errorRecovery;
+}
 /*!
  * Read next token from tokenizer, throw exception if EOF reached.
  */
@@ -64,7 +70,7 @@ void Parser::expect_next(Token& token)
 {
     if(next(token))
         return;
-    compilerResults->add(ErrorLevel::Fatal, token.state, Errors::E_UNEXPECTED_EOF);
+    compilerResults->add(ErrorLevel::Fatal, location(token), Errors::E_UNEXPECTED_EOF);
     throw Abort();
 }
 /*!
@@ -103,13 +109,13 @@ bool Parser::next(Token& token)
             return true;
         }
         //eof reached, fill token with end-of-file for compiler error
-        token.token = L"end-of-file";
+        static const std::wstring endOfFile = L"end-of-file";
+        token.token = TokenText(&endOfFile);
         return false;
     }
     catch(const TokenizerError& e)
     {
-        token.state.line = e.line;
-        token.state.column = e.column;
+        token.offset = e.cursor;
         tassert(token, false, e.errorCode, e.item);
         return false;
     }
@@ -121,6 +127,31 @@ void Parser::restore(Token& token)
 {
     tokenizer->restore(token);
 }
+/*!
+ * Source position of given token
+ */
+SourceInfo Parser::location(const Token& token)
+{
+    SourceInfo ret;
+    ret.offset = token.offset;
+    return ret;
+}
+/*!
+ * Source position of the tokenizer's cursor
+ */
+SourceInfo Parser::location()
+{
+    SourceInfo ret;
+    ret.offset = tokenizer->save().cursor;
+    return ret;
+}
+/*!
+ * Resolve the line of given token
+ */
+int Parser::line(const Token& token)
+{
+    return tokenizer->getSourceIndex().getLine(token.offset);
+}
 /*!
  * Check if the following token is the specified one, consume the token and return true if matched or return false if not.
  */
@@ -224,7 +255,7 @@ void Parser::expect_identifier(Token& token)
  */
 void Parser::unexpected(const Token& token)
 {
-    compilerResults->add(ErrorLevel::Fatal, token.state, Errors::E_UNEXPECTED_1, token.token);
+    compilerResults->add(ErrorLevel::Fatal, location(token), Errors::E_UNEXPECTED_1, token.token);
     throw Abort();
 }
 void Parser::tassert(Token& token, bool cond, int errorCode)
@@ -232,7 +263,7 @@ void Parser::tassert(Token& token, bool cond, int errorCode)
     if(cond)
         return;
     //record this issue
-    compilerResults->add(ErrorLevel::Fatal, token.state, errorCode);
+    compilerResults->add(ErrorLevel::Fatal, location(token), errorCode);
     throw Abort();
 }
 void Parser::tassert(Token& token, bool cond, int errorCode, const std::wstring& s)
@@ -240,13 +271,111 @@ void Parser::tassert(Token& token, bool cond, int errorCode, const std::wstring&
     if(cond)
         return;
     //record this issue
-    compilerResults->add(ErrorLevel::Fatal, token.state, errorCode, s);
+    compilerResults->add(ErrorLevel::Fatal, location(token), errorCode, s);
     throw Abort();
 }
 
+bool Parser::recover(const Token& start)
+{
+    if(!errorRecovery || compilerResults->isFull())
+        return false;
+    synchronize(start);
+    return true;
+}
+
+void Parser::synchronize(const Token& start)
+{
+    Token token = start;
+    int depth = 0;
+    int lastLine = line(start);
+    bool first = true;
+    restore(token);
+    try
+    {
+        while(peek(token))
+        {
+            if(!first && depth == 0)
+            {
+                switch(token.type)
+                {
+                    case TokenType::CloseBrace:
+                    case TokenType::CloseBracket:
+                    case TokenType::CloseParen:
+                        //leave it to the enclosing block
+                        return;
+                    default:
+                        if(line(token) > lastLine && isStatementStart(token))
+                            return;
+                        break;
+                }
+            }
+            //always consume the first token, so the parser will make progress
+            first = false;
+            next(token);
+            lastLine = line(token);
+            switch(token.type)
+            {
+                case TokenType::OpenBrace:
+                case TokenType::OpenBracket:
+                case TokenType::OpenParen:
+                    depth++;
+                    break;
+                case TokenType::CloseBrace:
+                case TokenType::CloseBracket:
+                case TokenType::CloseParen:
+                    if(depth > 0)
+                        depth--;
+                    break;
+                case TokenType::Semicolon:
+                    if(depth == 0)
+                        return;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    catch(const Abort&)
+    {
+        //tokenizer error, the rest of the file cannot be read
+    }
+}
+
+bool Parser::advanced(const Token& start)
+{
+    Token token;
+    if(!peek(token))
+        return true;
+    return token.offset != start.offset;
+}
+
+bool Parser::isStatementStart(const Token& token)
+{
+    if(token.type == TokenType::Attribute)
+        return true;
+    if(token.type != TokenType::Identifier)
+        return false;
+    switch(token.getKeyword())
+    {
+        //these keywords continue the previous statement
+        case Keyword::Else:
+        case Keyword::Where:
+        case Keyword::In:
+        case Keyword::Is:
+        case Keyword::As:
+        case Keyword::Case:
+        case Keyword::Default:
+            return false;
+        default:
+            return true;
+    }
+}
+
 NodePtr Parser::parseStatement(const wchar_t* code)
 {
+    PhaseTimer timer(CompilerPhase::Parse);
     tokenizer->set(code);
+    compilerResults->setSourceIndex(tokenizer->getSourceIndex());
     NodePtr ret = NULL;
     try
     {
@@ -271,22 +400,36 @@ ProgramPtr Parser::parse(const wchar_t* code)
 }
 bool Parser::parse(const wchar_t* code, const ProgramPtr& program)
 {
+    PhaseTimer timer(CompilerPhase::Parse);
     tokenizer->set(code);
-    try
+    compilerResults->setSourceIndex(tokenizer->getSourceIndex());
+    Token token;
+    while(peek(token))
     {
-        Token token;
-        while(peek(token))
+        try
         {
             StatementPtr statement = parseStatement();
             if(!statement)
-                break;
+            {
+                if(!errorRecovery)
+                    break;
+                if(!advanced(token))
+                    unexpected(token);
+                continue;
+            }
             program->addStatement(statement);
             match(L";");
         }
-    }
-    catch(...)
-    {
-        return false;
+        catch(const Abort&)
+        {
+            if(!recover(token))
+                return false;
+            program->addStatement(nodeFactory->createError(location(token)));
+        }
+        catch(...)
+        {
+            return false;
+        }
     }
     return true;
 }
@@ -60,7 +60,7 @@ AttributePtr Parser::parseAttribute()
 {
     Token token;
     expect(L"@", token);
-    AttributePtr ret = nodeFactory->createAttribute(token.state);
+    AttributePtr ret = nodeFactory->createAttribute(location(token));
     expect_identifier(token);
     ret->setName(token.token);
     if(match(L"("))
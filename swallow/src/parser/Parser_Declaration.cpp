@@ -245,7 +245,7 @@ DeclarationPtr Parser::parseImport(const std::vector<AttributePtr>& attrs)
 {
     Token token;
     expect(Keyword::Import, token);
-    ImportPtr ret = nodeFactory->createImport(token.state);
+    ImportPtr ret = nodeFactory->createImport(location(token));
     ret->setAttributes(attrs);
     expect_next(token);
     tassert(token, token.type == TokenType::Identifier, Errors::E_EXPECT_IDENTIFIER_1, token.token);
@@ -309,7 +309,7 @@ DeclarationPtr Parser::parseLet(const std::vector<AttributePtr>& attrs, int modi
     Token token;
     Flags flag(this, UNDER_LET);
     expect(Keyword::Let, token);
-    ValueBindingsPtr ret = nodeFactory->createValueBindings(token.state);
+    ValueBindingsPtr ret = nodeFactory->createValueBindings(location(token));
     ret->setReadOnly(true);
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
@@ -395,7 +395,7 @@ DeclarationPtr Parser::parseVar(const std::vector<AttributePtr>& attrs, int modi
     expect(Keyword::Var, token);
     Flags flags(this, UNDER_VAR);
     //try read it as pattern-initializer-list
-    ValueBindingsPtr ret = nodeFactory->createValueBindings(token.state);
+    ValueBindingsPtr ret = nodeFactory->createValueBindings(location(token));
     ret->setReadOnly(false);
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
@@ -466,7 +466,7 @@ DeclarationPtr Parser::parseVar(const std::vector<AttributePtr>& attrs, int modi
                 break;
             default:
                 //‌ variable-declaration → variable-declaration-head variable-name type-annotation code-block
-                CodeBlockPtr getter = nodeFactory->createCodeBlock(token.state);
+                CodeBlockPtr getter = nodeFactory->createCodeBlock(location(token));
                 prop->setGetter(getter);
                 do
                 {
@@ -633,12 +633,12 @@ std::pair<CodeBlockPtr, CodeBlockPtr> Parser::parseGetterSetterKeywordBlock()
 
     if(match(Keyword::Get, token))
     {
-        getter = nodeFactory->createCodeBlock(token.state);
+        getter = nodeFactory->createCodeBlock(location(token));
         getter->setAttributes(attributes);
         parseAttributes(attributes);
         if(match(Keyword::Set, token))
         {
-            setter = nodeFactory->createCodeBlock(token.state);
+            setter = nodeFactory->createCodeBlock(location(token));
             setter->setAttributes(attributes);
         }
         else if(!attributes.empty())//attributes defined for setter but setter is not found
@@ -650,12 +650,12 @@ std::pair<CodeBlockPtr, CodeBlockPtr> Parser::parseGetterSetterKeywordBlock()
     }
     else if(match(Keyword::Set, token))
     {
-        setter = nodeFactory->createCodeBlock(token.state);
+        setter = nodeFactory->createCodeBlock(location(token));
         setter->setAttributes(attributes);
         
         parseAttributes(attributes);
         expect(Keyword::Get, token);
-        getter = nodeFactory->createCodeBlock(token.state);
+        getter = nodeFactory->createCodeBlock(location(token));
         getter->setAttributes(attributes);
     }
     return std::make_pair(getter, setter);
@@ -688,7 +688,7 @@ DeclarationPtr Parser::parseTypealias(const Attributes& attrs, int modifiers)
         expect(L"=");
         type = parseType();
     }
-    TypeAliasPtr ret = nodeFactory->createTypealias(token.state);
+    TypeAliasPtr ret = nodeFactory->createTypealias(location(token));
     ret->setAttributes(attrs);
     ret->setName(token.token);
     ret->setType(type);
@@ -709,7 +709,7 @@ DeclarationPtr Parser::parseFunc(const std::vector<AttributePtr>& attrs, int mod
 {
     Token token;
     expect(Keyword::Func, token);
-    FunctionDefPtr ret = nodeFactory->createFunction(token.state);
+    FunctionDefPtr ret = nodeFactory->createFunction(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     expect_next(token);
@@ -771,7 +771,7 @@ ParametersNodePtr Parser::parseParameterClause()
 {
     Token token;
     expect(L"(", token);
-    ParametersNodePtr ret = nodeFactory->createParameters(token.state);
+    ParametersNodePtr ret = nodeFactory->createParameters(location(token));
     if(match(L")"))
         return ret;
     ENTER_CONTEXT(TokenizerContextFunctionSignature);
@@ -780,7 +780,7 @@ ParametersNodePtr Parser::parseParameterClause()
         bool inout = match(Keyword::Inout);
         ParameterNode::Accessibility accessibility = ParameterNode::None;
         expect_next(token);
-        ParameterNodePtr param = nodeFactory->createParameter(token.state);
+        ParameterNodePtr param = nodeFactory->createParameter(location(token));
         if(token.type == TokenType::Identifier)
         {
             if(token.identifier.keyword == Keyword::Var)
@@ -853,14 +853,14 @@ DeclarationPtr Parser::parseEnum(const std::vector<AttributePtr>& attrs, int mod
     Flags flag(this);
     flags += UNDER_ENUM;
     expect_identifier(token);
-    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(token.state);
+    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(location(token));
     typeId->setName(token.token);
     GenericParametersDefPtr generic = nullptr;
     if(predicate(L"<"))
     {
         generic = this->parseGenericParametersDef();
     }
-    EnumDefPtr ret = nodeFactory->createEnum(token.state);
+    EnumDefPtr ret = nodeFactory->createEnum(location(token));
     ret->setValueStyle(EnumDef::Undefined);
     ret->setIdentifier(typeId);
     ret->setGenericParametersDef(generic);
@@ -927,11 +927,11 @@ DeclarationPtr Parser::parseStruct(const std::vector<AttributePtr>& attrs, int m
 {
     Token token;
     expect(Keyword::Struct);
-    StructDefPtr ret = nodeFactory->createStruct(token.state);
+    StructDefPtr ret = nodeFactory->createStruct(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     expect_identifier(token);
-    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(token.state);
+    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(location(token));
     typeId->setName(token.token);
     ret->setIdentifier(typeId);
 
@@ -979,11 +979,11 @@ DeclarationPtr Parser::parseClass(const std::vector<AttributePtr>& attrs, int mo
 {
     Token token;
     expect(Keyword::Class, token);
-    ClassDefPtr ret = nodeFactory->createClass(token.state);
+    ClassDefPtr ret = nodeFactory->createClass(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     expect_identifier(token);
-    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(token.state);
+    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(location(token));
     typeId->setName(token.token);
     ret->setIdentifier(typeId);
     if(predicate(L"<"))
@@ -1057,11 +1057,11 @@ DeclarationPtr Parser::parseProtocol(const std::vector<AttributePtr>& attrs, int
 {
     Token token;
     expect(Keyword::Protocol);
-    ProtocolDefPtr ret = nodeFactory->createProtocol(token.state);
+    ProtocolDefPtr ret = nodeFactory->createProtocol(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     expect_identifier(token);
-    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(token.state);
+    TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(location(token));
     typeId->setName(token.token);
     ret->setIdentifier(typeId);
     if(match(L":"))
@@ -1109,7 +1109,7 @@ DeclarationPtr Parser::parseInit(const std::vector<AttributePtr>& attrs, int mod
     }
     else
         restore(token);
-    InitializerDefPtr ret = nodeFactory->createInitializer(token.state);
+    InitializerDefPtr ret = nodeFactory->createInitializer(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     ret->setFailable(failable);
@@ -1134,7 +1134,7 @@ DeclarationPtr Parser::parseDeinit(const std::vector<AttributePtr>& attrs, int m
 {
     Token token;
     expect(Keyword::Deinit, token);
-    DeinitializerDefPtr ret = nodeFactory->createDeinitializer(token.state);
+    DeinitializerDefPtr ret = nodeFactory->createDeinitializer(location(token));
     ret->setAttributes(attrs);
     ret->setModifiers(modifiers);
     CodeBlockPtr body = parseCodeBlock();
@@ -1153,7 +1153,7 @@ DeclarationPtr Parser::parseExtension(const std::vector<AttributePtr>& attrs, in
     Flags flags(this, UNDER_EXTENSION);
     expect(Keyword::Extension, token);
     TypeIdentifierPtr id = parseTypeIdentifier();
-    ExtensionDefPtr ret = nodeFactory->createExtension(token.state);
+    ExtensionDefPtr ret = nodeFactory->createExtension(location(token));
     ret->setAttributes(attrs);
     ret->setIdentifier(id);
     ret->setModifiers(modifiers);
@@ -1197,7 +1197,7 @@ DeclarationPtr Parser::parseSubscript(const std::vector<AttributePtr>& attrs, in
     Attributes typeAttrs;
     parseAttributes(typeAttrs);
     TypeNodePtr retType = parseType();
-    SubscriptDefPtr ret = nodeFactory->createSubscript(token.state);
+    SubscriptDefPtr ret = nodeFactory->createSubscript(location(token));
     ret->setAttributes(attrs);
     ret->setParameters(params);
     ret->setReturnType(retType);
@@ -1267,7 +1267,7 @@ DeclarationPtr Parser::parseOperator(const std::vector<AttributePtr>& attrs, int
     ENTER_CONTEXT(TokenizerContextOperator);
 
     OperatorType::T type = OperatorType::_;
-    OperatorDefPtr op = nodeFactory->createOperator(token.state);
+    OperatorDefPtr op = nodeFactory->createOperator(location(token));
     op->setAttributes(attrs);
 
     if(modifiers & DeclarationModifiers::Prefix)
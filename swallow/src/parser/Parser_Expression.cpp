@@ -42,7 +42,7 @@ ExpressionPtr Parser::parseFloat()
 {
     Token token;
     expect_next(token);
-    FloatLiteralPtr ret = nodeFactory->createFloat(token.state);
+    FloatLiteralPtr ret = nodeFactory->createFloat(location(token));
     ret->valueAsString = token.token;
     ret->value = token.number.dvalue;
     return ret;
@@ -51,18 +51,18 @@ ExpressionPtr Parser::parseInteger()
 {
     Token token;
     expect_next(token);
-    IntegerLiteralPtr ret = nodeFactory->createInteger(token.state);
+    IntegerLiteralPtr ret = nodeFactory->createInteger(location(token));
     ret->valueAsString = token.token;
-    ret->value = token.number.value;
-    ret->dvalue = token.number.dvalue;
     ret->isFloat = token.type == TokenType::Float;
+    ret->value = ret->isFloat ? (int64_t)token.number.dvalue : token.number.value;
+    ret->dvalue = ret->isFloat ? token.number.dvalue : (double)token.number.value;
     return ret;
 }
-static void appendString(NodeFactory* nodeFactory, const StringInterpolationPtr& si, const Token& token)
+static void appendString(NodeFactory* nodeFactory, const StringInterpolationPtr& si, const Token& token, const SourceInfo& info)
 {
     if(token.token.empty())
         return;
-    StringLiteralPtr str = nodeFactory->createString(token.state);
+    StringLiteralPtr str = nodeFactory->createString(info);
     str->value = token.token;
     si->addExpression(str);
 }
@@ -72,19 +72,19 @@ ExpressionPtr Parser::parseString()
     expect_next(token);
     if(!token.string.expressionFollowed)
     {
-        StringLiteralPtr ret = nodeFactory->createString(token.state);
+        StringLiteralPtr ret = nodeFactory->createString(location(token));
         ret->value = token.token;
         return ret;
     }
-    StringInterpolationPtr si = nodeFactory->createStringInterpolation(token.state);
-    appendString(nodeFactory, si, token);
+    StringInterpolationPtr si = nodeFactory->createStringInterpolation(location(token));
+    appendString(nodeFactory, si, token, location(token));
     do
     {
         ExpressionPtr expr = parseExpression();
         si->addExpression(expr);
         expect_next(token);
         tassert(token, token.type == TokenType::String, Errors::E_UNTERMINATED_STRING_LITERAL);
-        appendString(nodeFactory, si, token);
+        appendString(nodeFactory, si, token, location(token));
     }while(token.string.expressionFollowed);
 
     return si;
@@ -102,9 +102,9 @@ ExpressionPtr Parser::parsePrefixExpression()
     {
         //in-out-expression → & identifier
         expect_identifier(token);
-        IdentifierPtr identifier = nodeFactory->createIdentifier(token.state);
+        IdentifierPtr identifier = nodeFactory->createIdentifier(location(token));
         identifier->setIdentifier(token.token);
-        InOutParameterNode ret = nodeFactory->createInOutParameter(token.state);
+        InOutParameterNode ret = nodeFactory->createInOutParameter(location(token));
         ret->setOperand(identifier);
         return ret;
     }
@@ -114,7 +114,8 @@ ExpressionPtr Parser::parsePrefixExpression()
     if(token.type == TokenType::Operator && token.operators.type == OperatorType::PrefixUnary)
     {
         ExpressionPtr postfixExpression = parsePostfixExpression();
-        UnaryOperatorPtr op = nodeFactory->createUnary(token.state);
+        tassert(token, postfixExpression != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
+        UnaryOperatorPtr op = nodeFactory->createUnary(location(token));
         op->setOperator(token.token);
         op->setOperatorType(token.operators.type);
         op->setOperand(postfixExpression);
@@ -142,6 +143,8 @@ ExpressionPtr Parser::parsePostfixExpression()
     Token token;
     // postfix-expression → primary-expression
     ExpressionPtr ret =  parsePrimaryExpression();
+    if(!ret)
+        return ret;
     while(peek(token))
     {
         if(token.type == TokenType::Dot)
@@ -156,7 +159,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             {
                 if (token == L"init")
                 {
-                    InitializerReferencePtr r = nodeFactory->createInitializerReference(token.state);
+                    InitializerReferencePtr r = nodeFactory->createInitializerReference(location(token));
                     r->setExpression(ret);
                     ret = r;
                     continue;
@@ -164,7 +167,7 @@ ExpressionPtr Parser::parsePostfixExpression()
                 // postfix-expression → postfix-self-expression
                 if (token.identifier.keyword == Keyword::Self)
                 {
-                    SelfExpressionPtr r = nodeFactory->createSelfExpression(token.state);
+                    SelfExpressionPtr r = nodeFactory->createSelfExpression(location(token));
                     r->setExpression(ret);
                     ret = r;
                     continue;
@@ -172,7 +175,7 @@ ExpressionPtr Parser::parsePostfixExpression()
                 // postfix-expression → dynamic-type-expression
                 if (token.identifier.keyword == Keyword::DynamicType)
                 {
-                    DynamicTypePtr r = nodeFactory->createDynamicType(token.state);
+                    DynamicTypePtr r = nodeFactory->createDynamicType(location(token));
                     r->setExpression(ret);
                     ret = r;
                     continue;
@@ -181,7 +184,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             }
 
             // postfix-expression → explicit-member-expression
-            MemberAccessPtr access = nodeFactory->createMemberAccess(token.state);
+            MemberAccessPtr access = nodeFactory->createMemberAccess(location(token));
             access->setSelf(ret);
             if(token.type == TokenType::Integer)
             {
@@ -189,7 +192,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             }
             else
             {
-                IdentifierPtr field = nodeFactory->createIdentifier(token.state);
+                IdentifierPtr field = nodeFactory->createIdentifier(location(token));
                 field->setIdentifier(token.token);
                 access->setField(field);
             }
@@ -202,7 +205,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             {
                 // postfix-expression → forced-value-expression
                 expect_next(token);
-                ForcedValuePtr r = nodeFactory->createForcedValue(token.state);
+                ForcedValuePtr r = nodeFactory->createForcedValue(location(token));
                 r->setExpression(ret);
                 ret = r;
                 continue;
@@ -211,7 +214,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             if(token.type == TokenType::Operator && token.operators.type == OperatorType::PostfixUnary)//symbolRegistry->isPostfixOperator(token.token))
             {
                 expect_next(token);
-                UnaryOperatorPtr postfix = nodeFactory->createUnary(token.state);
+                UnaryOperatorPtr postfix = nodeFactory->createUnary(location(token));
                 postfix->setOperator(token.token);
                 postfix->setOperatorType(OperatorType::PostfixUnary);
                 postfix->setOperand(ret);
@@ -225,7 +228,7 @@ ExpressionPtr Parser::parsePostfixExpression()
             //? used as post unary operator will treated as optional chaining expression, not ternary expression
             // postfix-expression → optional-chaining-expression
             expect_next(token);
-            OptionalChainingPtr r = nodeFactory->createOptionalChaining(token.state);
+            OptionalChainingPtr r = nodeFactory->createOptionalChaining(location(token));
             r->setExpression(ret);
             ret = r;
             continue;
@@ -247,9 +250,9 @@ ExpressionPtr Parser::parsePostfixExpression()
         {
             // subscript-expression → postfix-expression[expression-list]
             match(L"[", token);
-            SubscriptAccessPtr subscript = nodeFactory->createSubscriptAccess(token.state);
+            SubscriptAccessPtr subscript = nodeFactory->createSubscriptAccess(location(token));
             subscript->setSelf(ret);
-            ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(token.state);
+            ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(location(token));
             do
             {
                 parseExpressionItem(index);
@@ -273,7 +276,7 @@ ExpressionPtr Parser::parsePostfixExpression()
  */
 FunctionCallPtr Parser::parseFunctionCallExpression()
 {
-    FunctionCallPtr ret = nodeFactory->createFunctionCall(tokenizer->save());
+    FunctionCallPtr ret = nodeFactory->createFunctionCall(location());
     if(predicate(L"("))
     {
         ParenthesizedExpressionPtr p = this->parseParenthesizedExpression();
@@ -281,7 +284,7 @@ FunctionCallPtr Parser::parseFunctionCallExpression()
     }
     else
     {
-        ParenthesizedExpressionPtr p = nodeFactory->createParenthesizedExpression(tokenizer->save());
+        ParenthesizedExpressionPtr p = nodeFactory->createParenthesizedExpression(location());
         ret->setArguments(p);
     }
     bool suppressTrailingClosure = (this->flags & SUPPRESS_TRAILING_CLOSURE) != 0;
@@ -354,7 +357,7 @@ ExpressionPtr Parser::parsePrimaryExpression()
     if(token == L"_")
     {
         expect_next(token);
-        IdentifierPtr id = nodeFactory->createIdentifier(token.state);
+        IdentifierPtr id = nodeFactory->createIdentifier(location(token));
         id->setIdentifier(L"_");
         return id;
     }
@@ -370,9 +373,9 @@ ExpressionPtr Parser::parsePrimaryExpression()
     {
         expect_next(token);
         expect_identifier(token);
-        IdentifierPtr field = nodeFactory->createIdentifier(token.state);
+        IdentifierPtr field = nodeFactory->createIdentifier(location(token));
         field->setIdentifier(token.token);
-        MemberAccessPtr ret = nodeFactory->createMemberAccess(token.state);
+        MemberAccessPtr ret = nodeFactory->createMemberAccess(location(token));
         ret->setField(field);
         return ret;
     }
@@ -425,7 +428,7 @@ GenericArgumentDefPtr Parser::parseGenericArgumentDef()
 {
     Token token;
     expect(L"<", token);
-    GenericArgumentDefPtr ret = nodeFactory->createGenericArgumentDef(token.state);
+    GenericArgumentDefPtr ret = nodeFactory->createGenericArgumentDef(location(token));
     do
     {
         TypeNodePtr argument = parseType();
@@ -448,7 +451,7 @@ ParenthesizedExpressionPtr Parser::parseParenthesizedExpression()
 {
     Token token;
     match(L"(", token);
-    ParenthesizedExpressionPtr ret = nodeFactory->createParenthesizedExpression(token.state);
+    ParenthesizedExpressionPtr ret = nodeFactory->createParenthesizedExpression(location(token));
     if(!predicate(L")"))
     {
         parseExpressionItem(ret);
@@ -495,7 +498,7 @@ ExpressionPtr Parser::parseSelfExpression()
     Token token;
     expect(Keyword::Self);
     expect_next(token);
-    IdentifierPtr self = nodeFactory->createIdentifier(token.state);
+    IdentifierPtr self = nodeFactory->createIdentifier(location(token));
     self->setIdentifier(L"self");
     if(token == L".")
     {
@@ -503,9 +506,9 @@ ExpressionPtr Parser::parseSelfExpression()
         tassert(token, token.type == TokenType::Identifier, Errors::E_EXPECT_IDENTIFIER_1, token.token);
         if(token.identifier.keyword != Keyword::_ && token.identifier.keyword != Keyword::Init)
             unexpected(token);
-        IdentifierPtr field = nodeFactory->createIdentifier(token.state);
+        IdentifierPtr field = nodeFactory->createIdentifier(location(token));
         field->setIdentifier(token.token);
-        MemberAccessPtr ret = nodeFactory->createMemberAccess(token.state);
+        MemberAccessPtr ret = nodeFactory->createMemberAccess(location(token));
         ret->setField(field);
         ret->setSelf(self);
         return ret;
@@ -513,9 +516,9 @@ ExpressionPtr Parser::parseSelfExpression()
     else if(token == L"[")
     {
         ExpressionPtr expr = this->parseExpression();
-        SubscriptAccessPtr sub = nodeFactory->createSubscriptAccess(token.state);
+        SubscriptAccessPtr sub = nodeFactory->createSubscriptAccess(location(token));
         sub->setSelf(self);
-        ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(token.state);
+        ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(location(token));
         do
         {
             parseExpressionItem(index);
@@ -540,7 +543,7 @@ ExpressionPtr Parser::parseSuperExpression()
 {
     Token token;
     expect(Keyword::Super, token);
-    IdentifierPtr super = nodeFactory->createIdentifier(token.state);
+    IdentifierPtr super = nodeFactory->createIdentifier(location(token));
     super->setIdentifier(L"super");
     expect_next(token);
     if(token == L".")
@@ -550,9 +553,9 @@ ExpressionPtr Parser::parseSuperExpression()
             unexpected(token);
         if(token.identifier.keyword != Keyword::_ && token.identifier.keyword != Keyword::Init)
             unexpected(token);
-        IdentifierPtr field = nodeFactory->createIdentifier(token.state);
+        IdentifierPtr field = nodeFactory->createIdentifier(location(token));
         field->setIdentifier(token.token);
-        MemberAccessPtr ret = nodeFactory->createMemberAccess(token.state);
+        MemberAccessPtr ret = nodeFactory->createMemberAccess(location(token));
         ret->setSelf(super);
         ret->setField(field);
         return ret;
@@ -561,8 +564,8 @@ ExpressionPtr Parser::parseSuperExpression()
     {
         ExpressionPtr expr = this->parseExpression();
         expect(L"]", token);
-        SubscriptAccessPtr sub = nodeFactory->createSubscriptAccess(token.state);
-        ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(token.state);
+        SubscriptAccessPtr sub = nodeFactory->createSubscriptAccess(location(token));
+        ParenthesizedExpressionPtr index = nodeFactory->createParenthesizedExpression(location(token));
         sub->setSelf(super);
         do
         {
@@ -580,7 +583,7 @@ IdentifierPtr Parser::parseIdentifier()
 {
     Token token;
     expect_identifier(token);
-    IdentifierPtr ret = nodeFactory->createIdentifier(token.state);
+    IdentifierPtr ret = nodeFactory->createIdentifier(location(token));
     ret->setIdentifier(token.token);
     
     if(isGenericArgument())
@@ -621,13 +624,13 @@ ExpressionPtr Parser::parseLiteralExpression()
         if(token.type == TokenType::CloseBracket)
         {
             //[] detected, empty array
-            return nodeFactory->createArrayLiteral(token.state);
+            return nodeFactory->createArrayLiteral(location(token));
         }
         if(token.type == TokenType::Colon)
         {
             //[: detected, empty dictionary
             expect(L"]", token);
-            return nodeFactory->createDictionaryLiteral(token.state);
+            return nodeFactory->createDictionaryLiteral(location(token));
         }
         restore(token);
         //check if there's a colon after an expression
@@ -637,7 +640,7 @@ ExpressionPtr Parser::parseLiteralExpression()
         peek(token);
         if(token.type == TokenType::Comma || token.type == TokenType::CloseBracket)//array
         {
-            ArrayLiteralPtr array = nodeFactory->createArrayLiteral(token.state);
+            ArrayLiteralPtr array = nodeFactory->createArrayLiteral(location(token));
             array->push(ExpressionPtr(tmp));
             while(match(L","))
             {
@@ -652,7 +655,7 @@ ExpressionPtr Parser::parseLiteralExpression()
         else if(token.type == TokenType::Colon)//dictionary
         {
             match(L":");
-            DictionaryLiteralPtr dict = nodeFactory->createDictionaryLiteral(token.state);
+            DictionaryLiteralPtr dict = nodeFactory->createDictionaryLiteral(location(token));
             ExpressionPtr key = tmp;
             ExpressionPtr value = parseExpression();
             tassert(token, value != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
@@ -678,7 +681,7 @@ ExpressionPtr Parser::parseLiteralExpression()
         {
             case Keyword::File:
             {
-                CompileConstantPtr c = nodeFactory->createCompilecConstant(token.state);
+                CompileConstantPtr c = nodeFactory->createCompilecConstant(location(token));
                 c->setName(L"__FILE__");
                 c->setValue(fileName);
                 return c;
@@ -686,8 +689,10 @@ ExpressionPtr Parser::parseLiteralExpression()
             case Keyword::Line:
             {
                 std::wstringstream ss;
-                ss<<token.state.column;
-                CompileConstantPtr c = nodeFactory->createCompilecConstant(token.state);
+                int line, column;
+                tokenizer->getSourceIndex().getPosition(token.offset, line, column);
+                ss<<column;
+                CompileConstantPtr c = nodeFactory->createCompilecConstant(location(token));
                 c->setName(L"__LINE__");
                 c->setValue(ss.str());
                 return c;
@@ -695,15 +700,15 @@ ExpressionPtr Parser::parseLiteralExpression()
             case Keyword::Column:
             {
                 std::wstringstream ss;
-                ss<<token.state.line;
-                CompileConstantPtr c = nodeFactory->createCompilecConstant(token.state);
+                ss<<line(token);
+                CompileConstantPtr c = nodeFactory->createCompilecConstant(location(token));
                 c->setName(L"__COLUMN__");
                 c->setValue(ss.str());
                 return c;
             }
             case Keyword::Function:
             {
-                CompileConstantPtr c = nodeFactory->createCompilecConstant(token.state);
+                CompileConstantPtr c = nodeFactory->createCompilecConstant(location(token));
                 c->setName(L"__FUNCTION__");
                 c->setValue(functionName);
                 return c;
@@ -724,7 +729,7 @@ ExpressionPtr Parser::parseLiteral()
     {
         case TokenType::Integer:
         {
-            IntegerLiteralPtr i = nodeFactory->createInteger(token.state);
+            IntegerLiteralPtr i = nodeFactory->createInteger(location(token));
             i->valueAsString = token.token;
             i->value = token.number.value;
             return i;
@@ -736,7 +741,7 @@ ExpressionPtr Parser::parseLiteral()
         }
         case TokenType::Float:
         {
-            FloatLiteralPtr f = nodeFactory->createFloat(token.state);
+            FloatLiteralPtr f = nodeFactory->createFloat(location(token));
             f->valueAsString = token.token;
             f->value = token.number.dvalue;
             return f;
@@ -747,13 +752,13 @@ ExpressionPtr Parser::parseLiteral()
             {
                 case Keyword::Nil:
                 {
-                    NilLiteralPtr nil = nodeFactory->createNilLiteral(token.state);
+                    NilLiteralPtr nil = nodeFactory->createNilLiteral(location(token));
                     return nil;
                 }
                 case Keyword::True:
                 case Keyword::False:
                 {
-                    BooleanLiteralPtr ret = nodeFactory->createBooleanLiteral(token.state);
+                    BooleanLiteralPtr ret = nodeFactory->createBooleanLiteral(location(token));
                     ret->setValue(token.getKeyword() == Keyword::True);
                     return ret;
                 }
@@ -829,12 +834,16 @@ ExpressionPtr Parser::parseBinaryExpression(const ExpressionPtr& lhs)
 {
     Token token;
     expect_next(token);
+    //only a bare infix operator like sort(names, >) may come without operands
+    bool infixOperator = token.type == TokenType::Operator && token.operators.type == OperatorType::InfixBinary && !(token == L"=");
+    if(!infixOperator)
+        tassert(token, lhs != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
     if(token.type == TokenType::Identifier)
     {
         if(token.identifier.keyword == Keyword::Is)
         {
             TypeNodePtr typeNode = parseType();
-            TypeCheckPtr ret = nodeFactory->createTypeCheck(token.state);
+            TypeCheckPtr ret = nodeFactory->createTypeCheck(location(token));
             ret->setLHS(lhs);
             ret->setDeclaredType(typeNode);
             return ret;
@@ -855,7 +864,7 @@ ExpressionPtr Parser::parseBinaryExpression(const ExpressionPtr& lhs)
             
             TypeNodePtr typeNode = parseType();
             
-            TypeCastPtr ret = nodeFactory->createTypeCast(token.state);
+            TypeCastPtr ret = nodeFactory->createTypeCast(location(token));
             ret->setLHS(lhs);
             ret->setDeclaredType(typeNode);
             ret->setOptional(optional);
@@ -867,7 +876,8 @@ ExpressionPtr Parser::parseBinaryExpression(const ExpressionPtr& lhs)
         if(token == L"=")
         {
             ExpressionPtr rhs = parsePrefixExpression();
-            AssignmentPtr ret = nodeFactory->createAssignment(token.state);
+            tassert(token, rhs != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
+            AssignmentPtr ret = nodeFactory->createAssignment(location(token));
             ret->setLHS(lhs);
             ret->setRHS(rhs);
             return ret;
@@ -878,8 +888,9 @@ ExpressionPtr Parser::parseBinaryExpression(const ExpressionPtr& lhs)
             //OperatorInfo* op = symbolRegistry->getOperator(token.token);
             //tassert(token, op != NULL, Errors::E_UNDEFINED_INFIX_OPERATOR, token.token);
             ExpressionPtr rhs = parsePrefixExpression();
+            tassert(token, (lhs == NULL) == (rhs == NULL), Errors::E_EXPECT_EXPRESSION_1, token.token);
             //int precedence = op->precedence.infix > 0 ? op->precedence.infix : 100;
-            BinaryOperatorPtr ret = nodeFactory->createBinary(token.state);
+            BinaryOperatorPtr ret = nodeFactory->createBinary(location(token));
             ret->setOperator(token.token);
             //ret->setAssociativity(op->associativity);
             //ret->setPrecedence(precedence);
@@ -892,9 +903,11 @@ ExpressionPtr Parser::parseBinaryExpression(const ExpressionPtr& lhs)
     {
         // binary-expression → conditional-operator prefix-expression
         ExpressionPtr expr = parseExpression();
+        tassert(token, expr != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
         expect(L":");
         ExpressionPtr expr2 = parsePrefixExpression();
-        ConditionalOperatorPtr ret = nodeFactory->createConditionalOperator(token.state);
+        tassert(token, expr2 != NULL, Errors::E_EXPECT_EXPRESSION_1, token.token);
+        ConditionalOperatorPtr ret = nodeFactory->createConditionalOperator(location(token));
         ret->setCondition(lhs);
         ret->setTrueExpression(expr);
         ret->setFalseExpression(expr2);
@@ -919,7 +932,7 @@ ClosurePtr Parser::parseClosureExpression()
 {
     Token token;
     expect(L"{", token);
-    ClosurePtr ret = nodeFactory->createClosure(token.state);
+    ClosurePtr ret = nodeFactory->createClosure(location(token));
     TokenizerState s = tokenizer->save();
     bool hasSignature = false;
     //look for keyword "in"
@@ -973,11 +986,11 @@ ClosurePtr Parser::parseClosureExpression()
         }
         else
         {
-            ParametersNodePtr params = nodeFactory->createParameters(tokenizer->save());
+            ParametersNodePtr params = nodeFactory->createParameters(location());
             do
             {
                 expect_identifier(token);
-                ParameterNodePtr param = nodeFactory->createParameter(token.state);
+                ParameterNodePtr param = nodeFactory->createParameter(location(token));
                 param->setLocalName(token.token);
                 params->addParameter(param);
             } while (match(L","));
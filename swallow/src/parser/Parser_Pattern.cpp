@@ -56,7 +56,7 @@ PatternPtr Parser::parsePattern()
             // pattern → identifier-pattern type-annotationopt
             case Keyword::_:
             {
-                IdentifierPtr id = nodeFactory->createIdentifier(token.state);
+                IdentifierPtr id = nodeFactory->createIdentifier(location(token));
                 id->setIdentifier(token.token);
                 if((flags & UNDER_CASE) == 0)//type annotation is not parsed when it's inside a let/var
                 {
@@ -75,7 +75,7 @@ PatternPtr Parser::parsePattern()
             case Keyword::Var:
             case Keyword::Let:
             {
-                ValueBindingPatternPtr ret = nodeFactory->createValueBindingPattern(token.state);
+                ValueBindingPatternPtr ret = nodeFactory->createValueBindingPattern(location(token));
                 PatternPtr binding = parsePattern();
                 if(TypedPatternPtr p = std::dynamic_pointer_cast<TypedPattern>(binding))
                 {
@@ -150,7 +150,7 @@ PatternPtr Parser::parseEnumPattern()
     Token token;
     expect(L".");
     expect_identifier(token);
-    EnumCasePatternPtr ret = nodeFactory->createEnumCasePattern(token.state);
+    EnumCasePatternPtr ret = nodeFactory->createEnumCasePattern(location(token));
     ret->setName(token.token);
 
 
@@ -174,7 +174,7 @@ PatternPtr Parser::parseTypeCastingPattern()
     {
         //is-pattern → is type
         TypeNodePtr type = parseType();
-        TypeCheckPtr ret = nodeFactory->createTypeCheck(token.state);
+        TypeCheckPtr ret = nodeFactory->createTypeCheck(location(token));
         ret->setDeclaredType(type);
         return ret;
     }
@@ -182,7 +182,7 @@ PatternPtr Parser::parseTypeCastingPattern()
     PatternPtr pat = parsePattern();
     expect(Keyword::As, token);
     TypeNodePtr type = parseType();
-    TypeCastPtr ret = nodeFactory->createTypeCast(token.state);
+    TypeCastPtr ret = nodeFactory->createTypeCast(location(token));
     ret->setLHS(pat);
     ret->setDeclaredType(type);
     return ret;
@@ -196,7 +196,7 @@ PatternPtr Parser::parseTuple()
 {
     Token token;
     expect(L"(", token);
-    TuplePtr ret = nodeFactory->createTuple(token.state);
+    TuplePtr ret = nodeFactory->createTuple(location(token));
     if(!predicate(L")"))
     {
         do
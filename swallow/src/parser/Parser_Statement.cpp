@@ -182,7 +182,7 @@ StatementPtr Parser::parseForIn()
 {
     Token token;
     expect(Keyword::For, token);
-    ForInLoopPtr ret = nodeFactory->createForInLoop(token.state);
+    ForInLoopPtr ret = nodeFactory->createForInLoop(location(token));
     Flags flags(this);
     flags += SUPPRESS_TRAILING_CLOSURE;
     PatternPtr loopVars = parsePattern();
@@ -213,7 +213,7 @@ StatementPtr Parser::parseForStatement()
     expect(Keyword::For, token);
     Flags flags(this);
     flags += SUPPRESS_TRAILING_CLOSURE;
-    ForLoopPtr ret = nodeFactory->createForLoop(token.state);
+    ForLoopPtr ret = nodeFactory->createForLoop(location(token));
     bool parenthesized = match(L"(");
     if(!predicate(L";", token))
     {
@@ -281,7 +281,7 @@ StatementPtr Parser::parseWhileLoop()
     Token token;
     Flags flags(this, SUPPRESS_TRAILING_CLOSURE);
     expect(Keyword::While, token);
-    WhileLoopPtr ret = nodeFactory->createWhileLoop(token.state);
+    WhileLoopPtr ret = nodeFactory->createWhileLoop(location(token));
     ExpressionPtr condition = parseConditionExpression();
     //TODO: The condition can also be an optional binding declaration, as discussed in Optional Binding.
     ret->setCondition(condition);
@@ -298,7 +298,7 @@ ExpressionPtr Parser::parseConditionExpression()
     {
         Keyword::T keyword = token.identifier.keyword;
         tassert(token, keyword == Keyword::Var || keyword == Keyword::Let, Errors::E_EXPECTED_EXPRESSION_VAR_OR_LET_IN_A_CONDITION_1, L"if");
-        ValueBindingPatternPtr value = nodeFactory->createValueBindingPattern(token.state);
+        ValueBindingPatternPtr value = nodeFactory->createValueBindingPattern(location(token));
         value->setReadOnly(keyword == Keyword::Let);
         PatternPtr binding = parsePattern();
         value->setBinding(binding);
@@ -312,7 +312,7 @@ ExpressionPtr Parser::parseConditionExpression()
         {
             tassert(token, false, Errors::E_VARIABLE_BINDING_IN_A_CONDITION_REQUIRES_AN_INITIALIZER);
         }
-        AssignmentPtr assignment = nodeFactory->createAssignment(token.state);
+        AssignmentPtr assignment = nodeFactory->createAssignment(location(token));
         ExpressionPtr expr = parseExpression();
         assignment->setLHS(value);
         assignment->setRHS(expr);
@@ -334,7 +334,7 @@ StatementPtr Parser::parseDoLoop()
     Token token;
     Flags flags(this, SUPPRESS_TRAILING_CLOSURE);
     expect(Keyword::Do, token);
-    DoLoopPtr ret = nodeFactory->createDoLoop(token.state);
+    DoLoopPtr ret = nodeFactory->createDoLoop(location(token));
     CodeBlockPtr codeBlock = parseCodeBlock();
     ret->setCodeBlock(codeBlock);
     expect(Keyword::While);
@@ -353,7 +353,7 @@ IfStatementPtr Parser::parseIf()
 {
     Token token;
     expect(Keyword::If, token);
-    IfStatementPtr ret = nodeFactory->createIf(token.state);
+    IfStatementPtr ret = nodeFactory->createIf(location(token));
     {
         Flags flags(this);
         flags += SUPPRESS_TRAILING_CLOSURE;
@@ -403,7 +403,7 @@ StatementPtr Parser::parseSwitch()
     Flags flags(this, UNDER_SWITCH_CASE | SUPPRESS_TRAILING_CLOSURE);
     
     expect(Keyword::Switch, token);
-    SwitchCasePtr ret = nodeFactory->createSwitch(token.state);
+    SwitchCasePtr ret = nodeFactory->createSwitch(location(token));
     {
         Flags f(flags);
         f += SUPPRESS_TRAILING_CLOSURE;
@@ -424,8 +424,8 @@ StatementPtr Parser::parseSwitch()
             fcase += UNDER_CASE;
             
             //“case-item-list → pattern guard-clause opt | pattern guard-clause opt , case-item-list”
-            CaseStatementPtr caseCond = nodeFactory->createCase(token.state);
-            CodeBlockPtr codeBlock = nodeFactory->createCodeBlock(token.state);
+            CaseStatementPtr caseCond = nodeFactory->createCase(location(token));
+            CodeBlockPtr codeBlock = nodeFactory->createCodeBlock(location(token));
             caseCond->setCodeBlock(codeBlock);
             do
             {
@@ -444,8 +444,8 @@ StatementPtr Parser::parseSwitch()
         else if(token.identifier.keyword == Keyword::Default)
         {
             expect(L":");
-            CaseStatementPtr caseCond = nodeFactory->createCase(token.state);
-            CodeBlockPtr codeBlock = nodeFactory->createCodeBlock(token.state);
+            CaseStatementPtr caseCond = nodeFactory->createCase(location(token));
+            CodeBlockPtr codeBlock = nodeFactory->createCodeBlock(location(token));
             caseCond->setCodeBlock(codeBlock);
             parseSwitchStatements(caseCond);
             ret->setDefaultCase(caseCond);
@@ -491,7 +491,7 @@ StatementPtr Parser::parseBreak()
 {
     Token token;
     expect(Keyword::Break, token);
-    BreakStatementPtr ret = nodeFactory->createBreak(token.state);
+    BreakStatementPtr ret = nodeFactory->createBreak(location(token));
     
     if(match_identifier(token) && token.identifier.keyword == Keyword::_)
     {
@@ -513,7 +513,7 @@ StatementPtr Parser::parseContinue()
 {
     Token token;
     expect(Keyword::Continue, token);
-    ContinueStatementPtr ret = nodeFactory->createContinue(token.state);
+    ContinueStatementPtr ret = nodeFactory->createContinue(location(token));
     
     if(match_identifier(token) && token.identifier.keyword == Keyword::_)
     {
@@ -536,7 +536,7 @@ StatementPtr Parser::parseFallthrough()
 {
     Token token;
     expect(Keyword::Fallthrough, token);
-    FallthroughStatementPtr ret = nodeFactory->createFallthrough(token.state);
+    FallthroughStatementPtr ret = nodeFactory->createFallthrough(location(token));
     return ret;
 }
 /*
@@ -548,7 +548,7 @@ StatementPtr Parser::parseReturn()
 {
     Token token;
     expect(Keyword::Return, token);
-    ReturnStatementPtr ret = nodeFactory->createReturn(token.state);
+    ReturnStatementPtr ret = nodeFactory->createReturn(location(token));
     
     if(peek(token))
     {
@@ -584,7 +584,7 @@ StatementPtr Parser::parseLabeledStatement()
             case Keyword::Switch:
             {
                 StatementPtr statement = parseSwitch();
-                LabeledStatementPtr ret = nodeFactory->createLabel(token.state);
+                LabeledStatementPtr ret = nodeFactory->createLabel(location(token));
                 ret->setLabel(label);
                 ret->setStatement(statement);
                 return ret;
@@ -594,7 +594,7 @@ StatementPtr Parser::parseLabeledStatement()
             case Keyword::While:
             {
                 StatementPtr statement = parseLoopStatement();
-                LabeledStatementPtr ret = nodeFactory->createLabel(token.state);
+                LabeledStatementPtr ret = nodeFactory->createLabel(location(token));
                 ret->setLabel(label);
                 ret->setStatement(statement);
                 return ret;
@@ -613,13 +613,29 @@ CodeBlockPtr Parser::parseCodeBlock()
     Flags flags(this);
     flags -= SUPPRESS_TRAILING_CLOSURE;
     expect(L"{", token);
-    CodeBlockPtr ret = nodeFactory->createCodeBlock(token.state);
+    CodeBlockPtr ret = nodeFactory->createCodeBlock(location(token));
     //ENTER_CONTEXT(TokenizerContextUnknown);
     while(!match(L"}"))
     {
-        StatementPtr st = parseStatement();
-        if(st != NULL)
-            ret->addStatement(st);
+        Token start;
+        bool hasStart = peek(start);
+        try
+        {
+            StatementPtr st = parseStatement();
+            if(st != NULL)
+                ret->addStatement(st);
+            else if(hasStart && !advanced(start))
+                unexpected(start);//the token cannot begin a statement
+        }
+        catch(const Abort&)
+        {
+            if(!hasStart || !recover(start))
+                throw;
+            ret->addStatement(nodeFactory->createError(location(start)));
+            //unterminated code block
+            if(!peek(start))
+                expect(L"}");
+        }
     }
     return ret;
 }
@@ -89,7 +89,7 @@ TypeNodePtr Parser::parseType()
                 argType->add(false, L"", ret);
             }
             TypeNodePtr retType = parseType();
-            FunctionTypePtr func = nodeFactory->createFunctionType(token.state);
+            FunctionTypePtr func = nodeFactory->createFunctionType(location(token));
             func->setArgumentsType(argType);
             func->setReturnType(retType);
             ret = func;
@@ -98,7 +98,7 @@ TypeNodePtr Parser::parseType()
         if(token == TokenType::OpenBracket)
         {
             expect(L"]");
-            ArrayTypePtr array = nodeFactory->createArrayType(token.state);
+            ArrayTypePtr array = nodeFactory->createArrayType(location(token));
             array->setInnerType(ret);
             ret = array;
             continue;
@@ -106,7 +106,7 @@ TypeNodePtr Parser::parseType()
         if(token == L"?")
         {
             //optional-type → type?
-            OptionalTypePtr type = nodeFactory->createOptionalType(token.state);
+            OptionalTypePtr type = nodeFactory->createOptionalType(location(token));
             type->setInnerType(ret);
             ret = type;
             continue;
@@ -114,7 +114,7 @@ TypeNodePtr Parser::parseType()
         if(token == L"!")
         {
             //implicitly-unwrapped-optional-type → type!
-            ImplicitlyUnwrappedOptionalPtr type = nodeFactory->createImplicitlyUnwrappedOptional(token.state);
+            ImplicitlyUnwrappedOptionalPtr type = nodeFactory->createImplicitlyUnwrappedOptional(location(token));
             type->setInnerType(ret);
             ret = type;
             continue;
@@ -141,7 +141,7 @@ TypeNodePtr Parser::parseCollectionType()
         //it's a dictionary type
         TypeNodePtr valueType = parseType();
         expect(L"]");
-        DictionaryTypePtr ret = nodeFactory->createDictionaryType(token.state);
+        DictionaryTypePtr ret = nodeFactory->createDictionaryType(location(token));
         ret->setKeyType(type);
         ret->setValueType(valueType);
         return ret;
@@ -150,7 +150,7 @@ TypeNodePtr Parser::parseCollectionType()
     {
         //it's an array type
         expect(L"]");
-        ArrayTypePtr ret = nodeFactory->createArrayType(token.state);
+        ArrayTypePtr ret = nodeFactory->createArrayType(location(token));
         ret->setInnerType(type);
         return ret;
     }
@@ -169,7 +169,7 @@ TupleTypePtr Parser::parseTupleType()
 {
     Token token, token2;
     expect(L"(", token);
-    TupleTypePtr ret = nodeFactory->createTupleType(token.state);
+    TupleTypePtr ret = nodeFactory->createTupleType(location(token));
     Attributes attributes;
     if(!predicate(L")"))
     {
@@ -223,7 +223,7 @@ TypeIdentifierPtr Parser::parseTypeIdentifier()
 {
     Token token;
     expect_identifier(token);
-    TypeIdentifierPtr ret = nodeFactory->createTypeIdentifier(token.state);
+    TypeIdentifierPtr ret = nodeFactory->createTypeIdentifier(location(token));
     ret->setName(token.token);
     if(match(L"<"))
     {
@@ -248,7 +248,7 @@ ProtocolCompositionPtr Parser::parseProtocolComposition()
     Token token;
     expect(L"protocol", token);
     expect(L"<");
-    ProtocolCompositionPtr ret = nodeFactory->createProtocolComposition(token.state);
+    ProtocolCompositionPtr ret = nodeFactory->createProtocolComposition(location(token));
     if(!predicate(L">"))
     {
         do
@@ -288,7 +288,7 @@ GenericParametersDefPtr Parser::parseGenericParametersDef()
 {
     Token token;
     expect(L"<", token);
-    GenericParametersDefPtr ret = nodeFactory->createGenericParametersDef(token.state);
+    GenericParametersDefPtr ret = nodeFactory->createGenericParametersDef(location(token));
     // ‌ generic-parameter-list → generic-parameter | generic-parameter,generic-parameter-list
     do
     {
@@ -297,7 +297,7 @@ GenericParametersDefPtr Parser::parseGenericParametersDef()
         //‌ generic-parameter → type-name:protocol-composition-type
         expect_identifier(token);
         std::wstring typeName = token.token;
-        TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(token.state);
+        TypeIdentifierPtr typeId = nodeFactory->createTypeIdentifier(location(token));
         typeId->setName(typeName);
         ret->addGenericType(typeId);
         if(match(L":"))
@@ -307,8 +307,8 @@ GenericParametersDefPtr Parser::parseGenericParametersDef()
                 expected = parseProtocolComposition();
             else
                 expected = parseTypeIdentifier();
-            GenericConstraintDefPtr c = nodeFactory->createGenericConstraintDef(token.state);
-            typeId = nodeFactory->createTypeIdentifier(token.state);
+            GenericConstraintDefPtr c = nodeFactory->createGenericConstraintDef(location(token));
+            typeId = nodeFactory->createTypeIdentifier(location(token));
             typeId->setName(typeName);
             c->setIdentifier(typeId);
             c->setConstraintType(GenericConstraintDef::AssignableTo);
@@ -0,0 +1,205 @@
+/* BatchCompiler.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "semantics/BatchCompiler.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/TypeCache.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/ScopedNodeFactory.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/OperatorResolver.h"
+#include "semantics/ConstantFolder.h"
+#include "semantics/SemanticAnalyzer.h"
+#include "parser/Parser.h"
+#include "common/SwallowUtils.h"
+#include "common/CompilerTrace.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <dirent.h>
+
+USE_SWALLOW_NS
+using namespace std;
+
+
+BatchCompiler::BatchCompiler(int numThreads)
+:numThreads(numThreads), keepAST(false), trace(nullptr), maxExpressionCost(SemanticAnalyzer::DefaultMaxExpressionCost), maxResults(CompilerResults::DefaultLimit)
+{
+    if(this->numThreads <= 0)
+        this->numThreads = max(1, (int)thread::hardware_concurrency());
+    stdlib = new SymbolRegistry();
+}
+BatchCompiler::~BatchCompiler()
+{
+    delete stdlib;
+}
+
+/*!
+ * Gets the shared global scope, external functions should be declared here before compiling.
+ */
+GlobalScope* BatchCompiler::getGlobalScope()
+{
+    return stdlib->getGlobalScope();
+}
+
+/*!
+ * Keep the analyzed AST in result, default is false
+ */
+void BatchCompiler::setKeepAST(bool keepAST)
+{
+    this->keepAST = keepAST;
+}
+
+/*!
+ * Records the timeline of all compilations to given trace, default is null
+ */
+void BatchCompiler::setTrace(CompilerTrace* trace)
+{
+    this->trace = trace;
+}
+
+/*!
+ * Limits the cost of type checking a single statement, 0 means unlimited.
+ * Default is SemanticAnalyzer::DefaultMaxExpressionCost
+ */
+void BatchCompiler::setMaxExpressionCost(int maxExpressionCost)
+{
+    this->maxExpressionCost = maxExpressionCost;
+}
+
+/*!
+ * Limits the number of compiler results kept for each item, 0 means unlimited.
+ * Default is CompilerResults::DefaultLimit
+ */
+void BatchCompiler::setMaxResults(int maxResults)
+{
+    this->maxResults = maxResults;
+}
+
+/*!
+ * Compile a single item in the caller's thread
+ */
+void BatchCompiler::compile(const BatchItem& item, BatchResult& result)
+{
+    result.fileName = item.fileName;
+    result.successed = false;
+    result.program = nullptr;
+    result.types = nullptr;
+    result.stats.reset();
+    result.compilerResults.setLimit(maxResults);
+    CompilerStatsScope statsScope(&result.stats);
+    CompilerTraceScope traceScope(trace);
+    TraceEvent event(TraceCategory::File, item.fileName);
+
+    //the types and specializations of this item are released after it instead of growing the shared generic types
+    TypeCachePtr types(new TypeCache());
+    TypeCacheScope typeScope(types.get());
+    SymbolRegistry registry(stdlib->getGlobalScope());
+    ScopedNodeFactory nodeFactory;
+    Parser parser(&nodeFactory, &result.compilerResults);
+    parser.setFileName(item.fileName.c_str());
+    parser.setErrorRecovery(true);
+    ScopedProgramPtr program = static_pointer_cast<ScopedProgram>(parser.parse(item.code.c_str()));
+    if(!program)
+        return;
+    //syntax errors were recovered, still analyze the rest of the file to report more errors
+    bool parsed = result.compilerResults.numResults() == 0;
+    try
+    {
+        OperatorResolver operatorResolver(&registry, &result.compilerResults);
+        SemanticAnalyzer analyzer(&registry, &result.compilerResults);
+        analyzer.setMaxExpressionCost(maxExpressionCost);
+        ConstantFolder constantFolder(&registry, &result.compilerResults);
+        program->accept(&operatorResolver);
+        program->accept(&analyzer);
+        program->accept(&constantFolder);
+        result.successed = parsed;
+    }
+    catch(const Abort&)
+    {
+        return;
+    }
+    if(keepAST)
+    {
+        result.types = types;
+        result.program = program;
+    }
+}
+
+/*!
+ * Compile all items concurrently, results are stored in the same order of items.
+ */
+void BatchCompiler::compile(const std::vector<BatchItem>& items, std::vector<BatchResult>& results)
+{
+    results.clear();
+    results.resize(items.size());
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < items.size(); i = next++)
+        {
+            compile(items[i], results[i]);
+        }
+    };
+    int n = min(numThreads, (int)items.size());
+    if(n <= 1)
+    {
+        worker();
+        return;
+    }
+    vector<thread> threads;
+    for(int i = 0; i < n; i++)
+        threads.push_back(thread(worker));
+    for(thread& t : threads)
+        t.join();
+}
+
+/*!
+ * Collect all .swift files under given directory(not recursively), sorted by file name.
+ */
+bool BatchCompiler::readDirectory(const std::string& path, std::vector<BatchItem>& items)
+{
+    DIR* dir = opendir(path.c_str());
+    if(!dir)
+        return false;
+    vector<string> files;
+    while(struct dirent* entry = readdir(dir))
+    {
+        string name = entry->d_name;
+        if(name.size() > 6 && name.compare(name.size() - 6, 6, ".swift") == 0)
+            files.push_back(name);
+    }
+    closedir(dir);
+    sort(files.begin(), files.end());
+    for(const string& file : files)
+    {
+        string fullName = path + "/" + file;
+        items.push_back(BatchItem(SwallowUtils::toWString(fullName), SwallowUtils::readFile(fullName.c_str())));
+    }
+    return true;
+}
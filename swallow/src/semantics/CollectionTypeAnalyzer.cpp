@@ -52,15 +52,15 @@ void CollectionTypeAnalyzer::analyze(const ExpressionPtr& expr)
     if(finalType && Type::equals(exprType, finalType))
         return;//
     assert(exprType != nullptr);
-    switch(expr->getNodeType())
+    switch(expr->getLiteralKind())
     {
-        case NodeType::IntegerLiteral:
+        case LiteralKind::Integer:
             if(finalType == nullptr)
                 finalType = global->Int();
             else if(!finalType->canAssignTo(global->_IntegerType()))
                 differentTypes++;
             break;
-        case NodeType::FloatLiteral:
+        case LiteralKind::Float:
             if(finalType == nullptr || (finalType == global->Int() && changable))
                 finalType = global->Double();
             else if(!finalType->canAssignTo(global->FloatingPointType()))
@@ -32,6 +32,7 @@
 #include "ast/Node.h"
 #include "common/Errors.h"
 #include "common/CompilerResults.h"
+#include "common/CompilerTrace.h"
 
 USE_SWALLOW_NS
 using namespace std;
@@ -91,4 +92,9 @@ void CompilerResultEmitter::warning(const NodePtr& node, int code, const std::ws
     compilerResults->add(ErrorLevel::Warning, *node->getSourceInfo(), code, item);
 }
 
-
+int CompilerResultEmitter::getTraceLine(const NodePtr& node) const
+{
+    if(!CompilerTrace::isActive())
+        return 0;
+    return compilerResults->getLine(*node->getSourceInfo());
+}
@@ -0,0 +1,731 @@
+/* ConstantFolder.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "semantics/ConstantFolder.h"
+#include "ast/ast.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/GlobalScope.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <iomanip>
+
+USE_SWALLOW_NS
+using namespace std;
+
+struct ConstantFolder::Constant
+{
+    enum Kind
+    {
+        Integer,
+        Floating,
+        Boolean,
+        String
+    };
+    Kind kind;
+    int64_t i;
+    double d;
+    bool b;
+    wstring s;
+
+    wstring toString() const
+    {
+        switch(kind)
+        {
+            case Integer:
+                return to_wstring(i);
+            case Floating:
+            {
+                wstringstream out;
+                out<<setprecision(17)<<d;
+                wstring ret = out.str();
+                if(ret.find_first_of(L".en") == wstring::npos)
+                    ret += L".0";
+                return ret;
+            }
+            case Boolean:
+                return b ? L"true" : L"false";
+            default:
+                return s;
+        }
+    }
+};
+
+
+ConstantFolder::ConstantFolder(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults)
+        :SemanticPass(symbolRegistry, compilerResults), scope(nullptr)
+{
+}
+
+/*!
+ * Gets the bit width and signedness of standard integer types, returns false for other types
+ */
+static bool getIntegerType(GlobalScope* global, const TypePtr& type, int& bits, bool& isSigned)
+{
+    static const struct
+    {
+        TypePtr (GlobalScope::*type)() const;
+        int bits;
+        bool isSigned;
+    } types[] = {
+        {&GlobalScope::Int, 64, true}, {&GlobalScope::UInt, 64, false},
+        {&GlobalScope::Int8, 8, true}, {&GlobalScope::UInt8, 8, false},
+        {&GlobalScope::Int16, 16, true}, {&GlobalScope::UInt16, 16, false},
+        {&GlobalScope::Int32, 32, true}, {&GlobalScope::UInt32, 32, false},
+        {&GlobalScope::Int64, 64, true}, {&GlobalScope::UInt64, 64, false},
+        {nullptr, 0, false}
+    };
+    if(!type)
+        return false;
+    for(int i = 0; types[i].type; i++)
+    {
+        if(type == (global->*types[i].type)())
+        {
+            bits = types[i].bits;
+            isSigned = types[i].isSigned;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isFloatingType(GlobalScope* global, const TypePtr& type)
+{
+    return type && (type == global->Double() || type == global->Float());
+}
+
+/*!
+ * Checked arithmetic on 64-bit signed integers, returns true if the operation overflows
+ */
+static bool addOverflow(int64_t a, int64_t b, int64_t& r)
+{
+    typedef numeric_limits<int64_t> limits;
+    if((b > 0 && a > limits::max() - b) || (b < 0 && a < limits::min() - b))
+        return true;
+    r = a + b;
+    return false;
+}
+
+static bool subOverflow(int64_t a, int64_t b, int64_t& r)
+{
+    typedef numeric_limits<int64_t> limits;
+    if((b < 0 && a > limits::max() + b) || (b > 0 && a < limits::min() + b))
+        return true;
+    r = a - b;
+    return false;
+}
+
+static bool mulOverflow(int64_t a, int64_t b, int64_t& r)
+{
+    typedef numeric_limits<int64_t> limits;
+    if(a == 0 || b == 0)
+    {
+        r = 0;
+        return false;
+    }
+    bool overflow;
+    if(a > 0)
+        overflow = b > 0 ? a > limits::max() / b : b < limits::min() / a;
+    else
+        overflow = b > 0 ? a < limits::min() / b : a < limits::max() / b;
+    if(overflow)
+        return true;
+    r = a * b;
+    return false;
+}
+
+/*!
+ * Truncates the value to given bit width, used by the wrapping operators
+ */
+static bool truncate(uint64_t value, int bits, bool isSigned, int64_t& r)
+{
+    if(bits < 64)
+    {
+        uint64_t mask = (1ULL << bits) - 1;
+        value &= mask;
+        if(isSigned && (value >> (bits - 1)) & 1)
+            value |= ~mask;
+    }
+    else if(!isSigned && value > (uint64_t)numeric_limits<int64_t>::max())
+        return false;//cannot be represented by the integer literal
+    r = (int64_t)value;
+    return true;
+}
+
+bool ConstantFolder::evaluate(const ExpressionPtr& expr, Constant& ret)
+{
+    if(!expr)
+        return false;
+    GlobalScope* global = symbolRegistry->getGlobalScope();
+    TypePtr type = expr->getType();
+    int bits;
+    bool isSigned;
+    switch(expr->getNodeType())
+    {
+        case NodeType::IntegerLiteral:
+        {
+            IntegerLiteralPtr literal = static_pointer_cast<IntegerLiteral>(expr);
+            if(getIntegerType(global, type, bits, isSigned))
+            {
+                ret.kind = Constant::Integer;
+                ret.i = literal->value;
+                return true;
+            }
+            if(isFloatingType(global, type))
+            {
+                ret.kind = Constant::Floating;
+                ret.d = literal->isFloat ? literal->dvalue : (double)literal->value;
+                return true;
+            }
+            return false;
+        }
+        case NodeType::FloatLiteral:
+            if(!isFloatingType(global, type))
+                return false;
+            ret.kind = Constant::Floating;
+            ret.d = static_pointer_cast<FloatLiteral>(expr)->value;
+            return true;
+        case NodeType::BooleanLiteral:
+            if(type != global->Bool())
+                return false;
+            ret.kind = Constant::Boolean;
+            ret.b = static_pointer_cast<BooleanLiteral>(expr)->getValue();
+            return true;
+        case NodeType::StringLiteral:
+            if(type != global->String())
+                return false;
+            ret.kind = Constant::String;
+            ret.s = static_pointer_cast<StringLiteral>(expr)->value;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*!
+ * Only the operators declared by the standard library can be evaluated
+ */
+static FunctionSymbolPtr getBuiltinOperator(const ExpressionPtr& node)
+{
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(node->getReferencedSymbol());
+    if(!func || func->getDefinition() || !node->getType())
+        return nullptr;
+    return func;
+}
+
+bool ConstantFolder::checkIntegerRange(const ExpressionPtr& node, const std::wstring& expr, const TypePtr& type, Constant& value)
+{
+    int bits;
+    bool isSigned;
+    getIntegerType(symbolRegistry->getGlobalScope(), type, bits, isSigned);
+    bool inRange;
+    if(bits == 64)
+        inRange = isSigned || value.i >= 0;
+    else if(isSigned)
+        inRange = value.i >= -(1LL << (bits - 1)) && value.i < (1LL << (bits - 1));
+    else
+        inRange = value.i >= 0 && value.i < (1LL << bits);
+    if(!inRange)
+        error(node, Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, expr, type->toString());
+    return inRange;
+}
+
+bool ConstantFolder::evaluateBinary(const BinaryOperatorPtr& node, Constant& ret)
+{
+    FunctionSymbolPtr func = getBuiltinOperator(node);
+    if(!func || func->getType()->getParameters().size() != 2)
+        return false;
+    Constant a, b;
+    if(!evaluate(dynamic_pointer_cast<Expression>(node->getLHS()), a) || !evaluate(dynamic_pointer_cast<Expression>(node->getRHS()), b))
+        return false;
+    if(a.kind != b.kind)
+        return false;
+    GlobalScope* global = symbolRegistry->getGlobalScope();
+    TypePtr type = func->getType()->getParameters()[0].type;
+    const wstring& op = node->getOperator();
+    wstring expr = a.toString() + L" " + op + L" " + b.toString();
+    ret.kind = Constant::Boolean;
+    switch(a.kind)
+    {
+        case Constant::Integer:
+        {
+            int bits;
+            bool isSigned;
+            if(!getIntegerType(global, type, bits, isSigned))
+                return false;
+            if(op == L"==") ret.b = a.i == b.i;
+            else if(op == L"!=") ret.b = a.i != b.i;
+            else if(op == L"<") ret.b = a.i < b.i;
+            else if(op == L"<=") ret.b = a.i <= b.i;
+            else if(op == L">") ret.b = a.i > b.i;
+            else if(op == L">=") ret.b = a.i >= b.i;
+            else
+            {
+                ret.kind = Constant::Integer;
+                bool overflow = false;
+                if(op == L"+")
+                    overflow = addOverflow(a.i, b.i, ret.i);
+                else if(op == L"-")
+                    overflow = subOverflow(a.i, b.i, ret.i);
+                else if(op == L"*")
+                    overflow = mulOverflow(a.i, b.i, ret.i);
+                else if(op == L"/" || op == L"%")
+                {
+                    if(b.i == 0)
+                    {
+                        error(node, Errors::E_DIVISION_BY_ZERO);
+                        return false;
+                    }
+                    overflow = a.i == numeric_limits<int64_t>::min() && b.i == -1;
+                    if(!overflow)
+                        ret.i = op == L"/" ? a.i / b.i : a.i % b.i;
+                }
+                else if(op == L"&+")
+                    return truncate((uint64_t)a.i + (uint64_t)b.i, bits, isSigned, ret.i);
+                else if(op == L"&-")
+                    return truncate((uint64_t)a.i - (uint64_t)b.i, bits, isSigned, ret.i);
+                else if(op == L"&*")
+                    return truncate((uint64_t)a.i * (uint64_t)b.i, bits, isSigned, ret.i);
+                else if(op == L"&")
+                    ret.i = a.i & b.i;
+                else if(op == L"|")
+                    ret.i = a.i | b.i;
+                else if(op == L"^")
+                    ret.i = a.i ^ b.i;
+                else
+                    return false;
+                if(overflow)
+                {
+                    //unsigned 64-bit results beyond Int64 are valid but cannot be represented by the literal
+                    if(bits == 64 && !isSigned && op != L"-")
+                        return false;
+                    error(node, Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, expr, type->toString());
+                    return false;
+                }
+                return checkIntegerRange(node, expr, type, ret);
+            }
+            return true;
+        }
+        case Constant::Floating:
+        {
+            if(op == L"==") ret.b = a.d == b.d;
+            else if(op == L"!=") ret.b = a.d != b.d;
+            else if(op == L"<") ret.b = a.d < b.d;
+            else if(op == L"<=") ret.b = a.d <= b.d;
+            else if(op == L">") ret.b = a.d > b.d;
+            else if(op == L">=") ret.b = a.d >= b.d;
+            else
+            {
+                ret.kind = Constant::Floating;
+                if(op == L"+") ret.d = a.d + b.d;
+                else if(op == L"-") ret.d = a.d - b.d;
+                else if(op == L"*") ret.d = a.d * b.d;
+                else if(op == L"/") ret.d = a.d / b.d;
+                else if(op == L"%") ret.d = fmod(a.d, b.d);
+                else
+                    return false;
+                if(type == global->Float())
+                    ret.d = (float)ret.d;
+                //infinity and NaN have no literal form
+                return std::isfinite(ret.d);
+            }
+            return true;
+        }
+        case Constant::Boolean:
+            if(op == L"&&") ret.b = a.b && b.b;
+            else if(op == L"||") ret.b = a.b || b.b;
+            else if(op == L"==") ret.b = a.b == b.b;
+            else if(op == L"!=") ret.b = a.b != b.b;
+            else
+                return false;
+            return true;
+        case Constant::String:
+            if(op == L"==") ret.b = a.s == b.s;
+            else if(op == L"!=") ret.b = a.s != b.s;
+            else if(op == L"+")
+            {
+                ret.kind = Constant::String;
+                ret.s = a.s + b.s;
+            }
+            else
+                return false;
+            return true;
+    }
+    return false;
+}
+
+bool ConstantFolder::evaluateUnary(const UnaryOperatorPtr& node, Constant& ret)
+{
+    FunctionSymbolPtr func = getBuiltinOperator(node);
+    if(!func || func->getType()->getParameters().size() != 1)
+        return false;
+    Constant a;
+    if(!evaluate(node->getOperand(), a))
+        return false;
+    TypePtr type = func->getType()->getParameters()[0].type;
+    const wstring& op = node->getOperator();
+    if(node->getOperatorType() != OperatorType::PrefixUnary)
+        return false;
+    ret.kind = a.kind;
+    switch(a.kind)
+    {
+        case Constant::Integer:
+        {
+            int bits;
+            bool isSigned;
+            if(!getIntegerType(symbolRegistry->getGlobalScope(), type, bits, isSigned))
+                return false;
+            if(op == L"+")
+                ret.i = a.i;
+            else if(op == L"-")
+            {
+                if(a.i == numeric_limits<int64_t>::min())
+                {
+                    error(node, Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2, op + a.toString(), type->toString());
+                    return false;
+                }
+                ret.i = -a.i;
+            }
+            else if(op == L"~")
+                return truncate(~(uint64_t)a.i, bits, isSigned, ret.i);
+            else
+                return false;
+            return checkIntegerRange(node, op + a.toString(), type, ret);
+        }
+        case Constant::Floating:
+            if(op == L"+")
+                ret.d = a.d;
+            else if(op == L"-")
+                ret.d = -a.d;
+            else
+                return false;
+            return true;
+        case Constant::Boolean:
+            if(op != L"!")
+                return false;
+            ret.b = !a.b;
+            return true;
+        default:
+            return false;
+    }
+}
+
+ExpressionPtr ConstantFolder::createLiteral(const ExpressionPtr& node, const Constant& value)
+{
+    const SourceInfo& info = *node->getSourceInfo();
+    ExpressionPtr ret;
+    switch(value.kind)
+    {
+        case Constant::Integer:
+        {
+            IntegerLiteralPtr literal = nodeFactory.createInteger(info);
+            literal->value = value.i;
+            literal->dvalue = (double)value.i;
+            literal->isFloat = false;
+            literal->valueAsString = value.toString();
+            ret = literal;
+            break;
+        }
+        case Constant::Floating:
+        {
+            FloatLiteralPtr literal = nodeFactory.createFloat(info);
+            literal->value = value.d;
+            literal->valueAsString = value.toString();
+            ret = literal;
+            break;
+        }
+        case Constant::Boolean:
+        {
+            BooleanLiteralPtr literal = nodeFactory.createBooleanLiteral(info);
+            literal->setValue(value.b);
+            ret = literal;
+            break;
+        }
+        case Constant::String:
+        {
+            StringLiteralPtr literal = nodeFactory.createString(info);
+            literal->value = value.s;
+            ret = literal;
+            break;
+        }
+    }
+    ret->setType(node->getType());
+    return ret;
+}
+
+ExpressionPtr ConstantFolder::fold(const ExpressionPtr& expr)
+{
+    if(!expr)
+        return nullptr;
+    expr->accept(this);
+    Constant value;
+    switch(expr->getNodeType())
+    {
+        case NodeType::BinaryOperator:
+            if(evaluateBinary(static_pointer_cast<BinaryOperator>(expr), value))
+                return createLiteral(expr, value);
+            break;
+        case NodeType::UnaryOperator:
+            if(evaluateUnary(static_pointer_cast<UnaryOperator>(expr), value))
+                return createLiteral(expr, value);
+            break;
+        case NodeType::ParenthesizedExpression:
+        {
+            //a parenthesized literal is the literal itself
+            ParenthesizedExpressionPtr p = static_pointer_cast<ParenthesizedExpression>(expr);
+            if(p->numExpressions() == 1 && p->getName(0).empty() && evaluate(p->get(0), value))
+                return p->get(0);
+            break;
+        }
+        case NodeType::Identifier:
+        {
+            SymbolPtr sym = expr->getReferencedSymbol();
+            auto iter = sym ? constants.find(sym.get()) : constants.end();
+            if(iter != constants.end() && expr->getType() == iter->second->getType() && evaluate(iter->second, value))
+                return createLiteral(expr, value);
+            break;
+        }
+        default:
+            break;
+    }
+    return expr;
+}
+
+void ConstantFolder::visitProgram(const ProgramPtr& node)
+{
+    SymbolScope* oldScope = scope;
+    scope = static_pointer_cast<ScopedProgram>(node)->getScope();
+    for(int i = 0; i < node->numStatements(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
+    scope = oldScope;
+}
+
+void ConstantFolder::visitCodeBlock(const CodeBlockPtr& node)
+{
+    SymbolScope* oldScope = scope;
+    shared_ptr<ScopedCodeBlock> block = dynamic_pointer_cast<ScopedCodeBlock>(node);
+    scope = block ? block->getScope() : nullptr;
+    for(int i = 0; i < node->numStatements(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
+    scope = oldScope;
+}
+
+void ConstantFolder::visitClosure(const ClosurePtr& node)
+{
+    SymbolScope* oldScope = scope;
+    shared_ptr<ScopedClosure> closure = dynamic_pointer_cast<ScopedClosure>(node);
+    scope = closure ? closure->getScope() : nullptr;
+    for(int i = 0; i < node->numStatement(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
+    scope = oldScope;
+}
+
+void ConstantFolder::visitTypeDeclaration(const TypeDeclarationPtr& node)
+{
+    //let declared in type are properties, they're not recorded as constants
+    SymbolScope* oldScope = scope;
+    scope = nullptr;
+    for(const DeclarationPtr& decl : *node)
+    {
+        decl->accept(this);
+    }
+    scope = oldScope;
+}
+
+void ConstantFolder::visitClass(const ClassDefPtr& node)
+{
+    visitTypeDeclaration(node);
+}
+
+void ConstantFolder::visitStruct(const StructDefPtr& node)
+{
+    visitTypeDeclaration(node);
+}
+
+void ConstantFolder::visitEnum(const EnumDefPtr& node)
+{
+    visitTypeDeclaration(node);
+}
+
+void ConstantFolder::visitExtension(const ExtensionDefPtr& node)
+{
+    visitTypeDeclaration(node);
+}
+
+void ConstantFolder::visitProtocol(const ProtocolDefPtr& node)
+{
+    //ignore everything under protocol
+}
+
+void ConstantFolder::visitValueBindings(const ValueBindingsPtr& node)
+{
+    for(const ValueBindingPtr& binding : *node)
+    {
+        binding->setInitializer(transform<Expression>(binding->getInitializer()));
+        IdentifierPtr name = dynamic_pointer_cast<Identifier>(binding->getName());
+        Constant value;
+        if(!scope || !node->isReadOnly() || !name || !evaluate(binding->getInitializer(), value))
+            continue;
+        SymbolPlaceHolderPtr sym = dynamic_pointer_cast<SymbolPlaceHolder>(scope->lookup(name->getIdentifier()));
+        if(!sym || sym->hasFlags(SymbolFlagWritable))
+            continue;
+        if(sym->getRole() == SymbolPlaceHolder::R_LOCAL_VARIABLE || sym->getRole() == SymbolPlaceHolder::R_TOP_LEVEL_VARIABLE)
+            constants[sym.get()] = binding->getInitializer();
+    }
+}
+
+void ConstantFolder::visitComputedProperty(const ComputedPropertyPtr& node)
+{
+    node->setInitializer(transform<Expression>(node->getInitializer()));
+    if(node->getGetter())
+        node->getGetter()->accept(this);
+    if(node->getSetter())
+        node->getSetter()->accept(this);
+    if(node->getWillSet())
+        node->getWillSet()->accept(this);
+    if(node->getDidSet())
+        node->getDidSet()->accept(this);
+}
+
+void ConstantFolder::visitAssignment(const AssignmentPtr& node)
+{
+    node->setRHS(transform<Pattern>(node->getRHS()));
+}
+
+void ConstantFolder::visitBinaryOperator(const BinaryOperatorPtr& node)
+{
+    node->setLHS(transform<Pattern>(node->getLHS()));
+    node->setRHS(transform<Pattern>(node->getRHS()));
+}
+
+void ConstantFolder::visitUnaryOperator(const UnaryOperatorPtr& node)
+{
+    node->setOperand(transform<Expression>(node->getOperand()));
+}
+
+void ConstantFolder::visitConditionalOperator(const ConditionalOperatorPtr& node)
+{
+    node->setCondition(transform<Pattern>(node->getCondition()));
+    node->setTrueExpression(transform<Expression>(node->getTrueExpression()));
+    node->setFalseExpression(transform<Expression>(node->getFalseExpression()));
+}
+
+void ConstantFolder::visitTuple(const TuplePtr& node)
+{
+    for(int i = 0; i < node->numElements(); i++)
+        node->setElement(i, transform<Pattern>(node->getElement(i)));
+}
+
+void ConstantFolder::visitParenthesizedExpression(const ParenthesizedExpressionPtr& node)
+{
+    int i = 0;
+    for(auto& p : *node)
+    {
+        node->setExpression(i, transform<Expression>(p.expression));
+        node->setTransformedExpression(i, transform<Expression>(p.transformedExpression));
+        i++;
+    }
+}
+
+void ConstantFolder::visitArrayLiteral(const ArrayLiteralPtr& node)
+{
+    for(int i = 0; i < node->numElements(); i++)
+        node->setElement(i, transform<Expression>(node->getElement(i)));
+}
+
+void ConstantFolder::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
+{
+    int i = 0;
+    for(auto& el : *node)
+    {
+        node->setKey(i, transform<Expression>(el.first));
+        node->setValue(i, transform<Expression>(el.second));
+        i++;
+    }
+}
+
+void ConstantFolder::visitStringInterpolation(const StringInterpolationPtr& node)
+{
+    for(int i = 0; i < (int)node->numExpressions(); i++)
+        node->setExpression(i, transform<Expression>(node->getExpression(i)));
+}
+
+void ConstantFolder::visitReturn(const ReturnStatementPtr& node)
+{
+    node->setExpression(transform<Expression>(node->getExpression()));
+}
+
+void ConstantFolder::visitIf(const IfStatementPtr& node)
+{
+    node->setCondition(transform<Expression>(node->getCondition()));
+    node->getThen()->accept(this);
+    if(node->getElse())
+        node->getElse()->accept(this);
+}
+
+void ConstantFolder::visitWhileLoop(const WhileLoopPtr& node)
+{
+    node->setCondition(transform<Expression>(node->getCondition()));
+    node->getCodeBlock()->accept(this);
+}
+
+void ConstantFolder::visitDoLoop(const DoLoopPtr& node)
+{
+    node->getCodeBlock()->accept(this);
+    node->setCondition(transform<Expression>(node->getCondition()));
+}
+
+void ConstantFolder::visitForLoop(const ForLoopPtr& node)
+{
+    for(int i = 0; i < node->numInit(); i++)
+        node->setInit(i, transform<Expression>(node->getInit(i)));
+    if(node->getInitializer())
+        node->getInitializer()->accept(this);
+    node->setCondition(transform<Expression>(node->getCondition()));
+    node->setStep(transform<Expression>(node->getStep()));
+    node->getCodeBlock()->accept(this);
+}
+
+void ConstantFolder::visitSwitchCase(const SwitchCasePtr& node)
+{
+    node->setControlExpression(transform<Expression>(node->getControlExpression()));
+    for(const CaseStatementPtr& c : *node)
+    {
+        c->accept(this);
+    }
+    if(node->getDefaultCase())
+        node->getDefaultCase()->accept(this);
+}
@@ -0,0 +1,467 @@
+/* ControlFlowGraph.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "semantics/ControlFlowGraph.h"
+#include "ast/ast.h"
+#include "ast/FlatAST.h"
+#include <algorithm>
+#include <cassert>
+
+USE_SWALLOW_NS
+using namespace std;
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * Builds the blocks of a ControlFlowGraph by walking the statements of a function body in its flat AST.
+ * Elements are always appended to the current block, and a block becomes current only once,
+ * so the elements of each block are contiguous.
+ */
+class ControlFlowGraphBuilder
+{
+    /*!
+     * Where break/continue jumps to, continue is invalid for switch
+     */
+    struct Target
+    {
+        wstring label;
+        uint32_t breakTarget;
+        uint32_t continueTarget;
+    };
+public:
+    ControlFlowGraphBuilder(ControlFlowGraph* cfg, const FlatAST& ast)
+    :cfg(cfg), ast(ast), current(ControlFlowGraph::Entry), fallthroughTarget(ControlFlowGraph::InvalidBlock)
+    {
+    }
+public:
+    void build(uint32_t body);
+private:
+    void visitStatement(uint32_t st);
+    void visitCodeBlock(uint32_t node);
+    void visitIf(uint32_t node);
+    void visitSwitchCase(uint32_t node);
+    void visitWhileLoop(uint32_t node);
+    void visitDoLoop(uint32_t node);
+    void visitForLoop(uint32_t node);
+    void visitForIn(uint32_t node);
+    uint32_t newBlock();
+    void setCurrent(uint32_t block);
+    void add(uint32_t element);
+    void addEdge(uint32_t from, uint32_t to);
+    /*!
+     * Ends current block with an edge to given block, the following statements are unreachable
+     * and no block is current until one of them is added
+     */
+    void jump(uint32_t to);
+    uint32_t findTarget(const wstring& label, bool isContinue) const;
+    void finish();
+private:
+    ControlFlowGraph* cfg;
+    const FlatAST& ast;
+    uint32_t current;
+    uint32_t fallthroughTarget;
+    wstring pendingLabel;
+    vector<Target> targets;
+    vector<pair<uint32_t, uint32_t> > edges;
+    vector<bool> reached;
+};
+
+SWALLOW_NS_END
+
+void ControlFlowGraphBuilder::build(uint32_t body)
+{
+    newBlock();
+    newBlock();
+    reached[ControlFlowGraph::Entry] = true;
+    setCurrent(ControlFlowGraph::Entry);
+    if(body < ast.size())
+        visitCodeBlock(body);
+    addEdge(current, ControlFlowGraph::Exit);
+    finish();
+}
+
+uint32_t ControlFlowGraphBuilder::newBlock()
+{
+    ControlFlowGraph::Block block = {0, 0, 0, 0, 0, 0};
+    cfg->blocks.push_back(block);
+    reached.push_back(false);
+    return cfg->blocks.size() - 1;
+}
+
+void ControlFlowGraphBuilder::setCurrent(uint32_t block)
+{
+    assert(cfg->blocks[block].numElements == 0);
+    cfg->blocks[block].firstElement = cfg->elements.size();
+    current = block;
+}
+
+void ControlFlowGraphBuilder::add(uint32_t element)
+{
+    if(element == FlatAST::InvalidIndex)
+        return;
+    //statements after a jump are unreachable, they start a new block
+    if(current == ControlFlowGraph::InvalidBlock)
+        setCurrent(newBlock());
+    cfg->elements.push_back(ast.getNode(element));
+    cfg->blocks[current].numElements++;
+}
+
+void ControlFlowGraphBuilder::addEdge(uint32_t from, uint32_t to)
+{
+    //nothing follows a jump, and an empty block that nothing jumps to doesn't flow anywhere
+    if(from == ControlFlowGraph::InvalidBlock || (!reached[from] && cfg->blocks[from].numElements == 0))
+        return;
+    edges.push_back(make_pair(from, to));
+    reached[to] = true;
+}
+
+void ControlFlowGraphBuilder::jump(uint32_t to)
+{
+    if(to != ControlFlowGraph::InvalidBlock)
+        addEdge(current, to);
+    current = ControlFlowGraph::InvalidBlock;
+}
+
+uint32_t ControlFlowGraphBuilder::findTarget(const wstring& label, bool isContinue) const
+{
+    for(auto iter = targets.rbegin(); iter != targets.rend(); iter++)
+    {
+        if(isContinue && iter->continueTarget == ControlFlowGraph::InvalidBlock)
+            continue;
+        if(label.empty() || label == iter->label)
+            return isContinue ? iter->continueTarget : iter->breakTarget;
+    }
+    return ControlFlowGraph::InvalidBlock;
+}
+
+void ControlFlowGraphBuilder::visitStatement(uint32_t st)
+{
+    switch(ast.getKind(st))
+    {
+        case NodeType::If:
+            visitIf(st);
+            break;
+        case NodeType::SwitchCase:
+            visitSwitchCase(st);
+            break;
+        case NodeType::While:
+            visitWhileLoop(st);
+            break;
+        case NodeType::Do:
+            visitDoLoop(st);
+            break;
+        case NodeType::For:
+            visitForLoop(st);
+            break;
+        case NodeType::ForIn:
+            visitForIn(st);
+            break;
+        case NodeType::CodeBlock:
+            visitCodeBlock(st);
+            break;
+        case NodeType::LabeledStatement:
+            pendingLabel = ast.getName(st);
+            if(ast.numChildren(st) > 0)
+                visitStatement(ast.getChild(st, 0));
+            pendingLabel.clear();
+            break;
+        case NodeType::Break:
+            add(st);
+            jump(findTarget(ast.getName(st), false));
+            break;
+        case NodeType::Continue:
+            add(st);
+            jump(findTarget(ast.getName(st), true));
+            break;
+        case NodeType::Fallthrough:
+            add(st);
+            jump(fallthroughTarget);
+            break;
+        case NodeType::Return:
+            add(st);
+            jump(ControlFlowGraph::Exit);
+            break;
+        default:
+            add(st);
+            break;
+    }
+}
+
+void ControlFlowGraphBuilder::visitCodeBlock(uint32_t node)
+{
+    for(uint32_t i = 0; i < ast.numChildren(node); i++)
+    {
+        visitStatement(ast.getChild(node, i));
+    }
+}
+
+void ControlFlowGraphBuilder::visitIf(uint32_t node)
+{
+    add(ast.findChild(node, FlatAST::RoleCondition));
+    uint32_t elsePart = ast.findChild(node, FlatAST::RoleElse);
+    uint32_t head = current;
+    uint32_t thenBlock = newBlock();
+    uint32_t elseBlock = elsePart != FlatAST::InvalidIndex ? newBlock() : ControlFlowGraph::InvalidBlock;
+    uint32_t after = newBlock();
+
+    addEdge(head, thenBlock);
+    setCurrent(thenBlock);
+    visitCodeBlock(ast.findChild(node, FlatAST::RoleThen));
+    addEdge(current, after);
+
+    if(elsePart != FlatAST::InvalidIndex)
+    {
+        addEdge(head, elseBlock);
+        setCurrent(elseBlock);
+        visitStatement(elsePart);
+        addEdge(current, after);
+    }
+    else
+    {
+        addEdge(head, after);
+    }
+    setCurrent(after);
+}
+
+void ControlFlowGraphBuilder::visitSwitchCase(uint32_t node)
+{
+    wstring label;
+    label.swap(pendingLabel);
+    //the patterns and guards are all evaluated before entering a case, the default case is the last one
+    vector<uint32_t> cases;
+    bool hasDefault = false;
+    for(uint32_t i = 0; i < ast.numChildren(node); i++)
+    {
+        uint32_t child = ast.getChild(node, i);
+        FlatAST::Role role = ast.getRole(child);
+        if(role == FlatAST::RoleCondition)
+            add(child);
+        else if(role == FlatAST::RoleCase || role == FlatAST::RoleDefaultCase)
+        {
+            cases.push_back(child);
+            hasDefault = hasDefault || role == FlatAST::RoleDefaultCase;
+        }
+    }
+    for(uint32_t c : cases)
+    {
+        for(uint32_t i = 0; i < ast.numChildren(c); i++)
+        {
+            uint32_t child = ast.getChild(c, i);
+            if(ast.getRole(child) != FlatAST::RoleBody)
+                add(child);
+        }
+    }
+    uint32_t head = current;
+    vector<uint32_t> entries;
+    for(size_t i = 0; i < cases.size(); i++)
+        entries.push_back(newBlock());
+    uint32_t after = newBlock();
+    for(uint32_t entry : entries)
+        addEdge(head, entry);
+    if(!hasDefault)
+        addEdge(head, after);
+
+    Target target = {label, after, ControlFlowGraph::InvalidBlock};
+    targets.push_back(target);
+    for(size_t i = 0; i < cases.size(); i++)
+    {
+        fallthroughTarget = i + 1 < entries.size() ? entries[i + 1] : after;
+        setCurrent(entries[i]);
+        uint32_t body = ast.findChild(cases[i], FlatAST::RoleBody);
+        if(body != FlatAST::InvalidIndex)
+            visitCodeBlock(body);
+        addEdge(current, after);
+    }
+    targets.pop_back();
+    fallthroughTarget = ControlFlowGraph::InvalidBlock;
+    setCurrent(after);
+}
+
+void ControlFlowGraphBuilder::visitWhileLoop(uint32_t node)
+{
+    wstring label;
+    label.swap(pendingLabel);
+    uint32_t header = newBlock();
+    uint32_t body = newBlock();
+    uint32_t after = newBlock();
+    addEdge(current, header);
+    setCurrent(header);
+    add(ast.findChild(node, FlatAST::RoleCondition));
+    addEdge(header, body);
+    addEdge(header, after);
+
+    Target target = {label, after, header};
+    targets.push_back(target);
+    setCurrent(body);
+    visitCodeBlock(ast.findChild(node, FlatAST::RoleBody));
+    addEdge(current, header);
+    targets.pop_back();
+    setCurrent(after);
+}
+
+void ControlFlowGraphBuilder::visitDoLoop(uint32_t node)
+{
+    wstring label;
+    label.swap(pendingLabel);
+    uint32_t body = newBlock();
+    uint32_t condition = newBlock();
+    uint32_t after = newBlock();
+    addEdge(current, body);
+
+    Target target = {label, after, condition};
+    targets.push_back(target);
+    setCurrent(body);
+    visitCodeBlock(ast.findChild(node, FlatAST::RoleBody));
+    addEdge(current, condition);
+    targets.pop_back();
+
+    setCurrent(condition);
+    add(ast.findChild(node, FlatAST::RoleCondition));
+    addEdge(condition, body);
+    addEdge(condition, after);
+    setCurrent(after);
+}
+
+void ControlFlowGraphBuilder::visitForLoop(uint32_t node)
+{
+    wstring label;
+    label.swap(pendingLabel);
+    for(uint32_t i = 0; i < ast.numChildren(node); i++)
+    {
+        uint32_t child = ast.getChild(node, i);
+        if(ast.getRole(child) == FlatAST::RoleInit)
+            add(child);
+    }
+    uint32_t condition = ast.findChild(node, FlatAST::RoleCondition);
+    uint32_t header = newBlock();
+    uint32_t body = newBlock();
+    uint32_t step = newBlock();
+    uint32_t after = newBlock();
+    addEdge(current, header);
+    setCurrent(header);
+    add(condition);
+    addEdge(header, body);
+    //for(;;) only leaves by break/return
+    if(condition != FlatAST::InvalidIndex)
+        addEdge(header, after);
+
+    Target target = {label, after, step};
+    targets.push_back(target);
+    setCurrent(body);
+    visitCodeBlock(ast.findChild(node, FlatAST::RoleBody));
+    addEdge(current, step);
+    targets.pop_back();
+
+    setCurrent(step);
+    add(ast.findChild(node, FlatAST::RoleStep));
+    addEdge(step, header);
+    setCurrent(after);
+}
+
+void ControlFlowGraphBuilder::visitForIn(uint32_t node)
+{
+    wstring label;
+    label.swap(pendingLabel);
+    add(ast.findChild(node, FlatAST::RoleContainer));
+    uint32_t header = newBlock();
+    uint32_t body = newBlock();
+    uint32_t after = newBlock();
+    addEdge(current, header);
+    setCurrent(header);
+    //loop variables are bound to the next element of the sequence in each iteration
+    add(ast.findChild(node, FlatAST::RoleLoopVariables));
+    addEdge(header, body);
+    addEdge(header, after);
+
+    Target target = {label, after, header};
+    targets.push_back(target);
+    setCurrent(body);
+    visitCodeBlock(ast.findChild(node, FlatAST::RoleBody));
+    addEdge(current, header);
+    targets.pop_back();
+    setCurrent(after);
+}
+
+/*!
+ * Lays out the collected edges into the successor and predecessor arrays
+ */
+void ControlFlowGraphBuilder::finish()
+{
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    vector<ControlFlowGraph::Block>& blocks = cfg->blocks;
+    for(const pair<uint32_t, uint32_t>& edge : edges)
+    {
+        blocks[edge.first].numSuccessors++;
+        blocks[edge.second].numPredecessors++;
+    }
+    uint32_t numSuccessors = 0, numPredecessors = 0;
+    for(ControlFlowGraph::Block& block : blocks)
+    {
+        block.firstSuccessor = numSuccessors;
+        block.firstPredecessor = numPredecessors;
+        numSuccessors += block.numSuccessors;
+        numPredecessors += block.numPredecessors;
+        block.numPredecessors = 0;
+    }
+    cfg->successors.resize(edges.size());
+    cfg->predecessors.resize(edges.size());
+    for(size_t i = 0; i < edges.size(); i++)
+    {
+        //edges are sorted by source block, so the successors are already in place
+        cfg->successors[i] = edges[i].second;
+        ControlFlowGraph::Block& to = blocks[edges[i].second];
+        cfg->predecessors[to.firstPredecessor + to.numPredecessors++] = edges[i].first;
+    }
+}
+
+ControlFlowGraph::ControlFlowGraph(const FlatAST& ast, uint32_t body)
+{
+    ControlFlowGraphBuilder builder(this, ast);
+    builder.build(body);
+}
+
+ControlFlowGraph::ControlFlowGraph(const CodeBlockPtr& body)
+:ControlFlowGraph(FlatAST(body), 0)
+{
+}
+
+uint32_t ControlFlowGraph::findBlock(const Node* element) const
+{
+    for(uint32_t b = 0; b < blocks.size(); b++)
+    {
+        const Block& block = blocks[b];
+        for(uint32_t e = block.firstElement; e < block.firstElement + block.numElements; e++)
+        {
+            if(elements[e] == element)
+                return b;
+        }
+    }
+    return InvalidBlock;
+}
@@ -0,0 +1,347 @@
+/* DataFlowAnalysis.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "semantics/DataFlowAnalysis.h"
+#include "semantics/ControlFlowGraph.h"
+#include "ast/ast.h"
+#include "ast/NodeVisitor.h"
+#include "common/ScopedValue.h"
+#include <deque>
+
+USE_SWALLOW_NS
+using namespace std;
+
+SWALLOW_NS_BEGIN
+
+/*!
+ * Collects the accesses of local variables in an element, the elements are visited twice,
+ * the first time declares the variables bound in the body, and the second time records the accesses.
+ */
+class VariableAccessCollector : public NodeVisitor
+{
+public:
+    VariableAccessCollector(LocalVariables* variables)
+    :variables(variables), declaring(true), capturing(false)
+    {
+    }
+public:
+    void collect(Node* element);
+public:
+    virtual void visitValueBinding(const ValueBindingPtr& node) override;
+    virtual void visitAssignment(const AssignmentPtr& node) override;
+    virtual void visitIdentifier(const IdentifierPtr& node) override;
+    virtual void visitClosure(const ClosurePtr& node) override;
+    virtual void visitFunction(const FunctionDefPtr& node) override;
+    virtual void visitClass(const ClassDefPtr& node) override {}
+    virtual void visitStruct(const StructDefPtr& node) override {}
+    virtual void visitEnum(const EnumDefPtr& node) override {}
+    virtual void visitProtocol(const ProtocolDefPtr& node) override {}
+    virtual void visitExtension(const ExtensionDefPtr& node) override {}
+private:
+    /*!
+     * Names in the pattern are bound by let/var/if-let/for-in
+     */
+    void bind(const PatternPtr& pattern, bool initialized);
+    /*!
+     * Names in the pattern are the left hand side of an assignment
+     */
+    void assign(const PatternPtr& pattern);
+    void access(const wstring& name, bool write);
+public:
+    LocalVariables* variables;
+    bool declaring;
+    bool capturing;
+};
+
+SWALLOW_NS_END
+
+void VariableAccessCollector::collect(Node* element)
+{
+    NodePtr parent = element->getParentNode();
+    if(parent && parent->getNodeType() == NodeType::ForIn && static_pointer_cast<ForInLoop>(parent)->getLoopVars().get() == element)
+    {
+        bind(static_pointer_cast<Pattern>(element->shared_from_this()), true);
+        return;
+    }
+    element->accept(this);
+}
+
+void VariableAccessCollector::bind(const PatternPtr& pattern, bool initialized)
+{
+    switch(pattern->getNodeType())
+    {
+        case NodeType::Identifier:
+        {
+            const wstring& name = static_pointer_cast<Identifier>(pattern)->getIdentifier();
+            if(declaring)
+            {
+                if(!capturing && variables->indices.find(name) == variables->indices.end())
+                {
+                    variables->indices[name] = variables->names.size();
+                    variables->names.push_back(name);
+                }
+            }
+            else if(initialized)
+            {
+                access(name, true);
+            }
+            break;
+        }
+        case NodeType::Tuple:
+            for(const PatternPtr& p : *static_pointer_cast<Tuple>(pattern))
+                bind(p, initialized);
+            break;
+        case NodeType::TypedPattern:
+            bind(static_pointer_cast<TypedPattern>(pattern)->getPattern(), initialized);
+            break;
+        case NodeType::ValueBindingPattern:
+            bind(static_pointer_cast<ValueBindingPattern>(pattern)->getBinding(), initialized);
+            break;
+        default:
+            pattern->accept(this);
+            break;
+    }
+}
+
+void VariableAccessCollector::assign(const PatternPtr& pattern)
+{
+    switch(pattern->getNodeType())
+    {
+        case NodeType::Identifier:
+            if(!declaring)
+                access(static_pointer_cast<Identifier>(pattern)->getIdentifier(), true);
+            break;
+        case NodeType::Tuple:
+            for(const PatternPtr& p : *static_pointer_cast<Tuple>(pattern))
+                assign(p);
+            break;
+        case NodeType::TypedPattern:
+            assign(static_pointer_cast<TypedPattern>(pattern)->getPattern());
+            break;
+        default:
+            //member or subscript of a variable reads the variable
+            pattern->accept(this);
+            break;
+    }
+}
+
+void VariableAccessCollector::access(const wstring& name, bool write)
+{
+    //a closure may run at any time, so writes inside it are not assignments of the enclosing function
+    if(write && capturing)
+        return;
+    auto iter = variables->indices.find(name);
+    if(iter == variables->indices.end())
+        return;
+    LocalVariables::Access a = {iter->second, write};
+    variables->accesses.push_back(a);
+}
+
+void VariableAccessCollector::visitValueBinding(const ValueBindingPtr& node)
+{
+    if(node->getInitializer())
+        node->getInitializer()->accept(this);
+    bind(node->getName(), node->getInitializer() != nullptr);
+}
+
+void VariableAccessCollector::visitAssignment(const AssignmentPtr& node)
+{
+    node->getRHS()->accept(this);
+    if(node->getLHS()->getNodeType() == NodeType::ValueBindingPattern)
+        bind(node->getLHS(), true);
+    else
+        assign(node->getLHS());
+}
+
+void VariableAccessCollector::visitIdentifier(const IdentifierPtr& node)
+{
+    if(!declaring)
+        access(node->getIdentifier(), false);
+}
+
+void VariableAccessCollector::visitClosure(const ClosurePtr& node)
+{
+    SCOPED_SET(capturing, true);
+    NodeVisitor::visitClosure(node);
+}
+
+void VariableAccessCollector::visitFunction(const FunctionDefPtr& node)
+{
+    SCOPED_SET(capturing, true);
+    NodeVisitor::visitFunction(node);
+}
+
+LocalVariables::LocalVariables(const ControlFlowGraph& cfg)
+{
+    VariableAccessCollector collector(this);
+    for(uint32_t e = 0; e < cfg.numElements(); e++)
+        collector.collect(cfg.getElement(e));
+    collector.declaring = false;
+    offsets.reserve(cfg.numElements() + 1);
+    offsets.push_back(0);
+    for(uint32_t e = 0; e < cfg.numElements(); e++)
+    {
+        collector.collect(cfg.getElement(e));
+        offsets.push_back(accesses.size());
+    }
+}
+
+int LocalVariables::indexOf(const std::wstring& name) const
+{
+    auto iter = indices.find(name);
+    if(iter == indices.end())
+        return -1;
+    return iter->second;
+}
+
+DataFlowAnalysis::DataFlowAnalysis(const ControlFlowGraph& cfg, Direction direction, Meet meet, size_t numBits)
+:cfg(&cfg), direction(direction), meet(meet), boundary(numBits), iterations(0)
+{
+    gens.resize(cfg.numBlocks(), BitVector(numBits));
+    kills.resize(cfg.numBlocks(), BitVector(numBits));
+}
+
+void DataFlowAnalysis::solve()
+{
+    uint32_t numBlocks = cfg->numBlocks();
+    BitVector identity(boundary.size(), meet == Intersection);
+    ins.assign(numBlocks, identity);
+    outs.assign(numBlocks, identity);
+    iterations = 0;
+    bool forward = direction == Forward;
+    uint32_t start = forward ? (uint32_t)ControlFlowGraph::Entry : (uint32_t)ControlFlowGraph::Exit;
+    //visit blocks in the order they're created for forward problems, which is close to the control flow
+    deque<uint32_t> worklist;
+    vector<bool> queued(numBlocks, true);
+    for(uint32_t i = 0; i < numBlocks; i++)
+        worklist.push_back(forward ? i : numBlocks - 1 - i);
+    while(!worklist.empty())
+    {
+        uint32_t b = worklist.front();
+        worklist.pop_front();
+        queued[b] = false;
+        iterations++;
+        const ControlFlowGraph::Block& block = cfg->getBlock(b);
+        //meet the values flowing into this block
+        BitVector& input = forward ? ins[b] : outs[b];
+        if(b == start)
+        {
+            input = boundary;
+        }
+        else
+        {
+            input = identity;
+            uint32_t numEdges = forward ? block.numPredecessors : block.numSuccessors;
+            for(uint32_t i = 0; i < numEdges; i++)
+            {
+                uint32_t from = forward ? cfg->getPredecessor(b, i) : cfg->getSuccessor(b, i);
+                const BitVector& value = forward ? outs[from] : ins[from];
+                if(meet == Union)
+                    input.unite(value);
+                else
+                    input.intersect(value);
+            }
+        }
+        BitVector output = input;
+        output.subtract(kills[b]);
+        output.unite(gens[b]);
+        BitVector& result = forward ? outs[b] : ins[b];
+        if(output == result)
+            continue;
+        result = output;
+        uint32_t numEdges = forward ? block.numSuccessors : block.numPredecessors;
+        for(uint32_t i = 0; i < numEdges; i++)
+        {
+            uint32_t to = forward ? cfg->getSuccessor(b, i) : cfg->getPredecessor(b, i);
+            if(!queued[to])
+            {
+                queued[to] = true;
+                worklist.push_back(to);
+            }
+        }
+    }
+}
+
+DataFlowAnalysis DataFlowAnalysis::reachability(const ControlFlowGraph& cfg)
+{
+    DataFlowAnalysis ret(cfg, Forward, Union, 1);
+    ret.gen(ControlFlowGraph::Entry).set(0);
+    ret.solve();
+    return ret;
+}
+
+DataFlowAnalysis DataFlowAnalysis::liveness(const ControlFlowGraph& cfg, const LocalVariables& variables)
+{
+    DataFlowAnalysis ret(cfg, Backward, Union, variables.size());
+    for(uint32_t b = 0; b < cfg.numBlocks(); b++)
+    {
+        const ControlFlowGraph::Block& block = cfg.getBlock(b);
+        BitVector& gen = ret.gen(b);
+        BitVector& kill = ret.kill(b);
+        //walk backward, a read is exposed to the block's entry unless a prior write in the block kills it
+        for(uint32_t e = block.firstElement + block.numElements; e-- > block.firstElement; )
+        {
+            for(uint32_t i = variables.numAccesses(e); i-- > 0; )
+            {
+                const LocalVariables::Access& access = variables.getAccess(e, i);
+                if(access.write)
+                {
+                    gen.reset(access.variable);
+                    kill.set(access.variable);
+                }
+                else
+                {
+                    gen.set(access.variable);
+                }
+            }
+        }
+    }
+    ret.solve();
+    return ret;
+}
+
+DataFlowAnalysis DataFlowAnalysis::definiteAssignment(const ControlFlowGraph& cfg, const LocalVariables& variables)
+{
+    DataFlowAnalysis ret(cfg, Forward, Intersection, variables.size());
+    for(uint32_t b = 0; b < cfg.numBlocks(); b++)
+    {
+        const ControlFlowGraph::Block& block = cfg.getBlock(b);
+        for(uint32_t e = block.firstElement; e < block.firstElement + block.numElements; e++)
+        {
+            for(uint32_t i = 0; i < variables.numAccesses(e); i++)
+            {
+                const LocalVariables::Access& access = variables.getAccess(e, i);
+                if(access.write)
+                    ret.gen(b).set(access.variable);
+            }
+        }
+    }
+    ret.solve();
+    return ret;
+}
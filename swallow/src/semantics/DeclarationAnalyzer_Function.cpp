@@ -43,9 +43,10 @@
 #include "semantics/ScopedNodes.h"
 #include "common/ScopedValue.h"
 #include "semantics/SemanticContext.h"
-#include "semantics/ReturnStatementValidator.h"
-#include "semantics/InitializerValidator.h"
+#include "semantics/FlowTracer.h"
 #include "semantics/InitializationTracer.h"
+#include "common/CompilerStats.h"
+#include "common/CompilerTrace.h"
 #include <set>
 #include <cassert>
 #include <ast/NodeFactory.h>
@@ -220,9 +221,14 @@ void DeclarationAnalyzer::visitClosure(const ClosurePtr& node)
     }
 
     SCOPED_SET(ctx->currentFunction, node->getType());
+    SCOPED_SET(ctx->currentFlowTracer, nullptr);
 
+    PhaseTimer timer(CompilerPhase::BodyAnalysis);
+    TraceEvent event(TraceCategory::FunctionBody, getTraceLine(node), [&]{ return wstring(L"closure");});
     for(const StatementPtr& st : *node)
     {
+        ExpressionCost cost;
+        SCOPED_SET(ctx->expressionCost, &cost);
         st->accept(semanticAnalyzer);
     }
 
@@ -581,6 +587,7 @@ void DeclarationAnalyzer::visitAccessor(const CodeBlockPtr& accessor, const Para
     prepareParameters(scope, params);
 
     SCOPED_SET(ctx->currentFunction, accessor->getType());
+    SCOPED_SET(ctx->currentFlowTracer, nullptr);
 
     accessor->accept(semanticAnalyzer);
 }
@@ -983,6 +990,17 @@ void DeclarationAnalyzer::checkForFunctionOverriding(const std::wstring& name, c
     }
 }
 
+/*!
+ * Name of a function body shown in the compiler trace, methods are prefixed by their type
+ */
+static wstring getTraceName(const NodePtr& node, const wstring& name)
+{
+    TypeDeclarationPtr owner = dynamic_pointer_cast<TypeDeclaration>(node->getParentNode());
+    if(!owner)
+        return name;
+    return owner->getIdentifier()->getName() + L"." + name;
+}
+
 void DeclarationAnalyzer::visitFunction(const FunctionDefPtr& node)
 {
     if(ctx->flags & SemanticContext::FLAG_PROCESS_DECLARATION)
@@ -995,15 +1013,18 @@ void DeclarationAnalyzer::visitFunction(const FunctionDefPtr& node)
         FunctionSymbolPtr func = static_pointer_cast<SymboledFunction>(node)->symbol;
         assert(func != nullptr);
         SCOPED_SET(ctx->currentFunction, func->getType());
-        node->getBody()->accept(semanticAnalyzer);
+        FlowTracer flow(nullptr, FlowTracer::Sequence);
+        {
+            TraceEvent event(TraceCategory::FunctionBody, getTraceLine(node), [&]{ return getTraceName(node, node->getName());});
+            SCOPED_SET(ctx->currentFlowTracer, &flow);
+            node->getBody()->accept(semanticAnalyzer);
+        }
 
         if(!Type::equals(func->getType()->getReturnType(), symbolRegistry->getGlobalScope()->Void()))
         {
             //check return in all branches
-            ReturnStatementValidator validator(ctx);
-            node->getBody()->accept(&validator);
-            NodePtr refNode = validator.getRefNode() ? validator.getRefNode() : node;
-            ReturnCoverResult  result = validator.getResult();
+            NodePtr refNode = flow.returnRefNode ? flow.returnRefNode : node;
+            ReturnCoverResult  result = flow.returns;
             if (result & ReturnCoverDeadcode)
             {
                 this->warning(refNode, Errors::W_CODE_AFTER_A_WILL_NEVER_BE_EXECUTED_1, L"return");
@@ -1041,6 +1062,7 @@ void DeclarationAnalyzer::visitDeinit(const DeinitializerDefPtr& node)
     {
         TypePtr funcType = ctx->currentType->getDeinit()->getType();
         SCOPED_SET(ctx->currentFunction, funcType);
+        SCOPED_SET(ctx->currentFlowTracer, nullptr);
         node->getBody()->accept(this);
     }
 }
@@ -1112,9 +1134,12 @@ void DeclarationAnalyzer::visitInit(const InitializerDefPtr& node)
         FunctionSymbolPtr init = static_pointer_cast<SymboledInit>(node)->symbol;
         TypePtr funcType = init->getType();
         SCOPED_SET(ctx->currentFunction, funcType);
+        FlowTracer flow(nullptr, FlowTracer::Sequence);
         {
+            TraceEvent event(TraceCategory::FunctionBody, getTraceLine(node), [&]{ return getTraceName(node, L"init");});
             InitializationTracer tracer(nullptr, InitializationTracer::Sequence);
             SCOPED_SET(ctx->currentInitializationTracer, &tracer);
+            SCOPED_SET(ctx->currentFlowTracer, &flow);
             node->getBody()->accept(semanticAnalyzer);
             //check if some stored property is not initialized
             for(const SymbolPtr& storedProp : ctx->currentType->getDeclaredStoredProperties())
@@ -1130,15 +1155,13 @@ void DeclarationAnalyzer::visitInit(const InitializerDefPtr& node)
         if(node->hasModifier(DeclarationModifiers::Convenience))
         {
             //convenience initializer must call designated initializer in all paths
-            InitializerValidator validator(ctx, this);
-            node->getBody()->accept(&validator);
-            NodePtr refNode = validator.getRefNode() ? validator.getRefNode() : node;
-            if(validator.getResult() & InitializerCoverMultiple)
+            NodePtr refNode = flow.initializerRefNode ? flow.initializerRefNode : node;
+            if(flow.initializers & InitializerCoverMultiple)
             {
                 error(refNode, Errors::E_SELF_INIT_CALLED_MULTIPLE_TIMES_IN_INITIALIZER);
                 return;
             }
-            switch(validator.getResult())
+            switch(flow.initializers)
             {
                 case InitializerCoverNoResult:
                 case InitializerCoverUnmatched:
@@ -1171,15 +1194,13 @@ void DeclarationAnalyzer::visitInit(const InitializerDefPtr& node)
             }
             if(hasCustomizedInitializer)
             {
-                InitializerValidator validator(ctx, this);
-                node->getBody()->accept(&validator);
-                NodePtr refNode = validator.getRefNode() ? validator.getRefNode() : node;
-                if(validator.getResult() & InitializerCoverMultiple)
+                NodePtr refNode = flow.initializerRefNode ? flow.initializerRefNode : node;
+                if(flow.initializers & InitializerCoverMultiple)
                 {
                     error(refNode, Errors::E_SUPER_INIT_CALLED_MULTIPLE_TIMES_IN_INITIALIZER);
                     return;
                 }
-                switch(validator.getResult())
+                switch(flow.initializers)
                 {
                     case InitializerCoverNoResult:
                     case InitializerCoverUnmatched:
@@ -1198,12 +1219,11 @@ void DeclarationAnalyzer::visitInit(const InitializerDefPtr& node)
 void DeclarationAnalyzer::visitCodeBlock(const CodeBlockPtr &node)
 {
     SCOPED_SET(ctx->flags, ctx->flags | SemanticContext::FLAG_PROCESS_IMPLEMENTATION | SemanticContext::FLAG_PROCESS_DECLARATION);
-    auto iter = node->begin();
-    for(; iter != node->end(); iter++)
+    for(int i = 0; i < node->numStatements(); i++)
     {
-        StatementPtr st = *iter;
+        StatementPtr st = node->getStatement(i);
         if(BinaryOperatorPtr op = dynamic_pointer_cast<BinaryOperator>(st))
-            *iter = semanticAnalyzer->transformExpression(nullptr, op);
+            node->setStatement(i, semanticAnalyzer->transformExpression(nullptr, op));
         st->accept(semanticAnalyzer);
     }
 }
@@ -278,6 +278,7 @@ void DeclarationAnalyzer::prepareDefaultInitializers(const TypePtr& type)
             std::vector<Parameter> params;
             TypePtr initType = Type::newFunction(params, global->Void(), false);
             initType->setFlags(SymbolFlagInit, true);
+            static_pointer_cast<TypeBuilder>(initType)->setDeclaringType(type);
             FunctionSymbolPtr initializer(new FunctionSymbol(L"init", initType, FunctionRoleInit, nullptr));
             declarationFinished(initializer->getName(), initializer, nullptr);
             initCreated = true;
@@ -286,6 +287,7 @@ void DeclarationAnalyzer::prepareDefaultInitializers(const TypePtr& type)
         {
             TypePtr initType = Type::newFunction(initParams, global->Void(), false);
             initType->setFlags(SymbolFlagInit, true);
+            static_pointer_cast<TypeBuilder>(initType)->setDeclaringType(type);
             FunctionSymbolPtr initializer(new FunctionSymbol(L"init", initType, FunctionRoleInit, nullptr));
             declarationFinished(initializer->getName(), initializer, nullptr);
             initCreated = true;
@@ -295,7 +295,10 @@ void DeclarationAnalyzer::visitValueBindings(const ValueBindingsPtr& node)
         flags |= SymbolFlagLazy;
 
     SymbolPlaceHolder::Role role = SymbolPlaceHolder::R_LOCAL_VARIABLE;
-    if(!ctx->currentFunction)
+    //a type can be declared lazily while a function body is being analyzed, its variables are still properties
+    if(flags & SymbolFlagMember)
+        role = SymbolPlaceHolder::R_PROPERTY;
+    else if(!ctx->currentFunction)
     {
         if (ctx->currentType)
             role = SymbolPlaceHolder::R_PROPERTY;
@@ -30,12 +30,16 @@
 #include "semantics/FunctionSymbol.h"
 #include "semantics/Type.h"
 #include <cassert>
+#include <mutex>
 
 USE_SWALLOW_NS
+using namespace std;
+
+static mutex specializationLock;
 
 
 FunctionSymbol::FunctionSymbol(const std::wstring& name, const TypePtr& signature, FunctionRole role, const CodeBlockPtr& definition)
-:name(name), type(signature), role(role), definition(definition)
+:name(name), type(signature), role(role), definition(definition), specializationSweepSize(16)
 {
     assert(signature);
     assert(signature->getCategory() == Type::Function);
@@ -57,3 +61,38 @@ CodeBlockPtr FunctionSymbol::getDefinition()
 {
     return definition.lock();
 }
+
+void FunctionSymbol::sweepSpecializations()
+{
+    if(specializations.size() < specializationSweepSize)
+        return;
+    for(auto iter = specializations.begin(); iter != specializations.end();)
+    {
+        if(iter->second.expired())
+            iter = specializations.erase(iter);
+        else
+            ++iter;
+    }
+    specializationSweepSize = max((size_t)16, specializations.size() * 2);
+}
+
+FunctionSymbolPtr FunctionSymbol::getSpecialization(const FunctionSymbolPtr& genericFunction, const GenericArgumentPtr& arguments)
+{
+    //generic functions of global scope can be shared by multiple registries
+    lock_guard<mutex> lock(specializationLock);
+    GenericArgumentKey key(arguments);
+    auto iter = genericFunction->specializations.find(key);
+    if(iter != genericFunction->specializations.end())
+    {
+        if(FunctionSymbolPtr ret = iter->second.lock())
+            return ret;
+        genericFunction->specializations.erase(iter);
+    }
+    TypePtr type = Type::newSpecializedType(genericFunction->getType(), arguments);
+    FunctionSymbolPtr ret(new FunctionSymbol(genericFunction->getName(), type, genericFunction->getRole(), nullptr));
+    ret->genericFunction = genericFunction;
+    ret->genericArguments = arguments;
+    genericFunction->sweepSpecializations();
+    genericFunction->specializations.insert(make_pair(key, ret));
+    return ret;
+}
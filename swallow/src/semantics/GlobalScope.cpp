@@ -577,6 +577,10 @@ void GlobalScope::initOperators(SymbolRegistry* registry)
         registerOperatorFunction(logic, _Bool, _Bool, _Bool);
     }
     registerOperatorFunction(L"!", _Bool, _Bool, OperatorType::PrefixUnary);
+    //String concatenation and comparison
+    registerOperatorFunction(L"+", _String, _String, _String);
+    registerOperatorFunction(L"==", _Bool, _String, _String);
+    registerOperatorFunction(L"!=", _Bool, _String, _String);
     for(const wchar_t* unary : unaries)
     {
         for(const TypePtr& type : numbers)
@@ -33,6 +33,7 @@
 #include "common/CompilerResults.h"
 #include "semantics/SymbolRegistry.h"
 #include "common/Errors.h"
+#include "common/CompilerStats.h"
 #include "semantics/ScopedNodes.h"
 
 USE_SWALLOW_NS
@@ -151,28 +152,23 @@ void OperatorResolver::visitProtocol(const ProtocolDefPtr& node)
 
 void OperatorResolver::visitClosure(const ClosurePtr& node)
 {
-    for(auto& st : *node)
-    {
-        st = transform<Statement>(st);
-    }
+    for(int i = 0; i < node->numStatement(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
 }
 
 
 void OperatorResolver::visitProgram(const ProgramPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::OperatorResolution);
     ScopedProgramPtr program = static_pointer_cast<ScopedProgram>(node);
     symbolRegistry->setFileScope(program->getScope());
-    for(auto& st : *node)
-    {
-        st = transform<Statement>(st);
-    }
+    for(int i = 0; i < node->numStatements(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
 }
 void OperatorResolver::visitCodeBlock(const CodeBlockPtr& node)
 {
-    for(auto& st : *node)
-    {
-        st = transform<Statement>(st);
-    }
+    for(int i = 0; i < node->numStatements(); i++)
+        node->setStatement(i, transform<Statement>(node->getStatement(i)));
 }
 
 void OperatorResolver::visitValueBinding(const ValueBindingPtr& node)
@@ -182,10 +178,8 @@ void OperatorResolver::visitValueBinding(const ValueBindingPtr& node)
 
 void OperatorResolver::visitStringInterpolation(const StringInterpolationPtr& node)
 {
-    for(auto& expr : *node)
-    {
-        expr = transform<Expression>(expr);
-    }
+    for(int i = 0; i < (int)node->numExpressions(); i++)
+        node->setExpression(i, transform<Expression>(node->getExpression(i)));
 }
 
 void OperatorResolver::visitConditionalOperator(const ConditionalOperatorPtr& node)
@@ -205,10 +199,8 @@ void OperatorResolver::visitUnaryOperator(const UnaryOperatorPtr& node)
 }
 void OperatorResolver::visitTuple(const TuplePtr& node)
 {
-    for(PatternPtr& p : *node)
-    {
-        p = transform<Pattern>(p);
-    }
+    for(int i = 0; i < node->numElements(); i++)
+        node->setElement(i, transform<Pattern>(node->getElement(i)));
 }
 
 void OperatorResolver::visitReturn(const ReturnStatementPtr& node)
@@ -217,24 +209,22 @@ void OperatorResolver::visitReturn(const ReturnStatementPtr& node)
 }
 void OperatorResolver::visitParenthesizedExpression(const ParenthesizedExpressionPtr& node)
 {
-    for(auto& p : *node)
-    {
-        p.expression = transform<Expression>(p.expression);
-    }
+    for(int i = 0; i < (int)node->numExpressions(); i++)
+        node->setExpression(i, transform<Expression>(node->get(i)));
 }
 void OperatorResolver::visitArrayLiteral(const ArrayLiteralPtr& node)
 {
-    for(auto& p : *node)
-    {
-        p = transform<Expression>(p);
-    }
+    for(int i = 0; i < node->numElements(); i++)
+        node->setElement(i, transform<Expression>(node->getElement(i)));
 }
 void OperatorResolver::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
 {
+    int i = 0;
     for(auto& el : *node)
     {
-        el.first = transform<Expression>(el.first);
-        el.second = transform<Expression>(el.second);
+        node->setKey(i, transform<Expression>(el.first));
+        node->setValue(i, transform<Expression>(el.second));
+        i++;
     }
 }
 
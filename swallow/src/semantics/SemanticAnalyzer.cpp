@@ -48,16 +48,20 @@
 #include <set>
 #include <semantics/Symbol.h>
 #include "semantics/DeclarationAnalyzer.h"
+#include "common/CompilerStats.h"
+#include "common/CompilerTrace.h"
 
 USE_SWALLOW_NS
 using namespace std;
 
+const int SemanticAnalyzer::DefaultMaxExpressionCost;
 
 SemanticAnalyzer::SemanticAnalyzer(SymbolRegistry* symbolRegistry, CompilerResults* compilerResults)
 :SemanticPass(symbolRegistry, compilerResults)
 {
     declarationAnalyzer = new DeclarationAnalyzer(this, &ctx);
     lazyDeclaration = true;
+    maxExpressionCost = DefaultMaxExpressionCost;
 }
 SemanticAnalyzer::~SemanticAnalyzer()
 {
@@ -72,11 +76,12 @@ std::wstring SemanticAnalyzer::generateTempName()
 }
 
 /*!
- * Check if the declaration is declared as global
+ * Check if the declaration being visited is visited as a global declaration
  */
 bool SemanticAnalyzer::isGlobal(const DeclarationPtr& node)
 {
-    NodePtr parent = node->getParentNode();
+    assert(getCurrentNode() == node.get());
+    Node* parent = getVisitingParent();
     bool ret(parent == nullptr || parent->getNodeType() == NodeType::Program);
     return ret;
 }
@@ -93,6 +98,61 @@ static std::wstring getDeclarationName(const DeclarationPtr& node)
     }
     return L"";
 }
+/*!
+ * Name of a top-level statement shown in the compiler trace
+ */
+static std::wstring getTraceName(const StatementPtr& node)
+{
+    switch(node->getNodeType())
+    {
+        case NodeType::Function:
+            return L"func " + static_pointer_cast<FunctionDef>(node)->getName();
+        case NodeType::Class:
+            return L"class " + static_pointer_cast<TypeDeclaration>(node)->getIdentifier()->getName();
+        case NodeType::Struct:
+            return L"struct " + static_pointer_cast<TypeDeclaration>(node)->getIdentifier()->getName();
+        case NodeType::Enum:
+            return L"enum " + static_pointer_cast<TypeDeclaration>(node)->getIdentifier()->getName();
+        case NodeType::Protocol:
+            return L"protocol " + static_pointer_cast<TypeDeclaration>(node)->getIdentifier()->getName();
+        case NodeType::Extension:
+            return L"extension " + static_pointer_cast<TypeDeclaration>(node)->getIdentifier()->getName();
+        case NodeType::TypeAlias:
+            return L"typealias " + static_pointer_cast<TypeAlias>(node)->getName();
+        case NodeType::ValueBindings:
+        {
+            ValueBindingsPtr bindings = static_pointer_cast<ValueBindings>(node);
+            wstring ret = bindings->isReadOnly() ? L"let" : L"var";
+            if(bindings->numBindings() > 0)
+            {
+                if(IdentifierPtr id = dynamic_pointer_cast<Identifier>(bindings->get(0)->getName()))
+                    ret += L" " + id->getIdentifier();
+            }
+            return ret;
+        }
+        default:
+            return L"statement";
+    }
+}
+
+/*!
+ * Check if the top-level statement will be delayed as a lazy declaration
+ */
+static bool isLazyDeclaration(const StatementPtr& node)
+{
+    switch(node->getNodeType())
+    {
+        case NodeType::Function:
+        case NodeType::Class:
+        case NodeType::Struct:
+        case NodeType::Enum:
+        case NodeType::Protocol:
+            return true;
+        default:
+            return false;
+    }
+}
+
 /*!
   * Mark this declaration node as lazy declaration, it will be processed only when being used or after the end of the program.
   */
@@ -130,6 +190,10 @@ void SemanticAnalyzer::declareImmediately(const std::wstring& name)
         {
             DeclarationPtr decl = decls.front();
             decls.pop_front();
+            TraceEvent event(TraceCategory::Declaration, getTraceLine(decl), [&]{ return getTraceName(decl);});
+            //the declaration is not a part of the expression that uses it
+            ExpressionCost cost;
+            SCOPED_SET(ctx.expressionCost, &cost);
             decl->accept(this);
         }
     }
@@ -142,10 +206,24 @@ void SemanticAnalyzer::declareImmediately(const std::wstring& name)
 }
 void SemanticAnalyzer::visitProgram(const ProgramPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::BodyAnalysis);
     InitializationTracer tracer(nullptr, InitializationTracer::Sequence);
     SCOPED_SET(ctx.currentInitializationTracer, &tracer);
 
-    SemanticPass::visitProgram(node);
+    for(const StatementPtr& st : *node)
+    {
+        if(!st)
+            continue;
+        if(lazyDeclaration && isLazyDeclaration(st))
+        {
+            st->accept(this);
+            continue;
+        }
+        TraceEvent event(TraceCategory::Declaration, getTraceLine(st), [&]{ return getTraceName(st);});
+        ExpressionCost cost;
+        SCOPED_SET(ctx.expressionCost, &cost);
+        st->accept(this);
+    }
     //now we'll deal with the lazy declaration of functions and classes
     lazyDeclaration = false;
     while(!lazyDeclarations.empty())
@@ -156,10 +234,15 @@ void SemanticAnalyzer::visitProgram(const ProgramPtr& node)
         {
             DeclarationPtr decl = decls.front();
             decls.pop_front();
+            TraceEvent event(TraceCategory::Declaration, getTraceLine(decl), [&]{ return getTraceName(decl);});
+            ExpressionCost cost;
+            SCOPED_SET(ctx.expressionCost, &cost);
             decl->accept(this);
         }
         lazyDeclarations.erase(entry);
     }
+    //top-level variables stay initialized, statements analyzed later in the same scope(e.g. by REPL) can use them
+    tracer.set.clear();
 }
 
 
@@ -539,7 +622,12 @@ ExpressionPtr SemanticAnalyzer::transformExpression(const TypePtr& contextualTyp
     if(!contextualType)
         return expr;
     GlobalScope* global = symbolRegistry->getGlobalScope();
-    if(global->isOptional(contextualType) || global->isImplicitlyUnwrappedOptional(contextualType))
+    //literals take the type wrapped by the contextual optional type
+    TypePtr wrappedType = contextualType;
+    while(global->isOptional(wrappedType) || global->isImplicitlyUnwrappedOptional(wrappedType))
+        wrappedType = wrappedType->getGenericArguments()->get(0);
+    applyContextualType(expr, wrappedType);
+    if(wrappedType != contextualType)
     {
         ExpressionPtr transformed = expr;
         bool ret = expandOptional(contextualType, transformed);
@@ -553,6 +641,25 @@ ExpressionPtr SemanticAnalyzer::transformExpression(const TypePtr& contextualTyp
     //}
     return expr;
 }
+void SemanticAnalyzer::chargeExpressionCost(const NodePtr& node, int cost)
+{
+    ExpressionCost* expressionCost = ctx.expressionCost;
+    if(!expressionCost || !maxExpressionCost)
+        return;
+    expressionCost->total += cost;
+    int& nodeCost = expressionCost->nodes[node.get()];
+    nodeCost += cost;
+    if(nodeCost > expressionCost->hotCost)
+    {
+        expressionCost->hotCost = nodeCost;
+        expressionCost->hotNode = node;
+    }
+    if(expressionCost->total > maxExpressionCost)
+    {
+        error(expressionCost->hotNode, Errors::E_EXPRESSION_WAS_TOO_COMPLEX_A_OF_B_SPENT_HERE_2, toString(expressionCost->hotCost), toString(maxExpressionCost));
+        abort();
+    }
+}
 /*!
  * Gets all functions from current scope to top scope with given name, if flagMasks is specified, only functions
  * with given mask will be returned
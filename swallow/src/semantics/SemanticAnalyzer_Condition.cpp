@@ -45,6 +45,7 @@
 #include "common/ScopedValue.h"
 #include "semantics/ScopeGuard.h"
 #include "semantics/InitializationTracer.h"
+#include "semantics/FlowTracer.h"
 #include "semantics/SemanticUtils.h"
 
 
@@ -144,14 +145,19 @@ void SemanticAnalyzer::visitIf(const IfStatementPtr& node)
 
     SCOPED_SET(ctx.currentInitializationTracer, &tracer);
 
+    FlowTracer* flow = ctx.currentFlowTracer;
     {
         InitializationTracer ifTracer(&tracer, InitializationTracer::Branch);
         SCOPED_SET(ctx.currentInitializationTracer, &ifTracer);
+        FlowTracer ifFlow(flow, FlowTracer::Branch);
+        SCOPED_SET(ctx.currentFlowTracer, &ifFlow);
         node->getThen()->accept(this);
     }
     {
         InitializationTracer elseTracer(&tracer, InitializationTracer::Branch);
         SCOPED_SET(ctx.currentInitializationTracer, &elseTracer);
+        FlowTracer elseFlow(flow, FlowTracer::Branch);
+        SCOPED_SET(ctx.currentFlowTracer, &elseFlow);
         if (node->getElse())
             node->getElse()->accept(this);
     }
@@ -193,12 +199,15 @@ void SemanticAnalyzer::visitSwitchCase(const SwitchCasePtr& node)
     checkExhausiveSwitch(this, node);
 
     InitializationTracer tracer(ctx.currentInitializationTracer, InitializationTracer::Sequence);
+    FlowTracer* flow = ctx.currentFlowTracer;
     for(const CaseStatementPtr& c : *node)
     {
         CodeBlockPtr statements = c->getCodeBlock();
 
         InitializationTracer caseTracer(&tracer, InitializationTracer::Branch);
         SCOPED_SET(ctx.currentInitializationTracer, &caseTracer);
+        FlowTracer caseFlow(flow, FlowTracer::Branch);
+        SCOPED_SET(ctx.currentFlowTracer, &caseFlow);
         if(statements->numStatements() == 0)
         {
             error(node, Errors::E_A_LABEL_IN_SWITCH_SHOULD_HAVE_AT_LEAST_ONE_STATEMENT_0, L"case");
@@ -209,6 +218,8 @@ void SemanticAnalyzer::visitSwitchCase(const SwitchCasePtr& node)
     {
         InitializationTracer caseTracer(&tracer, InitializationTracer::Branch);
         SCOPED_SET(ctx.currentInitializationTracer, &caseTracer);
+        FlowTracer defaultFlow(flow, FlowTracer::Branch);
+        SCOPED_SET(ctx.currentFlowTracer, &defaultFlow);
         if (node->getDefaultCase())
         {
             if (node->getDefaultCase()->getCodeBlock()->numStatements() == 0)
@@ -90,7 +90,7 @@ bool SemanticAnalyzer::hasOptionalChaining(const NodePtr& node)
 }
 
 
-bool SemanticAnalyzer::isParentInOptionalChain(const NodePtr& node)
+bool SemanticAnalyzer::isParentInOptionalChain(Node* node)
 {
     if(node == nullptr)
         return false;
@@ -179,6 +179,7 @@ void SemanticAnalyzer::visitMemberAccess(const MemberAccessPtr& node)
             }
         }
         node->setType(member->getType());
+        node->setReferencedSymbol(member);
     }
     else
     {
@@ -199,7 +200,7 @@ void SemanticAnalyzer::visitMemberAccess(const MemberAccessPtr& node)
 
     //Optional Chaining, if parent node is not a member access and there's a optional chaining expression inside Self, mark the expression optional
     //if(!parentNode || (parentNode->getNodeType() != NodeType::MemberAccess && parentNode->getNodeType() != NodeType::Assignment && parentNode->getNodeType() != NodeType::OptionalChaining))
-    if(!isParentInOptionalChain(node->getParentNode()))
+    if(!isParentInOptionalChain(getVisitingParent()))
     {
         if(hasOptionalChaining(node->getSelf()))
         {
@@ -240,9 +241,13 @@ void SemanticAnalyzer::visitSubscriptAccess(const SubscriptAccessPtr& node)
     }
     bool mutatingSelf = false;//TODO update this variable
     //Now inference the type returned by this subscript access
+    analyzeArguments(node->getIndex());
     SymbolPtr func = getOverloadedFunction(mutatingSelf, node, funcs, node->getIndex());
     assert(func && func->getType() && func->getType()->getCategory() == Type::Function);
+    //convert the index arguments to the matched subscript
+    calculateFitScore(mutatingSelf, func, node->getIndex(), false);
     node->setType(func->getType()->getReturnType());
+    node->setReferencedSymbol(func);
 }
 
 
@@ -44,6 +44,8 @@
 #include <set>
 #include <cassert>
 #include "semantics/DeclarationAnalyzer.h"
+#include "common/CompilerStats.h"
+#include "semantics/FlowTracer.h"
 
 USE_SWALLOW_NS
 using namespace std;
@@ -52,11 +54,13 @@ using namespace std;
 
 void SemanticAnalyzer::visitClosure(const ClosurePtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 
 void SemanticAnalyzer::visitSubscript(const SubscriptDefPtr &node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitFunction(const FunctionDefPtr& node)
@@ -67,34 +71,63 @@ void SemanticAnalyzer::visitFunction(const FunctionDefPtr& node)
         delayDeclare(node);
         return;
     }
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 
 void SemanticAnalyzer::visitDeinit(const DeinitializerDefPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 
 void SemanticAnalyzer::visitInit(const InitializerDefPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 
+/*!
+ * Check if the statement is a delegation call like self.init(...) or super.init(...)
+ */
+static bool isInitializerCall(const StatementPtr& st)
+{
+    if(st->getNodeType() != NodeType::FunctionCall)
+        return false;
+    FunctionCallPtr call = static_pointer_cast<FunctionCall>(st);
+    if(call->getFunction()->getNodeType() != NodeType::MemberAccess)
+        return false;
+    MemberAccessPtr ma = static_pointer_cast<MemberAccess>(call->getFunction());
+    return ma->getField() && ma->getField()->getIdentifier() == L"init";
+}
+
 void SemanticAnalyzer::visitCodeBlock(const CodeBlockPtr &node)
 {
+    PhaseTimer timer(CompilerPhase::BodyAnalysis);
     SCOPED_SET(ctx.flags, ctx.flags | SemanticContext::FLAG_PROCESS_IMPLEMENTATION | SemanticContext::FLAG_PROCESS_DECLARATION);
-    auto iter = node->begin();
-    for(; iter != node->end(); iter++)
+    FlowTracer* flow = ctx.currentFlowTracer;
+    for(int i = 0; i < node->numStatements(); i++)
     {
-        StatementPtr st = *iter;
+        StatementPtr st = node->getStatement(i);
         if(BinaryOperatorPtr op = dynamic_pointer_cast<BinaryOperator>(st))
-            *iter = transformExpression(nullptr, op);
-        st->accept(this);
+            node->setStatement(i, transformExpression(nullptr, op));
+        if(flow && flow->isReturned())
+            flow->markUnreachable(node->getStatement(i));
+        {
+            FlowTracer tracer(flow, FlowTracer::Sequence);
+            ExpressionCost cost;
+            SCOPED_SET(ctx.currentFlowTracer, &tracer);
+            SCOPED_SET(ctx.expressionCost, &cost);
+            st->accept(this);
+        }
+        if(flow && isInitializerCall(node->getStatement(i)))
+            flow->addInitializerCall(node->getStatement(i));
     }
 }
 
 
 void SemanticAnalyzer::visitComputedProperty(const ComputedPropertyPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
@@ -44,7 +44,10 @@
 #include <iostream>
 #include "common/ScopedValue.h"
 #include "semantics/InitializationTracer.h"
+#include "semantics/FlowTracer.h"
 #include "semantics/SemanticUtils.h"
+#include "common/CompilerStats.h"
+#include "common/CompilerTrace.h"
 
 USE_SWALLOW_NS
 using namespace std;
@@ -55,9 +58,8 @@ TypePtr SemanticAnalyzer::getExpressionType(const ExpressionPtr& expr, const Typ
         expr->accept(this);
     score = 0.9;
     GlobalScope* scope = symbolRegistry->getGlobalScope();
-    if(expr->getNodeType() == NodeType::IntegerLiteral && hint != nullptr)
+    if(expr->getLiteralKind() == LiteralKind::Integer && hint != nullptr)
     {
-        IntegerLiteralPtr literal = std::static_pointer_cast<IntegerLiteral>(expr);
         if(hint->conformTo(scope->FloatingPointType()))
         {
             score  = 0.5;
@@ -71,9 +73,8 @@ TypePtr SemanticAnalyzer::getExpressionType(const ExpressionPtr& expr, const Typ
         }
 
     }
-    if(expr->getNodeType() == NodeType::FloatLiteral && hint != nullptr)
+    if(expr->getLiteralKind() == LiteralKind::Float && hint != nullptr)
     {
-        FloatLiteralPtr literal = std::static_pointer_cast<FloatLiteral>(expr);
         if(hint == scope->Double())
         {
             score = 1;
@@ -152,8 +153,112 @@ bool SemanticAnalyzer::checkArgument(const TypePtr& funcType, const Parameter& p
     return true;
 }
 
+bool SemanticAnalyzer::isContextDependentFunction(const IdentifierPtr& id)
+{
+    declareImmediately(id->getIdentifier());
+    SymbolPtr sym = symbolRegistry->lookupSymbol(id->getIdentifier());
+    if(FunctionOverloadedSymbolPtr funcs = dynamic_pointer_cast<FunctionOverloadedSymbol>(sym))
+    {
+        if(funcs->numOverloads() != 1)
+            return true;
+        sym = *funcs->begin();
+    }
+    FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(sym);
+    return func && func->getType()->getGenericDefinition() != nullptr;
+}
+
+bool SemanticAnalyzer::isContextFree(const ExpressionPtr& expr)
+{
+    switch(expr->getNodeType())
+    {
+        case NodeType::IntegerLiteral:
+        case NodeType::FloatLiteral:
+        case NodeType::BinaryOperator:
+        case NodeType::UnaryOperator:
+            return true;
+        case NodeType::Identifier:
+            return !isContextDependentFunction(static_pointer_cast<Identifier>(expr));
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr parens = static_pointer_cast<ParenthesizedExpression>(expr);
+            return parens->numExpressions() == 1 && isContextFree(parens->get(0));
+        }
+        case NodeType::FunctionCall:
+        {
+            FunctionCallPtr call = static_pointer_cast<FunctionCall>(expr);
+            if(call->getFunction()->getNodeType() == NodeType::Identifier)
+                return !isContextDependentFunction(static_pointer_cast<Identifier>(call->getFunction()));
+            if(call->getFunction()->getNodeType() != NodeType::MemberAccess)
+                return false;
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(call->getFunction());
+            return ma->getSelf() && isContextFree(ma->getSelf());
+        }
+        case NodeType::MemberAccess:
+        {
+            MemberAccessPtr ma = static_pointer_cast<MemberAccess>(expr);
+            return ma->getSelf() && isContextFree(ma->getSelf());
+        }
+        default:
+            return false;
+    }
+}
+
+void SemanticAnalyzer::analyzeArguments(const ParenthesizedExpressionPtr& arguments)
+{
+    for(int i = 0; i < (int)arguments->numExpressions(); i++)
+    {
+        ExpressionPtr argument = arguments->get(i);
+        if(isContextFree(argument))
+            arguments->setTransformedExpression(i, transformExpression(nullptr, argument));
+    }
+}
+
+bool SemanticAnalyzer::checkAnalyzedArgument(const TypePtr& funcType, const Parameter& parameter, const wstring& name, ExpressionPtr& argument, float& score, bool supressErrors, map<wstring, TypePtr>& genericTypes)
+{
+    GlobalScope* global = symbolRegistry->getGlobalScope();
+    ExpressionPtr expr = argument;
+    assert(expr != nullptr && expr->getType() != nullptr);
+    //the argument will be wrapped by Optional.Some if it's passed to an optional parameter, like transformExpression does
+    Parameter param = parameter;
+    float s;
+    while(!getExpressionType(expr, param.type, s)->canAssignTo(param.type) && (global->isOptional(param.type) || global->isImplicitlyUnwrappedOptional(param.type)))
+        param.type = param.type->getGenericArguments()->get(0);
+    bool wrapped = param.type != parameter.type;
+    if(wrapped && !getExpressionType(expr, param.type, s)->canAssignTo(param.type))
+    {
+        param.type = parameter.type;
+        wrapped = false;
+    }
+    if(!supressErrors)
+    {
+        //the overload is resolved, now the literals take the parameter type they were scored with
+        bool inferred = getExpressionType(expr, param.type, s) == param.type;
+        applyContextualType(expr, param.type);
+        if(inferred && !expr->getType()->canAssignTo(param.type))
+        {
+            error(expr, Errors::E_CANNOT_CONVERT_EXPRESSION_TYPE_2, expr->getType()->toString(), param.type->toString());
+            abort();
+        }
+        if(wrapped)
+        {
+            expandOptional(parameter.type, expr);
+            param.type = parameter.type;
+            wrapped = false;
+        }
+        argument = expr;
+    }
+    float before = score;
+    if(!checkArgument(funcType, param, make_pair(name, expr), false, score, supressErrors, genericTypes))
+        return false;
+    //wrapping into Optional is an implicit conversion, it never fits exactly
+    if(wrapped)
+        score = before + std::min(score - before, 0.9f);
+    return true;
+}
+
 float SemanticAnalyzer::calculateFitScore(bool mutatingSelf, SymbolPtr& func, const ParenthesizedExpressionPtr& arguments, bool supressErrors)
 {
+    CompilerStats::increase(CompilerCounter::OverloadCandidates);
     float score = 0;
     TypePtr type = func->getType();
     assert(type != nullptr);
@@ -178,15 +283,41 @@ float SemanticAnalyzer::calculateFitScore(bool mutatingSelf, SymbolPtr& func, co
 
 
     std::vector<Parameter>::const_iterator paramIter = parameters.begin();
-    std::vector<ParenthesizedExpression::Term>::iterator argumentIter = arguments->begin();
+    std::vector<ParenthesizedExpression::Term>::const_iterator argumentIter = arguments->begin();
     std::vector<Parameter>::const_iterator paramEnd = variadic ? parameters.end() - 1 : parameters.end();
     map<wstring, TypePtr> genericTypes;
-    for(;argumentIter != arguments->end() && paramIter != paramEnd; argumentIter++, paramIter++)
+    //generic parameters bound by the contextual type through the return type, e.g. T is Double in let a : Double = f(1)
+    map<wstring, TypePtr> contextualTypes;
+    if(type->getGenericDefinition() && ctx.contextualType && type->getReturnType())
+        type->getReturnType()->canSpecializeTo(ctx.contextualType, contextualTypes);
+    for(int i = 0; argumentIter != arguments->end() && paramIter != paramEnd; argumentIter++, paramIter++, i++)
     {
-        const Parameter& parameter = *paramIter;
-        ParenthesizedExpression::Term& argument = *argumentIter;
+        Parameter parameter = *paramIter;
+        const ParenthesizedExpression::Term& argument = *argumentIter;
+        if(isContextFree(argument.expression))
+        {
+            //a literal passed to a generic parameter takes the type bound by the contextual type if it can
+            if(argument.transformedExpression->getLiteralKind() != LiteralKind::None
+               && (parameter.type->getCategory() == Type::Alias || parameter.type->getCategory() == Type::GenericParameter))
+            {
+                auto iter = contextualTypes.find(parameter.type->getName());
+                float s;
+                if(iter != contextualTypes.end() && genericTypes.find(iter->first) == genericTypes.end()
+                   && getExpressionType(argument.transformedExpression, iter->second, s) == iter->second)
+                {
+                    parameter.type = iter->second;
+                    genericTypes.insert(*iter);
+                }
+            }
+            ExpressionPtr transformed = argument.transformedExpression;
+            bool ret = checkAnalyzedArgument(type, parameter, argument.name, transformed, score, supressErrors, genericTypes);
+            arguments->setTransformedExpression(i, transformed);
+            if(!ret)
+                return -1;
+            continue;
+        }
         SCOPED_SET(ctx.contextualType, parameter.type);
-        argument.transformedExpression = this->transformExpression(parameter.type, argument.expression);
+        arguments->setTransformedExpression(i, this->transformExpression(parameter.type, argument.expression));
         bool ret = checkArgument(type, parameter, make_pair(argumentIter->name, argumentIter->transformedExpression), false, score, supressErrors, genericTypes);
         if(!ret)
             return -1;
@@ -259,13 +390,32 @@ float SemanticAnalyzer::calculateFitScore(bool mutatingSelf, SymbolPtr& func, co
                 abort();
             }
         }
-        assert(generic->numParameters() == genericTypes.size());
+        //a generic parameter that isn't used by any parameter cannot be inferred from the arguments
+        for(const GenericDefinition::Parameter& param : generic->getParameters())
+        {
+            if(genericTypes.find(param.name) != genericTypes.end())
+                continue;
+            if(supressErrors)
+                return -1;
+            error(arguments, Errors::E_ARGUMENT_FOR_GENERIC_PARAMETER_A_COULD_NOT_BE_INFERRED_1, param.name);
+            abort();
+        }
         //Specialization on function call depends on varying type arguments
-        CodeBlockPtr definition = nullptr;
-        type = type->newSpecializedType(type, genericTypes);
+        GenericArgumentPtr genericArguments(new GenericArgument(generic));
+        for(const GenericDefinition::Parameter& param : generic->getParameters())
+            genericArguments->add(genericTypes[param.name]);
         FunctionSymbolPtr func2 = dynamic_pointer_cast<FunctionSymbol>(func);
         assert(func2 != nullptr);
-        func = FunctionSymbolPtr(new FunctionSymbol(func->getName(), type, func2->getRole(), definition));
+        if(FunctionSymbolPtr genericFunction = func2->getGenericFunction())
+            func2 = genericFunction;
+        FunctionSymbolPtr specialized = FunctionSymbol::getSpecialization(func2, genericArguments);
+        //the call site only references it weakly, the file being compiled owns it
+        if(!supressErrors)
+        {
+            SymbolScope* scope = symbolRegistry->getFileScope();
+            (scope ? scope : symbolRegistry->getCurrentScope())->addSpecialization(specialized);
+        }
+        func = specialized;
     }
 
     if(!arguments->numExpressions())
@@ -276,6 +426,7 @@ float SemanticAnalyzer::calculateFitScore(bool mutatingSelf, SymbolPtr& func, co
 SymbolPtr SemanticAnalyzer::getOverloadedFunction(bool mutatingSelf, const NodePtr& node, const std::vector<SymbolPtr>& funcs, const ParenthesizedExpressionPtr& arguments)
 {
     typedef std::tuple<float, SymbolPtr, TypePtr> ScoredFunction;
+    TraceEvent event(TraceCategory::OverloadResolution, getTraceLine(node), [&]{ return funcs.empty() ? wstring() : funcs[0]->getName();});
     std::vector<ScoredFunction> candidates;
     for(SymbolPtr func : funcs)
     {
@@ -297,6 +448,22 @@ SymbolPtr SemanticAnalyzer::getOverloadedFunction(bool mutatingSelf, const NodeP
         sort(candidates.begin(), candidates.end(), [](const ScoredFunction& lhs, const ScoredFunction& rhs ){
             return get<0>(rhs) < get<0>(lhs);
         });
+        //the candidates fit the arguments equally, the contextual type picks the one with the matching result
+        if(get<0>(candidates[0]) == get<0>(candidates[1]) && ctx.contextualType)
+        {
+            float best = get<0>(candidates[0]);
+            vector<ScoredFunction> matched;
+            for(const ScoredFunction& candidate : candidates)
+            {
+                const SymbolPtr& func = get<1>(candidate);
+                TypePtr funcType = get<2>(candidate);
+                TypePtr resultType = funcType->hasFlags(SymbolFlagInit) ? func->getDeclaringType() : funcType->getReturnType();
+                if(get<0>(candidate) == best && resultType && resultType->canAssignTo(ctx.contextualType))
+                    matched.push_back(candidate);
+            }
+            if(matched.size() == 1)
+                return get<1>(matched.front());
+        }
         if(get<0>(candidates[0]) == get<0>(candidates[1]))
         {
             error(node, Errors::E_AMBIGUOUS_USE_1, funcs[0]->getName());
@@ -373,6 +540,15 @@ static void updateNodeType(SemanticAnalyzer* semanticAnalyzer, const PatternPtr&
     }
 }
 
+/*!
+ * Record the resolved callee on the call/operator node, so later passes don't need to resolve the overload again
+ */
+static void setReferencedSymbol(const PatternPtr& node, const SymbolPtr& sym)
+{
+    if(ExpressionPtr expr = std::dynamic_pointer_cast<Expression>(node))
+        expr->setReferencedSymbol(sym);
+}
+
 SymbolPtr SemanticAnalyzer::visitFunctionCall(bool mutatingSelf, std::vector<SymbolPtr>& funcs, const ParenthesizedExpressionPtr& args, const PatternPtr& node)
 {
     //filter out impossible candidates by argument count
@@ -391,6 +567,15 @@ SymbolPtr SemanticAnalyzer::visitFunctionCall(bool mutatingSelf, std::vector<Sym
 
     }
 
+    //every candidate checks the arguments, the generic ones are also specialized
+    int cost = (int)funcs.size() + 1;
+    for(const SymbolPtr& func : funcs)
+    {
+        if(func->getType()->getGenericDefinition())
+            cost++;
+    }
+    chargeExpressionCost(node, cost);
+
     if(funcs.size() == 1)
     {
         SymbolPtr sym = funcs.front();
@@ -402,6 +587,7 @@ SymbolPtr SemanticAnalyzer::visitFunctionCall(bool mutatingSelf, std::vector<Sym
             TypePtr type = func->getType();
             //check mutating function
             updateNodeType(this, node, func);
+            setReferencedSymbol(node, func);
             return func;
         }
         else if(std::dynamic_pointer_cast<SymbolPlaceHolder>(sym) || std::dynamic_pointer_cast<ComputedPropertySymbol>(sym))
@@ -417,6 +603,7 @@ SymbolPtr SemanticAnalyzer::visitFunctionCall(bool mutatingSelf, std::vector<Sym
             }
             calculateFitScore(mutatingSelf, sym, args, false);
             updateNodeType(this, node, sym);
+            setReferencedSymbol(node, sym);
             return sym;
         }
         else
@@ -429,8 +616,11 @@ SymbolPtr SemanticAnalyzer::visitFunctionCall(bool mutatingSelf, std::vector<Sym
     {
         SymbolPtr matched = getOverloadedFunction(mutatingSelf, node, funcs, args);
         assert(matched != nullptr && matched->getType()->getCategory() == Type::Function);
+        //arguments were last evaluated against the final candidate of the scoring, evaluate them again with the matched one
+        calculateFitScore(mutatingSelf, matched, args, false);
         //node->setType(matched->getType()->getReturnType());
         updateNodeType(this, node, matched);
+        setReferencedSymbol(node, matched);
         return matched;
     }
 
@@ -490,6 +680,7 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
                     }
                 }
             }
+            analyzeArguments(node->getArguments());
             visitFunctionCall(mutatingSelf, funcs, node->getArguments(), node);
             break;
         }
@@ -499,7 +690,6 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
             TypePtr selfType;
             if(ma->getSelf() != nullptr)//e.g.   var a : String? = .Some("fff")
             {
-                SCOPED_SET(currentNode, ma);
                 validateInitializerDelegation(ma);
                 ma->getSelf()->accept(this);
                 selfType = ma->getSelf()->getType();
@@ -541,6 +731,7 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
                 abort();
                 return;
             }
+            analyzeArguments(node->getArguments());
             SymbolPtr func = visitFunctionCall(mutatingSelf, funcs, node->getArguments(), node);
             assert(func != nullptr);
             TypePtr funcType = func->getType();
@@ -559,7 +750,7 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
                 return;
             }
             ma->setType(funcType);
-            if(hasOptionalChaining(ma->getSelf()) && !isParentInOptionalChain(node->getParentNode()))
+            if(hasOptionalChaining(ma->getSelf()) && !isParentInOptionalChain(getVisitingParent()))
             {
                 TypePtr type = symbolRegistry->getGlobalScope()->makeOptional(node->getType());
                 node->setType(type);
@@ -575,6 +766,7 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
             SymbolPtr tmp(new SymbolPlaceHolder(L"", type, SymbolPlaceHolder::R_LOCAL_VARIABLE, 0));
             assert(type != nullptr && type->getCategory() == Type::Function);
             bool mutatingSelf = false;
+            analyzeArguments(node->getArguments());
             calculateFitScore(mutatingSelf, tmp, node->getArguments(), false);
             node->setType(type->getReturnType());
             break;
@@ -622,7 +814,10 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
         }
         default:
         {
-            error(func, Errors::E_INVALID_USE_OF_A_TO_CALL_A_VALUE_OF_NON_FUNCTION_TYPE_B_2, toString(func), func->getType()->toString());
+            //analyze the callee first so an unresolved name inside it gets reported
+            func->accept(this);
+            TypePtr type = func->getType();
+            error(func, Errors::E_INVALID_USE_OF_A_TO_CALL_A_VALUE_OF_NON_FUNCTION_TYPE_B_2, toString(func), type ? type->toString() : L"<<error type>>");
             break;
         }
     }
@@ -633,6 +828,8 @@ void SemanticAnalyzer::visitFunctionCall(const FunctionCallPtr& node)
 
 void SemanticAnalyzer::visitReturn(const ReturnStatementPtr& node)
 {
+    if(ctx.currentFlowTracer)
+        ctx.currentFlowTracer->addReturn();
     if(!ctx.currentFunction)
     {
         error(node, Errors::E_RETURN_INVALID_OUTSIDE_OF_A_FUNC);
@@ -678,6 +875,13 @@ void SemanticAnalyzer::visitReturn(const ReturnStatementPtr& node)
     float score = 0;
     TypePtr retType = this->getExpressionType(node->getExpression(), funcType->getReturnType(), score);
     TypePtr expectedType = funcType->getReturnType();
+    if(!expectedType->containsGenericParameters())
+    {
+        //returned literals take the return type
+        applyContextualType(node->getExpression(), expectedType);
+        if(node->getExpression()->getLiteralKind() != LiteralKind::None)
+            retType = node->getExpression()->getType();
+    }
     if(!retType->canAssignTo(expectedType))
     {
         error(node->getExpression(), Errors::E_CANNOT_CONVERT_EXPRESSION_TYPE_2, retType->toString(), expectedType->toString());
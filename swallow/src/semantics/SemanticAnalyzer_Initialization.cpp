@@ -163,7 +163,9 @@ void SemanticAnalyzer::validateInitializerDelegation(const MemberAccessPtr& node
         }
         //NOTE: this check exists whatever if the member defined in current type or super type
         //I'm not sure if it's official implementation's bug
-        if(node->getParentNode()->getNodeType() == NodeType::FunctionCall && !tracer->superInit)
+        //the member access is either being visited, or used as the callee of the function call being visited
+        Node* parent = getCurrentNode() == node.get() ? getVisitingParent() : getCurrentNode();
+        if(parent && parent->getNodeType() == NodeType::FunctionCall && !tracer->superInit)
         {
             error(node, Errors::E_SELF_USED_BEFORE_SUPER_INIT_CALL);
             return;
@@ -48,6 +48,25 @@
 USE_SWALLOW_NS
 using namespace std;
 
+/*!
+ * Plain literals take their type from the collection directly, they never need an overload resolution
+ */
+static bool isPlainLiteral(const ExpressionPtr& expr)
+{
+    switch(expr->getNodeType())
+    {
+        case NodeType::IntegerLiteral:
+        case NodeType::FloatLiteral:
+        case NodeType::StringLiteral:
+        case NodeType::BooleanLiteral:
+        case NodeType::NilLiteral:
+            return true;
+        default:
+            //folded arithmetic on literals
+            return expr->getLiteralKind() != LiteralKind::None;
+    }
+}
+
 bool SemanticAnalyzer::isInteger(const TypePtr& type)
 {
     GlobalScope* scope = symbolRegistry->getGlobalScope();
@@ -100,6 +119,8 @@ void SemanticAnalyzer::visitStringInterpolation(const StringInterpolationPtr &no
 {
     //TODO: check all expressions inside can be converted to string
     GlobalScope* scope = symbolRegistry->getGlobalScope();
+    for(int i = 0; i < (int)node->numExpressions(); i++)
+        node->setExpression(i, transformExpression(nullptr, node->getExpression(i)));
     if(ctx.contextualType && ctx.contextualType->canAssignTo(scope->StringInterpolationConvertible()))
         node->setType(ctx.contextualType);
     else
@@ -115,6 +136,7 @@ void SemanticAnalyzer::visitInteger(const IntegerLiteralPtr& node)
         node->setType(ctx.contextualType);
     else
         node->setType(scope->Int());
+    node->setLiteralKind(LiteralKind::Integer);
 }
 void SemanticAnalyzer::visitFloat(const FloatLiteralPtr& node)
 {
@@ -123,6 +145,7 @@ void SemanticAnalyzer::visitFloat(const FloatLiteralPtr& node)
         node->setType(ctx.contextualType);
     else
         node->setType(scope->Double());
+    node->setLiteralKind(LiteralKind::Float);
 }
 
 //Will be replaced by stdlib's type constructor
@@ -147,6 +170,39 @@ bool SemanticAnalyzer::canConvertTo(const ExpressionPtr& expr, const TypePtr& ty
     return false;
 }
 
+void SemanticAnalyzer::applyContextualType(const ExpressionPtr& expr, const TypePtr& type)
+{
+    if(!type || expr->getLiteralKind() == LiteralKind::None || Type::equals(expr->getType(), type))
+        return;
+    if(type->containsGenericParameters())
+        return;
+    switch(expr->getNodeType())
+    {
+        case NodeType::IntegerLiteral:
+        case NodeType::FloatLiteral:
+        {
+            SCOPED_SET(ctx.contextualType, type);
+            expr->accept(this);
+            break;
+        }
+        case NodeType::ParenthesizedExpression:
+        {
+            ParenthesizedExpressionPtr parens = static_pointer_cast<ParenthesizedExpression>(expr);
+            ExpressionPtr inner = parens->get(0);
+            applyContextualType(inner, type);
+            parens->setType(inner->getType());
+            parens->setLiteralKind(inner->getLiteralKind());
+            break;
+        }
+        case NodeType::BinaryOperator:
+        case NodeType::UnaryOperator:
+            inferOperatorType(expr, type);
+            break;
+        default:
+            break;
+    }
+}
+
 void SemanticAnalyzer::visitArrayLiteral(const ArrayLiteralPtr& node)
 {
     int num = node->numElements();
@@ -183,16 +239,23 @@ void SemanticAnalyzer::visitArrayLiteral(const ArrayLiteralPtr& node)
         SCOPED_SET(ctx.contextualType, analyzer.finalType);
         el->accept(this);
         analyzer.analyze(el);
+        //only elements that may need an overload resolution are charged, so large literal tables stay affordable
+        if(!isPlainLiteral(el))
+            chargeExpressionCost(node, 1);
 
         if(analyzer.differentTypes > 0)
         {
             error(el, Errors::E_ARRAY_CONTAINS_DIFFERENT_TYPES);
         }
+    }
+    //the element type is known after all elements are analyzed, literals analyzed before it take the final type
+    for(const ExpressionPtr& el : *node)
+    {
+        applyContextualType(el, analyzer.finalType);
         if(!canConvertTo(el, analyzer.finalType))
         {
             error(el, Errors::E_CANNOT_CONVERT_EXPRESSION_TYPE_2, toString(el), analyzer.finalType->toString());
         }
-
     }
 
     assert(analyzer.finalType != nullptr);
@@ -261,13 +324,21 @@ void SemanticAnalyzer::visitDictionaryLiteral(const DictionaryLiteralPtr& node)
         entry.second->accept(this);
         keyAnalyzer.analyze(entry.first);
         valueAnalyzer.analyze(entry.second);
-        entry.first = this->transformExpression(keyAnalyzer.finalType, entry.first);
-        entry.second = transformExpression(valueAnalyzer.finalType, entry.second);
+        if(!isPlainLiteral(entry.first) || !isPlainLiteral(entry.second))
+            chargeExpressionCost(node, 1);
 
         if(keyAnalyzer.differentTypes > 0)
             error(entry.first, Errors::E_DICTIONARY_KEY_CONTAINS_DIFFERENT_TYPES);
         if(valueAnalyzer.differentTypes > 0)
             error(entry.second, Errors::E_DICTIONARY_VALUE_CONTAINS_DIFFERENT_TYPES);
+    }
+    //keys and values are converted to the final types without being analyzed again
+    for(auto entry : *node)
+    {
+        applyContextualType(entry.first, keyAnalyzer.finalType);
+        applyContextualType(entry.second, valueAnalyzer.finalType);
+        expandOptional(keyAnalyzer.finalType, entry.first);
+        expandOptional(valueAnalyzer.finalType, entry.second);
         if(!canConvertTo(entry.first, keyAnalyzer.finalType))
             error(entry.first, Errors::E_CANNOT_CONVERT_EXPRESSION_TYPE_2, toString(entry.first), keyAnalyzer.finalType->toString());
         if(!canConvertTo(entry.second, valueAnalyzer.finalType))
@@ -294,23 +365,22 @@ void SemanticAnalyzer::visitParenthesizedExpression(const ParenthesizedExpressio
     TypePtr hint = ctx.contextualType;
     std::vector<TypePtr> types;
     int index = 0;
-    for(ParenthesizedExpression::Term& element : *node)
+    for(int i = 0; i < (int)node->numExpressions(); i++)
     {
         TypePtr elementHint = nullptr;
         if(ctx.contextualType && ctx.contextualType->getCategory() == Type::Tuple && index < ctx.contextualType->numElementTypes())
         {
             elementHint = ctx.contextualType->getElementType(index++);
         }
-        SCOPED_SET(ctx.contextualType, elementHint);
-        element.expression->accept(this);
-        element.expression = transformExpression(elementHint, element.expression);
-        TypePtr elementType = element.expression->getType();
+        node->setExpression(i, transformExpression(elementHint, node->get(i)));
+        TypePtr elementType = node->get(i)->getType();
         assert(elementType != nullptr);
         types.push_back(elementType);
     }
     if(types.size() == 1)
     {
         node->setType(types[0]);
+        node->setLiteralKind(node->get(0)->getLiteralKind());
     }
     else
     {
@@ -322,22 +392,24 @@ void SemanticAnalyzer::visitTuple(const TuplePtr& node)
 {
     NodeVisitor::visitTuple(node);
     std::vector<TypePtr> types;
-    auto iter = node->begin();
     int index = 0;
-    for(; iter != node->end(); iter++)
+    for(int i = 0; i < node->numElements(); i++)
     {
         TypePtr elementHint = nullptr;
         if(ctx.contextualType && ctx.contextualType->getCategory() == Type::Tuple && index < ctx.contextualType->numElementTypes())
         {
             elementHint = ctx.contextualType->getElementType(index++);
         }
-        SCOPED_SET(ctx.contextualType, elementHint);
-        PatternPtr element = *iter;
-        element->accept(this);
+        PatternPtr element = node->getElement(i);
         if(ExpressionPtr expr = dynamic_pointer_cast<Expression>(element))
         {
-            expr = transformExpression(elementHint, expr);
-            element = *iter = expr;
+            element = transformExpression(elementHint, expr);
+            node->setElement(i, element);
+        }
+        else
+        {
+            SCOPED_SET(ctx.contextualType, elementHint);
+            element->accept(this);
         }
         TypePtr elementType = element->getType();
         assert(elementType != nullptr);
@@ -371,6 +443,43 @@ void SemanticAnalyzer::visitCompileConstant(const CompileConstantPtr& node)
 
 
 
+/*!
+ * A generic function referenced by a function type is specialized by it, e.g. let f : (Int) -> Int = identity
+ */
+static FunctionSymbolPtr specializeByContext(SymbolRegistry* registry, const FunctionSymbolPtr& func, const TypePtr& contextualType)
+{
+    GenericDefinitionPtr generic = func->getType()->getGenericDefinition();
+    if(!generic || !contextualType || contextualType->getCategory() != Type::Function)
+        return func;
+    map<wstring, TypePtr> genericTypes;
+    if(!func->getType()->canSpecializeTo(contextualType, genericTypes) || genericTypes.size() != generic->numParameters())
+        return func;
+    GenericArgumentPtr genericArguments(new GenericArgument(generic));
+    for(const GenericDefinition::Parameter& param : generic->getParameters())
+    {
+        TypePtr expectedType;
+        if(!generic->validate(param.name, genericTypes[param.name], expectedType))
+            return func;
+        genericArguments->add(genericTypes[param.name]);
+    }
+    FunctionSymbolPtr specialized = FunctionSymbol::getSpecialization(func, genericArguments);
+    //the identifier only references it weakly, the file being compiled owns it
+    SymbolScope* scope = registry->getFileScope();
+    (scope ? scope : registry->getCurrentScope())->addSpecialization(specialized);
+    return specialized;
+}
+
+/*!
+ * Returns the type of a function reference, a specialized function is referenced as a non-generic function
+ */
+static TypePtr getReferenceType(const FunctionSymbolPtr& func)
+{
+    TypePtr type = func->getType();
+    if(!func->getGenericFunction())
+        return type;
+    return Type::newFunction(type->getParameters(), type->getReturnType(), type->hasVariadicParameters());
+}
+
 void SemanticAnalyzer::visitIdentifier(const IdentifierPtr& id)
 {
     SymbolPtr sym = NULL;
@@ -396,6 +505,7 @@ void SemanticAnalyzer::visitIdentifier(const IdentifierPtr& id)
         error(id, Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, id->getIdentifier());
         return;
     }
+    id->setReferencedSymbol(sym);
     if(SymbolPlaceHolderPtr placeholder = std::dynamic_pointer_cast<SymbolPlaceHolder>(sym))
     {
         if(placeholder->hasFlags(SymbolFlagInitializing))
@@ -425,11 +535,37 @@ void SemanticAnalyzer::visitIdentifier(const IdentifierPtr& id)
     }
     else if(FunctionSymbolPtr func = dynamic_pointer_cast<FunctionSymbol>(sym))
     {
-        id->setType(func->getType());
+        //the callee of a function call is specialized by the call's arguments
+        FunctionCallPtr call = dynamic_pointer_cast<FunctionCall>(id->getParentNode());
+        if(!call || call->getFunction() != id)
+        {
+            func = specializeByContext(symbolRegistry, func, ctx.contextualType);
+            id->setReferencedSymbol(func);
+        }
+        id->setType(getReferenceType(func));
     }
-    else if(FunctionOverloadedSymbolPtr func = dynamic_pointer_cast<FunctionOverloadedSymbol>(sym))
+    else if(FunctionOverloadedSymbolPtr funcs = dynamic_pointer_cast<FunctionOverloadedSymbol>(sym))
     {
-        //TODO: check contextual type hint
-        //error(id, Errors::E_AMBIGUOUS_USE_1, id->getIdentifier());
+        //the callee of a function call is resolved by the call's arguments
+        FunctionCallPtr call = dynamic_pointer_cast<FunctionCall>(id->getParentNode());
+        if(call && call->getFunction() == id)
+            return;
+        //otherwise it references the overload of the contextual type
+        bool functionContext = ctx.contextualType && ctx.contextualType->getCategory() == Type::Function;
+        FunctionSymbolPtr func;
+        if(functionContext)
+            func = funcs->lookupByType(ctx.contextualType);
+        if(!func && funcs->numOverloads() == 1)
+            func = specializeByContext(symbolRegistry, *funcs->begin(), ctx.contextualType);
+        if(!func && !functionContext)
+        {
+            error(id, Errors::E_AMBIGUOUS_USE_1, id->getIdentifier());
+            return;
+        }
+        //none matches the contextual type, the mismatch is reported by the one who checks the type
+        if(!func)
+            func = *funcs->begin();
+        id->setReferencedSymbol(func);
+        id->setType(getReferenceType(func));
     }
 }
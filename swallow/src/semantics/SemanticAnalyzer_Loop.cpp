@@ -98,17 +98,21 @@ void SemanticAnalyzer::visitForLoop(const ForLoopPtr& node)
         //condition and step expression should be evaluated under for statement's scope
         ScopeGuard guard(codeBlock.get(), this);
 
-        //check condition
-        node->getCondition()->accept(this);
-        GlobalScope *global = symbolRegistry->getGlobalScope();
-        TypePtr conditionType = node->getCondition()->getType();
-        if (!conditionType->conformTo(global->BooleanType()))
+        //check condition, an omitted condition loops forever
+        if(node->getCondition())
         {
-            error(node->getCondition(), Errors::E_TYPE_DOES_NOT_CONFORM_TO_PROTOCOL_2_, conditionType->toString(), L"BooleanType");
-            return;
+            node->getCondition()->accept(this);
+            GlobalScope *global = symbolRegistry->getGlobalScope();
+            TypePtr conditionType = node->getCondition()->getType();
+            if (!conditionType->conformTo(global->BooleanType()))
+            {
+                error(node->getCondition(), Errors::E_TYPE_DOES_NOT_CONFORM_TO_PROTOCOL_2_, conditionType->toString(), L"BooleanType");
+                return;
+            }
         }
         //visit step expressions
-        node->getStep()->accept(this);
+        if(node->getStep())
+            node->getStep()->accept(this);
     }
     //visit code block
     node->getCodeBlock()->accept(this);
@@ -51,9 +51,53 @@ using namespace std;
 
 
 
-void SemanticAnalyzer::visitConditionalOperator(const ConditionalOperatorPtr& node)
+/*!
+ * An operator on literals is a literal too if it returns the type of its operands, e.g. 1 + 2,
+ * so its type can be inferred from the contextual type later.
+ */
+static LiteralKind::T getOperatorLiteralKind(const ExpressionPtr& node, const ParenthesizedExpressionPtr& args)
 {
+    LiteralKind::T kind = LiteralKind::None;
+    for(const ParenthesizedExpression::Term& argument : *args)
+    {
+        ExpressionPtr operand = argument.transformedExpression;
+        if(!operand || operand->getLiteralKind() == LiteralKind::None || !Type::equals(operand->getType(), node->getType()))
+            return LiteralKind::None;
+        kind = std::max(kind, operand->getLiteralKind());
+    }
+    return kind;
+}
 
+void SemanticAnalyzer::visitConditionalOperator(const ConditionalOperatorPtr& node)
+{
+    GlobalScope* global = symbolRegistry->getGlobalScope();
+    if(ExpressionPtr condition = dynamic_pointer_cast<Expression>(node->getCondition()))
+        node->setCondition(transformExpression(global->Bool(), condition));
+    else
+        node->getCondition()->accept(this);
+    TypePtr conditionType = node->getCondition()->getType();
+    assert(conditionType != nullptr);
+    if(!conditionType->conformTo(global->BooleanType()))
+    {
+        error(node->getCondition(), Errors::E_TYPE_DOES_NOT_CONFORM_TO_PROTOCOL_2_, conditionType->toString(), L"BooleanType");
+        abort();
+    }
+    //both branches are evaluated with the contextual type of the whole expression
+    TypePtr contextualType = ctx.contextualType;
+    node->setTrueExpression(transformExpression(contextualType, node->getTrueExpression()));
+    node->setFalseExpression(transformExpression(contextualType, node->getFalseExpression()));
+    TypePtr trueType = node->getTrueExpression()->getType();
+    TypePtr falseType = node->getFalseExpression()->getType();
+    assert(trueType != nullptr && falseType != nullptr);
+    if(falseType->canAssignTo(trueType))
+        node->setType(trueType);
+    else if(trueType->canAssignTo(falseType))
+        node->setType(falseType);
+    else
+    {
+        error(node->getFalseExpression(), Errors::E_A_IS_NOT_CONVERTIBLE_TO_B_2, falseType->toString(), trueType->toString());
+        abort();
+    }
 }
 void SemanticAnalyzer::visitBinaryOperator(const BinaryOperatorPtr& node)
 {
@@ -83,10 +127,11 @@ void SemanticAnalyzer::visitBinaryOperator(const BinaryOperatorPtr& node)
     assert(lhs != nullptr);
     assert(rhs != nullptr);
     ParenthesizedExpressionPtr args(node->getNodeFactory()->createParenthesizedExpression(*node->getSourceInfo()));
-    args->append(lhs);
-    args->append(rhs);
+    args->borrow(lhs);
+    args->borrow(rhs);
+    analyzeArguments(args);
     visitFunctionCall(false, funcs, args, node);
-    //find for overload
+    node->setLiteralKind(getOperatorLiteralKind(node, args));
 }
 void SemanticAnalyzer::visitUnaryOperator(const UnaryOperatorPtr& node)
 {
@@ -106,8 +151,48 @@ void SemanticAnalyzer::visitUnaryOperator(const UnaryOperatorPtr& node)
         return;
     }
     ParenthesizedExpressionPtr args(node->getNodeFactory()->createParenthesizedExpression(*node->getSourceInfo()));
-    args->append(node->getOperand());
+    args->borrow(node->getOperand());
+    analyzeArguments(args);
+    visitFunctionCall(false, funcs, args, node);
+    node->setLiteralKind(getOperatorLiteralKind(node, args));
+}
+
+void SemanticAnalyzer::inferOperatorType(const ExpressionPtr& node, const TypePtr& type)
+{
+    wstring name;
+    int mask = 0;
+    ParenthesizedExpressionPtr args(node->getNodeFactory()->createParenthesizedExpression(*node->getSourceInfo()));
+    if(node->getNodeType() == NodeType::BinaryOperator)
+    {
+        BinaryOperatorPtr op = static_pointer_cast<BinaryOperator>(node);
+        name = op->getOperator();
+        args->borrow(static_pointer_cast<Expression>(op->getLHS()));
+        args->borrow(static_pointer_cast<Expression>(op->getRHS()));
+    }
+    else
+    {
+        UnaryOperatorPtr op = static_pointer_cast<UnaryOperator>(node);
+        name = op->getOperator();
+        mask = op->getOperatorType() == OperatorType::PostfixUnary ? SymbolFlagPostfix : SymbolFlagPrefix;
+        args->borrow(op->getOperand());
+    }
+    //the operands were analyzed with the operator, they are reused as they are
+    for(int i = 0; i < (int)args->numExpressions(); i++)
+        args->setTransformedExpression(i, args->get(i));
+    vector<SymbolPtr> funcs;
+    for(const SymbolPtr& func : allFunctions(name, mask, true))
+    {
+        SymbolPtr candidate = func;
+        TypePtr funcType = func->getType();
+        if(!funcType || funcType->getCategory() != Type::Function || !Type::equals(funcType->getReturnType(), type))
+            continue;
+        if(calculateFitScore(false, candidate, args, true) > 0)
+            funcs.push_back(func);
+    }
+    if(funcs.empty())
+        return;
     visitFunctionCall(false, funcs, args, node);
+    node->setLiteralKind(getOperatorLiteralKind(node, args));
 }
 
 
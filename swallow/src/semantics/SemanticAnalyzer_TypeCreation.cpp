@@ -41,6 +41,7 @@
 #include "ast/NodeFactory.h"
 #include "common/ScopedValue.h"
 #include "semantics/DeclarationAnalyzer.h"
+#include "common/CompilerStats.h"
 
 USE_SWALLOW_NS
 using namespace std;
@@ -48,6 +49,7 @@ using namespace std;
 
 void SemanticAnalyzer::visitTypeAlias(const TypeAliasPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitEnum(const EnumDefPtr& node)
@@ -58,6 +60,7 @@ void SemanticAnalyzer::visitEnum(const EnumDefPtr& node)
         delayDeclare(node);
         return;
     }
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitClass(const ClassDefPtr& node)
@@ -68,6 +71,7 @@ void SemanticAnalyzer::visitClass(const ClassDefPtr& node)
         delayDeclare(node);
         return;
     }
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitStruct(const StructDefPtr& node)
@@ -78,6 +82,7 @@ void SemanticAnalyzer::visitStruct(const StructDefPtr& node)
         delayDeclare(node);
         return;
     }
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitProtocol(const ProtocolDefPtr& node)
@@ -88,10 +93,12 @@ void SemanticAnalyzer::visitProtocol(const ProtocolDefPtr& node)
         delayDeclare(node);
         return;
     }
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitExtension(const ExtensionDefPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     node->accept(declarationAnalyzer);
 }
 void SemanticAnalyzer::visitOptionalType(const OptionalTypePtr& node)
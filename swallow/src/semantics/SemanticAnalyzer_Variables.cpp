@@ -31,6 +31,7 @@
 #include "ast/ast.h"
 #include <cassert>
 #include "semantics/DeclarationAnalyzer.h"
+#include "common/CompilerStats.h"
 
 USE_SWALLOW_NS
 using namespace std;
@@ -38,11 +39,13 @@ using namespace std;
 
 void SemanticAnalyzer::visitValueBinding(const ValueBindingPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     declarationAnalyzer->visitValueBinding(node);
 }
 
 
 void SemanticAnalyzer::visitValueBindings(const ValueBindingsPtr& node)
 {
+    PhaseTimer timer(CompilerPhase::DeclarationAnalysis);
     declarationAnalyzer->visitValueBindings(node);
 }
@@ -38,7 +38,7 @@
 using namespace Swallow;
 
 SymbolRegistry::SymbolRegistry()
-:currentScope(nullptr), fileScope(nullptr)
+:currentScope(nullptr), fileScope(nullptr), sharedGlobalScope(false)
 {
     globalScope = new GlobalScope();
     globalScope->initRuntime(this);
@@ -48,9 +48,18 @@ SymbolRegistry::SymbolRegistry()
     //Register built-in type
 
 }
+SymbolRegistry::SymbolRegistry(GlobalScope* globalScope)
+:currentScope(nullptr), globalScope(globalScope), fileScope(nullptr), sharedGlobalScope(true)
+{
+    assert(globalScope != nullptr);
+    //the global scope's parent is already nullptr, do not use enterScope here to avoid writing to a shared scope
+    scopes.push(currentScope);
+    currentScope = globalScope;
+}
 SymbolRegistry::~SymbolRegistry()
 {
-    delete globalScope;
+    if(!sharedGlobalScope)
+        delete globalScope;
 }
 
 bool SymbolRegistry::registerOperator(const std::wstring& name, OperatorType::T type, Associativity::T associativity, int precedence)
@@ -30,6 +30,7 @@
 #include "semantics/SymbolScope.h"
 #include "semantics/SymbolRegistry.h"
 #include "semantics/Type.h"
+#include "common/CompilerStats.h"
 #include <cassert>
 #include <iostream>
 
@@ -69,6 +70,7 @@ void SymbolScope::removeSymbol(const SymbolPtr& symbol)
 SymbolPtr SymbolScope::lookup(const std::wstring& name)
 {
     assert(!name.empty());
+    CompilerStats::increase(CompilerCounter::ScopeLookups);
     SymbolMap::iterator iter = symbols.find(name);
     if(iter != symbols.end())
         return iter->second;
@@ -97,3 +99,8 @@ void SymbolScope::addExtension(const TypePtr& extension)
     assert(iter == extensions.end());
     extensions.insert(std::make_pair(extension->getName(), extension));
 }
+
+void SymbolScope::addSpecialization(const FunctionSymbolPtr& func)
+{
+    specializations.insert(func);
+}
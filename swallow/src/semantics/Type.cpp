@@ -33,6 +33,7 @@
 #include "semantics/GenericArgument.h"
 #include "semantics/FunctionOverloadedSymbol.h"
 #include "semantics/TypeBuilder.h"
+#include "semantics/TypeCache.h"
 #include <sstream>
 
 USE_SWALLOW_NS
@@ -83,6 +84,17 @@ const TypePtr& Type::getPlaceHolder()
     return placeholder;
 }
 
+/*!
+ * Types created while a TypeCache is active belong to that compilation
+ */
+static TypePtr track(Type* type)
+{
+    TypePtr ret(type);
+    if(TypeCache* cache = TypeCache::current())
+        cache->track(ret);
+    return ret;
+}
+
 TypePtr Type::newType(const std::wstring& name, Category category, const TypeDeclarationPtr& reference, const TypePtr& parentType, const std::vector<TypePtr>& protocols, const GenericDefinitionPtr& generic)
 {
     assert(!name.empty());
@@ -100,12 +112,12 @@ TypePtr Type::newType(const std::wstring& name, Category category, const TypeDec
     }
     if(parentType)
         ret->inheritantDepth = parentType->inheritantDepth + 1;
-    return TypePtr(ret);
+    return track(ret);
 }
 
 TypePtr Type::newTypeReference(const TypePtr& innerType)
 {
-    TypePtr ret(new TypeBuilder(MetaType));
+    TypePtr ret = track(new TypeBuilder(MetaType));
     ret->innerType = innerType;
     return ret;
 }
@@ -113,7 +125,7 @@ TypePtr Type::newTypeReference(const TypePtr& innerType)
 
 TypePtr Type::newExtension(const TypePtr& innerType)
 {
-    TypePtr ret(new TypeBuilder(Extension));
+    TypePtr ret = track(new TypeBuilder(Extension));
     ret->name = innerType->getName();
     ret->innerType = innerType;
     ret->moduleName = innerType->moduleName;
@@ -123,7 +135,7 @@ TypePtr Type::newProtocolComposition(const std::vector<TypePtr>& types)
 {
     Type* ret = new TypeBuilder(ProtocolComposition);
     ret->protocols = types;
-    return TypePtr(ret);
+    return track(ret);
 
 }
 
@@ -131,7 +143,7 @@ TypePtr Type::newTuple(const std::vector<TypePtr>& types)
 {
     Type* ret = new TypeBuilder(Tuple);
     ret->elementTypes = types;
-    return TypePtr(ret);
+    return track(ret);
 }
 
 TypePtr Type::newFunction(const std::vector<Parameter>& parameters, const TypePtr& returnType, bool hasVariadicParameters, const GenericDefinitionPtr& generic)
@@ -142,7 +154,7 @@ TypePtr Type::newFunction(const std::vector<Parameter>& parameters, const TypePt
     ret->returnType = returnType;
     ret->variadicParameters = hasVariadicParameters;
     ret->genericDefinition = generic;
-    return TypePtr(ret);
+    return track(ret);
 }
 /*!
  * Gets the common parent class between current class and rhs with the minimum inheritance distance.
@@ -666,7 +678,10 @@ int Type::compare(const TypePtr &lhs, const TypePtr &rhs)
                 return result;
             if(!::compare(lhs->name, rhs->name, result))
                 return result;
-            assert(lhs->getReference() == rhs->getReference());
+            //same-named declarations from different compilations sharing the
+            //same global scope(e.g. BatchCompiler) are distinct types
+            if(lhs->getReference() != rhs->getReference())
+                return lhs->getReference() < rhs->getReference() ? -1 : 1;
             assert(isGenericDefinitionEquals(lhs->genericDefinition, rhs->genericDefinition));
             return 0;
         case Alias:
@@ -234,6 +234,29 @@ void TypeBuilder::addEnumCase(const std::wstring &name, const TypePtr &associate
     EnumCase c = {name, associatedType, constructor};
     enumCases.insert(make_pair(name, c));
 }
+void TypeBuilder::releaseReferences()
+{
+    declaringType = nullptr;
+    genericDefinition = nullptr;
+    specializations.clear();
+    innerType = nullptr;
+    genericArguments = nullptr;
+    enumCases.clear();
+    returnType = nullptr;
+    parameters.clear();
+    elementTypes.clear();
+    parentType = nullptr;
+    protocols.clear();
+    parents.clear();
+    members.clear();
+    staticMembers.clear();
+    storedProperties.clear();
+    computedProperties.clear();
+    associatedTypes.clear();
+    functions.clear();
+    subscripts.clear();
+    deinit = nullptr;
+}
 /*!
  * Add a subscript to this type
  */
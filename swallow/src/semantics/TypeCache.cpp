@@ -0,0 +1,72 @@
+/* TypeCache.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "semantics/TypeCache.h"
+#include "semantics/TypeBuilder.h"
+#include "semantics/GenericArgument.h"
+
+USE_SWALLOW_NS
+using namespace std;
+
+thread_local TypeCache* TypeCache::active = nullptr;
+
+TypeCache::~TypeCache()
+{
+    clear();
+}
+
+TypePtr TypeCache::getSpecializedType(const TypePtr& type, const GenericArgumentPtr& arguments) const
+{
+    auto iter = specializations.find(make_pair(type.get(), GenericArgumentKey(arguments)));
+    if(iter == specializations.end())
+        return nullptr;
+    return iter->second.specialized;
+}
+
+void TypeCache::addSpecializedType(const TypePtr& type, const GenericArgumentPtr& arguments, const TypePtr& specialized)
+{
+    Entry entry = {type, specialized};
+    specializations.insert(make_pair(make_pair(type.get(), GenericArgumentKey(arguments)), entry));
+}
+
+void TypeCache::track(const TypePtr& type)
+{
+    types.push_back(type);
+}
+
+void TypeCache::clear()
+{
+    for(const weak_ptr<Type>& t : types)
+    {
+        if(TypePtr type = t.lock())
+            static_pointer_cast<TypeBuilder>(type)->releaseReferences();
+    }
+    types.clear();
+    specializations.clear();
+}
@@ -33,12 +33,46 @@
 #include "semantics/GenericArgument.h"
 #include "semantics/GenericDefinition.h"
 #include "semantics/TypeBuilder.h"
+#include "semantics/TypeCache.h"
+#include "common/CompilerStats.h"
+#include "common/CompilerTrace.h"
 #include <cassert>
+#include <mutex>
 
 USE_SWALLOW_NS
 using namespace std;
 
+/*!
+ * Without an active TypeCache the specializations are cached by the generic types, which can be shared
+ * by multiple registries through a global scope, so creating specialized types is serialized.
+ */
+static recursive_mutex specializationLock;
+
 static FunctionSymbolPtr specialize(const FunctionSymbolPtr& func, const GenericArgumentPtr& arguments);
+
+/*!
+ * Looks up the specialization cached by the generic type, or by the compilation on current thread
+ */
+static TypePtr getSpecializedCache(const TypePtr& type, const GenericArgumentPtr& arguments)
+{
+    TypePtr ret = type->getSpecializedCache(arguments);
+    TypeCache* cache = TypeCache::current();
+    if(!ret && cache)
+        ret = cache->getSpecializedType(type, arguments);
+    return ret;
+}
+
+/*!
+ * A compilation keeps its specializations in its own cache if it has one, the generic type may be shared.
+ */
+static void addSpecializedCache(const TypePtr& type, const GenericArgumentPtr& arguments, const TypePtr& specialized)
+{
+    if(TypeCache* cache = TypeCache::current())
+        cache->addSpecializedType(type, arguments, specialized);
+    else
+        static_pointer_cast<TypeBuilder>(type)->addSpecializedType(arguments, specialized);
+}
+
 static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& arguments)
 {
     assert(type != nullptr);
@@ -47,19 +81,23 @@ static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& argumen
         return type;
 
     //check if the argument was already been specialized before
-    TypePtr ret = type->getSpecializedCache(arguments);
+    TypePtr ret = getSpecializedCache(type, arguments);
     if(ret)
+    {
+        CompilerStats::increase(CompilerCounter::SpecializationCacheHits);
         return ret;
+    }
+    CompilerStats::increase(CompilerCounter::Specializations);
 
     Type::Category category = type->getCategory();
+    if(category == Type::Alias || category == Type::GenericParameter)
+    {
+        TypePtr ret = arguments->get(type->getName());
+        return ret;
+    }
+    TraceEvent event(TraceCategory::Specialization, 0, [&]{ return type->toString();});
     switch(category)
     {
-        case Type::Alias:
-        case Type::GenericParameter:
-        {
-            TypePtr ret = arguments->get(type->getName());
-            return ret;
-        }
         case Type::Function:
         {
             std::vector<Parameter> params;
@@ -70,7 +108,7 @@ static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& argumen
                 params.push_back(Parameter(param.name, param.inout, paramType));
             }
             TypePtr ret = Type::newFunction(params, returnType, type->hasVariadicParameters(), type->getGenericDefinition());
-            static_pointer_cast<TypeBuilder>(type)->addSpecializedType(arguments, ret);
+            addSpecializedCache(type, arguments, ret);
             return ret;
         }
         case Type::Tuple:
@@ -84,7 +122,7 @@ static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& argumen
                 elementTypes.push_back(newType);
             }
             TypePtr ret = Type::newTuple(elementTypes);
-            static_pointer_cast<TypeBuilder>(type)->addSpecializedType(arguments, ret);
+            addSpecializedCache(type, arguments, ret);
             return ret;
         }
         case Type::Class:
@@ -94,7 +132,9 @@ static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& argumen
         {
             TypeBuilder* builder = new TypeBuilder(Type::Specialized);
             TypePtr ret(builder);
-            static_pointer_cast<TypeBuilder>(type)->addSpecializedType(arguments, ret);
+            if(TypeCache* cache = TypeCache::current())
+                cache->track(ret);
+            addSpecializedCache(type, arguments, ret);
             builder->setInnerType(type);
             builder->setGenericArguments(arguments);
 
@@ -154,7 +194,7 @@ static TypePtr specialize(const TypePtr& type, const GenericArgumentPtr& argumen
                 args->add(arg);
             }
             TypePtr ret = Type::newSpecializedType(type->getInnerType(), args);
-            static_pointer_cast<TypeBuilder>(type)->addSpecializedType(arguments, ret);
+            addSpecializedCache(type, arguments, ret);
             return ret;
         }
         default:
@@ -188,6 +228,8 @@ TypePtr Type::newSpecializedType(const TypePtr& innerType, const std::map<std::w
 TypePtr Type::newSpecializedType(const TypePtr& innerType, const GenericArgumentPtr& arguments)
 {
     assert(innerType->containsGenericParameters());
+    PhaseTimer timer(CompilerPhase::Specialization);
+    lock_guard<recursive_mutex> lock(specializationLock);
     return specialize(innerType, arguments);
 }
 TypePtr Type::newSpecializedType(const TypePtr& innerType, const TypePtr& argument)
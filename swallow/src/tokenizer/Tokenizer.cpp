@@ -34,6 +34,7 @@
 #include <wchar.h>
 #include <ctype.h>
 #include "common/Errors.h"
+#include "common/CompilerStats.h"
 using namespace Swallow;
 
 Tokenizer::Tokenizer(const wchar_t* data)
@@ -162,9 +163,9 @@ void Tokenizer::set(const wchar_t* data)
     state.cursor = 0;
     state.hasSpace = false;
     state.inStringExpression = 0;
-    state.line = 1;
-    state.column = 1;
     state.context = TokenizerContextFile;
+    text.clear();
+    strings.clear();
     //copy string
     if(data)
     {
@@ -174,7 +175,7 @@ void Tokenizer::set(const wchar_t* data)
         state.cursor = 0;
         end = this->data + size;
     }
-    memset(positions, 0, sizeof(positions));
+    index.reset(this->data, size);
 }
 Tokenizer::~Tokenizer()
 {
@@ -200,7 +201,10 @@ void Tokenizer::restore(const TokenizerState& state)
  */
 void Tokenizer::restore(const Token& token)
 {
-    this->state = token.state;
+    state.cursor = token.offset;
+    state.hasSpace = false;
+    state.inStringExpression = token.inStringExpression;
+    state.context = token.context;
 }
 
 /*!
@@ -214,8 +218,19 @@ void Tokenizer::setContext(TokenizerContext context)
 void Tokenizer::resetToken(Token& token)
 {
     token.type = TokenType::_;
-    token.token.clear();
-    token.size = 0;
+    token.token = TokenText();
+    text.clear();
+}
+void Tokenizer::append(wchar_t ch)
+{
+    text.push_back(ch);
+}
+/*!
+ * Return the pooled copy of given string, identifiers and keywords repeat a lot so most lookups hit the pool
+ */
+const std::wstring* Tokenizer::intern(const std::wstring& str)
+{
+    return &*strings.insert(str).first;
 }
 bool Tokenizer::peek(wchar_t &ch)
 {
@@ -228,32 +243,12 @@ bool Tokenizer::get(wchar_t &ch)
 {
     if(state.cursor >= (int)size)
         return false;
-    //save line and column
-    int p = (state.cursor << 1) & 0xf;
-    positions[p] = state.line;
-    positions[p | 1] = state.column;
-    
-    
     ch = data[state.cursor++];
-    if(ch == '\n')
-    {
-        //move to next line
-        state.line++;
-        state.column = 1;
-    }
-    else
-    {
-        //move to next column
-        state.column++;
-    }
     return true;
 }
 void Tokenizer::unget()
 {
     state.cursor--;
-    int p = (state.cursor << 1) & 0xf;
-    state.line = positions[p];
-    state.column = positions[p | 1];
 }
 bool Tokenizer::skipSpaces()
 {
@@ -300,7 +295,7 @@ bool Tokenizer::readOperator(Token& token, bool dotOperator, int max)
     bool whiteLeft = hasWhiteLeft(cursor);
     const wchar_t* begin = cursor;
     
-    while(get(ch) && (!max || token.token.size() < (size_t)max))
+    while(get(ch) && (!max || text.size() < (size_t)max))
     {
         bool ret = dotOperator ? isDotOperatorCharacter(ch) : isOperatorCharacter(ch);
         if(!ret)
@@ -308,21 +303,21 @@ bool Tokenizer::readOperator(Token& token, bool dotOperator, int max)
             unget();
             break;
         }
-        if(!token.token.empty() && token.token.back() != '.' && ch == '.')
+        if(!text.empty() && text.back() != '.' && ch == '.')
         {
             //This is a undocumented rule of operator
             //An operator contains dot(.) can not contain other characters.
             unget();
             break;
         }
-        token.append(ch);
+        append(ch);
         if(!whiteLeft && (ch == '?' || ch == '!'))
         {
             //no white before, ?! will be used as syntax sugar operator, only one character
             break;
         }
     }
-    token.operators.type = calculateOperatorType(begin, begin + token.token.size());
+    token.operators.type = calculateOperatorType(begin, begin + text.size());
     return true;
 }
 OperatorType::T Tokenizer::calculateOperatorType(const wchar_t* begin, const wchar_t* end)
@@ -382,11 +377,11 @@ bool Tokenizer::readMultilineComment(Token& token)
             level--;
             if(level == 0)
             {
-                token.token.pop_back();
+                text.pop_back();
                 break;
             }
         }
-        token.append(ch);
+        append(ch);
     }
     
     return true;
@@ -404,7 +399,7 @@ bool Tokenizer::readComment(Token& token)
     {
         if(ch == '\n')
             break;
-        token.append(ch);
+        append(ch);
     }
     return true;
 }
@@ -422,7 +417,7 @@ bool Tokenizer::readString(Token& token)
             break;
         if(ch != '\\')
         {
-            token.append(ch);
+            append(ch);
             continue;
         }
         ch = must_get();
@@ -437,25 +432,25 @@ bool Tokenizer::readString(Token& token)
         switch(ch)
         {
             case '0':
-                token.append('\0');
+                append('\0');
                 break;
             case '\\':
-                token.append('\\');
+                append('\\');
                 break;
             case 't':
-                token.append('\t');
+                append('\t');
                 break;
             case 'n':
-                token.append('\n');
+                append('\n');
                 break;
             case 'r':
-                token.append('\r');
+                append('\r');
                 break;
             case '\"':
-                token.append('\"');
+                append('\"');
                 break;
             case '\'':
-                token.append('\'');
+                append('\'');
                 break;
             case 'U'://escaped-character → \Uhexadecimal-digit hexadecimal-digit hexadecimal-digit hexadecimal-digit hexadecimal-digit hexadecimal-digit hexadecimal-digit hexadecimal-digit”
                 len = 4;  // 8 hexadecimal digits
@@ -478,7 +473,7 @@ bool Tokenizer::readString(Token& token)
                         ch = ch - 'A' + 0xa;
                     r = (r << 4) | ch;
                 }
-                token.append(r);
+                append(r);
                 len = 0;
                 break;
             }
@@ -498,7 +493,7 @@ bool Tokenizer::readNumberLiteral(Token& token, int base, int64_t& out)
             unget();
             break;
         }
-        token.append(ch);
+        append(ch);
         if(ch != '_')
         {
             int digit = to_digit(ch);
@@ -521,7 +516,7 @@ bool Tokenizer::readFraction(Token& token, int base, double& out)
             unget();
             break;
         }
-        token.append(ch);
+        append(ch);
         if(ch != '_')
         {
             int digit = to_digit(ch);
@@ -537,9 +532,6 @@ bool Tokenizer::readNumber(Token& token)
     
     token.number.base = 10;
     token.number.sign = false;
-    token.number.exponent = 0;
-    token.number.fraction = 0;
-    token.number.dvalue = 0;
     token.number.value = 0;
     token.type = TokenType::Integer;
     int64_t val = 0, exponent = 0;
@@ -548,14 +540,14 @@ bool Tokenizer::readNumber(Token& token)
     int sign = 1;
     if(ch == '+' || ch == '-')
     {
-        token.append(ch);
+        append(ch);
         if(ch == '-')
             sign = -1;
         ch = must_get();
         token.number.sign = true;
 
     }
-    token.append(ch);
+    append(ch);
     if(check_digit(base, ch))
         val = to_digit(ch);
     
@@ -563,9 +555,9 @@ bool Tokenizer::readNumber(Token& token)
         goto done;
     switch(ch)
     {
-        case 'b': base = 2; token.append(must_get()); break;
-        case 'o': base = 8; token.append(must_get()); break;
-        case 'x': base = 16; token.append(must_get()); break;
+        case 'b': base = 2; append(must_get()); break;
+        case 'o': base = 8; append(must_get()); break;
+        case 'x': base = 16; append(must_get()); break;
         case '.': break;
         default: if(!isdigit(ch) && ch != '_' && ch != 'e') goto done;
     }
@@ -582,7 +574,7 @@ bool Tokenizer::readNumber(Token& token)
         }
         
         token.type = TokenType::Float;
-        token.append(dot);
+        append(dot);
         readFraction(token, base, fract);
     }
     if(peek(ch))
@@ -590,30 +582,24 @@ bool Tokenizer::readNumber(Token& token)
         if(base == 10 && ch == 'e')
         {
             token.type = TokenType::Float;
-            token.append(must_get());
+            append(must_get());
             readNumberLiteral(token, base, exponent);
-            token.number.exponent = true;
         }
         else if(base == 16 && ch == 'p')
         {
             token.type = TokenType::Float;
-            token.append(must_get());
+            append(must_get());
             readNumberLiteral(token, base, exponent);
-            token.number.exponent = true;
         }
     }
 
     done:
 
-    token.number.exponent = (int)exponent;
-    token.number.base = base;
-    token.number.fraction = fract;
-    token.number.sign = sign;
+    token.number.base = (unsigned char)base;
 
     if(token.type == TokenType::Integer)
     {
         token.number.value = sign * val;
-        token.number.dvalue = token.number.value;
     }
     else if(token.type == TokenType::Float)
     {
@@ -626,7 +612,6 @@ bool Tokenizer::readNumber(Token& token)
         }
         dval *= sign;
         token.number.dvalue = dval;
-        token.number.value = (int64_t)dval;
     }
 
 
@@ -644,9 +629,9 @@ bool Tokenizer::readIdentifier(Token& token)
     if(ch == '$')
     {
         //implicit-parameter-name -> $ decimal-digits
-        token.append(ch);
+        append(ch);
         ch = must_get();
-        token.append(ch);
+        append(ch);
         if(isdigit(ch))
         {
             while (get(ch))
@@ -656,7 +641,7 @@ bool Tokenizer::readIdentifier(Token& token)
                     unget();
                     break;
                 }
-                token.append(ch);
+                append(ch);
             }
             token.identifier.implicitParameterName = true;
             return true;
@@ -665,7 +650,7 @@ bool Tokenizer::readIdentifier(Token& token)
     else if(ch == '`')
         token.identifier.backtick = true;
     else
-        token.append(ch);
+        append(ch);
     while(get(ch))
     {
         if(!isIdentifierCharacter(ch))
@@ -673,7 +658,7 @@ bool Tokenizer::readIdentifier(Token& token)
             unget();
             break;
         }
-        token.append(ch);
+        append(ch);
     }
     if(token.identifier.backtick)
     {
@@ -682,7 +667,7 @@ bool Tokenizer::readIdentifier(Token& token)
     if(!token.identifier.backtick && !token.identifier.implicitParameterName)
     {
         //resolve keyword
-        KeywordInfo* keyword = getKeyword(token.token);
+        KeywordInfo* keyword = getKeyword(text);
         if(keyword)
         {
             token.identifier.keyword = keyword->keyword;
@@ -718,8 +703,8 @@ wchar_t Tokenizer::must_get()
 void Tokenizer::error(int errorCode, const std::wstring& str)
 {
     TokenizerError error;
-    error.column = state.column;
-    error.line = state.line;
+    index.getPosition(state.cursor, error.line, error.column);
+    error.cursor = state.cursor;
     error.errorCode = errorCode;
     error.item = str;
     throw error;
@@ -735,7 +720,7 @@ void Tokenizer::match(wchar_t expected)
 }
 bool Tokenizer::readSymbol(Token& token, TokenType::T type)
 {
-    token.append(must_get());
+    append(must_get());
     token.type = type;
     return true;
 }
@@ -748,9 +733,13 @@ bool Tokenizer::peek(Token& token)
 }
 bool Tokenizer::next(Token& token)
 {
+    PhaseTimer timer(CompilerPhase::Tokenize);
+    CompilerStats::increase(CompilerCounter::Tokens);
     resetToken(token);
     skipSpaces();
     bool ret = nextImpl(token);
+    if(!text.empty())
+        token.token = TokenText(intern(text));
     return ret;
 }
 bool Tokenizer::nextImpl(Token& token)
@@ -759,11 +748,15 @@ bool Tokenizer::nextImpl(Token& token)
     if(!peek(ch))
     {
         token.type = TokenType::EndOfFile;
-        token.state = state;
+        token.offset = state.cursor;
+        token.context = state.context;
+        token.inStringExpression = state.inStringExpression;
         return false;
     }
     
-    token.state = state;
+    token.offset = state.cursor;
+    token.context = state.context;
+    token.inStringExpression = state.inStringExpression;
 
     switch(ch)
     {
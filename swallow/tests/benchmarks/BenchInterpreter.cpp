@@ -0,0 +1,218 @@
+/* BenchInterpreter.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "parser/Parser.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+#include "common/SwallowUtils.h"
+#include "semantics/SymbolRegistry.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/ScopedNodeFactory.h"
+#include "semantics/OperatorResolver.h"
+#include "semantics/SemanticAnalyzer.h"
+#include "semantics/Symbol.h"
+#include "interpreter/Evaluator.h"
+#include "interpreter/VirtualMachine.h"
+
+using namespace Swallow;
+using namespace std;
+
+/*!
+ * Micro benchmarks comparing the tree-walking Evaluator with the bytecode VirtualMachine.
+ * Each program stores its answer in a global named result, both engines must agree on it.
+ */
+struct Benchmark
+{
+    const char* name;
+    const wchar_t* code;
+};
+
+static const Benchmark benchmarks[] = {
+    {"fib",
+        L"func fib(n : Int) -> Int {\n"
+        L"    if n < 2 {\n"
+        L"        return n\n"
+        L"    }\n"
+        L"    return fib(n - 1) + fib(n - 2)\n"
+        L"}\n"
+        L"let result = fib(25)\n"},
+    {"loops",
+        L"func loops(n : Int) -> Int {\n"
+        L"    var sum = 0\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        for var j = 0; j < n; j++ {\n"
+        L"            sum = sum + (i ^ j) % 7\n"
+        L"        }\n"
+        L"    }\n"
+        L"    return sum\n"
+        L"}\n"
+        L"let result = loops(1000)\n"},
+    {"array ops",
+        L"func arrays(n : Int) -> Int {\n"
+        L"    var a : [Int] = []\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        a.append(i * 3)\n"
+        L"    }\n"
+        L"    for var i = 1; i < a.count; i++ {\n"
+        L"        a[i] = a[i] + a[i - 1] % 11\n"
+        L"    }\n"
+        L"    var sum = 0\n"
+        L"    while a.count > 0 {\n"
+        L"        sum = sum + a.removeLast()\n"
+        L"    }\n"
+        L"    return sum\n"
+        L"}\n"
+        L"let result = arrays(200000)\n"},
+    {"string interpolation",
+        L"func strings(n : Int) -> Int {\n"
+        L"    var hits = 0\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        let s = \"item \\(i % 100): \\(i * 2)\"\n"
+        L"        if s == \"item 7: 14\" {\n"
+        L"            hits++\n"
+        L"        }\n"
+        L"    }\n"
+        L"    return hits\n"
+        L"}\n"
+        L"let result = strings(100000)\n"},
+    {"class dispatch",
+        L"class Shape {\n"
+        L"    func area() -> Int {\n"
+        L"        return 0\n"
+        L"    }\n"
+        L"}\n"
+        L"class Square : Shape {\n"
+        L"    var side = 3\n"
+        L"    override func area() -> Int {\n"
+        L"        return side * side\n"
+        L"    }\n"
+        L"}\n"
+        L"class Rect : Shape {\n"
+        L"    var width = 2\n"
+        L"    var height = 5\n"
+        L"    override func area() -> Int {\n"
+        L"        return width * height\n"
+        L"    }\n"
+        L"}\n"
+        L"func dispatch(n : Int) -> Int {\n"
+        L"    let shapes : [Shape] = [Shape(), Square(), Rect()]\n"
+        L"    var sum = 0\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        sum = sum + shapes[i % 3].area()\n"
+        L"    }\n"
+        L"    return sum\n"
+        L"}\n"
+        L"let result = dispatch(300000)\n"},
+};
+
+static ScopedProgramPtr analyze(SymbolRegistry& registry, CompilerResults& compilerResults, const wchar_t* code)
+{
+    ScopedNodeFactory nodeFactory;
+    Parser parser(&nodeFactory, &compilerResults);
+    parser.setFileName(L"<bench>");
+    ScopedProgramPtr program = dynamic_pointer_cast<ScopedProgram>(parser.parse(code));
+    if(!program)
+        return nullptr;
+    try
+    {
+        OperatorResolver operatorResolver(&registry, &compilerResults);
+        SemanticAnalyzer analyzer(&registry, &compilerResults);
+        program->accept(&operatorResolver);
+        program->accept(&analyzer);
+    }
+    catch(const Abort&)
+    {
+        return nullptr;
+    }
+    return compilerResults.numResults() == 0 ? program : nullptr;
+}
+
+/*!
+ * Runs the benchmark once on the given engine, returns the elapsed milliseconds or a negative value on failure.
+ */
+template<class Engine, bool (Engine::*Run)(const ScopedProgramPtr&, vector<Value>*)>
+static double measure(const Benchmark& benchmark, wstring& result)
+{
+    SymbolRegistry registry;
+    CompilerResults compilerResults;
+    ScopedProgramPtr program = analyze(registry, compilerResults, benchmark.code);
+    if(!program)
+    {
+        SwallowUtils::dumpCompilerResults(benchmark.code, compilerResults, wcerr);
+        return -1;
+    }
+    Engine engine(&registry, &compilerResults);
+    auto start = chrono::steady_clock::now();
+    bool succeeded = (engine.*Run)(program, nullptr);
+    auto end = chrono::steady_clock::now();
+    if(!succeeded)
+    {
+        SwallowUtils::dumpCompilerResults(benchmark.code, compilerResults, wcerr);
+        return -1;
+    }
+    SymbolPtr sym = program->getScope()->lookup(L"result");
+    Value* value = sym ? engine.getGlobal(sym) : nullptr;
+    result = value ? engine.toString(*value, sym->getType()) : L"";
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 3;
+    if(rounds <= 0)
+        rounds = 1;
+    bool failed = false;
+    printf("%-22s %14s %14s %9s\n", "benchmark", "evaluator(ms)", "vm(ms)", "speedup");
+    for(const Benchmark& benchmark : benchmarks)
+    {
+        double evaluator = 0, vm = 0;
+        wstring expected, actual;
+        for(int i = 0; i < rounds && !failed; i++)
+        {
+            double t1 = measure<Evaluator, &Evaluator::evaluate>(benchmark, expected);
+            double t2 = measure<VirtualMachine, &VirtualMachine::run>(benchmark, actual);
+            if(t1 < 0 || t2 < 0 || expected != actual)
+            {
+                wcerr<<benchmark.name<<L": engines disagree or failed, "<<expected<<L" != "<<actual<<endl;
+                failed = true;
+            }
+            //keep the best round of each engine
+            evaluator = i == 0 || t1 < evaluator ? t1 : evaluator;
+            vm = i == 0 || t2 < vm ? t2 : vm;
+        }
+        if(failed)
+            break;
+        printf("%-22s %14.2f %14.2f %8.1fx\n", benchmark.name, evaluator, vm, evaluator / vm);
+    }
+    return failed ? 1 : 0;
+}
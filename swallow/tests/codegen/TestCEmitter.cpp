@@ -0,0 +1,325 @@
+/* TestCEmitter.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/Errors.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRStackPromotion.h"
+#include "ir/IRARCOptimizer.h"
+#include "codegen/CEmitter.h"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace Swallow;
+using namespace std;
+
+#define EMIT_C(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    IRModule module(L"main"); \
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module); \
+    ASSERT_TRUE(lowering.lower(root)); \
+    stringstream c; \
+    CEmitter emitter(&symbolRegistry, &compilerResults); \
+    bool emitted = emitter.emit(&module, c); \
+    (void)emitted;
+
+#define ASSERT_C_CONTAINS(s) ASSERT_NE(string::npos, c.str().find(s)) << c.str();
+
+/*!
+ * Builds the emitted source with the system C compiler and returns its standard output,
+ * the test is skipped when no C compiler is available.
+ */
+static bool compileAndRun(const string& source, string& output)
+{
+    if(system("cc --version > /dev/null 2>&1") != 0)
+        return false;
+    char dir[] = "/tmp/swallow-cXXXXXX";
+    if(!mkdtemp(dir))
+        return false;
+    string src = string(dir) + "/main.c";
+    string exe = string(dir) + "/main";
+    ofstream(src.c_str()) << source;
+    string cmd = "cc -std=c99 -O2 -o " + exe + " " + src + " -lm";
+    bool ret = system(cmd.c_str()) == 0;
+    if(ret)
+    {
+        FILE* f = popen(exe.c_str(), "r");
+        char buf[256];
+        size_t size;
+        while(f && (size = fread(buf, 1, sizeof(buf), f)) > 0)
+            output.append(buf, size);
+        ret = f && pclose(f) == 0;
+    }
+    unlink(exe.c_str());
+    unlink(src.c_str());
+    rmdir(dir);
+    return ret;
+}
+
+TEST(TestCEmitter, Struct)
+{
+    EMIT_C(L"struct Point {\n"
+           L"    var x : Int\n"
+           L"    var y : Double\n"
+           L"    func sum() -> Double {\n"
+           L"        return y * 2.0\n"
+           L"    }\n"
+           L"}\n"
+           L"let p = Point(x : 1, y : 2.5)\n");
+    ASSERT_TRUE(emitted);
+    ASSERT_C_CONTAINS("struct sw_Point\n{\n    int64_t x;\n    double y;\n};");
+    ASSERT_C_CONTAINS("struct sw_Point _Tv4main1pVS_5Point;");
+    ASSERT_C_CONTAINS("double _TFV4main5Point3sumfS0_FT_Sd(struct sw_Point v0)");
+    ASSERT_C_CONTAINS("int main(int argc, char** argv)");
+}
+
+TEST(TestCEmitter, Enum)
+{
+    EMIT_C(L"enum Shape {\n"
+           L"    case Circle(Int)\n"
+           L"    case Rect(Int, Int)\n"
+           L"    case Empty\n"
+           L"}\n"
+           L"let s = Shape.Rect(3, 4)\n");
+    ASSERT_TRUE(emitted);
+    //cases are numbered by name
+    ASSERT_C_CONTAINS("    uint32_t tag;\n    union\n    {\n        int64_t Circle;\n        struct sw_tuple0 Rect;\n    } payload;\n");
+    ASSERT_C_CONTAINS(".tag = 2;");
+}
+
+TEST(TestCEmitter, Class)
+{
+    EMIT_C(L"class Base {\n"
+           L"    var a : Int = 1\n"
+           L"    func f() -> Int { return a }\n"
+           L"    func g() -> Int { return 2 }\n"
+           L"}\n"
+           L"class Derived : Base {\n"
+           L"    var b : String = \"b\"\n"
+           L"    override func g() -> Int { return 3 }\n"
+           L"    func h() -> Int { return 4 }\n"
+           L"}\n"
+           L"let o : Base = Derived()\n"
+           L"let r = o.g()\n");
+    ASSERT_TRUE(emitted);
+    ASSERT_C_CONTAINS("struct sw_Derived\n{\n    struct sw_Base base;\n    sw_String b;\n};");
+    ASSERT_C_CONTAINS("struct sw_Derived_vtable\n{\n    sw_VTable header;\n"
+                      "    int64_t (*m0_f)(sw_Object* v0);\n"
+                      "    int64_t (*m1_g)(sw_Object* v0);\n"
+                      "    int64_t (*m2_h)(sw_Object* v0);\n};");
+    //override takes the slot of the overridden method
+    ASSERT_C_CONTAINS("static const struct sw_Derived_vtable sw_Derived_vtable = {\n"
+                      "    {sw_Derived_destroy},\n"
+                      "    _TFC4main4Base1ffS0_FT_Si,\n"
+                      "    _TFC4main7Derived1gfS0_FT_Si,\n"
+                      "    _TFC4main7Derived1hfS0_FT_Si\n};");
+    ASSERT_C_CONTAINS("sw_release_String(((struct sw_Derived*)self)->b);");
+    ASSERT_C_CONTAINS("((const struct sw_Base_vtable*)");
+}
+
+TEST(TestCEmitter, Unsupported)
+{
+    //existential containers have no C mapping yet
+    EMIT_C(L"protocol P { func f() -> Int }\n"
+           L"struct S : P { func f() -> Int { return 1 } }\n"
+           L"let p : P = S()\n");
+    ASSERT_FALSE(emitted);
+    ASSERT_ERROR(Errors::E_A_IS_NOT_SUPPORTED_IN_C_CODE_GENERATION_1);
+}
+
+TEST(TestCEmitter, Run)
+{
+    EMIT_C(L"enum Shape {\n"
+           L"    case Circle(Int)\n"
+           L"    case Rect(Int, Int)\n"
+           L"    case Empty\n"
+           L"}\n"
+           L"func area(s : Shape) -> Int {\n"
+           L"    switch s {\n"
+           L"        case .Circle(let r):\n"
+           L"            return 3 * r * r\n"
+           L"        case .Rect(let w, let h):\n"
+           L"            return w * h\n"
+           L"        default:\n"
+           L"            return 0\n"
+           L"    }\n"
+           L"}\n"
+           L"class Animal {\n"
+           L"    var name : String\n"
+           L"    init(name : String) {\n"
+           L"        self.name = name\n"
+           L"    }\n"
+           L"    func sound() -> String {\n"
+           L"        return \"...\"\n"
+           L"    }\n"
+           L"    deinit {\n"
+           L"        println(\"bye \" + name)\n"
+           L"    }\n"
+           L"}\n"
+           L"class Dog : Animal {\n"
+           L"    override func sound() -> String {\n"
+           L"        return \"woof\"\n"
+           L"    }\n"
+           L"}\n"
+           L"func fib(n : Int) -> Int {\n"
+           L"    if n < 2 {\n"
+           L"        return n\n"
+           L"    }\n"
+           L"    return fib(n - 1) + fib(n - 2)\n"
+           L"}\n"
+           L"println(area(Shape.Circle(2)) + area(Shape.Rect(3, 5)) + area(Shape.Empty))\n"
+           L"var a : Animal = Dog(name : \"rex\")\n"
+           L"println(a.name + \" says \" + a.sound())\n"
+           L"a = Animal(name : \"tom\")\n"
+           L"println(fib(20))\n"
+           L"var x : UInt8 = 250\n"
+           L"x = x &+ 10\n"
+           L"if x == 4 {\n"
+           L"    println(\"wrapped\")\n"
+           L"}\n");
+    ASSERT_TRUE(emitted);
+    string output;
+    if(system("cc --version > /dev/null 2>&1") != 0)
+        return;
+    ASSERT_TRUE(compileAndRun(c.str(), output)) << c.str();
+    ASSERT_EQ("27\nrex says woof\nbye rex\n6765\nwrapped\n", output);
+}
+
+TEST(TestCEmitter, RunOptimized)
+{
+    SEMANTIC_ANALYZE(L"class Counter {\n"
+                     L"    var count : Int\n"
+                     L"    init() {\n"
+                     L"        count = 0\n"
+                     L"    }\n"
+                     L"    deinit {\n"
+                     L"        println(\"deinit\")\n"
+                     L"    }\n"
+                     L"}\n"
+                     L"func bump(c : Counter) {\n"
+                     L"    c.count = c.count + 1\n"
+                     L"}\n"
+                     L"func local() -> Int {\n"
+                     L"    let c = Counter()\n"
+                     L"    let d = c\n"
+                     L"    bump(d)\n"
+                     L"    bump(c)\n"
+                     L"    return c.count\n"
+                     L"}\n"
+                     L"func loop() -> Int {\n"
+                     L"    let c = Counter()\n"
+                     L"    var i = 0\n"
+                     L"    while i < 5 {\n"
+                     L"        let d = c\n"
+                     L"        bump(d)\n"
+                     L"        i = i + 1\n"
+                     L"    }\n"
+                     L"    return c.count\n"
+                     L"}\n"
+                     L"var keep = Counter()\n"
+                     L"func escape() {\n"
+                     L"    let c = Counter()\n"
+                     L"    keep = c\n"
+                     L"}\n"
+                     L"println(local())\n"
+                     L"println(loop())\n"
+                     L"escape()\n"
+                     L"println(\"end\")\n");
+    ASSERT_NO_ERRORS();
+    IRModule module(L"main");
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module);
+    ASSERT_TRUE(lowering.lower(root));
+    IRARCOptimizer optimizer(&module);
+    ASSERT_LT(0, optimizer.run());
+    stringstream c;
+    CEmitter emitter(&symbolRegistry, &compilerResults);
+    ASSERT_TRUE(emitter.emit(&module, c));
+    string output;
+    if(system("cc --version > /dev/null 2>&1") != 0)
+        return;
+    ASSERT_TRUE(compileAndRun(c.str(), output)) << c.str();
+    //objects are still released exactly once, and deinitializers run in the same order
+    ASSERT_EQ("deinit\n2\ndeinit\n5\ndeinit\nend\n", output);
+}
+
+TEST(TestCEmitter, RunPromoted)
+{
+    SEMANTIC_ANALYZE(L"class Counter {\n"
+                     L"    var count : Int\n"
+                     L"    init() {\n"
+                     L"        count = 0\n"
+                     L"    }\n"
+                     L"    deinit {\n"
+                     L"        println(\"deinit\")\n"
+                     L"    }\n"
+                     L"}\n"
+                     L"func bump(c : Counter) {\n"
+                     L"    c.count = c.count + 1\n"
+                     L"}\n"
+                     L"func local() -> Int {\n"
+                     L"    let c = Counter()\n"
+                     L"    bump(c)\n"
+                     L"    bump(c)\n"
+                     L"    return c.count\n"
+                     L"}\n"
+                     L"func loop() {\n"
+                     L"    var i = 0\n"
+                     L"    while i < 3 {\n"
+                     L"        let c = Counter()\n"
+                     L"        bump(c)\n"
+                     L"        println(c.count + i)\n"
+                     L"        i = i + 1\n"
+                     L"    }\n"
+                     L"}\n"
+                     L"println(local())\n"
+                     L"loop()\n"
+                     L"println(\"end\")\n");
+    ASSERT_NO_ERRORS();
+    IRModule module(L"main");
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module);
+    ASSERT_TRUE(lowering.lower(root));
+    IRStackPromotion promotion(&module);
+    ASSERT_EQ(2, promotion.run());
+    IRARCOptimizer optimizer(&module);
+    optimizer.run();
+    stringstream c;
+    CEmitter emitter(&symbolRegistry, &compilerResults);
+    ASSERT_TRUE(emitter.emit(&module, c));
+    ASSERT_C_CONTAINS("sw_initObject(&s");
+    string output;
+    if(system("cc --version > /dev/null 2>&1") != 0)
+        return;
+    ASSERT_TRUE(compileAndRun(c.str(), output)) << c.str();
+    //the storage in the frame is reused by each iteration, the deinitializer still runs
+    ASSERT_EQ("deinit\n2\n1\ndeinit\n2\ndeinit\n3\ndeinit\nend\n", output);
+}
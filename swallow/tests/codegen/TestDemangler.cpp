@@ -0,0 +1,137 @@
+/* TestDemangler.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "codegen/NameMangling.h"
+#include "codegen/Demangler.h"
+
+using namespace Swallow;
+using namespace std;
+
+
+TEST(TestDemangler, Variable)
+{
+    Demangler demangler;
+    DemangledSymbol s;
+    ASSERT_TRUE(demangler.demangle("_Tv4main9publicVarSi", s));
+    ASSERT_EQ(DemangledSymbol::Variable, s.kind);
+    ASSERT_EQ(L"main", s.module);
+    ASSERT_EQ(L"publicVar", s.name);
+    ASSERT_EQ(L"Swift.Int", s.type);
+    ASSERT_EQ(L"main.publicVar : Swift.Int", s.toString());
+
+    ASSERT_TRUE(demangler.demangle("_TFV4main6STRUCTgP33_fad58de7366495db4650cfefac2fcd611hSi", s));
+    ASSERT_EQ(1, s.context.size());
+    ASSERT_EQ(L"STRUCT", s.context[0]);
+    ASSERT_EQ('g', s.accessor);
+    ASSERT_TRUE(s.isPrivate);
+    ASSERT_EQ(L"main.STRUCT.h.getter : Swift.Int", s.toString());
+    ASSERT_EQ(L"main.STRUCT.g.didSet : Swift.Int", demangler.demangle("_TFV4main6STRUCTW1gSi"));
+}
+
+TEST(TestDemangler, Function)
+{
+    Demangler demangler;
+    ASSERT_EQ(L"main.test (Swift.UInt8, Swift.UInt16, Swift.UInt32, Swift.UInt64, Swift.UInt) -> ()",
+            demangler.demangle("_TF4main4testFTVSs5UInt8VSs6UInt16VSs6UInt32VSs6UInt64Su_T_"));
+    ASSERT_EQ(L"main.dec (Swift.Int) -> Swift.Int", demangler.demangle("_TF4main3decFSiSi"));
+    ASSERT_EQ(L"main.ENUM.init (main.ENUM.Type)(a : Swift.Int) -> main.ENUM", demangler.demangle("_TFO4main4ENUMcfMS0_FT1aSi_S0_"));
+    ASSERT_EQ(L"main.+++ (Swift.Int, Swift.Bool) -> ()", demangler.demangle("_TF4mainoi3pppFTSiSb_T_"));
+    ASSERT_EQ(L"Swift.Int.asInt (Swift.Int)() -> Swift.Int", demangler.demangle("_TFE4mainSi5asIntfSiFT_Si"));
+    ASSERT_EQ(L"main.OuterClass.Nested.Inner.innerFunc (main.OuterClass.Nested.Inner)() -> ()",
+            demangler.demangle("_TFCCC4main10OuterClass6Nested5Inner9innerFuncfS2_FT_T_"));
+}
+
+TEST(TestDemangler, Substitutions)
+{
+    Demangler demangler;
+    ASSERT_EQ(L"main.test6 (Swift.Int, main.Maybe<main.MyClass>, main.MAYBE<Swift.Int>, main.MAYBE<main.MyClass>, main.MAYBE<main.Maybe<main.MyClass>>) -> ()",
+            demangler.demangle("_TF4main5test6FTSiGOS_5MaybeCS_7MyClass_GOS_5MAYBESi_GS2_S1__GS2_GS0_S1____T_"));
+    ASSERT_EQ(L"main.composition (protocol<Swift.DebugPrintable, Swift.Printable>) -> ()",
+            demangler.demangle("_TF4main11compositionFPSs14DebugPrintableSs9Printable_T_"));
+}
+
+TEST(TestDemangler, Generics)
+{
+    Demangler demangler;
+    ASSERT_EQ(L"main.makeTuple <A, B, C>(A, B, C) -> (A, B, C)", demangler.demangle("_TF4main9makeTupleU____FTQ_Q0_Q1__TQ_Q0_Q1__"));
+    ASSERT_EQ(L"main.constraint <A : Swift.Reflectable, main.MyProtocol, B : Swift.RawRepresentable>(A, B) -> ()",
+            demangler.demangle("_TF4main10constraintUSs11ReflectableS_10MyProtocol_Ss16RawRepresentable__FTQ_Q0__T_"));
+}
+
+TEST(TestDemangler, Invalid)
+{
+    Demangler demangler;
+    DemangledSymbol s;
+    ASSERT_FALSE(demangler.demangle("main", s));
+    ASSERT_FALSE(demangler.demangle("_TF4main3dec", s));
+    ASSERT_FALSE(demangler.demangle("_TF4main3decFSiS9_", s));
+    ASSERT_EQ(L"_TZ", demangler.demangle("_TZ"));
+}
+
+TEST(TestDemangler, Decode)
+{
+    SEMANTIC_ANALYZE(L"struct STRUCT\n"
+            L"{\n"
+            L"    var c : Int { return 5}\n"
+            L"    static var d : Int = 6\n"
+            L"    func foo(a : Int) -> Int { return a }\n"
+            L"    func foo(a : Bool) -> Int { return 1 }\n"
+            L"}\n"
+            L"var a : Int = 3\n"
+            L"func test(a : Int) {}\n"
+            L"func test(a : Bool) {}");
+    ASSERT_NO_ERRORS();
+    TypePtr STRUCT;
+    ASSERT_NOT_NULL(STRUCT = dynamic_pointer_cast<Type>(scope->lookup(L"STRUCT")));
+    mangling.indexScope(scope);
+
+    SymbolPtr s;
+    ASSERT_NOT_NULL(s = mangling.decode(L"_Tv4main1aSi"));
+    ASSERT_EQ(scope->lookup(L"a"), s);
+    ASSERT_NOT_NULL(s = mangling.decode(L"_TF4main4testFSbT_"));
+    ASSERT_EQ(L"test", s->getName());
+    ASSERT_EQ(L"_TF4main4testFSbT_", mangling.encode(s));
+
+    //members are resolved through the demangled declaring type
+    ASSERT_NOT_NULL(s = mangling.decode(L"_TvV4main6STRUCT1dSi"));
+    ASSERT_EQ(STRUCT->getDeclaredStaticMember(L"d"), s);
+    ComputedPropertySymbolPtr c;
+    ASSERT_NOT_NULL(c = dynamic_pointer_cast<ComputedPropertySymbol>(STRUCT->getMember(L"c")));
+    ASSERT_EQ(c->getGetter(), mangling.decode(L"_TFV4main6STRUCTg1cSi"));
+    ASSERT_NOT_NULL(s = mangling.decode(L"_TFV4main6STRUCT3foofS0_FSbSi"));
+    ASSERT_EQ(L"_TFV4main6STRUCT3foofS0_FSbSi", mangling.encode(s));
+
+    ASSERT_NULL(mangling.decode(L"_TF4main7unknownFSbT_"));
+    ASSERT_NULL(mangling.decode(L"_TF4main4testFSdT_"));
+}
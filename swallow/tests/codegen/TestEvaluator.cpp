@@ -0,0 +1,277 @@
+/* TestEvaluator.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/Symbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/Errors.h"
+#include "interpreter/Evaluator.h"
+
+using namespace Swallow;
+using namespace std;
+
+#define EVALUATE(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    Evaluator evaluator(&symbolRegistry, &compilerResults); \
+    vector<Value> results; \
+    bool evaluated = evaluator.evaluate(root, &results); \
+    (void)evaluated;
+
+static wstring valueOf(Evaluator& evaluator, SymbolScope* scope, const wchar_t* name)
+{
+    SymbolPtr sym = scope->lookup(name);
+    Value* value = sym ? evaluator.getGlobal(sym) : nullptr;
+    if(!value)
+        return L"<undefined>";
+    return evaluator.toString(*value, sym->getType());
+}
+
+#define ASSERT_VALUE(name, expected) ASSERT_EQ(wstring(expected), valueOf(evaluator, scope, name));
+
+TEST(TestEvaluator, ValueLayout)
+{
+    ASSERT_EQ(16, sizeof(Value));
+}
+
+TEST(TestEvaluator, Arithmetic)
+{
+    EVALUATE(L"let a = 1 + 2 * 3\n"
+             L"let b = (a - 10) / 2\n"
+             L"let c = 7.0 / 2\n"
+             L"let d = a > 5 && b < 0\n"
+             L"let e = \"x = \\(a), y = \\(c)\"\n"
+             L"let f : UInt8 = 200\n"
+             L"let g = f &+ 100\n"
+             L"a * 2\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"a", L"7");
+    ASSERT_VALUE(L"b", L"-1");
+    ASSERT_VALUE(L"c", L"3.5");
+    ASSERT_VALUE(L"d", L"true");
+    ASSERT_VALUE(L"e", L"\"x = 7, y = 3.5\"");
+    ASSERT_VALUE(L"g", L"44");
+    ASSERT_EQ(8, results.size());
+    ASSERT_EQ(14, results[7].i);
+}
+
+TEST(TestEvaluator, Loop)
+{
+    EVALUATE(L"var sum = 0\n"
+             L"for var i = 0; i < 1000000; i++ {\n"
+             L"    if i % 3 == 0 {\n"
+             L"        continue\n"
+             L"    }\n"
+             L"    sum = sum + i\n"
+             L"}\n"
+             L"var n = 0\n"
+             L"while n < 100 {\n"
+             L"    n++\n"
+             L"    if n == 10 {\n"
+             L"        break\n"
+             L"    }\n"
+             L"}\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"sum", L"333332666667");
+    ASSERT_VALUE(L"n", L"10");
+}
+
+TEST(TestEvaluator, Recursion)
+{
+    EVALUATE(L"func fib(n : Int) -> Int {\n"
+             L"    if n < 2 {\n"
+             L"        return n\n"
+             L"    }\n"
+             L"    return fib(n - 1) + fib(n - 2)\n"
+             L"}\n"
+             L"let f = fib(20)\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"f", L"6765");
+}
+
+TEST(TestEvaluator, Closures)
+{
+    EVALUATE(L"func makeCounter(step : Int) -> () -> Int {\n"
+             L"    var count = 0\n"
+             L"    return {() -> Int in\n"
+             L"        count = count + step\n"
+             L"        return count\n"
+             L"    }\n"
+             L"}\n"
+             L"let counter = makeCounter(3)\n"
+             L"counter()\n"
+             L"let c = counter()\n"
+             L"let other = makeCounter(1)\n"
+             L"let d = other()\n"
+             L"func sum(n : Int) -> Int {\n"
+             L"    var total = 0\n"
+             L"    func add(i : Int) {\n"
+             L"        total = total + i\n"
+             L"        if i < n {\n"
+             L"            add(i + 1)\n"
+             L"        }\n"
+             L"    }\n"
+             L"    add(1)\n"
+             L"    return total\n"
+             L"}\n"
+             L"let s = sum(100)\n"
+             L"let twice = {(x : Int) -> Int in x * 2}\n"
+             L"let t = twice(21)\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"c", L"6");
+    ASSERT_VALUE(L"d", L"1");
+    ASSERT_VALUE(L"s", L"5050");
+    ASSERT_VALUE(L"t", L"42");
+}
+
+TEST(TestEvaluator, Structs)
+{
+    EVALUATE(L"struct Point {\n"
+             L"    var x : Int\n"
+             L"    var y : Int\n"
+             L"    mutating func move(dx : Int) {\n"
+             L"        x = x + dx\n"
+             L"    }\n"
+             L"    var sum : Int {\n"
+             L"        return x + y\n"
+             L"    }\n"
+             L"}\n"
+             L"var a = Point(x : 1, y : 2)\n"
+             L"var b = a\n"
+             L"b.move(10)\n"
+             L"b.y = 5\n"
+             L"let s = b.sum\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"a", L"Point(x: 1, y: 2)");
+    ASSERT_VALUE(L"b", L"Point(x: 11, y: 5)");
+    ASSERT_VALUE(L"s", L"16");
+}
+
+TEST(TestEvaluator, Classes)
+{
+    EVALUATE(L"class Shape {\n"
+             L"    var name : String\n"
+             L"    init(name : String) {\n"
+             L"        self.name = name\n"
+             L"    }\n"
+             L"    func area() -> Double {\n"
+             L"        return 0\n"
+             L"    }\n"
+             L"    func describe() -> String {\n"
+             L"        return \"\\(name): \\(area())\"\n"
+             L"    }\n"
+             L"}\n"
+             L"class Square : Shape {\n"
+             L"    var side : Double = 1\n"
+             L"    init(side : Double) {\n"
+             L"        super.init(name : \"square\")\n"
+             L"        self.side = side\n"
+             L"    }\n"
+             L"    override func area() -> Double {\n"
+             L"        return side * side\n"
+             L"    }\n"
+             L"}\n"
+             L"let shape : Shape = Square(side : 3)\n"
+             L"let d = shape.describe()\n"
+             L"let alias = shape\n"
+             L"alias.name = \"renamed\"\n"
+             L"let n = shape.name\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"d", L"\"square: 9.0\"");
+    ASSERT_VALUE(L"n", L"\"renamed\"");
+}
+
+TEST(TestEvaluator, Enums)
+{
+    EVALUATE(L"enum Shape {\n"
+             L"    case Circle(Double)\n"
+             L"    case Rect(Double, Double)\n"
+             L"    case Empty\n"
+             L"}\n"
+             L"func area(s : Shape) -> Double {\n"
+             L"    switch s {\n"
+             L"        case .Circle(let r):\n"
+             L"            return 3 * r * r\n"
+             L"        case .Rect(let w, let h):\n"
+             L"            return w * h\n"
+             L"        default:\n"
+             L"            return 0\n"
+             L"    }\n"
+             L"}\n"
+             L"let a = area(Shape.Circle(2))\n"
+             L"let b = area(Shape.Rect(2, 3))\n"
+             L"let c = area(Shape.Empty)\n"
+             L"let r = Shape.Rect(1, 2)\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"a", L"12.0");
+    ASSERT_VALUE(L"b", L"6.0");
+    ASSERT_VALUE(L"c", L"0.0");
+    ASSERT_VALUE(L"r", L"Rect(1.0, 2.0)");
+}
+
+TEST(TestEvaluator, Arrays)
+{
+    EVALUATE(L"var a = [1, 2, 3]\n"
+             L"var b = a\n"
+             L"b.append(4)\n"
+             L"b[0] = 10\n"
+             L"var total = 0\n"
+             L"for var i = 0; i < b.count; i++ {\n"
+             L"    total = total + b[i]\n"
+             L"}\n");
+    ASSERT_TRUE(evaluated);
+    ASSERT_VALUE(L"a", L"[1, 2, 3]");
+    ASSERT_VALUE(L"b", L"[10, 2, 3, 4]");
+    ASSERT_VALUE(L"total", L"19");
+}
+
+TEST(TestEvaluator, RuntimeError)
+{
+    EVALUATE(L"var a : Int8 = 100\n"
+             L"a = a + a\n");
+    ASSERT_FALSE(evaluated);
+    ASSERT_ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2);
+    ASSERT_EQ(2, error->line);
+}
+
+TEST(TestEvaluator, IndexOutOfRange)
+{
+    EVALUATE(L"let a = [1, 2]\n"
+             L"let b = a[2]\n");
+    ASSERT_FALSE(evaluated);
+    ASSERT_ERROR(Errors::E_ARRAY_INDEX_OUT_OF_RANGE);
+}
+
+TEST(TestEvaluator, Unsupported)
+{
+    EVALUATE(L"let a = [\"a\" : 1]\n");
+    ASSERT_FALSE(evaluated);
+    ASSERT_ERROR(Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1);
+    ASSERT_EQ(L"dictionary literal", error->items[0]);
+}
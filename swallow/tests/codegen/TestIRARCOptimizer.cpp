@@ -0,0 +1,183 @@
+/* TestIRARCOptimizer.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/Errors.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRPrinter.h"
+#include "ir/IRARCOptimizer.h"
+#include <sstream>
+
+using namespace Swallow;
+using namespace std;
+
+#define OPTIMIZE(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    IRModule module(L"main"); \
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module); \
+    ASSERT_TRUE(lowering.lower(root)); \
+    IRARCOptimizer optimizer(&module); \
+    optimizer.run(); \
+    const ARCStatistics& statistics = optimizer.getStatistics(); \
+    (void)statistics;
+
+/*!
+ * Prints the optimized function of given mangled name
+ */
+static wstring printFunction(IRModule& module, const wchar_t* name)
+{
+    wstringstream out;
+    IRFunction* func = module.getFunction(name);
+    if(func)
+        IRPrinter(out).printFunction(&module, func);
+    return out.str();
+}
+
+#define ASSERT_FUNCTION_CONTAINS(func, s) ASSERT_NE(wstring::npos, func.find(s)) << func;
+#define ASSERT_FUNCTION_NOT_CONTAINS(func, s) ASSERT_EQ(wstring::npos, func.find(s)) << func;
+
+static const wchar_t* Counter = L"class Counter {\n"
+                                L"    var count : Int\n"
+                                L"    init() {\n"
+                                L"        count = 0\n"
+                                L"    }\n"
+                                L"}\n"
+                                L"func bump(c : Counter) {\n"
+                                L"    c.count = c.count + 1\n"
+                                L"}\n";
+
+TEST(TestIRARCOptimizer, GuaranteedParameter)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"func read(c : Counter) -> Int {\n"
+             L"    let d = c\n"
+             L"    return d.count\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4readFCS_7CounterSi");
+    //the parameter outlives the local constant, so the copy is borrowed
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"strong_retain");
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"strong_release");
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"destroy_addr");
+    ASSERT_EQ(0, statistics.finalOperations);
+}
+
+TEST(TestIRARCOptimizer, BorrowedArgument)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"var global = Counter()\n"
+             L"func test() {\n"
+             L"    bump(global)\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4testFT_T_");
+    //global may be released by the callee, the retain around the call is kept
+    ASSERT_FUNCTION_CONTAINS(func, L"strong_retain");
+    ASSERT_FUNCTION_CONTAINS(func, L"strong_release");
+    ASSERT_EQ(0, statistics.borrowedArguments);
+}
+
+TEST(TestIRARCOptimizer, BorrowedLocal)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"var global = Counter()\n"
+             L"func test() {\n"
+             L"    let c = global\n"
+             L"    bump(c)\n"
+             L"    bump(c)\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4testFT_T_");
+    //the local constant keeps the object alive during the calls
+    ASSERT_EQ(2, statistics.borrowedArguments);
+    ASSERT_FUNCTION_CONTAINS(func, L"strong_retain");
+    ASSERT_FUNCTION_CONTAINS(func, L"destroy_addr");
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"strong_release");
+}
+
+TEST(TestIRARCOptimizer, NonEscaping)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"func test() -> Int {\n"
+             L"    let c = Counter()\n"
+             L"    let d = c\n"
+             L"    bump(d)\n"
+             L"    return c.count\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4testFT_Si");
+    ASSERT_EQ(1, statistics.nonEscapingObjects);
+    //only the final destruction that deallocates the object is left
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"strong_retain");
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"strong_release");
+    ASSERT_FUNCTION_CONTAINS(func, L"destroy_addr %3 : $*Counter");
+    ASSERT_FUNCTION_NOT_CONTAINS(func, L"destroy_addr %6");
+}
+
+TEST(TestIRARCOptimizer, Escaping)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"var global = Counter()\n"
+             L"func test() {\n"
+             L"    let c = Counter()\n"
+             L"    global = c\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4testFT_T_");
+    ASSERT_EQ(0, statistics.nonEscapingObjects);
+    ASSERT_FUNCTION_CONTAINS(func, L"strong_retain");
+    ASSERT_FUNCTION_CONTAINS(func, L"destroy_addr %3 : $*Counter");
+}
+
+TEST(TestIRARCOptimizer, HoistRelease)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"func test() -> Int {\n"
+             L"    let c = Counter()\n"
+             L"    let a = c.count\n"
+             L"    let b = a * 2 + 1\n"
+             L"    return b\n"
+             L"}\n");
+    wstring func = printFunction(module, L"_TF4main4testFT_Si");
+    ASSERT_EQ(1, statistics.hoistedReleases);
+    //the object is destroyed right after the last read of it instead of the end of the scope
+    size_t destroy = func.find(L"destroy_addr %3 : $*Counter");
+    size_t mul = func.find(L"builtin \"mul_Int\"");
+    ASSERT_NE(wstring::npos, destroy);
+    ASSERT_LT(destroy, mul) << func;
+}
+
+TEST(TestIRARCOptimizer, Statistics)
+{
+    OPTIMIZE(wstring(Counter) +
+             L"func read(c : Counter) -> Int {\n"
+             L"    let d = c\n"
+             L"    return d.count\n"
+             L"}\n");
+    wstringstream out;
+    optimizer.dumpStatistics(out);
+    ASSERT_NE(wstring::npos, out.str().find(L"reference counting: 4 -> 0 operations")) << out.str();
+    ASSERT_NE(wstring::npos, out.str().find(L"removed pairs: 2")) << out.str();
+}
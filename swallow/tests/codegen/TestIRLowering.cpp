@@ -0,0 +1,200 @@
+/* TestIRLowering.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/Symbol.h"
+#include "semantics/FunctionSymbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/Errors.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRPrinter.h"
+#include <sstream>
+
+using namespace Swallow;
+using namespace std;
+
+#define LOWER(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    IRModule module(L"main"); \
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module); \
+    bool lowered = lowering.lower(root); \
+    (void)lowered; \
+    wstringstream ir; \
+    IRPrinter(ir).print(&module);
+
+#define ASSERT_IR_CONTAINS(s) ASSERT_NE(wstring::npos, ir.str().find(s)) << ir.str();
+
+TEST(TestIRLowering, InstructionLayout)
+{
+    ASSERT_EQ(24, sizeof(IRInstruction));
+}
+
+TEST(TestIRLowering, Arithmetic)
+{
+    LOWER(L"func add(a : Int, b : Int) -> Int {\n"
+          L"    return a + b * 2\n"
+          L"}\n"
+          L"var c = add(1, 2)\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"sil @_TF4main3addFTSiSi_Si : $@thin (Int, Int) -> Int {");
+    ASSERT_IR_CONTAINS(L"builtin \"mul_Int\"(%1 : $Int, %2 : $Int) : $Int");
+    ASSERT_IR_CONTAINS(L"builtin \"add_Int\"(%0 : $Int, %3 : $Int) : $Int");
+    ASSERT_IR_CONTAINS(L"apply %2(%0, %1) : $@thin (Int, Int) -> Int");
+    ASSERT_IR_CONTAINS(L"sil_global @_Tv4main1cSi : $Int");
+}
+
+TEST(TestIRLowering, ControlFlow)
+{
+    LOWER(L"func sum(n : Int) -> Int {\n"
+          L"    var s = 0\n"
+          L"    var i = 0\n"
+          L"    while i < n {\n"
+          L"        if i % 2 == 0 && i > 3 {\n"
+          L"            s = s + i\n"
+          L"        } else {\n"
+          L"            s = s - 1\n"
+          L"        }\n"
+          L"        i++\n"
+          L"    }\n"
+          L"    return s\n"
+          L"}\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"alloc_stack $Int");
+    ASSERT_IR_CONTAINS(L"builtin \"cmp_lt_Int\"");
+    //short-circuit of && merges the result through a block argument
+    ASSERT_IR_CONTAINS(L"bb5(%22 : $Bool):");
+    ASSERT_IR_CONTAINS(L"br bb5(%15 : $Bool)");
+    //i++ is inlined as load/add/store
+    ASSERT_IR_CONTAINS(L"store %36 to %5 : $*Int");
+    ASSERT_IR_CONTAINS(L"dealloc_stack %2 : $*Int");
+    ASSERT_EQ(wstring::npos, ir.str().find(L"function_ref @_TF4main2pp"));
+}
+
+TEST(TestIRLowering, Struct)
+{
+    LOWER(L"struct Point {\n"
+          L"    var x : Int\n"
+          L"    var y : Int\n"
+          L"    mutating func moveBy(dx : Int) {\n"
+          L"        x = x + dx\n"
+          L"    }\n"
+          L"    func length() -> Int {\n"
+          L"        return x * x + y * y\n"
+          L"    }\n"
+          L"}\n"
+          L"var p = Point(x : 1, y : 2)\n"
+          L"p.moveBy(3)\n"
+          L"let l = p.length()\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"$@cc(method) @thin (Int, Int, @thin Point.Type) -> Point");
+    ASSERT_IR_CONTAINS(L"struct_element_addr %3 : $*Point, #Point.y");
+    ASSERT_IR_CONTAINS(L"sil @_TFV4main5Point6moveByfRS0_FMSiT_ : $@cc(method) @thin (Int, @inout Point) -> ()");
+    ASSERT_IR_CONTAINS(L"apply %9(%8, %7) : $@cc(method) @thin (Int, @inout Point) -> ()");
+    ASSERT_IR_CONTAINS(L"struct_extract %0 : $Point, #Point.y");
+}
+
+TEST(TestIRLowering, Class)
+{
+    LOWER(L"class Shape {\n"
+          L"    var name : String\n"
+          L"    init(name : String) {\n"
+          L"        self.name = name\n"
+          L"    }\n"
+          L"    func area() -> Double {\n"
+          L"        return 0.0\n"
+          L"    }\n"
+          L"}\n"
+          L"class Square : Shape {\n"
+          L"    var side : Double = 1.0\n"
+          L"    init() {\n"
+          L"        super.init(name : \"square\")\n"
+          L"    }\n"
+          L"    override func area() -> Double {\n"
+          L"        return side * side\n"
+          L"    }\n"
+          L"}\n"
+          L"let s : Shape = Square()\n"
+          L"let a = s.area()\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"alloc_ref $Square");
+    ASSERT_IR_CONTAINS(L"class_method %6 : $Shape, #Shape.area!1 : $@cc(method) @thin (Shape) -> Double");
+    ASSERT_IR_CONTAINS(L"strong_release %6 : $Shape");
+    ASSERT_IR_CONTAINS(L"ref_element_addr %0 : $Square, #Square.side");
+    //super.init is a direct call
+    ASSERT_IR_CONTAINS(L"function_ref @_TFC4main5ShapecfMS0_FT4nameSS_S0_");
+}
+
+TEST(TestIRLowering, EnumSwitch)
+{
+    LOWER(L"enum Shape {\n"
+          L"    case Circle(Double)\n"
+          L"    case Rect(Double, Double)\n"
+          L"    case Empty\n"
+          L"}\n"
+          L"func area(s : Shape) -> Double {\n"
+          L"    switch s {\n"
+          L"        case .Circle(let r):\n"
+          L"            return 3.14 * r * r\n"
+          L"        case .Rect(let w, let h):\n"
+          L"            return w * h\n"
+          L"        default:\n"
+          L"            return 0.0\n"
+          L"    }\n"
+          L"}\n"
+          L"let a = area(Shape.Rect(1.0, 2.0))\n"
+          L"let b = area(.Empty)\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"enum $Shape, #Shape.Rect!enumelt.1, %2 : $(Double, Double)");
+    ASSERT_IR_CONTAINS(L"enum $Shape, #Shape.Empty!enumelt");
+    ASSERT_IR_CONTAINS(L"switch_enum %0 : $Shape, case #Shape.Circle!enumelt.1: bb1, case #Shape.Rect!enumelt.1: bb2, default bb3");
+    ASSERT_IR_CONTAINS(L"unchecked_enum_data %0 : $Shape, #Shape.Rect!enumelt.1");
+    ASSERT_IR_CONTAINS(L"tuple_extract %12 : $(Double, Double), 1");
+}
+
+TEST(TestIRLowering, Unsupported)
+{
+    LOWER(L"let f = {(a : Int) -> Int in return a}\n");
+    ASSERT_FALSE(lowered);
+    ASSERT_ERROR(Errors::E_A_IS_NOT_SUPPORTED_IN_IR_LOWERING_1);
+    ASSERT_EQ(L"closure", error->items[0]);
+}
+
+TEST(TestIRLowering, GenericApply)
+{
+    LOWER(L"func pick<T>(a : T, b : T) -> T {\n"
+          L"    return a\n"
+          L"}\n"
+          L"let a = pick(1, 2)\n");
+    ASSERT_TRUE(lowered);
+    ASSERT_IR_CONTAINS(L"sil @_TF4main4pickU__FTQ_Q__Q_ : $@thin <T> (T, T) -> T");
+    ASSERT_IR_CONTAINS(L"retain_value %0 : $T");
+    ASSERT_IR_CONTAINS(L"apply %2<Int>(%0, %1) : $@thin <T> (T, T) -> T");
+}
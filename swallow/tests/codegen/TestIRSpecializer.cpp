@@ -0,0 +1,155 @@
+/* TestIRSpecializer.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/Errors.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRPrinter.h"
+#include "ir/IRSpecializer.h"
+#include <sstream>
+
+using namespace Swallow;
+using namespace std;
+
+#define SPECIALIZE(s, policy) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    IRModule module(L"main"); \
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module); \
+    ASSERT_TRUE(lowering.lower(root)); \
+    IRSpecializer specializer(&symbolRegistry, &module); \
+    specializer.setPolicy(policy);
+
+#define PRINT_IR() wstringstream ir; \
+    IRPrinter(ir).print(&module);
+
+#define ASSERT_IR_CONTAINS(s) ASSERT_NE(wstring::npos, ir.str().find(s)) << ir.str();
+#define ASSERT_IR_NOT_CONTAINS(s) ASSERT_EQ(wstring::npos, ir.str().find(s)) << ir.str();
+
+static const wchar_t* Pick = L"func pick<T>(a : T, b : T, first : Bool) -> T {\n"
+                             L"    if first {\n"
+                             L"        return a\n"
+                             L"    }\n"
+                             L"    return b\n"
+                             L"}\n";
+
+TEST(TestIRSpecializer, Always)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"let a = pick(1, 2, true)\n"
+               L"let b = pick(3, 4, false)\n"
+               L"let c = pick(\"a\", \"b\", true)\n", SpecializationPolicy::Always);
+    ASSERT_EQ(2, specializer.run());
+    PRINT_IR();
+    //call sites with identical generic arguments share the specialized copy
+    const SpecializationStatistics& s = specializer.getStatistics();
+    ASSERT_EQ(1, s.genericFunctions);
+    ASSERT_EQ(2, s.instances);
+    ASSERT_EQ(2, s.specializedInstances);
+    ASSERT_EQ(3, s.callSites);
+    ASSERT_EQ(3, s.specializedCallSites);
+    ASSERT_EQ(2, specializer.getInstances()[0].callSites);
+    ASSERT_IR_CONTAINS(L"sil @_TTSg5Si___TF4main4pickU__FTQ_Q_Sb_Q_ : $@thin (Int, Int, Bool) -> Int {");
+    ASSERT_IR_CONTAINS(L"sil @_TTSg5SS___TF4main4pickU__FTQ_Q_Sb_Q_ : $@thin (String, String, Bool) -> String {");
+    ASSERT_IR_CONTAINS(L"function_ref @_TTSg5Si___TF4main4pickU__FTQ_Q_Sb_Q_ : $@thin (Int, Int, Bool) -> Int");
+    ASSERT_IR_NOT_CONTAINS(L"<Int>(");
+    //the generic implementation is kept
+    ASSERT_IR_CONTAINS(L"sil @_TF4main4pickU__FTQ_Q_Sb_Q_ : $@thin <T> (T, T, Bool) -> T {");
+}
+
+TEST(TestIRSpecializer, Never)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"let a = pick(1, 2, true)\n", SpecializationPolicy::Never);
+    ASSERT_EQ(0, specializer.run());
+    PRINT_IR();
+    const SpecializationStatistics& s = specializer.getStatistics();
+    ASSERT_EQ(1, s.instances);
+    ASSERT_EQ(0, s.specializedCallSites);
+    ASSERT_EQ(s.originalSize, s.finalSize);
+    ASSERT_IR_CONTAINS(L"<Int>(");
+    ASSERT_IR_NOT_CONTAINS(L"_TTSg");
+}
+
+TEST(TestIRSpecializer, RefCounting)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"let a = pick(1, 2, true)\n", SpecializationPolicy::Always);
+    ASSERT_EQ(1, specializer.run());
+    PRINT_IR();
+    //retain_value of both returned values are dropped as Int is trivial
+    const SpecializationStatistics& s = specializer.getStatistics();
+    ASSERT_EQ(2, s.removedRefCounting);
+    const SpecializationInstance& instance = specializer.getInstances()[0];
+    ASSERT_EQ(instance.genericSize - 2, instance.specializedSize);
+    ASSERT_EQ(s.originalSize + instance.specializedSize, s.finalSize);
+    ASSERT_IR_NOT_CONTAINS(L"retain_value %0 : $Int");
+}
+
+TEST(TestIRSpecializer, HotOrSmall)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"var i = 0\n"
+               L"while i < 10 {\n"
+               L"    i = pick(i + 1, 0, true)\n"
+               L"}\n"
+               L"let s = pick(\"a\", \"b\", true)\n", SpecializationPolicy::HotOrSmall);
+    //no generic function is small, only the call site inside the loop is hot
+    specializer.setSmallFunctionSize(0);
+    ASSERT_EQ(1, specializer.run());
+    PRINT_IR();
+    const vector<SpecializationInstance>& instances = specializer.getInstances();
+    ASSERT_EQ(2, instances.size());
+    ASSERT_EQ(8, instances[0].hotness);
+    ASSERT_NE(IRSpecializer::InvalidFunction, instances[0].specialized);
+    ASSERT_EQ(1, instances[1].hotness);
+    ASSERT_EQ(IRSpecializer::InvalidFunction, instances[1].specialized);
+    ASSERT_IR_CONTAINS(L"_TTSg5Si___TF4main4pickU__FTQ_Q_Sb_Q_");
+    ASSERT_IR_CONTAINS(L"<String>(");
+}
+
+TEST(TestIRSpecializer, CodeGrowth)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"let a = pick(1, 2, true)\n", SpecializationPolicy::HotOrSmall);
+    specializer.setMaxCodeGrowth(0);
+    ASSERT_EQ(0, specializer.run());
+    ASSERT_EQ(0, specializer.getStatistics().specializedCallSites);
+}
+
+TEST(TestIRSpecializer, Statistics)
+{
+    SPECIALIZE(wstring(Pick) +
+               L"let a = pick(1, 2, true)\n", SpecializationPolicy::Always);
+    specializer.run();
+    wstringstream out;
+    specializer.dumpStatistics(out);
+    ASSERT_NE(wstring::npos, out.str().find(L"generic functions: 1, instances: 1 (1 specialized), call sites: 1 (1 specialized)")) << out.str();
+    ASSERT_NE(wstring::npos, out.str().find(L"_TF4main4pickU__FTQ_Q_Sb_Q_<Int>: call sites 1, hotness 1")) << out.str();
+}
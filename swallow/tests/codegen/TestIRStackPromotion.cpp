@@ -0,0 +1,160 @@
+/* TestIRStackPromotion.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/Errors.h"
+#include "ir/IR.h"
+#include "ir/IRLowering.h"
+#include "ir/IRPrinter.h"
+#include "ir/IRStackPromotion.h"
+#include <sstream>
+
+using namespace Swallow;
+using namespace std;
+
+#define PROMOTE(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    IRModule module(L"main"); \
+    IRLowering lowering(&symbolRegistry, &compilerResults, &module); \
+    ASSERT_TRUE(lowering.lower(root)); \
+    IRStackPromotion promotion(&module); \
+    promotion.run(); \
+    const StackPromotionStatistics& statistics = promotion.getStatistics(); \
+    (void)statistics;
+
+static wstring printFunction(IRModule& module, const wchar_t* name)
+{
+    wstringstream out;
+    IRFunction* func = module.getFunction(name);
+    if(func)
+        IRPrinter(out).printFunction(&module, func);
+    return out.str();
+}
+
+#define ASSERT_FUNCTION_CONTAINS(func, s) ASSERT_NE(wstring::npos, func.find(s)) << func;
+#define ASSERT_FUNCTION_NOT_CONTAINS(func, s) ASSERT_EQ(wstring::npos, func.find(s)) << func;
+
+static const wchar_t* Counter = L"class Counter {\n"
+                                L"    var count : Int\n"
+                                L"    init() {\n"
+                                L"        count = 0\n"
+                                L"    }\n"
+                                L"}\n"
+                                L"func bump(c : Counter) {\n"
+                                L"    c.count = c.count + 1\n"
+                                L"}\n";
+
+TEST(TestIRStackPromotion, LocalObject)
+{
+    PROMOTE(wstring(Counter) +
+            L"func local() -> Int {\n"
+            L"    let c = Counter()\n"
+            L"    let d = c\n"
+            L"    bump(d)\n"
+            L"    return c.count\n"
+            L"}\n");
+    wstring func = printFunction(module, L"_TF4main5localFT_Si");
+    ASSERT_FUNCTION_CONTAINS(func, L"alloc_ref [stack] $Counter");
+    ASSERT_EQ(1, statistics.promoted);
+}
+
+TEST(TestIRStackPromotion, EscapingObject)
+{
+    PROMOTE(wstring(Counter) +
+            L"var keep = Counter()\n"
+            L"func escape() {\n"
+            L"    let c = Counter()\n"
+            L"    keep = c\n"
+            L"}\n"
+            L"func make() -> Counter {\n"
+            L"    return Counter()\n"
+            L"}\n");
+    ASSERT_FUNCTION_NOT_CONTAINS(printFunction(module, L"_TF4main6escapeFT_T_"), L"[stack]");
+    ASSERT_FUNCTION_NOT_CONTAINS(printFunction(module, L"_TF4main4makeFT_CS_7Counter"), L"[stack]");
+    ASSERT_EQ(0, statistics.promoted);
+}
+
+TEST(TestIRStackPromotion, ObjectUsedInLoop)
+{
+    PROMOTE(wstring(Counter) +
+            L"func loop() -> Int {\n"
+            L"    let c = Counter()\n"
+            L"    var i = 0\n"
+            L"    while i < 5 {\n"
+            L"        bump(c)\n"
+            L"        i = i + 1\n"
+            L"    }\n"
+            L"    return c.count\n"
+            L"}\n");
+    //the lifetime doesn't end in the block it's allocated
+    ASSERT_FUNCTION_NOT_CONTAINS(printFunction(module, L"_TF4main4loopFT_Si"), L"[stack]");
+}
+
+TEST(TestIRStackPromotion, EscapingDeinit)
+{
+    PROMOTE(L"class Base {\n"
+            L"}\n"
+            L"class Nest {\n"
+            L"    var item : Base\n"
+            L"    init(item : Base) {\n"
+            L"        self.item = item\n"
+            L"    }\n"
+            L"}\n"
+            L"var nest = Nest(item: Base())\n"
+            L"func save(item : Base) {\n"
+            L"    nest.item = item\n"
+            L"}\n"
+            L"class Phoenix : Base {\n"
+            L"    deinit {\n"
+            L"        save(self)\n"
+            L"    }\n"
+            L"}\n"
+            L"class Child : Phoenix {\n"
+            L"}\n"
+            L"func test() {\n"
+            L"    let c = Child()\n"
+            L"}\n");
+    //the deinitializer of the parent makes the object outlive the frame
+    ASSERT_FUNCTION_NOT_CONTAINS(printFunction(module, L"_TF4main4testFT_T_"), L"[stack]");
+    ASSERT_EQ(0, statistics.promoted);
+    ASSERT_EQ(1, statistics.escapingDeinits);
+}
+
+TEST(TestIRStackPromotion, Statistics)
+{
+    PROMOTE(wstring(Counter) +
+            L"func local() -> Int {\n"
+            L"    let c = Counter()\n"
+            L"    return c.count\n"
+            L"}\n"
+            L"var keep = Counter()\n");
+    wstringstream out;
+    promotion.dumpStatistics(out);
+    ASSERT_EQ(L"stack promotion: 1 of 2 allocations\n", out.str());
+}
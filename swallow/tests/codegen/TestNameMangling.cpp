@@ -38,6 +38,7 @@
 #include "semantics/GenericArgument.h"
 #include "semantics/FunctionOverloadedSymbol.h"
 #include "codegen/NameMangling.h"
+#include <set>
 
 using namespace Swallow;
 using namespace std;
@@ -652,4 +653,39 @@ TEST(TestNameMangling, Extension)
 
     //TODO: test witness function encoding
 
-}
\ No newline at end of file
+}
+TEST(TestNameMangling, NarrowBuffer)
+{
+    SEMANTIC_ANALYZE(L"private var privateVar : Int = 5\n"
+            L"private var privateVar2 : Int = 6");
+    ASSERT_NO_ERRORS();
+    string buffer;
+    SymbolPtr sym;
+    ASSERT_NOT_NULL(sym = scope->lookup(L"privateVar"));
+    ASSERT_TRUE(mangling.encode(sym, buffer));
+    ASSERT_EQ("_Tv4mainP33_fad58de7366495db4650cfefac2fcd6110privateVarSi", buffer);
+    //the discriminator is reused from the cache
+    ASSERT_NOT_NULL(sym = scope->lookup(L"privateVar2"));
+    ASSERT_TRUE(mangling.encode(sym, buffer));
+    ASSERT_EQ("_Tv4mainP33_fad58de7366495db4650cfefac2fcd6111privateVar2Si", buffer);
+}
+
+TEST(TestNameMangling, EncodeAll)
+{
+    SEMANTIC_ANALYZE(L"struct MyStruct {}\n"
+            L"var a : MyStruct = MyStruct()\n"
+            L"func test(a : MyStruct) {}\n"
+            L"func test(a : MyStruct, b : MyStruct) {}\n"
+            L"var b : Int { return 3}");
+    ASSERT_NO_ERRORS();
+    vector<pair<SymbolPtr, string> > names;
+    mangling.encodeAll(scope, names);
+    ASSERT_EQ(4, names.size());
+    set<string> s;
+    for(auto entry : names)
+        s.insert(entry.second);
+    ASSERT_EQ(1, s.count("_Tv4main1aVS_8MyStruct"));
+    ASSERT_EQ(1, s.count("_TF4main4testFVS_8MyStructT_"));
+    ASSERT_EQ(1, s.count("_TF4main4testFTVS_8MyStructS0__T_"));
+    ASSERT_EQ(1, s.count("_TF4maing1bSi"));
+}
@@ -0,0 +1,315 @@
+/* TestVirtualMachine.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/Symbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/Errors.h"
+#include "interpreter/VirtualMachine.h"
+
+using namespace Swallow;
+using namespace std;
+
+#define RUN(s) SEMANTIC_ANALYZE(s); \
+    ASSERT_NO_ERRORS(); \
+    VirtualMachine vm(&symbolRegistry, &compilerResults); \
+    vector<Value> results; \
+    bool succeeded = vm.run(root, &results); \
+    (void)succeeded;
+
+static wstring valueOf(VirtualMachine& vm, SymbolScope* scope, const wchar_t* name)
+{
+    SymbolPtr sym = scope->lookup(name);
+    Value* value = sym ? vm.getGlobal(sym) : nullptr;
+    if(!value)
+        return L"<undefined>";
+    return vm.toString(*value, sym->getType());
+}
+
+#define ASSERT_VALUE(name, expected) ASSERT_EQ(wstring(expected), valueOf(vm, scope, name));
+
+TEST(TestVirtualMachine, InstructionLayout)
+{
+    ASSERT_EQ(8, sizeof(BCInstruction));
+}
+
+TEST(TestVirtualMachine, Arithmetic)
+{
+    RUN(L"let a = 1 + 2 * 3\n"
+        L"let b = (a - 10) / 2\n"
+        L"let c = 7.0 / 2\n"
+        L"let d = a > 5 && b < 0\n"
+        L"let e = \"x = \\(a), y = \\(c)\"\n"
+        L"let f : UInt8 = 200\n"
+        L"let g = f &+ 100\n"
+        L"let h = f % 7\n"
+        L"a * 2\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"a", L"7");
+    ASSERT_VALUE(L"b", L"-1");
+    ASSERT_VALUE(L"c", L"3.5");
+    ASSERT_VALUE(L"d", L"true");
+    ASSERT_VALUE(L"e", L"\"x = 7, y = 3.5\"");
+    ASSERT_VALUE(L"g", L"44");
+    ASSERT_VALUE(L"h", L"4");
+    ASSERT_EQ(9, results.size());
+    ASSERT_EQ(14, results[8].i);
+}
+
+TEST(TestVirtualMachine, Loop)
+{
+    RUN(L"func count(n : Int) -> Int {\n"
+        L"    var sum = 0\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        if i % 3 == 0 {\n"
+        L"            continue\n"
+        L"        }\n"
+        L"        sum = sum + i\n"
+        L"    }\n"
+        L"    var k = 0\n"
+        L"    while k < 100 {\n"
+        L"        k++\n"
+        L"        if k == 10 {\n"
+        L"            break\n"
+        L"        }\n"
+        L"    }\n"
+        L"    return sum + k\n"
+        L"}\n"
+        L"let sum = count(1000000)\n"
+        L"var n = 0\n"
+        L"do {\n"
+        L"    n++\n"
+        L"} while n < 5\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"sum", L"333332666677");
+    ASSERT_VALUE(L"n", L"5");
+    //the loop condition is fused into a jump, the counter is updated in place
+    wstring code = vm.disassemble(L"count");
+    ASSERT_NE(wstring::npos, code.find(L"JumpIfNotLtInt"));
+    ASSERT_NE(wstring::npos, code.find(L"AddIntImm"));
+}
+
+TEST(TestVirtualMachine, Recursion)
+{
+    RUN(L"func fib(n : Int) -> Int {\n"
+        L"    if n < 2 {\n"
+        L"        return n\n"
+        L"    }\n"
+        L"    return fib(n - 1) + fib(n - 2)\n"
+        L"}\n"
+        L"let f = fib(20)\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"f", L"6765");
+}
+
+TEST(TestVirtualMachine, Structs)
+{
+    RUN(L"struct Point {\n"
+        L"    var x : Int\n"
+        L"    var y : Int\n"
+        L"    mutating func move(dx : Int) {\n"
+        L"        x = x + dx\n"
+        L"    }\n"
+        L"    var sum : Int {\n"
+        L"        return x + y\n"
+        L"    }\n"
+        L"}\n"
+        L"struct Line {\n"
+        L"    var from = Point(x : 0, y : 0)\n"
+        L"    var to = Point(x : 1, y : 1)\n"
+        L"}\n"
+        L"var a = Point(x : 1, y : 2)\n"
+        L"var b = a\n"
+        L"b.move(10)\n"
+        L"b.y = 5\n"
+        L"let s = b.sum\n"
+        L"var l = Line()\n"
+        L"let m = l\n"
+        L"l.to.x = 7\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"a", L"Point(x: 1, y: 2)");
+    ASSERT_VALUE(L"b", L"Point(x: 11, y: 5)");
+    ASSERT_VALUE(L"s", L"16");
+    ASSERT_VALUE(L"l", L"Line(from: Point(x: 0, y: 0), to: Point(x: 7, y: 1))");
+    ASSERT_VALUE(L"m", L"Line(from: Point(x: 0, y: 0), to: Point(x: 1, y: 1))");
+}
+
+TEST(TestVirtualMachine, Classes)
+{
+    RUN(L"class Shape {\n"
+        L"    var name : String\n"
+        L"    init(name : String) {\n"
+        L"        self.name = name\n"
+        L"    }\n"
+        L"    func area() -> Double {\n"
+        L"        return 0\n"
+        L"    }\n"
+        L"    func describe() -> String {\n"
+        L"        return \"\\(name): \\(area())\"\n"
+        L"    }\n"
+        L"}\n"
+        L"class Square : Shape {\n"
+        L"    var side : Double = 1\n"
+        L"    init(side : Double) {\n"
+        L"        super.init(name : \"square\")\n"
+        L"        self.side = side\n"
+        L"    }\n"
+        L"    override func area() -> Double {\n"
+        L"        return side * side\n"
+        L"    }\n"
+        L"}\n"
+        L"let shape : Shape = Square(side : 3)\n"
+        L"let d = shape.describe()\n"
+        L"let base = Shape(name : \"shape\")\n"
+        L"let e = base.describe()\n"
+        L"let alias = shape\n"
+        L"alias.name = \"renamed\"\n"
+        L"let n = shape.name\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"d", L"\"square: 9.0\"");
+    ASSERT_VALUE(L"e", L"\"shape: 0.0\"");
+    ASSERT_VALUE(L"n", L"\"renamed\"");
+    ASSERT_NE(wstring::npos, vm.disassemble(L"describe").find(L"CallVirtual"));
+}
+
+TEST(TestVirtualMachine, PolymorphicCall)
+{
+    RUN(L"class Shape {\n"
+        L"    func area() -> Int {\n"
+        L"        return 0\n"
+        L"    }\n"
+        L"}\n"
+        L"class Square : Shape {\n"
+        L"    var side = 3\n"
+        L"    override func area() -> Int {\n"
+        L"        return side * side\n"
+        L"    }\n"
+        L"}\n"
+        L"class Rect : Shape {\n"
+        L"    var width = 2\n"
+        L"    var height = 5\n"
+        L"    override func area() -> Int {\n"
+        L"        return width * height\n"
+        L"    }\n"
+        L"}\n"
+        L"func total(n : Int) -> Int {\n"
+        L"    let shapes : [Shape] = [Shape(), Square(), Rect()]\n"
+        L"    var sum = 0\n"
+        L"    for var i = 0; i < n; i++ {\n"
+        L"        sum = sum + shapes[i % 3].area()\n"
+        L"    }\n"
+        L"    return sum\n"
+        L"}\n"
+        L"let t = total(30)\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"t", L"190");
+}
+
+TEST(TestVirtualMachine, Enums)
+{
+    RUN(L"enum Color {\n"
+        L"    case Red, Green, Blue\n"
+        L"}\n"
+        L"func name(c : Color) -> String {\n"
+        L"    switch c {\n"
+        L"        case .Red:\n"
+        L"            return \"red\"\n"
+        L"        case .Green, .Blue:\n"
+        L"            return \"other\"\n"
+        L"        default:\n"
+        L"            return \"unknown\"\n"
+        L"    }\n"
+        L"}\n"
+        L"func grade(score : Int) -> String {\n"
+        L"    switch score {\n"
+        L"        case 10:\n"
+        L"            return \"A\"\n"
+        L"        case 8, 9:\n"
+        L"            return \"B\"\n"
+        L"        default:\n"
+        L"            return \"C\"\n"
+        L"    }\n"
+        L"}\n"
+        L"let a = name(Color.Red)\n"
+        L"let b = name(.Blue)\n"
+        L"let g = grade(9) + grade(10) + grade(1)\n"
+        L"let c = Color.Green\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"a", L"\"red\"");
+    ASSERT_VALUE(L"b", L"\"other\"");
+    ASSERT_VALUE(L"g", L"\"BAC\"");
+    ASSERT_VALUE(L"c", L"Green");
+}
+
+TEST(TestVirtualMachine, Arrays)
+{
+    RUN(L"var a = [1, 2, 3]\n"
+        L"var b = a\n"
+        L"b.append(4)\n"
+        L"b[0] = 10\n"
+        L"var total = 0\n"
+        L"for var i = 0; i < b.count; i++ {\n"
+        L"    total = total + b[i]\n"
+        L"}\n"
+        L"let last = b.removeLast()\n");
+    ASSERT_TRUE(succeeded);
+    ASSERT_VALUE(L"a", L"[1, 2, 3]");
+    ASSERT_VALUE(L"b", L"[10, 2, 3]");
+    ASSERT_VALUE(L"total", L"19");
+    ASSERT_VALUE(L"last", L"4");
+}
+
+TEST(TestVirtualMachine, RuntimeError)
+{
+    RUN(L"var a : Int8 = 100\n"
+        L"a = a + a\n");
+    ASSERT_FALSE(succeeded);
+    ASSERT_ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2);
+    ASSERT_EQ(2, error->line);
+    ASSERT_EQ(L"Int8", error->items[1]);
+}
+
+TEST(TestVirtualMachine, CallDepth)
+{
+    RUN(L"func f(n : Int) -> Int {\n"
+        L"    return f(n + 1)\n"
+        L"}\n"
+        L"let a = f(0)\n");
+    ASSERT_FALSE(succeeded);
+    ASSERT_ERROR(Errors::E_MAXIMUM_CALL_DEPTH_EXCEEDED);
+}
+
+TEST(TestVirtualMachine, Unsupported)
+{
+    RUN(L"let twice = {(x : Int) -> Int in x * 2}\n");
+    ASSERT_FALSE(succeeded);
+    ASSERT_ERROR(Errors::E_A_IS_NOT_SUPPORTED_IN_EVALUATION_1);
+    ASSERT_EQ(L"closure", error->items[0]);
+}
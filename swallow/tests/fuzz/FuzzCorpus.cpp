@@ -0,0 +1,210 @@
+/* FuzzCorpus.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Builds the seed corpus of the fuzz targets from the test suite.
+ * Every .swift file is copied, and every sequence of adjacent wide string literals in the gtest sources is
+ * unescaped and written as a seed, which covers the code snippets used by SEMANTIC_ANALYZE and PARSE_STATEMENT.
+ *
+ * Usage: FuzzCorpus <tests directory> <output directory>
+ */
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static bool endsWith(const string& s, const char* suffix)
+{
+    size_t len = strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+static void collectFiles(const string& path, vector<string>& files)
+{
+    DIR* dir = opendir(path.c_str());
+    if(!dir)
+        return;
+    vector<string> entries;
+    while(dirent* entry = readdir(dir))
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+        entries.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    sort(entries.begin(), entries.end());
+    for(const string& entry : entries)
+    {
+        struct stat st;
+        if(stat(entry.c_str(), &st) != 0)
+            continue;
+        if(S_ISDIR(st.st_mode))
+            collectFiles(entry, files);
+        else if(endsWith(entry, ".swift") || endsWith(entry, ".cpp"))
+            files.push_back(entry);
+    }
+}
+
+static bool readFile(const string& path, string& content)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+    content.clear();
+    char buf[4096];
+    size_t size;
+    while((size = fread(buf, 1, sizeof(buf), f)) > 0)
+        content.append(buf, size);
+    fclose(f);
+    return true;
+}
+
+/*!
+ * Reads a string literal starting after the open quote, returns the position after the close quote
+ */
+static size_t readLiteral(const string& src, size_t pos, string& out)
+{
+    while(pos < src.size() && src[pos] != '"')
+    {
+        char ch = src[pos++];
+        if(ch != '\\' || pos >= src.size())
+        {
+            out.push_back(ch);
+            continue;
+        }
+        ch = src[pos++];
+        switch(ch)
+        {
+            case 'n': out.push_back('\n'); break;
+            case 't': out.push_back('\t'); break;
+            case 'r': out.push_back('\r'); break;
+            case '0': out.push_back('\0'); break;
+            default: out.push_back(ch); break;
+        }
+    }
+    return pos + 1;
+}
+
+/*!
+ * Extracts the sequences of adjacent wide string literals, comments between them are not expected
+ */
+static void extractLiterals(const string& src, vector<string>& literals)
+{
+    size_t pos = 0;
+    while((pos = src.find("L\"", pos)) != string::npos)
+    {
+        if(pos > 0 && (isalnum((unsigned char)src[pos - 1]) || src[pos - 1] == '_'))
+        {
+            pos += 2;
+            continue;
+        }
+        string literal;
+        pos = readLiteral(src, pos + 2, literal);
+        //adjacent literals are concatenated by the C++ compiler
+        while(true)
+        {
+            size_t next = src.find_first_not_of(" \t\r\n", pos);
+            if(next == string::npos)
+                break;
+            if(src.compare(next, 2, "L\"") == 0)
+                pos = readLiteral(src, next + 2, literal);
+            else if(src[next] == '"')
+                pos = readLiteral(src, next + 1, literal);
+            else
+                break;
+        }
+        if(!literal.empty())
+            literals.push_back(literal);
+    }
+}
+
+static bool writeSeed(const string& path, const string& content)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        fprintf(stderr, "Cannot write %s\n", path.c_str());
+        return false;
+    }
+    fwrite(content.data(), 1, content.size(), f);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <tests directory> <output directory>\n", argv[0]);
+        return 1;
+    }
+    string output = argv[2];
+    mkdir(output.c_str(), 0755);
+    string root = argv[1];
+    vector<string> files;
+    collectFiles(root, files);
+    set<string> seeds;
+    int written = 0;
+    for(const string& file : files)
+    {
+        string content;
+        if(!readFile(file, content))
+            continue;
+        vector<string> literals;
+        if(endsWith(file, ".swift"))
+            literals.push_back(content);
+        else
+            extractLiterals(content, literals);
+        //seeds are named after the relative path of the file, tests in different directories share names
+        string name = file.substr(root.size() + 1);
+        name = name.substr(0, name.find('.'));
+        replace(name.begin(), name.end(), '/', '-');
+        int idx = 0;
+        for(const string& literal : literals)
+        {
+            //the same snippets are used by many tests
+            if(!seeds.insert(literal).second)
+                continue;
+            char path[32];
+            snprintf(path, sizeof(path), "-%d.swift", idx++);
+            if(!writeSeed(output + "/" + name + path, literal))
+                return 1;
+            written++;
+        }
+    }
+    printf("%d seeds written to %s\n", written, output.c_str());
+    return 0;
+}
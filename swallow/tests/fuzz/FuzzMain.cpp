@@ -0,0 +1,214 @@
+/* FuzzMain.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Standalone driver for the fuzz targets when they're not linked with libFuzzer.
+ * It replays given inputs through LLVMFuzzerTestOneInput, so a crash or a corpus found by libFuzzer can be
+ * reproduced and checked by the regression tests with any compiler.
+ *
+ * Usage: FuzzXXX [--runs=N] [--timeout=seconds] [--slow=ms] [--rss-growth=KB] <file or directory>...
+ *
+ * With --rss-growth, the driver fails if the resident memory grows more than given KB between the first and the
+ * last run of an input, libFuzzer runs millions of inputs in the same process so nothing may accumulate between them.
+ */
+#include "FuzzTarget.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+static const char* currentInput = "";
+
+/*!
+ * Prints the input that crashed or timed out, only async-signal-safe calls are used
+ */
+static void printCurrentInput(const char* msg)
+{
+    if(write(STDERR_FILENO, msg, strlen(msg)) < 0 || write(STDERR_FILENO, currentInput, strlen(currentInput)) < 0)
+        return;
+    if(write(STDERR_FILENO, "\n", 1) < 0)
+        return;
+}
+
+static void onTimeout(int)
+{
+    printCurrentInput("Timeout while running input: ");
+    signal(SIGABRT, SIG_DFL);
+    abort();
+}
+
+static void onCrash(int sig)
+{
+    printCurrentInput("Crashed while running input: ");
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/*!
+ * Collect all regular files under given path recursively, sorted by name
+ */
+static void collectInputs(const string& path, vector<string>& inputs)
+{
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0)
+    {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return;
+    }
+    if(!S_ISDIR(st.st_mode))
+    {
+        inputs.push_back(path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if(!dir)
+        return;
+    vector<string> entries;
+    while(dirent* entry = readdir(dir))
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+        entries.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    sort(entries.begin(), entries.end());
+    for(const string& entry : entries)
+        collectInputs(entry, inputs);
+}
+
+/*!
+ * Resident memory of current process in KB, 0 if it's unknown
+ */
+static long residentMemory()
+{
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(!f)
+        return 0;
+    long size = 0, resident = 0;
+    if(fscanf(f, "%ld %ld", &size, &resident) != 2)
+        resident = 0;
+    fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static bool readInput(const string& path, vector<uint8_t>& data)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+    data.clear();
+    uint8_t buf[4096];
+    size_t size;
+    while((size = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + size);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 1;
+    int timeout = 0;
+    double slow = 100;
+    long rssGrowth = -1;
+    vector<string> inputs;
+    for(int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if(!strncmp("--runs=", arg, 7))
+            runs = max(1, atoi(arg + 7));
+        else if(!strncmp("--timeout=", arg, 10))
+            timeout = atoi(arg + 10);
+        else if(!strncmp("--slow=", arg, 7))
+            slow = atof(arg + 7);
+        else if(!strncmp("--rss-growth=", arg, 13))
+            rssGrowth = atol(arg + 13);
+        else
+            collectInputs(arg, inputs);
+    }
+    if(inputs.empty())
+    {
+        fprintf(stderr, "Usage: %s [--runs=N] [--timeout=seconds] [--slow=ms] [--rss-growth=KB] <file or directory>...\n", argv[0]);
+        return 1;
+    }
+    signal(SIGALRM, onTimeout);
+    signal(SIGSEGV, onCrash);
+    signal(SIGBUS, onCrash);
+    signal(SIGFPE, onCrash);
+    signal(SIGABRT, onCrash);
+    vector<uint8_t> data;
+    Clock::duration total = Clock::duration::zero();
+    long long execs = 0;
+    bool leaked = false;
+    for(const string& input : inputs)
+    {
+        if(!readInput(input, data))
+        {
+            fprintf(stderr, "Cannot read %s\n", input.c_str());
+            return 1;
+        }
+        currentInput = input.c_str();
+        Clock::time_point start = Clock::now();
+        long rss = 0;
+        for(int i = 0; i < runs; i++)
+        {
+            alarm(timeout);
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+            alarm(0);
+            //the first run may initialize the shared states, growth is measured after it
+            if(i == 0)
+                rss = residentMemory();
+        }
+        Clock::duration elapsed = Clock::now() - start;
+        long growth = residentMemory() - rss;
+        if(rssGrowth >= 0 && growth > rssGrowth)
+        {
+            printf("Memory grew %ld KB in %d runs of input %s\n", growth, runs - 1, input.c_str());
+            leaked = true;
+        }
+        total += elapsed;
+        execs += runs;
+        double ms = chrono::duration_cast<chrono::microseconds>(elapsed).count() / 1000.0 / runs;
+        if(ms >= slow)
+            printf("Slow input %s: %.3f ms\n", input.c_str(), ms);
+    }
+    double seconds = chrono::duration_cast<chrono::microseconds>(total).count() / 1000000.0;
+    printf("Executed %lld runs of %d inputs in %.3f s, %.0f exec/s\n", execs, (int)inputs.size(), seconds, seconds > 0 ? execs / seconds : 0.0);
+    return leaked ? 1 : 0;
+}
@@ -0,0 +1 @@
+func chooseStepFunction(backwards: Bool) -> (Int) -> Int {return backwards ? stepBackward : stepForward}
\ No newline at end of file
@@ -0,0 +1 @@
+for(
\ No newline at end of file
@@ -0,0 +1,19 @@
+struct Point {
+    var x : Int
+    var y : Int
+}
+class Node<T> {
+    var value : T
+    var next : Node<T>?
+    init(value : T) {
+        self.value = value
+    }
+}
+enum Shape {
+    case Circle(Point, Int)
+    case Line(Point, Point)
+}
+var points : Array<Point> = [Point(x: 1, y: 2)]
+var names : Dictionary<String, Point> = [:]
+var list = Node<Point>(value: Point(x: 0, y: 0))
+let shape = Shape.Line(points[0], points[0])
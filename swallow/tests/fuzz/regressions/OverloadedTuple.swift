@@ -0,0 +1,3 @@
+func test(a : Int) -> String { return ""; }
+func test(a : String) -> Bool { return true; }
+let a = (test(56), test(""))
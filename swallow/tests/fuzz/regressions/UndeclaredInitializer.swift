@@ -0,0 +1 @@
+Shape.init(id : 5)
@@ -0,0 +1,5 @@
+func test<T1, T2>(a : T1) -> T1
+{
+return a;
+}
+test(5)
\ No newline at end of file
@@ -0,0 +1,157 @@
+/* TestErrorRecovery.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/Errors.h"
+#include "semantics/BatchCompiler.h"
+
+using namespace Swallow;
+using namespace std;
+
+static ProgramPtr parseWithRecovery(CompilerResults& compilerResults, const wchar_t* code)
+{
+    NodeFactory nodeFactory;
+    Parser parser(&nodeFactory, &compilerResults);
+    parser.setFileName(L"<file>");
+    parser.setErrorRecovery(true);
+    return parser.parse(code);
+}
+
+TEST(TestErrorRecovery, Disabled)
+{
+    CompilerResults compilerResults;
+    ProgramPtr program = parseStatements(compilerResults, __FUNCTION__,
+            L"let a : = 3\n"
+            L"let b = 3\n"
+            L"struct 3 {}");
+    ASSERT_NULL(program);
+    ASSERT_EQ(1, compilerResults.numResults());
+}
+
+TEST(TestErrorRecovery, TopLevel)
+{
+    CompilerResults compilerResults;
+    ProgramPtr program = parseWithRecovery(compilerResults,
+            L"let a : = 3\n"
+            L"let b = 3\n"
+            L"let c = (1, if); let d = 4\n"
+            L"class { var x = 1 }\n"
+            L"let e = 5");
+    ASSERT_NOT_NULL(program);
+    ASSERT_EQ(3, compilerResults.numResults());
+    ASSERT_EQ(1, compilerResults.getResult(0).line);
+    ASSERT_EQ(3, compilerResults.getResult(1).line);
+    ASSERT_EQ(4, compilerResults.getResult(2).line);
+    ASSERT_EQ(6, program->numStatements());
+    ASSERT_EQ(NodeType::Error, program->getStatement(0)->getNodeType());
+    ASSERT_EQ(NodeType::ValueBindings, program->getStatement(1)->getNodeType());
+    ASSERT_EQ(NodeType::Error, program->getStatement(2)->getNodeType());
+    ASSERT_EQ(NodeType::ValueBindings, program->getStatement(3)->getNodeType());
+    ASSERT_EQ(NodeType::Error, program->getStatement(4)->getNodeType());
+    ASSERT_EQ(NodeType::ValueBindings, program->getStatement(5)->getNodeType());
+}
+
+TEST(TestErrorRecovery, CodeBlock)
+{
+    CompilerResults compilerResults;
+    ProgramPtr program = parseWithRecovery(compilerResults,
+            L"func foo() {\n"
+            L"    let a : = 3\n"
+            L"    if a { let x = (1, if) }\n"
+            L"    struct 3 {}\n"
+            L"    let d = 4\n"
+            L"}\n"
+            L"let c = 1");
+    ASSERT_NOT_NULL(program);
+    ASSERT_EQ(3, compilerResults.numResults());
+    ASSERT_EQ(2, program->numStatements());
+    FunctionDefPtr func = dynamic_pointer_cast<FunctionDef>(program->getStatement(0));
+    ASSERT_NOT_NULL(func);
+    CodeBlockPtr body = func->getBody();
+    ASSERT_EQ(4, body->numStatements());
+    ASSERT_EQ(NodeType::Error, body->getStatement(0)->getNodeType());
+    IfStatementPtr if_ = dynamic_pointer_cast<IfStatement>(body->getStatement(1));
+    ASSERT_NOT_NULL(if_);
+    ASSERT_EQ(1, if_->getThen()->numStatements());
+    ASSERT_EQ(NodeType::Error, if_->getThen()->getStatement(0)->getNodeType());
+    ASSERT_EQ(NodeType::Error, body->getStatement(2)->getNodeType());
+    ASSERT_EQ(NodeType::ValueBindings, body->getStatement(3)->getNodeType());
+}
+
+TEST(TestErrorRecovery, UnterminatedBlock)
+{
+    CompilerResults compilerResults;
+    ProgramPtr program = parseWithRecovery(compilerResults,
+            L"let a = 1\n"
+            L"func foo() {\n"
+            L"    let b : = 3\n");
+    ASSERT_NOT_NULL(program);
+    ASSERT_EQ(2, program->numStatements());
+    ASSERT_EQ(NodeType::Error, program->getStatement(1)->getNodeType());
+    ASSERT_EQ(2, compilerResults.numResults());
+    ASSERT_EQ(Errors::E_EXPECT_1, compilerResults.getResult(1).code);
+}
+
+TEST(TestErrorRecovery, UnexpectedToken)
+{
+    CompilerResults compilerResults;
+    ProgramPtr program = parseWithRecovery(compilerResults,
+            L"func foo() {\n"
+            L"    )\n"
+            L"}");
+    ASSERT_NOT_NULL(program);
+    ASSERT_EQ(1, compilerResults.numResults());
+    ASSERT_EQ(Errors::E_UNEXPECTED_1, compilerResults.getResult(0).code);
+}
+
+TEST(TestErrorRecovery, Limit)
+{
+    CompilerResults compilerResults;
+    compilerResults.setLimit(2);
+    ProgramPtr program = parseWithRecovery(compilerResults,
+            L"let a : = 3\n"
+            L"let b : = 3\n"
+            L"let c : = 3\n"
+            L"let d : = 3\n");
+    ASSERT_NULL(program);
+    ASSERT_EQ(2, compilerResults.numResults());
+}
+
+TEST(TestErrorRecovery, SemanticAnalysis)
+{
+    BatchCompiler compiler(1);
+    BatchResult result;
+    compiler.compile(BatchItem(L"a.swift",
+            L"let a : = 3\n"
+            L"let b : Int = \"str\"\n"), result);
+    ASSERT_FALSE(result.successed);
+    ASSERT_EQ(2, result.compilerResults.numResults());
+    ASSERT_EQ(ErrorLevel::Fatal, result.compilerResults.getResult(0).level);
+    ASSERT_EQ(ErrorLevel::Error, result.compilerResults.getResult(1).level);
+}
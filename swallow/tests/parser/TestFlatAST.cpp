@@ -0,0 +1,205 @@
+/* TestFlatAST.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "ast/FlatAST.h"
+
+using namespace Swallow;
+using namespace std;
+
+static uint32_t findNode(const FlatAST& ast, NodeType::T kind, const wchar_t* name, uint32_t start = 0)
+{
+    for(uint32_t i = start; i < ast.size(); i++)
+    {
+        if(ast.getKind(i) == kind && ast.getName(i) == name)
+            return i;
+    }
+    return FlatAST::InvalidIndex;
+}
+
+TEST(TestFlatAST, testLayout)
+{
+    wstring code = L"let a = 1\n"
+                   L"var b = a + 2\n"
+                   L"b = a";
+    CompilerResults compilerResults;
+    ProgramPtr root = parseStatements(compilerResults, __FUNCTION__, code.c_str());
+    ASSERT_NOT_NULL(root);
+    FlatAST ast(root);
+
+    ASSERT_EQ(NodeType::Program, ast.getKind(0));
+    ASSERT_EQ(FlatAST::InvalidIndex, ast.getParent(0));
+    ASSERT_EQ(ast.size(), ast.getSubtreeEnd(0));
+    ASSERT_EQ(3, ast.numChildren(0));
+
+    uint32_t let = ast.getChild(0, 0);
+    uint32_t var = ast.getChild(0, 1);
+    ASSERT_EQ(NodeType::ValueBindings, ast.getKind(let));
+    ASSERT_EQ(NodeType::ValueBindings, ast.getKind(var));
+    ASSERT_TRUE((ast.getFlags(let) & FlatAST::FlagReadOnly) != 0);
+    ASSERT_TRUE((ast.getFlags(var) & FlatAST::FlagReadOnly) == 0);
+    ASSERT_EQ(ast.getSubtreeEnd(let), var);
+
+    uint32_t plus = findNode(ast, NodeType::BinaryOperator, L"+");
+    ASSERT_NE(FlatAST::InvalidIndex, plus);
+    ASSERT_TRUE((ast.getFlags(plus) & FlatAST::FlagExpression) != 0);
+    ASSERT_EQ(2, ast.numChildren(plus));
+    uint32_t lhs = ast.getChild(plus, 0);
+    uint32_t rhs = ast.getChild(plus, 1);
+    ASSERT_EQ(NodeType::Identifier, ast.getKind(lhs));
+    ASSERT_EQ(L"a", ast.getName(lhs));
+    ASSERT_EQ(NodeType::IntegerLiteral, ast.getKind(rhs));
+    ASSERT_EQ(L"2", ast.getName(rhs));
+    ASSERT_EQ(plus, ast.getParent(lhs));
+    ASSERT_EQ(plus, ast.getParent(rhs));
+    ASSERT_EQ(ast.getSubtreeEnd(plus), ast.getSubtreeEnd(rhs));
+    ASSERT_EQ(code.find(L"a + 2"), ast.getSourceOffset(lhs));
+
+    //identical names share one entry of the name table
+    uint32_t a = findNode(ast, NodeType::Identifier, L"a", ast.getSubtreeEnd(var));
+    ASSERT_NE(FlatAST::InvalidIndex, a);
+    ASSERT_EQ(ast.getNameIndex(a), ast.getNameIndex(lhs));
+    ASSERT_EQ(nullptr, ast.getType(a));
+}
+
+TEST(TestFlatAST, testChildrenInOrder)
+{
+    wstring code = L"func foo(x : Int) -> Int {\n"
+                   L"    if x > 0 {\n"
+                   L"        return x\n"
+                   L"    }\n"
+                   L"    return foo(x + 1)\n"
+                   L"}";
+    CompilerResults compilerResults;
+    ProgramPtr root = parseStatements(compilerResults, __FUNCTION__, code.c_str());
+    ASSERT_NOT_NULL(root);
+    FlatAST ast(root);
+
+    uint32_t func = findNode(ast, NodeType::Function, L"foo");
+    ASSERT_NE(FlatAST::InvalidIndex, func);
+    ASSERT_TRUE((ast.getFlags(func) & FlatAST::FlagDeclaration) != 0);
+    //every node in the subtree links back to a parent inside the subtree, and children are in pre-order
+    for(uint32_t i = func + 1; i < ast.getSubtreeEnd(func); i++)
+    {
+        uint32_t parent = ast.getParent(i);
+        ASSERT_TRUE(parent >= func && parent < i);
+        ASSERT_TRUE(ast.getSubtreeEnd(i) <= ast.getSubtreeEnd(parent));
+    }
+    for(uint32_t i = 0; i < ast.size(); i++)
+    {
+        for(uint32_t c = 0; c + 1 < ast.numChildren(i); c++)
+            ASSERT_EQ(ast.getSubtreeEnd(ast.getChild(i, c)), ast.getChild(i, c + 1));
+    }
+    int returns = 0;
+    for(uint32_t i = func; i < ast.getSubtreeEnd(func); i++)
+    {
+        if(ast.getKind(i) == NodeType::Return)
+            returns++;
+    }
+    ASSERT_EQ(2, returns);
+}
+
+class IdentifierCollector : public NodeVisitor
+{
+public:
+    virtual void visitIdentifier(const IdentifierPtr& id) override
+    {
+        names.push_back(id->getIdentifier());
+    }
+    vector<wstring> names;
+};
+
+TEST(TestFlatAST, testAccept)
+{
+    wstring code = L"let x = (a + b) * c";
+    CompilerResults compilerResults;
+    ProgramPtr root = parseStatements(compilerResults, __FUNCTION__, code.c_str());
+    ASSERT_NOT_NULL(root);
+    FlatAST ast(root);
+
+    uint32_t mul = findNode(ast, NodeType::BinaryOperator, L"*");
+    ASSERT_NE(FlatAST::InvalidIndex, mul);
+    IdentifierCollector collector;
+    ast.accept(mul, &collector);
+    ASSERT_EQ(3, collector.names.size());
+    ASSERT_EQ(L"a", collector.names[0]);
+    ASSERT_EQ(L"b", collector.names[1]);
+    ASSERT_EQ(L"c", collector.names[2]);
+    ASSERT_EQ(ast.getNode(mul)->getNodeType(), ast.getKind(mul));
+    ASSERT_TRUE(ast.getMemoryUsage() > 0);
+}
+
+TEST(TestFlatAST, testRoles)
+{
+    wstring code = L"outer: for var i = 0; i < 10; i++ {\n"
+                   L"    if i > 5 {\n"
+                   L"        break outer\n"
+                   L"    } else {\n"
+                   L"        continue\n"
+                   L"    }\n"
+                   L"}\n"
+                   L"for x in list {\n"
+                   L"}";
+    CompilerResults compilerResults;
+    ProgramPtr root = parseStatements(compilerResults, __FUNCTION__, code.c_str());
+    ASSERT_NOT_NULL(root);
+    FlatAST ast(root);
+
+    uint32_t label = findNode(ast, NodeType::LabeledStatement, L"outer");
+    ASSERT_NE(FlatAST::InvalidIndex, label);
+    uint32_t loop = ast.getChild(label, 0);
+    ASSERT_EQ(NodeType::For, ast.getKind(loop));
+    uint32_t init = ast.findChild(loop, FlatAST::RoleInit);
+    uint32_t condition = ast.findChild(loop, FlatAST::RoleCondition);
+    uint32_t step = ast.findChild(loop, FlatAST::RoleStep);
+    uint32_t body = ast.findChild(loop, FlatAST::RoleBody);
+    ASSERT_NE(FlatAST::InvalidIndex, init);
+    ASSERT_NE(FlatAST::InvalidIndex, condition);
+    ASSERT_NE(FlatAST::InvalidIndex, step);
+    ASSERT_EQ(NodeType::CodeBlock, ast.getKind(body));
+    ASSERT_TRUE(init < condition && condition < step && step < body);
+
+    uint32_t ifs = ast.getChild(body, 0);
+    ASSERT_EQ(NodeType::If, ast.getKind(ifs));
+    ASSERT_EQ(FlatAST::RoleNone, ast.getRole(ifs));
+    ASSERT_NE(FlatAST::InvalidIndex, ast.findChild(ifs, FlatAST::RoleThen));
+    ASSERT_NE(FlatAST::InvalidIndex, ast.findChild(ifs, FlatAST::RoleElse));
+    ASSERT_NE(FlatAST::InvalidIndex, findNode(ast, NodeType::Break, L"outer"));
+
+    uint32_t forIn = findNode(ast, NodeType::ForIn, L"");
+    ASSERT_NE(FlatAST::InvalidIndex, forIn);
+    uint32_t vars = ast.findChild(forIn, FlatAST::RoleLoopVariables);
+    uint32_t container = ast.findChild(forIn, FlatAST::RoleContainer);
+    ASSERT_NE(FlatAST::InvalidIndex, vars);
+    ASSERT_EQ(NodeType::Identifier, ast.getKind(container));
+    ASSERT_EQ(L"list", ast.getName(container));
+
+    //the retained tree is part of the footprint
+    ASSERT_TRUE(ast.getMemoryUsage() > ast.size() * sizeof(Node));
+}
@@ -661,3 +661,21 @@ TEST(TestStatement, testLabeledFor)
 
 
 }
+
+TEST(TestStatement, ParentLinks)
+{
+    PARSE_STATEMENT(L"for i = 0;i < 10; i++ {a = i;println(a);}");
+    ForLoopPtr loop = std::dynamic_pointer_cast<ForLoop>(root);
+    ASSERT_NOT_NULL(loop);
+    //parents are linked by the parser, no visitor has run on the tree
+    ASSERT_EQ(loop, loop->getCondition()->getParentNode());
+    ASSERT_EQ(loop, loop->getStep()->getParentNode());
+    CodeBlockPtr body = loop->getCodeBlock();
+    ASSERT_EQ(loop, body->getParentNode());
+    FunctionCallPtr call;
+    ASSERT_NOT_NULL(call = std::dynamic_pointer_cast<FunctionCall>(body->getStatement(1)));
+    ASSERT_EQ(body, call->getParentNode());
+    ASSERT_EQ(call, call->getFunction()->getParentNode());
+    ASSERT_EQ(call, call->getArguments()->getParentNode());
+    ASSERT_EQ(call->getArguments(), call->getArguments()->get(0)->getParentNode());
+}
@@ -0,0 +1,119 @@
+/* TestBatchCompiler.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/BatchCompiler.h"
+#include "semantics/SymbolScope.h"
+#include "semantics/Type.h"
+#include "common/Errors.h"
+
+using namespace Swallow;
+using namespace std;
+
+TEST(TestBatchCompiler, Compile)
+{
+    BatchCompiler compiler(4);
+    vector<BatchItem> items = {
+        BatchItem(L"a.swift", L"let a = [1, 2, 3]"),
+        BatchItem(L"b.swift", L"let b : Int = \"test\""),
+        BatchItem(L"c.swift", L"let c = a"),
+        BatchItem(L"d.swift", L"struct Stack<T> { var items = [T]() }\n"
+                L"var s = Stack<Int>()")
+    };
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    ASSERT_EQ(4, results.size());
+    ASSERT_EQ(L"a.swift", results[0].fileName);
+    ASSERT_TRUE(results[0].successed);
+    ASSERT_EQ(0, results[0].compilerResults.numResults());
+    ASSERT_FALSE(results[1].successed);
+    ASSERT_EQ(1, results[1].compilerResults.numResults());
+    //the declaration in a.swift should not be visible in c.swift
+    ASSERT_FALSE(results[2].successed);
+    ASSERT_EQ(Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, results[2].compilerResults.getResult(0).code);
+    ASSERT_TRUE(results[3].successed);
+    ASSERT_NULL(results[3].program);
+}
+
+TEST(TestBatchCompiler, KeepAST)
+{
+    BatchCompiler compiler;
+    compiler.setKeepAST(true);
+    vector<BatchItem> items;
+    for(int i = 0; i < 16; i++)
+        items.push_back(BatchItem(L"<file>", L"let a : Int? = 3\nlet b = a! + 4"));
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    ASSERT_EQ(16, results.size());
+    for(const BatchResult& result : results)
+    {
+        ASSERT_TRUE(result.successed);
+        ASSERT_NOT_NULL(result.program);
+        SymbolPtr b = result.program->getScope()->lookup(L"b");
+        ASSERT_NOT_NULL(b);
+        ASSERT_EQ(L"Int", b->getType()->getName());
+    }
+}
+
+TEST(TestBatchCompiler, MaxResults)
+{
+    wstring code;
+    for(int i = 0; i < CompilerResults::DefaultLimit + 10; i++)
+        code += L"let a : = 3\n";
+    BatchCompiler compiler(1);
+    BatchResult result;
+    compiler.compile(BatchItem(L"a.swift", code), result);
+    ASSERT_EQ(CompilerResults::DefaultLimit, result.compilerResults.numResults());
+
+    compiler.setMaxResults(0);
+    compiler.compile(BatchItem(L"a.swift", code), result);
+    ASSERT_EQ(CompilerResults::DefaultLimit + 10, result.compilerResults.numResults());
+}
+
+TEST(TestBatchCompiler, MalformedInput)
+{
+    //malformed files are reported as errors instead of crashing the batch
+    BatchCompiler compiler;
+    vector<BatchItem> items = {
+        BatchItem(L"a.swift", L"!"),
+        BatchItem(L"b.swift", L"Shape.init(id : 5)"),
+        BatchItem(L"c.swift", L" + 1"),
+        BatchItem(L"d.swift", L"struct Stack<T> {\nvar items = T[]()\n}"),
+        BatchItem(L"e.swift", L"for ;; {}")
+    };
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    ASSERT_EQ(5, results.size());
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_FALSE(results[i].successed);
+        ASSERT_NE(0, results[i].compilerResults.numResults());
+    }
+    ASSERT_TRUE(results[4].successed);
+}
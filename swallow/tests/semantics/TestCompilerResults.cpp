@@ -0,0 +1,124 @@
+/* TestCompilerResults.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/CompilerResults.h"
+#include "common/Errors.h"
+
+using namespace Swallow;
+using namespace std;
+
+static SourceInfo location(uint32_t offset)
+{
+    SourceInfo ret;
+    ret.offset = offset;
+    return ret;
+}
+
+TEST(TestCompilerResults, Render)
+{
+    CompilerResults results;
+    results.add(ErrorLevel::Error, location(0), Errors::E_CANNOT_ASSIGN_TO_A_IN_B_2, ResultItems({L"a", L"self"}));
+    ASSERT_EQ(1, results.numResults());
+    const CompilerResult& res = results.getResult(0);
+    ASSERT_EQ(2, res.items.size());
+    ASSERT_EQ(L"a", res.items[0]);
+    ASSERT_EQ(L"self", res.items[1]);
+    ASSERT_EQ(L"Cannot assign to 'a' in 'self'", res.format());
+    ASSERT_EQ(Errors::format(res.code, res.items.toVector()), res.format());
+
+    //truncated output still reports the full length
+    wchar_t buffer[10];
+    size_t len = res.render(buffer, 10);
+    ASSERT_EQ(res.format().size(), len);
+    ASSERT_EQ(wstring(L"Cannot as"), buffer);
+}
+
+TEST(TestCompilerResults, Intern)
+{
+    CompilerResults results;
+    results.add(ErrorLevel::Error, location(0), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"foo");
+    results.add(ErrorLevel::Error, location(10), Errors::E_USE_OF_UNDECLARED_TYPE_1, L"foo");
+    ASSERT_EQ(2, results.numResults());
+    ASSERT_EQ(results.getResult(0).items.handle(0), results.getResult(1).items.handle(0));
+}
+
+TEST(TestCompilerResults, Dedup)
+{
+    CompilerResults results;
+    for(int i = 0; i < 3; i++)
+        results.add(ErrorLevel::Error, location(4), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"foo");
+    results.add(ErrorLevel::Error, location(4), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"bar");
+    results.add(ErrorLevel::Warning, location(4), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"foo");
+    ASSERT_EQ(3, results.numResults());
+    ASSERT_EQ(2, results.numDiscarded());
+}
+
+TEST(TestCompilerResults, Limit)
+{
+    CompilerResults results;
+    results.setLimit(2);
+    for(int i = 0; i < 10; i++)
+        results.add(ErrorLevel::Error, location(i * 10), Errors::E_UNEXPECTED_1, L"}");
+    ASSERT_TRUE(results.isFull());
+    ASSERT_EQ(2, results.numResults());
+    ASSERT_EQ(8, results.numDiscarded());
+    results.clear();
+    ASSERT_FALSE(results.isFull());
+    ASSERT_EQ(0, results.numDiscarded());
+}
+
+TEST(TestCompilerResults, OutliveOwner)
+{
+    //a copied result keeps its arguments after the owner is cleared or destroyed
+    CompilerResult* res = nullptr;
+    {
+        CompilerResults results;
+        results.add(ErrorLevel::Error, location(0), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"foo");
+        res = new CompilerResult(results.getResult(0));
+        results.clear();
+        results.add(ErrorLevel::Error, location(0), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"bar");
+    }
+    ASSERT_EQ(L"foo", res->items[0]);
+    ASSERT_EQ(L"use of unresolved identifier 'foo'", res->format());
+    delete res;
+}
+
+TEST(TestCompilerResults, Position)
+{
+    wstring code = L"let a = 1\nlet b = c";
+    CompilerResults results;
+    results.setSourceIndex(SourceIndex(code));
+    results.add(ErrorLevel::Error, location(code.find(L"c")), Errors::E_USE_OF_UNRESOLVED_IDENTIFIER_1, L"c");
+    ASSERT_EQ(1, results.numResults());
+    const CompilerResult& res = results.getResult(0);
+    ASSERT_EQ(code.find(L"c"), res.offset);
+    ASSERT_EQ(2, res.line);
+    ASSERT_EQ(9, res.column);
+}
@@ -0,0 +1,119 @@
+/* TestCompilerStats.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/CompilerStats.h"
+#include "semantics/BatchCompiler.h"
+#include <chrono>
+
+using namespace Swallow;
+using namespace std;
+
+TEST(TestCompilerStats, Counters)
+{
+    CompilerStats stats;
+    {
+        CompilerStatsScope statsScope(&stats);
+        //specializes a type declared by the test, the standard library's types may be already cached
+        SEMANTIC_ANALYZE(L"struct Box<T> {\n"
+            L"    var value : T\n"
+            L"}\n"
+            L"func f(a : Int) -> Int { return a }\n"
+            L"func f(a : String) -> String { return a }\n"
+            L"var b : Box<Int>\n"
+            L"let x = f(3)");
+        ASSERT_NO_ERRORS();
+    }
+    ASSERT_NE(0, stats.getCount(CompilerCounter::Tokens));
+    ASSERT_NE(0, stats.getCount(CompilerCounter::Nodes));
+    ASSERT_NE(0, stats.getCount(CompilerCounter::ScopeLookups));
+    ASSERT_NE(0, stats.getCount(CompilerCounter::OverloadCandidates));
+    ASSERT_NE(0, stats.getCount(CompilerCounter::Specializations));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::Tokenize));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::Parse));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::OperatorResolution));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::DeclarationAnalysis));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::BodyAnalysis));
+    ASSERT_NE(0, stats.getTime(CompilerPhase::Specialization));
+}
+
+TEST(TestCompilerStats, Inactive)
+{
+    CompilerStats stats;
+    {
+        CompilerStatsScope statsScope(&stats);
+    }
+    ASSERT_NULL(CompilerStats::current());
+    SEMANTIC_ANALYZE(L"let a = 1 + 2");
+    ASSERT_NO_ERRORS();
+    ASSERT_EQ(0, stats.getCount(CompilerCounter::Tokens));
+    ASSERT_EQ(0, stats.getTotalTime());
+}
+
+TEST(TestCompilerStats, ExclusivePhases)
+{
+    CompilerStats stats;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    {
+        CompilerStatsScope statsScope(&stats);
+        SEMANTIC_ANALYZE(L"func fib(n : Int) -> Int {\n"
+            L"    if n < 2 { return n }\n"
+            L"    return fib(n - 1) + fib(n - 2)\n"
+            L"}\n"
+            L"let a = fib(10)");
+        ASSERT_NO_ERRORS();
+    }
+    uint64_t elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    //nested phases pause the outer one, so the phases never add up to more than the elapsed time
+    ASSERT_LE(stats.getTotalTime(), elapsed);
+    ASSERT_EQ(stats.getTotalTime(), stats.getTime(CompilerPhase::Tokenize) + stats.getTime(CompilerPhase::Parse)
+        + stats.getTime(CompilerPhase::OperatorResolution) + stats.getTime(CompilerPhase::DeclarationAnalysis)
+        + stats.getTime(CompilerPhase::BodyAnalysis) + stats.getTime(CompilerPhase::Specialization)
+        + stats.getTime(CompilerPhase::Mangling));
+}
+
+TEST(TestCompilerStats, BatchResult)
+{
+    BatchCompiler compiler(2);
+    vector<BatchItem> items = {
+        BatchItem(L"a.swift", L"let a = [1, 2, 3]"),
+        BatchItem(L"b.swift", L"let b = 1")
+    };
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    ASSERT_EQ(2, results.size());
+    //each item is collected on its own worker thread
+    ASSERT_NE(0, results[0].stats.getCount(CompilerCounter::Tokens));
+    ASSERT_NE(0, results[1].stats.getCount(CompilerCounter::Tokens));
+    ASSERT_GT(results[0].stats.getCount(CompilerCounter::Tokens), results[1].stats.getCount(CompilerCounter::Tokens));
+    CompilerStats total;
+    total.merge(results[0].stats);
+    total.merge(results[1].stats);
+    ASSERT_EQ(results[0].stats.getCount(CompilerCounter::Nodes) + results[1].stats.getCount(CompilerCounter::Nodes), total.getCount(CompilerCounter::Nodes));
+}
@@ -0,0 +1,130 @@
+/* TestCompilerTrace.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "common/CompilerTrace.h"
+#include "semantics/BatchCompiler.h"
+#include <sstream>
+
+using namespace Swallow;
+using namespace std;
+
+static int count(const string& str, const string& s)
+{
+    int ret = 0;
+    for(size_t p = str.find(s); p != string::npos; p = str.find(s, p + s.size()))
+        ret++;
+    return ret;
+}
+
+TEST(TestCompilerTrace, ChromeTrace)
+{
+    CompilerTrace trace;
+    {
+        CompilerTraceScope traceScope(&trace);
+        //specializes a type declared by the test, the standard library's types may be already cached
+        SEMANTIC_ANALYZE(L"struct Box<T> {\n"
+            L"    var value : T\n"
+            L"}\n"
+            L"func f(a : Int) -> Int { return a }\n"
+            L"func f(a : String) -> String { return a }\n"
+            L"var b : Box<Int>\n"
+            L"let x = f(3)");
+        ASSERT_NO_ERRORS();
+    }
+    ASSERT_EQ(0, trace.getDroppedEvents());
+    stringstream out;
+    trace.writeChromeTrace(out);
+    string json = out.str();
+    ASSERT_EQ(0, json.find("{\"traceEvents\":["));
+    ASSERT_NE(string::npos, json.find("\"name\":\"struct Box\",\"cat\":\"declaration\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"func f\",\"cat\":\"declaration\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"let x\",\"cat\":\"declaration\",\"ph\":\"B\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"var b\",\"cat\":\"declaration\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"f\",\"cat\":\"function_body\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"Box\",\"cat\":\"specialization\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"f\",\"cat\":\"overload_resolution\""));
+    ASSERT_NE(string::npos, json.find("\"args\":{\"line\":7}"));
+    ASSERT_EQ(trace.getNumEvents(), count(json, "\"ph\":\"B\"") + count(json, "\"ph\":\"E\""));
+    ASSERT_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+}
+
+TEST(TestCompilerTrace, Inactive)
+{
+    CompilerTrace trace;
+    {
+        CompilerTraceScope traceScope(&trace);
+    }
+    SEMANTIC_ANALYZE(L"func f() -> Int { return 1 }\n"
+        L"let a = f()");
+    ASSERT_NO_ERRORS();
+    ASSERT_EQ(0, trace.getNumEvents());
+}
+
+TEST(TestCompilerTrace, RingBuffer)
+{
+    CompilerTrace trace(3);
+    {
+        CompilerTraceScope traceScope(&trace);
+        TraceEvent a(TraceCategory::Declaration, L"a");
+        {
+            TraceEvent b(TraceCategory::Declaration, L"b");
+        }
+    }
+    //the begin of a is overwritten, so is its end skipped
+    ASSERT_EQ(3, trace.getNumEvents());
+    ASSERT_EQ(1, trace.getDroppedEvents());
+    stringstream out;
+    trace.writeChromeTrace(out);
+    string json = out.str();
+    ASSERT_EQ(string::npos, json.find("\"name\":\"a\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"b\""));
+    ASSERT_EQ(1, count(json, "\"ph\":\"B\""));
+    ASSERT_EQ(1, count(json, "\"ph\":\"E\""));
+}
+
+TEST(TestCompilerTrace, BatchCompiler)
+{
+    CompilerTrace trace;
+    BatchCompiler compiler(2);
+    compiler.setTrace(&trace);
+    vector<BatchItem> items = {
+        BatchItem(L"a.swift", L"let a = [1, 2, 3]"),
+        BatchItem(L"b.swift", L"let b = 1")
+    };
+    vector<BatchResult> results;
+    compiler.compile(items, results);
+    stringstream out;
+    trace.writeChromeTrace(out);
+    string json = out.str();
+    ASSERT_NE(string::npos, json.find("\"name\":\"a.swift\",\"cat\":\"file\""));
+    ASSERT_NE(string::npos, json.find("\"name\":\"b.swift\",\"cat\":\"file\""));
+    ASSERT_LE(1, count(json, "\"name\":\"thread_name\""));
+    ASSERT_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+}
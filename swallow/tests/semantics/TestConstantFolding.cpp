@@ -28,20 +28,114 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "../utils.h"
+#include "semantics/ConstantFolder.h"
+#include "semantics/Symbol.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/Type.h"
+#include "common/Errors.h"
 
 
 using namespace Swallow;
+using namespace std;
 
+#define CONSTANT_FOLD(s) SEMANTIC_ANALYZE(s); \
+    ConstantFolder folder(&symbolRegistry, &compilerResults); \
+    try { \
+        if(root) \
+            root->accept(&folder); \
+    } catch(const Abort&) {}
 
-TEST(TestConstantFolding, testLogic)
+static ExpressionPtr getInitializer(const ScopedProgramPtr& root, int statement)
 {
+    ValueBindingsPtr bindings = dynamic_pointer_cast<ValueBindings>(root->getStatement(statement));
+    if(!bindings)
+        return nullptr;
+    return bindings->get(0)->getInitializer();
+}
 
+
+TEST(TestConstantFolding, testLogic)
+{
+    CONSTANT_FOLD(L"let a = true && !false || false\n"
+                  L"let b = 1 < 2 && 2.5 >= 3.0\n"
+                  L"let c = \"ab\" == \"a\" + \"b\"\n");
+    ASSERT_NO_ERRORS();
+    BooleanLiteralPtr a = dynamic_pointer_cast<BooleanLiteral>(getInitializer(root, 0));
+    ASSERT_NOT_NULL(a);
+    ASSERT_TRUE(a->getValue());
+    ASSERT_EQ(global->Bool(), a->getType());
+    BooleanLiteralPtr b = dynamic_pointer_cast<BooleanLiteral>(getInitializer(root, 1));
+    ASSERT_NOT_NULL(b);
+    ASSERT_FALSE(b->getValue());
+    BooleanLiteralPtr c = dynamic_pointer_cast<BooleanLiteral>(getInitializer(root, 2));
+    ASSERT_NOT_NULL(c);
+    ASSERT_TRUE(c->getValue());
 }
 TEST(TestConstantFolding, testArithmetic)
 {
-
+    CONSTANT_FOLD(L"let a = 3 + 4 * (5 - 1) % 3\n"
+                  L"let x : UInt8 = 200\n"
+                  L"let b = x + 55\n"
+                  L"let c = 1.5 * 2 - -1\n"
+                  L"let d = \"Hello\" + \" \" + \"World\"\n");
+    ASSERT_NO_ERRORS();
+    IntegerLiteralPtr a = dynamic_pointer_cast<IntegerLiteral>(getInitializer(root, 0));
+    ASSERT_NOT_NULL(a);
+    ASSERT_EQ(4, a->value);
+    ASSERT_EQ(global->Int(), a->getType());
+    IntegerLiteralPtr b = dynamic_pointer_cast<IntegerLiteral>(getInitializer(root, 2));
+    ASSERT_NOT_NULL(b);
+    ASSERT_EQ(255, b->value);
+    ASSERT_EQ(global->UInt8(), b->getType());
+    FloatLiteralPtr c = dynamic_pointer_cast<FloatLiteral>(getInitializer(root, 3));
+    ASSERT_NOT_NULL(c);
+    ASSERT_EQ(4.0, c->value);
+    ASSERT_EQ(global->Double(), c->getType());
+    StringLiteralPtr d = dynamic_pointer_cast<StringLiteral>(getInitializer(root, 4));
+    ASSERT_NOT_NULL(d);
+    ASSERT_EQ(L"Hello World", d->value);
 }
 
+TEST(TestConstantFolding, testOverflow)
+{
+    CONSTANT_FOLD(L"let a : UInt8 = 200\n"
+                  L"let b = a + 100");
+    ASSERT_ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2);
+    ASSERT_EQ(L"200 + 100", error->items[0]);
+    ASSERT_EQ(L"UInt8", error->items[1]);
+    ASSERT_NOT_NULL(dynamic_pointer_cast<BinaryOperator>(getInitializer(root, 1)));
+}
 
+TEST(TestConstantFolding, testOverflow2)
+{
+    CONSTANT_FOLD(L"let a = 9223372036854775807 * 2");
+    ASSERT_ERROR(Errors::E_ARITHMETIC_OPERATION_A_ON_TYPE_B_RESULTS_IN_AN_OVERFLOW_2);
+    ASSERT_EQ(L"Int", error->items[1]);
+}
 
+TEST(TestConstantFolding, testDivisionByZero)
+{
+    CONSTANT_FOLD(L"let a = 10 / (5 - 5)");
+    ASSERT_ERROR(Errors::E_DIVISION_BY_ZERO);
+}
 
+TEST(TestConstantFolding, testConstantPropagation)
+{
+    CONSTANT_FOLD(L"let size = 16\n"
+                  L"var n = 0\n"
+                  L"func area() -> Int {\n"
+                  L"    let half = size / 2\n"
+                  L"    return half * half + n\n"
+                  L"}\n");
+    ASSERT_NO_ERRORS();
+    FunctionDefPtr func = dynamic_pointer_cast<FunctionDef>(root->getStatement(2));
+    ASSERT_NOT_NULL(func);
+    ReturnStatementPtr ret = dynamic_pointer_cast<ReturnStatement>(func->getBody()->getStatement(1));
+    ASSERT_NOT_NULL(ret);
+    //var is not a constant
+    BinaryOperatorPtr add = dynamic_pointer_cast<BinaryOperator>(ret->getExpression());
+    ASSERT_NOT_NULL(add);
+    IntegerLiteralPtr lhs = dynamic_pointer_cast<IntegerLiteral>(add->getLHS());
+    ASSERT_NOT_NULL(lhs);
+    ASSERT_EQ(64, lhs->value);
+}
@@ -0,0 +1,210 @@
+/* TestControlFlowGraph.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/ScopedNodes.h"
+#include "semantics/ControlFlowGraph.h"
+#include "semantics/DataFlowAnalysis.h"
+#include "ast/ast.h"
+
+using namespace Swallow;
+using namespace std;
+
+static CodeBlockPtr functionBody(const ProgramPtr& program, int idx)
+{
+    FunctionDefPtr func = dynamic_pointer_cast<FunctionDef>(program->getStatement(idx));
+    return func ? func->getBody() : nullptr;
+}
+
+TEST(TestControlFlowGraph, IfElse)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Bool) -> Int\n"
+            L"{\n"
+            L"    var x : Int\n"
+            L"    if a\n"
+            L"    {\n"
+            L"        x = 1\n"
+            L"    }\n"
+            L"    else\n"
+            L"    {\n"
+            L"        x = 2\n"
+            L"    }\n"
+            L"    return x\n"
+            L"}");
+    ASSERT_NO_ERRORS();
+    CodeBlockPtr body = functionBody(root, 0);
+    ASSERT_NOT_NULL(body);
+    ControlFlowGraph cfg(body);
+    //entry, exit, then, else, after if
+    ASSERT_EQ(5, cfg.numBlocks());
+    ASSERT_EQ(2, cfg.getBlock(ControlFlowGraph::Entry).numElements);
+    ASSERT_EQ(2, cfg.getBlock(ControlFlowGraph::Entry).numSuccessors);
+    ASSERT_EQ(2, cfg.getSuccessor(ControlFlowGraph::Entry, 0));
+    ASSERT_EQ(3, cfg.getSuccessor(ControlFlowGraph::Entry, 1));
+    ASSERT_EQ(2, cfg.getBlock(4).numPredecessors);
+    ASSERT_EQ(4, cfg.getPredecessor(ControlFlowGraph::Exit, 0));
+    ASSERT_EQ(4, cfg.findBlock(body->getStatement(2).get()));
+
+    LocalVariables vars(cfg);
+    ASSERT_EQ(1, vars.size());
+    ASSERT_EQ(0, vars.indexOf(L"x"));
+    ASSERT_EQ(-1, vars.indexOf(L"a"));
+    DataFlowAnalysis assigned = DataFlowAnalysis::definiteAssignment(cfg, vars);
+    ASSERT_FALSE(assigned.getIn(2).test(0));
+    ASSERT_TRUE(assigned.getIn(4).test(0));
+    DataFlowAnalysis live = DataFlowAnalysis::liveness(cfg, vars);
+    ASSERT_TRUE(live.getIn(4).test(0));
+    ASSERT_FALSE(live.getIn(2).test(0));
+    ASSERT_FALSE(live.getIn(ControlFlowGraph::Entry).test(0));
+}
+
+TEST(TestControlFlowGraph, PartialAssignment)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Bool) -> Int\n"
+            L"{\n"
+            L"    var x = 0\n"
+            L"    var y : Int\n"
+            L"    if a\n"
+            L"    {\n"
+            L"        y = 1\n"
+            L"    }\n"
+            L"    return x\n"
+            L"}");
+    ASSERT_NO_ERRORS();
+    ControlFlowGraph cfg(functionBody(root, 0));
+    LocalVariables vars(cfg);
+    ASSERT_EQ(2, vars.size());
+    DataFlowAnalysis assigned = DataFlowAnalysis::definiteAssignment(cfg, vars);
+    uint32_t after = cfg.findBlock(functionBody(root, 0)->getStatement(3).get());
+    ASSERT_TRUE(assigned.getIn(after).test(vars.indexOf(L"x")));
+    ASSERT_FALSE(assigned.getIn(after).test(vars.indexOf(L"y")));
+}
+
+TEST(TestControlFlowGraph, LoopLiveness)
+{
+    SEMANTIC_ANALYZE(L"func f() -> Int\n"
+            L"{\n"
+            L"    var i = 0\n"
+            L"    var last = 0\n"
+            L"    while i < 10\n"
+            L"    {\n"
+            L"        last = i\n"
+            L"        i = i + 1\n"
+            L"    }\n"
+            L"    return 3\n"
+            L"}");
+    ASSERT_NO_ERRORS();
+    CodeBlockPtr body = functionBody(root, 0);
+    ControlFlowGraph cfg(body);
+    //entry, exit, header, body, after
+    ASSERT_EQ(5, cfg.numBlocks());
+    uint32_t header = cfg.getSuccessor(ControlFlowGraph::Entry, 0);
+    ASSERT_EQ(2, cfg.getBlock(header).numSuccessors);
+    ASSERT_EQ(2, cfg.getBlock(header).numPredecessors);
+    LocalVariables vars(cfg);
+    DataFlowAnalysis live = DataFlowAnalysis::liveness(cfg, vars);
+    //i is carried around the back edge, last is never read
+    ASSERT_TRUE(live.getIn(header).test(vars.indexOf(L"i")));
+    ASSERT_FALSE(live.getIn(header).test(vars.indexOf(L"last")));
+    ASSERT_FALSE(live.getIn(ControlFlowGraph::Entry).test(vars.indexOf(L"i")));
+}
+
+TEST(TestControlFlowGraph, Unreachable)
+{
+    SEMANTIC_ANALYZE(L"func f() -> Int\n"
+            L"{\n"
+            L"    var a = 0\n"
+            L"    outer: while a < 100\n"
+            L"    {\n"
+            L"        while a < 3\n"
+            L"        {\n"
+            L"            a = a + 1\n"
+            L"            continue outer\n"
+            L"            a = 5\n"
+            L"        }\n"
+            L"        break\n"
+            L"    }\n"
+            L"    return a\n"
+            L"}");
+    ASSERT_NO_ERRORS();
+    CodeBlockPtr body = functionBody(root, 0);
+    ControlFlowGraph cfg(body);
+    LabeledStatementPtr outer = static_pointer_cast<LabeledStatement>(body->getStatement(1));
+    WhileLoopPtr outerLoop = static_pointer_cast<WhileLoop>(outer->getStatement());
+    WhileLoopPtr inner = static_pointer_cast<WhileLoop>(outerLoop->getCodeBlock()->getStatement(0));
+    CodeBlockPtr innerBody = inner->getCodeBlock();
+    uint32_t outerHeader = cfg.findBlock(outerLoop->getCondition().get());
+    uint32_t continueBlock = cfg.findBlock(innerBody->getStatement(1).get());
+    uint32_t deadBlock = cfg.findBlock(innerBody->getStatement(2).get());
+    ASSERT_NE(continueBlock, deadBlock);
+    ASSERT_EQ(1, cfg.getBlock(continueBlock).numSuccessors);
+    ASSERT_EQ(outerHeader, cfg.getSuccessor(continueBlock, 0));
+    ASSERT_EQ(0, cfg.getBlock(deadBlock).numPredecessors);
+
+    DataFlowAnalysis reachable = DataFlowAnalysis::reachability(cfg);
+    ASSERT_TRUE(reachable.getOut(continueBlock).test(0));
+    ASSERT_FALSE(reachable.getOut(deadBlock).test(0));
+    ASSERT_TRUE(reachable.getOut(ControlFlowGraph::Exit).test(0));
+}
+
+TEST(TestControlFlowGraph, SwitchFallthrough)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Int) -> Int\n"
+            L"{\n"
+            L"    var b = 0\n"
+            L"    switch a\n"
+            L"    {\n"
+            L"        case 1:\n"
+            L"            fallthrough\n"
+            L"        case 2:\n"
+            L"            b = 2\n"
+            L"        default:\n"
+            L"            b = b + 3\n"
+            L"    }\n"
+            L"    return b\n"
+            L"}");
+    ASSERT_NO_ERRORS();
+    CodeBlockPtr body = functionBody(root, 0);
+    ControlFlowGraph cfg(body);
+    //entry, exit, 3 cases and the block after switch
+    ASSERT_EQ(6, cfg.numBlocks());
+    ASSERT_EQ(3, cfg.getBlock(ControlFlowGraph::Entry).numSuccessors);
+    uint32_t case1 = cfg.getSuccessor(ControlFlowGraph::Entry, 0);
+    uint32_t case2 = cfg.getSuccessor(ControlFlowGraph::Entry, 1);
+    uint32_t defaultCase = cfg.getSuccessor(ControlFlowGraph::Entry, 2);
+    ASSERT_EQ(1, cfg.getBlock(case1).numSuccessors);
+    ASSERT_EQ(case2, cfg.getSuccessor(case1, 0));
+    LocalVariables vars(cfg);
+    DataFlowAnalysis live = DataFlowAnalysis::liveness(cfg, vars);
+    int b = vars.indexOf(L"b");
+    //case 1 falls into case 2 which overwrites b
+    ASSERT_FALSE(live.getIn(case1).test(b));
+    ASSERT_TRUE(live.getIn(defaultCase).test(b));
+    ASSERT_TRUE(live.getIn(cfg.findBlock(body->getStatement(2).get())).test(b));
+}
@@ -0,0 +1,139 @@
+/* TestExpressionCost.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "../utils.h"
+#include "semantics/BatchCompiler.h"
+#include "semantics/SemanticAnalyzer.h"
+#include "common/Errors.h"
+
+using namespace Swallow;
+using namespace std;
+
+static void compile(int maxExpressionCost, const wchar_t* code, BatchResult& result)
+{
+    BatchCompiler compiler(1);
+    compiler.setMaxExpressionCost(maxExpressionCost);
+    compiler.compile(BatchItem(L"<file>", code), result);
+}
+
+TEST(TestExpressionCost, OperatorChain)
+{
+    //operands are analyzed once for all candidates of an operator, the cost grows linearly with the chain
+    wstring chain = L"let a = 1\nlet x = a";
+    for(int i = 0; i < 40; i++)
+        chain += L" + 1";
+    BatchResult result;
+    compile(1000, chain.c_str(), result);
+    ASSERT_TRUE(result.successed);
+    ASSERT_EQ(0, result.compilerResults.numResults());
+
+    BatchResult result2;
+    compile(100, chain.c_str(), result2);
+    ASSERT_EQ(1, result2.compilerResults.numResults());
+    const CompilerResult& error = result2.compilerResults.getResult(0);
+    ASSERT_EQ(Errors::E_EXPRESSION_WAS_TOO_COMPLEX_A_OF_B_SPENT_HERE_2, error.code);
+    ASSERT_EQ(2, error.line);
+    ASSERT_EQ(L"100", error.items[1]);
+}
+
+TEST(TestExpressionCost, Unlimited)
+{
+    BatchResult result;
+    compile(0, L"let x = 1 + 1 + 1 + 1", result);
+    ASSERT_TRUE(result.successed);
+    ASSERT_EQ(0, result.compilerResults.numResults());
+}
+
+TEST(TestExpressionCost, PerStatement)
+{
+    //every statement has its own budget
+    BatchResult result;
+    compile(1000, L"var a = 1 + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"a = a + 1\n"
+        L"func f() -> Int {\n"
+        L"    var b = a + 1\n"
+        L"    b = b + 1\n"
+        L"    b = b + 1\n"
+        L"    return b + 1\n"
+        L"}", result);
+    ASSERT_TRUE(result.successed);
+    ASSERT_EQ(0, result.compilerResults.numResults());
+}
+
+TEST(TestExpressionCost, CollectionLiteral)
+{
+    //elements that aren't plain literals are charged
+    wstring code = L"let a = 1\nlet b = [";
+    for(int i = 0; i < 12; i++)
+        code += i ? L", [a, a, a, a, a, a, a, a, a, a]" : L"[a, a, a, a, a, a, a, a, a, a]";
+    code += L"]";
+    BatchResult result;
+    compile(100, code.c_str(), result);
+    ASSERT_EQ(1, result.compilerResults.numResults());
+    ASSERT_EQ(Errors::E_EXPRESSION_WAS_TOO_COMPLEX_A_OF_B_SPENT_HERE_2, result.compilerResults.getResult(0).code);
+}
+
+TEST(TestExpressionCost, PlainLiterals)
+{
+    //plain literals need no overload resolution, a large table of them stays within the default limit
+    wstring code = L"let a = [";
+    for(int i = 0; i < SemanticAnalyzer::DefaultMaxExpressionCost + 1000; i++)
+        code += i ? L", 1" : L"1";
+    code += L"]\nlet b = [";
+    for(int i = 0; i < 200; i++)
+        code += (i ? L", \"" : L"\"") + to_wstring(i) + L"\" : 1.5";
+    code += L"]";
+    BatchResult result;
+    compile(SemanticAnalyzer::DefaultMaxExpressionCost, code.c_str(), result);
+    ASSERT_TRUE(result.successed);
+    ASSERT_EQ(0, result.compilerResults.numResults());
+
+    BatchResult result2;
+    compile(100, code.c_str(), result2);
+    ASSERT_TRUE(result2.successed);
+    ASSERT_EQ(0, result2.compilerResults.numResults());
+}
+
+TEST(TestExpressionCost, DefaultLimit)
+{
+    SymbolRegistry registry;
+    CompilerResults compilerResults;
+    SemanticAnalyzer analyzer(&registry, &compilerResults);
+    ASSERT_EQ(SemanticAnalyzer::DefaultMaxExpressionCost, analyzer.getMaxExpressionCost());
+    BatchResult result;
+    compile(SemanticAnalyzer::DefaultMaxExpressionCost, L"let x : Double = 1 + 1 + 1 + 1 + 1 + 1 + 1 + 1 + 1 + 1 + 1 + 1", result);
+    ASSERT_TRUE(result.successed);
+    ASSERT_EQ(0, result.compilerResults.numResults());
+}
@@ -180,19 +180,17 @@ TEST(TestGeneric, FuncSpecialization)
     ASSERT_EQ(L"Bool", b->getType()->toString());
 }
 
-/*
-TODO: check unused generic type
-TEST(TestGeneric, GenericConstraint7)
+TEST(TestGeneric, UninferredGenericParameter)
 {
     SEMANTIC_ANALYZE(L"func test<T1, T2>(a : T1) -> T1\n"
         "{\n"
         "return a;\n"
         "}\n"
         "test(5)");
-    dumpCompilerResults(compilerResults);
     ASSERT_EQ(1, compilerResults.numResults());
+    ASSERT_EQ(Errors::E_ARGUMENT_FOR_GENERIC_PARAMETER_A_COULD_NOT_BE_INFERRED_1, compilerResults.getResult(0).code);
+    ASSERT_EQ(L"T2", compilerResults.getResult(0).items[0]);
 }
-*/
 
 TEST(TestGeneric, GenericConstraint7)
 {
@@ -201,6 +199,27 @@ TEST(TestGeneric, GenericConstraint7)
     ASSERT_EQ(0, compilerResults.numResults());
 }
 
+TEST(TestGeneric, SpecializationCache)
+{
+    SEMANTIC_ANALYZE(L"func pick<T>(a : T) -> T { return a }\n"
+        L"let a = pick(1)");
+    ASSERT_NO_ERRORS();
+    FunctionSymbolPtr pick;
+    ASSERT_NOT_NULL(pick = std::dynamic_pointer_cast<FunctionSymbol>(scope->lookup(L"pick")));
+    GenericArgumentPtr args1(new GenericArgument(pick->getType()->getGenericDefinition()));
+    args1->add(global->String());
+    GenericArgumentPtr args2(new GenericArgument(pick->getType()->getGenericDefinition()));
+    args2->add(global->String());
+    //identical arguments share the specialization while it's alive
+    FunctionSymbolPtr spec = FunctionSymbol::getSpecialization(pick, args1);
+    ASSERT_EQ(spec, FunctionSymbol::getSpecialization(pick, args2));
+    //the generic function doesn't keep it alive
+    FunctionSymbolWeakPtr weak = spec;
+    spec = nullptr;
+    ASSERT_TRUE(weak.expired());
+    ASSERT_NOT_NULL(FunctionSymbol::getSpecialization(pick, args1));
+}
+
 TEST(TestGeneric, GenericConstraint8)
 {
     SEMANTIC_ANALYZE(L"func test<T>(a : Array<Foo<T>>) -> T\n"
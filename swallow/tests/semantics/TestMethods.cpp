@@ -484,3 +484,16 @@ TEST(TestMethods, MissingReturn6)
     ASSERT_ERROR(Errors::W_CODE_AFTER_A_WILL_NEVER_BE_EXECUTED_1);
     ASSERT_EQ(4, error->line);
 }
+TEST(TestMethods, MissingReturn7)
+{
+    SEMANTIC_ANALYZE(L"func a(f : Bool) -> Int\n"
+            L"{\n"
+            L"    let c = {() -> Int in return 1}\n"
+            L"    func b() -> Int\n"
+            L"    {\n"
+            L"        return 2\n"
+            L"    }\n"
+            L"}");
+    ASSERT_ERROR(Errors::E_MISSING_RETURN_IN_A_FUNCTION_EXPECTED_TO_RETURN_A_1);
+    ASSERT_EQ(1, error->line);
+}
@@ -353,3 +353,67 @@ TEST(TestOperators, Precedence2)
     ASSERT_NOT_NULL(op);
     ASSERT_EQ(L"+", op->getOperator());
 }
+
+TEST(TestOperators, OperandParents)
+{
+    SEMANTIC_ANALYZE(L"var b = 4\n"
+            L"var a = b + b * -b");
+    ASSERT_EQ(0, compilerResults.numResults());
+    ValueBindingsPtr bindings = dynamic_pointer_cast<ValueBindings>(root->getStatement(1));
+    ASSERT_NOT_NULL(bindings);
+    ValueBindingPtr a = bindings->get(0);
+    BinaryOperatorPtr op = dynamic_pointer_cast<BinaryOperator>(a->getInitializer());
+    ASSERT_NOT_NULL(op);
+    //operands stay linked to the operators after being resolved and analyzed
+    ASSERT_EQ(a, op->getParentNode());
+    ASSERT_EQ(op, op->getLHS()->getParentNode());
+    BinaryOperatorPtr mul = dynamic_pointer_cast<BinaryOperator>(op->getRHS());
+    ASSERT_NOT_NULL(mul);
+    ASSERT_EQ(op, mul->getParentNode());
+    ASSERT_EQ(mul, mul->getLHS()->getParentNode());
+    UnaryOperatorPtr neg = dynamic_pointer_cast<UnaryOperator>(mul->getRHS());
+    ASSERT_NOT_NULL(neg);
+    ASSERT_EQ(mul, neg->getParentNode());
+    ASSERT_EQ(neg, neg->getOperand()->getParentNode());
+}
+
+TEST(TestOperators, RewrittenElementParents)
+{
+    SEMANTIC_ANALYZE(L"var b = 4\n"
+            L"var a = [b + 1, (b * 2) - 3]");
+    ASSERT_EQ(0, compilerResults.numResults());
+    ValueBindingsPtr bindings = dynamic_pointer_cast<ValueBindings>(root->getStatement(1));
+    ASSERT_NOT_NULL(bindings);
+    ArrayLiteralPtr array = dynamic_pointer_cast<ArrayLiteral>(bindings->get(0)->getInitializer());
+    ASSERT_NOT_NULL(array);
+    ASSERT_EQ(2, array->numElements());
+    //elements replaced by the operator resolver and the analyzer are linked to their containers
+    ASSERT_EQ(array, array->getElement(0)->getParentNode());
+    BinaryOperatorPtr sub = dynamic_pointer_cast<BinaryOperator>(array->getElement(1));
+    ASSERT_NOT_NULL(sub);
+    ASSERT_EQ(array, sub->getParentNode());
+    ParenthesizedExpressionPtr p = dynamic_pointer_cast<ParenthesizedExpression>(sub->getLHS());
+    ASSERT_NOT_NULL(p);
+    ASSERT_EQ(sub, p->getParentNode());
+    ASSERT_EQ(p, p->get(0)->getParentNode());
+}
+
+TEST(TestOperators, Conditional)
+{
+    SEMANTIC_ANALYZE(L"func stepForward(input: Int) -> Int { return input + 1 }\n"
+            L"func stepBackward(input: Int) -> Int { return input - 1 }\n"
+            L"func chooseStepFunction(backwards: Bool) -> (Int) -> Int { return backwards ? stepBackward : stepForward }\n"
+            L"let a = 1 > 2 ? 3 : 4");
+    dumpCompilerResults(compilerResults);
+    ASSERT_EQ(0, compilerResults.numResults());
+    SymbolPtr a = scope->lookup(L"a");
+    ASSERT_NOT_NULL(a);
+    ASSERT_EQ(L"Int", a->getType()->toString());
+}
+
+TEST(TestOperators, Conditional_Mismatch)
+{
+    SEMANTIC_ANALYZE(L"let a = true ? 3 : \"4\"");
+    ASSERT_EQ(1, compilerResults.numResults());
+    ASSERT_EQ(Errors::E_A_IS_NOT_CONVERTIBLE_TO_B_2, compilerResults.getResult(0).code);
+}
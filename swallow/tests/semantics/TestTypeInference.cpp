@@ -318,3 +318,119 @@ TEST(TestTypeInference, FuncToVar)
 
 }
 
+
+static ExpressionPtr getInitializer(const ScopedProgramPtr& root, int statement)
+{
+    ValueBindingsPtr bindings = std::dynamic_pointer_cast<ValueBindings>(root->getStatement(statement));
+    if(!bindings)
+        return nullptr;
+    return bindings->get(0)->getInitializer();
+}
+
+TEST(TestTypeInference, LiteralOperator)
+{
+    SEMANTIC_ANALYZE(L"let a = 1 + 2\n"
+        L"let b : UInt8 = 200 + 55\n"
+        L"let c : Float = 1 * 2 + 3");
+    ASSERT_NO_ERRORS();
+    BinaryOperatorPtr a, b, c;
+    ASSERT_NOT_NULL(a = std::dynamic_pointer_cast<BinaryOperator>(getInitializer(root, 0)));
+    ASSERT_EQ(global->Int(), a->getType());
+    ASSERT_EQ(LiteralKind::Integer, a->getLiteralKind());
+
+    ASSERT_NOT_NULL(b = std::dynamic_pointer_cast<BinaryOperator>(getInitializer(root, 1)));
+    ASSERT_EQ(global->UInt8(), b->getType());
+    ASSERT_EQ(global->UInt8(), b->getLHS()->getType());
+    ASSERT_EQ(global->UInt8(), b->getRHS()->getType());
+
+    //the contextual type is propagated to the innermost operator
+    ASSERT_NOT_NULL(c = std::dynamic_pointer_cast<BinaryOperator>(getInitializer(root, 2)));
+    ASSERT_EQ(global->Float(), c->getType());
+    BinaryOperatorPtr mul;
+    ASSERT_NOT_NULL(mul = std::dynamic_pointer_cast<BinaryOperator>(c->getLHS()));
+    ASSERT_EQ(global->Float(), mul->getType());
+    ASSERT_EQ(global->Float(), mul->getLHS()->getType());
+}
+
+TEST(TestTypeInference, LiteralOperatorArgument)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Double) -> Double { return a }\n"
+        L"func g() -> Double { return 1 + 2 }\n"
+        L"let b = f((1 + 2) * 3)");
+    ASSERT_NO_ERRORS();
+    FunctionCallPtr call;
+    ASSERT_NOT_NULL(call = std::dynamic_pointer_cast<FunctionCall>(getInitializer(root, 2)));
+    ExpressionPtr arg = call->getArguments()->get(0);
+    ASSERT_EQ(global->Double(), arg->getType());
+    ASSERT_EQ(LiteralKind::Integer, arg->getLiteralKind());
+}
+
+TEST(TestTypeInference, LiteralOperatorMismatch)
+{
+    SEMANTIC_ANALYZE(L"let a : String = 1 + 2");
+    ASSERT_ERROR(Errors::E_CANNOT_CONVERT_EXPRESSION_TYPE_2);
+}
+
+TEST(TestTypeInference, MixedNumberArray)
+{
+    SEMANTIC_ANALYZE(L"let a = [1, 2 + 3, 2.5]");
+    ASSERT_NO_ERRORS();
+    ArrayLiteralPtr a;
+    ASSERT_NOT_NULL(a = std::dynamic_pointer_cast<ArrayLiteral>(getInitializer(root, 0)));
+    ASSERT_EQ(L"Array<Double>", a->getType()->toString());
+    //literals analyzed before the element type was known take it afterwards
+    for(const ExpressionPtr& el : *a)
+        ASSERT_EQ(global->Double(), el->getType());
+}
+
+TEST(TestTypeInference, OverloadedFunctionArgument)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Int) -> Int { return a }\n"
+        L"func f(a : String) -> String { return a }\n"
+        L"func apply(fn : (String) -> String, v : String) -> String { return fn(v) }\n"
+        L"let r = apply(f, \"x\")");
+    ASSERT_NO_ERRORS();
+    FunctionCallPtr call;
+    ASSERT_NOT_NULL(call = std::dynamic_pointer_cast<FunctionCall>(getInitializer(root, 3)));
+    //the overload is picked by the parameter type
+    ExpressionPtr arg = call->getArguments()->get(0);
+    ASSERT_EQ(L"(String) -> String", arg->getType()->toString());
+    ASSERT_EQ(arg->getType(), arg->getReferencedSymbol()->getType());
+}
+
+TEST(TestTypeInference, OverloadedFunctionResult)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Int) -> Int { return a }\n"
+        L"func f(a : Int) -> String { return \"a\" }\n"
+        L"func g(a : String) -> String { return a }\n"
+        L"let r = g(f(1))");
+    ASSERT_NO_ERRORS();
+}
+
+TEST(TestTypeInference, GenericFunctionArgument)
+{
+    SEMANTIC_ANALYZE(L"func pick<T>(a : T) -> T { return a }\n"
+        L"func g(a : Double) -> Double { return a }\n"
+        L"func apply(fn : (Int) -> Int) -> Int { return fn(1) }\n"
+        L"let a = g(pick(1))\n"
+        L"let b = apply(pick)\n"
+        L"let c = pick(1)");
+    ASSERT_NO_ERRORS();
+    //the generic parameter is inferred from the parameter type
+    FunctionCallPtr call;
+    ASSERT_NOT_NULL(call = std::dynamic_pointer_cast<FunctionCall>(getInitializer(root, 3)));
+    ASSERT_EQ(global->Double(), call->getArguments()->get(0)->getType());
+    ASSERT_NOT_NULL(call = std::dynamic_pointer_cast<FunctionCall>(getInitializer(root, 4)));
+    ASSERT_EQ(L"(Int) -> Int", call->getArguments()->get(0)->getType()->toString());
+    SymbolPtr c;
+    ASSERT_NOT_NULL(c = scope->lookup(L"c"));
+    ASSERT_EQ(global->Int(), c->getType());
+}
+
+TEST(TestTypeInference, AmbiguousFunctionReference)
+{
+    SEMANTIC_ANALYZE(L"func f(a : Int) -> Int { return a }\n"
+        L"func f(a : String) -> String { return a }\n"
+        L"let g = f");
+    ASSERT_ERROR(Errors::E_AMBIGUOUS_USE_1);
+}
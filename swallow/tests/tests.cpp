@@ -34,5 +34,5 @@ using namespace Swallow;
 int main(int argc, char** argv)
 {
     testInit(argc, argv);
-    return RUN_ALL_TESTS();
+    return runTests();
 }
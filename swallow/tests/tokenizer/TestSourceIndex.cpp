@@ -0,0 +1,89 @@
+/* TestSourceIndex.cpp --
+ *
+ * Copyright (c) 2014, Lex Chou <lex at chou dot it>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Swallow nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "tokenizer/Token.h"
+#include "tokenizer/Tokenizer.h"
+#include "common/SourceIndex.h"
+#include "../utils.h"
+using namespace Swallow;
+
+TEST(TestSourceIndex, testPosition)
+{
+    SourceIndex index(L"let a = 1\nlet b = 2\r\n\nfoo()");
+    ASSERT_EQ(4, index.numLines());
+    int line, column;
+    index.getPosition(0, line, column);
+    ASSERT_EQ(1, line);
+    ASSERT_EQ(1, column);
+    index.getPosition(9, line, column);
+    ASSERT_EQ(1, line);
+    ASSERT_EQ(10, column);
+    index.getPosition(14, line, column);
+    ASSERT_EQ(2, line);
+    ASSERT_EQ(5, column);
+    index.getPosition(22, line, column);
+    ASSERT_EQ(4, line);
+    ASSERT_EQ(1, column);
+    ASSERT_EQ(14, index.getOffset(2, 5));
+    ASSERT_EQ(L"let b = 2", index.getLineContent(2));
+    ASSERT_EQ(L"", index.getLineContent(3));
+    ASSERT_EQ(L"foo()", index.getLineContent(4));
+    ASSERT_EQ(L"", index.getLineContent(5));
+}
+
+TEST(TestSourceIndex, testTokenPosition)
+{
+    Tokenizer tokenizer(L"let a = 1\n  foo(a,\n\tb)");
+    Token token;
+    int line, column;
+    ASSERT_TRUE(tokenizer.next(token));
+    tokenizer.getSourceIndex().getPosition(token.offset, line, column);
+    ASSERT_EQ(1, line);
+    ASSERT_EQ(1, column);
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_EQ(L"a", token.token);
+    tokenizer.getSourceIndex().getPosition(token.offset, line, column);
+    ASSERT_EQ(1, line);
+    ASSERT_EQ(5, column);
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_EQ(L"foo", token.token);
+    tokenizer.getSourceIndex().getPosition(token.offset, line, column);
+    ASSERT_EQ(2, line);
+    ASSERT_EQ(3, column);
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_TRUE(tokenizer.next(token));
+    ASSERT_EQ(L"b", token.token);
+    tokenizer.getSourceIndex().getPosition(token.offset, line, column);
+    ASSERT_EQ(3, line);
+    ASSERT_EQ(2, column);
+}
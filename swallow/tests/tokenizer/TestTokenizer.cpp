@@ -604,7 +604,7 @@ TEST(TestNumberToken, testDecimalFloat)
     ASSERT_TRUE(tokenizer.next(token));
     ASSERT_EQ(TokenType::Integer, token.type);
     ASSERT_EQ(10, token.number.base);
-    ASSERT_EQ((double)345.0, token.number.dvalue);
+    ASSERT_EQ((int64_t)345, token.number.value);
     ASSERT_EQ(L"345", token.token);
 
     ASSERT_TRUE(tokenizer.next(token));
@@ -654,3 +654,22 @@ TEST(TestNumberToken, testHexadecimalFloat)
     ASSERT_TRUE(!tokenizer.next(token));
 }
 
+
+TEST(TestTokenText, testInterned)
+{
+    Token a, b, c;
+    Tokenizer tokenizer(L"foo bar foo");
+    ASSERT_TRUE(tokenizer.next(a));
+    ASSERT_TRUE(tokenizer.next(b));
+    ASSERT_TRUE(tokenizer.next(c));
+    ASSERT_EQ(L"foo", a.token);
+    ASSERT_EQ(L"bar", b.token);
+    ASSERT_EQ(&a.token.str(), &c.token.str());
+    ASSERT_NE(&a.token.str(), &b.token.str());
+    ASSERT_EQ(8u, c.offset);
+
+    tokenizer.restore(b);
+    ASSERT_TRUE(tokenizer.next(c));
+    ASSERT_EQ(L"bar", c.token);
+    ASSERT_EQ(4u, c.offset);
+}
@@ -36,6 +36,7 @@
 #include "semantics/ScopedNodes.h"
 #include "semantics/FunctionSymbol.h"
 #include "semantics/FunctionOverloadedSymbol.h"
+#include "semantics/TypeCache.h"
 #include <sstream>
 #include <fstream>
 #include "common/Errors.h"
@@ -44,10 +45,120 @@
 #include "ast/utils/ASTHierachyDumper.h"
 #include "semantics/OperatorResolver.h"
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 using namespace std;
 USE_SWALLOW_NS
 static bool opt_dumpAST = false;
+static bool opt_sharedStdlib = false;
+static bool opt_timing = false;
+static int opt_jobs = 1;
+static int opt_slowest = 10;
+
+/*!
+ * The prebuilt standard library scope shared by all tests
+ */
+static SymbolRegistry* stdlib = nullptr;
+/*!
+ * Tests specialize the shared standard library's generic types too, the types and specializations of a test are kept
+ * here and released when the next test creates its registry, so no test sees the specializations of the tests ran
+ * before it.
+ */
+static TypeCache testTypes;
+
+typedef chrono::steady_clock Clock;
+/*!
+ * Time spent on parsing and analyzing by current test
+ */
+static Clock::duration compileTime;
+
+struct TestTiming
+{
+    string name;
+    long long compile;//microseconds
+    long long total;//microseconds
+    bool failed;
+};
+
+/*!
+ * Records the time of each test, the slowest tests are reported when the program ends.
+ * In a worker process the records are written to a file for the parent to merge.
+ */
+class TestTimer : public testing::EmptyTestEventListener
+{
+public:
+    TestTimer()
+    :records(nullptr)
+    {}
+public:
+    virtual void OnTestStart(const testing::TestInfo& test_info) override
+    {
+        compileTime = Clock::duration::zero();
+        start = Clock::now();
+    }
+    virtual void OnTestEnd(const testing::TestInfo& info) override
+    {
+        TestTiming t;
+        t.name = string(info.test_case_name()) + "." + info.name();
+        t.compile = chrono::duration_cast<chrono::microseconds>(compileTime).count();
+        t.total = chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+        t.failed = info.result()->Failed();
+        if(opt_timing)
+            printf("[   TIME   ] %s compile %.3f ms, total %.3f ms\n", t.name.c_str(), t.compile / 1000.0, t.total / 1000.0);
+        if(records)
+            fprintf(records, "%lld %lld %d %s\n", t.compile, t.total, t.failed ? 1 : 0, t.name.c_str());
+        timings.push_back(t);
+    }
+    virtual void OnTestProgramEnd(const testing::UnitTest& unit_test) override
+    {
+        if(records)
+            fflush(records);
+        else if(opt_timing)
+            report(timings);
+    }
+    static void report(vector<TestTiming>& timings);
+public:
+    FILE* records;
+    vector<TestTiming> timings;
+private:
+    Clock::time_point start;
+};
+static TestTimer* timer = nullptr;
+
+void TestTimer::report(vector<TestTiming>& timings)
+{
+    long long compile = 0;
+    for(const TestTiming& t : timings)
+        compile += t.compile;
+    sort(timings.begin(), timings.end(), [](const TestTiming& a, const TestTiming& b){
+        return a.compile > b.compile;
+    });
+    printf("[   TIME   ] %d tests, compile %.3f ms in total, slowest:\n", (int)timings.size(), compile / 1000.0);
+    for(int i = 0; i < opt_slowest && i < (int)timings.size(); i++)
+    {
+        const TestTiming& t = timings[i];
+        printf("[   TIME   ] %10.3f ms  %s%s\n", t.compile / 1000.0, t.name.c_str(), t.failed ? " (FAILED)" : "");
+    }
+}
+
+/*!
+ * External functions used by test sources
+ */
+static void declareTestFunctions(GlobalScope* global)
+{
+    global->declareFunction(L"println", 0, L"Void", L"Int", NULL);
+    global->declareFunction(L"println", 0, L"Void", L"String", NULL);
+    global->declareFunction(L"print", 0, L"Void", L"String", NULL);
+    global->declareFunction(L"assert", 0, L"Void", L"Bool", L"String", NULL);
+}
 
 
 void testInit(int argc, char** argv)
@@ -56,9 +167,147 @@ void testInit(int argc, char** argv)
     {
         const char* arg = argv[i];
         if(!strcmp("--ast", arg))
-        opt_dumpAST = true;
+            opt_dumpAST = true;
+        else if(!strcmp("--shared-stdlib", arg))
+            opt_sharedStdlib = true;
+        else if(!strcmp("--timing", arg))
+            opt_timing = true;
+        else if(!strncmp("--slowest=", arg, 10))
+            opt_slowest = atoi(arg + 10);
+        else if(!strcmp("--jobs", arg))
+            opt_jobs = max(1, (int)thread::hardware_concurrency());
+        else if(!strncmp("--jobs=", arg, 7))
+            opt_jobs = max(1, atoi(arg + 7));
     }
     testing::InitGoogleTest(&argc, argv);
+    timer = new TestTimer();
+    testing::UnitTest::GetInstance()->listeners().Append(timer);
+    if(opt_sharedStdlib || opt_jobs > 1)
+    {
+        //built before forking workers, so all of them share the same pages of the snapshot
+        stdlib = new SymbolRegistry();
+        declareTestFunctions(stdlib->getGlobalScope());
+        //activated for the whole program, so passes after the semantic analysis use it too
+        static TypeCacheScope typeScope(&testTypes);
+    }
+}
+
+SymbolRegistry* createSymbolRegistry()
+{
+    if(stdlib)
+    {
+        testTypes.clear();
+        return new SymbolRegistry(stdlib->getGlobalScope());
+    }
+    return new SymbolRegistry();
+}
+
+#ifndef _WIN32
+/*!
+ * Copy the content of a temporary file to given file descriptor
+ */
+static void copyFile(FILE* src, int fd)
+{
+    char buf[4096];
+    size_t size;
+    rewind(src);
+    while((size = fread(buf, 1, sizeof(buf), src)) > 0)
+    {
+        if(write(fd, buf, size) < 0)
+            break;
+    }
+}
+
+/*!
+ * Runs the tests in opt_jobs worker processes using gtest's sharding, each worker runs a disjoint part of the
+ * test list. A crashed worker only fails its own shard.
+ */
+static int runShards()
+{
+    struct Worker
+    {
+        pid_t pid;
+        FILE* output;
+        FILE* records;
+        int status;
+    };
+    vector<Worker> workers(opt_jobs);
+    char buf[32];
+    Clock::time_point start = Clock::now();
+    fflush(stdout);
+    fflush(stderr);
+    for(int i = 0; i < opt_jobs; i++)
+    {
+        Worker& w = workers[i];
+        w.output = tmpfile();
+        w.records = tmpfile();
+        w.status = 0;
+        w.pid = fork();
+        if(w.pid < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        if(w.pid == 0)
+        {
+            dup2(fileno(w.output), STDOUT_FILENO);
+            dup2(fileno(w.output), STDERR_FILENO);
+            snprintf(buf, sizeof(buf), "%d", opt_jobs);
+            setenv("GTEST_TOTAL_SHARDS", buf, 1);
+            snprintf(buf, sizeof(buf), "%d", i);
+            setenv("GTEST_SHARD_INDEX", buf, 1);
+            timer->records = w.records;
+            int ret = RUN_ALL_TESTS();
+            fflush(stdout);
+            wcout.flush();
+            _exit(ret);
+        }
+    }
+    int failed = 0;
+    vector<TestTiming> timings;
+    for(int i = 0; i < opt_jobs; i++)
+    {
+        Worker& w = workers[i];
+        waitpid(w.pid, &w.status, 0);
+        printf("[==========] Shard %d/%d\n", i + 1, opt_jobs);
+        fflush(stdout);
+        copyFile(w.output, STDOUT_FILENO);
+        if(WIFSIGNALED(w.status))
+            printf("[  FAILED  ] Shard %d/%d crashed with signal %d\n", i + 1, opt_jobs, WTERMSIG(w.status));
+        if(!WIFEXITED(w.status) || WEXITSTATUS(w.status) != 0)
+            failed++;
+        rewind(w.records);
+        TestTiming t;
+        char name[1024];
+        int f;
+        while(fscanf(w.records, "%lld %lld %d %1023s", &t.compile, &t.total, &f, name) == 4)
+        {
+            t.name = name;
+            t.failed = f != 0;
+            timings.push_back(t);
+        }
+        fclose(w.output);
+        fclose(w.records);
+    }
+    long long elapsed = chrono::duration_cast<chrono::milliseconds>(Clock::now() - start).count();
+    if(opt_timing)
+        TestTimer::report(timings);
+    printf("[==========] %d tests ran in %d shards. (%lld ms total)\n", (int)timings.size(), opt_jobs, elapsed);
+    if(failed)
+        printf("[  FAILED  ] %d of %d shards failed.\n", failed, opt_jobs);
+    else
+        printf("[  PASSED  ] %d tests.\n", (int)timings.size());
+    return failed ? 1 : 0;
+}
+#endif//_WIN32
+
+int runTests()
+{
+#ifndef _WIN32
+    if(opt_jobs > 1)
+        return runShards();
+#endif
+    return RUN_ALL_TESTS();
 }
 
 
@@ -117,11 +366,10 @@ static void dumpAST(const NodePtr& node, const wchar_t* title)
 Swallow::ScopedProgramPtr analyzeStatement(Swallow::SymbolRegistry& registry, Swallow::CompilerResults& compilerResults, const char* func, const wchar_t* str)
 {
     using namespace Swallow;
-    GlobalScope* global = registry.getGlobalScope();
-    global->declareFunction(L"println", 0, L"Void", L"Int", NULL);
-    global->declareFunction(L"println", 0, L"Void", L"String", NULL);
-    global->declareFunction(L"print", 0, L"Void", L"String", NULL);
-    global->declareFunction(L"assert", 0, L"Void", L"Bool", L"String", NULL);
+    Clock::time_point start = Clock::now();
+    //the shared standard library already has them
+    if(!stdlib || registry.getGlobalScope() != stdlib->getGlobalScope())
+        declareTestFunctions(registry.getGlobalScope());
 
 
     ScopedNodeFactory nodeFactory;
@@ -144,7 +392,7 @@ Swallow::ScopedProgramPtr analyzeStatement(Swallow::SymbolRegistry& registry, Sw
     {
         dumpAST(ret, L"Failed to transform AST< result:");
     }
-
+    compileTime += Clock::now() - start;
     return ret;
 }
 
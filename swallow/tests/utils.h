@@ -54,6 +54,15 @@ Swallow::ProgramPtr parseStatements(Swallow::CompilerResults& compilerResults, c
 Swallow::ScopedProgramPtr analyzeStatement(Swallow::SymbolRegistry& registry, Swallow::CompilerResults& compilerResults, const char* func, const wchar_t* str);
 std::wstring readFile(const char* fileName);
 void testInit(int argc, char** argv);
+/*!
+ * Runs all tests, the tests are sharded across worker processes when --jobs is given.
+ */
+int runTests();
+/*!
+ * Creates the symbol registry of a test, it's built on top of the prebuilt standard library scope
+ * when --shared-stdlib or --jobs is given.
+ */
+Swallow::SymbolRegistry* createSymbolRegistry();
 const Swallow::CompilerResult* getCompilerResultByError(Swallow::CompilerResults& results, int error);
 
 
@@ -75,7 +84,8 @@ struct Tracer
 
 
 #define SEMANTIC_ANALYZE(s) Tracer tracer(__FILE__, __LINE__, __FUNCTION__); \
-    Swallow::SymbolRegistry symbolRegistry; \
+    std::unique_ptr<Swallow::SymbolRegistry> symbolRegistryPtr(createSymbolRegistry()); \
+    Swallow::SymbolRegistry& symbolRegistry = *symbolRegistryPtr; \
     std::wstring content = s; \
     Swallow::GlobalScope* global = symbolRegistry.getGlobalScope(); (void)global; \
     Swallow::CompilerResults compilerResults; \
@@ -255,6 +255,11 @@ void JSONSerializer::visitFallthrough(const FallthroughStatementPtr& node)
     NODE(Fallthrough);
 
 }
+void JSONSerializer::visitError(const ErrorNodePtr& node)
+{
+    JSON;
+    NODE(Error);
+}
 void JSONSerializer::visitIf(const IfStatementPtr& node)
 {
     JSON;
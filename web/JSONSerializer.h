@@ -74,6 +74,7 @@ SWALLOW_NS_BEGIN
         virtual void visitReturn(const ReturnStatementPtr& node);
         virtual void visitContinue(const ContinueStatementPtr& node);
         virtual void visitFallthrough(const FallthroughStatementPtr& node);
+        virtual void visitError(const ErrorNodePtr& node);
         virtual void visitIf(const IfStatementPtr& node);
         virtual void visitSwitchCase(const SwitchCasePtr& node);
         virtual void visitCase(const CaseStatementPtr& node);
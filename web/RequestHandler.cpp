@@ -28,7 +28,6 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "RequestHandler.h"
-#include "common/SwallowUtils.h"
 #include <fcgio.h>
 #include <iostream>
 #include <sstream>
@@ -38,16 +37,29 @@
 #include "semantics/SymbolRegistry.h"
 #include "semantics/ScopedNodeFactory.h"
 #include "common/CompilerResults.h"
+#include "common/CompilerStats.h"
 #include "semantics/OperatorResolver.h"
+#include "semantics/ConstantFolder.h"
 #include "semantics/ScopedNodes.h"
+#include "semantics/BatchCompiler.h"
 #include "JSONSerializer.h"
 
 using namespace std;
 using namespace Swallow;
 
 RequestHandler::RequestHandler()
+:batchCompiler(nullptr), maxResults(CompilerResults::DefaultLimit)
 {
     this->handlers.insert(make_pair("/swift/compiler/ast", &RequestHandler::handleAST));
+    this->handlers.insert(make_pair("/swift/compiler/batch", &RequestHandler::handleBatch));
+}
+RequestHandler::~RequestHandler()
+{
+    delete batchCompiler;
+}
+void RequestHandler::setMaxResults(int maxResults)
+{
+    this->maxResults = maxResults;
 }
 void RequestHandler::handle(FCGX_Request* request)
 {
@@ -83,12 +95,14 @@ static string readAll(istream& in)
     return ret;
 }
 
-static ScopedProgramPtr compile(const wstring& code, CompilerResults* compilerResults)
+static ScopedProgramPtr compile(const wstring& code, CompilerResults* compilerResults, CompilerStats* stats)
 {
+    CompilerStatsScope statsScope(stats);
     ScopedNodeFactory nodeFactory;
     SymbolRegistry registry;
     Parser parser(&nodeFactory, compilerResults);
     parser.setFileName(L"<file>");
+    parser.setErrorRecovery(true);
     ScopedProgramPtr ret = std::dynamic_pointer_cast<ScopedProgram>(parser.parse(code.c_str()));
     if(!ret)
         return nullptr;
@@ -96,8 +110,10 @@ static ScopedProgramPtr compile(const wstring& code, CompilerResults* compilerRe
     {
         OperatorResolver operatorResolver(&registry, compilerResults);
         SemanticAnalyzer analyzer(&registry, compilerResults);
+        ConstantFolder constantFolder(&registry, compilerResults);
         ret->accept(&operatorResolver);
         ret->accept(&analyzer);
+        ret->accept(&constantFolder);
         return ret;
     }
     catch(const Abort&)
@@ -108,34 +124,402 @@ static ScopedProgramPtr compile(const wstring& code, CompilerResults* compilerRe
 }
 
 
-void RequestHandler::handleAST(FCGX_Request* request)
+static void appendUTF8(string& out, uint32_t ch)
 {
-    cout<<"Content-Type: text/json\r\n"
-            <<"\r\n";
-    wstring code = SwallowUtils::toWString(readAll(cin));
+    if(ch < 0x80)
+        out.push_back((char)ch);
+    else if(ch < 0x800)
+    {
+        out.push_back((char)(0xc0 | (ch >> 6)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+    else if(ch < 0x10000)
+    {
+        out.push_back((char)(0xe0 | (ch >> 12)));
+        out.push_back((char)(0x80 | ((ch >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+    else
+    {
+        out.push_back((char)(0xf0 | (ch >> 18)));
+        out.push_back((char)(0x80 | ((ch >> 12) & 0x3f)));
+        out.push_back((char)(0x80 | ((ch >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (ch & 0x3f)));
+    }
+}
 
-    CompilerResults results;
-    ScopedProgramPtr program = compile(code, &results);
-    cout<<"{\"errors\" : [";
+static inline bool isHighSurrogate(uint32_t ch)
+{
+    return ch >= 0xd800 && ch <= 0xdbff;
+}
+static inline bool isLowSurrogate(uint32_t ch)
+{
+    return ch >= 0xdc00 && ch <= 0xdfff;
+}
+static inline uint32_t combineSurrogates(uint32_t high, uint32_t low)
+{
+    return 0x10000 + ((high - 0xd800) << 10) + (low - 0xdc00);
+}
+
+/*!
+ * Append a code point to a wide string, wchar_t is 16-bit on Windows
+ */
+static void appendCodePoint(wstring& out, uint32_t ch)
+{
+    if(sizeof(wchar_t) == 2 && ch >= 0x10000)
+    {
+        ch -= 0x10000;
+        out.push_back((wchar_t)(0xd800 + (ch >> 10)));
+        out.push_back((wchar_t)(0xdc00 + (ch & 0x3ff)));
+        return;
+    }
+    out.push_back((wchar_t)ch);
+}
+
+/*!
+ * Decode the UTF-8 sequence at given position, an invalid byte is taken as is
+ */
+static uint32_t readUTF8(const string& s, size_t& p)
+{
+    unsigned char lead = (unsigned char)s[p++];
+    int length = 0;
+    uint32_t ch = lead;
+    if((lead & 0xe0) == 0xc0)
+    {
+        length = 1;
+        ch = lead & 0x1f;
+    }
+    else if((lead & 0xf0) == 0xe0)
+    {
+        length = 2;
+        ch = lead & 0x0f;
+    }
+    else if((lead & 0xf8) == 0xf0)
+    {
+        length = 3;
+        ch = lead & 0x07;
+    }
+    if(p + length > s.size())
+        return lead;
+    for(int i = 0; i < length; i++)
+    {
+        if((s[p + i] & 0xc0) != 0x80)
+            return lead;
+    }
+    for(int i = 0; i < length; i++)
+        ch = (ch << 6) | (s[p++] & 0x3f);
+    return ch;
+}
+
+static wstring fromUTF8(const string& str)
+{
+    wstring ret;
+    for(size_t p = 0; p < str.size(); )
+        appendCodePoint(ret, readUTF8(str, p));
+    return ret;
+}
+
+static string toUTF8(const wstring& str)
+{
+    string ret;
+    for(size_t i = 0; i < str.size(); i++)
+    {
+        uint32_t ch = (uint32_t)str[i];
+        if(isHighSurrogate(ch) && i + 1 < str.size() && isLowSurrogate((uint32_t)str[i + 1]))
+            ch = combineSurrogates(ch, (uint32_t)str[++i]);
+        appendUTF8(ret, ch);
+    }
+    return ret;
+}
+
+/*!
+ * Escape given string as the content of a JSON string, encoded in UTF-8
+ */
+static string escape(const wstring& str)
+{
+    string ret;
+    for(size_t i = 0; i < str.size(); i++)
+    {
+        uint32_t ch = (uint32_t)str[i];
+        switch(ch)
+        {
+            case '"': ret += "\\\""; break;
+            case '\\': ret += "\\\\"; break;
+            case '\n': ret += "\\n"; break;
+            case '\r': ret += "\\r"; break;
+            case '\t': ret += "\\t"; break;
+            default:
+                if(ch < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                    ret += buf;
+                    break;
+                }
+                //a surrogate pair from a 16-bit wchar_t
+                if(isHighSurrogate(ch) && i + 1 < str.size() && isLowSurrogate((uint32_t)str[i + 1]))
+                    ch = combineSurrogates(ch, (uint32_t)str[++i]);
+                appendUTF8(ret, ch);
+                break;
+        }
+    }
+    return ret;
+}
+
+static void writeErrors(CompilerResults& results)
+{
+    cout<<"\"errors\" : [";
+    bool first = true;
     for(const CompilerResult& res : results)
     {
-        std::wstring msg = Errors::format(res.code, res.items);
+        std::wstring msg = res.format();
+        if(!first)
+            cout<<", ";
+        first = false;
         cout<<"{\"code\" : " << res.code << ", ";
         cout<<"\"line\" : " << res.line << ", ";
         cout<<"\"column\" : " << res.column << ", ";
         cout<<"\"level\" : " << res.level << ", ";
-        cout<<"\"msg\" : \"" << SwallowUtils::toString(msg) << "\"}";
+        cout<<"\"msg\" : \"" << escape(msg) << "\"}";
     }
     cout<<"]";
-    if(program != nullptr)
+}
+
+/*!
+ * Phase times are in milliseconds
+ */
+static void writeStats(const CompilerStats& stats)
+{
+    cout<<", \"stats\" : {\"phases\" : {";
+    for(int i = 0; i < CompilerPhase::Count; i++)
+    {
+        CompilerPhase::T phase = (CompilerPhase::T)i;
+        if(i)
+            cout<<", ";
+        cout<<"\"" << CompilerStats::getPhaseName(phase) << "\" : " << stats.getTime(phase) / 1000000.0;
+    }
+    cout<<"}, \"total\" : " << stats.getTotalTime() / 1000000.0 << ", \"counters\" : {";
+    for(int i = 0; i < CompilerCounter::Count; i++)
     {
-        wstringstream out;
-        JSONSerializer serializer(out);
-        program->accept(&serializer);
-        string ast = SwallowUtils::toString(out.str());
-        cout << ", \"ast\" : ";
-        cout << ast;
+        CompilerCounter::T counter = (CompilerCounter::T)i;
+        if(i)
+            cout<<", ";
+        cout<<"\"" << CompilerStats::getCounterName(counter) << "\" : " << stats.getCount(counter);
     }
+    cout<<"}}";
+}
+
+static void writeAST(const ScopedProgramPtr& program)
+{
+    wstringstream out;
+    JSONSerializer serializer(out);
+    program->accept(&serializer);
+    string ast = toUTF8(out.str());
+    cout << ", \"ast\" : ";
+    cout << ast;
+}
+
+void RequestHandler::handleAST(FCGX_Request* request)
+{
+    cout<<"Content-Type: text/json\r\n"
+            <<"\r\n";
+    wstring code = fromUTF8(readAll(cin));
+
+    CompilerResults results;
+    results.setLimit(maxResults);
+    CompilerStats stats;
+    ScopedProgramPtr program = compile(code, &results, &stats);
+    cout<<"{";
+    writeErrors(results);
+    writeStats(stats);
+    if(program != nullptr)
+        writeAST(program);
     cout<<"}";
 }
 
+/*!
+ * A minimal reader for the batch request:
+ * {"ast" : true, "sources" : [{"name" : "a.swift", "code" : "..."}, ...]}
+ */
+struct BatchRequestReader
+{
+    const string& s;
+    size_t p;
+    BatchRequestReader(const string& s)
+    :s(s), p(0)
+    {}
+    void skipSpaces()
+    {
+        while(p < s.size() && isspace((unsigned char)s[p]))
+            p++;
+    }
+    bool match(char ch)
+    {
+        skipSpaces();
+        if(p < s.size() && s[p] == ch)
+        {
+            p++;
+            return true;
+        }
+        return false;
+    }
+    /*!
+     * Read 4 hex digits of a \u escape
+     */
+    bool readHex4(uint32_t& out)
+    {
+        if(p + 4 > s.size())
+            return false;
+        out = 0;
+        for(int i = 0; i < 4; i++)
+        {
+            char ch = s[p++];
+            if(!isxdigit((unsigned char)ch))
+                return false;
+            out = out * 16 + (isdigit((unsigned char)ch) ? ch - '0' : (tolower((unsigned char)ch) - 'a' + 10));
+        }
+        return true;
+    }
+    bool readString(wstring& out)
+    {
+        if(!match('"'))
+            return false;
+        while(p < s.size() && s[p] != '"')
+        {
+            if(s[p] != '\\')
+            {
+                appendCodePoint(out, readUTF8(s, p));
+                continue;
+            }
+            if(++p >= s.size())
+                return false;
+            char ch = s[p++];
+            switch(ch)
+            {
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u':
+                {
+                    uint32_t code;
+                    if(!readHex4(code))
+                        return false;
+                    //characters outside the BMP are escaped as a surrogate pair
+                    if(isHighSurrogate(code) && s.compare(p, 2, "\\u") == 0)
+                    {
+                        size_t pos = p;
+                        uint32_t low;
+                        p += 2;
+                        if(readHex4(low) && isLowSurrogate(low))
+                            code = combineSurrogates(code, low);
+                        else
+                            p = pos;
+                    }
+                    appendCodePoint(out, code);
+                    break;
+                }
+                default: out.push_back(ch); break;
+            }
+        }
+        return match('"');
+    }
+    /*!
+     * Skip a scalar value(number/true/false/null)
+     */
+    bool readScalar(string& out)
+    {
+        skipSpaces();
+        while(p < s.size() && (isalnum((unsigned char)s[p]) || s[p] == '-' || s[p] == '.'))
+            out.push_back(s[p++]);
+        return !out.empty();
+    }
+    bool readSource(vector<BatchItem>& items)
+    {
+        BatchItem item(L"<file>", L"");
+        if(!match('{'))
+            return false;
+        while(!match('}'))
+        {
+            wstring key, value;
+            if(!readString(key) || !match(':') || !readString(value))
+                return false;
+            if(key == L"name")
+                item.fileName = value;
+            else if(key == L"code")
+                item.code = value;
+            match(',');
+        }
+        items.push_back(item);
+        return true;
+    }
+    bool read(vector<BatchItem>& items, bool& ast)
+    {
+        if(!match('{'))
+            return false;
+        while(!match('}'))
+        {
+            wstring key;
+            if(!readString(key) || !match(':'))
+                return false;
+            if(key == L"sources")
+            {
+                if(!match('['))
+                    return false;
+                while(!match(']'))
+                {
+                    if(!readSource(items))
+                        return false;
+                    match(',');
+                }
+            }
+            else
+            {
+                string value;
+                if(!readScalar(value))
+                    return false;
+                if(key == L"ast")
+                    ast = value == "true";
+            }
+            match(',');
+        }
+        return true;
+    }
+};
+
+void RequestHandler::handleBatch(FCGX_Request* request)
+{
+    cout<<"Content-Type: text/json\r\n"
+            <<"\r\n";
+    string body = readAll(cin);
+    vector<BatchItem> items;
+    bool ast = false;
+    BatchRequestReader reader(body);
+    if(!reader.read(items, ast))
+    {
+        cout<<"{\"error\" : \"Malformed batch request\"}";
+        return;
+    }
+
+    if(!batchCompiler)
+        batchCompiler = new BatchCompiler();
+    batchCompiler->setKeepAST(ast);
+    batchCompiler->setMaxResults(maxResults);
+    vector<BatchResult> results;
+    batchCompiler->compile(items, results);
+    cout<<"{\"results\" : [";
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        BatchResult& result = results[i];
+        if(i)
+            cout<<", ";
+        cout<<"{\"name\" : \"" << escape(result.fileName) << "\", ";
+        writeErrors(result.compilerResults);
+        writeStats(result.stats);
+        if(result.program != nullptr)
+            writeAST(result.program);
+        cout<<"}";
+    }
+    cout<<"]}";
+}
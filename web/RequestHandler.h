@@ -33,19 +33,35 @@
 #include <string>
 
 struct FCGX_Request;
+namespace Swallow
+{
+    class BatchCompiler;
+}
 class RequestHandler
 {
     typedef void (RequestHandler::*Handler)(FCGX_Request* request);
 public:
     RequestHandler();
+    ~RequestHandler();
 public:
     void handle(FCGX_Request* request);
+    /*!
+     * Limits the number of compiler results reported for each source, 0 means unlimited.
+     */
+    void setMaxResults(int maxResults);
 private:
     void handle404();
     void handleAST(FCGX_Request* request);
+    void handleBatch(FCGX_Request* request);
 
 private:
     std::map<std::string, Handler> handlers;
+    /*!
+     * Created by the first batch request and kept for the life of the process,
+     * so the standard library is only initialized once.
+     */
+    Swallow::BatchCompiler* batchCompiler;
+    int maxResults;
 
 
 };
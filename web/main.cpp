@@ -28,11 +28,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include <fcgio.h>
 #include "RequestHandler.h"
 
 using namespace std;
-int main()
+int main(int argc, char** argv)
 {
     streambuf* cin_buf = cin.rdbuf();
     streambuf* cout_buf = cout.rdbuf();
@@ -41,6 +43,11 @@ int main()
     FCGX_Init();
     FCGX_InitRequest(&request, 0, 0);
     RequestHandler handler;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--max-errors") && i + 1 < argc)
+            handler.setMaxResults(atoi(argv[++i]));
+    }
 
     while(FCGX_Accept_r(&request) == 0)
     {